@@ -0,0 +1,160 @@
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include "test_data.h"
+#include "api/JsonSerializer.h"
+#include "api/PricingEndpoint.h"
+#include "api/RequestArena.h"
+#include "api/ResponseWriter.h"
+
+using namespace OptionPricer;
+using namespace OptionPricer::API;
+using json = nlohmann::json;
+
+// Every handler runs end to end as pricing_server runs it, minus the socket:
+// request body in (decoded the same way the route decodes it), serialised
+// response body out.
+
+namespace
+{
+    json optionJson(const Tests::TestCase &c, const char *type, const char *model, int steps)
+    {
+        return {{"type", type}, {"model", model}, {"spot", c.spot}, {"strike", c.strike}, {"rate", c.rate},
+                {"volatility", c.volatility}, {"time", c.time}, {"steps", steps}};
+    }
+
+    // `legs` legs cycling through the published cases, every fifth one American
+    std::string portfolioBody(int legs, int payoffSteps)
+    {
+        const auto &cases = Tests::EUROPEAN_OPTION_TEST_CASES;
+        json body = {{"spot", 100.0}, {"rate", 0.05}, {"payoff_steps", payoffSteps}, {"legs", json::array()}};
+        for (int i = 0; i < legs; ++i)
+        {
+            const auto &c = cases[i % cases.size()];
+            body["legs"].push_back({{"type", i % 5 == 4 ? "american" : "european"},
+                                    {"optionType", i % 2 ? "put" : "call"},
+                                    {"strike", c.strike + (i / 2) % 10 - 5},
+                                    {"volatility", c.volatility},
+                                    {"time", c.time},
+                                    {"quantity", i % 3 ? 1 : -2},
+                                    {"steps", 200}});
+        }
+        return body.dump();
+    }
+} // namespace
+
+static void BM_HandlePrice(benchmark::State &state)
+{
+    const bool american = state.range(0) != 0;
+    const std::string body = optionJson(Tests::EUROPEAN_OPTION_TEST_CASES.front(), "put",
+                                        american ? "american" : "european", 500)
+                                 .dump();
+    for (auto _ : state)
+    {
+        const OptionParams params = JsonSerializer::parseOptionParams(body);
+        benchmark::DoNotOptimize(PricingEndpoint::handlePriceRequest(params).dump());
+    }
+    state.SetLabel(american ? "american, 500 steps" : "european");
+}
+BENCHMARK(BM_HandlePrice)->Arg(0)->Arg(1);
+
+static void BM_HandlePriceBatch(benchmark::State &state)
+{
+    const auto &cases = Tests::EUROPEAN_OPTION_TEST_CASES;
+    json entries = json::array();
+    for (int i = 0; i < state.range(0); ++i)
+    {
+        Tests::TestCase c = cases[i % cases.size()];
+        c.strike += i % 41 - 20;
+        entries.push_back(optionJson(c, i % 2 ? "put" : "call", i % 10 == 9 ? "american" : "european", 100));
+    }
+    const std::string body = entries.dump();
+    for (auto _ : state)
+    {
+        const std::vector<OptionBatchItem> items = JsonSerializer::parseOptionBatch(body);
+        benchmark::DoNotOptimize(PricingEndpoint::handlePriceBatchRequest(items).dump());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HandlePriceBatch)->Arg(1000)->UseRealTime();
+
+static void BM_HandleStrategy(benchmark::State &state)
+{
+    const auto &c = Tests::STRATEGY_TEST_CASES[1]; // the published straddle
+    const bool strangle = state.range(0) != 0;
+    const std::string body = json{{"strategy", strangle ? "strangle" : "straddle"}, {"spot", c.spot},
+                                  {"strike", c.strike}, {"rate", c.rate}, {"volatility", c.volatility},
+                                  {"time", c.time}, {"is_long", true}}
+                                 .dump();
+    for (auto _ : state)
+    {
+        const StrategyParams params = JsonSerializer::parseStrategyParams(body);
+        benchmark::DoNotOptimize(PricingEndpoint::handleStrategyRequest(params).dump());
+    }
+    state.SetLabel(strangle ? "strangle" : "straddle");
+}
+BENCHMARK(BM_HandleStrategy)->Arg(0)->Arg(1);
+
+static void BM_HandlePortfolio(benchmark::State &state)
+{
+    const std::string body = portfolioBody(static_cast<int>(state.range(0)), 100);
+    for (auto _ : state)
+    {
+        RequestArena::Scope arena;
+        const PortfolioParams params = JsonSerializer::parsePortfolioParams(body);
+        benchmark::DoNotOptimize(ResponseWriter::write(PricingEndpoint::buildPortfolioResponse(params),
+                                                       ResponseWriter::Format::Json));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HandlePortfolio)->Arg(4)->Arg(40)->UseRealTime();
+
+static void BM_HandleRisk(benchmark::State &state)
+{
+    json request = json::parse(portfolioBody(4, 100));
+    request["paths"] = 10000;
+    request["confidence"] = {0.95, 0.99};
+    request["revaluation"] = state.range(0) ? "taylor" : "full";
+    const std::string body = request.dump();
+    for (auto _ : state)
+    {
+        RequestArena::Scope arena;
+        benchmark::DoNotOptimize(PricingEndpoint::handleRiskRequest(json::parse(body)).dump());
+    }
+    state.SetLabel(state.range(0) ? "taylor" : "full");
+}
+BENCHMARK(BM_HandleRisk)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Square surface of range(0) x range(0) points with the default fields
+static void BM_HandleGreeksSurface(benchmark::State &state)
+{
+    const auto &g = Tests::GREEKS_TEST_DATA.front();
+    const json request = {{"type", g.optionType}, {"strike", g.strike}, {"rate", g.rate},
+                          {"volatility", g.volatility}, {"spot_range", {50.0, 150.0}},
+                          {"time_range", {0.05, 2.0}}, {"steps", state.range(0)}};
+    const std::string body = request.dump();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ResponseWriter::write(PricingEndpoint::buildSurfaceResponse(json::parse(body)),
+                                                       ResponseWriter::Format::Json));
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+BENCHMARK(BM_HandleGreeksSurface)->Arg(50)->Arg(500)->UseRealTime();
+
+static void BM_HandleChain(benchmark::State &state)
+{
+    const auto &c = Tests::EUROPEAN_OPTION_TEST_CASES.front();
+    json request = {{"type", "call"}, {"spot", c.spot}, {"rate", c.rate}, {"volatility", c.volatility},
+                    {"time", c.time}, {"strikes", json::array()}, {"types", json::array()}};
+    for (int i = 0; i < state.range(0); ++i)
+    {
+        request["strikes"].push_back(50.0 + 100.0 * i / state.range(0));
+        request["types"].push_back(i % 2 ? "put" : "call");
+    }
+    const std::string body = request.dump();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ResponseWriter::write(PricingEndpoint::buildChainResponse(json::parse(body)),
+                                                       ResponseWriter::Format::Json));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HandleChain)->Arg(200)->Arg(20000)->UseRealTime();
@@ -0,0 +1,17 @@
+#include <benchmark/benchmark.h>
+#include "options/GreeksCache.h"
+
+int main(int argc, char **argv)
+{
+    // Benchmarks repeat identical inputs; with the cache on they would time lookups, not pricing
+    OptionPricer::GreeksCache::Config cache;
+    cache.capacityBytes = 0;
+    OptionPricer::GreeksCache::configureShared(cache);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,332 @@
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "test_data.h"
+#include "concurrency/Scheduler.h"
+#include "models/BinomialTree.h"
+#include "models/BlackScholes.h"
+#include "models/FiniteDifference.h"
+#include "models/NormalDistribution.h"
+#include "models/RiskMeasures.h"
+#include "options/AmericanOption.h"
+#include "options/EuropeanOption.h"
+#include "strategy/IronCondor.h"
+
+using namespace OptionPricer;
+using Tests::EUROPEAN_OPTION_TEST_CASES;
+using Tests::GREEKS_TEST_DATA;
+
+// Each iteration walks every published case, so the branch predictor sees
+// realistic mixes of moneyness rather than one input over and over
+
+static void BM_CallPrice(benchmark::State &state)
+{
+    for (auto _ : state)
+        for (const auto &c : EUROPEAN_OPTION_TEST_CASES)
+            benchmark::DoNotOptimize(BlackScholes::callPrice(c.spot, c.strike, c.rate, c.volatility, c.time));
+    state.SetItemsProcessed(state.iterations() * EUROPEAN_OPTION_TEST_CASES.size());
+}
+BENCHMARK(BM_CallPrice);
+
+static void BM_PutPrice(benchmark::State &state)
+{
+    for (auto _ : state)
+        for (const auto &c : EUROPEAN_OPTION_TEST_CASES)
+            benchmark::DoNotOptimize(BlackScholes::putPrice(c.spot, c.strike, c.rate, c.volatility, c.time));
+    state.SetItemsProcessed(state.iterations() * EUROPEAN_OPTION_TEST_CASES.size());
+}
+BENCHMARK(BM_PutPrice);
+
+// The five Greeks one call at a time, against the fused kernel below
+static void BM_GreeksSeparate(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        for (const auto &g : GREEKS_TEST_DATA)
+        {
+            const OptionKind kind = parseOptionKind(g.optionType);
+            benchmark::DoNotOptimize(BlackScholes::delta(g.spot, g.strike, g.rate, g.volatility, g.time, kind));
+            benchmark::DoNotOptimize(BlackScholes::gamma(g.spot, g.strike, g.rate, g.volatility, g.time));
+            benchmark::DoNotOptimize(BlackScholes::vega(g.spot, g.strike, g.rate, g.volatility, g.time));
+            benchmark::DoNotOptimize(BlackScholes::theta(g.spot, g.strike, g.rate, g.volatility, g.time, kind));
+            benchmark::DoNotOptimize(BlackScholes::rho(g.spot, g.strike, g.rate, g.volatility, g.time, kind));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * GREEKS_TEST_DATA.size());
+}
+BENCHMARK(BM_GreeksSeparate);
+
+static void BM_PriceAndGreeks(benchmark::State &state)
+{
+    for (auto _ : state)
+        for (const auto &g : GREEKS_TEST_DATA)
+            benchmark::DoNotOptimize(BlackScholes::priceAndGreeks(g.spot, g.strike, g.rate, g.volatility, g.time,
+                                                                  parseOptionKind(g.optionType)));
+    state.SetItemsProcessed(state.iterations() * GREEKS_TEST_DATA.size());
+}
+BENCHMARK(BM_PriceAndGreeks);
+
+// A 64 x 64 spot / expiry grid of calls, as a surface or a risk run revalues it
+struct AccuracyGrid
+{
+    std::vector<double> spots, times;
+
+    AccuracyGrid()
+    {
+        for (int i = 0; i < 64 * 64; ++i)
+        {
+            spots.push_back(60.0 + 80.0 * (i / 64) / 63.0);
+            times.push_back(0.05 + 2.0 * (i % 64) / 63.0);
+        }
+    }
+};
+
+template <Normal::Accuracy A>
+static void priceGrid(benchmark::State &state)
+{
+    const AccuracyGrid grid;
+    Normal::prepareTable();
+    for (auto _ : state)
+        for (std::size_t i = 0; i < grid.spots.size(); ++i)
+            benchmark::DoNotOptimize(
+                BlackScholes::price<OptionKind::Call, A>(grid.spots[i], 100.0, 0.05, 0.2, grid.times[i]));
+    state.SetItemsProcessed(state.iterations() * grid.spots.size());
+}
+
+// Price only (two normal CDFs per option) at each accuracy
+static void BM_PriceAccuracyExact(benchmark::State &state) { priceGrid<Normal::Accuracy::Exact>(state); }
+static void BM_PriceAccuracyFast(benchmark::State &state) { priceGrid<Normal::Accuracy::Fast>(state); }
+static void BM_PriceAccuracyTable(benchmark::State &state) { priceGrid<Normal::Accuracy::Table>(state); }
+BENCHMARK(BM_PriceAccuracyExact);
+BENCHMARK(BM_PriceAccuracyFast);
+BENCHMARK(BM_PriceAccuracyTable);
+
+// Price and Greeks over the same grid at each accuracy (0 exact, 1 fast, 2 table)
+static void BM_PriceAndGreeksAccuracy(benchmark::State &state)
+{
+    const auto accuracy = static_cast<Normal::Accuracy>(state.range(0));
+    const AccuracyGrid grid;
+    Normal::prepareTable();
+    for (auto _ : state)
+        for (std::size_t i = 0; i < grid.spots.size(); ++i)
+            benchmark::DoNotOptimize(BlackScholes::priceAndGreeks(grid.spots[i], 100.0, 0.05, 0.2, grid.times[i],
+                                                                  OptionKind::Call, accuracy));
+    state.SetItemsProcessed(state.iterations() * grid.spots.size());
+    state.SetLabel(Normal::toString(accuracy));
+}
+BENCHMARK(BM_PriceAndGreeksAccuracy)->DenseRange(0, 2);
+
+// N(x) and phi(x) over [-6, 6] at each accuracy
+static void BM_NormalEvaluate(benchmark::State &state)
+{
+    const auto accuracy = static_cast<Normal::Accuracy>(state.range(0));
+    Normal::prepareTable();
+    std::vector<double> xs(1024);
+    for (std::size_t i = 0; i < xs.size(); ++i)
+        xs[i] = -6.0 + 12.0 * ((i * 389) % xs.size()) / xs.size();
+    for (auto _ : state)
+        for (double x : xs)
+        {
+            benchmark::DoNotOptimize(Normal::cdf(x, accuracy));
+            benchmark::DoNotOptimize(Normal::pdf(x, accuracy));
+        }
+    state.SetItemsProcessed(state.iterations() * xs.size());
+    state.SetLabel(Normal::toString(accuracy));
+}
+BENCHMARK(BM_NormalEvaluate)->DenseRange(0, 2);
+
+// SIMD kernel over a strike chain; items are options
+static void BM_PriceAndGreeksBatch(benchmark::State &state)
+{
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<double> spots(n, 100.0), strikes(n), rates(n, 0.05), vols(n, 0.2), times(n, 1.0);
+    std::vector<OptionKind> kinds(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        strikes[i] = 50.0 + 100.0 * i / n;
+        kinds[i] = i % 2 ? OptionKind::Put : OptionKind::Call;
+    }
+    std::vector<double> price(n), delta(n), gamma(n), vega(n), theta(n), rho(n);
+    for (auto _ : state)
+    {
+        BlackScholes::priceAndGreeksBatch({spots.data(), strikes.data(), rates.data(), vols.data(), times.data(), kinds.data(), n},
+                                          {price.data(), delta.data(), gamma.data(), vega.data(), theta.data(), rho.data()});
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetLabel(BlackScholes::batchInstructionSet());
+}
+BENCHMARK(BM_PriceAndGreeksBatch)->Arg(64)->Arg(4096);
+
+// The same chain as calls only, price column only: the specialised kernel with no kind gather or Greeks
+static void BM_PriceBatch(benchmark::State &state)
+{
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<double> spots(n, 100.0), strikes(n), rates(n, 0.05), vols(n, 0.2), times(n, 1.0);
+    std::vector<OptionKind> kinds(n, OptionKind::Call);
+    for (std::size_t i = 0; i < n; ++i)
+        strikes[i] = 50.0 + 100.0 * i / n;
+    std::vector<double> price(n);
+    for (auto _ : state)
+    {
+        BlackScholes::priceAndGreeksBatch({spots.data(), strikes.data(), rates.data(), vols.data(), times.data(), kinds.data(), n},
+                                          {price.data(), nullptr, nullptr, nullptr, nullptr, nullptr});
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetLabel(BlackScholes::batchInstructionSet());
+}
+BENCHMARK(BM_PriceBatch)->Arg(64)->Arg(4096);
+
+// Implied vols back-solved from the batch kernel's own prices, smile from 15% to 45%
+static void BM_ImpliedVolBatch(benchmark::State &state)
+{
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<double> spots(n, 100.0), strikes(n), rates(n, 0.05), vols(n), times(n, 1.0), prices(n), implied(n);
+    std::vector<OptionKind> kinds(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        strikes[i] = 50.0 + 100.0 * i / n;
+        vols[i] = 0.15 + 0.3 * std::abs(strikes[i] - 100.0) / 50.0;
+        kinds[i] = strikes[i] < 100.0 ? OptionKind::Put : OptionKind::Call;
+    }
+    BlackScholes::priceAndGreeksBatch({spots.data(), strikes.data(), rates.data(), vols.data(), times.data(), kinds.data(), n},
+                                      {prices.data(), nullptr, nullptr, nullptr, nullptr, nullptr});
+    for (auto _ : state)
+    {
+        BlackScholes::impliedVolatilityBatch({prices.data(), spots.data(), strikes.data(), rates.data(), times.data(),
+                                              kinds.data(), n},
+                                             implied.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetLabel(BlackScholes::batchInstructionSet());
+}
+BENCHMARK(BM_ImpliedVolBatch)->Arg(64)->Arg(20000);
+
+static void BM_AmericanPrice(benchmark::State &state)
+{
+    const auto &c = EUROPEAN_OPTION_TEST_CASES.front();
+    const AmericanOption put(c.spot, c.strike, c.rate, c.volatility, c.time, OptionKind::Put,
+                             static_cast<int>(state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(put.price());
+}
+BENCHMARK(BM_AmericanPrice)->Arg(100)->Arg(500)->Arg(2000);
+
+// Lattice schemes at the step counts that give CRR-2000-like accuracy, then the closed forms
+static void BM_AmericanScheme(benchmark::State &state)
+{
+    const auto &c = EUROPEAN_OPTION_TEST_CASES.front();
+    const auto scheme = static_cast<AmericanModel>(state.range(0));
+    const AmericanOption put(c.spot, c.strike, c.rate, c.volatility, c.time, OptionKind::Put,
+                             static_cast<int>(state.range(1)), scheme);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(put.price());
+    state.SetLabel(toString(scheme));
+}
+BENCHMARK(BM_AmericanScheme)
+    ->Args({static_cast<int>(AmericanModel::CRR), 2000})
+    ->Args({static_cast<int>(AmericanModel::LeisenReimer), 601})
+    ->Args({static_cast<int>(AmericanModel::BBSR), 200})
+    ->Args({static_cast<int>(AmericanModel::Trinomial), 2000})
+    ->Args({static_cast<int>(AmericanModel::BaroneAdesiWhaley), 0})
+    ->Args({static_cast<int>(AmericanModel::BjerksundStensland), 0});
+
+// One lattice plus four bumped ones on the shared scheduler
+static void BM_AmericanGreeks(benchmark::State &state)
+{
+    const auto &c = EUROPEAN_OPTION_TEST_CASES.front();
+    const AmericanOption put(c.spot, c.strike, c.rate, c.volatility, c.time, OptionKind::Put,
+                             static_cast<int>(state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(put.greeks());
+}
+BENCHMARK(BM_AmericanGreeks)->Arg(100)->Arg(500)->Arg(2000)->UseRealTime();
+
+// The same put across 8 strikes in one americanSensitivitiesBatch call (batchLanes() trees per pass); per option
+static void BM_AmericanGreeksBatch(benchmark::State &state)
+{
+    const auto &c = EUROPEAN_OPTION_TEST_CASES.front();
+    const std::size_t n = 8;
+    std::vector<double> spots(n, c.spot), strikes(n), rates(n, c.rate), vols(n, c.volatility), times(n, c.time);
+    std::vector<OptionKind> kinds(n, OptionKind::Put);
+    for (std::size_t i = 0; i < n; ++i)
+        strikes[i] = c.strike * (0.9 + 0.025 * i);
+    std::vector<BinomialTree::LatticeSensitivities> out(n);
+    for (auto _ : state)
+    {
+        BinomialTree::americanSensitivitiesBatch({spots.data(), strikes.data(), rates.data(), vols.data(), times.data(),
+                                                  kinds.data(), n},
+                                                 static_cast<int>(state.range(0)), AmericanModel::CRR, out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetLabel(std::to_string(BinomialTree::batchLanes()) + " lanes");
+}
+BENCHMARK(BM_AmericanGreeksBatch)->Arg(100)->Arg(500)->Arg(2000)->UseRealTime();
+
+// A 41-strike put chain with all Greeks: one PDE solve (flat vol, arg 0) or one lane per strike (smile, arg 1)
+static void BM_AmericanChainFD(benchmark::State &state)
+{
+    const auto &c = EUROPEAN_OPTION_TEST_CASES.front();
+    const std::size_t n = 41;
+    std::vector<double> strikes(n), vols(n), times(n, c.time), price(n), delta(n), gamma(n), vega(n), theta(n), rho(n);
+    std::vector<OptionKind> kinds(n, OptionKind::Put);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        strikes[i] = c.spot * (0.8 + 0.01 * i);
+        vols[i] = c.volatility + (state.range(0) ? 0.002 * (20.0 - i) : 0.0);
+    }
+    for (auto _ : state)
+        FiniteDifference::americanChain({c.spot, c.rate, strikes.data(), vols.data(), times.data(), kinds.data(), n},
+                                        {price.data(), delta.data(), gamma.data(), vega.data(), theta.data(), rho.data()},
+                                        Scheduler::shared());
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_AmericanChainFD)->Arg(0)->Arg(1)->UseRealTime();
+
+// Strategy::payoff one spot at a time over a 1000-point plotting grid
+static void BM_StrategyPayoff(benchmark::State &state)
+{
+    const auto &c = EUROPEAN_OPTION_TEST_CASES.front();
+    const IronCondor condor(c.spot, 90.0, 110.0, 85.0, 115.0, c.rate, c.volatility, c.time);
+    std::vector<double> spots(1000);
+    for (std::size_t i = 0; i < spots.size(); ++i)
+        spots[i] = 50.0 + 100.0 * i / spots.size();
+    for (auto _ : state)
+        for (double spot : spots)
+            benchmark::DoNotOptimize(condor.payoff(spot));
+    state.SetItemsProcessed(state.iterations() * spots.size());
+}
+BENCHMARK(BM_StrategyPayoff);
+
+static void BM_StrategyPayoffGrid(benchmark::State &state)
+{
+    const auto &c = EUROPEAN_OPTION_TEST_CASES.front();
+    const IronCondor condor(c.spot, 90.0, 110.0, 85.0, 115.0, c.rate, c.volatility, c.time);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(condor.payoffGrid(50.0, 150.0, 1000));
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_StrategyPayoffGrid);
+
+// Greeks plus 10000-path Monte Carlo VaR / ES on short straddles, optionally hedged with an American put
+static void BM_PortfolioRisk(benchmark::State &state)
+{
+    RiskMeasures::Portfolio portfolio;
+    for (const auto &c : EUROPEAN_OPTION_TEST_CASES)
+    {
+        portfolio.push_back({std::make_shared<EuropeanOption>(c.spot, c.strike, c.rate, c.volatility, c.time, OptionKind::Call), -1});
+        portfolio.push_back({std::make_shared<EuropeanOption>(c.spot, c.strike, c.rate, c.volatility, c.time, OptionKind::Put), -1});
+    }
+    const bool american = state.range(0) != 0;
+    if (american)
+        portfolio.push_back({std::make_shared<AmericanOption>(100.0, 85.0, 0.05, 0.2, 0.5, OptionKind::Put, 200), 2});
+    for (auto _ : state)
+        benchmark::DoNotOptimize(RiskMeasures::calculatePortfolioRisk(portfolio));
+    state.SetLabel(american ? "with american leg" : "european");
+}
+BENCHMARK(BM_PortfolioRisk)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
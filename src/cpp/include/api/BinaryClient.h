@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "api/BinaryProtocol.h"
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        /**
+         * @class BinaryClient
+         * @brief One blocking BinaryProtocol connection to another server (POSIX only)
+         *
+         * Used by RiskCoordinator to talk to worker nodes: one request in
+         * flight at a time, each bounded by a deadline and abandonable from
+         * another thread. Transport failures (refused connection, timeout,
+         * peer closed, abandon) throw std::runtime_error and leave the client
+         * disconnected; the next call reconnects.
+         */
+        class BinaryClient
+        {
+        public:
+            struct Response
+            {
+                BinaryProtocol::Status status;
+                std::string payload;
+            };
+
+            // "host:port" for TCP or "unix:/path" for a unix domain socket
+            explicit BinaryClient(std::string address, std::size_t maxFrameBytes = 256u << 20);
+            ~BinaryClient();
+
+            BinaryClient(const BinaryClient &) = delete;
+            BinaryClient &operator=(const BinaryClient &) = delete;
+
+            /**
+             * Send one request and wait for its response until deadline.
+             * abandon, when given, is polled while waiting; setting it makes
+             * the call give up (the connection is dropped, as its answer
+             * would otherwise arrive in front of the next one's).
+             */
+            Response call(BinaryProtocol::Opcode opcode, std::string_view payload,
+                          std::chrono::steady_clock::time_point deadline,
+                          const std::atomic<bool> *abandon = nullptr);
+
+            // Connect now, giving up at deadline; call() otherwise connects on demand
+            void connect(std::chrono::steady_clock::time_point deadline);
+
+            bool connected() const { return fd_ >= 0; }
+            void close();
+
+            const std::string &address() const { return address_; }
+
+        private:
+            std::string address_;
+            std::size_t maxFrameBytes_;
+            int fd_ = -1;
+            std::uint32_t nextId_ = 1;
+        };
+
+    } // namespace API
+} // namespace OptionPricer
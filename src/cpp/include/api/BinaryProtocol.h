@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "api/JsonSerializer.h"
+#include "api/RequestArena.h"
+#include "models/MonteCarloRisk.h"
+#include "models/OptionGreeks.h"
+#include "options/OptionContract.h"
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        /**
+         * Length-prefixed binary request/response protocol for co-located
+         * clients; see BinaryServer for the TCP and unix socket transport.
+         *
+         * Requests decode into the same typed structs as the JSON API and are
+         * priced by the same PricingEndpoint code, so both front ends return
+         * the same numbers. Connections are pipelined: a client may send any
+         * number of requests without waiting, and responses come back in
+         * request order. Every complete frame that arrives in one read is
+         * answered together (price requests among them as one deduplicated
+         * batch) and the responses leave in one write.
+         *
+         * Frame layout, all integers little-endian, float64 as IEEE-754 bits:
+         *   u32  length   bytes after this field (8 + payload)
+         *   u32  id       chosen by the client, echoed in the response
+         *   u16  opcode   Opcode below; echoed
+         *   u16  status   0 in requests; Status in responses
+         *   payload
+         *
+         * Records:
+         *   option  (48 bytes): u8 kind (0 call, 1 put), u8 model (0 european,
+         *           1 american, 2 american_lr, 3 american_bbsr,
+         *           4 american_trinomial, 5 american_baw, 6 american_bjs,
+         *           7 american_fd),
+         *           u16 reserved, u32 steps, f64 spot, strike,
+         *           rate, volatility, time
+         *   leg     (40 bytes): u8 kind, u8 model, u16 reserved, i32 quantity,
+         *           u32 steps, u32 reserved, f64 strike, volatility, time
+         *   greeks  (48 bytes): f64 price, delta, gamma, vega, theta, rho
+         *   position (56 bytes): option record, i32 quantity, u32 reserved
+         *
+         * Payloads by opcode (request -> response):
+         *   Ping        empty -> empty
+         *   Price       option -> greeks
+         *   PriceBatch  u32 count, u32 reserved, count options ->
+         *               u32 count, u32 unique, count x (u32 status, u32 reserved,
+         *               greeks), u32 error count, per error u32 index, u32
+         *               length, message bytes
+         *   Portfolio   f64 spot, f64 rate, u32 payoff steps, u32 leg count,
+         *               legs -> ResponseWriter binary body ("OPRB")
+         *   RiskPartition  u64 begin, u64 end (paths of the run), u64 paths,
+         *               u64 seed, u8 sampling (0 pseudo, 1 antithetic,
+         *               2 sobol), u8 flags (1 taylor, 2 summarise), u8
+         *               accuracy (0 exact, 1 fast, 2 table), u8 reserved,
+         *               u32 position count, f64 horizon, drift,
+         *               spot volatility, vol of vol, correlation, gamma
+         *               threshold, compression, positions ->
+         *               u64 begin, u64 end, f64 base value, u32 fully
+         *               revalued legs, u32 flags (2 summarised), then
+         *               (end - begin) x f64 P&L, or the summary: u64 paths,
+         *               f64 mean, f64 m2, u64 profitable, f64 compression,
+         *               f64 min loss, f64 max loss, u32 centroid count, u32
+         *               reserved, per centroid f64 mean, f64 weight
+         *
+         * An Error response carries the UTF-8 message as its whole payload.
+         * A frame over the size limit cannot be skipped safely, so the server
+         * closes the connection instead of answering it.
+         */
+        namespace BinaryProtocol
+        {
+
+            enum class Opcode : std::uint16_t
+            {
+                Ping = 0,
+                Price = 1,
+                PriceBatch = 2,
+                Portfolio = 3,
+                RiskPartition = 4
+            };
+
+            enum class Status : std::uint16_t
+            {
+                Ok = 0,
+                Error = 1
+            };
+
+            constexpr std::size_t HeaderBytes = 12;
+            constexpr std::size_t OptionRecordBytes = 48;
+            constexpr std::size_t LegRecordBytes = 40;
+            constexpr std::size_t GreeksRecordBytes = 48;
+            constexpr std::size_t PositionRecordBytes = 56;
+
+            struct Frame
+            {
+                std::uint32_t id;
+                std::uint16_t opcode;
+                std::uint16_t status;
+                std::string_view payload; // points into the input buffer
+            };
+
+            // One PriceBatch response entry
+            struct PriceResult
+            {
+                OptionGreeks greeks;
+                std::string error; // empty on success
+            };
+
+            /**
+             * One RiskPartition request: paths [begin, end) of a Monte Carlo
+             * run over fully resolved positions, so the worker needs no
+             * market data of its own
+             */
+            struct RiskTask
+            {
+                std::vector<std::pair<OptionContract, int>> positions;
+                MonteCarloRisk::Spec spec;
+                std::size_t begin = 0;
+                std::size_t end = 0;
+                bool summarise = false;
+                double compression = TDigest::DefaultCompression;
+            };
+
+            /**
+             * Split the next complete frame off the front of input. Returns
+             * false, leaving input untouched, when the frame has not fully
+             * arrived. Throws std::length_error for a frame whose length field
+             * is below the header size or above maxFrameBytes.
+             */
+            bool nextFrame(std::string_view &input, Frame &frame, std::size_t maxFrameBytes);
+
+            void appendFrame(std::string &out, std::uint32_t id, Opcode opcode, Status status,
+                             std::string_view payload);
+
+            // Request payloads, for clients
+            void appendOption(std::string &payload, const OptionParams &params);
+            std::string encodePriceBatch(const std::vector<OptionParams> &options);
+            std::string encodePortfolio(const PortfolioParams &params);
+            std::string encodeRiskTask(const RiskTask &task);
+
+            // Request decoding; malformed payloads throw std::invalid_argument
+            OptionParams decodeOption(std::string_view payload);
+            std::vector<OptionBatchItem> decodePriceBatch(std::string_view payload);
+            PortfolioParams decodePortfolio(std::string_view payload,
+                                            std::pmr::memory_resource *resource = RequestArena::resource());
+            RiskTask decodeRiskTask(std::string_view payload);
+
+            // Response decoding, for clients
+            OptionGreeks decodeGreeks(std::string_view payload);
+            std::vector<PriceResult> decodePriceBatchResults(std::string_view payload);
+            MonteCarloRisk::Partial decodeRiskPartial(std::string_view payload);
+
+            /**
+             * Answer every complete request frame at the front of input,
+             * appending the responses to output in request order. Returns the
+             * bytes consumed; a trailing partial frame is left for the next
+             * read. Throws std::length_error as nextFrame does.
+             */
+            std::size_t handleFrames(std::string_view input, std::string &output, std::size_t maxFrameBytes);
+
+        } // namespace BinaryProtocol
+    } // namespace API
+} // namespace OptionPricer
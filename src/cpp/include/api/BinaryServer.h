@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        /**
+         * @class BinaryServer
+         * @brief BinaryProtocol over TCP and unix domain sockets (POSIX only)
+         *
+         * Each connection is served by its own thread, like a kept-alive HTTP
+         * connection. The thread reads whatever has arrived, answers every
+         * complete frame in it with BinaryProtocol::handleFrames and sends
+         * all the responses with one write, so a pipelining client gets many
+         * requests per syscall in both directions. TCP connections have
+         * Nagle disabled.
+         *
+         * start() returns once the listeners are bound; stop() stops
+         * accepting, lets each connection answer the frames it has already
+         * read, then closes them.
+         */
+        class BinaryServer
+        {
+        public:
+            struct Config
+            {
+                std::string host = "127.0.0.1";        // co-located clients only by default
+                int port = -1;                         // TCP port; -1 disables TCP, 0 binds any free port
+                std::string unixPath;                  // unix socket path; empty disables it
+                std::size_t maxConnections = 64;       // further connections are closed on accept
+                std::size_t maxFrameBytes = 32u << 20; // larger frames close the connection
+                std::size_t readBytes = 1 << 16;       // receive buffer growth per read
+            };
+
+            explicit BinaryServer(const Config &config);
+            ~BinaryServer();
+
+            BinaryServer(const BinaryServer &) = delete;
+            BinaryServer &operator=(const BinaryServer &) = delete;
+
+            // Bind the configured listeners and start accepting; throws std::runtime_error
+            void start();
+
+            // Graceful shutdown; safe to call more than once
+            void stop();
+
+            bool isRunning() const { return running_.load(); }
+
+            // TCP port actually bound (differs from Config::port when that was 0); -1 without TCP
+            int port() const { return boundPort_; }
+
+            const Config &config() const { return config_; }
+
+        private:
+            struct Connection
+            {
+                int fd;
+                std::thread thread;
+                std::atomic<bool> done{false};
+            };
+
+            void acceptLoop(int listenFd, bool tcp);
+            void serve(Connection &connection);
+            void reapFinished();
+
+            Config config_;
+            std::atomic<bool> running_{false};
+            int boundPort_ = -1;
+            std::vector<int> listeners_;
+            int wakeFds_[2] = {-1, -1}; // written on stop() to wake the accept loops
+            std::vector<std::thread> acceptors_;
+
+            std::mutex connectionsMutex_;
+            std::list<std::unique_ptr<Connection>> connections_;
+        };
+
+    } // namespace API
+} // namespace OptionPricer
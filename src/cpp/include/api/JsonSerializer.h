@@ -1,7 +1,13 @@
 #pragma once
 
+#include <memory_resource>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <nlohmann/json.hpp>
+#include "api/RequestArena.h"
+#include "models/NormalDistribution.h"
 
 using json = nlohmann::json;
 
@@ -10,11 +16,86 @@ namespace OptionPricer
     namespace API
     {
 
+        // POST /api/price body
+        struct OptionParams
+        {
+            std::string type;               // "call" or "put"
+            std::string model = "european"; // "european", "american" or another american_* model
+            double spot = 0.0;
+            double strike = 0.0;
+            double rate = 0.0;
+            double volatility = 0.0;
+            double time = 0.0;
+            int steps = 100; // American lattice steps
+            Normal::Accuracy accuracy = Normal::Accuracy::Exact; // European normal CDF
+            // Market data name; spot, rate and volatility left out are NaN
+            // here and filled from the MarketDataStore snapshot when priced
+            std::string underlying;
+            double deadlineMs = 0.0; // time budget after arrival; 0 leaves the server's (RestServer::applyDeadline)
+        };
+
+        // One entry of a POST /api/price/batch body: its params, or why it failed to decode
+        struct OptionBatchItem
+        {
+            OptionParams params;
+            std::string error; // empty when params are valid
+        };
+
+        // POST /api/strategy/price body
+        struct StrategyParams
+        {
+            std::string strategy; // "straddle" or "strangle"
+            double spot = 0.0;
+            double rate = 0.0;
+            double volatility = 0.0;
+            double time = 0.0;
+            std::optional<double> strike;
+            std::optional<double> strikeCall; // strangle; defaults to strike + 5
+            std::optional<double> strikePut;  // strangle; defaults to strike - 5
+            bool isLong = true;
+        };
+
+        // One entry of a portfolio "legs" array; spot and rate come from the request
+        struct LegParams
+        {
+            std::string optionType = "call";
+            std::string model = "european"; // the leg's "type" field
+            double strike = 0.0;
+            double volatility = 0.0; // NaN when left to the portfolio's underlying
+            double time = 0.0;
+            int quantity = 1;
+            int steps = 100;
+        };
+
+        using LegArray = std::pmr::vector<LegParams>;
+
+        // POST /api/portfolio/price body
+        struct PortfolioParams
+        {
+            PortfolioParams() = default;
+            // legs allocate from resource (a request arena); a pmr vector keeps
+            // its allocator for life, so it cannot be assigned in afterwards
+            explicit PortfolioParams(std::pmr::memory_resource *resource) : legs(resource) {}
+
+            double spot = 0.0;
+            double rate = 0.0;
+            int payoffSteps = 100;
+            bool stream = false;
+            LegArray legs;
+            std::string underlying; // as in OptionParams: fills spot, rate and leg volatilities
+            double deadlineMs = 0.0; // as in OptionParams
+        };
+
         /**
          * @class JsonSerializer
          * @brief JSON serialization/deserialization for API communication
          *
-         * Converts between C++ objects and JSON for REST API requests/responses.
+         * Requests are decoded with a SAX handler straight into the typed
+         * structs above, so a large legs array never becomes a DOM. Unknown
+         * keys are skipped; missing required fields, mistyped values and
+         * malformed JSON throw std::invalid_argument. parse* reads a request
+         * body; decode* replays an already-parsed DOM through the same
+         * handler, so both accept and reject exactly the same requests.
          */
         class JsonSerializer
         {
@@ -49,20 +130,38 @@ namespace OptionPricer
             static json serializeError(const std::string &message, const std::string &code = "error");
 
             /**
-             * Deserialize option parameters from JSON request
+             * Option parameters from a request body or DOM
+             */
+            static OptionParams parseOptionParams(std::string_view body);
+            static OptionParams decodeOptionParams(const json &request);
+
+            /**
+             * Price batch from a JSON array or NDJSON body, or from a DOM array;
+             * entries that fail to decode carry their error instead of failing
+             * the batch
+             */
+            static std::vector<OptionBatchItem> parseOptionBatch(std::string_view body);
+            static std::vector<OptionBatchItem> decodeOptionBatch(const json &request);
+
+            /**
+             * Strategy parameters from a request body or DOM
+             */
+            static StrategyParams parseStrategyParams(std::string_view body);
+            static StrategyParams decodeStrategyParams(const json &request);
+
+            /**
+             * Portfolio parameters; the legs array is allocated from
+             * resource, the current request's arena by default
              */
-            static void deserializeOptionParams(const json &request,
-                                                double &S, double &K, double &r,
-                                                double &sigma, double &T, std::string &type);
+            static PortfolioParams parsePortfolioParams(
+                std::string_view body, std::pmr::memory_resource *resource = RequestArena::resource());
+            static PortfolioParams decodePortfolioParams(
+                const json &request, std::pmr::memory_resource *resource = RequestArena::resource());
 
             /**
-             * Deserialize strategy parameters from JSON request
+             * Decode a single portfolio leg object
              */
-            static void deserializeStrategyParams(const json &request,
-                                                  std::string &strategyName,
-                                                  double &S, double &K1, double &K2,
-                                                  double &r, double &sigma, double &T,
-                                                  bool &isLong);
+            static LegParams decodeLegParams(const json &leg);
         };
 
     } // namespace API
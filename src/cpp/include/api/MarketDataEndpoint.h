@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <nlohmann/json.hpp>
+#include "market/MarketData.h"
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        using json = nlohmann::json;
+
+        /**
+         * @class MarketDataEndpoint
+         * @brief JSON front end of MarketDataStore::shared()
+         *
+         * Pricing requests name an underlying with "underlying" instead of
+         * sending spot, rate and volatility; see PricingEndpoint. Unknown
+         * names throw std::out_of_range here (404), std::invalid_argument
+         * when a pricing request names them (400).
+         */
+        class MarketDataEndpoint
+        {
+        public:
+            /**
+             * Add or replace an underlying
+             *
+             * Request JSON format:
+             * {
+             *   "spot": 100.0,
+             *   "rate": 0.05,                       // flat, or a zero curve:
+             *   "rates": {"times": [0.25, 1, 5], "rates": [0.04, 0.045, 0.05]},
+             *   "volatility": 0.2,                  // flat, or a surface:
+             *   "surface": {
+             *     "type": "grid",
+             *     "expiries": [0.5, 1.0],
+             *     "moneyness": [0.8, 1.0, 1.2],     // strike / forward
+             *     "vols": [[0.25, 0.2, 0.22], [0.24, 0.2, 0.21]]  // one row per expiry
+             *   }
+             *   // or {"type": "svi", "expiries": [...], "params": [[a, b, rho, m, s], ...]}
+             * }
+             *
+             * Fields left out keep the underlying's current values; a new
+             * underlying needs all three.
+             *
+             * Response: {"underlying": "SPX", "version": 7, "status": "success"}
+             */
+            static json handleUpdate(const std::string &name, const json &request);
+
+            // One underlying in the update format, plus "name"
+            static json handleGet(const std::string &name);
+
+            // {"version": 7, "underlyings": [{"name", "spot", "surface", "expiries"}, ...], "status"}
+            static json handleList();
+
+            static json handleErase(const std::string &name);
+
+            // Map a market file (MarketDataStore layout): {"loaded": 3, "version": 8, "status"}
+            static json handleLoad(const std::string &path);
+
+            // Underlying from an update request on top of current (null for a new one)
+            static Underlying parseUnderlying(const std::string &name, const json &request, const Underlying *current);
+
+            static json toJson(const Underlying &underlying);
+        };
+
+    } // namespace API
+} // namespace OptionPricer
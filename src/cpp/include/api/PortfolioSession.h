@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "api/PricingEndpoint.h"
+#include "strategy/Strategy.h"
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        /**
+         * @class PortfolioSession
+         * @brief Server-side portfolio that is edited in place
+         *
+         * Holds the Strategy and every leg's price and Greeks. A patch
+         * reprices only the legs it touches (all of them when spot or rate
+         * moves), then re-reduces the totals and payoff in leg order, so the
+         * state always equals a fresh /api/portfolio/price of the same book.
+         * Not thread-safe; SessionStore serialises access per session.
+         */
+        class PortfolioSession
+        {
+        public:
+            // Request as for PricingEndpoint::handlePortfolioRequest
+            explicit PortfolioSession(const json &request);
+
+            /**
+             * Apply a patch and return only what changed:
+             * {
+             *   "spot": 101.0, "rate": 0.04, "payoff_steps": 200,   // optional
+             *   "legs": [
+             *     {"index": 1, "strike": 105, "quantity": -2},       // edit leg 1
+             *     {"optionType": "put", "strike": 90, ...}           // no index: append
+             *   ]
+             * }
+             * The response carries version, the changed legs (with their
+             * index) and portfolio totals / payoff when they moved. An
+             * invalid patch throws and leaves the session untouched.
+             */
+            json apply(const json &patch);
+
+            // Full state in the /api/portfolio/price response shape
+            json snapshot() const;
+
+            std::uint64_t version() const { return version_; }
+
+        private:
+            struct SessionLeg
+            {
+                json spec; // leg request fields as last patched
+                PricingEndpoint::LegInput input;
+                OptionGreeks greeks;
+            };
+
+            json legJson(std::size_t index) const;
+            json totalsJson() const;
+            json payoffJson() const;
+            void reduce();
+
+            double spot_;
+            double rate_;
+            int payoffSteps_;
+            std::vector<SessionLeg> legs_;
+            Strategy strategy_;
+            OptionGreeks totals_{};
+            std::vector<double> payoffSpots_;
+            std::vector<double> payoffs_;
+            std::uint64_t version_ = 1;
+        };
+
+        /**
+         * @class SessionStore
+         * @brief Thread-safe registry of portfolio sessions
+         *
+         * Sessions are addressed by a random id. Requests on different
+         * sessions run concurrently; requests on one session are applied in
+         * arrival order. Beyond the capacity the least recently used session
+         * is dropped. Unknown ids throw std::out_of_range.
+         */
+        class SessionStore
+        {
+        public:
+            explicit SessionStore(std::size_t capacity = DefaultCapacity);
+
+            // Create from a portfolio request; the snapshot carries the new "session" id
+            json create(const json &request);
+            json apply(const std::string &id, const json &patch);
+            json snapshot(const std::string &id);
+            void erase(const std::string &id);
+
+            std::size_t size() const;
+
+            static constexpr std::size_t DefaultCapacity = 1024;
+
+            // Process-wide store used by the HTTP server
+            static SessionStore &shared();
+
+        private:
+            struct Entry
+            {
+                std::mutex mutex;
+                PortfolioSession session;
+                std::uint64_t lastUsed;
+
+                explicit Entry(const json &request) : session(request), lastUsed(0) {}
+            };
+
+            std::shared_ptr<Entry> find(const std::string &id);
+
+            std::size_t capacity_;
+            mutable std::mutex mutex_;
+            std::unordered_map<std::string, std::shared_ptr<Entry>> sessions_;
+            std::uint64_t clock_ = 0;
+            std::uint64_t nextId_;
+        };
+
+    } // namespace API
+} // namespace OptionPricer
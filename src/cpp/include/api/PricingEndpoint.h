@@ -1,11 +1,22 @@
 #pragma once
 
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
 #include <nlohmann/json.hpp>
+#include "api/JsonSerializer.h"
+#include "api/RequestArena.h"
+#include "api/ResponseWriter.h"
+#include "models/MonteCarloRisk.h"
 #include "options/Option.h"
+#include "options/OptionContract.h"
 #include "strategy/Strategy.h"
 
 namespace OptionPricer
 {
+    class MarketSnapshot;
+
     namespace API
     {
 
@@ -24,7 +35,10 @@ namespace OptionPricer
              * Request JSON format:
              * {
              *   "type": "call" | "put",
-             *   "model": "european" | "american",  // optional, defaults to european
+             *   "model": "european" | "american"   // optional, defaults to european
+             *          | "american_lr" | "american_bbsr" | "american_trinomial",
+             *   "steps": 100,                      // lattice steps, American models only
+             *   "accuracy": "exact",               // or "fast", "table": normal CDF, european only
              *   "spot": 100.0,
              *   "strike": 100.0,
              *   "rate": 0.05,
@@ -40,10 +54,53 @@ namespace OptionPricer
              *   "vega": 39.45,
              *   "theta": -6.41,
              *   "rho": 53.23,
-             *   "model": "european" | "american"
+             *   "model": the request's model,
+             *   "accuracy": "fast"                 // only when not exact
              * }
              */
             static json handlePriceRequest(const json &request);
+            static json handlePriceRequest(const OptionParams &params);
+
+            /**
+             * Handle a batch of independent price requests
+             *
+             * Request: a JSON array of price request objects (NDJSON is
+             * decoded by JsonSerializer::parseOptionBatch into the same items)
+             *
+             * Response JSON format:
+             * {
+             *   "results": [ ... ],  // one handlePriceRequest response or error object per entry, in order
+             *   "count": 3,
+             *   "unique": 2,         // distinct contracts actually priced
+             *   "partial": true,     // only when cancelled part way; entries not reached are errors
+             *   "status": "success"
+             * }
+             *
+             * Identical entries are priced once. European contracts run through
+             * the SIMD chain kernel and American ones through the Greeks cache,
+             * both spread across the scheduler.
+             */
+            static json handlePriceBatchRequest(const json &request);
+            static json handlePriceBatchRequest(const std::vector<OptionBatchItem> &items);
+
+            // Typed result of a price batch, shared by the JSON and binary front ends
+            struct BatchPricing
+            {
+                static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+                std::vector<OptionContract> contracts; // distinct contracts priced
+                std::vector<OptionGreeks> greeks;      // one per contract
+                std::vector<std::size_t> slot;         // per entry: its contract, or npos
+                std::vector<std::string> errors;       // per entry: why it has no contract
+                std::string cancelled;                 // why pricing stopped early; empty when it did not
+            };
+
+            /**
+             * Deduplicate and price a batch; per-entry failures are recorded,
+             * not thrown. If the calling work is cancelled, contracts not yet
+             * priced keep NaN Greeks and cancelled says why.
+             */
+            static BatchPricing priceBatch(const std::vector<OptionBatchItem> &items);
 
             /**
              * Handle strategy pricing request
@@ -64,6 +121,7 @@ namespace OptionPricer
              * Response: Same structure as price request, but aggregated
              */
             static json handleStrategyRequest(const json &request);
+            static json handleStrategyRequest(const StrategyParams &params);
 
             /**
              * Handle Greeks surface request for plotting
@@ -76,23 +134,43 @@ namespace OptionPricer
              *   "volatility": 0.2,
              *   "spot_range": [90, 110],
              *   "time_range": [0.1, 2.0],
-             *   "steps": 10
+             *   "steps": 10,                        // or spot_steps / time_steps, up to 1000 each
+             *   "fields": ["delta", "gamma", "vega"], // any of price, delta, gamma, vega, theta, rho
+             *   "accuracy": "fast"                   // default; "table" is the same kernel, "exact"
+             *                                        // the scalar closed form (see GreeksSurface::Spec)
+             * }
+             *
+             * Response (columnar, row-major over spot then time):
+             * {
+             *   "spots": [...], "times": [...],
+             *   "shape": [spots.size(), times.size()],
+             *   "layout": "spot_major", "accuracy": "fast",
+             *   "delta": [...], "gamma": [...], "vega": [...],
+             *   "status": "success"
              * }
              *
-             * Response: 3D surface data for visualization
+             * A surface cancelled part way keeps the tiles that finished, has
+             * null elsewhere, and adds "partial": true and "completed_points".
              */
             static json handleGreeksSurface(const json &request);
 
             /**
              * Handle multi-leg portfolio pricing request
              *
+             * Legs are priced in parallel on Scheduler::shared() and reduced
+             * in leg order, so totals do not depend on the thread count. A
+             * request cancelled part way (see RestServer::registerAsyncRoute)
+             * returns the legs priced so far: the others have "priced":
+             * false, totals and payoff cover the priced legs only, and the
+             * portfolio carries "partial": true and "priced_legs".
+             *
              * Request JSON format:
              * {
              *   "spot": 100.0,
              *   "rate": 0.05,
              *   "legs": [
              *     {
-             *       "type": "european" | "american",
+             *       "type": "european" | "american" | "american_lr" | ...,  // as "model" above
              *       "optionType": "call" | "put",
              *       "strike": 100.0,
              *       "volatility": 0.2,
@@ -117,25 +195,193 @@ namespace OptionPricer
              *     "legs": [...],
              *     "payoff": {
              *       "spot_prices": [...],
-             *       "payoffs": [...]
+             *       "payoffs": [...],
+             *       "breakevens": [95.2, 104.8],   // exact, independent of payoff_steps
+             *       "kinks": [95.0, 105.0],
+             *       "max_profit": 4.8,             // null when unbounded
+             *       "max_loss": 0.2                // null when unbounded
              *     }
              *   }
              * }
              */
             static json handlePortfolioRequest(const json &request);
 
+            /**
+             * Monte Carlo VaR / ES of a portfolio over a horizon
+             *
+             * Request JSON format (spot, rate and legs as for the portfolio):
+             * {
+             *   "spot": 100.0, "rate": 0.05, "legs": [...],
+             *   "horizon": 0.004,            // years, default 1/252
+             *   "paths": 10000,              // up to 2,000,000
+             *   "sampling": "antithetic",    // or "pseudo", "sobol"
+             *   "seed": 0,
+             *   "spot_volatility": 0.2,      // default: mean leg volatility
+             *   "vol_of_vol": 0.0,           // lognormal implied-vol shocks
+             *   "correlation": 0.0,          // spot / vol shock correlation
+             *   "drift": 0.05,               // default: rate
+             *   "revaluation": "full",       // or "taylor" (delta-gamma-vega)
+             *   "gamma_threshold": 0.05,     // taylor: reprice legs with larger |gamma|
+             *   "accuracy": "exact",         // or "fast", "table": normal CDF of European legs
+             *   "confidence": [0.95, 0.99]
+             * }
+             *
+             * Response:
+             * {
+             *   "risk": {
+             *     "paths": 10000, "sampling": "antithetic", "horizon": 0.004,
+             *     "revaluation": "full", "accuracy": "exact", "fully_revalued_legs": 2,
+             *     "base_value": 20.9, "mean_pnl": -0.07, "stdev_pnl": 0.6,
+             *     "max_loss": 3.1, "probability_of_profit": 0.47,
+             *     "levels": [{"confidence": 0.95, "var": 1.2, "es": 1.6}, ...]
+             *   },
+             *   "status": "success"
+             * }
+             *
+             * The same seed gives the same numbers for any thread count.
+             */
+            static json handleRiskRequest(const json &request);
+
+            /**
+             * Handle option chain pricing request (batch SIMD kernel)
+             *
+             * Scalar fields apply to every strike; the optional arrays
+             * override them per strike and must match "strikes" in length.
+             * "model" defaults to "european"; "american_fd" prices the chain
+             * with one PDE solve per expiry, and the other American models
+             * price strike by strike. "steps" (default 100) applies to both.
+             *
+             * Request JSON format:
+             * {
+             *   "type": "call" | "put",
+             *   "spot": 100.0,
+             *   "rate": 0.05,
+             *   "volatility": 0.2,
+             *   "time": 1.0,
+             *   "strikes": [90.0, 95.0, 100.0, ...],
+             *   "model": "european" | "american_fd" | ..., // optional
+             *   "steps": 100,                       // optional, American only
+             *   "types": ["call", "put", ...],      // optional
+             *   "volatilities": [0.21, 0.2, ...],   // optional
+             *   "times": [1.0, 1.0, ...]            // optional
+             * }
+             *
+             * Response JSON format (columnar, one entry per strike):
+             * {
+             *   "count": 3,
+             *   "model": "european",
+             *   "instruction_set": "avx512" | "avx2" | "scalar", // european only
+             *   "strikes": [...],
+             *   "price": [...], "delta": [...], "gamma": [...],
+             *   "vega": [...], "theta": [...], "rho": [...]
+             * }
+             */
+            static json handleChainRequest(const json &request);
+
+            /**
+             * Handle batch implied-volatility request (SIMD kernel)
+             *
+             * Same layout as the chain request, with market prices in place of
+             * volatilities. Quotes outside the no-arbitrage bounds come back as
+             * null and are counted in "unsolved".
+             *
+             * Request JSON format:
+             * {
+             *   "type": "call" | "put",
+             *   "spot": 100.0,
+             *   "rate": 0.05,
+             *   "time": 1.0,
+             *   "strikes": [90.0, 95.0, 100.0, ...],
+             *   "prices": [14.2, 10.5, 7.1, ...],
+             *   "types": ["call", "put", ...],      // optional
+             *   "times": [1.0, 1.0, ...]            // optional
+             * }
+             *
+             * Response JSON format (columnar, one entry per strike):
+             * {
+             *   "count": 3,
+             *   "unsolved": 0,
+             *   "instruction_set": "avx512" | "avx2" | "scalar",
+             *   "strikes": [...],
+             *   "implied_volatility": [...]
+             * }
+             */
+            static json handleImpliedVolBatchRequest(const json &request);
+
+            /**
+             * Columnar forms of the surface, portfolio, chain and implied-vol
+             * handlers: same content, but numeric arrays stay std::vector<double>
+             * so the server can serialise them with ResponseWriter in any
+             * negotiated format.
+             * These throw on invalid input instead of returning an error object.
+             * With "stream": true the surface fields and portfolio payoff are
+             * generated columns, computed only as the writer reaches them.
+             */
+            static ColumnarResponse buildSurfaceResponse(const json &request);
+            static ColumnarResponse buildPortfolioResponse(const json &request);
+            static ColumnarResponse buildPortfolioResponse(const PortfolioParams &params);
+            static ColumnarResponse buildChainResponse(const json &request);
+            static ColumnarResponse buildImpliedVolResponse(const json &request);
+
+            // One parsed portfolio leg; parsing is shared with PortfolioSession
+            struct LegInput
+            {
+                OptionContract contract;
+                int quantity;
+                std::string optionType;
+                std::string model;
+            };
+
+            // Validate and build one leg of a portfolio-style request against spot and rate
+            static LegInput parseLeg(const json &legJson, double spot, double rate);
+            static LegInput parseLeg(const LegParams &leg, double spot, double rate);
+
+            // Validate and build the legs of a portfolio-style request (spot, rate, legs);
+            // the vector lives on the current request's arena unless told otherwise
+            static std::pmr::vector<LegInput> parseLegs(const json &request,
+                                                        std::pmr::memory_resource *resource = RequestArena::resource());
+            static std::pmr::vector<LegInput> parseLegs(const PortfolioParams &params,
+                                                        std::pmr::memory_resource *resource = RequestArena::resource());
+
+            // A parsed risk request: resolved positions, simulation spec and confidence levels
+            struct RiskRequest
+            {
+                std::vector<std::pair<OptionContract, int>> positions;
+                MonteCarloRisk::Spec spec;
+                std::vector<double> confidences;
+            };
+
+            // Validate a risk request (fields as for handleRiskRequest); throws std::invalid_argument
+            static RiskRequest parseRiskRequest(const json &request);
+
+            // The "risk" response of handleRiskRequest for a result of request
+            static json riskResponse(const RiskRequest &request, const MonteCarloRisk::Result &result);
+
+            // breakevens / kinks / max_profit / max_loss fields; unbounded extremes are null
+            static void addPayoffProfile(const Strategy &strategy, json &payoff);
+
         private:
+
             /**
-             * Create Option from JSON parameters
+             * Create an OptionContract from decoded pricing parameters; market
+             * supplies the inputs of a request naming an underlying (and may be
+             * null otherwise)
              */
-            static std::shared_ptr<Option> createOptionFromJson(const json &params);
+            static OptionContract contractFrom(const OptionParams &params, const MarketSnapshot *market);
+
+            // Positivity check and model selection shared by single options and legs
+            static OptionContract makeContract(OptionKind kind, const std::string &model, double spot,
+                                               double strike, double rate, double volatility,
+                                               double time, int steps);
 
             /**
              * Build Greeks response object
-             * @param model "european" or "american" — echoed back in the response
+             * @param model "european", "american" or another american_* model — echoed back in the response
              */
-            static json buildGreeksResponse(const std::shared_ptr<Option> &option,
+            static json buildGreeksResponse(const OptionContract &contract,
                                             const std::string &model = "european");
+            static json buildGreeksResponse(const OptionContract &contract, const OptionGreeks &greeks,
+                                            const std::string &model);
         };
 
     } // namespace API
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        /**
+         * @class RequestArena
+         * @brief Per-thread monotonic memory for one request's temporaries
+         *
+         * Each server thread owns a fixed buffer. A Scope opens it at the
+         * start of a request and rewinds it at the end, so parsed legs,
+         * per-leg results and the priced Strategy cost a pointer bump
+         * instead of malloc / free. A request that outgrows the buffer
+         * continues on the heap until its Scope ends.
+         *
+         * Memory from resource() is valid only until the outermost Scope on
+         * this thread closes; anything that outlives the handler (streamed
+         * generators, sessions) must use the default resource. Only the
+         * thread that opened the Scope may allocate from it.
+         */
+        class RequestArena
+        {
+        public:
+            class Scope
+            {
+            public:
+                Scope();
+                ~Scope();
+                Scope(const Scope &) = delete;
+                Scope &operator=(const Scope &) = delete;
+            };
+
+            // Current request's arena, or the default resource outside any Scope
+            static std::pmr::memory_resource *resource();
+
+            // Allocate and fault in this thread's buffer now rather than in its first request
+            static void prepare();
+
+            static constexpr std::size_t BufferBytes = 256u << 10;
+        };
+
+    } // namespace API
+} // namespace OptionPricer
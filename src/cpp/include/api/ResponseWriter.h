@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        using json = nlohmann::json;
+
+        /**
+         * @struct ColumnarResponse
+         * @brief Response split into small metadata and large numeric columns
+         *
+         * meta holds everything that is cheap to keep as a json DOM (status,
+         * scalars, per-leg objects). Columns are float64 arrays addressed by a
+         * dotted path such as "portfolio.payoff.spot_prices"; every parent
+         * object on the path must already exist in meta. Writers serialise the
+         * columns straight from the vectors without building json arrays.
+         *
+         * A column is either materialised (values) or generated: the writer
+         * asks the generator for one block of values at a time, so large
+         * results can be streamed with bounded memory.
+         */
+        struct ColumnarResponse
+        {
+            // Fill out[0 .. end-begin) with the column values at indices [begin, end)
+            using Generator = std::function<void(std::size_t begin, std::size_t end, double *out)>;
+
+            struct Column
+            {
+                std::string path;
+                std::size_t size;
+                std::vector<double> values; // empty when generated
+                Generator generate;
+            };
+
+            json meta = json::object();
+            std::vector<Column> columns;
+
+            void addColumn(std::string path, std::vector<double> values)
+            {
+                const std::size_t size = values.size();
+                columns.push_back({std::move(path), size, std::move(values), nullptr});
+            }
+
+            void addGeneratedColumn(std::string path, std::size_t size, Generator generate)
+            {
+                columns.push_back({std::move(path), size, {}, std::move(generate)});
+            }
+
+            // Full json DOM with the columns spliced into meta (legacy handlers, tests)
+            json toJson() const;
+        };
+
+        namespace ResponseWriter
+        {
+
+            enum class Format
+            {
+                Json,    // compact application/json (default)
+                MsgPack, // application/x-msgpack; columns as arrays of float64
+                Binary   // application/octet-stream; layout below
+            };
+
+            /*
+             * Binary layout, all integers little-endian:
+             *   char[4]  magic "OPRB"
+             *   u16      version (1)
+             *   u16      column count
+             *   u32      meta length, then compact meta JSON (no columns)
+             *   per column:
+             *     u16 path length, path bytes (dotted, as in ColumnarResponse)
+             *     u64 value count
+             *     zero padding to an 8-byte boundary
+             *     value count float64 values
+             * Numeric payloads are 8-byte aligned relative to the start of
+             * the body, so clients can map them directly (numpy.frombuffer).
+             */
+
+            // Receives consecutive pieces of the body; return false to abort
+            using Sink = std::function<bool(const char *data, std::size_t size)>;
+
+            /**
+             * Pick a format from an HTTP Accept header. The first recognised
+             * media range wins; anything else (including * / *) yields Json.
+             */
+            Format negotiate(const std::string &accept);
+
+            const char *contentType(Format format);
+
+            // Serialise the whole body into one string
+            std::string write(const ColumnarResponse &response, Format format);
+
+            /**
+             * Serialise incrementally, handing sink pieces of about chunkBytes.
+             * Generated columns are evaluated one block at a time between
+             * pieces. Returns false if the sink aborted.
+             */
+            bool write(const ColumnarResponse &response, Format format, const Sink &sink,
+                       std::size_t chunkBytes = 1 << 16);
+
+            // Append one float64 array as JSON text
+            void appendJsonArray(std::string &out, const double *values, std::size_t count);
+
+        } // namespace ResponseWriter
+    } // namespace API
+} // namespace OptionPricer
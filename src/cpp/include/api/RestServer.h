@@ -1,10 +1,19 @@
 #pragma once
 
-#include <string>
+#include <atomic>
+#include <cstddef>
 #include <functional>
-#include <map>
 #include <memory>
+#include <string>
 #include <nlohmann/json.hpp>
+#include "api/ResponseWriter.h"
+
+namespace httplib
+{
+    class Server;
+    struct Request;
+    struct Response;
+} // namespace httplib
 
 namespace OptionPricer
 {
@@ -15,43 +24,125 @@ namespace OptionPricer
 
         // Request/Response handler types
         using RequestHandler = std::function<json(const json &)>;
+        using RouteHandler = std::function<void(const httplib::Request &, httplib::Response &)>;
 
         /**
          * @class RestServer
-         * @brief Lightweight REST API server for option pricing
+         * @brief HTTP server layer for the pricing API, on top of cpp-httplib
          *
-         * Provides HTTP endpoints for:
-         * - Single option pricing: POST /api/price
-         * - Strategy pricing: POST /api/strategy/price
-         * - Greeks calculation: GET /api/greeks
-         * - Implied volatility: POST /api/iv
+         * Every route registered here gets the same treatment: CORS headers,
+         * preflight handling, exceptions mapped to the standard
+         * {"error", "status": "error"} body (std::out_of_range -> 404, any
+         * other std::exception -> 400), and a Metrics::RequestTimer under
+         * its method and pattern. Worker count, keep-alive, connection
+         * backpressure and request size all come from Config, so they are
+         * tuned in one place.
          *
-         * Note: This is a simplified REST interface. In production, use cpp-httplib or Crow framework.
+         * cpp-httplib serves a connection on one worker for its whole
+         * keep-alive lifetime. At most `workers` connections are served at
+         * once and `maxQueued` more wait; connections beyond that are closed
+         * on accept rather than piling up.
+         *
+         * Heavy routes are registered async: their handler runs as a task on
+         * the shared Scheduler under a CancellationToken, while the HTTP
+         * worker only waits, watching the request's deadline and its
+         * client. A slow request holds a worker for at most its deadline
+         * plus cancelGraceMs, and a client that hangs up frees its worker at
+         * once; in both cases the pricing work stops at its next
+         * checkpoint instead of running to completion for nobody.
+         *
+         * Routes must be registered before start().
          */
         class RestServer
         {
         public:
+            struct Config
+            {
+                std::string host = "0.0.0.0";
+                int port = 8080;                          // 0 binds any free port; see port()
+                std::size_t workers = 0;                  // HTTP worker threads; 0 = max(8, cores - 1)
+                std::size_t maxQueued = 256;              // accepted connections waiting for a worker; 0 = unbounded
+                std::size_t keepAliveRequests = 100;      // per connection; 1 disables keep-alive
+                int keepAliveTimeoutSec = 5;              // idle time before a kept-alive connection closes
+                std::size_t maxRequestBytes = 32u << 20;  // larger bodies get 413
+                int readTimeoutSec = 5;
+                int writeTimeoutSec = 5;
+                int requestTimeoutMs = 30000;             // async routes: deadline of every request; 0 = none
+                int cancelGraceMs = 50;                   // past a deadline, time left to return a partial result
+                int disconnectPollMs = 10;                // how often a waiting async route checks its client
+            };
+
             RestServer(int port = 8080);
+            explicit RestServer(const Config &config);
             ~RestServer();
 
+            RestServer(const RestServer &) = delete;
+            RestServer &operator=(const RestServer &) = delete;
+
             /**
              * Register a request handler for a specific endpoint
              * @param endpoint HTTP endpoint path (e.g., "/api/price")
-             * @param method HTTP method ("GET", "POST")
-             * @param handler Function that processes JSON request and returns JSON response
+             * @param method HTTP method ("GET", "POST", "PATCH", "DELETE")
+             * @param handler Function that processes JSON request and returns JSON response.
+             *                POST / PATCH bodies are parsed as JSON; GET and DELETE pass the
+             *                query parameters as strings. A response with an "error" field
+             *                is sent as 400. The handler is timed as the price phase.
              */
             void registerEndpoint(const std::string &endpoint,
                                   const std::string &method,
                                   RequestHandler handler);
 
+            /**
+             * Register a handler that reads the raw request and writes the response,
+             * for bodies decoded without a DOM and for non-JSON or streamed output.
+             * The handler marks Metrics::Phase::Price itself once the body is decoded;
+             * sendJson / sendColumnar mark the serialize phase.
+             * @param pattern httplib path pattern; regex captures are in req.matches
+             */
+            void registerRoute(const std::string &method, const std::string &pattern, RouteHandler handler);
+
+            /**
+             * Register a route whose handler runs on Scheduler::shared(), off
+             * the HTTP worker. The handler gets its own copy of the request
+             * (without regex captures) and response, so it may outlive the
+             * connection, and runs with a CancellationToken current whose
+             * deadline is Config::requestTimeoutMs, shortened by a
+             * deadline_ms query parameter or applyDeadline().
+             *
+             * At the deadline the token is cancelled. A handler that returns
+             * within cancelGraceMs is answered as usual, so one that returns
+             * partial results gets them through; if it failed, or is still
+             * running, the answer is 504 with the standard error body. When
+             * the client disconnects the token is cancelled and the worker
+             * returns at once. The handler's phases are timed on the worker
+             * and joined into the request's; time queued for a worker counts
+             * as price. With a one-thread scheduler the handler runs on the HTTP
+             * worker itself: deadlines still stop it at checkpoints, but a
+             * disconnect goes unnoticed until it returns.
+             */
+            void registerAsyncRoute(const std::string &method, const std::string &pattern, RouteHandler handler);
+
+            // registerEndpoint's JSON handling on an async route; a "deadline_ms" body field is applied too
+            void registerAsyncEndpoint(const std::string &endpoint, const std::string &method, RequestHandler handler);
+
+            /**
+             * Shorten the deadline of the async request running on this
+             * thread to deadlineMs after its arrival. 0 keeps the current
+             * deadline; outside an async route the value is only validated.
+             * Throws std::invalid_argument when negative or not a number.
+             */
+            static void applyDeadline(double deadlineMs);
+
             /**
              * Start the server (blocking call)
-             * Server will listen on http://localhost:<port>
+             * Listens on host:port until stop(); throws std::runtime_error if the
+             * address cannot be bound
              */
             void start();
 
             /**
-             * Stop the server gracefully
+             * Stop the server gracefully: stop accepting, finish the requests in
+             * flight, then return from start(). Safe to call from any thread.
              */
             void stop();
 
@@ -61,10 +152,34 @@ namespace OptionPricer
              */
             bool isRunning() const;
 
+            // Block until start() is accepting connections
+            void waitUntilReady() const;
+
+            // Port actually bound (differs from Config::port when that was 0); 0 before start()
+            int port() const { return boundPort_.load(); }
+
+            const Config &config() const { return config_; }
+
+            // HTTP worker threads, with Config::workers = 0 resolved
+            std::size_t workerCount() const { return workerCount_; }
+
+            // Compact JSON body with the given status
+            static void sendJson(httplib::Response &res, const json &body, int status);
+            static void sendError(httplib::Response &res, const std::string &message, int status = 400);
+
+            /**
+             * Serialise a columnar result in the format requested by the Accept header.
+             * Streamed results go out with chunked transfer encoding as they are written,
+             * so the body is never held in memory as a whole.
+             */
+            static void sendColumnar(const httplib::Request &req, httplib::Response &res,
+                                     ColumnarResponse body, bool streamed);
+
         private:
-            int port_;
-            bool running_;
-            std::map<std::string, std::map<std::string, RequestHandler>> routes_;
+            Config config_;
+            std::size_t workerCount_ = 0;
+            std::unique_ptr<httplib::Server> server_;
+            std::atomic<int> boundPort_{0};
         };
 
     } // namespace API
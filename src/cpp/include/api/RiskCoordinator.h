@@ -0,0 +1,151 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "models/MonteCarloRisk.h"
+#include "options/OptionContract.h"
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        using json = nlohmann::json;
+
+        /**
+         * @class RiskCoordinator
+         * @brief Monte Carlo VaR / ES split across pricing_server worker nodes (POSIX only)
+         *
+         * A job is cut into partitions, either path ranges of the run or
+         * groups of positions, and each partition travels to a worker as one
+         * BinaryProtocol RiskPartition request carrying fully resolved
+         * contracts, so workers need no market data. Every registered worker
+         * gets a thread and a connection of its own and pulls partitions from
+         * a shared queue, so fast nodes take more of them.
+         *
+         * Path partitions return raw P&L, which concatenates into exactly the
+         * vector MonteCarloRisk::run builds locally (path i depends only on
+         * the seed and i), or, when summarised, a mergeable moments-plus-
+         * t-digest Summary whose size is independent of the path count;
+         * VaR and ES are then approximate beyond the digest's singleton
+         * tail. Position partitions return P&L over every path, summed per
+         * path.
+         *
+         * Stragglers: once the queue is empty, an idle worker re-runs a
+         * partition that has been running for longer than stragglerFactor
+         * times the median partition time (and at least minStragglerDelay);
+         * the first answer wins and the other call is abandoned. A worker
+         * whose connection fails is retired for the job and its partition
+         * goes back on the queue; a worker's Error answer (invalid input)
+         * fails the job.
+         */
+        class RiskCoordinator
+        {
+        public:
+            struct Config
+            {
+                std::size_t partitionsPerWorker = 4;  // path partitions queued per worker
+                std::size_t minPartitionPaths = 2048; // fewer partitions than that for small runs
+                double stragglerFactor = 2.0;         // re-issue beyond this multiple of the median time
+                std::chrono::milliseconds minStragglerDelay{250};
+                std::chrono::milliseconds partitionTimeout{600000}; // a call this slow retires its worker
+                std::chrono::milliseconds connectTimeout{2000};
+                std::size_t maxAttempts = 3; // runs of one partition, the first included
+            };
+
+            enum class Partitioning
+            {
+                Scenarios, // path ranges, every position
+                Positions  // groups of positions, every path
+            };
+
+            struct Job
+            {
+                std::vector<std::pair<OptionContract, int>> positions;
+                MonteCarloRisk::Spec spec;
+                std::vector<double> confidences;
+                Partitioning partitioning = Partitioning::Scenarios;
+                bool summarise = false; // t-digest summaries instead of raw P&L (Scenarios only)
+                double compression = TDigest::DefaultCompression;
+            };
+
+            struct WorkerReport
+            {
+                std::string address;
+                std::size_t partitions = 0; // answers used
+                double seconds = 0.0;       // time spent in calls
+                std::string error;          // why the worker was retired, if it was
+            };
+
+            struct Report
+            {
+                MonteCarloRisk::Result result;
+                std::size_t partitions = 0;
+                std::size_t reissued = 0;  // straggler re-runs started
+                bool approximate = false;  // VaR / ES read off merged digests
+                std::vector<WorkerReport> workers;
+            };
+
+            RiskCoordinator();
+            explicit RiskCoordinator(const Config &config);
+
+            // "host:port" or "unix:/path"; adding a registered address again does nothing
+            void addWorker(const std::string &address);
+            bool removeWorker(const std::string &address);
+            std::vector<std::string> workers() const;
+
+            /**
+             * Run job on the registered workers. Throws std::invalid_argument
+             * for an invalid job (or one a worker rejects) and
+             * std::runtime_error when no worker is registered or every one
+             * has failed. Safe to call from several threads at once. When
+             * the calling thread has a CancellationToken current, cancelling
+             * it abandons the calls in flight and throws OperationCancelled.
+             */
+            Report run(const Job &job) const;
+
+            const Config &config() const { return config_; }
+
+            // Coordinator of the server's distributed endpoints
+            static RiskCoordinator &shared();
+
+            /**
+             * Distributed Monte Carlo VaR / ES
+             *
+             * Request JSON format: as PricingEndpoint::handleRiskRequest, plus
+             * {
+             *   "partition": "scenarios",   // or "positions"
+             *   "summary": "pnl",           // or "tdigest" (scenarios only)
+             *   "compression": 500          // t-digest compression
+             * }
+             *
+             * Response: the PricingEndpoint::handleRiskRequest response with
+             * risk.distributed = {"partition", "summary", "partitions",
+             * "reissued", "approximate", "workers": [{"address",
+             * "partitions", "seconds", "error"?}, ...]}
+             */
+            static json handleRiskRequest(const json &request);
+
+            /**
+             * Registered workers, each pinged:
+             * {"workers": [{"address": "10.0.0.2:9001", "reachable": true,
+             *   "latency_ms": 0.2}, ...], "status": "success"}
+             */
+            static json handleWorkersRequest();
+
+            // Register a worker: {"address": "10.0.0.2:9001"}; answers as handleWorkersRequest
+            static json handleAddWorkerRequest(const json &request);
+
+        private:
+            Config config_;
+            mutable std::mutex mutex_;
+            std::vector<std::string> workers_;
+        };
+
+    } // namespace API
+} // namespace OptionPricer
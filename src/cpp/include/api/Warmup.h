@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        using json = nlohmann::json;
+
+        /**
+         * @class Warmup
+         * @brief Startup phase that brings a cold pricing_server up to speed
+         *
+         * prepare() does the one-time work a first request would otherwise
+         * pay for: the shared Scheduler's workers are started (and pinned,
+         * if asked), every one of them allocates and faults in its request
+         * arena, the normal CDF table and the SIMD kernel choice are built,
+         * and the shared caches and market store are created.
+         *
+         * run() then replays a request set against the running server over
+         * loopback, from several keep-alive connections at once (one fewer
+         * than the server's HTTP workers, in pricing_server), so the worker
+         * threads, their arenas and metrics slots are touched. The shared
+         * GreeksCache is bypassed meanwhile, so every round prices its legs
+         * afresh. The set is replayed in rounds until the p99 of a round
+         * stays within `tolerance` of the round before for `stableRounds`
+         * rounds running, or maxRounds is reached. Either way the server is
+         * then ready(); the report says whether it settled.
+         *
+         * Warm-up requests go through the normal routes. Before the server
+         * turns ready the cache is cleared and Metrics::reset(), so neither
+         * /metrics nor the cache counters include them (nor anything else
+         * served before ready).
+         */
+        class Warmup
+        {
+        public:
+            struct Config
+            {
+                std::size_t connections = 1; // concurrent clients; below the server's HTTP workers, so probes get one
+                int minRounds = 3;
+                int maxRounds = 30;          // 0 skips the replay: ready at once
+                int stableRounds = 2;        // consecutive rounds within tolerance
+                double tolerance = 0.15;     // of the previous round's p99
+                std::chrono::seconds budget{60}; // ready after this long, settled or not
+                bool pinThreads = false;         // pin Scheduler workers to CPUs in prepare()
+            };
+
+            // One request of the warm-up set
+            struct Request
+            {
+                std::string method; // GET or POST
+                std::string path;   // with any query string
+                std::string body;   // JSON, POST only
+            };
+
+            struct Report
+            {
+                int rounds = 0;
+                bool settled = false;
+                double p99Ms = 0.0;        // of the last round
+                std::size_t requests = 0;  // sent, over all rounds
+                std::size_t failures = 0;  // non-2xx answers and transport errors
+                std::size_t pinned = 0;    // Scheduler workers pinned to a CPU by prepare()
+                double seconds = 0.0;      // of the replay
+            };
+
+            explicit Warmup(const Config &config);
+
+            /**
+             * Process-wide one-time initialisation, before the server starts
+             * accepting; returns the number of Scheduler workers pinned (0
+             * unless Config::pinThreads, and always 0 off Linux)
+             */
+            std::size_t prepare();
+
+            /**
+             * Replay requests against the server at host:port (a wildcard
+             * host means loopback) until the p99 settles, then mark the
+             * server ready. Blocks; call it once the server is accepting
+             * connections. Never throws: transport errors count as failures.
+             */
+            Report run(const std::string &host, int port, const std::vector<Request> &requests);
+
+            bool ready() const { return ready_.load(std::memory_order_acquire); }
+
+            /**
+             * Readiness for load balancers:
+             * {"status": "warming"} until run() returns, then
+             * {"status": "ready", "warmup": {"rounds", "settled", "p99_ms",
+             *   "requests", "failures", "pinned_threads", "seconds"}}
+             */
+            json status() const;
+
+            /**
+             * Built-in warm-up set: every pricing model and endpoint at
+             * modest sizes, plus single prices against up to eight of the
+             * underlyings in the market store, so their snapshot data is
+             * read before the first real request
+             */
+            static std::vector<Request> defaultRequests();
+
+            /**
+             * Warm-up set from a file, one JSON object per line:
+             * {"method": "POST", "path": "/api/price", "body": {...}}.
+             * "method" defaults to POST when there is a body, GET otherwise.
+             * Blank lines are skipped. Throws std::runtime_error if the file
+             * cannot be read and std::invalid_argument for a malformed line.
+             */
+            static std::vector<Request> loadRequests(const std::string &path);
+
+        private:
+            Config config_;
+            std::size_t pinned_ = 0;
+            std::atomic<bool> ready_{false};
+            mutable std::mutex reportMutex_;
+            Report report_;
+        };
+
+    } // namespace API
+} // namespace OptionPricer
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace OptionPricer
+{
+
+    /**
+     * @class CancellationToken
+     * @brief Cooperative cancellation of one unit of work, with an optional deadline
+     *
+     * Whoever owns the work (RestServer, for an async route) cancels the
+     * token; the work notices at its next checkpoint. A token is made
+     * current on a thread by a Scope, and TaskGroup carries the submitter's
+     * token into every task it runs, so code deep in a pricing engine checks
+     * it without being handed anything. Scheduler::parallelFor and TaskGroup
+     * check it before each chunk of work; kernels that run long without
+     * spawning tasks (lattices, finite-difference grids) call checkpoint()
+     * themselves.
+     *
+     * The first reason given wins. A deadline turns into Reason::Deadline
+     * the first time cancelled() is asked after it has passed.
+     */
+    class CancellationToken
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        enum class Reason : std::uint8_t
+        {
+            None,
+            Deadline,     // the work's time budget ran out
+            Disconnected, // nobody is waiting for the result any more
+            Requested     // cancel() without a reason
+        };
+
+        // Starts the token's clock; no deadline until limit()
+        CancellationToken();
+
+        CancellationToken(const CancellationToken &) = delete;
+        CancellationToken &operator=(const CancellationToken &) = delete;
+
+        void cancel(Reason reason = Reason::Requested);
+
+        // Deadline budget after the token was created, unless an earlier one is set; ignored when not positive
+        void limit(std::chrono::milliseconds budget);
+
+        bool cancelled() const;
+        Reason reason() const { return reason_.load(std::memory_order_acquire); }
+        bool hasDeadline() const;
+
+        // Why the work stopped, for error responses ("Deadline of 200 ms exceeded")
+        std::string message() const;
+
+        // Throws OperationCancelled once cancelled()
+        void throwIfCancelled() const;
+
+        // Token of the work running on this thread; nullptr outside any Scope
+        static CancellationToken *current();
+
+        // Throws OperationCancelled if the current work has been cancelled; a
+        // thread-local load outside any Scope, and no clock read without a deadline
+        static void checkpoint();
+
+        /**
+         * Makes a token current on this thread until the Scope ends; Scopes
+         * nest, and a null token clears the current one
+         */
+        class Scope
+        {
+        public:
+            explicit Scope(CancellationToken *token);
+            ~Scope();
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            CancellationToken *previous_;
+        };
+
+    private:
+        static constexpr Clock::rep NoDeadline = Clock::duration::max().count();
+
+        Clock::time_point start_;
+        std::atomic<Clock::rep> deadline_{NoDeadline}; // since start_
+        mutable std::atomic<Reason> reason_{Reason::None};
+    };
+
+    /**
+     * Thrown by a checkpoint of cancelled work. Pricing handlers report it
+     * like any other failure; RestServer recognises cancelled work by its
+     * token and answers 504 (or not at all, once the client has gone).
+     */
+    class OperationCancelled : public std::runtime_error
+    {
+    public:
+        OperationCancelled(CancellationToken::Reason reason, const std::string &message)
+            : std::runtime_error(message), reason_(reason) {}
+
+        CancellationToken::Reason reason() const { return reason_; }
+
+    private:
+        CancellationToken::Reason reason_;
+    };
+
+} // namespace OptionPricer
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "concurrency/Cancellation.h"
+
+namespace OptionPricer
+{
+
+    /**
+     * @class Scheduler
+     * @brief Work-stealing task scheduler shared by all pricing endpoints
+     *
+     * Every worker owns a deque: it pushes and pops its own tasks at the back
+     * (depth-first, cache-warm) while idle workers steal from the front of
+     * other deques (oldest, usually largest, work first). Tasks submitted from
+     * outside the pool go to a shared injection queue. Threads blocked in
+     * TaskGroup::wait() execute pending tasks instead of sleeping, so nested
+     * parallelism (a portfolio leg spawning its own bumped revaluations)
+     * cannot deadlock.
+     *
+     * Tasks run under the CancellationToken current where they were
+     * submitted. Once it is cancelled, tasks not yet started throw
+     * OperationCancelled instead of running, so a cancelled request stops
+     * at its next chunk; results already written stay written.
+     */
+    class Scheduler
+    {
+    public:
+        using Task = std::function<void()>;
+
+        /**
+         * @param threads Total concurrency including the thread that waits;
+         *                0 means std::thread::hardware_concurrency()
+         */
+        explicit Scheduler(std::size_t threads);
+        ~Scheduler();
+
+        Scheduler(const Scheduler &) = delete;
+        Scheduler &operator=(const Scheduler &) = delete;
+
+        /**
+         * Run fn(i) for every i in [0, count), splitting the range recursively
+         * so idle workers steal the larger halves. Blocks until done and
+         * rethrows the first exception. Write results to per-index slots and
+         * reduce them in index order to keep output independent of threads.
+         * Checks the current CancellationToken before each grain.
+         * @param grain Largest range run as one task; 0 picks count / (8 * size())
+         */
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)> &fn,
+                         std::size_t grain = 0);
+
+        /**
+         * Run task on a worker and return at once, for work whose submitter
+         * waits on its own terms (RestServer's async routes). Posted tasks
+         * are taken only by idle workers, never by a thread helping in
+         * TaskGroup::wait, so one request never runs inside another's wait.
+         * With no workers (size() == 1) the task runs before post returns.
+         */
+        void post(Task task);
+
+        /**
+         * Run fn once on every worker and once on the calling thread, which
+         * must not be a worker, for per-thread setup (RequestArena buffers,
+         * at startup). Each worker
+         * holds its call until all have started one, so none runs it twice;
+         * this waits for every worker to be free. Rethrows the first
+         * exception once all calls have returned.
+         */
+        void runOnEachThread(const std::function<void()> &fn);
+
+        /**
+         * Pin worker i to the (i + 1)-th CPU this process may run on,
+         * wrapping, and leave the first to the threads outside the pool
+         * (HTTP workers). Returns how many workers were pinned: 0 off
+         * Linux or with a single CPU.
+         */
+        std::size_t pinWorkers();
+
+        // Total concurrency, including the waiting thread
+        std::size_t size() const { return workers_.size() + 1; }
+
+        // Tasks queued but not yet started, across all queues, posted ones included
+        std::size_t pending() const
+        {
+            return pending_.load(std::memory_order_relaxed) + posted_.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Process-wide scheduler. Sized by configureShared() if called before
+         * the first use, otherwise by the OPTION_PRICER_THREADS environment
+         * variable, otherwise by the hardware concurrency.
+         */
+        static Scheduler &shared();
+
+        // Set the shared scheduler size; returns false if it already exists
+        static bool configureShared(std::size_t threads);
+
+    private:
+        friend class TaskGroup;
+
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void submit(Task task);
+        bool tryRunOne();
+        bool tryRunPosted();
+        void workerLoop(std::size_t index);
+        void wakeAll();
+
+        std::vector<std::unique_ptr<WorkerQueue>> queues_; // one per worker
+        WorkerQueue injection_;                            // submissions from non-workers
+        WorkerQueue postQueue_;                            // post(), for idle workers only
+        std::vector<std::thread> workers_;
+
+        std::atomic<std::size_t> pending_{0}; // submitted tasks, not posted ones
+        std::atomic<std::size_t> posted_{0};
+        std::mutex sleepMutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+    };
+
+    /**
+     * @class TaskGroup
+     * @brief Set of tasks that can be waited on together
+     *
+     * wait() helps run queued tasks until every task in the group has
+     * finished, then rethrows the first exception any of them threw. The
+     * destructor waits too, so tasks may safely capture locals by reference.
+     */
+    class TaskGroup
+    {
+    public:
+        explicit TaskGroup(Scheduler &scheduler = Scheduler::shared()) : scheduler_(scheduler) {}
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+        void run(std::function<void()> fn);
+        void wait();
+
+    private:
+        void drain();
+
+        Scheduler &scheduler_;
+        std::atomic<std::size_t> outstanding_{0};
+        std::mutex errorMutex_;
+        std::exception_ptr error_;
+    };
+
+} // namespace OptionPricer
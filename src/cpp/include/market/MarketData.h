@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace OptionPricer
+{
+
+    /**
+     * @class RateCurve
+     * @brief Continuously compounded zero rates at pillar times
+     *
+     * Interpolated linearly in r(T) * T, i.e. piecewise-flat forwards, and
+     * flat beyond the first and last pillar. A view: the arrays belong to
+     * the Underlying that holds the curve.
+     */
+    class RateCurve
+    {
+    public:
+        RateCurve() = default;
+        RateCurve(const double *times, const double *rates, std::size_t size)
+            : times_(times), rates_(rates), size_(size) {}
+
+        // Zero rate to time (years)
+        double rate(double time) const;
+
+        const double *times() const { return times_; }
+        const double *rates() const { return rates_; }
+        std::size_t size() const { return size_; }
+
+    private:
+        const double *times_ = nullptr;
+        const double *rates_ = nullptr;
+        std::size_t size_ = 0;
+    };
+
+    /**
+     * @class VolSurface
+     * @brief Black volatility by moneyness (strike / forward) and expiry
+     *
+     * Each expiry is a slice: a grid of volatilities over moneyness columns
+     * (linear in moneyness, flat beyond the end columns) or an SVI slice
+     * w(k) = a + b (rho (k - m) + sqrt((k - m)^2 + s^2)) of total variance
+     * in log-moneyness k. Between expiries total variance is interpolated
+     * linearly in time; before the first and after the last expiry the
+     * volatility is flat. A view, like RateCurve.
+     */
+    class VolSurface
+    {
+    public:
+        enum class Kind : std::uint32_t
+        {
+            Grid = 0,
+            Svi = 1
+        };
+
+        // Values per SVI slice: a, b, rho, m, s
+        static constexpr std::size_t SviParams = 5;
+
+        VolSurface() = default;
+
+        /**
+         * expiries: expiryCount increasing times. Grid: moneyness holds
+         * `columns` increasing strike / forward ratios and values the vols,
+         * row-major by expiry. Svi: moneyness is null, columns is SviParams
+         * and values holds one parameter row per expiry.
+         */
+        VolSurface(Kind kind, const double *expiries, std::size_t expiryCount, const double *moneyness,
+                   std::size_t columns, const double *values)
+            : kind_(kind), expiries_(expiries), expiryCount_(expiryCount), moneyness_(moneyness),
+              columns_(columns), values_(values) {}
+
+        double volatility(double moneyness, double time) const;
+
+        Kind kind() const { return kind_; }
+        const double *expiries() const { return expiries_; }
+        std::size_t expiryCount() const { return expiryCount_; }
+        const double *moneyness() const { return moneyness_; }
+        std::size_t columns() const { return columns_; }
+        const double *values() const { return values_; }
+
+    private:
+        // Total variance of slice e at moneyness
+        double totalVariance(std::size_t e, double moneyness) const;
+
+        Kind kind_ = Kind::Grid;
+        const double *expiries_ = nullptr;
+        std::size_t expiryCount_ = 0;
+        const double *moneyness_ = nullptr;
+        std::size_t columns_ = 0;
+        const double *values_ = nullptr;
+    };
+
+    /**
+     * @struct Underlying
+     * @brief Spot, rate curve and volatility surface of one named underlying
+     *
+     * The curve and surface point into `storage`, a heap block for data
+     * built in-process or the mapped file for data loaded with
+     * MarketDataStore::loadFile, so copies are cheap and never copy the
+     * arrays.
+     */
+    struct Underlying
+    {
+        std::string name;
+        double spot = 0.0;
+        RateCurve rates;
+        VolSurface surface;
+        std::shared_ptr<const void> storage;
+
+        double rate(double time) const { return rates.rate(time); }
+
+        // Surface volatility at strike, against the forward implied by spot and the curve
+        double volatility(double strike, double time) const;
+
+        /**
+         * Copy the arrays into one heap block and validate; throws
+         * std::invalid_argument for a malformed curve or surface
+         */
+        static Underlying make(std::string name, double spot,
+                               const std::vector<double> &rateTimes, const std::vector<double> &rates,
+                               VolSurface::Kind kind, const std::vector<double> &expiries,
+                               const std::vector<double> &moneyness, const std::vector<double> &values);
+
+        // Longest accepted name; the file format stores names in a fixed field
+        static constexpr std::size_t MaxNameLength = 31;
+    };
+
+    /**
+     * @class MarketSnapshot
+     * @brief Immutable, versioned set of underlyings
+     *
+     * A reader holds a snapshot for the whole request, so every leg of a
+     * portfolio is priced against the same market even while it is updated.
+     */
+    class MarketSnapshot
+    {
+    public:
+        // Null for an unknown name
+        const Underlying *find(const std::string &name) const;
+
+        const std::map<std::string, Underlying> &underlyings() const { return underlyings_; }
+        std::uint64_t version() const { return version_; }
+
+    private:
+        friend class MarketDataStore;
+
+        std::map<std::string, Underlying> underlyings_;
+        std::uint64_t version_ = 0;
+    };
+
+    /**
+     * @class MarketDataStore
+     * @brief Shared market data with copy-on-write snapshots
+     *
+     * Readers take the current snapshot with one atomic shared_ptr load and
+     * never wait for a writer. Writers are serialised: each builds a new
+     * snapshot from the current one (underlyings are shared, not copied)
+     * and publishes it; the old one is freed when its last reader lets go.
+     *
+     * Market files are mapped read-only and their arrays are used in place.
+     * Layout, native little-endian, every array 8-byte aligned:
+     *   char[4]  magic "OPMD"
+     *   u32      version (1)
+     *   u32      underlying count
+     *   u32      reserved (0)
+     *   per underlying:
+     *     char[32] name, NUL-padded
+     *     f64      spot
+     *     u32      rate pillars P, surface kind (0 grid, 1 SVI), expiries E, columns C
+     *     f64[P]   pillar times, then f64[P] zero rates
+     *     f64[E]   expiries
+     *     f64[C]   moneyness (grid only)
+     *     f64[E*C] vols, or SVI parameters (C = 5), row-major by expiry
+     * Replace a live file by writing a new one and renaming it over the old;
+     * rewriting a mapped file in place is undefined.
+     */
+    class MarketDataStore
+    {
+    public:
+        MarketDataStore();
+
+        std::shared_ptr<const MarketSnapshot> snapshot() const;
+
+        // Add or replace one underlying; returns the new snapshot version
+        std::uint64_t update(Underlying underlying);
+
+        // Remove one underlying; false if it was not there
+        bool erase(const std::string &name);
+
+        /**
+         * Map a market file and publish its underlyings in one snapshot,
+         * replacing any with the same names. Returns how many were loaded.
+         * Throws std::runtime_error if the file cannot be read and
+         * std::invalid_argument if it is malformed; the store is then unchanged.
+         */
+        std::size_t loadFile(const std::string &path);
+
+        // Write a snapshot in the file format (via a temporary file and rename)
+        static void writeFile(const std::string &path, const MarketSnapshot &snapshot);
+
+        // Process-wide store used by the pricing endpoints
+        static MarketDataStore &shared();
+
+    private:
+        // Caller holds writeMutex_; returns the published version
+        std::uint64_t publish(std::shared_ptr<MarketSnapshot> next);
+
+        std::shared_ptr<const MarketSnapshot> current_; // accessed with std::atomic_load / atomic_store
+        std::mutex writeMutex_;
+    };
+
+} // namespace OptionPricer
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace OptionPricer
+{
+
+    /**
+     * @namespace Metrics
+     * @brief Low-overhead server instrumentation in Prometheus text format
+     *
+     * Every thread records into its own slot of relaxed atomics that only it
+     * writes, so the hot path takes no lock and shares no cache line with
+     * other threads; prometheus() sums the slots when scraped. The slot of a
+     * thread that exits is folded into a retired total, so counters never go
+     * backwards.
+     *
+     * Latencies go into log-linear (HDR-style) histograms with 8 sub-buckets
+     * per power of two from 1 us to ~69 s, so quantiles read back within
+     * 12.5%. Each endpoint has one histogram per Phase.
+     */
+    namespace Metrics
+    {
+
+        enum class Phase : std::uint8_t
+        {
+            Parse,     // from the start of the handler to the first other phase
+            Price,     // pricing engines
+            Serialize, // response encoding
+            Total      // the whole handler
+        };
+
+        constexpr std::size_t PhaseCount = 4;
+        constexpr std::size_t MaxEndpoints = 32;
+
+        /**
+         * Id of an endpoint, registering it on first use; the same method and
+         * path always give the same id. Throws std::length_error once
+         * MaxEndpoints distinct endpoints exist.
+         */
+        std::size_t endpoint(const std::string &method, const std::string &path);
+
+        void recordLatency(std::size_t endpoint, Phase phase, std::uint64_t nanos);
+
+        // European valuations (closed form, scalar or batched)
+        void recordEuropean(std::uint64_t valuations = 1);
+
+        // One binomial lattice of the given number of steps
+        void recordLattice(int steps);
+
+        // One closed-form American approximation (Barone-Adesi-Whaley, Bjerksund-Stensland)
+        void recordAnalytic();
+
+        // An async request stopped at its deadline, or because its client went away
+        void recordDeadlineExceeded();
+        void recordDisconnect();
+
+        /**
+         * @class RequestTimer
+         * @brief Times one request on the current thread, phase by phase
+         *
+         * Starts in Phase::Parse. enter() closes the running phase and opens
+         * the next on the innermost timer of the calling thread, so code deep
+         * in a handler (RestServer::sendJson, say) can mark Serialize without
+         * being handed the timer. Time spent in a phase entered more than once
+         * is added up, so every phase is recorded at most once per request.
+         * Responses streamed after the handler returns are not included.
+         *
+         * A handler run on another thread (an async route's, on a Scheduler
+         * worker) is timed there by a default-constructed timer, which
+         * records nothing itself; the request's thread then join()s its
+         * phases().
+         */
+        class RequestTimer
+        {
+        public:
+            // Time per phase so far, the running phase up to now
+            struct Phases
+            {
+                std::uint64_t nanos[PhaseCount - 1] = {};
+                bool entered[PhaseCount - 1] = {};
+            };
+
+            explicit RequestTimer(std::size_t endpoint);
+            // Times part of a request for join(); counts and records nothing
+            RequestTimer();
+            ~RequestTimer();
+
+            RequestTimer(const RequestTimer &) = delete;
+            RequestTimer &operator=(const RequestTimer &) = delete;
+
+            // No-op on a thread with no timer running
+            static void enter(Phase phase);
+
+            // Count the request as an error response
+            void fail() { failed_ = true; }
+
+            Phases phases() const;
+
+            /**
+             * Fold the phases of part of the request, run elsewhere while
+             * this thread waited, into the thread's innermost timer: their
+             * time moves out of its running phase into theirs. No-op on a
+             * thread with no timer running.
+             */
+            static void join(const Phases &part);
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            static constexpr std::size_t Unrecorded = static_cast<std::size_t>(-1);
+
+            std::size_t endpoint_;
+            Phase phase_ = Phase::Parse;
+            bool failed_ = false;
+            Clock::time_point start_;
+            Clock::time_point mark_;
+            std::uint64_t nanos_[PhaseCount - 1] = {};
+            bool entered_[PhaseCount - 1] = {true, false, false};
+            RequestTimer *outer_;
+        };
+
+        // Totals over all threads, for tests and the startup banner
+        struct LatencySummary
+        {
+            std::uint64_t count;
+            std::uint64_t sumNanos;
+            double p50; // seconds, upper bound of the bucket holding the quantile
+            double p99;
+            double p999;
+        };
+
+        struct ModelCounts
+        {
+            std::uint64_t european;
+            std::uint64_t lattices;
+            std::uint64_t binomialSteps;
+            std::uint64_t analytic;
+        };
+
+        /**
+         * Start every count and histogram over from zero, as seen by the
+         * accessors below and prometheus(); requests in flight are
+         * unaffected. API::Warmup calls it once its traffic is done.
+         */
+        void reset();
+
+        LatencySummary latency(std::size_t endpoint, Phase phase);
+        std::uint64_t errors(std::size_t endpoint);
+        ModelCounts models();
+
+        /**
+         * Everything above in Prometheus text exposition format 0.0.4, plus
+         * the shared GreeksCache counters and the shared Scheduler's queue
+         * depth, read at scrape time.
+         */
+        std::string prometheus();
+
+    } // namespace Metrics
+} // namespace OptionPricer
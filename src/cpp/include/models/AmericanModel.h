@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// How an American option is valued. Selected by the request's "model" field:
+// "american" keeps the original CRR tree, the suffixed names pick the
+// faster-converging lattices, a closed-form approximation or the PDE engine.
+enum class AmericanModel : std::uint8_t
+{
+    CRR,                // "american": Cox-Ross-Rubinstein binomial
+    LeisenReimer,       // "american_lr": Peizer-Pratt inversion, odd steps
+    BBSR,               // "american_bbsr": Black-Scholes last step + Richardson extrapolation
+    Trinomial,          // "american_trinomial": Boyle trinomial
+    BaroneAdesiWhaley,  // "american_baw": quadratic approximation, no lattice
+    BjerksundStensland, // "american_bjs": Bjerksund-Stensland 2002, no lattice
+    FiniteDifference    // "american_fd": Crank-Nicolson PDE, steps time levels
+};
+
+// Lattice models take "steps"; the PDE engine takes it as time steps and the approximations ignore it
+inline bool isLattice(AmericanModel model)
+{
+    return model <= AmericanModel::Trinomial;
+}
+
+inline AmericanModel parseAmericanModel(const std::string &model)
+{
+    if (model == "american")
+        return AmericanModel::CRR;
+    if (model == "american_lr")
+        return AmericanModel::LeisenReimer;
+    if (model == "american_bbsr")
+        return AmericanModel::BBSR;
+    if (model == "american_trinomial")
+        return AmericanModel::Trinomial;
+    if (model == "american_baw")
+        return AmericanModel::BaroneAdesiWhaley;
+    if (model == "american_bjs")
+        return AmericanModel::BjerksundStensland;
+    if (model == "american_fd")
+        return AmericanModel::FiniteDifference;
+    throw std::invalid_argument("Invalid model: " + model +
+                                " (expected \"european\", \"american\", \"american_lr\", \"american_bbsr\", "
+                                "\"american_trinomial\", \"american_baw\", \"american_bjs\" or \"american_fd\")");
+}
+
+inline const char *toString(AmericanModel model)
+{
+    switch (model)
+    {
+    case AmericanModel::LeisenReimer:
+        return "american_lr";
+    case AmericanModel::BBSR:
+        return "american_bbsr";
+    case AmericanModel::Trinomial:
+        return "american_trinomial";
+    case AmericanModel::BaroneAdesiWhaley:
+        return "american_baw";
+    case AmericanModel::BjerksundStensland:
+        return "american_bjs";
+    case AmericanModel::FiniteDifference:
+        return "american_fd";
+    default:
+        return "american";
+    }
+}
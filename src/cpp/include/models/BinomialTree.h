@@ -0,0 +1,145 @@
+#pragma once
+#include <cstddef>
+#include "models/AmericanModel.h"
+#include "models/OptionKind.h"
+
+namespace OptionPricer
+{
+
+    /**
+     * @namespace BinomialTree
+     * @brief Lattice engines for early-exercise options
+     *
+     * CRR (the default) oscillates in the step count, so its error only falls
+     * as 1/steps on average. Leisen-Reimer centres the lattice on the strike;
+     * its prices converge smoothly and monotonically and reach CRR's accuracy
+     * with about a third of the steps. BBSR smooths the last step with
+     * Black-Scholes and extrapolates between steps and steps/2, matching CRR
+     * with about a tenth of the steps. The trinomial tree does not oscillate
+     * between odd and even step counts but needs as many steps as CRR.
+     *
+     * Backward induction runs in a single rolling buffer of steps+1 node values,
+     * so memory is O(steps) rather than the O(steps^2) of a full price tree.
+     * Node spots and exercise values are precomputed once per tree on the
+     * 2*steps+1 distinct spot levels S * u^k (k = -steps..steps; Leisen-Reimer,
+     * where u * d != 1, uses tables of u^k and d^k instead); the inner
+     * loop performs no transcendental calls, string compares or allocations.
+     * Buffers are thread-local and grow on demand, so repeated pricings on the
+     * same thread do not touch the heap.
+     */
+    namespace BinomialTree
+    {
+
+        /**
+         * Quantities read off a single lattice pass
+         *
+         * delta and gamma come from the nodes at steps 1 and 2; theta compares
+         * the middle node at step 2 (same spot, 2*dt later) with the root.
+         * Theta is per year, matching BlackScholes::theta.
+         */
+        struct LatticeResult
+        {
+            double price;
+            double delta;
+            double gamma;
+            double theta;
+        };
+
+        /**
+         * Price an American option on a lattice
+         * @param S Spot price
+         * @param K Strike price
+         * @param r Risk-free rate
+         * @param sigma Volatility
+         * @param T Time to expiration
+         * @param kind Call or put
+         * @param steps Number of tree steps (clamped to at least 2; Leisen-Reimer
+         *              rounds up to odd, BBSR to even and at least 4)
+         * @param scheme Lattice construction; the closed-form AmericanModels
+         *               throw std::invalid_argument
+         * @return Option value at the root node
+         */
+        double americanPrice(double S, double K, double r, double sigma, double T,
+                             OptionKind kind, int steps, AmericanModel scheme = AmericanModel::CRR);
+
+        /**
+         * Price, delta, gamma and theta of an American option from one tree
+         * (two for BBSR, extrapolated like the price)
+         * @param steps Number of tree steps, clamped as for americanPrice
+         */
+        LatticeResult americanLattice(double S, double K, double r, double sigma, double T,
+                                      OptionKind kind, int steps, AmericanModel scheme = AmericanModel::CRR);
+
+        /**
+         * americanLattice's results plus the exact derivatives of the lattice
+         * price in every input. dTime is the derivative in time to expiry, so
+         * it is close to -theta.
+         */
+        struct LatticeSensitivities
+        {
+            LatticeResult lattice;
+            double dSpot;
+            double dStrike;
+            double dRate;
+            double dSigma;
+            double dTime;
+        };
+
+        /**
+         * americanLattice with adjoint (reverse-mode) sensitivities
+         *
+         * The pricing pass records every level of the tree; one reverse sweep
+         * then carries d(price)/d(node) from the root to the leaves, through
+         * the continuation or exercise branch each node took, and collects
+         * the adjoints of the branch probabilities, step factors and node
+         * spots, which the scheme's parameter formulas map back to the five
+         * inputs. All of them cost about two pricings together, where bumping
+         * needs two more trees per input. BBS leaves take their sensitivities
+         * from BlackScholes::priceAndGreeks. Small trees are recorded whole;
+         * past about 2 MB only every sqrt(steps)-th level is kept and the
+         * sweep rebuilds the rest a segment at a time, so memory stays
+         * O(steps^1.5), in thread-local buffers like the rest.
+         */
+        LatticeSensitivities americanSensitivities(double S, double K, double r, double sigma, double T,
+                                                   OptionKind kind, int steps,
+                                                   AmericanModel scheme = AmericanModel::CRR);
+
+        /**
+         * Inputs of americanSensitivitiesBatch; all arrays hold `size` elements
+         */
+        struct LatticeBatchInput
+        {
+            const double *spot;
+            const double *strike;
+            const double *rate;
+            const double *sigma;
+            const double *time;
+            const OptionKind *kind;
+            std::size_t size;
+        };
+
+        /**
+         * americanSensitivities for many options on one scheme and step count
+         *
+         * CRR and BBSR trees run batchLanes() options per pass, one per SIMD
+         * lane, on the widest instruction set the CPU supports (picked at
+         * runtime like BlackScholes::priceAndGreeksBatch). Node values are
+         * interleaved lane by lane, so a level is one sweep of vector
+         * multiply-adds and a per-lane max against exercise, and the reverse
+         * sweep carries every lane's adjoints together. Results are
+         * bit-identical to americanSensitivities. Other schemes, expired
+         * options, a lone last option and CPUs without AVX2 are priced one
+         * at a time.
+         * @param out in.size results, in input order
+         */
+        void americanSensitivitiesBatch(const LatticeBatchInput &in, int steps, AmericanModel scheme,
+                                        LatticeSensitivities *out);
+
+        // Options americanSensitivitiesBatch prices per pass: 8 (AVX-512), 4 (AVX2) or 1
+        std::size_t batchLanes();
+
+        // Largest value batchLanes() returns
+        constexpr std::size_t MaxBatchLanes = 8;
+
+    } // namespace BinomialTree
+} // namespace OptionPricer
@@ -1,8 +1,14 @@
 #pragma once
-#include <string>
+#include <cstddef>
+#include "models/NormalDistribution.h"
+#include "models/OptionGreeks.h"
+#include "models/OptionKind.h"
 
 namespace BlackScholes
 {
+    using Accuracy = OptionPricer::Normal::Accuracy;
+
+    // phi(x) and N(x) at Exact accuracy (see NormalDistribution.h)
     double standardNormal(double x);
     double cumulativeNormal(double x);
     double d1(double S, double K, double r, double sigma, double T);
@@ -11,9 +17,82 @@ namespace BlackScholes
     double callPrice(double S, double K, double r, double sigma, double T);
     double putPrice(double S, double K, double r, double sigma, double T);
 
-    double delta(double S, double K, double r, double sigma, double T, const std::string &type);
+    double delta(double S, double K, double r, double sigma, double T, OptionKind kind);
     double gamma(double S, double K, double r, double sigma, double T);
     double vega(double S, double K, double r, double sigma, double T);
-    double theta(double S, double K, double r, double sigma, double T, const std::string &type);
-    double rho(double S, double K, double r, double sigma, double T, const std::string &type);
+    double theta(double S, double K, double r, double sigma, double T, OptionKind kind);
+    double rho(double S, double K, double r, double sigma, double T, OptionKind kind);
+
+    // Price and all Greeks from one set of log/sqrt/exp/normal evaluations,
+    // the normal CDF and density at the given accuracy
+    OptionGreeks priceAndGreeks(double S, double K, double r, double sigma, double T, OptionKind kind,
+                                Accuracy accuracy = Accuracy::Exact);
+
+    // The closed form specialised at compile time on the option kind and the
+    // normal accuracy, so nothing inside branches on either; price<Kind>
+    // skips the density and the Greeks. Loops over many options of one kind
+    // pick an instance once (see ScenarioEngine); callPrice, putPrice and
+    // priceAndGreeks above dispatch to these per call. At Exact accuracy
+    // price<Kind> equals priceAndGreeks<Kind>(...).price bit for bit.
+    template <OptionKind Kind, Accuracy A = Accuracy::Exact>
+    double price(double S, double K, double r, double sigma, double T);
+
+    template <OptionKind Kind, Accuracy A = Accuracy::Exact>
+    OptionGreeks priceAndGreeks(double S, double K, double r, double sigma, double T);
+
+    // Structure-of-arrays inputs for priceAndGreeksBatch; all arrays hold `size` elements
+    struct BatchInput
+    {
+        const double *spot;
+        const double *strike;
+        const double *rate;
+        const double *sigma;
+        const double *time;
+        const OptionKind *kind;
+        std::size_t size;
+    };
+
+    // Output columns; a null pointer skips that column
+    struct BatchOutput
+    {
+        double *price;
+        double *delta;
+        double *gamma;
+        double *vega;
+        double *theta;
+        double *rho;
+    };
+
+    // Price and Greeks for a whole chain with the widest SIMD kernel the CPU
+    // supports (AVX-512, AVX2 or scalar). Uses vectorized log/exp/normal-CDF
+    // approximations; results match priceAndGreeks to ~1e-13 relative.
+    // Elements with T <= 0 or sigma <= 0 fall back to priceAndGreeks. The
+    // kernel is specialised per call on whether every element has the same
+    // kind and whether any Greek column is requested.
+    void priceAndGreeksBatch(const BatchInput &in, const BatchOutput &out);
+
+    // Kernel selected at runtime: "avx512", "avx2" or "scalar"
+    const char *batchInstructionSet();
+
+    // Quotes for impliedVolatilityBatch; all arrays hold `size` elements
+    struct ImpliedVolInput
+    {
+        const double *price;
+        const double *spot;
+        const double *strike;
+        const double *rate;
+        const double *time;
+        const OptionKind *kind;
+        std::size_t size;
+    };
+
+    // Volatility that reproduces each price, on the same SIMD kernels as
+    // priceAndGreeksBatch; accurate to about 1e-11 relative (see
+    // BlackScholesSimd.h). A price outside the no-arbitrage bounds (at or
+    // below the forward intrinsic value, at or above the spot for a call or
+    // the discounted strike for a put), or a quote with T <= 0, gives NaN.
+    void impliedVolatilityBatch(const ImpliedVolInput &in, double *sigma);
+
+    // One quote; throws std::invalid_argument where the batch gives NaN
+    double impliedVolatility(double price, double S, double K, double r, double T, OptionKind kind);
 }
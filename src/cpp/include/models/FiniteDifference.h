@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include "models/BlackScholes.h"
+#include "models/OptionKind.h"
+
+namespace OptionPricer
+{
+    class Scheduler;
+
+    /**
+     * @namespace FiniteDifference
+     * @brief Crank-Nicolson PDE engine for American chains
+     *
+     * Written in log-moneyness x = ln(S / K), the American value is
+     * V(S, K) = K v(x, T) where v solves a PDE that does not depend on the
+     * strike. A chain of strikes that share an expiry, rate and volatility
+     * is therefore one solve, read off at each strike's x with quadratic
+     * interpolation for price, delta and gamma.
+     *
+     * Strikes with different volatilities (a smile), and the bumped
+     * volatilities and rates behind vega and rho, are solved together as
+     * lanes of one structure-of-arrays grid, so every tridiagonal sweep runs
+     * across lanes in SIMD. Early exercise is imposed exactly by the
+     * Brennan-Schwartz elimination order, and two implicit half steps
+     * (Rannacher) damp the payoff kink before Crank-Nicolson takes over.
+     * Grids live in per-thread buffers reused across calls.
+     */
+    namespace FiniteDifference
+    {
+
+        /**
+         * Resolution per expiry: timeSteps time levels, and spaceSteps
+         * intervals across ten standard deviations of log-spot (more when the
+         * strikes span a wider range)
+         */
+        struct Grid
+        {
+            int timeSteps = 200;
+            int spaceSteps = 400;
+        };
+
+        // The grid an AmericanOption with this "steps" value uses
+        inline Grid gridForSteps(int steps)
+        {
+            return {steps, 2 * steps};
+        }
+
+        // Structure-of-arrays chain; spot and rate are shared, the arrays hold `size` elements
+        struct ChainInput
+        {
+            double spot;
+            double rate;
+            const double *strike;
+            const double *sigma;
+            const double *time;
+            const OptionKind *kind;
+            std::size_t size;
+        };
+
+        /**
+         * Price and Greeks of American options for a whole chain, one solve
+         * per (expiry, kind) group, groups in parallel on the scheduler.
+         * Output columns as in BlackScholes::priceAndGreeksBatch; leaving vega
+         * or rho null also skips their bumped lanes. Theta is per year.
+         * Throws std::invalid_argument for non-positive inputs or a grid
+         * smaller than 4 x 4.
+         */
+        void americanChain(const ChainInput &in, const BlackScholes::BatchOutput &out, Scheduler &scheduler,
+                           const Grid &grid = {});
+
+        // One option, on the calling thread
+        double americanPrice(double S, double K, double r, double sigma, double T, OptionKind kind,
+                             const Grid &grid = {});
+        OptionGreeks americanGreeks(double S, double K, double r, double sigma, double T, OptionKind kind,
+                                    const Grid &grid = {});
+
+    } // namespace FiniteDifference
+} // namespace OptionPricer
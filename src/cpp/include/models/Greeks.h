@@ -1,7 +1,7 @@
 #pragma once
 
 #include <cmath>
-#include <string>
+#include "models/OptionKind.h"
 
 namespace OptionPricer
 {
@@ -24,11 +24,11 @@ namespace OptionPricer
          * @param r Risk-free rate
          * @param sigma Volatility
          * @param T Time to expiration
-         * @param type "call" or "put"
+         * @param kind Call or put
          * @return Delta value (typically -1 to 1)
          */
         double delta(double S, double K, double r, double sigma, double T,
-                     const std::string &type);
+                     OptionKind kind);
 
         /**
          * Gamma - Second-order sensitivity (rate of delta change)
@@ -52,7 +52,7 @@ namespace OptionPricer
          * @return Theta value (typically annualized, divide by 365 for daily)
          */
         double theta(double S, double K, double r, double sigma, double T,
-                     const std::string &type);
+                     OptionKind kind);
 
         /**
          * Rho - Interest rate sensitivity
@@ -61,7 +61,7 @@ namespace OptionPricer
          * @return Rho value (per 1% rate move)
          */
         double rho(double S, double K, double r, double sigma, double T,
-                   const std::string &type);
+                   OptionKind kind);
 
         /**
          * Vanna - Mixed Greek (Δ sensitivity to volatility)
@@ -80,7 +80,7 @@ namespace OptionPricer
          * Measures how delta changes with time
          */
         double charm(double S, double K, double r, double sigma, double T,
-                     const std::string &type);
+                     OptionKind kind);
 
     } // namespace Greeks
 } // namespace OptionPricer
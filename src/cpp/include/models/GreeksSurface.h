@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "models/NormalDistribution.h"
+#include "models/OptionKind.h"
+
+namespace OptionPricer
+{
+    class Scheduler;
+
+    namespace GreeksSurface
+    {
+
+        /**
+         * Grid definition: spotSteps + 1 spots evenly spaced over
+         * [spotMin, spotMax] by timeSteps + 1 expiries over [timeMin, timeMax],
+         * all other inputs fixed. rates / sigmas, when not empty, hold one
+         * value per expiry and replace rate / sigma (a curve and a surface
+         * read at the strike).
+         *
+         * accuracy: Fast and Table run the SIMD batch kernel (its vector
+         * rational is within 1e-13 of the closed form, and measured faster
+         * per point than table lookups, which would need gathers in vector
+         * lanes); Exact prices point by point with the scalar closed form,
+         * bit-identical to BlackScholes::priceAndGreeks.
+         */
+        struct Spec
+        {
+            double strike;
+            double rate;
+            double sigma;
+            OptionKind kind;
+            double spotMin, spotMax;
+            double timeMin, timeMax;
+            int spotSteps;
+            int timeSteps;
+            std::vector<double> rates;
+            std::vector<double> sigmas;
+            Normal::Accuracy accuracy = Normal::Accuracy::Fast;
+        };
+
+        /**
+         * Columnar result. Every Greek column holds spots.size() * times.size()
+         * values in row-major (spot, time) order: point (i, j) is at
+         * i * times.size() + j.
+         */
+        struct Grid
+        {
+            std::vector<double> spots;
+            std::vector<double> times;
+            std::vector<double> price, delta, gamma, vega, theta, rho;
+            std::size_t completed = 0; // points evaluated; fewer than the grid's only when cancelled
+        };
+
+        // Largest accepted spotSteps / timeSteps
+        constexpr int MaxSteps = 1000;
+
+        // Validated spot and time axes only; the Greek columns are left empty
+        Grid axes(const Spec &spec);
+
+        /**
+         * Evaluate the grid with the batch Black-Scholes kernel (or the scalar
+         * closed form, at Exact accuracy), in parallel tiles of whole spot
+         * rows that write straight into the output columns.
+         * Throws std::invalid_argument for an empty or oversized grid. If
+         * the calling work is cancelled part way, returns the tiles that
+         * finished, with NaN in the rest and Grid::completed short of the
+         * grid's size.
+         */
+        Grid compute(const Spec &spec, Scheduler &scheduler);
+
+        // One Grid column; order matches BlackScholes::BatchOutput
+        enum class Field
+        {
+            Price,
+            Delta,
+            Gamma,
+            Vega,
+            Theta,
+            Rho
+        };
+
+        /**
+         * @class Stream
+         * @brief Selected columns of a grid, priced tile by tile as they are read
+         *
+         * Reading a range prices the row tiles under it that are not priced
+         * yet (compute()'s tiles, so values are bit-identical) and keeps
+         * every selected field of them, so a writer emitting the columns one
+         * after another prices each tile once, and the first column goes out
+         * as its tiles finish. Holds one column per selected field, never
+         * the unselected ones. One reader at a time.
+         */
+        class Stream
+        {
+        public:
+            // Validates the spec as axes() does
+            Stream(const Spec &spec, std::vector<Field> fields, Scheduler &scheduler);
+
+            // Spot and time axes; the Greek columns are empty
+            const Grid &axes() const { return axes_; }
+            std::size_t points() const { return axes_.spots.size() * axes_.times.size(); }
+
+            /**
+             * fields[column] at flat indices [begin, end) into out; throws
+             * std::out_of_range for a range or column outside the grid
+             */
+            void read(std::size_t column, std::size_t begin, std::size_t end, double *out);
+
+            // Tiles priced so far
+            std::size_t pricedTiles() const;
+
+        private:
+            Spec spec_;
+            std::vector<Field> fields_;
+            Scheduler &scheduler_;
+            Grid axes_;
+            std::size_t tilePoints_;
+            std::vector<char> priced_;                // by tile
+            std::vector<std::vector<double>> values_; // by Field; only selected ones are sized, on first read
+        };
+
+    } // namespace GreeksSurface
+} // namespace OptionPricer
@@ -0,0 +1,12 @@
+#pragma once
+
+// Market inputs an option is revalued under; strike, kind and contract
+// terms stay with the option. Units match Option: rates and volatility
+// as decimals, time in years.
+struct MarketState
+{
+    double spot;
+    double rate;
+    double sigma;
+    double time;
+};
@@ -0,0 +1,152 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "models/RiskMeasures.h"
+#include "models/TDigest.h"
+
+namespace OptionPricer
+{
+    class Scheduler;
+
+    /**
+     * @namespace MonteCarloRisk
+     * @brief Simulated horizon P&L for VaR / ES
+     *
+     * Each path draws a correlated lognormal spot move and implied-vol move
+     * over the horizon; every leg is then revalued with time decayed by the
+     * horizon. Path i depends only on (seed, i), never on the thread that
+     * generated it, so results are identical for any thread count.
+     */
+    namespace MonteCarloRisk
+    {
+
+        enum class Sampling : std::uint8_t
+        {
+            Pseudo,     // Philox4x32-10 counter-based normals
+            Antithetic, // Philox normals, each used with both signs
+            Sobol       // 2-D Sobol points, digitally shifted by the seed
+        };
+
+        // "pseudo", "antithetic" or "sobol"; throws std::invalid_argument otherwise
+        Sampling parseSampling(const std::string &name);
+        const char *toString(Sampling sampling);
+
+        struct Spec
+        {
+            std::size_t paths = 10000;
+            double horizon = 1.0 / 252.0; // years
+            double drift = 0.0;           // annual spot drift
+            double spotVol = 0.2;         // annual volatility of spot moves
+            double volOfVol = 0.0;        // annual lognormal volatility of implied vol
+            double correlation = 0.0;     // between spot and vol shocks
+            Sampling sampling = Sampling::Antithetic;
+            std::uint64_t seed = 0;
+            bool taylor = false;              // ScenarioEngine::runTaylor instead of full revaluation
+            double gammaThreshold = HUGE_VAL; // Taylor mode: legs with larger |gamma| are repriced
+            Normal::Accuracy accuracy = Normal::Accuracy::Exact; // normal CDF of European revaluations
+        };
+
+        // Largest accepted Spec::paths
+        constexpr std::size_t MaxPaths = 2000000;
+
+        /**
+         * Path shocks for spec, generated in parallel blocks. Antithetic
+         * rounds the path count up to even; pairs are adjacent.
+         * Throws std::invalid_argument for an invalid spec.
+         */
+        std::vector<RiskMeasures::MarketShock> generateShocks(const Spec &spec, Scheduler &scheduler);
+
+        // Paths a run of spec simulates; throws std::invalid_argument for an invalid spec
+        std::size_t pathCount(const Spec &spec);
+
+        // Paths [begin, end) of generateShocks(spec), generated on their own
+        std::vector<RiskMeasures::MarketShock> generateShocks(const Spec &spec, std::size_t begin, std::size_t end,
+                                                              Scheduler &scheduler);
+
+        struct Level
+        {
+            double confidence;
+            double var;
+            double es;
+        };
+
+        struct Result
+        {
+            std::size_t paths;
+            double baseValue;
+            double meanPnl;
+            double stdevPnl;
+            double maxLoss;
+            double pop;
+            std::size_t fullyRevaluedLegs;
+            std::vector<Level> levels; // one per requested confidence, same order
+        };
+
+        /**
+         * Simulate spec against the portfolio and report VaR / ES at each
+         * confidence level from a single revaluation pass
+         */
+        Result run(const RiskMeasures::Portfolio &portfolio, const Spec &spec,
+                   const std::vector<double> &confidences, Scheduler &scheduler);
+
+        /**
+         * Mergeable summary of the P&L of some paths: count, mean and
+         * squared deviations (combined with Chan et al.'s update), the
+         * profitable count and a t-digest of losses. Summaries of disjoint
+         * path ranges merge into the summary of their union.
+         */
+        struct Summary
+        {
+            std::size_t paths = 0;
+            double mean = 0.0;
+            double m2 = 0.0; // sum of squared deviations from mean
+            std::size_t profitable = 0;
+            TDigest losses;
+
+            explicit Summary(double compression = TDigest::DefaultCompression) : losses(compression) {}
+
+            void add(const std::vector<double> &pnl);
+            void merge(const Summary &other);
+        };
+
+        /**
+         * Paths [begin, end) of a run over some of its legs, as a worker
+         * node returns them: raw P&L, element i - begin being what run()
+         * computes for path i on those legs, or a Summary of it
+         */
+        struct Partial
+        {
+            std::size_t begin = 0;
+            std::size_t end = 0;
+            double baseValue = 0.0;
+            std::size_t fullyRevaluedLegs = 0;
+            bool summarised = false;
+            std::vector<double> pnl; // raw form only
+            Summary summary;         // summarised form only
+        };
+
+        // Revalue paths [begin, end) of spec; throws std::invalid_argument outside [0, pathCount(spec)]
+        Partial runPartial(const RiskMeasures::Portfolio &portfolio, const Spec &spec, std::size_t begin,
+                           std::size_t end, bool summarise, double compression, Scheduler &scheduler);
+
+        /**
+         * The Result of the P&L of every path, in path order; run() is
+         * summarize over its own buffer
+         */
+        Result summarize(const std::vector<double> &pnl, double baseValue, std::size_t fullyRevaluedLegs,
+                         const std::vector<double> &confidences);
+
+        /**
+         * The Result of a merged Summary: moments, max loss and probability
+         * of profit are exact; VaR and ES are read off the loss digest at
+         * the same tail count as the exact form, so they are exact while
+         * the tail centroids are singletons and interpolated beyond
+         */
+        Result summarize(const Summary &summary, double baseValue, std::size_t fullyRevaluedLegs,
+                         const std::vector<double> &confidences);
+
+    } // namespace MonteCarloRisk
+} // namespace OptionPricer
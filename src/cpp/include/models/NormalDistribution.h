@@ -0,0 +1,182 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace OptionPricer
+{
+    /**
+     * @namespace Normal
+     * @brief Standard normal CDF and density at a selectable accuracy
+     *
+     * The one home of N(x) and phi(x) for the scalar pricers; the SIMD batch
+     * kernels keep their own vector copy of the Fast rational
+     * (BlackScholesSimd.h). Three modes:
+     *
+     *   Exact  erfc and exp from the C library, to the last bit or two,
+     *          relative accuracy kept deep into the lower tail
+     *   Fast   Hart 5666 rational times one exp shared with the density
+     *          (G. West, "Better approximations to cumulative normal
+     *          functions", 2005): absolute error <= 2.3e-16, relative
+     *          error in the lower tail <= 5e-11 for |x| < 5
+     *   Table  cubic Hermite interpolation between nodes 1/64 apart over
+     *          [-8, 8], no transcendental call at all: absolute error
+     *          about 1e-10 for both N and phi, none of it relative; meant
+     *          for surfaces and plots, not for deep out-of-the-money tails
+     *
+     * Modes are picked per request (the "accuracy" field of the pricing
+     * endpoints) and threaded to the kernels as a template parameter, so
+     * the inner loops never branch on them.
+     */
+    namespace Normal
+    {
+
+        enum class Accuracy : std::uint8_t
+        {
+            Exact,
+            Fast,
+            Table
+        };
+
+        inline Accuracy parseAccuracy(const std::string &name)
+        {
+            if (name == "exact")
+                return Accuracy::Exact;
+            if (name == "fast")
+                return Accuracy::Fast;
+            if (name == "table")
+                return Accuracy::Table;
+            throw std::invalid_argument("Invalid accuracy: " + name + " (expected \"exact\", \"fast\" or \"table\")");
+        }
+
+        inline const char *toString(Accuracy accuracy)
+        {
+            return accuracy == Accuracy::Exact ? "exact" : accuracy == Accuracy::Fast ? "fast" : "table";
+        }
+
+        // std::sqrt(2.0) and std::sqrt(2.0 * pi) as doubles (the second is one
+        // ulp below the nearest double to the true root). Exact divides by them
+        // rather than multiplying by reciprocals, so it returns the bits
+        // BlackScholes::priceAndGreeks always has.
+        constexpr double Sqrt2 = 1.4142135623730951;
+        constexpr double Sqrt2Pi = 2.5066282746310002;
+
+        // Table layout: N and phi at TableMin + i / TableScale, interleaved
+        constexpr double TableMin = -8.0;
+        constexpr double TableMax = 8.0;
+        constexpr double TableScale = 64.0;
+        constexpr int TableNodes = 1025;
+
+        struct Value
+        {
+            double cdf;
+            double pdf;
+        };
+
+        namespace detail
+        {
+            // {N(x_i), phi(x_i)} for every node, built on first use
+            const double *buildTable();
+
+            inline const double *table()
+            {
+                static const double *const nodes = buildTable();
+                return nodes;
+            }
+
+            // N(-|x|) from phi(x) * sqrt(2 pi) = exp(-x^2 / 2)
+            inline double lowerTail(double ax, double expNegHalfSq)
+            {
+                if (ax < 7.07106781186547)
+                {
+                    const double p = (((((0.0352624965998911 * ax + 0.700383064443688) * ax + 6.37396220353165) * ax +
+                                        33.912866078383) * ax + 112.079291497871) * ax + 221.213596169931) * ax +
+                                     220.206867912376;
+                    const double q = ((((((0.0883883476483184 * ax + 1.75566716318264) * ax + 16.064177579207) * ax +
+                                         86.7807322029461) * ax + 296.564248779674) * ax + 637.333633378831) * ax +
+                                      793.826512519948) * ax + 440.413735824752;
+                    return expNegHalfSq * p / q;
+                }
+                if (ax > 37.0)
+                    return 0.0;
+                double b = ax + 0.65;
+                b = ax + 4.0 / b;
+                b = ax + 3.0 / b;
+                b = ax + 2.0 / b;
+                b = ax + 1.0 / b;
+                return expNegHalfSq / (b * 2.506628274631); // constant as in BlackScholesSimd.h
+            }
+        } // namespace detail
+
+        // Fast N(x) given exp(-x^2 / 2), for callers that already hold the exponential
+        inline double cdfFromExp(double x, double expNegHalfSq)
+        {
+            const double tail = detail::lowerTail(std::fabs(x), expNegHalfSq);
+            return x > 0.0 ? 1.0 - tail : tail;
+        }
+
+        template <Accuracy A>
+        inline Value evaluate(double x)
+        {
+            if constexpr (A == Accuracy::Exact)
+            {
+                return {0.5 * std::erfc(-x / Sqrt2), std::exp(-0.5 * x * x) / Sqrt2Pi};
+            }
+            else if constexpr (A == Accuracy::Fast)
+            {
+                const double e = std::exp(-0.5 * x * x);
+                return {cdfFromExp(x, e), e / Sqrt2Pi};
+            }
+            else
+            {
+                // Hermite cubic through the neighbouring nodes with slopes phi and phi' = -x phi
+                if (!(x > TableMin))
+                    return {0.0, 0.0}; // NaN lands here too, as in a clamp
+                if (!(x < TableMax))
+                    return {1.0, 0.0};
+                const double t = (x - TableMin) * TableScale;
+                const int i = std::min(static_cast<int>(t), TableNodes - 2); // x a rounding below TableMax
+                const double u = t - i;
+                const double *node = detail::table() + 2 * i;
+                const double h = 1.0 / TableScale;
+                const double x0 = TableMin + i * h, x1 = x0 + h;
+                const double n0 = node[0], p0 = node[1], n1 = node[2], p1 = node[3];
+                const double u2 = u * u, u3 = u2 * u;
+                const double h00 = 2.0 * u3 - 3.0 * u2 + 1.0, h01 = 3.0 * u2 - 2.0 * u3;
+                const double h10 = (u3 - 2.0 * u2 + u) * h, h11 = (u3 - u2) * h;
+                return {h00 * n0 + h01 * n1 + h10 * p0 + h11 * p1,
+                        h00 * p0 + h01 * p1 - h10 * x0 * p0 - h11 * x1 * p1};
+            }
+        }
+
+        template <Accuracy A>
+        inline double cdf(double x)
+        {
+            if constexpr (A == Accuracy::Exact)
+                return 0.5 * std::erfc(-x / Sqrt2);
+            else if constexpr (A == Accuracy::Fast)
+                return cdfFromExp(x, std::exp(-0.5 * x * x));
+            else
+                return evaluate<A>(x).cdf;
+        }
+
+        template <Accuracy A>
+        inline double pdf(double x)
+        {
+            if constexpr (A == Accuracy::Table)
+                return evaluate<A>(x).pdf;
+            else
+                return std::exp(-0.5 * x * x) / Sqrt2Pi;
+        }
+
+        // Runtime-selected mode, for callers outside the kernels
+        double cdf(double x, Accuracy accuracy = Accuracy::Exact);
+        double pdf(double x, Accuracy accuracy = Accuracy::Exact);
+
+        // Build the interpolation table now rather than on the first Table evaluation
+        void prepareTable();
+
+    } // namespace Normal
+} // namespace OptionPricer
@@ -0,0 +1,13 @@
+#pragma once
+
+// Price and first/second-order sensitivities of a single option.
+// Units follow BlackScholes: vega and rho per 1.0 change, theta per year.
+struct OptionGreeks
+{
+    double price;
+    double delta;
+    double gamma;
+    double vega;
+    double theta;
+    double rho;
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// Call/put direction. One byte so Option stays compact in large portfolios;
+// strings are only parsed at the JSON boundary.
+enum class OptionKind : std::uint8_t
+{
+    Call,
+    Put
+};
+
+inline OptionKind parseOptionKind(const std::string &type)
+{
+    if (type == "call")
+        return OptionKind::Call;
+    if (type == "put")
+        return OptionKind::Put;
+    throw std::invalid_argument("Invalid option type: " + type + " (expected \"call\" or \"put\")");
+}
+
+inline const char *toString(OptionKind kind)
+{
+    return kind == OptionKind::Call ? "call" : "put";
+}
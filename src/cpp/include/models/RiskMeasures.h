@@ -1,9 +1,12 @@
 #pragma once
 
+#include <cmath>
 #include <vector>
 #include <map>
 #include <memory>
 #include "../options/Option.h"
+#include "models/NormalDistribution.h"
+#include "concurrency/Scheduler.h"
 
 namespace OptionPricer
 {
@@ -18,9 +21,101 @@ namespace OptionPricer
     namespace RiskMeasures
     {
 
+        // Option position and signed quantity
+        using Portfolio = std::vector<std::pair<std::shared_ptr<Option>, int>>;
+
+        /**
+         * Tail statistics of one P&L distribution
+         */
+        struct ScenarioMeasures
+        {
+            double var;     // Loss not exceeded with the given confidence
+            double es;      // Mean loss over the same tail
+            double maxLoss; // Worst loss, 0 if every scenario profits
+            double pop;     // Fraction of scenarios with positive P&L
+        };
+
+        // Multiplicative move applied to every leg's spot and volatility
+        struct MarketShock
+        {
+            double spotFactor;
+            double volFactor;
+        };
+
+        /**
+         * @class ScenarioEngine
+         * @brief Revalues a portfolio once per scenario into a reusable P&L buffer
+         *
+         * P&L is scenario value minus current value. All risk measures are
+         * read from the same buffer, using partial selection for the tail
+         * instead of a full sort. Revaluation goes through Option::priceAt,
+         * so the portfolio is never modified and several engines may share
+         * one book concurrently.
+         *
+         * European legs are repriced with the closed form at the given
+         * normal accuracy; the base value is always exact, so a Fast or
+         * Table run carries the approximation's error into each P&L
+         * (about 1e-10 of the notional for Table).
+         */
+        class ScenarioEngine
+        {
+        public:
+            explicit ScenarioEngine(const Portfolio &portfolio,
+                                    Normal::Accuracy accuracy = Normal::Accuracy::Exact);
+
+            // P&L per scenario spot, scenarios in parallel; the returned buffer is reused by the next run
+            const std::vector<double> &run(const std::vector<double> &spotPrices,
+                                           Scheduler &scheduler = Scheduler::shared());
+
+            // P&L per shock after horizon years have elapsed (expired legs pay intrinsic)
+            const std::vector<double> &run(const std::vector<MarketShock> &shocks, double horizon,
+                                           Scheduler &scheduler = Scheduler::shared());
+
+            /**
+             * Approximate P&L per shock from a second-order expansion in each
+             * leg's Greeks, computed once:
+             *   dV = delta dS + gamma dS^2 / 2 + vega dSigma + theta horizon
+             * The per-scenario work is a short dot product over aggregated
+             * portfolio terms. Legs with |gamma| above gammaThreshold are
+             * fully revalued instead; with every leg over the threshold the
+             * buffer equals the full run bit for bit.
+             */
+            const std::vector<double> &runTaylor(const std::vector<MarketShock> &shocks, double horizon,
+                                                 double gammaThreshold = HUGE_VAL,
+                                                 Scheduler &scheduler = Scheduler::shared());
+
+            // Legs repriced in full by the last runTaylor
+            std::size_t fullyRevaluedLegs() const { return fullLegs_; }
+
+            // Measures over the last run (empty run gives zeros)
+            ScenarioMeasures measures(double confidence);
+
+            const std::vector<double> &pnl() const { return pnl_; }
+            double baseValue() const { return baseValue_; }
+
+        private:
+            template <typename ShiftFn>
+            const std::vector<double> &revalue(std::size_t scenarios, ShiftFn shift, Scheduler &scheduler);
+
+            const Portfolio &portfolio_;
+            double baseValue_;
+            Normal::Accuracy accuracy_;
+            std::vector<double> pnl_;
+            std::vector<double> losses_; // scratch for selection
+            std::size_t fullLegs_ = 0;
+        };
+
+        // Scenarios in the loss tail at confidence: ceil((1 - confidence) * n), at least 1
+        std::size_t tailScenarios(std::size_t n, double confidence);
+
+        // ScenarioEngine::measures over any P&L buffer; losses is scratch
+        ScenarioMeasures measures(const std::vector<double> &pnl, double confidence, std::vector<double> &losses);
+
         /**
          * Value-at-Risk (VaR)
-         * Maximum loss at given confidence level
+         * Maximum loss at given confidence level. The free functions below
+         * each run their own ScenarioEngine; use the engine directly to get
+         * several measures from one revaluation.
          *
          * @param portfolio Vector of option positions
          * @param confidence Confidence level (0.95 = 95%)
@@ -28,7 +123,7 @@ namespace OptionPricer
          * @param spotPrices Simulated spot prices
          * @return VaR amount
          */
-        double valueAtRisk(const std::vector<std::pair<std::shared_ptr<Option>, int>> &portfolio,
+        double valueAtRisk(const Portfolio &portfolio,
                            double confidence, double horizon,
                            const std::vector<double> &spotPrices);
 
@@ -42,7 +137,7 @@ namespace OptionPricer
          * @param spotPrices Simulated spot prices
          * @return ES amount
          */
-        double expectedShortfall(const std::vector<std::pair<std::shared_ptr<Option>, int>> &portfolio,
+        double expectedShortfall(const Portfolio &portfolio,
                                  double confidence, double horizon,
                                  const std::vector<double> &spotPrices);
 
@@ -50,14 +145,14 @@ namespace OptionPricer
          * Maximum loss
          * Worst-case loss in portfolio
          */
-        double maxLoss(const std::vector<std::pair<std::shared_ptr<Option>, int>> &portfolio,
+        double maxLoss(const Portfolio &portfolio,
                        const std::vector<double> &spotPrices);
 
         /**
          * Probability of profit
          * Percentage of outcomes with positive P&L
          */
-        double probabilityOfProfit(const std::vector<std::pair<std::shared_ptr<Option>, int>> &portfolio,
+        double probabilityOfProfit(const Portfolio &portfolio,
                                    const std::vector<double> &spotPrices);
 
         /**
@@ -76,8 +171,14 @@ namespace OptionPricer
             double pop; // Probability of profit
         };
 
+        /**
+         * Aggregate Greeks plus VaR / ES / max loss / PoP over the horizon, from
+         * 10000 antithetic Monte Carlo paths (see MonteCarloRisk). Each leg's
+         * Greeks come from one Option::greeks() call, so a lattice American
+         * leg costs one tree and its adjoint sweep.
+         */
         PortfolioRisk calculatePortfolioRisk(
-            const std::vector<std::pair<std::shared_ptr<Option>, int>> &portfolio,
+            const Portfolio &portfolio,
             double confidence = 0.95,
             double horizon = 1.0 / 252.0); // 1 day
 
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace OptionPricer
+{
+
+    /**
+     * @class TDigest
+     * @brief Mergeable quantile sketch (Dunning's merging t-digest)
+     *
+     * Values are summarised as weighted centroids whose size is bounded by
+     * the logistic (k2) scale function, in proportion to q (1 - q): centroids
+     * shrink towards both tails, so the 1% or 0.1% of a loss distribution
+     * that VaR and ES read is held far more finely than the body, down to
+     * singletons at the extremes. Memory is O(compression) whatever the
+     * count.
+     *
+     * Digests of disjoint samples merge into a digest of their union, which
+     * is how distributed risk runs combine partitions (RiskCoordinator).
+     * Merging in the same order gives the same digest, bit for bit.
+     */
+    class TDigest
+    {
+    public:
+        struct Centroid
+        {
+            double mean;
+            double weight;
+        };
+
+        static constexpr double DefaultCompression = 500.0;
+
+        explicit TDigest(double compression = DefaultCompression);
+
+        // Rebuild a digest from its parts (as serialised by a worker); throws std::invalid_argument
+        static TDigest fromCentroids(double compression, double min, double max, std::vector<Centroid> centroids);
+
+        void add(double value, double weight = 1.0);
+        void add(const double *values, std::size_t count);
+        void merge(const TDigest &other);
+
+        /**
+         * Value at rank index (0 <= index <= count()), interpolating between
+         * centroid centres; a singleton centroid returns its value exactly.
+         * NaN when empty.
+         */
+        double valueAt(double index) const;
+
+        // valueAt(q * count())
+        double quantile(double q) const;
+
+        // Mean of the largest `weight` values (the mean of the upper tail); NaN when empty
+        double upperMean(double weight) const;
+
+        double count() const;
+        double min() const { return min_; }
+        double max() const { return max_; }
+        double compression() const { return compression_; }
+
+        // Compressed centroids in ascending order of mean
+        const std::vector<Centroid> &centroids() const;
+
+    private:
+        void compress() const;
+
+        double compression_;
+        double min_;
+        double max_;
+        // Added values wait in buffer_ until a query or a full buffer compresses them
+        mutable std::vector<Centroid> centroids_;
+        mutable std::vector<Centroid> buffer_;
+    };
+
+} // namespace OptionPricer
@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 #include "Option.h"
+#include "models/BinomialTree.h"
 
 namespace OptionPricer
 {
@@ -13,11 +14,15 @@ namespace OptionPricer
      *
      * American options can be exercised at any time before expiration,
      * requiring numerical methods like binomial trees or Monte Carlo.
+     * The lattice defaults to CRR; see BinomialTree for the other schemes,
+     * AmericanApprox for the closed-form approximations and FiniteDifference
+     * for the PDE engine, which prices whole chains in one solve.
      */
     class AmericanOption : public Option
     {
     private:
         int steps_; // Number of steps in binomial tree
+        AmericanModel model_;
 
     public:
         /**
@@ -26,24 +31,41 @@ namespace OptionPricer
          * @param r Risk-free rate
          * @param sigma Volatility
          * @param T Time to expiration
-         * @param type "call" or "put"
+         * @param kind Call or put
          * @param steps Number of binomial tree steps (default 100)
+         * @param model Lattice scheme or analytic approximation (default CRR)
          */
         AmericanOption(double S, double K, double r, double sigma, double T,
-                       const std::string &type, int steps = 100);
+                       OptionKind kind, int steps = 100, AmericanModel model = AmericanModel::CRR);
 
         // Pricing and Greeks
         double price() const override;
+        double priceAt(const MarketState &state) const override;
         double delta() const override;
         double gamma() const override;
         double vega() const override;
         double theta() const override;
         double rho() const override;
 
+        /**
+         * Price, delta, gamma and theta from a single tree; vega and rho
+         * from the adjoint sweep of that tree on the lattice models
+         * (BinomialTree::americanSensitivities), from bumped revaluations
+         * on the others
+         */
+        OptionGreeks greeks() const override;
+
+        // greeks() from a lattice model's americanSensitivities
+        static OptionGreeks latticeGreeks(const BinomialTree::LatticeSensitivities &s);
+
+        int steps() const { return steps_; }
+        AmericanModel model() const { return model_; }
+
     private:
-        // Binomial tree implementation
-        double binomialPrice() const;
-        double binomialDelta() const;
+        // One tree, or greeks() for the models without one
+        BinomialTree::LatticeResult lattice() const;
+        BinomialTree::LatticeSensitivities sensitivities() const;
+        double bumpedPrice(double dRate, double dSigma) const;
     };
 
 } // namespace OptionPricer
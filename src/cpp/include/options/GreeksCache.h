@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "options/Option.h"
+#include "options/OptionContract.h"
+
+namespace OptionPricer
+{
+    class Scheduler;
+
+    /**
+     * @class GreeksCache
+     * @brief Concurrent LRU cache of per-option price and Greeks
+     *
+     * Keyed on (model, kind, steps, S, K, r, sigma, T) with each input
+     * rounded to a configurable quantum, so a portfolio re-posted with one
+     * edited leg only reprices that leg. Entries live in independently
+     * locked shards; a miss is computed outside the lock, so two threads
+     * missing the same key may both price it.
+     */
+    class GreeksCache
+    {
+    public:
+        // Absolute rounding step per input; results are those of the first
+        // option priced in a bucket
+        struct Quantization
+        {
+            double price = 1e-9; // spot and strike
+            double rate = 1e-12;
+            double sigma = 1e-12;
+            double time = 1e-12;
+        };
+
+        struct Config
+        {
+            std::size_t capacityBytes = 64u << 20; // 0 disables caching
+            Quantization quantization;
+        };
+
+        struct Stats
+        {
+            std::uint64_t hits;
+            std::uint64_t misses;
+            std::uint64_t evictions;
+            std::size_t entries;
+            std::size_t bytes;
+            std::size_t capacityBytes;
+        };
+
+        GreeksCache();
+        explicit GreeksCache(const Config &config);
+
+        // Cached contract.greeks()
+        OptionGreeks greeks(const OptionContract &contract);
+
+        // Same for a European or American option object
+        OptionGreeks greeks(const Option &option);
+
+        /**
+         * greeks(contracts[i]) into out[i] for every i in [0, count). Misses
+         * on CRR and BBSR contracts that share a scheme and step count are
+         * priced together, BinomialTree::batchLanes() per pass
+         * (americanSensitivitiesBatch), and the rest one by one; both kinds
+         * of task run on scheduler.
+         */
+        void greeks(const OptionContract *contracts, std::size_t count, OptionGreeks *out, Scheduler &scheduler);
+
+        Stats stats() const;
+
+        // Drops every entry and zeroes the hit, miss and eviction counts
+        void clear();
+
+        /**
+         * While bypassed every lookup misses without being counted and
+         * nothing is stored, so repeated requests keep reaching the engines
+         * (API::Warmup's rounds)
+         */
+        void setBypass(bool bypass) { bypass_.store(bypass, std::memory_order_relaxed); }
+
+        // Approximate memory per entry (key, value, list node and hash bucket)
+        static constexpr std::size_t EntryBytes = 128;
+
+        // Process-wide cache; configureShared() only takes effect before first use
+        static GreeksCache &shared();
+        static bool configureShared(const Config &config);
+
+    private:
+        struct Key
+        {
+            std::uint8_t model;
+            std::uint8_t kind;
+            std::int32_t steps;
+            std::int64_t spot, strike, rate, sigma, time;
+
+            bool operator==(const Key &other) const;
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(const Key &key) const;
+        };
+
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            std::list<std::pair<Key, OptionGreeks>> entries; // most recent first
+            std::unordered_map<Key, std::list<std::pair<Key, OptionGreeks>>::iterator, KeyHash> index;
+        };
+
+        static constexpr std::size_t ShardCount = 16;
+
+        Key keyFor(const OptionContract &contract) const;
+        Shard &shardFor(const Key &key);
+        bool cacheable(const Key &key) const;
+        bool lookup(const Key &key, OptionGreeks &out);
+        void insert(const Key &key, const OptionGreeks &value);
+
+        Quantization quantization_;
+        std::size_t capacityBytes_;
+        std::size_t shardCapacity_; // entries per shard
+        std::array<Shard, ShardCount> shards_;
+        std::atomic<std::uint64_t> hits_{0};
+        std::atomic<std::uint64_t> misses_{0};
+        std::atomic<std::uint64_t> evictions_{0};
+        std::atomic<bool> bypass_{false};
+    };
+
+} // namespace OptionPricer
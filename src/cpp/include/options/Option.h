@@ -1,5 +1,7 @@
 #pragma once
-#include <string>
+#include "models/MarketState.h"
+#include "models/OptionGreeks.h"
+#include "models/OptionKind.h"
 
 class Option
 {
@@ -9,25 +11,39 @@ protected:
     double rate_;      // Risk-free rate
     double sigma_;     // Volatility
     double time_;      // Time to expiry (years)
-    std::string type_; // "call" or "put"
+    OptionKind kind_;  // Call or put
 
 public:
     Option(double S, double K, double r, double sigma, double T,
-           const std::string &type)
-        : spot_(S), strike_(K), rate_(r), sigma_(sigma), time_(T), type_(type) {}
+           OptionKind kind)
+        : spot_(S), strike_(K), rate_(r), sigma_(sigma), time_(T), kind_(kind) {}
 
     virtual ~Option() = default;
 
     virtual double price() const = 0;
+
+    // Price under other market inputs without touching this option, so one
+    // instance can be revalued from several threads at once
+    virtual double priceAt(const MarketState &state) const = 0;
+
     virtual double delta() const = 0;
     virtual double gamma() const = 0;
     virtual double vega() const = 0;
     virtual double theta() const = 0;
     virtual double rho() const = 0;
 
+    // Price and all Greeks in one call; engines that can share work across
+    // sensitivities (closed forms, lattices) override this.
+    virtual OptionGreeks greeks() const
+    {
+        return {price(), delta(), gamma(), vega(), theta(), rho()};
+    }
+
+    MarketState market() const { return {spot_, rate_, sigma_, time_}; }
     double getSpot() const { return spot_; }
     double getStrike() const { return strike_; }
     void setSpot(double S) { spot_ = S; }
     void setSigma(double sigma) { sigma_ = sigma; }
-    const std::string &type() const { return type_; }
+    OptionKind kind() const { return kind_; }
+    const char *type() const { return toString(kind_); }
 };
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include "models/AmericanModel.h"
+#include "models/MarketState.h"
+#include "models/NormalDistribution.h"
+#include "models/OptionGreeks.h"
+#include "models/OptionKind.h"
+
+class Option;
+
+enum class ExerciseStyle : std::uint8_t
+{
+    European, // Black-Scholes closed form
+    American  // CRR lattice unless the contract picks another AmericanModel
+};
+
+/**
+ * @struct OptionContract
+ * @brief Value-type option: exercise style, kind and market inputs in one POD
+ *
+ * Priced by switching on the style to the same engines EuropeanOption and
+ * AmericanOption use, with identical results, but without a heap-allocated
+ * Option behind a shared_ptr. Containers of contracts are contiguous, and
+ * copying one involves no refcount traffic.
+ */
+struct OptionContract
+{
+    ExerciseStyle style;
+    OptionKind kind;
+    AmericanModel model; // American only; CRR for European
+    int steps;           // lattice steps; 0 for European
+    double spot;
+    double strike;
+    double rate;
+    double sigma;
+    double time;
+
+    static OptionContract european(double S, double K, double r, double sigma, double T, OptionKind kind)
+    {
+        return {ExerciseStyle::European, kind, AmericanModel::CRR, 0, S, K, r, sigma, T};
+    }
+
+    static OptionContract american(double S, double K, double r, double sigma, double T, OptionKind kind,
+                                   int steps = 100, AmericanModel model = AmericanModel::CRR)
+    {
+        return {ExerciseStyle::American, kind, model, steps, S, K, r, sigma, T};
+    }
+
+    // Snapshot of a European or American option; throws std::invalid_argument for other types
+    static OptionContract from(const Option &option);
+
+    // Heap Option for APIs that still take one
+    std::shared_ptr<Option> toOption() const;
+    // Same, with the Option and its control block allocated from resource
+    std::shared_ptr<Option> toOption(std::pmr::memory_resource *resource) const;
+
+    double price() const;
+    double priceAt(const MarketState &state) const;
+    OptionGreeks greeks() const;
+
+    // European: the closed form with its normal CDF at the given accuracy.
+    // American contracts ignore the accuracy and price as greeks() does.
+    OptionGreeks greeks(OptionPricer::Normal::Accuracy accuracy) const;
+
+    MarketState market() const { return {spot, rate, sigma, time}; }
+};
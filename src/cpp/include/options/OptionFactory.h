@@ -20,20 +20,20 @@ namespace OptionPricer
     public:
         /**
          * Create an option of the specified type
-         * @param optionType "european" or "american"
+         * @param optionType "european", "american" or another american_* model
          * @param S Spot price
          * @param K Strike price
          * @param r Risk-free rate
          * @param sigma Volatility
          * @param T Time to expiration
-         * @param type "call" or "put"
+         * @param kind Call or put
          * @param steps Binomial tree steps (for American options)
          * @return Shared pointer to created Option
          */
         static std::shared_ptr<Option> create(
             const std::string &optionType,
             double S, double K, double r, double sigma, double T,
-            const std::string &type, int steps = 100);
+            OptionKind kind, int steps = 100);
     };
 
 } // namespace OptionPricer
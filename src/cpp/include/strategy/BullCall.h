@@ -27,8 +27,10 @@ namespace OptionPricer
          * @param r Risk-free rate
          * @param sigma Volatility
          * @param T Time to expiration
+         * @param resource Leg storage
          */
-        BullCall(double S, double K1, double K2, double r, double sigma, double T);
+        BullCall(double S, double K1, double K2, double r, double sigma, double T,
+                 std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
         ~BullCall() = default;
     };
@@ -30,11 +30,13 @@ namespace OptionPricer
          * @param r Risk-free rate
          * @param sigma Volatility
          * @param T Time to expiration
+         * @param resource Leg storage
          */
         IronCondor(double S,
                    double K_short_put, double K_short_call,
                    double K_long_put, double K_long_call,
-                   double r, double sigma, double T);
+                   double r, double sigma, double T,
+                   std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
         ~IronCondor() = default;
     };
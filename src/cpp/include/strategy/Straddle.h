@@ -1,15 +1,14 @@
 #pragma once
 #include "strategy/Strategy.h"
-#include "options/EuropeanOption.h"
 
 class Straddle : public Strategy
 {
 public:
-    Straddle(double S, double K, double r, double sigma, double T, bool isLong)
+    Straddle(double S, double K, double r, double sigma, double T, bool isLong,
+             std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : Strategy(resource)
     {
-        auto call = std::make_shared<EuropeanOption>(S, K, r, sigma, T, "call");
-        auto put = std::make_shared<EuropeanOption>(S, K, r, sigma, T, "put");
-        addLeg(call, isLong ? 1 : -1);
-        addLeg(put, isLong ? 1 : -1);
+        addLeg(OptionContract::european(S, K, r, sigma, T, OptionKind::Call), isLong ? 1 : -1);
+        addLeg(OptionContract::european(S, K, r, sigma, T, OptionKind::Put), isLong ? 1 : -1);
     }
 };
@@ -1,37 +1,94 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include "options/Option.h"
+#include "options/OptionContract.h"
 
+/**
+ * Exact shape of a strategy's expiry P&L, which is piecewise linear in
+ * spot with kinks at the strikes
+ */
+struct PayoffProfile
+{
+    std::vector<double> kinks;      // strikes where the slope changes, ascending
+    std::vector<double> breakevens; // spots >= 0 with zero P&L, ascending
+    double maxProfit;               // highest P&L; HUGE_VAL if unbounded
+    double maxLoss;                 // minus the lowest P&L; HUGE_VAL if unbounded
+};
+
+/**
+ * Legs are stored by value as OptionContract in a std::pmr::vector, so a
+ * strategy built on a caller's memory resource (e.g. a monotonic buffer on
+ * the stack) is constructed and priced without touching the heap.
+ */
 class Strategy
 {
 protected:
     struct Leg
     {
-        std::shared_ptr<Option> option;
+        OptionContract contract;
         int quantity;
         double initialPremium; // Store initial premium for payoff calculation
     };
-    std::vector<Leg> legs_;
+    std::pmr::vector<Leg> legs_;
 
 public:
+    explicit Strategy(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : legs_(resource) {}
+
     virtual ~Strategy() = default;
 
-    void addLeg(std::shared_ptr<Option> option, int quantity)
+    void addLeg(const OptionContract &contract, int quantity)
+    {
+        legs_.push_back({contract, quantity, contract.price()});
+    }
+
+    // Add a leg whose premium the caller has already priced
+    void addLeg(const OptionContract &contract, int quantity, double premium)
+    {
+        legs_.push_back({contract, quantity, premium});
+    }
+
+    // Snapshot a heap option into a contract leg
+    void addLeg(const std::shared_ptr<Option> &option, int quantity)
     {
-        legs_.push_back({option, quantity, option->price()});
+        legs_.push_back({OptionContract::from(*option), quantity, option->price()});
     }
 
-    const std::vector<Leg> &getLegs() const
+    // Replace leg index in place with an already priced contract
+    void setLeg(std::size_t index, const OptionContract &contract, int quantity, double premium)
+    {
+        legs_.at(index) = {contract, quantity, premium};
+    }
+
+    const std::pmr::vector<Leg> &getLegs() const
     {
         return legs_;
     }
 
     double payoff(double spotPrice) const;
+
+    /**
+     * Expiry P&L at n evenly spaced spots from spotMin to spotMax (n == 1
+     * gives spotMin). Each leg is applied to the whole grid in one
+     * branch-free loop; values equal payoff() at the same spots bit for bit.
+     */
+    std::vector<double> payoffGrid(double spotMin, double spotMax, std::size_t n) const;
+
+    // Same for arbitrary spots, with no allocation; out must not alias spots
+    void payoffGrid(const double *spots, std::size_t n, double *out) const;
+
+    // Breakevens, kinks and extremes of payoff() in O(legs log legs), independent of any grid
+    PayoffProfile payoffProfile() const;
+
     double totalPrice() const;
     double totalDelta() const;
     double totalGamma() const;
     double totalVega() const;
     double totalTheta() const;
     double totalRho() const;
+
+    // Quantity-weighted price and Greeks, one greeks() call per leg
+    OptionGreeks totalGreeks() const;
 };
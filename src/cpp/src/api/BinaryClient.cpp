@@ -0,0 +1,230 @@
+#include "api/BinaryClient.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        namespace
+        {
+#ifdef MSG_NOSIGNAL
+            constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+            constexpr int SendFlags = 0; // SO_NOSIGPIPE is set per socket instead
+#endif
+
+            // How often a waiting call looks at its abandon flag
+            constexpr int PollSliceMs = 20;
+
+            using Clock = std::chrono::steady_clock;
+
+            std::runtime_error transportError(const std::string &address, const std::string &what)
+            {
+                return std::runtime_error(address + ": " + what);
+            }
+
+            int remainingMs(Clock::time_point deadline)
+            {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+                return static_cast<int>(std::max<long long>(0, std::min<long long>(left, PollSliceMs)));
+            }
+
+            // Wait for events on fd in slices, giving up at the deadline or when abandoned
+            void waitFor(int fd, short events, Clock::time_point deadline, const std::atomic<bool> *abandon,
+                         const std::string &address)
+            {
+                for (;;)
+                {
+                    if (abandon && abandon->load())
+                        throw transportError(address, "call abandoned");
+                    if (Clock::now() >= deadline)
+                        throw transportError(address, "timed out");
+                    pollfd p{fd, events, 0};
+                    const int ready = ::poll(&p, 1, remainingMs(deadline));
+                    if (ready < 0 && errno != EINTR)
+                        throw transportError(address, std::strerror(errno));
+                    if (ready > 0)
+                        return;
+                }
+            }
+
+            // Non-blocking connect to the first address that accepts
+            int connectTo(const std::string &address, Clock::time_point deadline)
+            {
+                std::vector<std::pair<sockaddr_storage, socklen_t>> targets;
+                int family = AF_UNIX;
+                if (address.rfind("unix:", 0) == 0)
+                {
+                    sockaddr_un un{};
+                    const std::string path = address.substr(5);
+                    if (path.empty() || path.size() >= sizeof un.sun_path)
+                        throw transportError(address, "invalid unix socket path");
+                    un.sun_family = AF_UNIX;
+                    std::memcpy(un.sun_path, path.c_str(), path.size() + 1);
+                    sockaddr_storage storage{};
+                    std::memcpy(&storage, &un, sizeof un);
+                    targets.emplace_back(storage, static_cast<socklen_t>(sizeof un));
+                }
+                else
+                {
+                    const std::size_t colon = address.rfind(':');
+                    if (colon == std::string::npos || colon == 0 || colon + 1 == address.size())
+                        throw transportError(address, "expected host:port or unix:/path");
+                    addrinfo hints{};
+                    hints.ai_family = AF_UNSPEC;
+                    hints.ai_socktype = SOCK_STREAM;
+                    addrinfo *found = nullptr;
+                    if (::getaddrinfo(address.substr(0, colon).c_str(), address.substr(colon + 1).c_str(), &hints,
+                                      &found) != 0)
+                        throw transportError(address, "could not resolve host");
+                    for (addrinfo *a = found; a; a = a->ai_next)
+                    {
+                        sockaddr_storage storage{};
+                        std::memcpy(&storage, a->ai_addr, a->ai_addrlen);
+                        targets.emplace_back(storage, a->ai_addrlen);
+                    }
+                    ::freeaddrinfo(found);
+                    family = AF_INET;
+                }
+
+                std::string lastError = "no address";
+                for (auto &target : targets)
+                {
+                    const int fd = ::socket(target.first.ss_family, SOCK_STREAM, 0);
+                    if (fd < 0)
+                        continue;
+                    const int yes = 1;
+                    if (family != AF_UNIX)
+                        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+#ifdef SO_NOSIGPIPE
+                    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof yes);
+#endif
+                    const int flags = ::fcntl(fd, F_GETFL, 0);
+                    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+                    int error = 0;
+                    if (::connect(fd, reinterpret_cast<sockaddr *>(&target.first), target.second) != 0)
+                    {
+                        error = errno;
+                        if (error == EINPROGRESS)
+                        {
+                            try
+                            {
+                                waitFor(fd, POLLOUT, deadline, nullptr, address);
+                            }
+                            catch (...)
+                            {
+                                ::close(fd);
+                                throw;
+                            }
+                            socklen_t length = sizeof error;
+                            ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                        }
+                    }
+                    if (error == 0)
+                    {
+                        // Blocking again: sends are bounded by the peer reading, receives by poll
+                        ::fcntl(fd, F_SETFL, flags);
+                        return fd;
+                    }
+                    lastError = std::strerror(error);
+                    ::close(fd);
+                }
+                throw transportError(address, "could not connect: " + lastError);
+            }
+        } // namespace
+
+        BinaryClient::BinaryClient(std::string address, std::size_t maxFrameBytes)
+            : address_(std::move(address)), maxFrameBytes_(maxFrameBytes)
+        {
+        }
+
+        BinaryClient::~BinaryClient()
+        {
+            close();
+        }
+
+        void BinaryClient::close()
+        {
+            if (fd_ >= 0)
+                ::close(fd_);
+            fd_ = -1;
+        }
+
+        void BinaryClient::connect(Clock::time_point deadline)
+        {
+            close();
+            fd_ = connectTo(address_, deadline);
+        }
+
+        BinaryClient::Response BinaryClient::call(BinaryProtocol::Opcode opcode, std::string_view payload,
+                                                  Clock::time_point deadline, const std::atomic<bool> *abandon)
+        {
+            try
+            {
+                if (!connected())
+                    connect(deadline);
+
+                const std::uint32_t id = nextId_++;
+                std::string request;
+                BinaryProtocol::appendFrame(request, id, opcode, BinaryProtocol::Status::Ok, payload);
+                std::size_t sent = 0;
+                while (sent < request.size())
+                {
+                    waitFor(fd_, POLLOUT, deadline, abandon, address_);
+                    const ssize_t n = ::send(fd_, request.data() + sent, request.size() - sent, SendFlags);
+                    if (n < 0 && (errno == EINTR || errno == EAGAIN))
+                        continue;
+                    if (n <= 0)
+                        throw transportError(address_, "send failed");
+                    sent += static_cast<std::size_t>(n);
+                }
+
+                std::string input;
+                char chunk[1 << 16];
+                for (;;)
+                {
+                    std::string_view view = input;
+                    BinaryProtocol::Frame frame;
+                    if (BinaryProtocol::nextFrame(view, frame, maxFrameBytes_))
+                    {
+                        if (frame.id != id || frame.opcode != static_cast<std::uint16_t>(opcode))
+                            throw transportError(address_, "response does not match the request");
+                        return {static_cast<BinaryProtocol::Status>(frame.status), std::string(frame.payload)};
+                    }
+                    waitFor(fd_, POLLIN, deadline, abandon, address_);
+                    const ssize_t n = ::recv(fd_, chunk, sizeof chunk, 0);
+                    if (n < 0 && errno == EINTR)
+                        continue;
+                    if (n <= 0)
+                        throw transportError(address_, "connection closed");
+                    input.append(chunk, static_cast<std::size_t>(n));
+                }
+            }
+            catch (const std::length_error &e)
+            {
+                close();
+                throw transportError(address_, e.what());
+            }
+            catch (...)
+            {
+                close();
+                throw;
+            }
+        }
+
+    } // namespace API
+} // namespace OptionPricer
@@ -0,0 +1,636 @@
+#include "api/BinaryProtocol.h"
+#include "api/PricingEndpoint.h"
+#include "api/ResponseWriter.h"
+#include "concurrency/Scheduler.h"
+#include "models/AmericanModel.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+        namespace BinaryProtocol
+        {
+
+            namespace
+            {
+                void putLittleEndian(std::string &out, std::uint64_t value, int bytes)
+                {
+                    for (int i = 0; i < bytes; ++i)
+                        out += static_cast<char>((value >> (8 * i)) & 0xff);
+                }
+
+                void putDouble(std::string &out, double value)
+                {
+                    std::uint64_t bits;
+                    std::memcpy(&bits, &value, sizeof bits);
+                    putLittleEndian(out, bits, 8);
+                }
+
+                std::uint64_t getLittleEndian(const char *data, int bytes)
+                {
+                    std::uint64_t value = 0;
+                    for (int i = 0; i < bytes; ++i)
+                        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+                    return value;
+                }
+
+                // Bounds-checked little-endian cursor over a payload
+                class Reader
+                {
+                public:
+                    explicit Reader(std::string_view data) : data_(data) {}
+
+                    std::uint64_t next(int bytes)
+                    {
+                        if (data_.size() - pos_ < static_cast<std::size_t>(bytes))
+                            throw std::invalid_argument("Truncated payload");
+                        const std::uint64_t value = getLittleEndian(data_.data() + pos_, bytes);
+                        pos_ += bytes;
+                        return value;
+                    }
+
+                    std::uint32_t u32() { return static_cast<std::uint32_t>(next(4)); }
+
+                    std::string_view bytes(std::size_t n)
+                    {
+                        if (data_.size() - pos_ < n)
+                            throw std::invalid_argument("Truncated payload");
+                        const std::string_view view = data_.substr(pos_, n);
+                        pos_ += n;
+                        return view;
+                    }
+
+                    double f64()
+                    {
+                        const std::uint64_t bits = next(8);
+                        double value;
+                        std::memcpy(&value, &bits, sizeof value);
+                        return value;
+                    }
+
+                    int count()
+                    {
+                        const std::uint32_t value = u32();
+                        if (value > static_cast<std::uint32_t>(std::numeric_limits<int>::max()))
+                            throw std::invalid_argument("Count out of range");
+                        return static_cast<int>(value);
+                    }
+
+                    std::size_t remaining() const { return data_.size() - pos_; }
+
+                    void expectEnd() const
+                    {
+                        if (pos_ != data_.size())
+                            throw std::invalid_argument("Unexpected bytes after payload");
+                    }
+
+                private:
+                    std::string_view data_;
+                    std::size_t pos_ = 0;
+                };
+
+                const char *kindName(std::uint64_t code)
+                {
+                    if (code > 1)
+                        throw std::invalid_argument("Invalid option type code: " + std::to_string(code));
+                    return code == 0 ? "call" : "put";
+                }
+
+                // 0 european, then 1 + AmericanModel
+                const char *modelName(std::uint64_t code)
+                {
+                    if (code > 1 + static_cast<std::uint64_t>(AmericanModel::FiniteDifference))
+                        throw std::invalid_argument("Invalid model code: " + std::to_string(code));
+                    return code == 0 ? "european" : toString(static_cast<AmericanModel>(code - 1));
+                }
+
+                std::uint8_t kindCode(const std::string &type)
+                {
+                    return parseOptionKind(type) == OptionKind::Call ? 0 : 1;
+                }
+
+                std::uint8_t modelCode(const std::string &model)
+                {
+                    return model == "european" ? 0 : 1 + static_cast<std::uint8_t>(parseAmericanModel(model));
+                }
+
+                void putGreeks(std::string &out, const OptionGreeks &g)
+                {
+                    for (double v : {g.price, g.delta, g.gamma, g.vega, g.theta, g.rho})
+                        putDouble(out, v);
+                }
+
+                OptionGreeks readGreeks(Reader &in)
+                {
+                    OptionGreeks g;
+                    for (double *v : {&g.price, &g.delta, &g.gamma, &g.vega, &g.theta, &g.rho})
+                        *v = in.f64();
+                    return g;
+                }
+
+                void putContract(std::string &out, const OptionContract &c)
+                {
+                    putLittleEndian(out, c.kind == OptionKind::Call ? 0 : 1, 1);
+                    putLittleEndian(out, c.style == ExerciseStyle::European ? 0 : 1 + static_cast<std::uint8_t>(c.model), 1);
+                    putLittleEndian(out, 0, 2);
+                    putLittleEndian(out, static_cast<std::uint32_t>(c.steps), 4);
+                    for (double v : {c.spot, c.strike, c.rate, c.sigma, c.time})
+                        putDouble(out, v);
+                }
+
+                // An option record as a contract; positions arrive already resolved, so only sanity is checked
+                OptionContract readContract(Reader &in)
+                {
+                    const std::uint64_t kindCode = in.next(1), model = in.next(1);
+                    const OptionKind kind = parseOptionKind(kindName(kindCode));
+                    modelName(model);
+                    in.next(2);
+                    const int steps = in.count();
+                    const double spot = in.f64(), strike = in.f64(), rate = in.f64(), sigma = in.f64(), time = in.f64();
+                    if (!(spot > 0.0 && strike > 0.0 && sigma > 0.0 && time >= 0.0) || !std::isfinite(spot) ||
+                        !std::isfinite(strike) || !std::isfinite(rate) || !std::isfinite(sigma) || !std::isfinite(time))
+                        throw std::invalid_argument("Invalid position inputs");
+                    if (model == 0)
+                        return OptionContract::european(spot, strike, rate, sigma, time, kind);
+                    if (steps < 1)
+                        throw std::invalid_argument("American positions need at least one step");
+                    return OptionContract::american(spot, strike, rate, sigma, time, kind, steps,
+                                                    static_cast<AmericanModel>(model - 1));
+                }
+
+                enum RiskFlags : std::uint8_t
+                {
+                    Taylor = 1,
+                    Summarised = 2
+                };
+
+                MonteCarloRisk::Partial runRiskTask(const RiskTask &task)
+                {
+                    RiskMeasures::Portfolio portfolio;
+                    portfolio.reserve(task.positions.size());
+                    for (const auto &position : task.positions)
+                        portfolio.emplace_back(position.first.toOption(), position.second);
+                    return MonteCarloRisk::runPartial(portfolio, task.spec, task.begin, task.end, task.summarise,
+                                                      task.compression, Scheduler::shared());
+                }
+
+                void appendRiskPartial(std::string &out, const MonteCarloRisk::Partial &partial)
+                {
+                    putLittleEndian(out, partial.begin, 8);
+                    putLittleEndian(out, partial.end, 8);
+                    putDouble(out, partial.baseValue);
+                    putLittleEndian(out, partial.fullyRevaluedLegs, 4);
+                    putLittleEndian(out, partial.summarised ? RiskFlags::Summarised : 0, 4);
+                    if (!partial.summarised)
+                    {
+                        for (double p : partial.pnl)
+                            putDouble(out, p);
+                        return;
+                    }
+                    const MonteCarloRisk::Summary &summary = partial.summary;
+                    const std::vector<TDigest::Centroid> &centroids = summary.losses.centroids();
+                    putLittleEndian(out, summary.paths, 8);
+                    putDouble(out, summary.mean);
+                    putDouble(out, summary.m2);
+                    putLittleEndian(out, summary.profitable, 8);
+                    putDouble(out, summary.losses.compression());
+                    putDouble(out, summary.losses.min());
+                    putDouble(out, summary.losses.max());
+                    putLittleEndian(out, centroids.size(), 4);
+                    putLittleEndian(out, 0, 4);
+                    for (const TDigest::Centroid &c : centroids)
+                    {
+                        putDouble(out, c.mean);
+                        putDouble(out, c.weight);
+                    }
+                }
+
+                // Header with the length left to fill in; returns where the frame starts
+                std::size_t beginFrame(std::string &out, std::uint32_t id, std::uint16_t opcode)
+                {
+                    const std::size_t start = out.size();
+                    putLittleEndian(out, 0, 4);
+                    putLittleEndian(out, id, 4);
+                    putLittleEndian(out, opcode, 2);
+                    putLittleEndian(out, static_cast<std::uint16_t>(Status::Ok), 2);
+                    return start;
+                }
+
+                void endFrame(std::string &out, std::size_t start, Status status)
+                {
+                    const std::uint64_t length = out.size() - start - 4;
+                    if (length > std::numeric_limits<std::uint32_t>::max())
+                        throw std::length_error("Response exceeds the frame size limit");
+                    for (int i = 0; i < 4; ++i)
+                        out[start + i] = static_cast<char>((length >> (8 * i)) & 0xff);
+                    const auto code = static_cast<std::uint16_t>(status);
+                    out[start + 10] = static_cast<char>(code & 0xff);
+                    out[start + 11] = static_cast<char>(code >> 8);
+                }
+
+                void appendPriceBatchResponse(std::string &out, const std::vector<OptionBatchItem> &items)
+                {
+                    const PricingEndpoint::BatchPricing batch = PricingEndpoint::priceBatch(items);
+                    putLittleEndian(out, items.size(), 4);
+                    putLittleEndian(out, batch.contracts.size(), 4);
+                    std::uint32_t errorCount = 0;
+                    for (std::size_t i = 0; i < items.size(); ++i)
+                    {
+                        const std::size_t u = batch.slot[i];
+                        const bool ok = u != PricingEndpoint::BatchPricing::npos;
+                        errorCount += !ok;
+                        putLittleEndian(out, static_cast<std::uint16_t>(ok ? Status::Ok : Status::Error), 4);
+                        putLittleEndian(out, 0, 4);
+                        putGreeks(out, ok ? batch.greeks[u] : OptionGreeks{0, 0, 0, 0, 0, 0});
+                    }
+                    putLittleEndian(out, errorCount, 4);
+                    for (std::size_t i = 0; i < items.size(); ++i)
+                    {
+                        if (batch.slot[i] != PricingEndpoint::BatchPricing::npos)
+                            continue;
+                        putLittleEndian(out, i, 4);
+                        putLittleEndian(out, batch.errors[i].size(), 4);
+                        out += batch.errors[i];
+                    }
+                }
+            } // namespace
+
+            bool nextFrame(std::string_view &input, Frame &frame, std::size_t maxFrameBytes)
+            {
+                if (input.size() < 4)
+                    return false;
+                const std::uint64_t length = getLittleEndian(input.data(), 4);
+                if (length < HeaderBytes - 4 || length > maxFrameBytes)
+                    throw std::length_error("Invalid frame length: " + std::to_string(length));
+                if (input.size() - 4 < length)
+                    return false;
+
+                frame.id = static_cast<std::uint32_t>(getLittleEndian(input.data() + 4, 4));
+                frame.opcode = static_cast<std::uint16_t>(getLittleEndian(input.data() + 8, 2));
+                frame.status = static_cast<std::uint16_t>(getLittleEndian(input.data() + 10, 2));
+                frame.payload = input.substr(HeaderBytes, length - (HeaderBytes - 4));
+                input.remove_prefix(4 + length);
+                return true;
+            }
+
+            void appendFrame(std::string &out, std::uint32_t id, Opcode opcode, Status status,
+                             std::string_view payload)
+            {
+                const std::size_t start = beginFrame(out, id, static_cast<std::uint16_t>(opcode));
+                out.append(payload.data(), payload.size());
+                endFrame(out, start, status);
+            }
+
+            void appendOption(std::string &payload, const OptionParams &params)
+            {
+                putLittleEndian(payload, kindCode(params.type), 1);
+                putLittleEndian(payload, modelCode(params.model), 1);
+                putLittleEndian(payload, 0, 2);
+                putLittleEndian(payload, static_cast<std::uint32_t>(params.steps), 4);
+                for (double v : {params.spot, params.strike, params.rate, params.volatility, params.time})
+                    putDouble(payload, v);
+            }
+
+            std::string encodePriceBatch(const std::vector<OptionParams> &options)
+            {
+                std::string payload;
+                payload.reserve(8 + options.size() * OptionRecordBytes);
+                putLittleEndian(payload, options.size(), 4);
+                putLittleEndian(payload, 0, 4);
+                for (const auto &option : options)
+                    appendOption(payload, option);
+                return payload;
+            }
+
+            std::string encodePortfolio(const PortfolioParams &params)
+            {
+                std::string payload;
+                payload.reserve(24 + params.legs.size() * LegRecordBytes);
+                putDouble(payload, params.spot);
+                putDouble(payload, params.rate);
+                putLittleEndian(payload, static_cast<std::uint32_t>(params.payoffSteps), 4);
+                putLittleEndian(payload, params.legs.size(), 4);
+                for (const auto &leg : params.legs)
+                {
+                    putLittleEndian(payload, kindCode(leg.optionType), 1);
+                    putLittleEndian(payload, modelCode(leg.model), 1);
+                    putLittleEndian(payload, 0, 2);
+                    putLittleEndian(payload, static_cast<std::uint32_t>(leg.quantity), 4);
+                    putLittleEndian(payload, static_cast<std::uint32_t>(leg.steps), 4);
+                    putLittleEndian(payload, 0, 4);
+                    for (double v : {leg.strike, leg.volatility, leg.time})
+                        putDouble(payload, v);
+                }
+                return payload;
+            }
+
+            std::string encodeRiskTask(const RiskTask &task)
+            {
+                const MonteCarloRisk::Spec &spec = task.spec;
+                std::string payload;
+                payload.reserve(96 + task.positions.size() * PositionRecordBytes);
+                putLittleEndian(payload, task.begin, 8);
+                putLittleEndian(payload, task.end, 8);
+                putLittleEndian(payload, spec.paths, 8);
+                putLittleEndian(payload, spec.seed, 8);
+                putLittleEndian(payload, static_cast<std::uint8_t>(spec.sampling), 1);
+                putLittleEndian(payload, (spec.taylor ? RiskFlags::Taylor : 0) | (task.summarise ? RiskFlags::Summarised : 0), 1);
+                putLittleEndian(payload, static_cast<std::uint8_t>(spec.accuracy), 1);
+                putLittleEndian(payload, 0, 1);
+                putLittleEndian(payload, task.positions.size(), 4);
+                for (double v : {spec.horizon, spec.drift, spec.spotVol, spec.volOfVol, spec.correlation,
+                                 spec.gammaThreshold, task.compression})
+                    putDouble(payload, v);
+                for (const auto &position : task.positions)
+                {
+                    putContract(payload, position.first);
+                    putLittleEndian(payload, static_cast<std::uint32_t>(position.second), 4);
+                    putLittleEndian(payload, 0, 4);
+                }
+                return payload;
+            }
+
+            OptionParams decodeOption(std::string_view payload)
+            {
+                Reader in(payload);
+                OptionParams params;
+                params.type = kindName(in.next(1));
+                params.model = modelName(in.next(1));
+                in.next(2);
+                params.steps = in.count();
+                params.spot = in.f64();
+                params.strike = in.f64();
+                params.rate = in.f64();
+                params.volatility = in.f64();
+                params.time = in.f64();
+                in.expectEnd();
+                return params;
+            }
+
+            std::vector<OptionBatchItem> decodePriceBatch(std::string_view payload)
+            {
+                Reader in(payload);
+                const std::size_t count = in.u32();
+                in.next(4);
+                if (in.remaining() != count * OptionRecordBytes)
+                    throw std::invalid_argument("PriceBatch count does not match the payload size");
+
+                // Records are fixed-size, so a bad one fails only itself
+                std::vector<OptionBatchItem> items(count);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    try
+                    {
+                        items[i].params = decodeOption(payload.substr(8 + i * OptionRecordBytes, OptionRecordBytes));
+                    }
+                    catch (const std::exception &e)
+                    {
+                        items[i].error = e.what();
+                    }
+                }
+                return items;
+            }
+
+            PortfolioParams decodePortfolio(std::string_view payload, std::pmr::memory_resource *resource)
+            {
+                Reader in(payload);
+                PortfolioParams params(resource);
+                params.spot = in.f64();
+                params.rate = in.f64();
+                params.payoffSteps = in.count();
+                const std::size_t legCount = in.u32();
+                if (legCount == 0)
+                    throw std::invalid_argument("legs must be a non-empty array");
+                if (in.remaining() != legCount * LegRecordBytes)
+                    throw std::invalid_argument("Portfolio leg count does not match the payload size");
+
+                params.legs.resize(legCount);
+                for (LegParams &leg : params.legs)
+                {
+                    leg.optionType = kindName(in.next(1));
+                    leg.model = modelName(in.next(1));
+                    in.next(2);
+                    leg.quantity = static_cast<std::int32_t>(in.u32());
+                    leg.steps = in.count();
+                    in.next(4);
+                    leg.strike = in.f64();
+                    leg.volatility = in.f64();
+                    leg.time = in.f64();
+                }
+                return params;
+            }
+
+            RiskTask decodeRiskTask(std::string_view payload)
+            {
+                Reader in(payload);
+                RiskTask task;
+                MonteCarloRisk::Spec &spec = task.spec;
+                task.begin = in.next(8);
+                task.end = in.next(8);
+                spec.paths = in.next(8);
+                spec.seed = in.next(8);
+                const std::uint64_t sampling = in.next(1);
+                if (sampling > static_cast<std::uint64_t>(MonteCarloRisk::Sampling::Sobol))
+                    throw std::invalid_argument("Invalid sampling code: " + std::to_string(sampling));
+                spec.sampling = static_cast<MonteCarloRisk::Sampling>(sampling);
+                const std::uint64_t flags = in.next(1);
+                spec.taylor = flags & RiskFlags::Taylor;
+                task.summarise = flags & RiskFlags::Summarised;
+                const std::uint64_t accuracy = in.next(1);
+                if (accuracy > static_cast<std::uint64_t>(Normal::Accuracy::Table))
+                    throw std::invalid_argument("Invalid accuracy code: " + std::to_string(accuracy));
+                spec.accuracy = static_cast<Normal::Accuracy>(accuracy);
+                in.next(1);
+                const std::size_t count = in.u32();
+                for (double *v : {&spec.horizon, &spec.drift, &spec.spotVol, &spec.volOfVol, &spec.correlation,
+                                  &spec.gammaThreshold, &task.compression})
+                    *v = in.f64();
+                if (in.remaining() != count * PositionRecordBytes)
+                    throw std::invalid_argument("RiskPartition position count does not match the payload size");
+
+                task.positions.reserve(count);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    const OptionContract contract = readContract(in);
+                    const int quantity = static_cast<std::int32_t>(in.u32());
+                    in.next(4);
+                    task.positions.emplace_back(contract, quantity);
+                }
+                return task;
+            }
+
+            OptionGreeks decodeGreeks(std::string_view payload)
+            {
+                Reader in(payload);
+                const OptionGreeks greeks = readGreeks(in);
+                in.expectEnd();
+                return greeks;
+            }
+
+            std::vector<PriceResult> decodePriceBatchResults(std::string_view payload)
+            {
+                Reader in(payload);
+                const std::size_t count = in.u32();
+                in.next(4);
+                if (in.remaining() < count * (8 + GreeksRecordBytes))
+                    throw std::invalid_argument("Truncated payload");
+
+                std::vector<PriceResult> results(count);
+                for (PriceResult &result : results)
+                {
+                    in.next(8);
+                    result.greeks = readGreeks(in);
+                }
+                const std::size_t errorCount = in.u32();
+                for (std::size_t e = 0; e < errorCount; ++e)
+                {
+                    const std::size_t index = in.u32();
+                    const std::size_t length = in.u32();
+                    if (index >= count)
+                        throw std::invalid_argument("Malformed error table");
+                    results[index].error = std::string(in.bytes(length));
+                }
+                in.expectEnd();
+                return results;
+            }
+
+            MonteCarloRisk::Partial decodeRiskPartial(std::string_view payload)
+            {
+                Reader in(payload);
+                MonteCarloRisk::Partial partial;
+                partial.begin = in.next(8);
+                partial.end = in.next(8);
+                partial.baseValue = in.f64();
+                partial.fullyRevaluedLegs = in.u32();
+                partial.summarised = in.u32() & RiskFlags::Summarised;
+                if (partial.end < partial.begin)
+                    throw std::invalid_argument("Malformed path range");
+                if (!partial.summarised)
+                {
+                    if (in.remaining() != (partial.end - partial.begin) * 8)
+                        throw std::invalid_argument("P&L count does not match the path range");
+                    partial.pnl.resize(partial.end - partial.begin);
+                    for (double &p : partial.pnl)
+                        p = in.f64();
+                    return partial;
+                }
+
+                MonteCarloRisk::Summary &summary = partial.summary;
+                summary.paths = in.next(8);
+                summary.mean = in.f64();
+                summary.m2 = in.f64();
+                summary.profitable = in.next(8);
+                const double compression = in.f64();
+                const double min = in.f64();
+                const double max = in.f64();
+                const std::size_t count = in.u32();
+                in.next(4);
+                if (in.remaining() != count * 16)
+                    throw std::invalid_argument("Centroid count does not match the payload size");
+                std::vector<TDigest::Centroid> centroids(count);
+                for (TDigest::Centroid &c : centroids)
+                {
+                    c.mean = in.f64();
+                    c.weight = in.f64();
+                }
+                summary.losses = TDigest::fromCentroids(compression, min, max, std::move(centroids));
+                return partial;
+            }
+
+            std::size_t handleFrames(std::string_view input, std::string &output, std::size_t maxFrameBytes)
+            {
+                std::string_view rest = input;
+                std::vector<Frame> frames;
+                Frame frame;
+                while (nextFrame(rest, frame, maxFrameBytes))
+                    frames.push_back(frame);
+
+                // Single prices that arrived together are priced as one batch
+                std::vector<OptionBatchItem> prices;
+                for (const Frame &f : frames)
+                {
+                    if (f.opcode != static_cast<std::uint16_t>(Opcode::Price))
+                        continue;
+                    OptionBatchItem item;
+                    try
+                    {
+                        item.params = decodeOption(f.payload);
+                    }
+                    catch (const std::exception &e)
+                    {
+                        item.error = e.what();
+                    }
+                    prices.push_back(std::move(item));
+                }
+                PricingEndpoint::BatchPricing priced;
+                std::string pricingError;
+                if (!prices.empty())
+                {
+                    try
+                    {
+                        priced = PricingEndpoint::priceBatch(prices);
+                    }
+                    catch (const std::exception &e)
+                    {
+                        pricingError = e.what();
+                    }
+                }
+
+                std::size_t nextPrice = 0;
+                for (const Frame &f : frames)
+                {
+                    const std::size_t start = beginFrame(output, f.id, f.opcode);
+                    try
+                    {
+                        switch (static_cast<Opcode>(f.opcode))
+                        {
+                        case Opcode::Ping:
+                            break;
+                        case Opcode::Price:
+                        {
+                            const std::size_t i = nextPrice++;
+                            if (!pricingError.empty())
+                                throw std::runtime_error(pricingError);
+                            const std::size_t u = priced.slot[i];
+                            if (u == PricingEndpoint::BatchPricing::npos)
+                                throw std::invalid_argument(priced.errors[i]);
+                            putGreeks(output, priced.greeks[u]);
+                            break;
+                        }
+                        case Opcode::PriceBatch:
+                            appendPriceBatchResponse(output, decodePriceBatch(f.payload));
+                            break;
+                        case Opcode::Portfolio:
+                        {
+                            RequestArena::Scope arena;
+                            const PortfolioParams params = decodePortfolio(f.payload);
+                            output += ResponseWriter::write(PricingEndpoint::buildPortfolioResponse(params),
+                                                            ResponseWriter::Format::Binary);
+                            break;
+                        }
+                        case Opcode::RiskPartition:
+                            appendRiskPartial(output, runRiskTask(decodeRiskTask(f.payload)));
+                            break;
+                        default:
+                            throw std::invalid_argument("Unknown opcode: " + std::to_string(f.opcode));
+                        }
+                        endFrame(output, start, Status::Ok);
+                    }
+                    catch (const std::exception &e)
+                    {
+                        // Drop whatever part of the payload was written and answer with the message
+                        output.resize(start + HeaderBytes);
+                        output += e.what();
+                        endFrame(output, start, Status::Error);
+                    }
+                }
+                return input.size() - rest.size();
+            }
+
+        } // namespace BinaryProtocol
+    } // namespace API
+} // namespace OptionPricer
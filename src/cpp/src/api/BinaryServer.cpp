@@ -0,0 +1,295 @@
+#include "api/BinaryServer.h"
+#include "api/BinaryProtocol.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        namespace
+        {
+#ifdef MSG_NOSIGNAL
+            constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+            constexpr int SendFlags = 0; // SO_NOSIGPIPE is set per socket instead
+#endif
+
+            // A client that stops reading cannot hold stop() up for longer than this
+            constexpr int SendTimeoutSec = 5;
+
+            std::runtime_error socketError(const std::string &what)
+            {
+                return std::runtime_error(what + ": " + std::strerror(errno));
+            }
+
+            bool sendAll(int fd, const std::string &data)
+            {
+                std::size_t sent = 0;
+                while (sent < data.size())
+                {
+                    const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, SendFlags);
+                    if (n < 0 && errno == EINTR)
+                        continue;
+                    if (n <= 0)
+                        return false;
+                    sent += static_cast<std::size_t>(n);
+                }
+                return true;
+            }
+
+            int listenTcp(const std::string &host, int port, int &boundPort)
+            {
+                addrinfo hints{};
+                hints.ai_family = AF_UNSPEC;
+                hints.ai_socktype = SOCK_STREAM;
+                hints.ai_flags = AI_PASSIVE;
+                addrinfo *addresses = nullptr;
+                const std::string service = std::to_string(port);
+                if (::getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0)
+                    throw std::runtime_error("Could not resolve " + host);
+
+                int fd = -1;
+                for (addrinfo *a = addresses; a && fd < 0; a = a->ai_next)
+                {
+                    fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+                    if (fd < 0)
+                        continue;
+                    const int yes = 1;
+                    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes);
+                    if (::bind(fd, a->ai_addr, a->ai_addrlen) != 0 || ::listen(fd, SOMAXCONN) != 0)
+                    {
+                        ::close(fd);
+                        fd = -1;
+                    }
+                }
+                ::freeaddrinfo(addresses);
+                if (fd < 0)
+                    throw socketError("Could not listen on " + host + ":" + service);
+
+                sockaddr_storage bound{};
+                socklen_t length = sizeof bound;
+                ::getsockname(fd, reinterpret_cast<sockaddr *>(&bound), &length);
+                boundPort = ntohs(bound.ss_family == AF_INET6
+                                      ? reinterpret_cast<sockaddr_in6 *>(&bound)->sin6_port
+                                      : reinterpret_cast<sockaddr_in *>(&bound)->sin_port);
+                return fd;
+            }
+
+            int listenUnix(const std::string &path)
+            {
+                sockaddr_un address{};
+                if (path.size() >= sizeof address.sun_path)
+                    throw std::runtime_error("Unix socket path too long: " + path);
+                address.sun_family = AF_UNIX;
+                std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+                const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+                if (fd < 0)
+                    throw socketError("Could not create unix socket");
+                ::unlink(path.c_str()); // stale socket from an earlier run
+                if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof address) != 0 ||
+                    ::listen(fd, SOMAXCONN) != 0)
+                {
+                    const std::runtime_error error = socketError("Could not listen on " + path);
+                    ::close(fd);
+                    throw error;
+                }
+                return fd;
+            }
+        } // namespace
+
+        BinaryServer::BinaryServer(const Config &config)
+            : config_(config)
+        {
+        }
+
+        BinaryServer::~BinaryServer()
+        {
+            stop();
+        }
+
+        void BinaryServer::start()
+        {
+            if (running_)
+                return;
+            if (::pipe(wakeFds_) != 0)
+                throw socketError("Could not create wake pipe");
+
+            try
+            {
+                if (config_.port >= 0)
+                    listeners_.push_back(listenTcp(config_.host, config_.port, boundPort_));
+                if (!config_.unixPath.empty())
+                    listeners_.push_back(listenUnix(config_.unixPath));
+            }
+            catch (...)
+            {
+                for (int fd : listeners_)
+                    ::close(fd);
+                listeners_.clear();
+                ::close(wakeFds_[0]);
+                ::close(wakeFds_[1]);
+                wakeFds_[0] = wakeFds_[1] = -1;
+                throw;
+            }
+
+            running_ = true;
+            for (std::size_t i = 0; i < listeners_.size(); ++i)
+            {
+                const bool tcp = i == 0 && config_.port >= 0;
+                acceptors_.emplace_back([this, fd = listeners_[i], tcp]
+                                        { acceptLoop(fd, tcp); });
+            }
+        }
+
+        void BinaryServer::stop()
+        {
+            if (!running_.exchange(false))
+                return;
+
+            // Stop accepting: the byte is never read, so every accept loop sees it
+            const char wake = 1;
+            while (::write(wakeFds_[1], &wake, 1) < 0 && errno == EINTR)
+            {
+            }
+            for (auto &acceptor : acceptors_)
+                acceptor.join();
+            acceptors_.clear();
+            for (int fd : listeners_)
+                ::close(fd);
+            listeners_.clear();
+            if (!config_.unixPath.empty())
+                ::unlink(config_.unixPath.c_str());
+            ::close(wakeFds_[0]);
+            ::close(wakeFds_[1]);
+            wakeFds_[0] = wakeFds_[1] = -1;
+
+            // Connections see end of input once they have answered what they read
+            std::lock_guard<std::mutex> lock(connectionsMutex_);
+            for (auto &connection : connections_)
+                ::shutdown(connection->fd, SHUT_RD);
+            for (auto &connection : connections_)
+            {
+                connection->thread.join();
+                ::close(connection->fd);
+            }
+            connections_.clear();
+        }
+
+        void BinaryServer::reapFinished()
+        {
+            for (auto it = connections_.begin(); it != connections_.end();)
+            {
+                if (!(*it)->done)
+                {
+                    ++it;
+                    continue;
+                }
+                (*it)->thread.join();
+                ::close((*it)->fd);
+                it = connections_.erase(it);
+            }
+        }
+
+        void BinaryServer::acceptLoop(int listenFd, bool tcp)
+        {
+            pollfd fds[2] = {{listenFd, POLLIN, 0}, {wakeFds_[0], POLLIN, 0}};
+            while (running_)
+            {
+                if (::poll(fds, 2, -1) < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    std::cerr << "Binary server poll failed: " << std::strerror(errno) << std::endl;
+                    return;
+                }
+                if (fds[1].revents)
+                    return;
+                if (!(fds[0].revents & POLLIN))
+                    continue;
+
+                const int fd = ::accept(listenFd, nullptr, nullptr);
+                if (fd < 0)
+                    continue;
+
+                const int yes = 1;
+                if (tcp)
+                    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+#ifdef SO_NOSIGPIPE
+                ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof yes);
+#endif
+                timeval sendTimeout{SendTimeoutSec, 0};
+                ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof sendTimeout);
+
+                std::lock_guard<std::mutex> lock(connectionsMutex_);
+                reapFinished();
+                if (connections_.size() >= config_.maxConnections)
+                {
+                    ::close(fd);
+                    continue;
+                }
+                auto connection = std::make_unique<Connection>();
+                connection->fd = fd;
+                Connection &served = *connection;
+                connections_.push_back(std::move(connection));
+                served.thread = std::thread([this, &served]
+                                            {
+                    serve(served);
+                    // The peer sees the close now; the descriptor itself is released when reaped
+                    ::shutdown(served.fd, SHUT_RDWR);
+                    served.done = true; });
+            }
+        }
+
+        void BinaryServer::serve(Connection &connection)
+        {
+            std::string input;
+            std::string output;
+            try
+            {
+                for (;;)
+                {
+                    // Read straight into the tail of the buffer; one read may hold many frames
+                    const std::size_t held = input.size();
+                    input.resize(held + config_.readBytes);
+                    const ssize_t n = ::recv(connection.fd, &input[held], config_.readBytes, 0);
+                    if (n < 0 && errno == EINTR)
+                    {
+                        input.resize(held);
+                        continue;
+                    }
+                    if (n <= 0)
+                        return;
+                    input.resize(held + static_cast<std::size_t>(n));
+
+                    const std::size_t consumed =
+                        BinaryProtocol::handleFrames(input, output, config_.maxFrameBytes);
+                    input.erase(0, consumed);
+                    if (output.empty())
+                        continue;
+                    if (!sendAll(connection.fd, output))
+                        return;
+                    output.clear();
+                }
+            }
+            catch (const std::exception &e)
+            {
+                // Framing is lost; the client sees the connection close
+                std::cerr << "Binary connection closed: " << e.what() << std::endl;
+            }
+        }
+
+    } // namespace API
+} // namespace OptionPricer
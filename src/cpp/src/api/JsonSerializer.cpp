@@ -1,138 +1,872 @@
 #include "api/JsonSerializer.h"
-#include <nlohmann/json.hpp>
-#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <stdexcept>
-
-using json = nlohmann::json;
+#include <utility>
 
 namespace OptionPricer
 {
     namespace API
     {
 
-        std::string JsonSerializer::serializeOptionResult(
-            const std::shared_ptr<Option> &option,
-            const std::string &optionType)
+        namespace
         {
+            // One JSON value as seen by a field decoder; containers only
+            // carry their kind, their contents are walked or skipped
+            struct Value
+            {
+                enum Kind
+                {
+                    Null,
+                    Boolean,
+                    Number,
+                    String,
+                    Container
+                } kind;
+                double number = 0.0;
+                bool boolean = false;
+                const std::string *string = nullptr;
+            };
+
+            double number(const char *field, const Value &v)
+            {
+                if (v.kind != Value::Number)
+                    throw std::invalid_argument(std::string(field) + " must be a number");
+                return v.number;
+            }
+
+            int integer(const char *field, const Value &v)
+            {
+                return static_cast<int>(number(field, v));
+            }
+
+            bool boolean(const char *field, const Value &v)
+            {
+                if (v.kind != Value::Boolean)
+                    throw std::invalid_argument(std::string(field) + " must be a boolean");
+                return v.boolean;
+            }
+
+            void text(const char *field, const Value &v, std::string &out)
+            {
+                if (v.kind != Value::String)
+                    throw std::invalid_argument(std::string(field) + " must be a string");
+                out.assign(*v.string);
+            }
+
+            // Placeholder for a market input the request leaves to its underlying
+            constexpr double FromMarket = std::numeric_limits<double>::quiet_NaN();
+
+            // Turns every scalar SAX event into one value() call
+            class ScalarSax : public nlohmann::json_sax<json>
+            {
+            public:
+                bool null() override { return value({Value::Null}); }
+
+                bool boolean(bool v) override
+                {
+                    Value value{Value::Boolean};
+                    value.boolean = v;
+                    return this->value(value);
+                }
+
+                bool number_integer(number_integer_t v) override { return number(static_cast<double>(v)); }
+                bool number_unsigned(number_unsigned_t v) override { return number(static_cast<double>(v)); }
+                bool number_float(number_float_t v, const string_t & /*raw*/) override { return number(v); }
+
+                bool string(string_t &v) override
+                {
+                    Value value{Value::String};
+                    value.string = &v;
+                    return this->value(value);
+                }
+
+                bool binary(binary_t & /*v*/) override { return value({Value::Container}); }
+
+                bool parse_error(std::size_t /*position*/, const std::string & /*lastToken*/,
+                                 const nlohmann::detail::exception &ex) override
+                {
+                    throw std::invalid_argument(ex.what());
+                }
+
+            protected:
+                virtual bool value(const Value &v) = 0;
+
+            private:
+                bool number(double v)
+                {
+                    Value value{Value::Number};
+                    value.number = v;
+                    return this->value(value);
+                }
+            };
+
+            /**
+             * Walks a request object and hands each top-level field, and each
+             * field of each "legs" entry, to the decoder. Containers under keys
+             * the decoder does not open are skipped without being built.
+             */
+            template <class Decoder>
+            class RequestSax : public ScalarSax
+            {
+            public:
+                explicit RequestSax(Decoder &decoder) : decoder_(decoder) {}
+
+                bool start_object(std::size_t /*elements*/) override
+                {
+                    if (skip_ > 0)
+                        ++skip_;
+                    else if (level_ == Start)
+                        level_ = Root;
+                    else if (level_ == Legs)
+                    {
+                        decoder_.beginLeg();
+                        level_ = Leg;
+                    }
+                    else
+                        skipContainer();
+                    return true;
+                }
+
+                bool key(string_t &v) override
+                {
+                    if (skip_ == 0)
+                        key_.assign(v);
+                    return true;
+                }
+
+                bool end_object() override
+                {
+                    if (skip_ > 0)
+                        --skip_;
+                    else if (level_ == Leg)
+                    {
+                        decoder_.endLeg();
+                        level_ = Legs;
+                    }
+                    else
+                        level_ = Done;
+                    return true;
+                }
+
+                bool start_array(std::size_t /*elements*/) override
+                {
+                    if (skip_ > 0)
+                        ++skip_;
+                    else if (level_ == Root && decoder_.opensLegs(key_))
+                        level_ = Legs;
+                    else
+                        skipContainer();
+                    return true;
+                }
+
+                bool end_array() override
+                {
+                    if (skip_ > 0)
+                        --skip_;
+                    else
+                        level_ = Root;
+                    return true;
+                }
+
+            private:
+                enum Level
+                {
+                    Start, // before the root object
+                    Root,  // top-level fields
+                    Legs,  // inside the "legs" array
+                    Leg,   // fields of one leg
+                    Done
+                };
+
+                bool value(const Value &v) override
+                {
+                    if (skip_ > 0)
+                        return true;
+                    if (level_ == Root)
+                        decoder_.field(key_, v);
+                    else if (level_ == Leg)
+                        decoder_.legField(key_, v);
+                    else if (level_ == Legs)
+                        throw std::invalid_argument("Each leg must be an object");
+                    else
+                        throw std::invalid_argument("Request body must be a JSON object");
+                    return true;
+                }
+
+                // A nested object or array the decoder has no use for; the
+                // decoder still sees it, so a known field of the wrong type is rejected
+                void skipContainer()
+                {
+                    value({Value::Container});
+                    skip_ = 1;
+                }
+
+                Decoder &decoder_;
+                std::string key_;
+                Level level_ = Start;
+                int skip_ = 0; // depth inside a skipped container
+            };
+
+            // Replays an existing DOM as SAX events
+            template <class Sax>
+            void replay(const json &value, Sax &sax)
+            {
+                switch (value.type())
+                {
+                case json::value_t::object:
+                    sax.start_object(value.size());
+                    for (auto it = value.begin(); it != value.end(); ++it)
+                    {
+                        std::string key = it.key();
+                        sax.key(key);
+                        replay(it.value(), sax);
+                    }
+                    sax.end_object();
+                    break;
+                case json::value_t::array:
+                    sax.start_array(value.size());
+                    for (const auto &element : value)
+                        replay(element, sax);
+                    sax.end_array();
+                    break;
+                case json::value_t::string:
+                {
+                    std::string text = value.get<std::string>();
+                    sax.string(text);
+                    break;
+                }
+                case json::value_t::boolean:
+                    sax.boolean(value.get<bool>());
+                    break;
+                case json::value_t::number_integer:
+                    sax.number_integer(value.get<json::number_integer_t>());
+                    break;
+                case json::value_t::number_unsigned:
+                    sax.number_unsigned(value.get<json::number_unsigned_t>());
+                    break;
+                case json::value_t::number_float:
+                    sax.number_float(value.get<double>(), std::string());
+                    break;
+                default:
+                    sax.null();
+                    break;
+                }
+            }
+
+            template <class Decoder>
+            void decode(std::string_view body, Decoder &decoder)
+            {
+                RequestSax<Decoder> sax(decoder);
+                json::sax_parse(body.begin(), body.end(), &sax);
+            }
+
+            template <class Decoder>
+            void decode(const json &request, Decoder &decoder)
+            {
+                RequestSax<Decoder> sax(decoder);
+                replay(request, sax);
+            }
+
+            // Decoders for requests without a legs array
+            struct FlatDecoder
+            {
+                bool opensLegs(const std::string & /*key*/) { return false; }
+                void beginLeg() {}
+                void legField(const std::string & /*key*/, const Value & /*v*/) {}
+                void endLeg() {}
+            };
+
+            class OptionDecoder : public FlatDecoder
+            {
+            public:
+                void field(const std::string &key, const Value &v)
+                {
+                    if (key == "type")
+                    {
+                        text("type", v, params_.type);
+                        seen_ |= Type;
+                    }
+                    else if (key == "model")
+                        text("model", v, params_.model);
+                    else if (key == "spot")
+                    {
+                        params_.spot = number("spot", v);
+                        seen_ |= Spot;
+                    }
+                    else if (key == "strike")
+                    {
+                        params_.strike = number("strike", v);
+                        seen_ |= Strike;
+                    }
+                    else if (key == "rate")
+                    {
+                        params_.rate = number("rate", v);
+                        seen_ |= Rate;
+                    }
+                    else if (key == "volatility")
+                    {
+                        params_.volatility = number("volatility", v);
+                        seen_ |= Volatility;
+                    }
+                    else if (key == "time")
+                    {
+                        params_.time = number("time", v);
+                        seen_ |= Time;
+                    }
+                    else if (key == "steps")
+                        params_.steps = integer("steps", v);
+                    else if (key == "accuracy")
+                    {
+                        std::string accuracy;
+                        text("accuracy", v, accuracy);
+                        params_.accuracy = Normal::parseAccuracy(accuracy);
+                    }
+                    else if (key == "underlying")
+                        text("underlying", v, params_.underlying);
+                    else if (key == "deadline_ms")
+                        params_.deadlineMs = number("deadline_ms", v);
+                }
+
+                OptionParams finish()
+                {
+                    // An underlying supplies whatever market inputs are left out
+                    const unsigned market = params_.underlying.empty() ? 0u : Spot | Rate | Volatility;
+                    if ((seen_ | market) != Required)
+                        throw std::invalid_argument("Missing required pricing parameters");
+                    if (!(seen_ & Spot))
+                        params_.spot = FromMarket;
+                    if (!(seen_ & Rate))
+                        params_.rate = FromMarket;
+                    if (!(seen_ & Volatility))
+                        params_.volatility = FromMarket;
+                    return std::move(params_);
+                }
+
+            private:
+                enum : unsigned
+                {
+                    Type = 1u << 0,
+                    Spot = 1u << 1,
+                    Strike = 1u << 2,
+                    Rate = 1u << 3,
+                    Volatility = 1u << 4,
+                    Time = 1u << 5,
+                    Required = (1u << 6) - 1
+                };
+
+                OptionParams params_;
+                unsigned seen_ = 0;
+            };
+
+            class StrategyDecoder : public FlatDecoder
+            {
+            public:
+                void field(const std::string &key, const Value &v)
+                {
+                    if (key == "strategy")
+                    {
+                        text("strategy", v, params_.strategy);
+                        hasStrategy_ = true;
+                    }
+                    else if (key == "spot")
+                    {
+                        params_.spot = number("spot", v);
+                        seen_ |= Spot;
+                    }
+                    else if (key == "rate")
+                    {
+                        params_.rate = number("rate", v);
+                        seen_ |= Rate;
+                    }
+                    else if (key == "volatility")
+                    {
+                        params_.volatility = number("volatility", v);
+                        seen_ |= Volatility;
+                    }
+                    else if (key == "time")
+                    {
+                        params_.time = number("time", v);
+                        seen_ |= Time;
+                    }
+                    else if (key == "strike")
+                        params_.strike = number("strike", v);
+                    else if (key == "strike_call")
+                        params_.strikeCall = number("strike_call", v);
+                    else if (key == "strike_put")
+                        params_.strikePut = number("strike_put", v);
+                    else if (key == "is_long")
+                        params_.isLong = boolean("is_long", v);
+                }
+
+                StrategyParams finish()
+                {
+                    if (!hasStrategy_)
+                        throw std::invalid_argument("Missing 'strategy' parameter");
+                    if (seen_ != Required)
+                        throw std::invalid_argument("Missing required parameters: spot, rate, volatility, time");
+                    return std::move(params_);
+                }
+
+            private:
+                enum : unsigned
+                {
+                    Spot = 1u << 0,
+                    Rate = 1u << 1,
+                    Volatility = 1u << 2,
+                    Time = 1u << 3,
+                    Required = (1u << 4) - 1
+                };
+
+                StrategyParams params_;
+                bool hasStrategy_ = false;
+                unsigned seen_ = 0;
+            };
+
+            // Fields of one leg object, shared by portfolio and single-leg decoding
+            class LegFields
+            {
+            public:
+                void field(LegParams &leg, const std::string &key, const Value &v)
+                {
+                    if (key == "optionType")
+                        text("optionType", v, leg.optionType);
+                    else if (key == "type")
+                        text("type", v, leg.model);
+                    else if (key == "strike")
+                    {
+                        leg.strike = number("strike", v);
+                        seen_ |= Strike;
+                    }
+                    else if (key == "volatility")
+                    {
+                        leg.volatility = number("volatility", v);
+                        seen_ |= Volatility;
+                    }
+                    else if (key == "time")
+                    {
+                        leg.time = number("time", v);
+                        seen_ |= Time;
+                    }
+                    else if (key == "quantity")
+                        leg.quantity = integer("quantity", v);
+                    else if (key == "steps")
+                        leg.steps = integer("steps", v);
+                }
+
+                void begin() { seen_ = 0; }
+
+                // A portfolio with an underlying may leave volatility out; it is then NaN
+                void end(LegParams &leg, bool requireVolatility) const
+                {
+                    const unsigned required = requireVolatility ? Required : Required & ~Volatility;
+                    if ((seen_ & required) != required)
+                        throw std::invalid_argument("Each leg must have: strike, volatility, time");
+                    if (!(seen_ & Volatility))
+                        leg.volatility = FromMarket;
+                }
+
+            private:
+                enum : unsigned
+                {
+                    Strike = 1u << 0,
+                    Volatility = 1u << 1,
+                    Time = 1u << 2,
+                    Required = (1u << 3) - 1
+                };
 
+                unsigned seen_ = 0;
+            };
+
+            class PortfolioDecoder
+            {
+            public:
+                explicit PortfolioDecoder(std::pmr::memory_resource *resource)
+                    : params_(resource) {}
+
+                void field(const std::string &key, const Value &v)
+                {
+                    if (key == "spot")
+                    {
+                        params_.spot = number("spot", v);
+                        seen_ |= Spot;
+                    }
+                    else if (key == "rate")
+                    {
+                        params_.rate = number("rate", v);
+                        seen_ |= Rate;
+                    }
+                    else if (key == "payoff_steps")
+                        params_.payoffSteps = integer("payoff_steps", v);
+                    else if (key == "stream")
+                        params_.stream = boolean("stream", v);
+                    else if (key == "underlying")
+                        text("underlying", v, params_.underlying);
+                    else if (key == "deadline_ms")
+                        params_.deadlineMs = number("deadline_ms", v);
+                    else if (key == "legs")
+                        throw std::invalid_argument("legs must be a non-empty array");
+                }
+
+                bool opensLegs(const std::string &key)
+                {
+                    if (key != "legs")
+                        return false;
+                    seen_ |= Legs;
+                    return true;
+                }
+
+                void beginLeg()
+                {
+                    params_.legs.emplace_back();
+                    legFields_.begin();
+                }
+
+                void legField(const std::string &key, const Value &v) { legFields_.field(params_.legs.back(), key, v); }
+                // "underlying" may follow the legs, so volatility is only checked in finish()
+                void endLeg() { legFields_.end(params_.legs.back(), false); }
+
+                PortfolioParams finish()
+                {
+                    const bool market = !params_.underlying.empty();
+                    if ((seen_ | (market ? Spot | Rate : 0u)) != Required)
+                        throw std::invalid_argument("Missing required parameters: spot, rate, legs");
+                    if (params_.legs.empty())
+                        throw std::invalid_argument("legs must be a non-empty array");
+                    if (!market && std::any_of(params_.legs.begin(), params_.legs.end(), [](const LegParams &leg)
+                                               { return std::isnan(leg.volatility); }))
+                        throw std::invalid_argument("Each leg must have: strike, volatility, time");
+                    if (!(seen_ & Spot))
+                        params_.spot = FromMarket;
+                    if (!(seen_ & Rate))
+                        params_.rate = FromMarket;
+                    return std::move(params_);
+                }
+
+            private:
+                enum : unsigned
+                {
+                    Spot = 1u << 0,
+                    Rate = 1u << 1,
+                    Legs = 1u << 2,
+                    Required = (1u << 3) - 1
+                };
+
+                PortfolioParams params_;
+                LegFields legFields_;
+                unsigned seen_ = 0;
+            };
+
+            // A bare leg object: its top-level fields are leg fields
+            class LegDecoder : public FlatDecoder
+            {
+            public:
+                void field(const std::string &key, const Value &v) { fields_.field(leg_, key, v); }
+
+                LegParams finish()
+                {
+                    fields_.end(leg_, true);
+                    return std::move(leg_);
+                }
+
+            private:
+                LegParams leg_;
+                LegFields fields_;
+            };
+
+            /**
+             * Decodes a JSON array of price requests entry by entry. An entry
+             * that fails to decode records its error and the walk moves on to
+             * the next one; only malformed JSON aborts the whole array.
+             */
+            class OptionBatchSax : public ScalarSax
+            {
+            public:
+                explicit OptionBatchSax(std::vector<OptionBatchItem> &items) : items_(items) {}
+
+                bool start_object(std::size_t /*elements*/) override
+                {
+                    if (skip_ > 0)
+                        ++skip_;
+                    else if (level_ == Items)
+                    {
+                        decoder_.emplace();
+                        error_.clear();
+                        level_ = Item;
+                    }
+                    else
+                        skipContainer();
+                    return true;
+                }
+
+                bool key(string_t &v) override
+                {
+                    if (skip_ == 0)
+                        key_.assign(v);
+                    return true;
+                }
+
+                bool end_object() override
+                {
+                    if (skip_ > 0)
+                    {
+                        --skip_;
+                        return true;
+                    }
+                    OptionBatchItem item;
+                    if (error_.empty())
+                    {
+                        try
+                        {
+                            item.params = decoder_->finish();
+                        }
+                        catch (const std::invalid_argument &e)
+                        {
+                            error_ = e.what();
+                        }
+                    }
+                    item.error = std::move(error_);
+                    items_.push_back(std::move(item));
+                    level_ = Items;
+                    return true;
+                }
+
+                bool start_array(std::size_t /*elements*/) override
+                {
+                    if (skip_ > 0)
+                        ++skip_;
+                    else if (level_ == Start)
+                        level_ = Items;
+                    else
+                        skipContainer();
+                    return true;
+                }
+
+                bool end_array() override
+                {
+                    if (skip_ > 0)
+                        --skip_;
+                    else
+                        level_ = Done;
+                    return true;
+                }
+
+            private:
+                enum Level
+                {
+                    Start, // before the root array
+                    Items, // between entries
+                    Item,  // fields of one entry
+                    Done
+                };
+
+                bool value(const Value &v) override
+                {
+                    if (skip_ > 0)
+                        return true;
+                    if (level_ == Items)
+                    {
+                        OptionBatchItem item;
+                        item.error = "Each request must be an object";
+                        items_.push_back(std::move(item));
+                    }
+                    else if (level_ == Item)
+                    {
+                        if (!error_.empty())
+                            return true; // entry already failed; skip its remaining fields
+                        try
+                        {
+                            decoder_->field(key_, v);
+                        }
+                        catch (const std::invalid_argument &e)
+                        {
+                            error_ = e.what();
+                        }
+                    }
+                    else
+                        throw std::invalid_argument("Batch body must be a JSON array or NDJSON");
+                    return true;
+                }
+
+                void skipContainer()
+                {
+                    value({Value::Container});
+                    skip_ = 1;
+                }
+
+                std::vector<OptionBatchItem> &items_;
+                std::optional<OptionDecoder> decoder_;
+                std::string error_;
+                std::string key_;
+                Level level_ = Start;
+                int skip_ = 0;
+            };
+
+            // One NDJSON line; anything but an object fails as it would inside an array
+            OptionBatchItem batchItem(std::string_view line)
+            {
+                OptionBatchItem item;
+                try
+                {
+                    const std::size_t first = line.find_first_not_of(" \t\r");
+                    if (line[first] != '{')
+                        throw std::invalid_argument("Each request must be an object");
+                    item.params = JsonSerializer::parseOptionParams(line);
+                }
+                catch (const std::invalid_argument &e)
+                {
+                    item.error = e.what();
+                }
+                return item;
+            }
+        } // namespace
+
+        json JsonSerializer::serializeOptionResult(
+            double price, double delta, double gamma,
+            double vega, double theta, double rho)
+        {
             json result;
-            result["type"] = optionType;
-            result["spot"] = option->getSpot();
-            result["strike"] = option->getStrike();
-            result["rate"] = option->getRate();
-            result["volatility"] = option->getVolatility();
-            result["time"] = option->getTime();
-            result["price"] = option->price();
-
-            json greeks;
-            greeks["delta"] = option->delta();
-            greeks["gamma"] = option->gamma();
-            greeks["vega"] = option->vega();
-            greeks["theta"] = option->theta();
-            greeks["rho"] = option->rho();
-
-            result["greeks"] = greeks;
-
-            return result.dump(4);
+            result["price"] = price;
+            result["delta"] = delta;
+            result["gamma"] = gamma;
+            result["vega"] = vega;
+            result["theta"] = theta;
+            result["rho"] = rho;
+            return result;
         }
 
-        std::string JsonSerializer::serializeStrategyResult(
-            const std::shared_ptr<Strategy> &strategy,
-            const std::string &strategyName)
+        json JsonSerializer::serializeStrategyResult(
+            double totalPrice, double totalDelta, double totalGamma,
+            double totalVega, double totalTheta, double totalRho,
+            int numLegs)
         {
-
-            json result;
-            result["strategy"] = strategyName;
-            result["price"] = strategy->price();
-
-            json greeks;
-            greeks["delta"] = strategy->delta();
-            greeks["gamma"] = strategy->gamma();
-            greeks["vega"] = strategy->vega();
-            greeks["theta"] = strategy->theta();
-            greeks["rho"] = strategy->rho();
-
-            result["greeks"] = greeks;
-            result["maxProfit"] = strategy->maxProfit();
-            result["maxLoss"] = strategy->maxLoss();
-            result["breakeven"] = strategy->breakeven();
-
-            return result.dump(4);
+            json result = serializeOptionResult(totalPrice, totalDelta, totalGamma, totalVega, totalTheta, totalRho);
+            result["num_legs"] = numLegs;
+            return result;
         }
 
-        std::string JsonSerializer::serializeGreeksSurface(
+        json JsonSerializer::serializeGreeksSurface(
             const std::vector<std::vector<double>> &surface,
-            const std::string &greekType,
             const std::vector<double> &spots,
-            const std::vector<double> &volatilities)
+            const std::vector<double> &times,
+            const std::string &greek)
         {
-
             json result;
-            result["greek"] = greekType;
-            result["data"] = surface;
+            result["greek"] = greek;
             result["spots"] = spots;
-            result["volatilities"] = volatilities;
-
-            return result.dump(4);
+            result["times"] = times;
+            result["data"] = surface;
+            return result;
         }
 
-        std::string JsonSerializer::serializeError(
-            const std::string &message,
-            int errorCode)
+        json JsonSerializer::serializeError(const std::string &message, const std::string &code)
         {
-
             json error;
             error["error"] = message;
-            error["code"] = errorCode;
+            error["status"] = code;
+            return error;
+        }
 
-            return error.dump(4);
+        OptionParams JsonSerializer::parseOptionParams(std::string_view body)
+        {
+            OptionDecoder decoder;
+            decode(body, decoder);
+            return decoder.finish();
         }
 
-        OptionParams JsonSerializer::deserializeOptionParams(const std::string &jsonStr)
+        OptionParams JsonSerializer::decodeOptionParams(const json &request)
         {
-            try
-            {
-                json data = json::parse(jsonStr);
+            OptionDecoder decoder;
+            decode(request, decoder);
+            return decoder.finish();
+        }
 
-                OptionParams params;
-                params.spot = data["spot"].get<double>();
-                params.strike = data["strike"].get<double>();
-                params.rate = data["rate"].get<double>();
-                params.volatility = data["volatility"].get<double>();
-                params.time = data["time"].get<double>();
-                params.type = data["type"].get<std::string>();
-                params.optionType = data.value("optionType", std::string("call"));
-                params.steps = data.value("steps", 100);
+        StrategyParams JsonSerializer::parseStrategyParams(std::string_view body)
+        {
+            StrategyDecoder decoder;
+            decode(body, decoder);
+            return decoder.finish();
+        }
 
-                return params;
-            }
-            catch (const std::exception &e)
-            {
-                throw std::invalid_argument(std::string("JSON parse error: ") + e.what());
-            }
+        StrategyParams JsonSerializer::decodeStrategyParams(const json &request)
+        {
+            StrategyDecoder decoder;
+            decode(request, decoder);
+            return decoder.finish();
         }
 
-        StrategyParams JsonSerializer::deserializeStrategyParams(const std::string &jsonStr)
+        PortfolioParams JsonSerializer::parsePortfolioParams(std::string_view body,
+                                                              std::pmr::memory_resource *resource)
         {
-            try
-            {
-                json data = json::parse(jsonStr);
+            PortfolioDecoder decoder(resource);
+            decode(body, decoder);
+            return decoder.finish();
+        }
 
-                StrategyParams params;
-                params.spot = data["spot"].get<double>();
-                params.strike = data["strike"].get<double>();
-                params.rate = data["rate"].get<double>();
-                params.volatility = data["volatility"].get<double>();
-                params.time = data["time"].get<double>();
-                params.strategyName = data["strategy"].get<std::string>();
-                params.isLong = data.value("isLong", true);
+        PortfolioParams JsonSerializer::decodePortfolioParams(const json &request,
+                                                              std::pmr::memory_resource *resource)
+        {
+            PortfolioDecoder decoder(resource);
+            decode(request, decoder);
+            return decoder.finish();
+        }
 
-                return params;
+        std::vector<OptionBatchItem> JsonSerializer::parseOptionBatch(std::string_view body)
+        {
+            std::vector<OptionBatchItem> items;
+            const std::size_t first = body.find_first_not_of(" \t\r\n");
+            if (first != std::string_view::npos && body[first] == '[')
+            {
+                OptionBatchSax sax(items);
+                json::sax_parse(body.begin(), body.end(), &sax);
+                return items;
             }
-            catch (const std::exception &e)
+
+            // NDJSON: one request per line, so a malformed line only fails itself
+            std::size_t begin = 0;
+            while (begin < body.size())
             {
-                throw std::invalid_argument(std::string("JSON parse error: ") + e.what());
+                std::size_t end = body.find('\n', begin);
+                if (end == std::string_view::npos)
+                    end = body.size();
+                const std::string_view line = body.substr(begin, end - begin);
+                if (line.find_first_not_of(" \t\r") != std::string_view::npos)
+                    items.push_back(batchItem(line));
+                begin = end + 1;
             }
+            return items;
+        }
+
+        std::vector<OptionBatchItem> JsonSerializer::decodeOptionBatch(const json &request)
+        {
+            if (!request.is_array())
+                throw std::invalid_argument("Batch body must be a JSON array or NDJSON");
+            std::vector<OptionBatchItem> items;
+            items.reserve(request.size());
+            for (const auto &entry : request)
+            {
+                OptionBatchItem item;
+                try
+                {
+                    if (!entry.is_object())
+                        throw std::invalid_argument("Each request must be an object");
+                    item.params = decodeOptionParams(entry);
+                }
+                catch (const std::invalid_argument &e)
+                {
+                    item.error = e.what();
+                }
+                items.push_back(std::move(item));
+            }
+            return items;
+        }
+
+        LegParams JsonSerializer::decodeLegParams(const json &leg)
+        {
+            LegDecoder decoder;
+            decode(leg, decoder);
+            return decoder.finish();
         }
 
     } // namespace API
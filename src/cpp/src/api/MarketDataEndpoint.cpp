@@ -0,0 +1,221 @@
+#include "api/MarketDataEndpoint.h"
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        namespace
+        {
+            std::vector<double> numbers(const json &object, const char *key, const char *owner)
+            {
+                if (!object.contains(key) || !object[key].is_array())
+                    throw std::invalid_argument(std::string(owner) + "." + key + " must be an array of numbers");
+                std::vector<double> values;
+                values.reserve(object[key].size());
+                for (const json &value : object[key])
+                {
+                    if (!value.is_number())
+                        throw std::invalid_argument(std::string(owner) + "." + key + " must be an array of numbers");
+                    values.push_back(value.get<double>());
+                }
+                return values;
+            }
+
+            // Rows of a surface ("vols" or "params"), flattened row-major; each must have `width` values
+            std::vector<double> rows(const json &surface, const char *key, std::size_t count, std::size_t width)
+            {
+                if (!surface.contains(key) || !surface[key].is_array() || surface[key].size() != count)
+                    throw std::invalid_argument(std::string("surface.") + key + " needs one row per expiry");
+                std::vector<double> values;
+                values.reserve(count * width);
+                for (const json &row : surface[key])
+                {
+                    if (!row.is_array() || row.size() != width)
+                        throw std::invalid_argument(std::string("surface.") + key + " rows must have " +
+                                                    std::to_string(width) + " values");
+                    for (const json &value : row)
+                        values.push_back(value.get<double>());
+                }
+                return values;
+            }
+
+            json rowsJson(const double *values, std::size_t count, std::size_t width)
+            {
+                json out = json::array();
+                for (std::size_t e = 0; e < count; ++e)
+                    out.push_back(std::vector<double>(values + e * width, values + (e + 1) * width));
+                return out;
+            }
+        } // namespace
+
+        Underlying MarketDataEndpoint::parseUnderlying(const std::string &name, const json &request,
+                                                       const Underlying *current)
+        {
+            if (!request.is_object())
+                throw std::invalid_argument("Request body must be a JSON object");
+            const bool hasRates = request.contains("rate") || request.contains("rates");
+            const bool hasSurface = request.contains("volatility") || request.contains("surface");
+            if (!current && (!request.contains("spot") || !hasRates || !hasSurface))
+                throw std::invalid_argument("A new underlying needs spot, rate or rates, and volatility or surface");
+
+            const double spot = request.contains("spot") ? request["spot"].get<double>() : current->spot;
+
+            std::vector<double> rateTimes, rates;
+            if (request.contains("rate"))
+            {
+                rateTimes = {1.0};
+                rates = {request["rate"].get<double>()};
+            }
+            else if (request.contains("rates"))
+            {
+                rateTimes = numbers(request["rates"], "times", "rates");
+                rates = numbers(request["rates"], "rates", "rates");
+            }
+            else
+            {
+                const RateCurve &curve = current->rates;
+                rateTimes.assign(curve.times(), curve.times() + curve.size());
+                rates.assign(curve.rates(), curve.rates() + curve.size());
+            }
+
+            VolSurface::Kind kind = VolSurface::Kind::Grid;
+            std::vector<double> expiries, moneyness, values;
+            if (request.contains("volatility"))
+            {
+                // A flat surface: one expiry, one column
+                expiries = {1.0};
+                moneyness = {1.0};
+                values = {request["volatility"].get<double>()};
+            }
+            else if (request.contains("surface"))
+            {
+                const json &surface = request["surface"];
+                if (!surface.is_object())
+                    throw std::invalid_argument("surface must be an object");
+                const std::string type = surface.value("type", "grid");
+                expiries = numbers(surface, "expiries", "surface");
+                if (type == "grid")
+                {
+                    moneyness = numbers(surface, "moneyness", "surface");
+                    values = rows(surface, "vols", expiries.size(), moneyness.size());
+                }
+                else if (type == "svi")
+                {
+                    kind = VolSurface::Kind::Svi;
+                    values = rows(surface, "params", expiries.size(), VolSurface::SviParams);
+                }
+                else
+                {
+                    throw std::invalid_argument("Invalid surface type: " + type + " (expected \"grid\" or \"svi\")");
+                }
+            }
+            else
+            {
+                const VolSurface &surface = current->surface;
+                kind = surface.kind();
+                expiries.assign(surface.expiries(), surface.expiries() + surface.expiryCount());
+                if (surface.moneyness())
+                    moneyness.assign(surface.moneyness(), surface.moneyness() + surface.columns());
+                values.assign(surface.values(), surface.values() + surface.expiryCount() * surface.columns());
+            }
+
+            return Underlying::make(name, spot, rateTimes, rates, kind, expiries, moneyness, values);
+        }
+
+        json MarketDataEndpoint::toJson(const Underlying &underlying)
+        {
+            const RateCurve &curve = underlying.rates;
+            const VolSurface &surface = underlying.surface;
+            json out;
+            out["name"] = underlying.name;
+            out["spot"] = underlying.spot;
+            out["rates"]["times"] = std::vector<double>(curve.times(), curve.times() + curve.size());
+            out["rates"]["rates"] = std::vector<double>(curve.rates(), curve.rates() + curve.size());
+            out["surface"]["expiries"] =
+                std::vector<double>(surface.expiries(), surface.expiries() + surface.expiryCount());
+            if (surface.kind() == VolSurface::Kind::Svi)
+            {
+                out["surface"]["type"] = "svi";
+                out["surface"]["params"] = rowsJson(surface.values(), surface.expiryCount(), surface.columns());
+            }
+            else
+            {
+                out["surface"]["type"] = "grid";
+                out["surface"]["moneyness"] =
+                    std::vector<double>(surface.moneyness(), surface.moneyness() + surface.columns());
+                out["surface"]["vols"] = rowsJson(surface.values(), surface.expiryCount(), surface.columns());
+            }
+            return out;
+        }
+
+        json MarketDataEndpoint::handleUpdate(const std::string &name, const json &request)
+        {
+            MarketDataStore &store = MarketDataStore::shared();
+            const auto market = store.snapshot();
+            const std::uint64_t version = store.update(parseUnderlying(name, request, market->find(name)));
+
+            json response;
+            response["underlying"] = name;
+            response["version"] = version;
+            response["status"] = "success";
+            return response;
+        }
+
+        json MarketDataEndpoint::handleGet(const std::string &name)
+        {
+            const auto market = MarketDataStore::shared().snapshot();
+            const Underlying *underlying = market->find(name);
+            if (!underlying)
+                throw std::out_of_range("Unknown underlying: " + name);
+
+            json response = toJson(*underlying);
+            response["version"] = market->version();
+            response["status"] = "success";
+            return response;
+        }
+
+        json MarketDataEndpoint::handleList()
+        {
+            const auto market = MarketDataStore::shared().snapshot();
+            json underlyings = json::array();
+            for (const auto &entry : market->underlyings())
+            {
+                const Underlying &u = entry.second;
+                underlyings.push_back({{"name", u.name},
+                                       {"spot", u.spot},
+                                       {"surface", u.surface.kind() == VolSurface::Kind::Svi ? "svi" : "grid"},
+                                       {"expiries", u.surface.expiryCount()}});
+            }
+
+            json response;
+            response["version"] = market->version();
+            response["underlyings"] = std::move(underlyings);
+            response["status"] = "success";
+            return response;
+        }
+
+        json MarketDataEndpoint::handleErase(const std::string &name)
+        {
+            if (!MarketDataStore::shared().erase(name))
+                throw std::out_of_range("Unknown underlying: " + name);
+            return json{{"status", "success"}};
+        }
+
+        json MarketDataEndpoint::handleLoad(const std::string &path)
+        {
+            MarketDataStore &store = MarketDataStore::shared();
+            const std::size_t loaded = store.loadFile(path);
+
+            json response;
+            response["loaded"] = loaded;
+            response["version"] = store.snapshot()->version();
+            response["status"] = "success";
+            return response;
+        }
+
+    } // namespace API
+} // namespace OptionPricer
@@ -0,0 +1,346 @@
+#include "api/PortfolioSession.h"
+#include "api/RequestArena.h"
+#include "options/GreeksCache.h"
+#include "concurrency/Scheduler.h"
+#include <cstdio>
+#include <map>
+#include <random>
+#include <stdexcept>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        namespace
+        {
+            int readPayoffSteps(const json &request, int fallback)
+            {
+                const int steps = request.value("payoff_steps", fallback);
+                if (steps < 1)
+                    throw std::invalid_argument("payoff_steps must be positive");
+                return steps;
+            }
+
+            // Price and Greeks of each leg in parallel, one slot per leg
+            std::vector<OptionGreeks> priceLegs(const std::pmr::vector<PricingEndpoint::LegInput> &legs)
+            {
+                std::vector<OptionGreeks> greeks(legs.size());
+                GreeksCache &cache = GreeksCache::shared();
+                Scheduler::shared().parallelFor(legs.size(), [&](std::size_t i)
+                                                { greeks[i] = cache.greeks(legs[i].contract); }, 1);
+                return greeks;
+            }
+
+            bool sameGreeks(const OptionGreeks &a, const OptionGreeks &b)
+            {
+                return a.price == b.price && a.delta == b.delta && a.gamma == b.gamma &&
+                       a.vega == b.vega && a.theta == b.theta && a.rho == b.rho;
+            }
+
+            // splitmix64 finaliser: distinct counters give distinct, unguessable-looking ids
+            std::uint64_t scramble(std::uint64_t x)
+            {
+                x += 0x9e3779b97f4a7c15ull;
+                x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+                x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+                return x ^ (x >> 31);
+            }
+        } // namespace
+
+        PortfolioSession::PortfolioSession(const json &request)
+        {
+            if (!request.contains("spot") || !request.contains("rate") || !request.contains("legs"))
+            {
+                throw std::invalid_argument("Missing required parameters: spot, rate, legs");
+            }
+
+            spot_ = request["spot"].get<double>();
+            rate_ = request["rate"].get<double>();
+            payoffSteps_ = readPayoffSteps(request, 100);
+
+            // Parsed legs are scratch; the session keeps its own copies
+            std::pmr::vector<PricingEndpoint::LegInput> inputs = PricingEndpoint::parseLegs(request);
+            const std::vector<OptionGreeks> greeks = priceLegs(inputs);
+            for (std::size_t i = 0; i < inputs.size(); ++i)
+            {
+                strategy_.addLeg(inputs[i].contract, inputs[i].quantity, greeks[i].price);
+                legs_.push_back({request["legs"][i], std::move(inputs[i]), greeks[i]});
+            }
+            reduce();
+        }
+
+        json PortfolioSession::apply(const json &patch)
+        {
+            // Stage every change first so an invalid patch leaves the session untouched
+            const double spot = patch.value("spot", spot_);
+            const double rate = patch.value("rate", rate_);
+            const int payoffSteps = readPayoffSteps(patch, payoffSteps_);
+            const bool marketMoved = spot != spot_ || rate != rate_;
+
+            std::map<std::size_t, json> staged;
+            if (patch.contains("legs"))
+            {
+                const json &legPatches = patch["legs"];
+                if (!legPatches.is_array())
+                    throw std::invalid_argument("legs must be an array");
+
+                std::size_t appended = legs_.size();
+                for (const auto &legPatch : legPatches)
+                {
+                    if (!legPatch.is_object())
+                        throw std::invalid_argument("Each leg patch must be an object");
+                    if (!legPatch.contains("index"))
+                    {
+                        staged[appended++] = legPatch;
+                        continue;
+                    }
+
+                    const json &indexField = legPatch["index"];
+                    if (!indexField.is_number_integer() || indexField.get<long long>() < 0 ||
+                        indexField.get<long long>() >= static_cast<long long>(legs_.size()))
+                        throw std::invalid_argument("Leg index out of range");
+                    const std::size_t index = indexField.get<std::size_t>();
+
+                    auto it = staged.find(index);
+                    json spec = it != staged.end() ? it->second : legs_[index].spec;
+                    spec.update(legPatch);
+                    spec.erase("index");
+                    staged[index] = std::move(spec);
+                }
+            }
+            if (marketMoved)
+            {
+                for (std::size_t i = 0; i < legs_.size(); ++i)
+                    staged.emplace(i, legs_[i].spec);
+            }
+
+            std::vector<std::size_t> indices;
+            std::pmr::vector<PricingEndpoint::LegInput> inputs(RequestArena::resource());
+            for (const auto &change : staged)
+            {
+                indices.push_back(change.first);
+                inputs.push_back(PricingEndpoint::parseLeg(change.second, spot, rate));
+            }
+            const std::vector<OptionGreeks> greeks = priceLegs(inputs);
+
+            // Commit
+            const OptionGreeks previousTotals = totals_;
+            const std::vector<double> previousPayoffs = payoffs_;
+            const bool gridMoved = marketMoved || payoffSteps != payoffSteps_;
+            spot_ = spot;
+            rate_ = rate;
+            payoffSteps_ = payoffSteps;
+
+            json changedLegs = json::array();
+            for (std::size_t k = 0; k < indices.size(); ++k)
+            {
+                const std::size_t index = indices[k];
+                SessionLeg leg{std::move(staged[index]), std::move(inputs[k]), greeks[k]};
+                if (index < legs_.size())
+                {
+                    strategy_.setLeg(index, leg.input.contract, leg.input.quantity, leg.greeks.price);
+                    legs_[index] = std::move(leg);
+                }
+                else
+                {
+                    strategy_.addLeg(leg.input.contract, leg.input.quantity, leg.greeks.price);
+                    legs_.push_back(std::move(leg));
+                }
+                changedLegs.push_back(legJson(index));
+            }
+
+            json response;
+            if (!indices.empty() || gridMoved)
+            {
+                ++version_;
+                reduce();
+            }
+            response["version"] = version_;
+            response["portfolio"] = json::object();
+            response["portfolio"]["legs"] = changedLegs;
+            if (!sameGreeks(previousTotals, totals_))
+            {
+                const json totals = totalsJson();
+                response["portfolio"]["totalPrice"] = totals["totalPrice"];
+                response["portfolio"]["greeks"] = totals["greeks"];
+            }
+            if (gridMoved || payoffs_ != previousPayoffs)
+            {
+                if (marketMoved)
+                    response["portfolio"]["spot"] = spot_;
+                response["portfolio"]["payoff"] = payoffJson();
+            }
+            response["status"] = "success";
+            return response;
+        }
+
+        json PortfolioSession::snapshot() const
+        {
+            json portfolio = totalsJson();
+            portfolio["spot"] = spot_;
+            portfolio["legs"] = json::array();
+            for (std::size_t i = 0; i < legs_.size(); ++i)
+            {
+                json leg = legJson(i);
+                leg.erase("index");
+                portfolio["legs"].push_back(std::move(leg));
+            }
+            portfolio["payoff"] = payoffJson();
+
+            json response;
+            response["portfolio"] = std::move(portfolio);
+            response["version"] = version_;
+            response["status"] = "success";
+            return response;
+        }
+
+        json PortfolioSession::legJson(std::size_t index) const
+        {
+            const SessionLeg &leg = legs_[index];
+            const OptionGreeks &g = leg.greeks;
+            json legResponse;
+            legResponse["index"] = index;
+            legResponse["optionType"] = leg.input.optionType;
+            legResponse["model"] = leg.input.model;
+            legResponse["strike"] = leg.input.contract.strike;
+            legResponse["price"] = g.price;
+            legResponse["quantity"] = leg.input.quantity;
+            legResponse["delta"] = g.delta;
+            legResponse["gamma"] = g.gamma;
+            legResponse["vega"] = g.vega;
+            legResponse["theta"] = g.theta;
+            legResponse["rho"] = g.rho;
+            return legResponse;
+        }
+
+        json PortfolioSession::totalsJson() const
+        {
+            json totals;
+            totals["totalPrice"] = totals_.price;
+            totals["greeks"] = json::object();
+            totals["greeks"]["delta"] = totals_.delta;
+            totals["greeks"]["gamma"] = totals_.gamma;
+            totals["greeks"]["vega"] = totals_.vega;
+            totals["greeks"]["theta"] = totals_.theta;
+            totals["greeks"]["rho"] = totals_.rho;
+            return totals;
+        }
+
+        json PortfolioSession::payoffJson() const
+        {
+            json payoff;
+            payoff["spot_prices"] = payoffSpots_;
+            payoff["payoffs"] = payoffs_;
+            PricingEndpoint::addPayoffProfile(strategy_, payoff);
+            return payoff;
+        }
+
+        void PortfolioSession::reduce()
+        {
+            // Same leg-order reduction and grid as buildPortfolioResponse, so the
+            // session matches a fresh request bit for bit
+            totals_ = OptionGreeks{};
+            for (const auto &leg : legs_)
+            {
+                const int quantity = leg.input.quantity;
+                totals_.price += leg.greeks.price * quantity;
+                totals_.delta += leg.greeks.delta * quantity;
+                totals_.gamma += leg.greeks.gamma * quantity;
+                totals_.vega += leg.greeks.vega * quantity;
+                totals_.theta += leg.greeks.theta * quantity;
+                totals_.rho += leg.greeks.rho * quantity;
+            }
+
+            const double spotMin = spot_ * 0.7;
+            const double spotMax = spot_ * 1.3;
+            const std::size_t points = static_cast<std::size_t>(payoffSteps_) + 1;
+            payoffSpots_.resize(points);
+            payoffs_.resize(points);
+            for (std::size_t i = 0; i < points; ++i)
+                payoffSpots_[i] = spotMin + (spotMax - spotMin) * static_cast<int>(i) / payoffSteps_;
+            strategy_.payoffGrid(payoffSpots_.data(), points, payoffs_.data());
+        }
+
+        SessionStore::SessionStore(std::size_t capacity)
+            : capacity_(capacity), nextId_(std::random_device{}())
+        {
+            nextId_ = (nextId_ << 32) ^ std::random_device{}();
+        }
+
+        json SessionStore::create(const json &request)
+        {
+            // Price outside the store lock; other sessions stay available meanwhile
+            auto entry = std::make_shared<Entry>(request);
+            json response = entry->session.snapshot();
+
+            char id[17];
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(scramble(nextId_++)));
+            entry->lastUsed = ++clock_;
+            sessions_.emplace(id, entry);
+
+            while (sessions_.size() > capacity_)
+            {
+                auto oldest = sessions_.begin();
+                for (auto it = sessions_.begin(); it != sessions_.end(); ++it)
+                {
+                    if (it->second->lastUsed < oldest->second->lastUsed)
+                        oldest = it;
+                }
+                sessions_.erase(oldest);
+            }
+
+            response["session"] = id;
+            return response;
+        }
+
+        json SessionStore::apply(const std::string &id, const json &patch)
+        {
+            auto entry = find(id);
+            std::lock_guard<std::mutex> lock(entry->mutex);
+            json response = entry->session.apply(patch);
+            response["session"] = id;
+            return response;
+        }
+
+        json SessionStore::snapshot(const std::string &id)
+        {
+            auto entry = find(id);
+            std::lock_guard<std::mutex> lock(entry->mutex);
+            json response = entry->session.snapshot();
+            response["session"] = id;
+            return response;
+        }
+
+        void SessionStore::erase(const std::string &id)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (sessions_.erase(id) == 0)
+                throw std::out_of_range("Unknown session: " + id);
+        }
+
+        std::size_t SessionStore::size() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return sessions_.size();
+        }
+
+        std::shared_ptr<SessionStore::Entry> SessionStore::find(const std::string &id)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = sessions_.find(id);
+            if (it == sessions_.end())
+                throw std::out_of_range("Unknown session: " + id);
+            it->second->lastUsed = ++clock_;
+            return it->second;
+        }
+
+        SessionStore &SessionStore::shared()
+        {
+            static SessionStore store;
+            return store;
+        }
+
+    } // namespace API
+} // namespace OptionPricer
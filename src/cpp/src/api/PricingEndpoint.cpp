@@ -1,60 +1,213 @@
 #include "api/PricingEndpoint.h"
-#include "options/EuropeanOption.h"
 #include "options/AmericanOption.h"
+#include "options/GreeksCache.h"
 #include "strategy/Straddle.h"
 #include "strategy/Strangle.h"
+#include "models/BlackScholes.h"
+#include "models/FiniteDifference.h"
+#include "models/GreeksSurface.h"
+#include "models/MonteCarloRisk.h"
+#include "models/NormalDistribution.h"
+#include "concurrency/Scheduler.h"
+#include "market/MarketData.h"
+#include <algorithm>
 #include <stdexcept>
 #include <cmath>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace OptionPricer
 {
     namespace API
     {
 
-        std::shared_ptr<Option> PricingEndpoint::createOptionFromJson(const json &params)
+        namespace
         {
-            if (!params.contains("type") || !params.contains("spot") ||
-                !params.contains("strike") || !params.contains("rate") ||
-                !params.contains("volatility") || !params.contains("time"))
+            /**
+             * Fill a chain column from a per-strike array if present, otherwise
+             * broadcast the scalar field; every value must be positive
+             */
+            void readChainColumn(const json &request, const char *arrayKey, const char *scalarKey,
+                                 std::size_t n, std::vector<double> &column)
             {
-                throw std::invalid_argument("Missing required pricing parameters");
+                if (request.contains(arrayKey))
+                {
+                    const json &values = request[arrayKey];
+                    if (!values.is_array() || values.size() != n)
+                        throw std::invalid_argument(std::string(arrayKey) + " must be an array matching strikes");
+                    column.resize(n);
+                    for (std::size_t i = 0; i < n; ++i)
+                        column[i] = values[i].get<double>();
+                }
+                else if (request.contains(scalarKey))
+                {
+                    column.assign(n, request[scalarKey].get<double>());
+                }
+                else
+                {
+                    throw std::invalid_argument(std::string("Missing required parameter: ") + scalarKey);
+                }
+
+                for (double v : column)
+                {
+                    if (!(v > 0.0))
+                        throw std::invalid_argument(std::string(scalarKey) + " values must be positive");
+                }
             }
 
-            std::string type = params["type"].get<std::string>();
-            double spot = params["spot"].get<double>();
-            double strike = params["strike"].get<double>();
-            double rate = params["rate"].get<double>();
-            double volatility = params["volatility"].get<double>();
-            double time = params["time"].get<double>();
+            // The named underlying in a snapshot; an unknown name is a bad request, not a 404
+            const Underlying &underlyingIn(const MarketSnapshot &market, const std::string &name)
+            {
+                const Underlying *underlying = market.find(name);
+                if (!underlying)
+                    throw std::invalid_argument("Unknown underlying: " + name);
+                return *underlying;
+            }
 
-            if (spot <= 0 || strike <= 0 || volatility <= 0 || time <= 0)
+            // Surface volatility at a strike, against the forward of the request's own spot and rate
+            double marketVolatility(const Underlying &underlying, double spot, double rate, double strike, double time)
             {
-                throw std::invalid_argument("Parameters must be positive");
+                return underlying.surface.volatility(strike / (spot * std::exp(rate * time)), time);
+            }
+
+            /**
+             * Spot and per-strike rates of a chain-style request: explicit
+             * "spot" and "rate" win, the named underlying supplies the rest
+             * (its curve read at each strike's time)
+             */
+            struct ChainMarket
+            {
+                std::shared_ptr<const MarketSnapshot> snapshot;
+                const Underlying *underlying = nullptr;
+                double spot = 0.0;
+                std::vector<double> rates;
+            };
+
+            ChainMarket chainMarket(const json &request, const std::vector<double> &times)
+            {
+                ChainMarket market;
+                if (request.contains("underlying"))
+                {
+                    market.snapshot = MarketDataStore::shared().snapshot();
+                    market.underlying = &underlyingIn(*market.snapshot, request["underlying"].get<std::string>());
+                }
+                else if (!request.contains("spot") || !request.contains("rate"))
+                {
+                    throw std::invalid_argument("Missing required parameters: spot, rate");
+                }
+
+                market.spot = request.contains("spot") ? request["spot"].get<double>() : market.underlying->spot;
+                if (!(market.spot > 0))
+                {
+                    throw std::invalid_argument("Parameters must be positive");
+                }
+                if (request.contains("rate"))
+                {
+                    market.rates.assign(times.size(), request["rate"].get<double>());
+                }
+                else
+                {
+                    market.rates.resize(times.size());
+                    for (std::size_t i = 0; i < times.size(); ++i)
+                        market.rates[i] = market.underlying->rate(times[i]);
+                }
+                return market;
+            }
+
+            void addMarketMeta(const ChainMarket &market, json &meta)
+            {
+                if (market.underlying)
+                {
+                    meta["underlying"] = market.underlying->name;
+                    meta["market_version"] = market.snapshot->version();
+                }
+            }
+
+            // Exact identity of a contract, for deduplicating batch entries
+            struct ContractHash
+            {
+                std::size_t operator()(const OptionContract &c) const
+                {
+                    std::size_t h = std::hash<int>()(static_cast<int>(c.style) << 16 | static_cast<int>(c.model) << 8 |
+                                                     static_cast<int>(c.kind));
+                    for (double v : {static_cast<double>(c.steps), c.spot, c.strike, c.rate, c.sigma, c.time})
+                        h = h * 1000003u ^ std::hash<double>()(v);
+                    return h;
+                }
+            };
+
+            struct ContractEqual
+            {
+                bool operator()(const OptionContract &a, const OptionContract &b) const
+                {
+                    return a.style == b.style && a.kind == b.kind && a.model == b.model && a.steps == b.steps &&
+                           a.spot == b.spot &&
+                           a.strike == b.strike && a.rate == b.rate && a.sigma == b.sigma && a.time == b.time;
+                }
+            };
+        } // namespace
+
+        OptionContract PricingEndpoint::contractFrom(const OptionParams &params, const MarketSnapshot *market)
+        {
+            double spot = params.spot;
+            double rate = params.rate;
+            double volatility = params.volatility;
+            if (!params.underlying.empty())
+            {
+                // Fields the request left out (NaN) come from the underlying at this strike and expiry
+                const Underlying &underlying = underlyingIn(*market, params.underlying);
+                if (std::isnan(spot))
+                    spot = underlying.spot;
+                if (std::isnan(rate))
+                    rate = underlying.rate(params.time);
+                if (std::isnan(volatility))
+                    volatility = marketVolatility(underlying, spot, rate, params.strike, params.time);
             }
 
             // "model" field selects the pricing model; defaults to European Black-Scholes
-            std::string model = params.value("model", "european");
-            if (model == "american")
+            return makeContract(parseOptionKind(params.type), params.model, spot, params.strike,
+                                rate, volatility, params.time, params.steps);
+        }
+
+        OptionContract PricingEndpoint::makeContract(OptionKind kind, const std::string &model,
+                                                     double spot, double strike, double rate,
+                                                     double volatility, double time, int steps)
+        {
+            if (!(spot > 0) || !(strike > 0) || !(volatility > 0) || !(time > 0) || std::isnan(rate))
             {
-                int steps = params.value("steps", 100);
-                return std::make_shared<OptionPricer::AmericanOption>(spot, strike, rate, volatility, time, type, steps);
+                throw std::invalid_argument("Parameters must be positive");
             }
-            return std::make_shared<EuropeanOption>(spot, strike, rate, volatility, time, type);
+
+            if (model == "european")
+                return OptionContract::european(spot, strike, rate, volatility, time, kind);
+            // "american" and the other american_* models; anything else throws
+            return OptionContract::american(spot, strike, rate, volatility, time, kind, steps,
+                                            parseAmericanModel(model));
+        }
+
+        json PricingEndpoint::buildGreeksResponse(const OptionContract &contract,
+                                                  const std::string &model)
+        {
+            return buildGreeksResponse(contract, contract.greeks(), model);
         }
 
-        json PricingEndpoint::buildGreeksResponse(const std::shared_ptr<Option> &option,
+        json PricingEndpoint::buildGreeksResponse(const OptionContract &contract, const OptionGreeks &g,
                                                   const std::string &model)
         {
             json response;
-            response["price"] = option->price();
-            response["delta"] = option->delta();
-            response["gamma"] = option->gamma();
-            response["vega"] = option->vega();
-            response["theta"] = option->theta();
-            response["rho"] = option->rho();
-            response["spot"] = option->getSpot();
-            response["strike"] = option->getStrike();
-            response["type"] = option->type();
+            response["price"] = g.price;
+            response["delta"] = g.delta;
+            response["gamma"] = g.gamma;
+            response["vega"] = g.vega;
+            response["theta"] = g.theta;
+            response["rho"] = g.rho;
+            response["spot"] = contract.spot;
+            response["strike"] = contract.strike;
+            response["type"] = toString(contract.kind);
             response["model"] = model;
             return response;
         }
@@ -63,9 +216,7 @@ namespace OptionPricer
         {
             try
             {
-                auto option = createOptionFromJson(request);
-                std::string model = request.value("model", "european");
-                return buildGreeksResponse(option, model);
+                return handlePriceRequest(JsonSerializer::decodeOptionParams(request));
             }
             catch (const std::exception &e)
             {
@@ -76,33 +227,242 @@ namespace OptionPricer
             }
         }
 
-        json PricingEndpoint::handleStrategyRequest(const json &request)
+        json PricingEndpoint::handlePriceRequest(const OptionParams &params)
+        {
+            try
+            {
+                std::shared_ptr<const MarketSnapshot> market;
+                if (!params.underlying.empty())
+                    market = MarketDataStore::shared().snapshot();
+                const OptionContract contract = contractFrom(params, market.get());
+                json response = buildGreeksResponse(contract, contract.greeks(params.accuracy), params.model);
+                if (params.accuracy != Normal::Accuracy::Exact)
+                    response["accuracy"] = Normal::toString(params.accuracy);
+                if (!market)
+                    return response;
+
+                // Echo the market inputs that were filled in, and the snapshot they came from
+                response["underlying"] = params.underlying;
+                response["rate"] = contract.rate;
+                response["volatility"] = contract.sigma;
+                response["market_version"] = market->version();
+                return response;
+            }
+            catch (const std::exception &e)
+            {
+                json errorResponse;
+                errorResponse["error"] = e.what();
+                errorResponse["status"] = "error";
+                return errorResponse;
+            }
+        }
+
+        json PricingEndpoint::handlePriceBatchRequest(const json &request)
+        {
+            try
+            {
+                return handlePriceBatchRequest(JsonSerializer::decodeOptionBatch(request));
+            }
+            catch (const std::exception &e)
+            {
+                json errorResponse;
+                errorResponse["error"] = e.what();
+                errorResponse["status"] = "error";
+                return errorResponse;
+            }
+        }
+
+        PricingEndpoint::BatchPricing PricingEndpoint::priceBatch(const std::vector<OptionBatchItem> &items)
+        {
+            // Map each valid entry onto a distinct contract; identical inputs share one pricing
+            const std::size_t n = items.size();
+            BatchPricing batch;
+            batch.slot.assign(n, BatchPricing::npos);
+            batch.errors.resize(n);
+            std::vector<OptionContract> &unique = batch.contracts;
+            std::unordered_map<OptionContract, std::size_t, ContractHash, ContractEqual> index;
+            std::shared_ptr<const MarketSnapshot> market; // one snapshot for the whole batch, taken on first use
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (!items[i].error.empty())
+                {
+                    batch.errors[i] = items[i].error;
+                    continue;
+                }
+                try
+                {
+                    if (!items[i].params.underlying.empty() && !market)
+                        market = MarketDataStore::shared().snapshot();
+                    const OptionContract contract = contractFrom(items[i].params, market.get());
+                    const auto entry = index.emplace(contract, unique.size());
+                    if (entry.second)
+                        unique.push_back(contract);
+                    batch.slot[i] = entry.first->second;
+                }
+                catch (const std::exception &e)
+                {
+                    batch.errors[i] = e.what();
+                }
+            }
+
+            // Split the distinct contracts by model
+            std::vector<std::size_t> european, american;
+            for (std::size_t u = 0; u < unique.size(); ++u)
+                (unique[u].style == ExerciseStyle::American ? american : european).push_back(u);
+
+            // Contracts a cancelled batch never reaches keep a NaN price
+            const double nan = std::numeric_limits<double>::quiet_NaN();
+            const OptionGreeks unpriced{nan, nan, nan, nan, nan, nan};
+            std::vector<OptionGreeks> &greeks = batch.greeks;
+            greeks.assign(unique.size(), unpriced);
+
+            // European: gather into columns and run the SIMD kernel block by block
+            {
+                const std::size_t m = european.size();
+                std::vector<double> spots(m), strikes(m), rates(m), vols(m), times(m);
+                std::vector<OptionKind> kinds(m);
+                for (std::size_t j = 0; j < m; ++j)
+                {
+                    const OptionContract &c = unique[european[j]];
+                    spots[j] = c.spot;
+                    strikes[j] = c.strike;
+                    rates[j] = c.rate;
+                    vols[j] = c.sigma;
+                    times[j] = c.time;
+                    kinds[j] = c.kind;
+                }
+                std::vector<double> price(m, nan), delta(m), gamma(m), vega(m), theta(m), rho(m);
+                const std::size_t blockSize = 4096;
+                try
+                {
+                    Scheduler::shared().parallelFor((m + blockSize - 1) / blockSize, [&](std::size_t block)
+                                                    {
+                        const std::size_t b = block * blockSize;
+                        const std::size_t k = std::min(blockSize, m - b);
+                        BlackScholes::priceAndGreeksBatch(
+                            {spots.data() + b, strikes.data() + b, rates.data() + b, vols.data() + b, times.data() + b, kinds.data() + b, k},
+                            {price.data() + b, delta.data() + b, gamma.data() + b, vega.data() + b, theta.data() + b, rho.data() + b}); }, 1);
+                }
+                catch (const OperationCancelled &e)
+                {
+                    batch.cancelled = e.what();
+                }
+                for (std::size_t j = 0; j < m; ++j)
+                    greeks[european[j]] = {price[j], delta[j], gamma[j], vega[j], theta[j], rho[j]};
+            }
+
+            // American: one lattice per distinct contract, shared with portfolio requests via the
+            // cache; misses on one tree scheme and step count run side by side in SIMD lanes
+            {
+                std::vector<OptionContract> contracts(american.size());
+                for (std::size_t j = 0; j < american.size(); ++j)
+                    contracts[j] = unique[american[j]];
+                std::vector<OptionGreeks> results(american.size(), unpriced);
+                try
+                {
+                    if (batch.cancelled.empty())
+                        GreeksCache::shared().greeks(contracts.data(), contracts.size(), results.data(),
+                                                     Scheduler::shared());
+                }
+                catch (const OperationCancelled &e)
+                {
+                    batch.cancelled = e.what();
+                }
+                for (std::size_t j = 0; j < american.size(); ++j)
+                    greeks[american[j]] = results[j];
+            }
+            return batch;
+        }
+
+        json PricingEndpoint::handlePriceBatchRequest(const std::vector<OptionBatchItem> &items)
         {
             try
             {
-                if (!request.contains("strategy"))
+                const BatchPricing batch = priceBatch(items);
+
+                // Results in request order, errors in place of the entries that raised them
+                json results = json::array();
+                for (std::size_t i = 0; i < items.size(); ++i)
                 {
-                    throw std::invalid_argument("Missing 'strategy' parameter");
+                    const std::size_t u = batch.slot[i];
+                    const bool priced = u != BatchPricing::npos &&
+                                        (batch.cancelled.empty() || !std::isnan(batch.greeks[u].price));
+                    if (priced)
+                    {
+                        results.push_back(buildGreeksResponse(batch.contracts[u], batch.greeks[u], items[i].params.model));
+                        continue;
+                    }
+                    json errorResponse;
+                    errorResponse["error"] = u != BatchPricing::npos ? batch.cancelled : batch.errors[i];
+                    errorResponse["status"] = "error";
+                    results.push_back(std::move(errorResponse));
                 }
 
-                std::string strategy = request["strategy"].get<std::string>();
-                double spot = request["spot"].get<double>();
-                double rate = request["rate"].get<double>();
-                double volatility = request["volatility"].get<double>();
-                double time = request["time"].get<double>();
-                bool isLong = request.value("is_long", true);
+                json response;
+                response["results"] = std::move(results);
+                response["count"] = items.size();
+                response["unique"] = batch.contracts.size();
+                if (!batch.cancelled.empty())
+                    response["partial"] = true; // entries not reached carry the cancellation as their error
+                response["status"] = "success";
+                return response;
+            }
+            catch (const std::exception &e)
+            {
+                json errorResponse;
+                errorResponse["error"] = e.what();
+                errorResponse["status"] = "error";
+                return errorResponse;
+            }
+        }
+
+        json PricingEndpoint::handleStrategyRequest(const json &request)
+        {
+            try
+            {
+                return handleStrategyRequest(JsonSerializer::decodeStrategyParams(request));
+            }
+            catch (const std::exception &e)
+            {
+                json errorResponse;
+                errorResponse["error"] = e.what();
+                errorResponse["status"] = "error";
+                return errorResponse;
+            }
+        }
+
+        json PricingEndpoint::handleStrategyRequest(const StrategyParams &params)
+        {
+            try
+            {
+                const std::string &strategy = params.strategy;
+                const double spot = params.spot;
+                const double rate = params.rate;
+                const double volatility = params.volatility;
+                const double time = params.time;
+                const bool isLong = params.isLong;
+
+                // "strike" shifted by offset unless an explicit strike is given
+                auto strikeOr = [&params](const std::optional<double> &strike, double offset)
+                {
+                    if (strike)
+                        return *strike;
+                    if (!params.strike)
+                        throw std::invalid_argument("Missing 'strike' parameter");
+                    return *params.strike + offset;
+                };
 
                 std::shared_ptr<Strategy> strat = nullptr;
 
                 if (strategy == "straddle")
                 {
-                    double strike = request["strike"].get<double>();
+                    double strike = strikeOr(std::nullopt, 0.0);
                     strat = std::make_shared<Straddle>(spot, strike, rate, volatility, time, isLong);
                 }
                 else if (strategy == "strangle")
                 {
-                    double callStrike = request.value("strike_call", request["strike"].get<double>() + 5.0);
-                    double putStrike = request.value("strike_put", request["strike"].get<double>() - 5.0);
+                    double callStrike = strikeOr(params.strikeCall, 5.0);
+                    double putStrike = strikeOr(params.strikePut, -5.0);
                     strat = std::make_shared<Strangle>(spot, callStrike, putStrike, rate, volatility, time, isLong);
                 }
                 else
@@ -110,15 +470,17 @@ namespace OptionPricer
                     throw std::invalid_argument("Unknown strategy: " + strategy);
                 }
 
+                OptionGreeks totals = strat->totalGreeks();
+
                 json response;
                 response["strategy"] = strategy;
                 response["is_long"] = isLong;
-                response["price"] = strat->totalPrice();
-                response["delta"] = strat->totalDelta();
-                response["gamma"] = strat->totalGamma();
-                response["vega"] = strat->totalVega();
-                response["theta"] = strat->totalTheta();
-                response["rho"] = strat->totalRho();
+                response["price"] = totals.price;
+                response["delta"] = totals.delta;
+                response["gamma"] = totals.gamma;
+                response["vega"] = totals.vega;
+                response["theta"] = totals.theta;
+                response["rho"] = totals.rho;
                 response["num_legs"] = static_cast<int>(strat->getLegs().size());
                 response["status"] = "success";
 
@@ -137,53 +499,226 @@ namespace OptionPricer
         {
             try
             {
-                auto baseOption = createOptionFromJson(request);
+                return buildSurfaceResponse(request).toJson();
+            }
+            catch (const std::exception &e)
+            {
+                json errorResponse;
+                errorResponse["error"] = e.what();
+                errorResponse["status"] = "error";
+                return errorResponse;
+            }
+        }
 
-                auto spotRange = request.value("spot_range", json::array({90.0, 110.0}));
-                auto timeRange = request.value("time_range", json::array({0.1, 2.0}));
-                int steps = request.value("steps", 10);
+        ColumnarResponse PricingEndpoint::buildSurfaceResponse(const json &request)
+        {
+            std::shared_ptr<const MarketSnapshot> market;
+            const Underlying *underlying = nullptr;
+            if (request.contains("underlying"))
+            {
+                market = MarketDataStore::shared().snapshot();
+                underlying = &underlyingIn(*market, request["underlying"].get<std::string>());
+            }
+            const bool hasRate = request.contains("rate");
+            const bool hasVolatility = request.contains("volatility");
+            if (!request.contains("type") || !request.contains("strike") ||
+                (!underlying && (!hasRate || !hasVolatility)))
+            {
+                throw std::invalid_argument("Missing required parameters: type, strike, rate, volatility");
+            }
 
-                double spotMin = spotRange[0].get<double>();
-                double spotMax = spotRange[1].get<double>();
-                double timeMin = timeRange[0].get<double>();
-                double timeMax = timeRange[1].get<double>();
+            const double centre = underlying ? underlying->spot : 100.0;
+            auto spotRange = request.value("spot_range", json::array({0.9 * centre, 1.1 * centre}));
+            auto timeRange = request.value("time_range", json::array({0.1, 2.0}));
+            if (!spotRange.is_array() || spotRange.size() != 2 || !timeRange.is_array() || timeRange.size() != 2)
+            {
+                throw std::invalid_argument("spot_range and time_range must be [min, max]");
+            }
 
-                json surface = json::array();
+            GreeksSurface::Spec spec;
+            spec.kind = parseOptionKind(request["type"].get<std::string>());
+            spec.strike = request["strike"].get<double>();
+            spec.rate = hasRate ? request["rate"].get<double>() : 0.0;
+            spec.sigma = hasVolatility ? request["volatility"].get<double>() : 0.0;
+            spec.spotMin = spotRange[0].get<double>();
+            spec.spotMax = spotRange[1].get<double>();
+            spec.timeMin = timeRange[0].get<double>();
+            spec.timeMax = timeRange[1].get<double>();
+            int steps = request.value("steps", 10);
+            spec.spotSteps = request.value("spot_steps", steps);
+            spec.timeSteps = request.value("time_steps", steps);
+            spec.accuracy = Normal::parseAccuracy(request.value("accuracy", "fast"));
 
-                for (int i = 0; i <= steps; ++i)
+            // From an underlying: its curve at each expiry, and its surface at the strike
+            // against the current forward
+            if (underlying && (!hasRate || !hasVolatility))
+            {
+                for (double time : GreeksSurface::axes(spec).times)
                 {
-                    double spot = spotMin + (spotMax - spotMin) * i / steps;
-                    json timeSlice = json::array();
+                    const double rate = hasRate ? spec.rate : underlying->rate(time);
+                    spec.rates.push_back(rate);
+                    spec.sigmas.push_back(hasVolatility ? spec.sigma
+                                                        : marketVolatility(*underlying, underlying->spot, rate,
+                                                                           spec.strike, time));
+                }
+                spec.rate = spec.rates.front();
+                spec.sigma = spec.sigmas.front();
+            }
 
-                    for (int j = 0; j <= steps; ++j)
-                    {
-                        double time = timeMin + (timeMax - timeMin) * j / steps;
+            if (!(spec.strike > 0) || !(spec.sigma > 0) || spec.spotMin <= 0 || spec.timeMin < 0)
+            {
+                throw std::invalid_argument("Parameters must be positive");
+            }
+            if (spec.spotMax < spec.spotMin || spec.timeMax < spec.timeMin)
+            {
+                throw std::invalid_argument("Range max must not be below min");
+            }
+
+            // Columns to return; unless streamed, everything is computed in one kernel pass regardless
+            const json fields = request.value("fields", json::array({"delta", "gamma", "vega"}));
+            if (!fields.is_array() || fields.empty())
+            {
+                throw std::invalid_argument("fields must be a non-empty array");
+            }
 
-                        // Create option with varied spot and time
-                        auto variedOption = std::make_shared<EuropeanOption>(
-                            spot, baseOption->getStrike(),
-                            0.05, 0.2, time, request["type"].get<std::string>());
+            using Field = GreeksSurface::Field;
+            const std::pair<const char *, Field> known[] = {
+                {"price", Field::Price}, {"delta", Field::Delta}, {"gamma", Field::Gamma},
+                {"vega", Field::Vega}, {"theta", Field::Theta}, {"rho", Field::Rho}};
+            std::vector<std::pair<std::string, Field>> selected;
+            for (const auto &field : fields)
+            {
+                const std::string name = field.get<std::string>();
+                auto match = std::find_if(std::begin(known), std::end(known),
+                                          [&](const auto &k)
+                                          { return name == k.first; });
+                if (match == std::end(known))
+                    throw std::invalid_argument("Unknown surface field: " + name);
+                selected.emplace_back(name, match->second);
+            }
 
-                        json point;
-                        point["spot"] = spot;
-                        point["time"] = time;
-                        point["delta"] = variedOption->delta();
-                        point["gamma"] = variedOption->gamma();
-                        point["vega"] = variedOption->vega();
+            const bool streamed = request.value("stream", false);
+            std::shared_ptr<GreeksSurface::Stream> stream;
+            if (streamed)
+            {
+                std::vector<Field> streamedFields;
+                for (const auto &entry : selected)
+                    streamedFields.push_back(entry.second);
+                stream = std::make_shared<GreeksSurface::Stream>(spec, std::move(streamedFields), Scheduler::shared());
+            }
+            GreeksSurface::Grid grid = streamed ? stream->axes() : GreeksSurface::compute(spec, Scheduler::shared());
+            const std::size_t points = grid.spots.size() * grid.times.size();
 
-                        timeSlice.push_back(point);
-                    }
+            ColumnarResponse response;
+            response.meta["shape"] = json::array({grid.spots.size(), grid.times.size()});
+            response.meta["layout"] = "spot_major"; // column[i * times.size() + j] is (spots[i], times[j])
+            response.meta["spot_range"] = spotRange;
+            response.meta["time_range"] = timeRange;
+            response.meta["accuracy"] = Normal::toString(spec.accuracy);
+            if (!streamed && grid.completed < points)
+            {
+                // Cancelled part way: unfinished tiles are NaN, null in JSON
+                response.meta["partial"] = true;
+                response.meta["completed_points"] = grid.completed;
+            }
+            if (underlying)
+            {
+                response.meta["underlying"] = underlying->name;
+                response.meta["market_version"] = market->version();
+            }
+            response.meta["status"] = "success";
+            response.addColumn("spots", std::move(grid.spots));
+            response.addColumn("times", std::move(grid.times));
 
-                    surface.push_back(timeSlice);
+            std::vector<double> *columns[] = {&grid.price, &grid.delta, &grid.gamma,
+                                              &grid.vega, &grid.theta, &grid.rho};
+            for (std::size_t c = 0; c < selected.size(); ++c)
+            {
+                // Streamed columns are read one writer block at a time; the first prices each tile
+                // once for every selected field, so the others only copy
+                if (streamed)
+                {
+                    response.addGeneratedColumn(selected[c].first, points, [stream, c](std::size_t begin, std::size_t end, double *out)
+                                                { stream->read(c, begin, end, out); });
                 }
+                else
+                {
+                    response.addColumn(selected[c].first, *columns[static_cast<int>(selected[c].second)]);
+                }
+            }
 
-                json response;
-                response["surface"] = surface;
-                response["spot_range"] = spotRange;
-                response["time_range"] = timeRange;
-                response["status"] = "success";
+            return response;
+        }
 
-                return response;
+        PricingEndpoint::LegInput PricingEndpoint::parseLeg(const json &legJson, double spot, double rate)
+        {
+            return parseLeg(JsonSerializer::decodeLegParams(legJson), spot, rate);
+        }
+
+        PricingEndpoint::LegInput PricingEndpoint::parseLeg(const LegParams &leg, double spot, double rate)
+        {
+            // optionType is the direction (call/put), model the pricing model (european/american);
+            // the leg's fields go straight into the contract with the request's spot and rate
+            const OptionContract contract = makeContract(parseOptionKind(leg.optionType), leg.model, spot,
+                                                         leg.strike, rate, leg.volatility, leg.time, leg.steps);
+            return {contract, leg.quantity, leg.optionType, leg.model};
+        }
+
+        std::pmr::vector<PricingEndpoint::LegInput> PricingEndpoint::parseLegs(const json &request,
+                                                                               std::pmr::memory_resource *resource)
+        {
+            return parseLegs(JsonSerializer::decodePortfolioParams(request, resource), resource);
+        }
+
+        std::pmr::vector<PricingEndpoint::LegInput> PricingEndpoint::parseLegs(const PortfolioParams &params,
+                                                                               std::pmr::memory_resource *resource)
+        {
+            // Every leg is validated up front so errors are reported in leg
+            // order regardless of how pricing is scheduled
+            std::pmr::vector<LegInput> legs(resource);
+            legs.reserve(params.legs.size());
+            if (params.underlying.empty())
+            {
+                for (const LegParams &leg : params.legs)
+                    legs.push_back(parseLeg(leg, params.spot, params.rate));
+                return legs;
+            }
+
+            // Spot, each leg's rate (the curve at its expiry) and missing leg
+            // volatilities come from one snapshot of the underlying
+            const auto market = MarketDataStore::shared().snapshot();
+            const Underlying &underlying = underlyingIn(*market, params.underlying);
+            const double spot = std::isnan(params.spot) ? underlying.spot : params.spot;
+            for (const LegParams &leg : params.legs)
+            {
+                const double rate = std::isnan(params.rate) ? underlying.rate(leg.time) : params.rate;
+                if (!std::isnan(leg.volatility))
+                {
+                    legs.push_back(parseLeg(leg, spot, rate));
+                    continue;
+                }
+                LegParams resolved = leg;
+                resolved.volatility = marketVolatility(underlying, spot, rate, leg.strike, leg.time);
+                legs.push_back(parseLeg(resolved, spot, rate));
+            }
+
+            return legs;
+        }
+
+        void PricingEndpoint::addPayoffProfile(const Strategy &strategy, json &payoff)
+        {
+            const PayoffProfile profile = strategy.payoffProfile();
+            payoff["breakevens"] = profile.breakevens;
+            payoff["kinks"] = profile.kinks;
+            payoff["max_profit"] = std::isinf(profile.maxProfit) ? json(nullptr) : json(profile.maxProfit);
+            payoff["max_loss"] = std::isinf(profile.maxLoss) ? json(nullptr) : json(profile.maxLoss);
+        }
+
+        json PricingEndpoint::handlePortfolioRequest(const json &request)
+        {
+            try
+            {
+                return buildPortfolioResponse(request).toJson();
             }
             catch (const std::exception &e)
             {
@@ -194,118 +729,433 @@ namespace OptionPricer
             }
         }
 
-        json PricingEndpoint::handlePortfolioRequest(const json &request)
+        ColumnarResponse PricingEndpoint::buildPortfolioResponse(const json &request)
+        {
+            return buildPortfolioResponse(JsonSerializer::decodePortfolioParams(request));
+        }
+
+        ColumnarResponse PricingEndpoint::buildPortfolioResponse(const PortfolioParams &params)
         {
+            const bool stream = params.stream;
+            std::pmr::memory_resource *arena = RequestArena::resource();
+            const std::pmr::vector<LegInput> legs = parseLegs(params, arena);
+            const double spot = legs.front().contract.spot; // the request's, or its underlying's
+
+            // Price and Greeks of each leg in parallel, one slot per leg; legs
+            // unchanged since an earlier request come from the cache, and
+            // American legs sharing a tree and step count share SIMD passes
+            // If the request is cancelled part way, the legs priced so far are
+            // returned and the rest keep a NaN price
+            const double nan = std::numeric_limits<double>::quiet_NaN();
+            std::pmr::vector<OptionGreeks> legGreeks(legs.size(), OptionGreeks{nan, nan, nan, nan, nan, nan}, arena);
+            std::pmr::vector<OptionContract> legContracts(arena);
+            legContracts.reserve(legs.size());
+            for (const auto &leg : legs)
+                legContracts.push_back(leg.contract);
+            std::size_t pricedLegs = legs.size();
             try
             {
-                if (!request.contains("spot") || !request.contains("rate") || !request.contains("legs"))
-                {
-                    throw std::invalid_argument("Missing required parameters: spot, rate, legs");
-                }
+                GreeksCache::shared().greeks(legContracts.data(), legs.size(), legGreeks.data(), Scheduler::shared());
+            }
+            catch (const OperationCancelled &)
+            {
+                pricedLegs = static_cast<std::size_t>(std::count_if(
+                    legGreeks.begin(), legGreeks.end(), [](const OptionGreeks &g)
+                    { return !std::isnan(g.price); }));
+                if (pricedLegs == 0)
+                    throw;
+            }
+            const bool partial = pricedLegs < legs.size();
 
-                double spot = request["spot"].get<double>();
-                double rate = request["rate"].get<double>();
-                auto legsArray = request["legs"];
+            // Reduce in leg order so totals are bit-for-bit independent of thread count.
+            // Streamed payoff columns run after the handler returns, so their
+            // Strategy cannot live on the request arena
+            std::pmr::memory_resource *strategyResource = stream ? std::pmr::get_default_resource() : arena;
+            auto portfolio = std::allocate_shared<Strategy>(std::pmr::polymorphic_allocator<Strategy>(strategyResource),
+                                                            strategyResource);
+            json legsResponse = json::array();
+            double totalPrice = 0.0;
+            double totalDelta = 0.0;
+            double totalGamma = 0.0;
+            double totalVega = 0.0;
+            double totalTheta = 0.0;
+            double totalRho = 0.0;
 
-                if (!legsArray.is_array() || legsArray.empty())
+            for (std::size_t i = 0; i < legs.size(); ++i)
+            {
+                const LegInput &leg = legs[i];
+                const OptionGreeks &g = legGreeks[i];
+                const int quantity = leg.quantity;
+                const bool priced = !partial || !std::isnan(g.price);
+                json legResponse;
+                legResponse["optionType"] = leg.optionType;
+                legResponse["model"] = leg.model;
+                legResponse["strike"] = leg.contract.strike;
+                if (!priced)
                 {
-                    throw std::invalid_argument("legs must be a non-empty array");
+                    // Left out of the totals and the payoff
+                    legResponse["quantity"] = quantity;
+                    legResponse["priced"] = false;
+                    legsResponse.push_back(legResponse);
+                    continue;
                 }
+                portfolio->addLeg(leg.contract, quantity, g.price);
 
-                // Create strategy with all legs
-                auto portfolio = std::make_shared<Strategy>();
-                json legsResponse = json::array();
-                double totalPrice = 0.0;
-                double totalDelta = 0.0;
-                double totalGamma = 0.0;
-                double totalVega = 0.0;
-                double totalTheta = 0.0;
-                double totalRho = 0.0;
+                // Accumulate greeks
+                double legPrice = g.price * quantity;
+                totalPrice += legPrice;
+                totalDelta += g.delta * quantity;
+                totalGamma += g.gamma * quantity;
+                totalVega += g.vega * quantity;
+                totalTheta += g.theta * quantity;
+                totalRho += g.rho * quantity;
 
-                for (const auto &legJson : legsArray)
-                {
-                    if (!legJson.contains("strike") || !legJson.contains("volatility") || !legJson.contains("time"))
-                    {
-                        throw std::invalid_argument("Each leg must have: strike, volatility, time");
-                    }
+                // Build leg response
+                legResponse["price"] = g.price;
+                legResponse["quantity"] = quantity;
+                legResponse["delta"] = g.delta;
+                legResponse["gamma"] = g.gamma;
+                legResponse["vega"] = g.vega;
+                legResponse["theta"] = g.theta;
+                legResponse["rho"] = g.rho;
+                legsResponse.push_back(legResponse);
+            }
 
-                    // Extract option direction (call/put) and pricing model (european/american)
-                    std::string optionDirection = legJson.value("optionType", "call");
-                    std::string modelType = legJson.value("type", "european");
-
-                    // Build full parameter set for this leg
-                    json legParams;
-                    legParams["spot"] = spot;
-                    legParams["strike"] = legJson["strike"];
-                    legParams["rate"] = rate;
-                    legParams["volatility"] = legJson["volatility"];
-                    legParams["time"] = legJson["time"];
-                    legParams["type"] = optionDirection; // call/put direction
-                    legParams["model"] = modelType;      // european/american model
-
-                    auto option = createOptionFromJson(legParams);
-                    int quantity = legJson.value("quantity", 1);
-
-                    portfolio->addLeg(option, quantity);
-
-                    // Accumulate greeks
-                    double legPrice = option->price() * quantity;
-                    totalPrice += legPrice;
-                    totalDelta += option->delta() * quantity;
-                    totalGamma += option->gamma() * quantity;
-                    totalVega += option->vega() * quantity;
-                    totalTheta += option->theta() * quantity;
-                    totalRho += option->rho() * quantity;
-
-                    // Build leg response
-                    json legResponse;
-                    legResponse["optionType"] = legJson.value("optionType", "call");
-                    legResponse["model"] = modelType;
-                    legResponse["strike"] = option->getStrike();
-                    legResponse["price"] = option->price();
-                    legResponse["quantity"] = quantity;
-                    legResponse["delta"] = option->delta();
-                    legResponse["gamma"] = option->gamma();
-                    legResponse["vega"] = option->vega();
-                    legResponse["theta"] = option->theta();
-                    legResponse["rho"] = option->rho();
-                    legsResponse.push_back(legResponse);
-                }
+            // Generate payoff diagram
+            const int payoffSteps = params.payoffSteps;
+            if (payoffSteps < 1)
+            {
+                throw std::invalid_argument("payoff_steps must be positive");
+            }
+            double spotMin = spot * 0.7; // 30% below current spot
+            double spotMax = spot * 1.3; // 30% above current spot
 
-                // Generate payoff diagram
-                int payoffSteps = request.value("payoff_steps", 100);
-                double spotMin = spot * 0.7; // 30% below current spot
-                double spotMax = spot * 1.3; // 30% above current spot
+            const std::size_t points = static_cast<std::size_t>(payoffSteps) + 1;
+            auto spotAt = [spotMin, spotMax, payoffSteps](std::size_t i)
+            { return spotMin + (spotMax - spotMin) * static_cast<int>(i) / payoffSteps; };
+            auto spotColumn = [spotAt](std::size_t begin, std::size_t end, double *out)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                    out[i - begin] = spotAt(i);
+            };
+            auto payoffColumn = [spotColumn, portfolio](std::size_t begin, std::size_t end, double *out)
+            {
+                std::vector<double> spots(end - begin);
+                spotColumn(begin, end, spots.data());
+                portfolio->payoffGrid(spots.data(), spots.size(), out);
+            };
 
-                json payoffData = json::object();
-                payoffData["spot_prices"] = json::array();
-                payoffData["payoffs"] = json::array();
+            // Build response; the payoff arrays stay columns so writers never box them
+            ColumnarResponse response;
+            json &meta = response.meta;
+            meta["portfolio"] = json::object();
+            meta["portfolio"]["spot"] = spot;
+            meta["portfolio"]["totalPrice"] = totalPrice;
+            meta["portfolio"]["greeks"] = json::object();
+            meta["portfolio"]["greeks"]["delta"] = totalDelta;
+            meta["portfolio"]["greeks"]["gamma"] = totalGamma;
+            meta["portfolio"]["greeks"]["vega"] = totalVega;
+            meta["portfolio"]["greeks"]["theta"] = totalTheta;
+            meta["portfolio"]["greeks"]["rho"] = totalRho;
+            meta["portfolio"]["legs"] = legsResponse;
+            meta["portfolio"]["payoff"] = json::object();
+            addPayoffProfile(*portfolio, meta["portfolio"]["payoff"]);
+            if (partial)
+            {
+                meta["portfolio"]["partial"] = true;
+                meta["portfolio"]["priced_legs"] = pricedLegs;
+            }
+            meta["status"] = "success";
+            if (stream)
+            {
+                response.addGeneratedColumn("portfolio.payoff.spot_prices", points, spotColumn);
+                response.addGeneratedColumn("portfolio.payoff.payoffs", points, payoffColumn);
+            }
+            else
+            {
+                std::vector<double> spotPrices(points), payoffs(points);
+                spotColumn(0, points, spotPrices.data());
+                portfolio->payoffGrid(spotPrices.data(), points, payoffs.data());
+                response.addColumn("portfolio.payoff.spot_prices", std::move(spotPrices));
+                response.addColumn("portfolio.payoff.payoffs", std::move(payoffs));
+            }
 
-                for (int i = 0; i <= payoffSteps; ++i)
-                {
-                    double testSpot = spotMin + (spotMax - spotMin) * i / payoffSteps;
-                    double totalPayoff = portfolio->payoff(testSpot);
+            return response;
+        }
+
+
+
+        PricingEndpoint::RiskRequest PricingEndpoint::parseRiskRequest(const json &request)
+        {
+            if (!request.contains("legs") ||
+                (!request.contains("underlying") && (!request.contains("spot") || !request.contains("rate"))))
+            {
+                throw std::invalid_argument("Missing required parameters: spot, rate, legs");
+            }
+
+            RiskRequest parsed;
+            const std::pmr::vector<LegInput> legs = parseLegs(request);
+            double meanVol = 0.0;
+            for (const auto &leg : legs)
+            {
+                parsed.positions.emplace_back(leg.contract, leg.quantity);
+                meanVol += leg.contract.sigma / legs.size();
+            }
 
-                    payoffData["spot_prices"].push_back(testSpot);
-                    payoffData["payoffs"].push_back(totalPayoff);
+            MonteCarloRisk::Spec &spec = parsed.spec;
+            spec.horizon = request.value("horizon", spec.horizon);
+            spec.paths = request.value("paths", spec.paths);
+            spec.sampling = MonteCarloRisk::parseSampling(request.value("sampling", "antithetic"));
+            spec.seed = request.value("seed", spec.seed);
+            spec.spotVol = request.value("spot_volatility", meanVol);
+            spec.volOfVol = request.value("vol_of_vol", spec.volOfVol);
+            spec.correlation = request.value("correlation", spec.correlation);
+            // Without a rate, drift at the underlying's zero rate to the horizon
+            double rate;
+            if (request.contains("rate"))
+                rate = request["rate"].get<double>();
+            else
+                rate = underlyingIn(*MarketDataStore::shared().snapshot(), request["underlying"].get<std::string>())
+                           .rate(spec.horizon);
+            spec.drift = request.value("drift", rate);
+            const std::string revaluation = request.value("revaluation", "full");
+            if (revaluation != "full" && revaluation != "taylor")
+            {
+                throw std::invalid_argument("Invalid revaluation: " + revaluation + " (expected \"full\" or \"taylor\")");
+            }
+            spec.taylor = revaluation == "taylor";
+            spec.gammaThreshold = request.value("gamma_threshold", spec.gammaThreshold);
+            spec.accuracy = Normal::parseAccuracy(request.value("accuracy", "exact"));
+            parsed.confidences = request.value("confidence", std::vector<double>{0.95, 0.99});
+            return parsed;
+        }
+
+        json PricingEndpoint::riskResponse(const RiskRequest &request, const MonteCarloRisk::Result &result)
+        {
+            json levels = json::array();
+            for (const auto &level : result.levels)
+                levels.push_back({{"confidence", level.confidence}, {"var", level.var}, {"es", level.es}});
+
+            json response;
+            response["risk"]["paths"] = result.paths;
+            response["risk"]["sampling"] = MonteCarloRisk::toString(request.spec.sampling);
+            response["risk"]["horizon"] = request.spec.horizon;
+            response["risk"]["revaluation"] = request.spec.taylor ? "taylor" : "full";
+            response["risk"]["accuracy"] = Normal::toString(request.spec.accuracy);
+            response["risk"]["fully_revalued_legs"] = result.fullyRevaluedLegs;
+            response["risk"]["base_value"] = result.baseValue;
+            response["risk"]["mean_pnl"] = result.meanPnl;
+            response["risk"]["stdev_pnl"] = result.stdevPnl;
+            response["risk"]["max_loss"] = result.maxLoss;
+            response["risk"]["probability_of_profit"] = result.pop;
+            response["risk"]["levels"] = levels;
+            response["status"] = "success";
+            return response;
+        }
+
+        json PricingEndpoint::handleRiskRequest(const json &request)
+        {
+            try
+            {
+                const RiskRequest parsed = parseRiskRequest(request);
+                RiskMeasures::Portfolio portfolio;
+                for (const auto &position : parsed.positions)
+                    portfolio.emplace_back(position.first.toOption(RequestArena::resource()), position.second);
+
+                const MonteCarloRisk::Result result =
+                    MonteCarloRisk::run(portfolio, parsed.spec, parsed.confidences, Scheduler::shared());
+                return riskResponse(parsed, result);
+            }
+            catch (const std::exception &e)
+            {
+                json errorResponse;
+                errorResponse["error"] = e.what();
+                errorResponse["status"] = "error";
+                return errorResponse;
+            }
+        }
+
+        json PricingEndpoint::handleChainRequest(const json &request)
+        {
+            try
+            {
+                return buildChainResponse(request).toJson();
+            }
+            catch (const std::exception &e)
+            {
+                json errorResponse;
+                errorResponse["error"] = e.what();
+                errorResponse["status"] = "error";
+                return errorResponse;
+            }
+        }
+
+        ColumnarResponse PricingEndpoint::buildChainResponse(const json &request)
+        {
+            if (!request.contains("strikes") || !request["strikes"].is_array() || request["strikes"].empty())
+            {
+                throw std::invalid_argument("strikes must be a non-empty array");
+            }
+
+            const std::size_t n = request["strikes"].size();
+            std::vector<double> strikes, vols, times;
+            readChainColumn(request, "strikes", "strike", n, strikes);
+            readChainColumn(request, "times", "time", n, times);
+            ChainMarket market = chainMarket(request, times);
+            const double spot = market.spot;
+            std::vector<double> spots(n, spot);
+            std::vector<double> rates = std::move(market.rates);
+            if (market.underlying && !request.contains("volatilities") && !request.contains("volatility"))
+            {
+                vols.resize(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    vols[i] = marketVolatility(*market.underlying, spot, rates[i], strikes[i], times[i]);
+            }
+            else
+            {
+                readChainColumn(request, "volatilities", "volatility", n, vols);
+            }
+
+            // Option direction is parsed once per strike here, never in the kernel
+            std::vector<OptionKind> kinds(n);
+            if (request.contains("types"))
+            {
+                const json &types = request["types"];
+                if (!types.is_array() || types.size() != n)
+                    throw std::invalid_argument("types must be an array matching strikes");
+                for (std::size_t i = 0; i < n; ++i)
+                    kinds[i] = parseOptionKind(types[i].get<std::string>());
+            }
+            else
+            {
+                std::fill(kinds.begin(), kinds.end(), parseOptionKind(request.value("type", "call")));
+            }
+
+            std::vector<double> price(n), delta(n), gamma(n), vega(n), theta(n), rho(n);
+            const BlackScholes::BatchOutput out{price.data(), delta.data(), gamma.data(), vega.data(), theta.data(),
+                                                rho.data()};
+            ColumnarResponse response;
+            const std::string model = request.value("model", "european");
+            if (model == "european")
+            {
+                // Long chains are split into blocks so each core runs the SIMD kernel on its own slice
+                const std::size_t blockSize = 4096;
+                Scheduler::shared().parallelFor((n + blockSize - 1) / blockSize, [&](std::size_t block)
+                                                {
+                    const std::size_t b = block * blockSize;
+                    const std::size_t m = std::min(blockSize, n - b);
+                    BlackScholes::priceAndGreeksBatch(
+                        {spots.data() + b, strikes.data() + b, rates.data() + b, vols.data() + b, times.data() + b, kinds.data() + b, m},
+                        {price.data() + b, delta.data() + b, gamma.data() + b, vega.data() + b, theta.data() + b, rho.data() + b}); }, 1);
+                response.meta["instruction_set"] = BlackScholes::batchInstructionSet();
+            }
+            else
+            {
+                const AmericanModel american = parseAmericanModel(model);
+                const int steps = request.value("steps", 100);
+                if (american == AmericanModel::FiniteDifference)
+                {
+                    // One PDE solve per expiry and type serves every strike. The
+                    // engine takes one rate, so a curve splits the chain by rate
+                    std::vector<double> distinct(rates);
+                    std::sort(distinct.begin(), distinct.end());
+                    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+                    const FiniteDifference::Grid fdGrid = FiniteDifference::gridForSteps(steps);
+                    if (distinct.size() == 1)
+                    {
+                        FiniteDifference::americanChain({spot, distinct.front(), strikes.data(), vols.data(), times.data(),
+                                                         kinds.data(), n},
+                                                        out, Scheduler::shared(), fdGrid);
+                    }
+                    else
+                    {
+                        double *columns[] = {price.data(), delta.data(), gamma.data(), vega.data(), theta.data(), rho.data()};
+                        for (double rate : distinct)
+                        {
+                            std::vector<std::size_t> members;
+                            for (std::size_t i = 0; i < n; ++i)
+                                if (rates[i] == rate)
+                                    members.push_back(i);
+                            const std::size_t m = members.size();
+                            std::vector<double> groupStrikes(m), groupVols(m), groupTimes(m), groupOut(6 * m);
+                            std::vector<OptionKind> groupKinds(m);
+                            for (std::size_t j = 0; j < m; ++j)
+                            {
+                                groupStrikes[j] = strikes[members[j]];
+                                groupVols[j] = vols[members[j]];
+                                groupTimes[j] = times[members[j]];
+                                groupKinds[j] = kinds[members[j]];
+                            }
+                            double *g = groupOut.data();
+                            FiniteDifference::americanChain({spot, rate, groupStrikes.data(), groupVols.data(), groupTimes.data(),
+                                                             groupKinds.data(), m},
+                                                            {g, g + m, g + 2 * m, g + 3 * m, g + 4 * m, g + 5 * m},
+                                                            Scheduler::shared(), fdGrid);
+                            for (std::size_t f = 0; f < 6; ++f)
+                                for (std::size_t j = 0; j < m; ++j)
+                                    columns[f][members[j]] = g[f * m + j];
+                        }
+                    }
                 }
+                else if (american == AmericanModel::CRR || american == AmericanModel::BBSR)
+                {
+                    // Every strike shares the step count: batchLanes() trees per SIMD pass
+                    const std::size_t lanes = BinomialTree::batchLanes();
+                    const std::vector<double> spots(n, spot);
+                    Scheduler::shared().parallelFor((n + lanes - 1) / lanes, [&](std::size_t block)
+                                                    {
+                        const std::size_t b = block * lanes;
+                        const std::size_t m = std::min(lanes, n - b);
+                        BinomialTree::LatticeSensitivities s[BinomialTree::MaxBatchLanes];
+                        BinomialTree::americanSensitivitiesBatch({spots.data() + b, strikes.data() + b, rates.data() + b,
+                                                                  vols.data() + b, times.data() + b, kinds.data() + b, m},
+                                                                 steps, american, s);
+                        for (std::size_t j = 0; j < m; ++j)
+                        {
+                            const OptionGreeks g = AmericanOption::latticeGreeks(s[j]);
+                            price[b + j] = g.price;
+                            delta[b + j] = g.delta;
+                            gamma[b + j] = g.gamma;
+                            vega[b + j] = g.vega;
+                            theta[b + j] = g.theta;
+                            rho[b + j] = g.rho;
+                        } }, 1);
+                }
+                else
+                {
+                    Scheduler::shared().parallelFor(n, [&](std::size_t i)
+                                                    {
+                        const OptionGreeks g = AmericanOption(spot, strikes[i], rates[i], vols[i], times[i], kinds[i],
+                                                              steps, american).greeks();
+                        price[i] = g.price;
+                        delta[i] = g.delta;
+                        gamma[i] = g.gamma;
+                        vega[i] = g.vega;
+                        theta[i] = g.theta;
+                        rho[i] = g.rho; });
+                }
+            }
 
-                // Build response
-                json response;
-                response["portfolio"] = json::object();
-                response["portfolio"]["spot"] = spot;
-                response["portfolio"]["totalPrice"] = totalPrice;
-                response["portfolio"]["greeks"] = json::object();
-                response["portfolio"]["greeks"]["delta"] = totalDelta;
-                response["portfolio"]["greeks"]["gamma"] = totalGamma;
-                response["portfolio"]["greeks"]["vega"] = totalVega;
-                response["portfolio"]["greeks"]["theta"] = totalTheta;
-                response["portfolio"]["greeks"]["rho"] = totalRho;
-                response["portfolio"]["legs"] = legsResponse;
-                response["portfolio"]["payoff"] = payoffData;
-                response["status"] = "success";
+            response.meta["count"] = n;
+            response.meta["model"] = model;
+            addMarketMeta(market, response.meta);
+            response.meta["status"] = "success";
+            response.addColumn("strikes", std::move(strikes));
+            response.addColumn("price", std::move(price));
+            response.addColumn("delta", std::move(delta));
+            response.addColumn("gamma", std::move(gamma));
+            response.addColumn("vega", std::move(vega));
+            response.addColumn("theta", std::move(theta));
+            response.addColumn("rho", std::move(rho));
 
-                return response;
+            return response;
+        }
+
+        json PricingEndpoint::handleImpliedVolBatchRequest(const json &request)
+        {
+            try
+            {
+                return buildImpliedVolResponse(request).toJson();
             }
             catch (const std::exception &e)
             {
@@ -316,5 +1166,58 @@ namespace OptionPricer
             }
         }
 
+        ColumnarResponse PricingEndpoint::buildImpliedVolResponse(const json &request)
+        {
+            if (!request.contains("strikes") || !request["strikes"].is_array() || request["strikes"].empty())
+            {
+                throw std::invalid_argument("strikes must be a non-empty array");
+            }
+
+            const std::size_t n = request["strikes"].size();
+            std::vector<double> strikes, prices, times;
+            readChainColumn(request, "strikes", "strike", n, strikes);
+            readChainColumn(request, "prices", "price", n, prices);
+            readChainColumn(request, "times", "time", n, times);
+            ChainMarket market = chainMarket(request, times);
+            std::vector<double> spots(n, market.spot);
+            std::vector<double> rates = std::move(market.rates);
+
+            std::vector<OptionKind> kinds(n);
+            if (request.contains("types"))
+            {
+                const json &types = request["types"];
+                if (!types.is_array() || types.size() != n)
+                    throw std::invalid_argument("types must be an array matching strikes");
+                for (std::size_t i = 0; i < n; ++i)
+                    kinds[i] = parseOptionKind(types[i].get<std::string>());
+            }
+            else
+            {
+                std::fill(kinds.begin(), kinds.end(), parseOptionKind(request.value("type", "call")));
+            }
+
+            std::vector<double> vols(n);
+            const std::size_t blockSize = 4096;
+            Scheduler::shared().parallelFor((n + blockSize - 1) / blockSize, [&](std::size_t block)
+                                            {
+                const std::size_t b = block * blockSize;
+                const std::size_t m = std::min(blockSize, n - b);
+                BlackScholes::impliedVolatilityBatch(
+                    {prices.data() + b, spots.data() + b, strikes.data() + b, rates.data() + b, times.data() + b, kinds.data() + b, m},
+                    vols.data() + b); }, 1);
+
+            ColumnarResponse response;
+            response.meta["count"] = n;
+            response.meta["unsolved"] = std::count_if(vols.begin(), vols.end(), [](double v)
+                                                      { return std::isnan(v); });
+            response.meta["instruction_set"] = BlackScholes::batchInstructionSet();
+            addMarketMeta(market, response.meta);
+            response.meta["status"] = "success";
+            response.addColumn("strikes", std::move(strikes));
+            response.addColumn("implied_volatility", std::move(vols));
+
+            return response;
+        }
+
     } // namespace API
 } // namespace OptionPricer
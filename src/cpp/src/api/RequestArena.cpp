@@ -0,0 +1,54 @@
+#include "api/RequestArena.h"
+#include <cstring>
+#include <memory>
+#include <optional>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        namespace
+        {
+            struct ThreadArena
+            {
+                std::unique_ptr<unsigned char[]> buffer; // allocated on first use, kept for the thread's life
+                std::optional<std::pmr::monotonic_buffer_resource> arena;
+                int depth = 0;
+            };
+
+            thread_local ThreadArena current;
+        } // namespace
+
+        RequestArena::Scope::Scope()
+        {
+            if (current.depth++ > 0)
+                return; // nested scopes share the outer request's arena
+            if (!current.buffer)
+                current.buffer.reset(new unsigned char[BufferBytes]);
+            current.arena.emplace(current.buffer.get(), BufferBytes, std::pmr::new_delete_resource());
+        }
+
+        RequestArena::Scope::~Scope()
+        {
+            if (--current.depth == 0)
+                current.arena.reset(); // rewinds the buffer and frees any overflow blocks
+        }
+
+        std::pmr::memory_resource *RequestArena::resource()
+        {
+            if (current.arena)
+                return &*current.arena;
+            return std::pmr::get_default_resource();
+        }
+
+        void RequestArena::prepare()
+        {
+            if (current.buffer)
+                return;
+            current.buffer.reset(new unsigned char[BufferBytes]);
+            std::memset(current.buffer.get(), 0, BufferBytes); // the pages are mapped on first write
+        }
+
+    } // namespace API
+} // namespace OptionPricer
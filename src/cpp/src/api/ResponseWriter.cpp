@@ -0,0 +1,401 @@
+#include "api/ResponseWriter.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        namespace
+        {
+            using Column = ColumnarResponse::Column;
+
+            // Values requested from a generator per call; bounds streaming memory
+            constexpr std::size_t GeneratorBlock = 1 << 16;
+
+            /**
+             * Output buffer that hands full pieces to the sink. Without a sink
+             * everything accumulates in buffer.
+             */
+            class Emitter
+            {
+            public:
+                Emitter(const ResponseWriter::Sink *sink, std::size_t chunkBytes)
+                    : sink_(sink), chunkBytes_(chunkBytes) {}
+
+                std::string buffer;
+
+                // Bytes emitted so far, flushed or not (binary alignment)
+                std::size_t position() const { return flushed_ + buffer.size(); }
+                bool aborted() const { return aborted_; }
+
+                void maybeFlush()
+                {
+                    if (sink_ && buffer.size() >= chunkBytes_)
+                        flush();
+                }
+
+                void flush()
+                {
+                    if (!sink_ || buffer.empty() || aborted_)
+                        return;
+                    aborted_ = !(*sink_)(buffer.data(), buffer.size());
+                    flushed_ += buffer.size();
+                    buffer.clear();
+                }
+
+            private:
+                const ResponseWriter::Sink *sink_;
+                std::size_t chunkBytes_;
+                std::size_t flushed_ = 0;
+                bool aborted_ = false;
+            };
+
+            // Visit a column in blocks, generating values on demand
+            template <typename Fn>
+            void forEachBlock(const Column &column, Emitter &out, Fn &&fn)
+            {
+                if (!column.generate)
+                {
+                    for (std::size_t b = 0; b < column.size && !out.aborted(); b += GeneratorBlock)
+                    {
+                        fn(column.values.data() + b, std::min(GeneratorBlock, column.size - b));
+                        out.maybeFlush();
+                    }
+                    return;
+                }
+
+                std::vector<double> block(std::min(GeneratorBlock, column.size));
+                for (std::size_t b = 0; b < column.size && !out.aborted(); b += GeneratorBlock)
+                {
+                    const std::size_t n = std::min(GeneratorBlock, column.size - b);
+                    column.generate(b, b + n, block.data());
+                    fn(block.data(), n);
+                    out.maybeFlush();
+                }
+            }
+
+            // Columns whose parent path is exactly prefix ("" for top level, "a.b." for a.b)
+            std::vector<const Column *> columnsAt(const ColumnarResponse &response, const std::string &prefix)
+            {
+                std::vector<const Column *> result;
+                for (const auto &column : response.columns)
+                {
+                    const std::size_t dot = column.path.rfind('.');
+                    const std::size_t parentLength = dot == std::string::npos ? 0 : dot + 1;
+                    if (parentLength == prefix.size() && column.path.compare(0, parentLength, prefix) == 0)
+                        result.push_back(&column);
+                }
+                return result;
+            }
+
+            std::string leafName(const std::string &path)
+            {
+                const std::size_t dot = path.rfind('.');
+                return dot == std::string::npos ? path : path.substr(dot + 1);
+            }
+
+            // ---------------------------------------------------------------- JSON
+
+            void appendJsonNumbers(std::string &out, const double *values, std::size_t count)
+            {
+                out.reserve(out.size() + count * 20);
+                char buffer[32];
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    if (i)
+                        out += ',';
+                    if (!std::isfinite(values[i]))
+                    {
+                        out += "null"; // same as nlohmann::json for NaN/inf
+                        continue;
+                    }
+                    char *end = std::to_chars(buffer, buffer + sizeof buffer, values[i]).ptr;
+                    out.append(buffer, end);
+                    // Keep integral values recognisably floating point, as nlohmann does
+                    if (std::find_if(buffer, end, [](char c)
+                                     { return c == '.' || c == 'e'; }) == end)
+                        out += ".0";
+                }
+            }
+
+            void writeJsonObject(Emitter &out, const ColumnarResponse &response,
+                                 const json &object, const std::string &prefix)
+            {
+                out.buffer += '{';
+                bool first = true;
+                for (auto it = object.begin(); it != object.end(); ++it)
+                {
+                    if (!first)
+                        out.buffer += ',';
+                    first = false;
+                    out.buffer += json(it.key()).dump();
+                    out.buffer += ':';
+                    if (it->is_object())
+                        writeJsonObject(out, response, *it, prefix + it.key() + ".");
+                    else
+                        out.buffer += it->dump();
+                }
+                for (const Column *column : columnsAt(response, prefix))
+                {
+                    if (!first)
+                        out.buffer += ',';
+                    first = false;
+                    out.buffer += json(leafName(column->path)).dump();
+                    out.buffer += ":[";
+                    bool firstBlock = true;
+                    forEachBlock(*column, out, [&](const double *values, std::size_t n)
+                                 {
+                        if (!firstBlock)
+                            out.buffer += ',';
+                        firstBlock = false;
+                        appendJsonNumbers(out.buffer, values, n); });
+                    out.buffer += ']';
+                }
+                out.buffer += '}';
+            }
+
+            // ------------------------------------------------------------ MsgPack
+
+            void putBigEndian(std::string &out, std::uint64_t value, int bytes)
+            {
+                for (int i = bytes - 1; i >= 0; --i)
+                    out += static_cast<char>((value >> (8 * i)) & 0xff);
+            }
+
+            void putMsgPackHeader(std::string &out, std::size_t n, unsigned char fix, int fixLimit,
+                                  unsigned char tag16, unsigned char tag32)
+            {
+                if (n < static_cast<std::size_t>(fixLimit))
+                {
+                    out += static_cast<char>(fix | n);
+                }
+                else if (n <= 0xffff)
+                {
+                    out += static_cast<char>(tag16);
+                    putBigEndian(out, n, 2);
+                }
+                else
+                {
+                    out += static_cast<char>(tag32);
+                    putBigEndian(out, n, 4);
+                }
+            }
+
+            void putMsgPackString(std::string &out, const std::string &s)
+            {
+                if (s.size() < 32)
+                {
+                    out += static_cast<char>(0xa0 | s.size());
+                }
+                else if (s.size() <= 0xff)
+                {
+                    out += static_cast<char>(0xd9);
+                    putBigEndian(out, s.size(), 1);
+                }
+                else
+                {
+                    putMsgPackHeader(out, s.size(), 0, 0, 0xda, 0xdb);
+                }
+                out += s;
+            }
+
+            void writeMsgPackObject(Emitter &out, const ColumnarResponse &response,
+                                    const json &object, const std::string &prefix)
+            {
+                const std::vector<const Column *> columns = columnsAt(response, prefix);
+                putMsgPackHeader(out.buffer, object.size() + columns.size(), 0x80, 16, 0xde, 0xdf);
+
+                for (auto it = object.begin(); it != object.end(); ++it)
+                {
+                    putMsgPackString(out.buffer, it.key());
+                    if (it->is_object())
+                    {
+                        writeMsgPackObject(out, response, *it, prefix + it.key() + ".");
+                    }
+                    else
+                    {
+                        const std::vector<std::uint8_t> packed = json::to_msgpack(*it);
+                        out.buffer.append(packed.begin(), packed.end());
+                    }
+                }
+                for (const Column *column : columns)
+                {
+                    putMsgPackString(out.buffer, leafName(column->path));
+                    putMsgPackHeader(out.buffer, column->size, 0x90, 16, 0xdc, 0xdd);
+                    forEachBlock(*column, out, [&](const double *values, std::size_t n)
+                                 {
+                        for (std::size_t i = 0; i < n; ++i)
+                        {
+                            std::uint64_t bits;
+                            std::memcpy(&bits, &values[i], sizeof bits);
+                            out.buffer += static_cast<char>(0xcb);
+                            putBigEndian(out.buffer, bits, 8);
+                        } });
+                }
+            }
+
+            // ------------------------------------------------------------- Binary
+
+            void putLittleEndian(std::string &out, std::uint64_t value, int bytes)
+            {
+                for (int i = 0; i < bytes; ++i)
+                    out += static_cast<char>((value >> (8 * i)) & 0xff);
+            }
+
+            bool hostIsLittleEndian()
+            {
+                const std::uint16_t probe = 1;
+                unsigned char first;
+                std::memcpy(&first, &probe, 1);
+                return first == 1;
+            }
+
+            void writeBinaryBody(Emitter &out, const ColumnarResponse &response)
+            {
+                const std::string meta = response.meta.dump();
+                out.buffer += "OPRB";
+                putLittleEndian(out.buffer, 1, 2);
+                putLittleEndian(out.buffer, response.columns.size(), 2);
+                putLittleEndian(out.buffer, meta.size(), 4);
+                out.buffer += meta;
+
+                const bool little = hostIsLittleEndian();
+                for (const auto &column : response.columns)
+                {
+                    putLittleEndian(out.buffer, column.path.size(), 2);
+                    out.buffer += column.path;
+                    putLittleEndian(out.buffer, column.size, 8);
+                    out.buffer.append((8 - out.position() % 8) % 8, '\0');
+
+                    forEachBlock(column, out, [&](const double *values, std::size_t n)
+                                 {
+                        if (little)
+                        {
+                            out.buffer.append(reinterpret_cast<const char *>(values), n * sizeof(double));
+                            return;
+                        }
+                        for (std::size_t i = 0; i < n; ++i)
+                        {
+                            std::uint64_t bits;
+                            std::memcpy(&bits, &values[i], sizeof bits);
+                            putLittleEndian(out.buffer, bits, 8);
+                        } });
+                }
+            }
+
+            void writeBody(Emitter &out, const ColumnarResponse &response, ResponseWriter::Format format)
+            {
+                switch (format)
+                {
+                case ResponseWriter::Format::MsgPack:
+                    writeMsgPackObject(out, response, response.meta, "");
+                    break;
+                case ResponseWriter::Format::Binary:
+                    writeBinaryBody(out, response);
+                    break;
+                default:
+                    writeJsonObject(out, response, response.meta, "");
+                    break;
+                }
+            }
+        } // namespace
+
+        json ColumnarResponse::toJson() const
+        {
+            json result = meta;
+            for (const auto &column : columns)
+            {
+                std::string pointer = "/" + column.path;
+                for (char &c : pointer)
+                {
+                    if (c == '.')
+                        c = '/';
+                }
+                if (column.generate)
+                {
+                    std::vector<double> values(column.size);
+                    if (column.size)
+                        column.generate(0, column.size, values.data());
+                    result[json::json_pointer(pointer)] = values;
+                }
+                else
+                {
+                    result[json::json_pointer(pointer)] = column.values;
+                }
+            }
+            return result;
+        }
+
+        namespace ResponseWriter
+        {
+
+            Format negotiate(const std::string &accept)
+            {
+                std::size_t begin = 0;
+                while (begin < accept.size())
+                {
+                    std::size_t end = accept.find(',', begin);
+                    if (end == std::string::npos)
+                        end = accept.size();
+                    std::string range = accept.substr(begin, end - begin);
+                    range = range.substr(0, range.find(';')); // drop parameters such as q=
+                    const std::size_t first = range.find_first_not_of(" \t");
+                    const std::size_t last = range.find_last_not_of(" \t");
+                    if (first != std::string::npos)
+                        range = range.substr(first, last - first + 1);
+
+                    if (range == "application/x-msgpack" || range == "application/msgpack")
+                        return Format::MsgPack;
+                    if (range == "application/octet-stream")
+                        return Format::Binary;
+                    if (range == "application/json")
+                        return Format::Json;
+                    begin = end + 1;
+                }
+                return Format::Json;
+            }
+
+            const char *contentType(Format format)
+            {
+                switch (format)
+                {
+                case Format::MsgPack:
+                    return "application/x-msgpack";
+                case Format::Binary:
+                    return "application/octet-stream";
+                default:
+                    return "application/json";
+                }
+            }
+
+            std::string write(const ColumnarResponse &response, Format format)
+            {
+                Emitter out(nullptr, 0);
+                writeBody(out, response, format);
+                return std::move(out.buffer);
+            }
+
+            bool write(const ColumnarResponse &response, Format format, const Sink &sink,
+                       std::size_t chunkBytes)
+            {
+                Emitter out(&sink, chunkBytes);
+                writeBody(out, response, format);
+                out.flush();
+                return !out.aborted();
+            }
+
+            void appendJsonArray(std::string &out, const double *values, std::size_t count)
+            {
+                out += '[';
+                appendJsonNumbers(out, values, count);
+                out += ']';
+            }
+
+        } // namespace ResponseWriter
+    } // namespace API
+} // namespace OptionPricer
@@ -1,18 +1,157 @@
 #include "api/RestServer.h"
+#include "concurrency/Scheduler.h"
+#include "metrics/Metrics.h"
+#include <httplib.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
 namespace OptionPricer
 {
     namespace API
     {
 
+        namespace
+        {
+            // Runs a route body; exceptions become the standard error response
+            template <class Body>
+            void guarded(httplib::Response &res, Body &&body)
+            {
+                try
+                {
+                    body();
+                }
+                catch (const std::out_of_range &e)
+                {
+                    RestServer::sendError(res, e.what(), 404);
+                }
+                catch (const std::exception &e)
+                {
+                    RestServer::sendError(res, e.what());
+                }
+            }
+
+            json queryParams(const httplib::Request &req)
+            {
+                json params = json::object();
+                for (const auto &param : req.params)
+                    params[param.first] = param.second;
+                return params;
+            }
+
+            RestServer::Config withPort(int port)
+            {
+                RestServer::Config config;
+                config.port = port;
+                return config;
+            }
+
+            const char *const InvalidDeadline = "deadline_ms must be a non-negative number of milliseconds";
+
+            /**
+             * Validates deadlineMs even without a token to shorten. A budget
+             * can only shorten the server's, so it is clamped to ceilingMs
+             * (Config::requestTimeoutMs; 0 is none) and to the clock's range
+             * before it becomes an integer.
+             */
+            void limitBy(CancellationToken *token, double deadlineMs, int ceilingMs = 0)
+            {
+                if (!(deadlineMs >= 0.0))
+                    throw std::invalid_argument(InvalidDeadline);
+                if (ceilingMs > 0)
+                    deadlineMs = std::min(deadlineMs, static_cast<double>(ceilingMs));
+                const double longest = static_cast<double>(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(CancellationToken::Clock::duration::max()).count());
+                if (token)
+                    token->limit(std::chrono::milliseconds(static_cast<long long>(std::ceil(std::min(deadlineMs, longest)))));
+            }
+
+            // A deadline_ms query value; one that is not a number is a 400 (std::stod's out_of_range would be a 404)
+            double parseDeadline(const std::string &text)
+            {
+                char *end = nullptr;
+                const double value = std::strtod(text.c_str(), &end);
+                if (text.empty() || end != text.c_str() + text.size())
+                    throw std::invalid_argument(InvalidDeadline);
+                return value;
+            }
+
+            // JSON in, JSON out: see registerEndpoint; async routes take a body deadline_ms up to timeoutMs
+            RouteHandler endpointRoute(RequestHandler handler, bool async, int timeoutMs = 0)
+            {
+                return [handler, async, timeoutMs](const httplib::Request &req, httplib::Response &res)
+                {
+                    const bool hasBody = req.method == "POST" || req.method == "PATCH" || req.method == "PUT";
+                    const json request = hasBody ? json::parse(req.body) : queryParams(req);
+                    if (async && hasBody && request.is_object() && request.contains("deadline_ms"))
+                        limitBy(CancellationToken::current(), request["deadline_ms"].get<double>(), timeoutMs);
+                    Metrics::RequestTimer::enter(Metrics::Phase::Price);
+                    const json response = handler(request);
+                    RestServer::sendJson(res, response, response.contains("error") ? 400 : 200);
+                };
+            }
+
+            // One async request, shared by the HTTP worker and the task running its handler
+            struct AsyncCall
+            {
+                httplib::Request request;
+                httplib::Response response;
+                CancellationToken token;
+                Metrics::RequestTimer::Phases phases; // of the handler, on the worker
+                std::mutex mutex;
+                std::condition_variable finished;
+                bool done = false;
+            };
+        } // namespace
+
         RestServer::RestServer(int port)
-            : port_(port), running_(false)
+            : RestServer(withPort(port))
         {
         }
 
+        RestServer::RestServer(const Config &config)
+            : config_(config), server_(std::make_unique<httplib::Server>())
+        {
+            // Same default as cpp-httplib's own pool
+            const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+            const std::size_t workers = config_.workers ? config_.workers : std::max<std::size_t>(8, cores - 1);
+            workerCount_ = workers;
+            const std::size_t maxQueued = config_.maxQueued;
+            server_->new_task_queue = [workers, maxQueued]
+            { return new httplib::ThreadPool(workers, maxQueued); };
+
+            server_->set_keep_alive_max_count(std::max<std::size_t>(1, config_.keepAliveRequests));
+            server_->set_keep_alive_timeout(config_.keepAliveTimeoutSec);
+            server_->set_payload_max_length(config_.maxRequestBytes);
+            server_->set_read_timeout(config_.readTimeoutSec, 0);
+            server_->set_write_timeout(config_.writeTimeoutSec, 0);
+            // Headers and chunked bodies go out in several writes; with Nagle on,
+            // each response after the first can wait ~40 ms on the client's delayed ACK
+            server_->set_tcp_nodelay(true);
+
+            // CORS on every response, including the server's own 404 / 413
+            server_->set_default_headers({{"Access-Control-Allow-Origin", "*"},
+                                          {"Access-Control-Allow-Methods", "GET, POST, PATCH, DELETE, OPTIONS"},
+                                          {"Access-Control-Allow-Headers", "Content-Type, Accept"}});
+            server_->Options(R"(/.*)", [](const httplib::Request & /*req*/, httplib::Response &res)
+                             { res.status = 200; });
+
+            // Errors raised by the server itself get the same JSON body as route errors
+            server_->set_error_handler([](const httplib::Request & /*req*/, httplib::Response &res)
+                                       {
+                if (res.body.empty())
+                    sendError(res, httplib::status_message(res.status), res.status); });
+        }
+
         RestServer::~RestServer()
         {
-            if (running_)
+            if (isRunning())
             {
                 stop();
             }
@@ -22,28 +161,197 @@ namespace OptionPricer
                                           const std::string &method,
                                           RequestHandler handler)
         {
-            routes_[endpoint][method] = handler;
+            registerRoute(method, endpoint, endpointRoute(std::move(handler), false));
+        }
+
+        void RestServer::registerAsyncEndpoint(const std::string &endpoint,
+                                               const std::string &method,
+                                               RequestHandler handler)
+        {
+            registerAsyncRoute(method, endpoint, endpointRoute(std::move(handler), true, config_.requestTimeoutMs));
+        }
+
+        void RestServer::registerRoute(const std::string &method, const std::string &pattern, RouteHandler handler)
+        {
+            // Timed per route pattern; the handler marks its own phases, see Metrics::RequestTimer
+            const std::size_t endpoint = Metrics::endpoint(method, pattern);
+            auto route = [handler, endpoint](const httplib::Request &req, httplib::Response &res)
+            {
+                Metrics::RequestTimer timer(endpoint);
+                guarded(res, [&]
+                        { handler(req, res); });
+                if (res.status >= 400)
+                    timer.fail();
+            };
+
+            if (method == "GET")
+                server_->Get(pattern, route);
+            else if (method == "POST")
+                server_->Post(pattern, route);
+            else if (method == "PATCH")
+                server_->Patch(pattern, route);
+            else if (method == "PUT")
+                server_->Put(pattern, route);
+            else if (method == "DELETE")
+                server_->Delete(pattern, route);
+            else
+                throw std::invalid_argument("Unsupported HTTP method: " + method);
+        }
+
+        void RestServer::registerAsyncRoute(const std::string &method, const std::string &pattern,
+                                            RouteHandler handler)
+        {
+            const int timeoutMs = config_.requestTimeoutMs;
+            const std::chrono::milliseconds timeout(timeoutMs);
+            const std::chrono::milliseconds grace(std::max(0, config_.cancelGraceMs));
+            const std::chrono::milliseconds poll(std::max(1, config_.disconnectPollMs));
+            registerRoute(method, pattern, [handler, timeoutMs, timeout, grace, poll](const httplib::Request &req, httplib::Response &res)
+                          {
+                auto call = std::make_shared<AsyncCall>();
+                call->token.limit(timeout);
+                if (req.has_param("deadline_ms"))
+                    limitBy(&call->token, parseDeadline(req.get_param_value("deadline_ms")), timeoutMs);
+                call->request = req;
+                call->request.matches = std::smatch(); // they point into req
+                call->response = res;                   // carries the default headers
+
+                Metrics::RequestTimer::enter(Metrics::Phase::Price);
+                Scheduler::shared().post([call, handler]
+                                         {
+                    Metrics::RequestTimer::Phases phases;
+                    {
+                        // The handler marks its phases on this thread; the HTTP thread joins them
+                        Metrics::RequestTimer part;
+                        CancellationToken::Scope scope(&call->token);
+                        guarded(call->response, [&]
+                                { handler(call->request, call->response); });
+                        phases = part.phases();
+                    }
+                    std::lock_guard<std::mutex> lock(call->mutex);
+                    call->phases = phases;
+                    call->done = true;
+                    call->finished.notify_all(); });
+
+                std::unique_lock<std::mutex> lock(call->mutex);
+                while (!call->finished.wait_for(lock, poll, [&]
+                                                { return call->done; }))
+                {
+                    if (req.is_connection_closed())
+                    {
+                        // Nobody will read the answer; the handler stops at its next checkpoint
+                        call->token.cancel(CancellationToken::Reason::Disconnected);
+                        Metrics::recordDisconnect();
+                        sendError(res, "Client disconnected", 499);
+                        return;
+                    }
+                    if (call->token.cancelled())
+                    {
+                        call->finished.wait_for(lock, grace, [&]
+                                                { return call->done; });
+                        break;
+                    }
+                }
+
+                if (call->done)
+                    Metrics::RequestTimer::join(call->phases);
+
+                // Read without the clock: a handler that finished in time was not cancelled
+                const bool cancelled = call->token.reason() != CancellationToken::Reason::None;
+                if (cancelled)
+                    Metrics::recordDeadlineExceeded();
+                if (!call->done || (cancelled && call->response.status >= 400))
+                {
+                    sendError(res, call->token.message(), 504);
+                    return;
+                }
+                res = std::move(call->response); });
+        }
+
+        void RestServer::applyDeadline(double deadlineMs)
+        {
+            limitBy(CancellationToken::current(), deadlineMs);
         }
 
         void RestServer::start()
         {
-            running_ = true;
-            // TODO: Implement HTTP server using cpp-httplib or Crow framework
-            // Example structure:
-            // 1. Set up httplib::Server or crow::SimpleApp
-            // 2. For each registered route, bind handler
-            // 3. Listen on port_
-            // 4. Call listen() in blocking mode
+            int port = config_.port;
+            if (port == 0)
+                port = server_->bind_to_any_port(config_.host);
+            else if (!server_->bind_to_port(config_.host, port))
+                port = -1;
+            if (port < 0)
+                throw std::runtime_error("Could not listen on " + config_.host + ":" + std::to_string(config_.port));
+
+            boundPort_ = port;
+            server_->listen_after_bind();
         }
 
         void RestServer::stop()
         {
-            running_ = false;
+            // cpp-httplib closes the listening socket, lets each worker finish
+            // its current request, and joins the pool before listen returns
+            server_->stop();
         }
 
         bool RestServer::isRunning() const
         {
-            return running_;
+            return server_->is_running();
+        }
+
+        void RestServer::waitUntilReady() const
+        {
+            server_->wait_until_ready();
+        }
+
+        void RestServer::sendJson(httplib::Response &res, const json &body, int status)
+        {
+            Metrics::RequestTimer::enter(Metrics::Phase::Serialize);
+            // Compact JSON; indentation only costs bytes and serialisation time
+            res.set_content(body.dump(), "application/json");
+            res.status = status;
+        }
+
+        void RestServer::sendError(httplib::Response &res, const std::string &message, int status)
+        {
+            json errorRes;
+            errorRes["error"] = message;
+            errorRes["status"] = "error";
+            sendJson(res, errorRes, status);
+        }
+
+        void RestServer::sendColumnar(const httplib::Request &req, httplib::Response &res,
+                                      ColumnarResponse body, bool streamed)
+        {
+            Metrics::RequestTimer::enter(Metrics::Phase::Serialize);
+            ResponseWriter::Format format = ResponseWriter::negotiate(req.get_header_value("Accept"));
+            res.set_header("Vary", "Accept");
+            res.status = 200;
+            if (!streamed)
+            {
+                res.set_content(ResponseWriter::write(body, format), ResponseWriter::contentType(format));
+                return;
+            }
+
+            auto shared = std::make_shared<ColumnarResponse>(std::move(body));
+            res.set_chunked_content_provider(
+                ResponseWriter::contentType(format),
+                [shared, format](size_t /*offset*/, httplib::DataSink &sink)
+                {
+                    bool complete = false;
+                    try
+                    {
+                        complete = ResponseWriter::write(*shared, format, [&sink](const char *data, size_t size)
+                                                         { return sink.write(data, size); });
+                    }
+                    catch (const std::exception &e)
+                    {
+                        // Headers are already sent; dropping the connection is the only signal left
+                        std::cerr << "Streaming response failed: " << e.what() << std::endl;
+                    }
+                    if (complete)
+                        sink.done();
+                    return complete;
+                });
         }
 
     } // namespace API
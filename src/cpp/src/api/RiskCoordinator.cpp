@@ -0,0 +1,495 @@
+#include "api/RiskCoordinator.h"
+#include "api/BinaryClient.h"
+#include "api/BinaryProtocol.h"
+#include "api/PricingEndpoint.h"
+#include "concurrency/Cancellation.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        namespace
+        {
+            using Clock = std::chrono::steady_clock;
+
+            // How often run() looks at the caller's CancellationToken while the workers run
+            constexpr std::chrono::milliseconds CancellationPoll(10);
+
+            // Shared by the worker threads of one job; guarded by mutex except finished
+            struct JobState
+            {
+                std::mutex mutex;
+                std::condition_variable changed;
+                std::atomic<bool> finished{false}; // also abandons calls still in flight
+
+                std::deque<std::size_t> queue;                // partitions nobody is running
+                std::vector<MonteCarloRisk::Partial> partials; // by partition
+                std::vector<bool> done;
+                std::vector<std::size_t> attempts;
+                std::vector<std::vector<std::size_t>> runners; // workers running each partition
+                std::vector<Clock::time_point> lastStart;
+                std::vector<double> durations; // seconds of every answered partition
+                std::size_t remaining = 0;
+                std::size_t alive = 0;
+                std::size_t reissued = 0;
+                std::string error;
+                bool rejected = false; // error is a worker's answer to invalid input
+            };
+
+            // One partition as sent, and the answer expected back
+            struct Partition
+            {
+                std::string payload;
+                std::size_t begin;
+                std::size_t end;
+            };
+
+            double median(std::vector<double> values)
+            {
+                if (values.empty())
+                    return 0.0;
+                const auto middle = values.begin() + values.size() / 2;
+                std::nth_element(values.begin(), middle, values.end());
+                return *middle;
+            }
+
+            /**
+             * Next partition for worker `me`: the front of the queue, else the
+             * longest-running straggler it may re-run. Without either, wakeAt
+             * is when the first candidate becomes a straggler (or max()).
+             */
+            std::optional<std::size_t> nextPartition(JobState &state, std::size_t me,
+                                                     const RiskCoordinator::Config &config, Clock::time_point &wakeAt)
+            {
+                wakeAt = Clock::time_point::max();
+                while (!state.queue.empty())
+                {
+                    const std::size_t i = state.queue.front();
+                    state.queue.pop_front();
+                    if (!state.done[i])
+                        return i;
+                }
+
+                const auto delay = std::max<Clock::duration>(
+                    config.minStragglerDelay, std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+                                                  config.stragglerFactor * median(state.durations))));
+                const Clock::time_point now = Clock::now();
+                std::optional<std::size_t> oldest;
+                for (std::size_t i = 0; i < state.done.size(); ++i)
+                {
+                    const auto &runners = state.runners[i];
+                    if (state.done[i] || runners.empty() || state.attempts[i] >= config.maxAttempts ||
+                        std::find(runners.begin(), runners.end(), me) != runners.end())
+                        continue;
+                    const Clock::time_point due = state.lastStart[i] + delay;
+                    if (due > now)
+                        wakeAt = std::min(wakeAt, due);
+                    else if (!oldest || state.lastStart[i] < state.lastStart[*oldest])
+                        oldest = i;
+                }
+                return oldest;
+            }
+
+            // One worker's thread: pull partitions until the job finishes or the worker fails
+            void serveWorker(JobState &state, const std::vector<Partition> &partitions,
+                             const RiskCoordinator::Config &config, std::size_t me,
+                             RiskCoordinator::WorkerReport &report)
+            {
+                BinaryClient client(report.address);
+                std::string failure;
+                try
+                {
+                    client.connect(Clock::now() + config.connectTimeout);
+                }
+                catch (const std::exception &e)
+                {
+                    failure = e.what();
+                }
+
+                std::unique_lock<std::mutex> lock(state.mutex);
+                while (failure.empty() && !state.finished)
+                {
+                    Clock::time_point wakeAt;
+                    const std::optional<std::size_t> next = nextPartition(state, me, config, wakeAt);
+                    if (!next)
+                    {
+                        if (wakeAt == Clock::time_point::max())
+                            state.changed.wait(lock);
+                        else
+                            state.changed.wait_until(lock, wakeAt);
+                        continue;
+                    }
+                    const std::size_t i = *next;
+                    if (!state.runners[i].empty())
+                        ++state.reissued;
+                    ++state.attempts[i];
+                    state.runners[i].push_back(me);
+                    const Clock::time_point started = state.lastStart[i] = Clock::now();
+                    lock.unlock();
+
+                    MonteCarloRisk::Partial partial;
+                    std::string rejection;
+                    try
+                    {
+                        const BinaryClient::Response response =
+                            client.call(BinaryProtocol::Opcode::RiskPartition, partitions[i].payload,
+                                        started + config.partitionTimeout, &state.finished);
+                        if (response.status == BinaryProtocol::Status::Error)
+                        {
+                            rejection = report.address + ": " + response.payload;
+                        }
+                        else
+                        {
+                            partial = BinaryProtocol::decodeRiskPartial(response.payload);
+                            if (partial.begin != partitions[i].begin || partial.end != partitions[i].end)
+                                throw std::runtime_error("answer covers the wrong paths");
+                        }
+                    }
+                    catch (const std::exception &e)
+                    {
+                        failure = e.what();
+                    }
+                    const double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+
+                    lock.lock();
+                    report.seconds += seconds;
+                    auto &runners = state.runners[i];
+                    runners.erase(std::find(runners.begin(), runners.end(), me));
+                    if (!failure.empty())
+                    {
+                        // Hand the partition back unless another worker is still on it
+                        if (!state.done[i] && runners.empty())
+                            state.queue.push_front(i);
+                        break;
+                    }
+                    if (state.done[i])
+                        continue; // a straggler's duplicate lost the race
+                    if (!rejection.empty())
+                    {
+                        if (!state.finished)
+                        {
+                            state.error = rejection;
+                            state.rejected = true;
+                            state.finished = true;
+                        }
+                        state.changed.notify_all();
+                        break;
+                    }
+                    state.done[i] = true;
+                    state.partials[i] = std::move(partial);
+                    state.durations.push_back(seconds);
+                    ++report.partitions;
+                    if (--state.remaining == 0)
+                        state.finished = true;
+                    state.changed.notify_all();
+                }
+
+                // Calls abandoned once the job was over are not failures of the worker
+                if (!failure.empty() && !state.finished)
+                {
+                    report.error = failure;
+                    if (--state.alive == 0)
+                    {
+                        state.error = "every worker failed; last: " + report.address + ": " + failure;
+                        state.finished = true;
+                    }
+                    state.changed.notify_all();
+                }
+            }
+
+            RiskCoordinator::Partitioning parsePartitioning(const std::string &name)
+            {
+                if (name == "scenarios")
+                    return RiskCoordinator::Partitioning::Scenarios;
+                if (name == "positions")
+                    return RiskCoordinator::Partitioning::Positions;
+                throw std::invalid_argument("Invalid partition: " + name + " (expected \"scenarios\" or \"positions\")");
+            }
+
+            json pingWorkers(const std::vector<std::string> &addresses, std::chrono::milliseconds timeout)
+            {
+                json workers = json::array();
+                for (const std::string &address : addresses)
+                {
+                    json worker;
+                    worker["address"] = address;
+                    try
+                    {
+                        BinaryClient client(address);
+                        const Clock::time_point started = Clock::now();
+                        const BinaryClient::Response response =
+                            client.call(BinaryProtocol::Opcode::Ping, {}, started + timeout);
+                        worker["reachable"] = response.status == BinaryProtocol::Status::Ok;
+                        worker["latency_ms"] =
+                            std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+                    }
+                    catch (const std::exception &e)
+                    {
+                        worker["reachable"] = false;
+                        worker["error"] = e.what();
+                    }
+                    workers.push_back(worker);
+                }
+                return workers;
+            }
+        } // namespace
+
+        RiskCoordinator::RiskCoordinator() : RiskCoordinator(Config())
+        {
+        }
+
+        RiskCoordinator::RiskCoordinator(const Config &config) : config_(config)
+        {
+            if (config.partitionsPerWorker < 1 || config.maxAttempts < 1 || !(config.stragglerFactor >= 1.0))
+                throw std::invalid_argument("coordinator needs partitionsPerWorker and maxAttempts of at least 1 "
+                                            "and a straggler factor of at least 1");
+        }
+
+        RiskCoordinator &RiskCoordinator::shared()
+        {
+            static RiskCoordinator coordinator;
+            return coordinator;
+        }
+
+        void RiskCoordinator::addWorker(const std::string &address)
+        {
+            if (address.rfind("unix:", 0) != 0 && address.find(':') == std::string::npos)
+                throw std::invalid_argument("worker address must be host:port or unix:/path: " + address);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (std::find(workers_.begin(), workers_.end(), address) == workers_.end())
+                workers_.push_back(address);
+        }
+
+        bool RiskCoordinator::removeWorker(const std::string &address)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto found = std::find(workers_.begin(), workers_.end(), address);
+            if (found == workers_.end())
+                return false;
+            workers_.erase(found);
+            return true;
+        }
+
+        std::vector<std::string> RiskCoordinator::workers() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return workers_;
+        }
+
+        RiskCoordinator::Report RiskCoordinator::run(const Job &job) const
+        {
+            const std::vector<std::string> addresses = workers();
+            if (addresses.empty())
+                throw std::runtime_error("no worker nodes are registered");
+
+            // Validate everything a worker would reject before any work is sent
+            const std::size_t paths = MonteCarloRisk::pathCount(job.spec);
+            MonteCarloRisk::summarize(std::vector<double>{0.0}, 0.0, 0, job.confidences);
+            const bool byPositions = job.partitioning == Partitioning::Positions;
+            if (byPositions && job.summarise)
+                throw std::invalid_argument("positions partitions return raw P&L: their digests cannot be summed");
+            if (byPositions && job.positions.empty())
+                throw std::invalid_argument("positions partitioning needs at least one position");
+            if (job.summarise)
+                static_cast<void>(TDigest(job.compression));
+
+            // Contiguous partitions: path ranges, or groups of positions over every path
+            const std::size_t units = byPositions ? job.positions.size() : paths;
+            std::size_t count = std::min(units, addresses.size() * config_.partitionsPerWorker);
+            if (!byPositions)
+                count = std::min(count, (paths + config_.minPartitionPaths - 1) / config_.minPartitionPaths);
+            count = std::max<std::size_t>(count, 1);
+            std::vector<Partition> partitions;
+            for (std::size_t k = 0; k < count; ++k)
+            {
+                BinaryProtocol::RiskTask task;
+                task.spec = job.spec;
+                task.summarise = job.summarise;
+                task.compression = job.compression;
+                const std::size_t first = units * k / count, last = units * (k + 1) / count;
+                if (byPositions)
+                {
+                    task.positions.assign(job.positions.begin() + first, job.positions.begin() + last);
+                    task.begin = 0;
+                    task.end = paths;
+                }
+                else
+                {
+                    task.positions = job.positions;
+                    task.begin = first;
+                    task.end = last;
+                }
+                partitions.push_back({BinaryProtocol::encodeRiskTask(task), task.begin, task.end});
+            }
+
+            JobState state;
+            for (std::size_t k = 0; k < count; ++k)
+                state.queue.push_back(k);
+            state.partials.resize(count);
+            state.done.assign(count, false);
+            state.attempts.assign(count, 0);
+            state.runners.resize(count);
+            state.lastStart.resize(count);
+            state.remaining = count;
+            state.alive = addresses.size();
+
+            Report report;
+            report.partitions = count;
+            report.approximate = job.summarise;
+            report.workers.resize(addresses.size());
+            std::vector<std::thread> threads;
+            for (std::size_t w = 0; w < addresses.size(); ++w)
+            {
+                report.workers[w].address = addresses[w];
+                threads.emplace_back(serveWorker, std::ref(state), std::cref(partitions), std::cref(config_), w,
+                                     std::ref(report.workers[w]));
+            }
+            // The caller's token is not current on the worker threads: watch it
+            // here, and abandon the job (and the calls in flight) once it fires
+            bool abandoned = false;
+            if (CancellationToken *token = CancellationToken::current())
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                while (!state.finished)
+                {
+                    if (token->cancelled())
+                    {
+                        abandoned = true;
+                        state.finished = true;
+                        state.changed.notify_all();
+                        break;
+                    }
+                    state.changed.wait_for(lock, CancellationPoll);
+                }
+            }
+            for (std::thread &thread : threads)
+                thread.join();
+            if (abandoned)
+                CancellationToken::checkpoint();
+
+            if (!state.error.empty())
+            {
+                if (state.rejected)
+                    throw std::invalid_argument(state.error);
+                throw std::runtime_error(state.error);
+            }
+            report.reissued = state.reissued;
+
+            // Merge in partition order, so a job gives the same numbers whichever worker ran what
+            std::vector<MonteCarloRisk::Partial> &partials = state.partials;
+            if (job.summarise)
+            {
+                MonteCarloRisk::Summary summary(job.compression);
+                for (const MonteCarloRisk::Partial &partial : partials)
+                    summary.merge(partial.summary);
+                report.result = MonteCarloRisk::summarize(summary, partials.front().baseValue,
+                                                          partials.front().fullyRevaluedLegs, job.confidences);
+            }
+            else if (byPositions)
+            {
+                std::vector<double> pnl = std::move(partials.front().pnl);
+                double baseValue = partials.front().baseValue;
+                std::size_t fullyRevaluedLegs = partials.front().fullyRevaluedLegs;
+                for (std::size_t k = 1; k < count; ++k)
+                {
+                    for (std::size_t i = 0; i < paths; ++i)
+                        pnl[i] += partials[k].pnl[i];
+                    baseValue += partials[k].baseValue;
+                    fullyRevaluedLegs += partials[k].fullyRevaluedLegs;
+                }
+                report.result = MonteCarloRisk::summarize(pnl, baseValue, fullyRevaluedLegs, job.confidences);
+            }
+            else
+            {
+                std::vector<double> pnl;
+                pnl.reserve(paths);
+                for (const MonteCarloRisk::Partial &partial : partials)
+                    pnl.insert(pnl.end(), partial.pnl.begin(), partial.pnl.end());
+                report.result = MonteCarloRisk::summarize(pnl, partials.front().baseValue,
+                                                          partials.front().fullyRevaluedLegs, job.confidences);
+            }
+            return report;
+        }
+
+        json RiskCoordinator::handleRiskRequest(const json &request)
+        {
+            try
+            {
+                const PricingEndpoint::RiskRequest parsed = PricingEndpoint::parseRiskRequest(request);
+                Job job;
+                job.positions = parsed.positions;
+                job.spec = parsed.spec;
+                job.confidences = parsed.confidences;
+                job.partitioning = parsePartitioning(request.value("partition", "scenarios"));
+                const std::string summary = request.value("summary", "pnl");
+                if (summary != "pnl" && summary != "tdigest")
+                    throw std::invalid_argument("Invalid summary: " + summary + " (expected \"pnl\" or \"tdigest\")");
+                job.summarise = summary == "tdigest";
+                job.compression = request.value("compression", job.compression);
+
+                const Report report = shared().run(job);
+                json response = PricingEndpoint::riskResponse(parsed, report.result);
+                json workers = json::array();
+                for (const WorkerReport &worker : report.workers)
+                {
+                    json entry = {{"address", worker.address},
+                                  {"partitions", worker.partitions},
+                                  {"seconds", worker.seconds}};
+                    if (!worker.error.empty())
+                        entry["error"] = worker.error;
+                    workers.push_back(entry);
+                }
+                json &distributed = response["risk"]["distributed"];
+                distributed["partition"] = request.value("partition", "scenarios");
+                distributed["summary"] = summary;
+                distributed["partitions"] = report.partitions;
+                distributed["reissued"] = report.reissued;
+                distributed["approximate"] = report.approximate;
+                distributed["workers"] = workers;
+                return response;
+            }
+            catch (const std::exception &e)
+            {
+                json errorResponse;
+                errorResponse["error"] = e.what();
+                errorResponse["status"] = "error";
+                return errorResponse;
+            }
+        }
+
+        json RiskCoordinator::handleWorkersRequest()
+        {
+            json response;
+            response["workers"] = pingWorkers(shared().workers(), shared().config().connectTimeout);
+            response["status"] = "success";
+            return response;
+        }
+
+        json RiskCoordinator::handleAddWorkerRequest(const json &request)
+        {
+            try
+            {
+                if (!request.contains("address") || !request["address"].is_string())
+                    throw std::invalid_argument("Missing required parameter: address");
+                shared().addWorker(request["address"].get<std::string>());
+                return handleWorkersRequest();
+            }
+            catch (const std::exception &e)
+            {
+                json errorResponse;
+                errorResponse["error"] = e.what();
+                errorResponse["status"] = "error";
+                return errorResponse;
+            }
+        }
+
+    } // namespace API
+} // namespace OptionPricer
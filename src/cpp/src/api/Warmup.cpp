@@ -0,0 +1,305 @@
+#include "api/Warmup.h"
+#include "api/PortfolioSession.h"
+#include "api/RequestArena.h"
+#include "concurrency/Scheduler.h"
+#include "market/MarketData.h"
+#include "metrics/Metrics.h"
+#include "models/BlackScholes.h"
+#include "models/NormalDistribution.h"
+#include "options/GreeksCache.h"
+#include <httplib.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+namespace OptionPricer
+{
+    namespace API
+    {
+
+        namespace
+        {
+            using Clock = std::chrono::steady_clock;
+
+            // Latencies of one round, in milliseconds, and the requests that failed
+            struct Round
+            {
+                std::vector<double> latencies;
+                std::size_t failures = 0;
+            };
+
+            std::string loopback(const std::string &host)
+            {
+                if (host.empty() || host == "0.0.0.0")
+                    return "127.0.0.1";
+                if (host == "::")
+                    return "::1";
+                return host;
+            }
+
+            // Nearest-rank quantile of an unsorted sample
+            double quantile(std::vector<double> values, double q)
+            {
+                if (values.empty())
+                    return 0.0;
+                const std::size_t rank = static_cast<std::size_t>(std::ceil(q * values.size()));
+                const std::size_t index = std::min(values.size() - 1, rank > 0 ? rank - 1 : 0);
+                std::nth_element(values.begin(), values.begin() + index, values.end());
+                return values[index];
+            }
+
+            // Every request once per client, the clients running at once; client
+            // c starts c requests in, so heavy requests do not all coincide
+            Round replay(std::vector<httplib::Client> &clients, const std::vector<Warmup::Request> &requests)
+            {
+                std::vector<Round> rounds(clients.size());
+                std::vector<std::thread> threads;
+                threads.reserve(clients.size());
+                for (std::size_t c = 0; c < clients.size(); ++c)
+                {
+                    threads.emplace_back([&, c]
+                                         {
+                        for (std::size_t k = 0; k < requests.size(); ++k)
+                        {
+                            const Warmup::Request &request = requests[(c + k) % requests.size()];
+                            const auto start = Clock::now();
+                            auto result = request.method == "GET"
+                                              ? clients[c].Get(request.path)
+                                              : clients[c].Post(request.path, request.body, "application/json");
+                            const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+                            if (result && result->status >= 200 && result->status < 300)
+                                rounds[c].latencies.push_back(elapsed.count());
+                            else
+                                ++rounds[c].failures;
+                        } });
+                }
+                Round merged;
+                for (std::size_t c = 0; c < threads.size(); ++c)
+                {
+                    threads[c].join();
+                    merged.latencies.insert(merged.latencies.end(), rounds[c].latencies.begin(), rounds[c].latencies.end());
+                    merged.failures += rounds[c].failures;
+                }
+                return merged;
+            }
+
+            Warmup::Request post(const std::string &path, const json &body)
+            {
+                return {"POST", path, body.dump()};
+            }
+        } // namespace
+
+        Warmup::Warmup(const Config &config)
+            : config_(config)
+        {
+        }
+
+        std::size_t Warmup::prepare()
+        {
+            Scheduler &scheduler = Scheduler::shared();
+            if (config_.pinThreads)
+                pinned_ = scheduler.pinWorkers();
+            // Arena buffers are faulted in now, on the threads that will use them
+            scheduler.runOnEachThread([]
+                                      { RequestArena::prepare(); });
+            Normal::prepareTable();
+            BlackScholes::batchInstructionSet();
+            GreeksCache::shared();
+            SessionStore::shared();
+            MarketDataStore::shared().snapshot();
+            return pinned_;
+        }
+
+        Warmup::Report Warmup::run(const std::string &host, int port, const std::vector<Request> &requests)
+        {
+            const auto started = Clock::now();
+            Report report;
+            report.pinned = pinned_;
+
+            if (config_.maxRounds > 0 && !requests.empty())
+            {
+                // Every round must reach the engines, not the previous round's cache entries
+                GreeksCache::shared().setBypass(true);
+                std::vector<httplib::Client> clients;
+                clients.reserve(std::max<std::size_t>(1, config_.connections));
+                for (std::size_t c = 0; c < std::max<std::size_t>(1, config_.connections); ++c)
+                {
+                    clients.emplace_back(loopback(host), port);
+                    clients.back().set_keep_alive(true);
+                    clients.back().set_read_timeout(config_.budget);
+                }
+
+                double previous = 0.0;
+                int stable = 0;
+                while (report.rounds < config_.maxRounds)
+                {
+                    const Round round = replay(clients, requests);
+                    ++report.rounds;
+                    report.requests += round.latencies.size() + round.failures;
+                    report.failures += round.failures;
+                    const double p99 = quantile(round.latencies, 0.99);
+                    // A round with nothing answered proves nothing either way
+                    const bool steady = !round.latencies.empty() && report.rounds > 1 &&
+                                        std::fabs(p99 - previous) <= config_.tolerance * previous;
+                    stable = steady ? stable + 1 : 0;
+                    previous = p99;
+                    report.p99Ms = p99;
+                    if (report.rounds >= config_.minRounds && stable >= config_.stableRounds)
+                    {
+                        report.settled = true;
+                        break;
+                    }
+                    if (Clock::now() - started >= config_.budget)
+                        break;
+                }
+                GreeksCache::shared().setBypass(false);
+            }
+            else
+            {
+                report.settled = true; // nothing to wait for
+            }
+
+            report.seconds = std::chrono::duration<double>(Clock::now() - started).count();
+            // Live traffic starts from an empty cache and metrics without the warm-up's requests
+            GreeksCache::shared().clear();
+            Metrics::reset();
+            {
+                std::lock_guard<std::mutex> lock(reportMutex_);
+                report_ = report;
+            }
+            ready_.store(true, std::memory_order_release);
+            return report;
+        }
+
+        json Warmup::status() const
+        {
+            if (!ready())
+                return json{{"status", "warming"}};
+            std::lock_guard<std::mutex> lock(reportMutex_);
+            json response;
+            response["status"] = "ready";
+            response["warmup"] = {{"rounds", report_.rounds},
+                                  {"settled", report_.settled},
+                                  {"p99_ms", report_.p99Ms},
+                                  {"requests", report_.requests},
+                                  {"failures", report_.failures},
+                                  {"pinned_threads", report_.pinned},
+                                  {"seconds", report_.seconds}};
+            return response;
+        }
+
+        std::vector<Warmup::Request> Warmup::defaultRequests()
+        {
+            const json option = {{"type", "put"}, {"spot", 100.0}, {"strike", 100.0}, {"rate", 0.05},
+                                 {"volatility", 0.2}, {"time", 1.0}};
+            std::vector<Request> requests;
+
+            // Every engine behind /api/price, each normal-CDF accuracy on the closed form
+            for (const char *accuracy : {"exact", "fast", "table"})
+            {
+                json body = option;
+                body["accuracy"] = accuracy;
+                requests.push_back(post("/api/price", body));
+            }
+            for (const char *model : {"american", "american_lr", "american_bbsr", "american_trinomial",
+                                      "american_baw", "american_bjs", "american_fd"})
+            {
+                json body = option;
+                body["model"] = model;
+                body["steps"] = 200;
+                requests.push_back(post("/api/price", body));
+            }
+
+            json batch = json::array();
+            for (int i = 0; i < 64; ++i)
+            {
+                json entry = option;
+                entry["type"] = i % 2 ? "call" : "put";
+                entry["strike"] = 80.0 + i * 0.625;
+                if (i % 8 == 0)
+                    entry["model"] = "american";
+                batch.push_back(entry);
+            }
+            requests.push_back(post("/api/price/batch", batch));
+
+            requests.push_back(post("/api/strategy/price", {{"strategy", "straddle"}, {"spot", 100.0}, {"strike", 100.0},
+                                                            {"is_long", true}, {"rate", 0.05}, {"volatility", 0.2},
+                                                            {"time", 1.0}}));
+
+            const json legs = json::array(
+                {{{"type", "european"}, {"optionType", "call"}, {"strike", 105.0}, {"volatility", 0.2}, {"time", 0.5}, {"quantity", -1}},
+                 {{"type", "american"}, {"optionType", "put"}, {"strike", 95.0}, {"volatility", 0.22}, {"time", 0.5}, {"quantity", 1}},
+                 {{"type", "european"}, {"optionType", "put"}, {"strike", 90.0}, {"volatility", 0.25}, {"time", 1.0}, {"quantity", 2}}});
+            requests.push_back(post("/api/portfolio/price", {{"spot", 100.0}, {"rate", 0.05}, {"legs", legs}, {"payoff_steps", 100}}));
+            for (const char *revaluation : {"full", "taylor"})
+                requests.push_back(post("/api/portfolio/risk", {{"spot", 100.0}, {"rate", 0.05}, {"legs", legs}, {"horizon", 0.04},
+                                                                {"paths", 4096}, {"sampling", "sobol"}, {"revaluation", revaluation}}));
+
+            json strikes = json::array();
+            json prices = json::array();
+            for (int i = 0; i < 41; ++i)
+            {
+                const double strike = 80.0 + i;
+                strikes.push_back(strike);
+                prices.push_back(BlackScholes::callPrice(100.0, strike, 0.05, 0.2, 1.0));
+            }
+            requests.push_back(post("/api/chain/price", {{"type", "call"}, {"spot", 100.0}, {"rate", 0.05}, {"volatility", 0.2},
+                                                         {"time", 1.0}, {"strikes", strikes}}));
+            requests.push_back(post("/api/chain/price", {{"type", "put"}, {"model", "american_fd"}, {"spot", 100.0}, {"rate", 0.05},
+                                                         {"volatility", 0.2}, {"time", 1.0}, {"strikes", strikes}}));
+            requests.push_back(post("/api/implied_vol/batch", {{"type", "call"}, {"spot", 100.0}, {"rate", 0.05}, {"time", 1.0},
+                                                               {"strikes", strikes}, {"prices", prices}}));
+
+            requests.push_back({"GET",
+                                "/api/greeks/surface?type=call&strike=100&rate=0.05&volatility=0.2"
+                                "&spot_range=%5B80,120%5D&time_range=%5B0.1,2%5D&steps=50&fields=price,delta,gamma,vega",
+                                ""});
+
+            // Named underlyings read their curve and surface out of the current snapshot
+            const auto snapshot = MarketDataStore::shared().snapshot();
+            std::size_t underlyings = 0;
+            for (const auto &entry : snapshot->underlyings())
+            {
+                if (underlyings++ == 8)
+                    break;
+                requests.push_back(post("/api/price", {{"type", "call"}, {"underlying", entry.first},
+                                                       {"strike", entry.second.spot}, {"time", 0.5}}));
+            }
+            return requests;
+        }
+
+        std::vector<Warmup::Request> Warmup::loadRequests(const std::string &path)
+        {
+            std::ifstream in(path);
+            if (!in)
+                throw std::runtime_error("Cannot read warm-up file " + path);
+
+            std::vector<Request> requests;
+            std::string line;
+            for (std::size_t number = 1; std::getline(in, line); ++number)
+            {
+                if (line.find_first_not_of(" \t\r") == std::string::npos)
+                    continue;
+                const std::string where = path + ":" + std::to_string(number);
+                const json entry = json::parse(line, nullptr, false);
+                if (!entry.is_object() || !entry.contains("path") || !entry["path"].is_string())
+                    throw std::invalid_argument(where + ": expected {\"method\", \"path\", \"body\"}");
+
+                Request request;
+                request.path = entry["path"].get<std::string>();
+                if (request.path.empty() || request.path[0] != '/')
+                    throw std::invalid_argument(where + ": path must start with /");
+                if (entry.contains("body"))
+                    request.body = entry["body"].is_string() ? entry["body"].get<std::string>() : entry["body"].dump();
+                request.method = entry.value("method", request.body.empty() ? "GET" : "POST");
+                if (request.method != "GET" && request.method != "POST")
+                    throw std::invalid_argument(where + ": method must be GET or POST");
+                requests.push_back(std::move(request));
+            }
+            return requests;
+        }
+
+    } // namespace API
+} // namespace OptionPricer
@@ -0,0 +1,101 @@
+#include "concurrency/Cancellation.h"
+
+namespace OptionPricer
+{
+
+    namespace
+    {
+        thread_local CancellationToken *currentToken = nullptr;
+    } // namespace
+
+    CancellationToken::CancellationToken()
+        : start_(Clock::now())
+    {
+    }
+
+    void CancellationToken::cancel(Reason reason)
+    {
+        Reason expected = Reason::None;
+        reason_.compare_exchange_strong(expected, reason == Reason::None ? Reason::Requested : reason,
+                                        std::memory_order_acq_rel);
+    }
+
+    void CancellationToken::limit(std::chrono::milliseconds budget)
+    {
+        // Beyond the clock's range is no sooner than no deadline at all
+        constexpr std::chrono::milliseconds longest =
+            std::chrono::duration_cast<std::chrono::milliseconds>(Clock::duration::max());
+        if (budget.count() <= 0 || budget >= longest)
+            return;
+        const Clock::rep ticks = std::chrono::duration_cast<Clock::duration>(budget).count();
+        Clock::rep current = deadline_.load(std::memory_order_relaxed);
+        while (ticks < current && !deadline_.compare_exchange_weak(current, ticks, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    bool CancellationToken::cancelled() const
+    {
+        if (reason_.load(std::memory_order_acquire) != Reason::None)
+            return true;
+        const Clock::rep deadline = deadline_.load(std::memory_order_relaxed);
+        if (deadline == NoDeadline || Clock::now() - start_ < Clock::duration(deadline))
+            return false;
+        Reason expected = Reason::None;
+        reason_.compare_exchange_strong(expected, Reason::Deadline, std::memory_order_acq_rel);
+        return true;
+    }
+
+    bool CancellationToken::hasDeadline() const
+    {
+        return deadline_.load(std::memory_order_relaxed) != NoDeadline;
+    }
+
+    std::string CancellationToken::message() const
+    {
+        switch (reason())
+        {
+        case Reason::Deadline:
+        {
+            const auto budget = std::chrono::duration_cast<std::chrono::milliseconds>(
+                Clock::duration(deadline_.load(std::memory_order_relaxed)));
+            return "Deadline of " + std::to_string(budget.count()) + " ms exceeded";
+        }
+        case Reason::Disconnected:
+            return "Client disconnected";
+        case Reason::Requested:
+            return "Request cancelled";
+        default:
+            return "Not cancelled";
+        }
+    }
+
+    void CancellationToken::throwIfCancelled() const
+    {
+        if (cancelled())
+            throw OperationCancelled(reason(), message());
+    }
+
+    CancellationToken *CancellationToken::current()
+    {
+        return currentToken;
+    }
+
+    void CancellationToken::checkpoint()
+    {
+        if (currentToken)
+            currentToken->throwIfCancelled();
+    }
+
+    CancellationToken::Scope::Scope(CancellationToken *token)
+        : previous_(currentToken)
+    {
+        currentToken = token;
+    }
+
+    CancellationToken::Scope::~Scope()
+    {
+        currentToken = previous_;
+    }
+
+} // namespace OptionPricer
@@ -0,0 +1,379 @@
+#include "concurrency/Scheduler.h"
+#include <algorithm>
+#include <cstdlib>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace OptionPricer
+{
+
+    namespace
+    {
+        std::mutex sharedMutex;
+        std::unique_ptr<Scheduler> sharedScheduler;
+        std::size_t sharedThreads = 0;
+        bool sharedConfigured = false;
+
+        // Identifies the scheduler and deque owned by the current thread, if any
+        struct WorkerIdentity
+        {
+            const Scheduler *owner = nullptr;
+            std::size_t index = 0;
+        };
+        thread_local WorkerIdentity currentWorker;
+
+        std::size_t resolveThreadCount(std::size_t threads)
+        {
+            if (threads == 0)
+                threads = std::thread::hardware_concurrency();
+            return std::max<std::size_t>(1, threads);
+        }
+    } // namespace
+
+    Scheduler::Scheduler(std::size_t threads)
+    {
+        const std::size_t workerCount = resolveThreadCount(threads) - 1;
+        for (std::size_t i = 0; i < workerCount; ++i)
+            queues_.push_back(std::make_unique<WorkerQueue>());
+
+        workers_.reserve(workerCount);
+        for (std::size_t i = 0; i < workerCount; ++i)
+            workers_.emplace_back([this, i]
+                                  { workerLoop(i); });
+    }
+
+    Scheduler::~Scheduler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto &worker : workers_)
+            worker.join();
+    }
+
+    void Scheduler::submit(Task task)
+    {
+        // Count first so pending_ never underflows when a thief pops immediately
+        pending_.fetch_add(1);
+        WorkerQueue &queue = currentWorker.owner == this ? *queues_[currentWorker.index] : injection_;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+
+        // Taking the lock orders the increment before any sleeper's predicate check
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+        }
+        wake_.notify_one();
+    }
+
+    bool Scheduler::tryRunOne()
+    {
+        Task task;
+        const bool isWorker = currentWorker.owner == this;
+        const std::size_t self = isWorker ? currentWorker.index : 0;
+
+        auto popBack = [&task](WorkerQueue &queue)
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+                return false;
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        };
+        auto popFront = [&task](WorkerQueue &queue)
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+                return false;
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        };
+
+        bool found = (isWorker && popBack(*queues_[self])) || popFront(injection_);
+        for (std::size_t k = isWorker ? 1 : 0; !found && k < queues_.size(); ++k)
+            found = popFront(*queues_[(self + k) % queues_.size()]);
+
+        if (!found)
+            return false;
+        pending_.fetch_sub(1);
+        task();
+        return true;
+    }
+
+    bool Scheduler::tryRunPosted()
+    {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(postQueue_.mutex);
+            if (postQueue_.tasks.empty())
+                return false;
+            task = std::move(postQueue_.tasks.front());
+            postQueue_.tasks.pop_front();
+        }
+        posted_.fetch_sub(1);
+        task();
+        return true;
+    }
+
+    void Scheduler::workerLoop(std::size_t index)
+    {
+        currentWorker = {this, index};
+        for (;;)
+        {
+            // Tasks of requests already running come before new requests
+            if (tryRunOne() || tryRunPosted())
+                continue;
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            wake_.wait(lock, [this]
+                       { return stopping_ || pending_.load() > 0 || posted_.load() > 0; });
+            if (stopping_ && pending_.load() == 0 && posted_.load() == 0)
+                return;
+        }
+    }
+
+    void Scheduler::post(Task task)
+    {
+        if (workers_.empty())
+        {
+            task();
+            return;
+        }
+        posted_.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(postQueue_.mutex);
+            postQueue_.tasks.push_back(std::move(task));
+        }
+        // All: a single wakeup could land on a thread waiting in TaskGroup::wait, which ignores posted work
+        wakeAll();
+    }
+
+    void Scheduler::runOnEachThread(const std::function<void()> &fn)
+    {
+        // Shared with the workers, which may still be leaving the wait when this returns
+        struct Rendezvous
+        {
+            std::mutex mutex;
+            std::condition_variable arrived;
+            std::size_t waiting;
+            std::exception_ptr error;
+        };
+        auto rendezvous = std::make_shared<Rendezvous>();
+        rendezvous->waiting = workers_.size();
+
+        for (std::size_t i = 0; i < workers_.size(); ++i)
+        {
+            post([rendezvous, &fn]
+                 {
+                std::exception_ptr error;
+                try
+                {
+                    fn();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                std::unique_lock<std::mutex> lock(rendezvous->mutex);
+                if (error && !rendezvous->error)
+                    rendezvous->error = error;
+                if (--rendezvous->waiting == 0)
+                    rendezvous->arrived.notify_all();
+                rendezvous->arrived.wait(lock, [&]
+                                         { return rendezvous->waiting == 0; }); });
+        }
+
+        std::exception_ptr error;
+        try
+        {
+            fn();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        std::unique_lock<std::mutex> lock(rendezvous->mutex);
+        rendezvous->arrived.wait(lock, [&]
+                                 { return rendezvous->waiting == 0; });
+        if (!error)
+            error = rendezvous->error;
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    std::size_t Scheduler::pinWorkers()
+    {
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof allowed, &allowed) != 0)
+            return 0;
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+                cpus.push_back(cpu);
+        }
+        if (cpus.size() < 2)
+            return 0;
+
+        std::size_t pinned = 0;
+        for (std::size_t i = 0; i < workers_.size(); ++i)
+        {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpus[(i + 1) % cpus.size()], &one);
+            if (pthread_setaffinity_np(workers_[i].native_handle(), sizeof one, &one) == 0)
+                ++pinned;
+        }
+        return pinned;
+#else
+        return 0;
+#endif
+    }
+
+    void Scheduler::wakeAll()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+        }
+        wake_.notify_all();
+    }
+
+    void Scheduler::parallelFor(std::size_t count, const std::function<void(std::size_t)> &fn,
+                                std::size_t grain)
+    {
+        if (grain == 0)
+            grain = std::max<std::size_t>(1, count / (8 * size()));
+        if (count <= grain || workers_.empty())
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (i % grain == 0)
+                    CancellationToken::checkpoint();
+                fn(i);
+            }
+            return;
+        }
+
+        TaskGroup group(*this);
+
+        // Keep the left half, publish the right half for thieves
+        std::function<void(std::size_t, std::size_t)> split = [&](std::size_t begin, std::size_t end)
+        {
+            while (end - begin > grain)
+            {
+                const std::size_t mid = begin + (end - begin) / 2;
+                group.run([&split, mid, end]
+                          { split(mid, end); });
+                end = mid;
+            }
+            CancellationToken::checkpoint();
+            for (std::size_t i = begin; i < end; ++i)
+                fn(i);
+        };
+
+        // Published halves reference split, so drain them before unwinding
+        std::exception_ptr inlineError;
+        try
+        {
+            split(0, count);
+        }
+        catch (...)
+        {
+            inlineError = std::current_exception();
+        }
+        group.wait();
+        if (inlineError)
+            std::rethrow_exception(inlineError);
+    }
+
+    Scheduler &Scheduler::shared()
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        if (!sharedScheduler)
+        {
+            std::size_t threads = sharedThreads;
+            if (!sharedConfigured)
+            {
+                if (const char *env = std::getenv("OPTION_PRICER_THREADS"))
+                    threads = static_cast<std::size_t>(std::strtoul(env, nullptr, 10));
+            }
+            sharedScheduler = std::make_unique<Scheduler>(threads);
+        }
+        return *sharedScheduler;
+    }
+
+    bool Scheduler::configureShared(std::size_t threads)
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        if (sharedScheduler)
+            return false;
+        sharedThreads = threads;
+        sharedConfigured = true;
+        return true;
+    }
+
+    TaskGroup::~TaskGroup()
+    {
+        drain();
+    }
+
+    void TaskGroup::run(std::function<void()> fn)
+    {
+        outstanding_.fetch_add(1);
+        Scheduler *scheduler = &scheduler_;
+        CancellationToken *token = CancellationToken::current();
+        scheduler_.submit([this, scheduler, token, fn = std::move(fn)]
+                          {
+            try
+            {
+                CancellationToken::Scope scope(token);
+                CancellationToken::checkpoint();
+                fn();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex_);
+                if (!error_)
+                    error_ = std::current_exception();
+            }
+            // The group may be destroyed as soon as the count hits zero
+            if (outstanding_.fetch_sub(1) == 1)
+                scheduler->wakeAll(); });
+    }
+
+    void TaskGroup::drain()
+    {
+        while (outstanding_.load() > 0)
+        {
+            if (scheduler_.tryRunOne())
+                continue;
+
+            std::unique_lock<std::mutex> lock(scheduler_.sleepMutex_);
+            scheduler_.wake_.wait(lock, [this]
+                                  { return outstanding_.load() == 0 || scheduler_.pending_.load() > 0; });
+        }
+    }
+
+    void TaskGroup::wait()
+    {
+        drain();
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex_);
+            std::swap(error, error_);
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+} // namespace OptionPricer
@@ -0,0 +1,279 @@
+/**
+ * @file load_generator.cpp
+ * @brief Open-loop HTTP load generator for pricing_server
+ *
+ * Requests are scheduled up front at the offered rate (Poisson arrivals by
+ * default) and each one's latency is measured from when it was scheduled
+ * to go out, not from when a connection became free to send it. A server
+ * that stalls therefore shows the stall in every request queued behind it,
+ * instead of quietly lowering the send rate (coordinated omission).
+ *
+ * Usage:
+ *   ./load_generator [--host H] [--port N] [--rate R] [--duration S]
+ *                    [--connections N] [--mix price:70,american:10,portfolio:10,surface:10]
+ *                    [--uniform] [--seed N]
+ */
+
+// Windows SDK version for CreateFile2 compatibility
+#ifdef _WIN32
+#define _WIN32_WINNT 0x0A00 // Windows 10+
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <httplib.h>
+#include "metrics/Metrics.h"
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+namespace Metrics = OptionPricer::Metrics;
+
+namespace
+{
+    // One kind of request in the mix; bodies rotate so the Greeks cache sees distinct legs
+    struct Workload
+    {
+        std::string name;
+        std::string method;
+        std::string path;
+        std::vector<std::string> bodies; // POST bodies, or query strings for GET
+        unsigned weight = 0;
+        std::size_t metric = 0;
+        std::atomic<std::uint64_t> errors{0};
+    };
+
+    constexpr int Variants = 64;
+
+    json option(int variant, const char *model, int steps)
+    {
+        return {{"type", variant % 2 ? "put" : "call"}, {"model", model}, {"spot", 100.0},
+                {"strike", 80.0 + 40.0 * variant / Variants}, {"rate", 0.05},
+                {"volatility", 0.15 + 0.002 * variant}, {"time", 0.25 + variant % 8 * 0.25}, {"steps", steps}};
+    }
+
+    std::vector<Workload> workloads()
+    {
+        std::vector<Workload> all(4);
+        all[0].name = "price";
+        all[1].name = "american";
+        all[2].name = "portfolio";
+        all[3].name = "surface";
+        all[0].method = all[1].method = all[2].method = "POST";
+        all[3].method = "GET";
+        all[0].path = all[1].path = "/api/price";
+        all[2].path = "/api/portfolio/price";
+        all[3].path = "/api/greeks/surface";
+
+        for (int v = 0; v < Variants; ++v)
+        {
+            all[0].bodies.push_back(option(v, "european", 0).dump());
+            all[1].bodies.push_back(option(v, "american", 2000).dump());
+
+            // 40 legs, every fifth one American
+            json portfolio = {{"spot", 100.0}, {"rate", 0.05}, {"legs", json::array()}};
+            for (int leg = 0; leg < 40; ++leg)
+            {
+                const json o = option((v + leg) % Variants, "", 0);
+                portfolio["legs"].push_back({{"type", leg % 5 == 4 ? "american" : "european"},
+                                             {"optionType", o["type"]}, {"strike", o["strike"]},
+                                             {"volatility", o["volatility"]}, {"time", o["time"]},
+                                             {"quantity", leg % 3 ? 1 : -2}, {"steps", 200}});
+            }
+            all[2].bodies.push_back(portfolio.dump());
+
+            // 200 x 200 points, all five Greeks
+            std::ostringstream query;
+            query << "?type=" << (v % 2 ? "put" : "call") << "&strike=" << 80 + v % 40
+                  << "&rate=0.05&volatility=0.2&steps=200&fields=delta,gamma,vega,theta,rho";
+            all[3].bodies.push_back(query.str());
+        }
+        return all;
+    }
+
+    // "price:70,american:10" -> weights; names left out of the list get 0
+    bool parseMix(const std::string &mix, std::vector<Workload> &all)
+    {
+        for (auto &w : all)
+            w.weight = 0;
+        std::stringstream entries(mix);
+        std::string entry;
+        while (std::getline(entries, entry, ','))
+        {
+            const std::size_t colon = entry.find(':');
+            const std::string name = entry.substr(0, colon);
+            auto it = std::find_if(all.begin(), all.end(), [&](const Workload &w)
+                                   { return w.name == name; });
+            if (it == all.end() || colon == std::string::npos)
+                return false;
+            it->weight = static_cast<unsigned>(std::strtoul(entry.c_str() + colon + 1, nullptr, 10));
+        }
+        return std::any_of(all.begin(), all.end(), [](const Workload &w)
+                           { return w.weight > 0; });
+    }
+
+    struct Request
+    {
+        Clock::duration due; // since the start of the run
+        std::uint32_t workload;
+        std::uint32_t variant;
+    };
+
+    void printRow(const std::string &name, std::uint64_t count, std::uint64_t errors, double seconds,
+                  const Metrics::LatencySummary &s)
+    {
+        std::printf("%-10s %9llu %7llu %10.1f %10.3f %10.3f %10.3f\n", name.c_str(),
+                    static_cast<unsigned long long>(count), static_cast<unsigned long long>(errors),
+                    count / seconds, s.p50 * 1e3, s.p99 * 1e3, s.p999 * 1e3);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string host = "localhost";
+    int port = 8080;
+    double rate = 200.0;
+    double duration = 10.0;
+    unsigned connections = 32;
+    std::string mix = "price:70,american:10,portfolio:10,surface:10";
+    bool uniform = false;
+    unsigned seed = 42;
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--uniform") == 0)
+            uniform = true;
+        else if (hasValue && std::strcmp(argv[i], "--host") == 0)
+            host = argv[++i];
+        else if (hasValue && std::strcmp(argv[i], "--port") == 0)
+            port = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--rate") == 0)
+            rate = std::atof(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--duration") == 0)
+            duration = std::atof(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--connections") == 0)
+            connections = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (hasValue && std::strcmp(argv[i], "--mix") == 0)
+            mix = argv[++i];
+        else if (hasValue && std::strcmp(argv[i], "--seed") == 0)
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else
+        {
+            std::cerr << "Unknown argument: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Workload> all = workloads();
+    if (rate <= 0.0 || duration <= 0.0 || connections == 0 || !parseMix(mix, all))
+    {
+        std::cerr << "Need --rate > 0, --duration > 0, --connections > 0 and a --mix of "
+                     "price, american, portfolio and surface weights"
+                  << std::endl;
+        return 1;
+    }
+    for (auto &w : all)
+        w.metric = Metrics::endpoint(w.method, w.name);
+    const std::size_t overall = Metrics::endpoint("ALL", "all");
+
+    // The whole schedule is fixed before the first request goes out
+    std::mt19937_64 rng(seed);
+    std::exponential_distribution<double> gap(rate);
+    std::vector<unsigned> weights;
+    for (const auto &w : all)
+        weights.push_back(w.weight);
+    std::discrete_distribution<std::uint32_t> pick(weights.begin(), weights.end());
+    std::vector<Request> schedule;
+    double at = 0.0;
+    for (std::uint64_t n = 0; at < duration; ++n)
+    {
+        schedule.push_back({std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(at)),
+                            pick(rng), static_cast<std::uint32_t>(n % Variants)});
+        at += uniform ? 1.0 / rate : gap(rng);
+    }
+
+    {
+        httplib::Client probe(host, port);
+        if (!probe.Get("/health"))
+        {
+            std::cerr << "No pricing_server at " << host << ":" << port << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Offering " << rate << " req/s for " << duration << " s over " << connections
+              << " connections (" << schedule.size() << " requests, "
+              << (uniform ? "uniform" : "Poisson") << " arrivals)" << std::endl;
+
+    // Each connection takes the next request due; if all are busy, it is sent
+    // late and the wait counts towards its latency
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::int64_t> maxLagNanos{0};
+    const Clock::time_point start = Clock::now();
+    std::vector<std::thread> senders;
+    for (unsigned c = 0; c < connections; ++c)
+    {
+        senders.emplace_back([&]
+                             {
+            httplib::Client client(host, port);
+            client.set_keep_alive(true);
+            client.set_tcp_nodelay(true); // otherwise Nagle + delayed ACK adds ~40 ms per POST
+            client.set_read_timeout(60);
+            for (std::size_t i; (i = next.fetch_add(1)) < schedule.size();)
+            {
+                const Request &request = schedule[i];
+                Workload &w = all[request.workload];
+                const std::string &body = w.bodies[request.variant];
+                const Clock::time_point due = start + request.due;
+                std::this_thread::sleep_until(due);
+
+                const std::int64_t lag = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - due).count();
+                for (std::int64_t seen = maxLagNanos.load(); lag > seen && !maxLagNanos.compare_exchange_weak(seen, lag);)
+                {
+                }
+
+                const httplib::Result result = w.method == "GET" ? client.Get(w.path + body)
+                                                                 : client.Post(w.path, body, "application/json");
+                const std::uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - due).count();
+                Metrics::recordLatency(w.metric, Metrics::Phase::Total, nanos);
+                Metrics::recordLatency(overall, Metrics::Phase::Total, nanos);
+                if (!result || result->status != 200)
+                    w.errors.fetch_add(1, std::memory_order_relaxed);
+            } });
+    }
+    for (auto &sender : senders)
+        sender.join();
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("\n%-10s %9s %7s %10s %10s %10s %10s\n", "endpoint", "requests", "errors", "req/s",
+                "p50 ms", "p99 ms", "p999 ms");
+    std::uint64_t errors = 0;
+    for (const auto &w : all)
+    {
+        const Metrics::LatencySummary s = Metrics::latency(w.metric, Metrics::Phase::Total);
+        if (s.count)
+            printRow(w.name, s.count, w.errors.load(), elapsed, s);
+        errors += w.errors.load();
+    }
+    const Metrics::LatencySummary total = Metrics::latency(overall, Metrics::Phase::Total);
+    printRow("all", total.count, errors, elapsed, total);
+
+    // Sending late means the connections, not the server, set the pace
+    const double maxLag = maxLagNanos.load() * 1e-9;
+    std::printf("\nElapsed %.2f s, latest send %.3f s behind schedule\n", elapsed, maxLag);
+    if (maxLag > 0.1 * duration)
+        std::cout << "Saturated: requests waited for a free connection; either the server cannot sustain "
+                  << rate << " req/s or --connections " << connections << " is too few" << std::endl;
+    return errors ? 2 : 0;
+}
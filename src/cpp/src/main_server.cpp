@@ -10,7 +10,11 @@
  * Then uncomment the pricing_server target in CMakeLists.txt and rebuild.
  *
  * Usage:
- *   ./pricing_server
+ *   ./pricing_server [--port N] [--threads N] [--cache-mb N]
+ *                    [--http-workers N] [--max-queued N] [--keep-alive N] [--max-body-mb N]
+ *                    [--request-timeout-ms N] [--warmup-rounds N] [--warmup-file PATH] [--pin-threads 1]
+ *                    [--binary-port N] [--binary-host ADDR] [--binary-socket PATH]
+ *                    [--workers HOST:PORT,...] [--market-data PATH]
  *   curl -X POST http://localhost:8080/api/price \
  *     -H "Content-Type: application/json" \
  *     -d '{"type":"call","spot":100,"strike":100,"rate":0.05,"volatility":0.2,"time":1.0}'
@@ -23,141 +27,395 @@
 #define _WIN32_WINNT 0x0A00 // Windows 10+
 #endif
 
-#include <httplib.h>
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 #include <nlohmann/json.hpp>
+#include <httplib.h>
+#include "api/JsonSerializer.h"
+#include "api/MarketDataEndpoint.h"
 #include "api/PricingEndpoint.h"
+#include "api/PortfolioSession.h"
+#include "api/RequestArena.h"
+#include "api/RestServer.h"
+#include "api/Warmup.h"
+#ifndef _WIN32
+#include "api/BinaryServer.h"
+#include "api/RiskCoordinator.h"
+#endif
+#include "concurrency/Scheduler.h"
+#include "market/MarketData.h"
+#include "metrics/Metrics.h"
+#include "options/GreeksCache.h"
 
 using json = nlohmann::json;
+using OptionPricer::API::RestServer;
 
-// CORS middleware
-void setCorsHeaders(httplib::Response &res)
+// Ctrl+C / SIGTERM: stop accepting, let requests in flight finish, then exit
+static RestServer *runningServer = nullptr;
+
+extern "C" void handleStopSignal(int /*signal*/)
 {
-    res.set_header("Access-Control-Allow-Origin", "*");
-    res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-    res.set_header("Access-Control-Allow-Headers", "Content-Type");
+    if (runningServer)
+        runningServer->stop();
 }
 
-int main()
+int main(int argc, char **argv)
 {
-    httplib::Server svr;
-
-    // Handle CORS preflight requests
-    svr.Options(R"(/api/.*)", [](const httplib::Request & /*req*/, httplib::Response &res)
+    RestServer::Config serverConfig;
+#ifndef _WIN32
+    OptionPricer::API::BinaryServer::Config binaryConfig;
+#endif
+    std::string marketPath;
+    OptionPricer::API::Warmup::Config warmupConfig;
+    std::string warmupPath;
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        const unsigned long value = std::strtoul(argv[i + 1], nullptr, 10);
+        // Worker threads for pricing; falls back to OPTION_PRICER_THREADS or all cores
+        if (std::strcmp(argv[i], "--threads") == 0)
+            OptionPricer::Scheduler::configureShared(value);
+        // Per-leg Greeks cache budget; 0 disables it
+        if (std::strcmp(argv[i], "--cache-mb") == 0)
+        {
+            OptionPricer::GreeksCache::Config cacheConfig;
+            cacheConfig.capacityBytes = static_cast<std::size_t>(value) << 20;
+            OptionPricer::GreeksCache::configureShared(cacheConfig);
+        }
+        // HTTP layer: see RestServer::Config
+        if (std::strcmp(argv[i], "--port") == 0)
+            serverConfig.port = static_cast<int>(value);
+        if (std::strcmp(argv[i], "--http-workers") == 0)
+            serverConfig.workers = value;
+        if (std::strcmp(argv[i], "--max-queued") == 0)
+            serverConfig.maxQueued = value;
+        if (std::strcmp(argv[i], "--keep-alive") == 0)
+            serverConfig.keepAliveRequests = value;
+        if (std::strcmp(argv[i], "--max-body-mb") == 0)
+            serverConfig.maxRequestBytes = static_cast<std::size_t>(value) << 20;
+        // Deadline of async pricing routes; requests may only shorten it with deadline_ms
+        if (std::strcmp(argv[i], "--request-timeout-ms") == 0)
+            serverConfig.requestTimeoutMs = static_cast<int>(value);
+        // Startup warm-up: replay rounds before /ready (0 = none), its request set, CPU pinning
+        if (std::strcmp(argv[i], "--warmup-rounds") == 0)
+            warmupConfig.maxRounds = static_cast<int>(value);
+        if (std::strcmp(argv[i], "--warmup-file") == 0)
+            warmupPath = argv[i + 1];
+        if (std::strcmp(argv[i], "--pin-threads") == 0)
+            warmupConfig.pinThreads = value != 0;
+        // Market file mapped at startup and on POST /api/market/reload
+        if (std::strcmp(argv[i], "--market-data") == 0)
+            marketPath = argv[i + 1];
+#ifndef _WIN32
+        // Binary protocol for co-located clients; off unless asked for
+        if (std::strcmp(argv[i], "--binary-port") == 0)
+            binaryConfig.port = static_cast<int>(value);
+        // Worker nodes of a distributed risk cluster listen beyond localhost
+        if (std::strcmp(argv[i], "--binary-host") == 0)
+            binaryConfig.host = argv[i + 1];
+        if (std::strcmp(argv[i], "--binary-socket") == 0)
+            binaryConfig.unixPath = argv[i + 1];
+        // Coordinator mode: worker nodes for /api/portfolio/risk/distributed
+        if (std::strcmp(argv[i], "--workers") == 0)
+        {
+            std::stringstream addresses(argv[i + 1]);
+            try
+            {
+                for (std::string address; std::getline(addresses, address, ',');)
                 {
-        setCorsHeaders(res);
-        res.status = 200; });
+                    if (!address.empty())
+                        OptionPricer::API::RiskCoordinator::shared().addWorker(address);
+                }
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+#endif
+    }
+
+    if (!marketPath.empty())
+    {
+        try
+        {
+            const std::size_t loaded = OptionPricer::MarketDataStore::shared().loadFile(marketPath);
+            std::cout << "Market data: " << loaded << " underlyings from " << marketPath << std::endl;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    RestServer server(serverConfig);
+
+    // Replayed once the server listens, after the market file so it can name its underlyings.
+    // Keep-alive connections hold a worker each, so one is left for /health and /ready probes
+    warmupConfig.connections = std::max<std::size_t>(1, server.workerCount() - 1);
+    OptionPricer::API::Warmup warmup(warmupConfig);
+    std::vector<OptionPricer::API::Warmup::Request> warmupRequests;
+    try
+    {
+        warmupRequests = warmupPath.empty() ? OptionPricer::API::Warmup::defaultRequests()
+                                            : OptionPricer::API::Warmup::loadRequests(warmupPath);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
 
     // ============================================================================
     // POST /api/price - Single option pricing
     // ============================================================================
-    svr.Post("/api/price", [](const httplib::Request &req, httplib::Response &res)
-             {
-        setCorsHeaders(res);
-        try {
-            auto reqJson = json::parse(req.body);
-            auto respJson = OptionPricer::API::PricingEndpoint::handlePriceRequest(reqJson);
-            res.set_content(respJson.dump(2), "application/json");
-            res.status = respJson.contains("error") ? 400 : 200;
-        } catch (const std::exception& e) {
-            json errorRes;
-            errorRes["error"] = e.what();
-            errorRes["status"] = "error";
-            res.set_content(errorRes.dump(2), "application/json");
-            res.status = 400;
-        } });
+    // Pricing routes run on the scheduler under a deadline; see RestServer::registerAsyncRoute
+    server.registerAsyncRoute("POST", "/api/price", [](const httplib::Request &req, httplib::Response &res)
+                              {
+        auto params = OptionPricer::API::JsonSerializer::parseOptionParams(req.body);
+        RestServer::applyDeadline(params.deadlineMs);
+        OptionPricer::Metrics::RequestTimer::enter(OptionPricer::Metrics::Phase::Price);
+        auto respJson = OptionPricer::API::PricingEndpoint::handlePriceRequest(params);
+        RestServer::sendJson(res, respJson, respJson.contains("error") ? 400 : 200); });
 
     // ============================================================================
-    // POST /api/strategy/price - Multi-leg strategy pricing
+    // POST /api/price/batch - Many independent price requests in one call
     // ============================================================================
-    svr.Post("/api/strategy/price", [](const httplib::Request &req, httplib::Response &res)
-             {
-        setCorsHeaders(res);
-        try {
-            auto reqJson = json::parse(req.body);
-            auto respJson = OptionPricer::API::PricingEndpoint::handleStrategyRequest(reqJson);
-            res.set_content(respJson.dump(2), "application/json");
+    server.registerAsyncRoute("POST", "/api/price/batch", [](const httplib::Request &req, httplib::Response &res)
+                              {
+        auto items = OptionPricer::API::JsonSerializer::parseOptionBatch(req.body);
+        OptionPricer::Metrics::RequestTimer::enter(OptionPricer::Metrics::Phase::Price);
+        auto respJson = OptionPricer::API::PricingEndpoint::handlePriceBatchRequest(items);
+        if (respJson.contains("error")) {
+            RestServer::sendJson(res, respJson, 500);
+            return;
+        }
+        // NDJSON in, NDJSON out: one result line per request line
+        if (req.get_header_value("Content-Type").rfind("application/x-ndjson", 0) == 0) {
+            OptionPricer::Metrics::RequestTimer::enter(OptionPricer::Metrics::Phase::Serialize);
+            std::string body;
+            for (const auto &result : respJson["results"])
+                body.append(result.dump()).push_back('\n');
+            res.set_content(body, "application/x-ndjson");
             res.status = 200;
-        } catch (const std::exception& e) {
-            json errorRes;
-            errorRes["error"] = e.what();
-            errorRes["status"] = "error";
-            res.set_content(errorRes.dump(2), "application/json");
-            res.status = 400;
-        } });
+            return;
+        }
+        RestServer::sendJson(res, respJson, 200); });
+
+    // ============================================================================
+    // POST /api/strategy/price - Multi-leg strategy pricing
+    // ============================================================================
+    server.registerRoute("POST", "/api/strategy/price", [](const httplib::Request &req, httplib::Response &res)
+                         {
+        auto params = OptionPricer::API::JsonSerializer::parseStrategyParams(req.body);
+        OptionPricer::Metrics::RequestTimer::enter(OptionPricer::Metrics::Phase::Price);
+        RestServer::sendJson(res, OptionPricer::API::PricingEndpoint::handleStrategyRequest(params), 200); });
 
     // ============================================================================
     // POST /api/portfolio/price - Multi-leg portfolio pricing
     // ============================================================================
-    svr.Post("/api/portfolio/price", [](const httplib::Request &req, httplib::Response &res)
-             {
-        setCorsHeaders(res);
-        try {
-            auto reqJson = json::parse(req.body);
-            auto respJson = OptionPricer::API::PricingEndpoint::handlePortfolioRequest(reqJson);
-            res.set_content(respJson.dump(2), "application/json");
-            res.status = respJson.contains("error") ? 400 : 200;
-        } catch (const std::exception& e) {
-            json errorRes;
-            errorRes["error"] = e.what();
-            errorRes["status"] = "error";
-            res.set_content(errorRes.dump(2), "application/json");
-            res.status = 400;
-        } });
+    server.registerAsyncRoute("POST", "/api/portfolio/price", [](const httplib::Request &req, httplib::Response &res)
+                              {
+        OptionPricer::API::RequestArena::Scope arena; // request temporaries, rewound on return
+        // Decoded straight from the body: a large legs array never becomes a DOM
+        auto params = OptionPricer::API::JsonSerializer::parsePortfolioParams(req.body);
+        RestServer::applyDeadline(params.deadlineMs);
+        OptionPricer::Metrics::RequestTimer::enter(OptionPricer::Metrics::Phase::Price);
+        RestServer::sendColumnar(req, res, OptionPricer::API::PricingEndpoint::buildPortfolioResponse(params),
+                                 params.stream); });
+
+    // ============================================================================
+    // POST /api/portfolio/risk - Monte Carlo VaR / ES over a horizon
+    // ============================================================================
+    server.registerAsyncEndpoint("/api/portfolio/risk", "POST", [](const json &request)
+                                 {
+        OptionPricer::API::RequestArena::Scope arena;
+        return OptionPricer::API::PricingEndpoint::handleRiskRequest(request); });
+
+#ifndef _WIN32
+    // ============================================================================
+    // Distributed risk - partitions of a run priced by --workers nodes
+    // ============================================================================
+    server.registerAsyncEndpoint("/api/portfolio/risk/distributed", "POST", [](const json &request)
+                                 {
+        OptionPricer::API::RequestArena::Scope arena;
+        return OptionPricer::API::RiskCoordinator::handleRiskRequest(request); });
+
+    server.registerEndpoint("/api/cluster/workers", "GET", [](const json & /*request*/)
+                            { return OptionPricer::API::RiskCoordinator::handleWorkersRequest(); });
+
+    server.registerEndpoint("/api/cluster/workers", "POST", [](const json &request)
+                            { return OptionPricer::API::RiskCoordinator::handleAddWorkerRequest(request); });
+#endif
+
+    // ============================================================================
+    // Portfolio sessions - price once, then PATCH legs or market fields
+    // ============================================================================
+    server.registerEndpoint("/api/portfolio/session", "POST", [](const json &request)
+                            {
+        OptionPricer::API::RequestArena::Scope arena;
+        return OptionPricer::API::SessionStore::shared().create(request); });
+
+    // Unknown session ids throw std::out_of_range, which RestServer sends as 404
+    server.registerRoute("PATCH", R"(/api/portfolio/session/([0-9a-f]+))", [](const httplib::Request &req, httplib::Response &res)
+                         {
+        OptionPricer::API::RequestArena::Scope arena;
+        auto reqJson = json::parse(req.body);
+        OptionPricer::Metrics::RequestTimer::enter(OptionPricer::Metrics::Phase::Price);
+        RestServer::sendJson(res, OptionPricer::API::SessionStore::shared().apply(req.matches[1], reqJson), 200); });
+
+    server.registerRoute("GET", R"(/api/portfolio/session/([0-9a-f]+))", [](const httplib::Request &req, httplib::Response &res)
+                         { RestServer::sendJson(res, OptionPricer::API::SessionStore::shared().snapshot(req.matches[1]), 200); });
+
+    server.registerRoute("DELETE", R"(/api/portfolio/session/([0-9a-f]+))", [](const httplib::Request &req, httplib::Response &res)
+                         {
+        OptionPricer::API::SessionStore::shared().erase(req.matches[1]);
+        RestServer::sendJson(res, json{{"status", "success"}}, 200); });
+
+    // ============================================================================
+    // POST /api/chain/price - Batch pricing of a strike chain (SIMD kernel)
+    // ============================================================================
+    server.registerAsyncRoute("POST", "/api/chain/price", [](const httplib::Request &req, httplib::Response &res)
+                              {
+        auto reqJson = json::parse(req.body);
+        RestServer::applyDeadline(reqJson.value("deadline_ms", 0.0));
+        OptionPricer::Metrics::RequestTimer::enter(OptionPricer::Metrics::Phase::Price);
+        RestServer::sendColumnar(req, res, OptionPricer::API::PricingEndpoint::buildChainResponse(reqJson), false); });
+
+    // ============================================================================
+    // POST /api/implied_vol/batch - Implied volatilities of a quoted chain (SIMD kernel)
+    // ============================================================================
+    server.registerAsyncRoute("POST", "/api/implied_vol/batch", [](const httplib::Request &req, httplib::Response &res)
+                              {
+        auto reqJson = json::parse(req.body);
+        RestServer::applyDeadline(reqJson.value("deadline_ms", 0.0));
+        OptionPricer::Metrics::RequestTimer::enter(OptionPricer::Metrics::Phase::Price);
+        RestServer::sendColumnar(req, res, OptionPricer::API::PricingEndpoint::buildImpliedVolResponse(reqJson), false); });
 
     // ============================================================================
     // GET /api/greeks/surface - Greeks surface for visualization
     // ============================================================================
-    svr.Get("/api/greeks/surface", [](const httplib::Request &req, httplib::Response &res)
-            {
-        setCorsHeaders(res);
-        try {
-            // Parse query parameters into JSON
-            json params;
-            if (req.has_param("type")) params["type"] = req.get_param_value("type");
-            if (req.has_param("strike")) params["strike"] = std::stod(req.get_param_value("strike"));
-            if (req.has_param("rate")) params["rate"] = std::stod(req.get_param_value("rate"));
-            if (req.has_param("volatility")) params["volatility"] = std::stod(req.get_param_value("volatility"));
-            if (req.has_param("spot_range")) {
-                // Parse as JSON array: "spot_range=[90,110]"
-                std::string rangeStr = req.get_param_value("spot_range");
-                params["spot_range"] = json::parse(rangeStr);
-            }
-            if (req.has_param("time_range")) {
-                std::string rangeStr = req.get_param_value("time_range");
-                params["time_range"] = json::parse(rangeStr);
-            }
-            if (req.has_param("steps")) params["steps"] = std::stoi(req.get_param_value("steps"));
+    server.registerAsyncRoute("GET", "/api/greeks/surface", [](const httplib::Request &req, httplib::Response &res)
+                              {
+        // Parse query parameters into JSON
+        json params;
+        if (req.has_param("type")) params["type"] = req.get_param_value("type");
+        if (req.has_param("underlying")) params["underlying"] = req.get_param_value("underlying");
+        if (req.has_param("strike")) params["strike"] = std::stod(req.get_param_value("strike"));
+        if (req.has_param("rate")) params["rate"] = std::stod(req.get_param_value("rate"));
+        if (req.has_param("volatility")) params["volatility"] = std::stod(req.get_param_value("volatility"));
+        if (req.has_param("spot_range")) {
+            // Parse as JSON array: "spot_range=[90,110]"
+            std::string rangeStr = req.get_param_value("spot_range");
+            params["spot_range"] = json::parse(rangeStr);
+        }
+        if (req.has_param("time_range")) {
+            std::string rangeStr = req.get_param_value("time_range");
+            params["time_range"] = json::parse(rangeStr);
+        }
+        if (req.has_param("steps")) params["steps"] = std::stoi(req.get_param_value("steps"));
+        if (req.has_param("spot_steps")) params["spot_steps"] = std::stoi(req.get_param_value("spot_steps"));
+        if (req.has_param("time_steps")) params["time_steps"] = std::stoi(req.get_param_value("time_steps"));
+        if (req.has_param("fields")) {
+            // Comma-separated: "fields=delta,gamma,theta"
+            std::stringstream fieldList(req.get_param_value("fields"));
+            std::string field;
+            params["fields"] = json::array();
+            while (std::getline(fieldList, field, ','))
+                params["fields"].push_back(field);
+        }
 
-            auto respJson = OptionPricer::API::PricingEndpoint::handleGreeksSurface(params);
-            res.set_content(respJson.dump(2), "application/json");
-            res.status = 200;
-        } catch (const std::exception& e) {
-            json errorRes;
-            errorRes["error"] = e.what();
-            errorRes["status"] = "error";
-            res.set_content(errorRes.dump(2), "application/json");
-            res.status = 400;
-        } });
+        if (req.has_param("accuracy")) params["accuracy"] = req.get_param_value("accuracy");
+        if (req.has_param("stream")) {
+            std::string stream = req.get_param_value("stream");
+            params["stream"] = stream == "1" || stream == "true";
+        }
+        OptionPricer::Metrics::RequestTimer::enter(OptionPricer::Metrics::Phase::Price);
+
+        RestServer::sendColumnar(req, res, OptionPricer::API::PricingEndpoint::buildSurfaceResponse(params),
+                                 params.value("stream", false)); });
+
+    // ============================================================================
+    // Market data - underlyings that pricing requests refer to by name
+    // ============================================================================
+    server.registerEndpoint("/api/market", "GET", [](const json & /*request*/)
+                            { return OptionPricer::API::MarketDataEndpoint::handleList(); });
+
+    // Unknown names throw std::out_of_range, which RestServer sends as 404
+    server.registerRoute("GET", R"(/api/market/([A-Za-z0-9_.\-]+))", [](const httplib::Request &req, httplib::Response &res)
+                         { RestServer::sendJson(res, OptionPricer::API::MarketDataEndpoint::handleGet(req.matches[1]), 200); });
+
+    server.registerRoute("PUT", R"(/api/market/([A-Za-z0-9_.\-]+))", [](const httplib::Request &req, httplib::Response &res)
+                         {
+        auto reqJson = json::parse(req.body);
+        RestServer::sendJson(res, OptionPricer::API::MarketDataEndpoint::handleUpdate(req.matches[1], reqJson), 200); });
+
+    server.registerRoute("DELETE", R"(/api/market/([A-Za-z0-9_.\-]+))", [](const httplib::Request &req, httplib::Response &res)
+                         { RestServer::sendJson(res, OptionPricer::API::MarketDataEndpoint::handleErase(req.matches[1]), 200); });
+
+    server.registerRoute("POST", "/api/market/reload", [marketPath](const httplib::Request & /*req*/, httplib::Response &res)
+                         {
+        if (marketPath.empty())
+            throw std::invalid_argument("No market file configured; start the server with --market-data PATH");
+        RestServer::sendJson(res, OptionPricer::API::MarketDataEndpoint::handleLoad(marketPath), 200); });
 
     // ============================================================================
     // GET /health - Health check endpoint
     // ============================================================================
-    svr.Get("/health", [](const httplib::Request & /*req*/, httplib::Response &res)
-            {
-        setCorsHeaders(res);
+    server.registerEndpoint("/health", "GET", [](const json & /*request*/)
+                            {
         json healthRes;
         healthRes["status"] = "healthy";
         healthRes["version"] = "1.0.0";
-        res.set_content(healthRes.dump(), "application/json");
+        return healthRes; });
+
+    // ============================================================================
+    // GET /ready - Readiness: 503 until the warm-up has run. Load balancers
+    // route on this; /health only says the process is up
+    // ============================================================================
+    server.registerRoute("GET", "/ready", [&warmup](const httplib::Request & /*req*/, httplib::Response &res)
+                         { RestServer::sendJson(res, warmup.status(), warmup.ready() ? 200 : 503); });
+
+    // ============================================================================
+    // GET /api/cache/stats - Greeks cache counters
+    // ============================================================================
+    server.registerEndpoint("/api/cache/stats", "GET", [](const json & /*request*/)
+                            {
+        const auto stats = OptionPricer::GreeksCache::shared().stats();
+        json statsRes;
+        statsRes["hits"] = stats.hits;
+        statsRes["misses"] = stats.misses;
+        statsRes["evictions"] = stats.evictions;
+        statsRes["entries"] = stats.entries;
+        statsRes["bytes"] = stats.bytes;
+        statsRes["capacity_bytes"] = stats.capacityBytes;
+        statsRes["status"] = "success";
+        return statsRes; });
+
+    // ============================================================================
+    // GET /metrics - Prometheus scrape: latency by endpoint and phase, model,
+    // cache and scheduler counters
+    // ============================================================================
+    server.registerRoute("GET", "/metrics", [](const httplib::Request & /*req*/, httplib::Response &res)
+                         {
+        res.set_content(OptionPricer::Metrics::prometheus(), "text/plain; version=0.0.4; charset=utf-8");
         res.status = 200; });
 
     // ============================================================================
     // GET /api/strategies - List available strategies
     // ============================================================================
-    svr.Get("/api/strategies", [](const httplib::Request & /*req*/, httplib::Response &res)
-            {
-        setCorsHeaders(res);
+    server.registerEndpoint("/api/strategies", "GET", [](const json & /*request*/)
+                            {
         json strategies;
         strategies["strategies"] = json::array({
             {{"name", "straddle"}, {"description", "Long/short straddle (call + put at same strike)"}},
@@ -165,25 +423,103 @@ int main()
             {{"name", "bull_call"}, {"description", "Bull call spread (long lower call + short higher call)"}},
             {{"name", "iron_condor"}, {"description", "Iron condor (short strangle + long wider strangle)"}}
         });
-        res.set_content(strategies.dump(2), "application/json");
-        res.status = 200; });
+        return strategies; });
+
+    const std::size_t pinned = warmup.prepare();
 
+    const RestServer::Config &config = server.config();
     std::cout << "Option Strategy Pricer Server" << std::endl;
     std::cout << "=============================" << std::endl;
-    std::cout << "Starting server on http://localhost:8080" << std::endl;
+    std::cout << "Starting server on http://localhost:" << config.port << std::endl;
+    std::cout << "Pricing threads: " << OptionPricer::Scheduler::shared().size();
+    if (warmupConfig.pinThreads)
+        std::cout << " (" << pinned << " workers pinned)";
+    std::cout << std::endl;
+    std::cout << "HTTP workers: " << (config.workers ? std::to_string(config.workers) : std::string("auto"))
+              << ", queue " << config.maxQueued << ", keep-alive " << config.keepAliveRequests
+              << ", max body " << (config.maxRequestBytes >> 20) << " MB" << std::endl;
+    std::cout << "Request timeout: "
+              << (config.requestTimeoutMs > 0 ? std::to_string(config.requestTimeoutMs) + " ms" : std::string("none"))
+              << std::endl;
+    std::cout << "Greeks cache: " << (OptionPricer::GreeksCache::shared().stats().capacityBytes >> 20) << " MB" << std::endl;
+    std::cout << "Warm-up: " << warmupRequests.size() << " requests, up to " << warmupConfig.maxRounds << " rounds on "
+              << warmupConfig.connections << " connections" << (warmupPath.empty() ? "" : " from " + warmupPath) << std::endl;
     std::cout << "Press Ctrl+C to stop" << std::endl
               << std::endl;
 
     std::cout << "Available Endpoints:" << std::endl;
     std::cout << "  POST   /api/price              - Price single option" << std::endl;
+    std::cout << "  POST   /api/price/batch        - Price many options (JSON array / NDJSON)" << std::endl;
     std::cout << "  POST   /api/strategy/price     - Price strategy" << std::endl;
     std::cout << "  POST   /api/portfolio/price    - Price multi-leg portfolio" << std::endl;
+    std::cout << "  POST   /api/portfolio/risk     - Monte Carlo VaR / ES" << std::endl;
+#ifndef _WIN32
+    std::cout << "  POST   /api/portfolio/risk/distributed - VaR / ES across worker nodes" << std::endl;
+    std::cout << "  GET    /api/cluster/workers    - Worker nodes, pinged (POST registers one)" << std::endl;
+#endif
+    std::cout << "  POST   /api/portfolio/session  - Open a portfolio session" << std::endl;
+    std::cout << "  PATCH  /api/portfolio/session/{id} - Edit legs / market, get changes" << std::endl;
+    std::cout << "  GET    /api/portfolio/session/{id} - Session snapshot (DELETE closes)" << std::endl;
+    std::cout << "  POST   /api/chain/price        - Batch-price a strike chain" << std::endl;
+    std::cout << "  POST   /api/implied_vol/batch  - Implied vols of a quoted chain" << std::endl;
     std::cout << "  GET    /api/greeks/surface     - Get Greeks surface" << std::endl;
+    std::cout << "  GET    /api/market             - List underlyings" << std::endl;
+    std::cout << "  PUT    /api/market/{name}      - Set spot, rate curve, vol surface (GET / DELETE)" << std::endl;
+    std::cout << "  POST   /api/market/reload      - Re-map the --market-data file" << std::endl;
     std::cout << "  GET    /api/strategies         - List strategies" << std::endl;
+    std::cout << "  GET    /api/cache/stats        - Greeks cache counters" << std::endl;
+    std::cout << "  GET    /metrics                - Prometheus metrics" << std::endl;
+    std::cout << "  GET    /ready                  - Readiness (503 while warming up)" << std::endl;
     std::cout << "  GET    /health                 - Health check" << std::endl
               << std::endl;
 
-    svr.listen("0.0.0.0", 8080);
+#ifndef _WIN32
+    OptionPricer::API::BinaryServer binary(binaryConfig);
+    try
+    {
+        binary.start();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (binary.port() >= 0)
+        std::cout << "Binary protocol on " << binaryConfig.host << ":" << binary.port() << std::endl;
+    if (!binaryConfig.unixPath.empty())
+        std::cout << "Binary protocol on unix:" << binaryConfig.unixPath << std::endl;
+#endif
+
+    // Warm up over loopback as soon as the server listens; /ready answers 503 until then
+    std::thread warming([&]
+                        {
+        server.waitUntilReady();
+        if (!server.isRunning())
+            return;
+        const auto report = warmup.run(config.host, server.port(), warmupRequests);
+        std::cout << "Ready after " << report.rounds << " warm-up rounds in " << report.seconds << " s (p99 "
+                  << report.p99Ms << " ms, " << (report.settled ? "settled" : "not settled") << ", "
+                  << report.failures << " failed)" << std::endl; });
+
+    runningServer = &server;
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    try
+    {
+        server.start();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        warming.join();
+        return 1;
+    }
+    runningServer = nullptr;
+    warming.join();
+#ifndef _WIN32
+    binary.stop();
+#endif
+    std::cout << "Server stopped" << std::endl;
 
     return 0;
 }
@@ -191,6 +527,7 @@ int main()
 #else
 
 #include <iostream>
+#include <memory>
 
 int main()
 {
@@ -0,0 +1,449 @@
+#include "market/MarketData.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace OptionPricer
+{
+
+    namespace
+    {
+        constexpr char Magic[4] = {'O', 'P', 'M', 'D'};
+        constexpr std::uint32_t FormatVersion = 1;
+        constexpr std::size_t NameBytes = Underlying::MaxNameLength + 1;
+        // Upper bound on any one array, so sizes read from a file cannot overflow
+        constexpr std::size_t MaxPoints = 1u << 20;
+
+        bool increasingPositive(const double *values, std::size_t n)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (!std::isfinite(values[i]) || !(values[i] > 0.0) || (i > 0 && !(values[i] > values[i - 1])))
+                    return false;
+            }
+            return true;
+        }
+
+        void validate(const Underlying &u)
+        {
+            if (u.name.empty() || u.name.size() > Underlying::MaxNameLength ||
+                u.name.find('\0') != std::string::npos)
+            {
+                throw std::invalid_argument("Underlying name must be 1 to " +
+                                            std::to_string(Underlying::MaxNameLength) + " characters");
+            }
+            if (!std::isfinite(u.spot) || !(u.spot > 0.0))
+                throw std::invalid_argument(u.name + ": spot must be positive");
+
+            const RateCurve &curve = u.rates;
+            if (curve.size() == 0 || curve.size() > MaxPoints || !increasingPositive(curve.times(), curve.size()))
+                throw std::invalid_argument(u.name + ": rate pillar times must be positive and increasing");
+            if (!std::all_of(curve.rates(), curve.rates() + curve.size(), [](double r)
+                             { return std::isfinite(r); }))
+                throw std::invalid_argument(u.name + ": rates must be finite");
+
+            const VolSurface &surface = u.surface;
+            const std::size_t expiries = surface.expiryCount();
+            const std::size_t columns = surface.columns();
+            if (expiries == 0 || expiries > MaxPoints || !increasingPositive(surface.expiries(), expiries))
+                throw std::invalid_argument(u.name + ": surface expiries must be positive and increasing");
+            if (surface.kind() == VolSurface::Kind::Grid)
+            {
+                if (columns == 0 || columns > MaxPoints || !increasingPositive(surface.moneyness(), columns))
+                    throw std::invalid_argument(u.name + ": surface moneyness must be positive and increasing");
+                if (!std::all_of(surface.values(), surface.values() + expiries * columns, [](double v)
+                                 { return std::isfinite(v) && v > 0.0; }))
+                    throw std::invalid_argument(u.name + ": surface volatilities must be positive");
+            }
+            else if (surface.kind() == VolSurface::Kind::Svi)
+            {
+                if (columns != VolSurface::SviParams)
+                    throw std::invalid_argument(u.name + ": SVI slices take 5 parameters (a, b, rho, m, s)");
+                for (std::size_t e = 0; e < expiries; ++e)
+                {
+                    const double *p = surface.values() + e * VolSurface::SviParams;
+                    const double a = p[0], b = p[1], rho = p[2], m = p[3], s = p[4];
+                    // The slice minimum is a + b s sqrt(1 - rho^2); it must leave positive variance
+                    if (!std::isfinite(a) || !std::isfinite(m) || !(b >= 0.0) || !std::isfinite(b) ||
+                        !(std::abs(rho) < 1.0) || !(s > 0.0) || !std::isfinite(s) ||
+                        !(a + b * s * std::sqrt(1.0 - rho * rho) > 0.0))
+                    {
+                        throw std::invalid_argument(u.name + ": SVI slice " + std::to_string(e) +
+                                                    " needs b >= 0, |rho| < 1, s > 0 and positive variance");
+                    }
+                }
+            }
+            else
+            {
+                throw std::invalid_argument(u.name + ": unknown surface kind");
+            }
+        }
+
+        // Read-only view of a whole file, unmapped with its last owner
+        class MappedFile
+        {
+        public:
+            explicit MappedFile(const std::string &path)
+            {
+#ifndef _WIN32
+                const int fd = ::open(path.c_str(), O_RDONLY);
+                struct stat info;
+                if (fd < 0 || ::fstat(fd, &info) != 0)
+                {
+                    const int error = errno;
+                    if (fd >= 0)
+                        ::close(fd);
+                    throw std::runtime_error("Cannot read market file " + path + ": " + std::strerror(error));
+                }
+                size_ = static_cast<std::size_t>(info.st_size);
+                void *mapped = size_ > 0 ? ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+                const int error = errno;
+                ::close(fd);
+                if (mapped == MAP_FAILED)
+                    throw std::runtime_error("Cannot map market file " + path + ": " + std::strerror(error));
+                data_ = static_cast<const unsigned char *>(mapped);
+#else
+                std::ifstream in(path, std::ios::binary | std::ios::ate);
+                if (!in)
+                    throw std::runtime_error("Cannot read market file " + path);
+                size_ = static_cast<std::size_t>(in.tellg());
+                buffer_.resize((size_ + sizeof(double) - 1) / sizeof(double)); // double-aligned
+                in.seekg(0);
+                in.read(reinterpret_cast<char *>(buffer_.data()), static_cast<std::streamsize>(size_));
+                data_ = reinterpret_cast<const unsigned char *>(buffer_.data());
+#endif
+            }
+
+            ~MappedFile()
+            {
+#ifndef _WIN32
+                if (data_)
+                    ::munmap(const_cast<unsigned char *>(data_), size_);
+#endif
+            }
+
+            MappedFile(const MappedFile &) = delete;
+            MappedFile &operator=(const MappedFile &) = delete;
+
+            const unsigned char *data() const { return data_; }
+            std::size_t size() const { return size_; }
+
+        private:
+            const unsigned char *data_ = nullptr;
+            std::size_t size_ = 0;
+#ifdef _WIN32
+            std::vector<double> buffer_;
+#endif
+        };
+
+        // Bounds-checked cursor over a mapped file
+        class Reader
+        {
+        public:
+            Reader(const unsigned char *data, std::size_t size) : data_(data), size_(size) {}
+
+            const unsigned char *take(std::size_t bytes)
+            {
+                if (bytes > size_ - offset_)
+                    throw std::invalid_argument("Market file is truncated");
+                const unsigned char *at = data_ + offset_;
+                offset_ += bytes;
+                return at;
+            }
+
+            std::uint32_t u32()
+            {
+                std::uint32_t v;
+                std::memcpy(&v, take(sizeof v), sizeof v);
+                return v;
+            }
+
+            double f64()
+            {
+                double v;
+                std::memcpy(&v, take(sizeof v), sizeof v);
+                return v;
+            }
+
+            // In place: every array starts on an 8-byte boundary of a page-aligned mapping
+            const double *doubles(std::size_t n)
+            {
+                if (n > (size_ - offset_) / sizeof(double))
+                    throw std::invalid_argument("Market file is truncated");
+                return reinterpret_cast<const double *>(take(n * sizeof(double)));
+            }
+
+            bool done() const { return offset_ == size_; }
+
+        private:
+            const unsigned char *data_;
+            std::size_t size_;
+            std::size_t offset_ = 0;
+        };
+
+        template <class T>
+        void append(std::string &out, T value)
+        {
+            out.append(reinterpret_cast<const char *>(&value), sizeof value);
+        }
+
+        void appendDoubles(std::string &out, const double *values, std::size_t n)
+        {
+            out.append(reinterpret_cast<const char *>(values), n * sizeof(double));
+        }
+    } // namespace
+
+    double RateCurve::rate(double time) const
+    {
+        if (time <= times_[0])
+            return rates_[0];
+        if (time >= times_[size_ - 1])
+            return rates_[size_ - 1];
+
+        const std::size_t hi = static_cast<std::size_t>(std::upper_bound(times_, times_ + size_, time) - times_);
+        const std::size_t lo = hi - 1;
+        const double w = (time - times_[lo]) / (times_[hi] - times_[lo]);
+        const double integral = rates_[lo] * times_[lo] + w * (rates_[hi] * times_[hi] - rates_[lo] * times_[lo]);
+        return integral / time;
+    }
+
+    double VolSurface::totalVariance(std::size_t e, double moneyness) const
+    {
+        const double *row = values_ + e * columns_;
+        if (kind_ == Kind::Svi)
+        {
+            const double d = std::log(moneyness) - row[3];
+            return row[0] + row[1] * (row[2] * d + std::sqrt(d * d + row[4] * row[4]));
+        }
+
+        double vol;
+        if (moneyness <= moneyness_[0])
+            vol = row[0];
+        else if (moneyness >= moneyness_[columns_ - 1])
+            vol = row[columns_ - 1];
+        else
+        {
+            const std::size_t hi =
+                static_cast<std::size_t>(std::upper_bound(moneyness_, moneyness_ + columns_, moneyness) - moneyness_);
+            const std::size_t lo = hi - 1;
+            const double w = (moneyness - moneyness_[lo]) / (moneyness_[hi] - moneyness_[lo]);
+            vol = row[lo] + w * (row[hi] - row[lo]);
+        }
+        return vol * vol * expiries_[e];
+    }
+
+    double VolSurface::volatility(double moneyness, double time) const
+    {
+        const std::size_t last = expiryCount_ - 1;
+        if (time <= expiries_[0])
+            return std::sqrt(totalVariance(0, moneyness) / expiries_[0]);
+        if (time >= expiries_[last])
+            return std::sqrt(totalVariance(last, moneyness) / expiries_[last]);
+
+        const std::size_t hi =
+            static_cast<std::size_t>(std::upper_bound(expiries_, expiries_ + expiryCount_, time) - expiries_);
+        const std::size_t lo = hi - 1;
+        const double w = (time - expiries_[lo]) / (expiries_[hi] - expiries_[lo]);
+        const double variance = totalVariance(lo, moneyness) + w * (totalVariance(hi, moneyness) - totalVariance(lo, moneyness));
+        return std::sqrt(variance / time);
+    }
+
+    double Underlying::volatility(double strike, double time) const
+    {
+        const double forward = spot * std::exp(rate(time) * time);
+        return surface.volatility(strike / forward, time);
+    }
+
+    Underlying Underlying::make(std::string name, double spot,
+                                const std::vector<double> &rateTimes, const std::vector<double> &rates,
+                                VolSurface::Kind kind, const std::vector<double> &expiries,
+                                const std::vector<double> &moneyness, const std::vector<double> &values)
+    {
+        const std::size_t columns = kind == VolSurface::Kind::Svi ? VolSurface::SviParams : moneyness.size();
+        if (rates.size() != rateTimes.size())
+            throw std::invalid_argument(name + ": rates must match rate pillar times");
+        if (kind == VolSurface::Kind::Svi && !moneyness.empty())
+            throw std::invalid_argument(name + ": SVI surfaces take no moneyness columns");
+        if (values.size() != expiries.size() * columns)
+            throw std::invalid_argument(name + ": surface needs one row of " + std::to_string(columns) +
+                                        " values per expiry");
+
+        // One block: rate times, rates, expiries, moneyness, values
+        auto block = std::make_shared<std::vector<double>>();
+        block->reserve(2 * rates.size() + expiries.size() + moneyness.size() + values.size());
+        for (const auto *part : {&rateTimes, &rates, &expiries, &moneyness, &values})
+            block->insert(block->end(), part->begin(), part->end());
+
+        const double *at = block->data();
+        Underlying u;
+        u.name = std::move(name);
+        u.spot = spot;
+        u.rates = RateCurve(at, at + rates.size(), rates.size());
+        at += 2 * rates.size();
+        const double *expiriesAt = at;
+        at += expiries.size();
+        const double *moneynessAt = moneyness.empty() ? nullptr : at;
+        at += moneyness.size();
+        u.surface = VolSurface(kind, expiriesAt, expiries.size(), moneynessAt, columns, at);
+        u.storage = std::move(block);
+        validate(u);
+        return u;
+    }
+
+    const Underlying *MarketSnapshot::find(const std::string &name) const
+    {
+        const auto it = underlyings_.find(name);
+        return it == underlyings_.end() ? nullptr : &it->second;
+    }
+
+    MarketDataStore::MarketDataStore() : current_(std::make_shared<const MarketSnapshot>()) {}
+
+    std::shared_ptr<const MarketSnapshot> MarketDataStore::snapshot() const
+    {
+        return std::atomic_load(&current_);
+    }
+
+    std::uint64_t MarketDataStore::publish(std::shared_ptr<MarketSnapshot> next)
+    {
+        const std::uint64_t version = std::atomic_load(&current_)->version_ + 1;
+        next->version_ = version;
+        std::atomic_store(&current_, std::shared_ptr<const MarketSnapshot>(std::move(next)));
+        return version;
+    }
+
+    std::uint64_t MarketDataStore::update(Underlying underlying)
+    {
+        validate(underlying);
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto next = std::make_shared<MarketSnapshot>(*std::atomic_load(&current_));
+        std::string name = underlying.name;
+        next->underlyings_[std::move(name)] = std::move(underlying);
+        return publish(std::move(next));
+    }
+
+    bool MarketDataStore::erase(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto next = std::make_shared<MarketSnapshot>(*std::atomic_load(&current_));
+        if (next->underlyings_.erase(name) == 0)
+            return false;
+        publish(std::move(next));
+        return true;
+    }
+
+    std::size_t MarketDataStore::loadFile(const std::string &path)
+    {
+        auto file = std::make_shared<const MappedFile>(path);
+        Reader in(file->data(), file->size());
+
+        const unsigned char *magic = in.take(sizeof Magic);
+        if (std::memcmp(magic, Magic, sizeof Magic) != 0)
+            throw std::invalid_argument(path + " is not a market data file");
+        if (in.u32() != FormatVersion)
+            throw std::invalid_argument(path + ": unsupported market file version");
+        const std::uint32_t count = in.u32();
+        in.u32(); // reserved
+
+        std::vector<Underlying> loaded;
+        loaded.reserve(std::min<std::size_t>(count, MaxPoints));
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            const char *name = reinterpret_cast<const char *>(in.take(NameBytes));
+            Underlying u;
+            u.name.assign(name, std::find(name, name + NameBytes, '\0'));
+            u.spot = in.f64();
+            const std::size_t pillars = in.u32();
+            const std::uint32_t kind = in.u32();
+            const std::size_t expiries = in.u32();
+            const std::size_t columns = in.u32();
+            if (pillars > MaxPoints || expiries > MaxPoints || columns > MaxPoints)
+                throw std::invalid_argument(path + ": array too large for " + u.name);
+            if (kind > static_cast<std::uint32_t>(VolSurface::Kind::Svi))
+                throw std::invalid_argument(path + ": unknown surface kind for " + u.name);
+
+            const double *times = in.doubles(pillars);
+            const double *rates = in.doubles(pillars);
+            u.rates = RateCurve(times, rates, pillars);
+            const double *expiriesAt = in.doubles(expiries);
+            const double *moneyness = kind == static_cast<std::uint32_t>(VolSurface::Kind::Grid) ? in.doubles(columns)
+                                                                                                 : nullptr;
+            const double *values = in.doubles(expiries * columns);
+            u.surface = VolSurface(static_cast<VolSurface::Kind>(kind), expiriesAt, expiries, moneyness, columns, values);
+            u.storage = file;
+            validate(u);
+            loaded.push_back(std::move(u));
+        }
+        if (!in.done())
+            throw std::invalid_argument(path + ": trailing bytes after the last underlying");
+
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto next = std::make_shared<MarketSnapshot>(*std::atomic_load(&current_));
+        for (Underlying &u : loaded)
+        {
+            std::string name = u.name;
+            next->underlyings_[std::move(name)] = std::move(u);
+        }
+        publish(std::move(next));
+        return loaded.size();
+    }
+
+    void MarketDataStore::writeFile(const std::string &path, const MarketSnapshot &snapshot)
+    {
+        std::string out;
+        out.append(Magic, sizeof Magic);
+        append(out, FormatVersion);
+        append(out, static_cast<std::uint32_t>(snapshot.underlyings().size()));
+        append(out, std::uint32_t{0});
+        for (const auto &entry : snapshot.underlyings())
+        {
+            const Underlying &u = entry.second;
+            char name[NameBytes] = {};
+            std::memcpy(name, u.name.data(), std::min(u.name.size(), Underlying::MaxNameLength));
+            out.append(name, NameBytes);
+            append(out, u.spot);
+            const VolSurface &s = u.surface;
+            append(out, static_cast<std::uint32_t>(u.rates.size()));
+            append(out, static_cast<std::uint32_t>(s.kind()));
+            append(out, static_cast<std::uint32_t>(s.expiryCount()));
+            append(out, static_cast<std::uint32_t>(s.columns()));
+            appendDoubles(out, u.rates.times(), u.rates.size());
+            appendDoubles(out, u.rates.rates(), u.rates.size());
+            appendDoubles(out, s.expiries(), s.expiryCount());
+            if (s.kind() == VolSurface::Kind::Grid)
+                appendDoubles(out, s.moneyness(), s.columns());
+            appendDoubles(out, s.values(), s.expiryCount() * s.columns());
+        }
+
+        // A mapped file must never change under its readers: write aside, then rename over
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(out.data(), static_cast<std::streamsize>(out.size()));
+            if (!file)
+                throw std::runtime_error("Cannot write market file " + temporary);
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Cannot replace market file " + path);
+        }
+    }
+
+    MarketDataStore &MarketDataStore::shared()
+    {
+        static MarketDataStore store;
+        return store;
+    }
+
+} // namespace OptionPricer
@@ -0,0 +1,649 @@
+#include "metrics/Metrics.h"
+#include "concurrency/Scheduler.h"
+#include "options/GreeksCache.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace OptionPricer
+{
+    namespace Metrics
+    {
+
+        namespace
+        {
+            using Counter = std::atomic<std::uint64_t>;
+
+            // Slots have a single writer, so a plain load and store is enough;
+            // no locked read-modify-write on the hot path
+            inline void bump(Counter &counter, std::uint64_t n = 1)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+
+            // [0, 1.024 us) is split into SubBuckets linear buckets, then every
+            // power of two up to 2^(MinShift + Octaves) ns into SubBuckets more;
+            // the last bucket takes everything beyond
+            constexpr int SubBits = 3;
+            constexpr std::size_t SubBuckets = std::size_t{1} << SubBits;
+            constexpr int MinShift = 10;
+            constexpr int Octaves = 26;
+            constexpr std::size_t BucketCount = (Octaves + 1) * SubBuckets + 1;
+            constexpr std::size_t Overflow = BucketCount - 1;
+
+            int log2Floor(std::uint64_t v)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return 63 - __builtin_clzll(v);
+#else
+                int e = 0;
+                while (v >>= 1)
+                    ++e;
+                return e;
+#endif
+            }
+
+            std::size_t bucketIndex(std::uint64_t nanos)
+            {
+                if (nanos < (std::uint64_t{1} << MinShift))
+                    return static_cast<std::size_t>(nanos >> (MinShift - SubBits));
+                const int e = log2Floor(nanos);
+                if (e >= MinShift + Octaves)
+                    return Overflow;
+                return (e - MinShift + 1) * SubBuckets + ((nanos >> (e - SubBits)) & (SubBuckets - 1));
+            }
+
+            // Exclusive upper bound of a finite bucket, in nanoseconds
+            std::uint64_t bucketUpper(std::size_t index)
+            {
+                if (index < SubBuckets)
+                    return (index + 1) << (MinShift - SubBits);
+                const int e = MinShift + static_cast<int>(index / SubBuckets) - 1;
+                return (SubBuckets + index % SubBuckets + 1) << (e - SubBits);
+            }
+
+            // Lattice sizes as a histogram on steps; the last bucket is +Inf
+            constexpr int StepBounds[] = {50, 100, 200, 500, 1000, 2000, 5000};
+            constexpr std::size_t StepBucketCount = sizeof(StepBounds) / sizeof(StepBounds[0]) + 1;
+
+            struct Histogram
+            {
+                Counter buckets[BucketCount];
+                Counter sumNanos;
+            };
+
+            // Allocated by a thread the first time it times a request
+            struct LatencyBlock
+            {
+                Histogram histograms[MaxEndpoints][PhaseCount];
+                Counter errors[MaxEndpoints];
+            };
+
+            struct Slot
+            {
+                Counter european;
+                Counter lattices[StepBucketCount];
+                Counter binomialSteps;
+                Counter analytic;
+                Counter deadlines;
+                Counter disconnects;
+                Counter started;
+                Counter finished;
+                std::atomic<LatencyBlock *> latency;
+
+                ~Slot() { delete latency.load(); }
+            };
+
+            struct Registry
+            {
+                std::mutex mutex; // guards endpoints, live and retired; never taken on the hot path
+                std::vector<std::pair<std::string, std::string>> endpoints;
+                std::vector<Slot *> live;
+                Slot retired{};
+            };
+
+            // Never destroyed, so threads exiting during static destruction can still fold into it
+            Registry &registry()
+            {
+                static Registry *instance = new Registry();
+                return *instance;
+            }
+
+            LatencyBlock &latencyBlock(Slot &slot)
+            {
+                LatencyBlock *block = slot.latency.load(std::memory_order_relaxed);
+                if (!block)
+                {
+                    block = new LatencyBlock();
+                    slot.latency.store(block, std::memory_order_release);
+                }
+                return *block;
+            }
+
+            void add(Counter &into, const Counter &from)
+            {
+                bump(into, from.load(std::memory_order_relaxed));
+            }
+
+            // Caller holds the registry mutex
+            void fold(const Slot &from, Slot &into)
+            {
+                add(into.european, from.european);
+                for (std::size_t b = 0; b < StepBucketCount; ++b)
+                    add(into.lattices[b], from.lattices[b]);
+                add(into.binomialSteps, from.binomialSteps);
+                add(into.analytic, from.analytic);
+                add(into.deadlines, from.deadlines);
+                add(into.disconnects, from.disconnects);
+                add(into.started, from.started);
+                add(into.finished, from.finished);
+
+                const LatencyBlock *source = from.latency.load(std::memory_order_acquire);
+                if (!source)
+                    return;
+                LatencyBlock &target = latencyBlock(into);
+                for (std::size_t e = 0; e < MaxEndpoints; ++e)
+                {
+                    add(target.errors[e], source->errors[e]);
+                    for (std::size_t p = 0; p < PhaseCount; ++p)
+                    {
+                        for (std::size_t b = 0; b < BucketCount; ++b)
+                            add(target.histograms[e][p].buckets[b], source->histograms[e][p].buckets[b]);
+                        add(target.histograms[e][p].sumNanos, source->histograms[e][p].sumNanos);
+                    }
+                }
+            }
+
+            // Registers the thread's slot on first use and retires it when the thread exits
+            struct SlotHolder
+            {
+                Slot *slot = nullptr;
+
+                ~SlotHolder()
+                {
+                    if (!slot)
+                        return;
+                    Registry &r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    fold(*slot, r.retired);
+                    r.live.erase(std::find(r.live.begin(), r.live.end(), slot));
+                    delete slot;
+                }
+            };
+
+            Slot &localSlot()
+            {
+                thread_local SlotHolder holder;
+                if (!holder.slot)
+                {
+                    holder.slot = new Slot();
+                    Registry &r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    r.live.push_back(holder.slot);
+                }
+                return *holder.slot;
+            }
+
+            void record(Histogram &histogram, std::uint64_t nanos)
+            {
+                bump(histogram.buckets[bucketIndex(nanos)]);
+                bump(histogram.sumNanos, nanos);
+            }
+
+            // Innermost running RequestTimer of this thread
+            thread_local RequestTimer *currentTimer = nullptr;
+
+            std::uint64_t nanosBetween(std::chrono::steady_clock::time_point from,
+                                       std::chrono::steady_clock::time_point to)
+            {
+                return static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+            }
+
+            // A consistent sum over all slots; caller holds the registry mutex
+            struct Totals
+            {
+                std::uint64_t european = 0;
+                std::uint64_t lattices[StepBucketCount] = {};
+                std::uint64_t binomialSteps = 0;
+                std::uint64_t analytic = 0;
+                std::uint64_t deadlines = 0;
+                std::uint64_t disconnects = 0;
+                std::uint64_t started = 0;
+                std::uint64_t finished = 0;
+                std::vector<std::array<std::uint64_t, BucketCount>> buckets; // [endpoint * PhaseCount + phase]
+                std::vector<std::uint64_t> sumNanos;
+                std::uint64_t errors[MaxEndpoints] = {};
+            };
+
+            // Totals at the last reset(), taken off every sum; guarded by the registry mutex
+            Totals &baseline()
+            {
+                static Totals *instance = new Totals();
+                return *instance;
+            }
+
+            Totals rawSum(const Registry &r)
+            {
+                Totals t;
+                t.buckets.assign(MaxEndpoints * PhaseCount, {});
+                t.sumNanos.assign(MaxEndpoints * PhaseCount, 0);
+                auto sum = [&t](const Slot &slot)
+                {
+                    t.european += slot.european.load(std::memory_order_relaxed);
+                    for (std::size_t b = 0; b < StepBucketCount; ++b)
+                        t.lattices[b] += slot.lattices[b].load(std::memory_order_relaxed);
+                    t.binomialSteps += slot.binomialSteps.load(std::memory_order_relaxed);
+                    t.analytic += slot.analytic.load(std::memory_order_relaxed);
+                    t.deadlines += slot.deadlines.load(std::memory_order_relaxed);
+                    t.disconnects += slot.disconnects.load(std::memory_order_relaxed);
+                    t.started += slot.started.load(std::memory_order_relaxed);
+                    t.finished += slot.finished.load(std::memory_order_relaxed);
+
+                    const LatencyBlock *block = slot.latency.load(std::memory_order_acquire);
+                    if (!block)
+                        return;
+                    for (std::size_t e = 0; e < MaxEndpoints; ++e)
+                    {
+                        t.errors[e] += block->errors[e].load(std::memory_order_relaxed);
+                        for (std::size_t p = 0; p < PhaseCount; ++p)
+                        {
+                            const Histogram &h = block->histograms[e][p];
+                            auto &into = t.buckets[e * PhaseCount + p];
+                            for (std::size_t b = 0; b < BucketCount; ++b)
+                                into[b] += h.buckets[b].load(std::memory_order_relaxed);
+                            t.sumNanos[e * PhaseCount + p] += h.sumNanos.load(std::memory_order_relaxed);
+                        }
+                    }
+                };
+                sum(r.retired);
+                for (const Slot *slot : r.live)
+                    sum(*slot);
+                return t;
+            }
+
+            // What the accessors report: everything since reset(). Requests
+            // in flight are started - finished, so those two keep counting from 0.
+            Totals sumSlots(const Registry &r)
+            {
+                Totals t = rawSum(r);
+                const Totals &base = baseline();
+                if (base.buckets.empty())
+                    return t;
+                t.european -= base.european;
+                for (std::size_t b = 0; b < StepBucketCount; ++b)
+                    t.lattices[b] -= base.lattices[b];
+                t.binomialSteps -= base.binomialSteps;
+                t.analytic -= base.analytic;
+                t.deadlines -= base.deadlines;
+                t.disconnects -= base.disconnects;
+                for (std::size_t s = 0; s < t.buckets.size(); ++s)
+                {
+                    for (std::size_t b = 0; b < BucketCount; ++b)
+                        t.buckets[s][b] -= base.buckets[s][b];
+                    t.sumNanos[s] -= base.sumNanos[s];
+                }
+                for (std::size_t e = 0; e < MaxEndpoints; ++e)
+                    t.errors[e] -= base.errors[e];
+                return t;
+            }
+
+            Totals snapshot()
+            {
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                return sumSlots(r);
+            }
+
+            std::uint64_t countOf(const std::array<std::uint64_t, BucketCount> &buckets)
+            {
+                std::uint64_t count = 0;
+                for (std::uint64_t n : buckets)
+                    count += n;
+                return count;
+            }
+
+            // Upper bound of the bucket holding quantile q, in seconds
+            double quantile(const std::array<std::uint64_t, BucketCount> &buckets, std::uint64_t count, double q)
+            {
+                if (count == 0)
+                    return 0.0;
+                const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * count)));
+                std::uint64_t seen = 0;
+                for (std::size_t b = 0; b < Overflow; ++b)
+                {
+                    seen += buckets[b];
+                    if (seen >= rank)
+                        return bucketUpper(b) * 1e-9;
+                }
+                return bucketUpper(Overflow - 1) * 1e-9;
+            }
+
+            const char *phaseName(std::size_t phase)
+            {
+                static const char *const names[PhaseCount] = {"parse", "price", "serialize", "total"};
+                return names[phase];
+            }
+
+            std::string escapeLabel(const std::string &value)
+            {
+                std::string out;
+                out.reserve(value.size());
+                for (char c : value)
+                {
+                    if (c == '\\' || c == '"')
+                        out += '\\';
+                    if (c == '\n')
+                    {
+                        out += "\\n";
+                        continue;
+                    }
+                    out += c;
+                }
+                return out;
+            }
+
+            std::string number(double value)
+            {
+                char buffer[32];
+                std::snprintf(buffer, sizeof buffer, "%.9g", value);
+                return buffer;
+            }
+
+            void header(std::string &out, const char *name, const char *type, const char *help)
+            {
+                out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+                out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+            }
+
+            void sample(std::string &out, const std::string &name, const std::string &labels, const std::string &value)
+            {
+                out.append(name);
+                if (!labels.empty())
+                    out.append("{").append(labels).append("}");
+                out.append(" ").append(value).append("\n");
+            }
+        } // namespace
+
+        std::size_t endpoint(const std::string &method, const std::string &path)
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (std::size_t id = 0; id < r.endpoints.size(); ++id)
+                if (r.endpoints[id].first == method && r.endpoints[id].second == path)
+                    return id;
+            if (r.endpoints.size() == MaxEndpoints)
+                throw std::length_error("Too many instrumented endpoints");
+            r.endpoints.emplace_back(method, path);
+            return r.endpoints.size() - 1;
+        }
+
+        void recordLatency(std::size_t endpoint, Phase phase, std::uint64_t nanos)
+        {
+            record(latencyBlock(localSlot()).histograms[endpoint][static_cast<std::size_t>(phase)], nanos);
+        }
+
+        void recordEuropean(std::uint64_t valuations)
+        {
+            bump(localSlot().european, valuations);
+        }
+
+        void recordLattice(int steps)
+        {
+            Slot &slot = localSlot();
+            std::size_t b = 0;
+            while (b + 1 < StepBucketCount && steps > StepBounds[b])
+                ++b;
+            bump(slot.lattices[b]);
+            bump(slot.binomialSteps, static_cast<std::uint64_t>(steps));
+        }
+
+        void recordAnalytic()
+        {
+            bump(localSlot().analytic);
+        }
+
+        void recordDeadlineExceeded()
+        {
+            bump(localSlot().deadlines);
+        }
+
+        void recordDisconnect()
+        {
+            bump(localSlot().disconnects);
+        }
+
+        RequestTimer::RequestTimer(std::size_t endpoint)
+            : endpoint_(endpoint), start_(Clock::now()), mark_(start_), outer_(currentTimer)
+        {
+            currentTimer = this;
+            bump(localSlot().started);
+        }
+
+        RequestTimer::RequestTimer()
+            : endpoint_(Unrecorded), start_(Clock::now()), mark_(start_), outer_(currentTimer)
+        {
+            currentTimer = this;
+        }
+
+        RequestTimer::~RequestTimer()
+        {
+            const Clock::time_point now = Clock::now();
+            nanos_[static_cast<std::size_t>(phase_)] += nanosBetween(mark_, now);
+            currentTimer = outer_;
+            if (endpoint_ == Unrecorded)
+                return;
+
+            Slot &slot = localSlot();
+            LatencyBlock &block = latencyBlock(slot);
+            for (std::size_t p = 0; p + 1 < PhaseCount; ++p)
+                if (entered_[p])
+                    record(block.histograms[endpoint_][p], nanos_[p]);
+            record(block.histograms[endpoint_][static_cast<std::size_t>(Phase::Total)], nanosBetween(start_, now));
+            if (failed_)
+                bump(block.errors[endpoint_]);
+            bump(slot.finished);
+        }
+
+        void RequestTimer::enter(Phase phase)
+        {
+            RequestTimer *timer = currentTimer;
+            if (!timer || phase == Phase::Total || phase == timer->phase_)
+                return;
+            const Clock::time_point now = Clock::now();
+            timer->nanos_[static_cast<std::size_t>(timer->phase_)] += nanosBetween(timer->mark_, now);
+            timer->mark_ = now;
+            timer->phase_ = phase;
+            timer->entered_[static_cast<std::size_t>(phase)] = true;
+        }
+
+        RequestTimer::Phases RequestTimer::phases() const
+        {
+            Phases phases;
+            for (std::size_t p = 0; p + 1 < PhaseCount; ++p)
+            {
+                phases.nanos[p] = nanos_[p];
+                phases.entered[p] = entered_[p];
+            }
+            phases.nanos[static_cast<std::size_t>(phase_)] += nanosBetween(mark_, Clock::now());
+            return phases;
+        }
+
+        void RequestTimer::join(const Phases &part)
+        {
+            RequestTimer *timer = currentTimer;
+            if (!timer)
+                return;
+            const Clock::time_point now = Clock::now();
+            std::uint64_t &running = timer->nanos_[static_cast<std::size_t>(timer->phase_)];
+            running += nanosBetween(timer->mark_, now);
+            timer->mark_ = now;
+            std::uint64_t elsewhere = 0;
+            for (std::size_t p = 0; p + 1 < PhaseCount; ++p)
+                elsewhere += part.nanos[p];
+            running -= std::min(running, elsewhere);
+            for (std::size_t p = 0; p + 1 < PhaseCount; ++p)
+            {
+                timer->nanos_[p] += part.nanos[p];
+                timer->entered_[p] = timer->entered_[p] || part.entered[p];
+            }
+        }
+
+        void reset()
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            baseline() = rawSum(r);
+        }
+
+        LatencySummary latency(std::size_t endpoint, Phase phase)
+        {
+            const Totals t = snapshot();
+            const std::size_t series = endpoint * PhaseCount + static_cast<std::size_t>(phase);
+            const auto &buckets = t.buckets[series];
+            const std::uint64_t count = countOf(buckets);
+            return {count, t.sumNanos[series], quantile(buckets, count, 0.5), quantile(buckets, count, 0.99),
+                    quantile(buckets, count, 0.999)};
+        }
+
+        std::uint64_t errors(std::size_t endpoint)
+        {
+            return snapshot().errors[endpoint];
+        }
+
+        ModelCounts models()
+        {
+            const Totals t = snapshot();
+            std::uint64_t lattices = 0;
+            for (std::uint64_t n : t.lattices)
+                lattices += n;
+            return {t.european, lattices, t.binomialSteps, t.analytic};
+        }
+
+        std::string prometheus()
+        {
+            Totals t;
+            std::vector<std::string> endpointLabels;
+            {
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                t = sumSlots(r);
+                for (const auto &e : r.endpoints)
+                    endpointLabels.push_back("method=\"" + escapeLabel(e.first) + "\",path=\"" + escapeLabel(e.second) + "\"");
+            }
+
+            std::string out;
+            out.reserve(64 << 10);
+
+            // Buckets are exposed at powers of two; the finer sub-buckets feed the quantiles below
+            const char *duration = "option_pricer_request_duration_seconds";
+            header(out, duration, "histogram", "Handler latency by endpoint and phase");
+            for (std::size_t e = 0; e < endpointLabels.size(); ++e)
+            {
+                for (std::size_t p = 0; p < PhaseCount; ++p)
+                {
+                    const auto &buckets = t.buckets[e * PhaseCount + p];
+                    const std::uint64_t count = countOf(buckets);
+                    if (count == 0)
+                        continue;
+                    const std::string labels = endpointLabels[e] + ",phase=\"" + phaseName(p) + "\"";
+                    std::uint64_t cumulative = 0;
+                    std::size_t b = 0;
+                    for (int k = MinShift; k <= MinShift + Octaves; ++k)
+                    {
+                        const std::size_t last = (k - MinShift + 1) * SubBuckets - 1;
+                        for (; b <= last; ++b)
+                            cumulative += buckets[b];
+                        sample(out, std::string(duration) + "_bucket",
+                               labels + ",le=\"" + number(std::ldexp(1e-9, k)) + "\"", std::to_string(cumulative));
+                    }
+                    sample(out, std::string(duration) + "_bucket", labels + ",le=\"+Inf\"", std::to_string(count));
+                    sample(out, std::string(duration) + "_sum", labels, number(t.sumNanos[e * PhaseCount + p] * 1e-9));
+                    sample(out, std::string(duration) + "_count", labels, std::to_string(count));
+                }
+            }
+
+            const char *quantiles = "option_pricer_request_duration_quantile_seconds";
+            header(out, quantiles, "gauge", "Latency quantiles since start, within 12.5%");
+            for (std::size_t e = 0; e < endpointLabels.size(); ++e)
+            {
+                for (std::size_t p = 0; p < PhaseCount; ++p)
+                {
+                    const auto &buckets = t.buckets[e * PhaseCount + p];
+                    const std::uint64_t count = countOf(buckets);
+                    if (count == 0)
+                        continue;
+                    const std::string labels = endpointLabels[e] + ",phase=\"" + phaseName(p) + "\"";
+                    for (const char *q : {"0.5", "0.9", "0.99", "0.999"})
+                        sample(out, quantiles, labels + ",quantile=\"" + q + "\"",
+                               number(quantile(buckets, count, std::stod(q))));
+                }
+            }
+
+            header(out, "option_pricer_request_errors_total", "counter", "Responses with status 400 or above");
+            for (std::size_t e = 0; e < endpointLabels.size(); ++e)
+                if (t.errors[e] || countOf(t.buckets[e * PhaseCount + static_cast<std::size_t>(Phase::Total)]))
+                    sample(out, "option_pricer_request_errors_total", endpointLabels[e], std::to_string(t.errors[e]));
+
+            // Per-thread counts are read one after another, so clamp a transiently negative difference
+            header(out, "option_pricer_requests_in_flight", "gauge", "Requests being handled");
+            sample(out, "option_pricer_requests_in_flight", "",
+                   std::to_string(t.started > t.finished ? t.started - t.finished : 0));
+            header(out, "option_pricer_requests_cancelled_total", "counter",
+                   "Async requests stopped before they finished, by reason");
+            sample(out, "option_pricer_requests_cancelled_total", "reason=\"deadline\"", std::to_string(t.deadlines));
+            sample(out, "option_pricer_requests_cancelled_total", "reason=\"disconnect\"", std::to_string(t.disconnects));
+
+            std::uint64_t lattices = 0;
+            for (std::uint64_t n : t.lattices)
+                lattices += n;
+            header(out, "option_pricer_valuations_total", "counter",
+                   "Valuations by model; american counts lattices, american_analytic closed-form approximations, bumped ones included");
+            sample(out, "option_pricer_valuations_total", "model=\"european\"", std::to_string(t.european));
+            sample(out, "option_pricer_valuations_total", "model=\"american\"", std::to_string(lattices));
+            sample(out, "option_pricer_valuations_total", "model=\"american_analytic\"", std::to_string(t.analytic));
+
+            header(out, "option_pricer_binomial_lattice_steps", "histogram", "Binomial lattices by step count");
+            std::uint64_t cumulative = 0;
+            for (std::size_t b = 0; b + 1 < StepBucketCount; ++b)
+            {
+                cumulative += t.lattices[b];
+                sample(out, "option_pricer_binomial_lattice_steps_bucket", "le=\"" + std::to_string(StepBounds[b]) + "\"",
+                       std::to_string(cumulative));
+            }
+            sample(out, "option_pricer_binomial_lattice_steps_bucket", "le=\"+Inf\"", std::to_string(lattices));
+            sample(out, "option_pricer_binomial_lattice_steps_sum", "", std::to_string(t.binomialSteps));
+            sample(out, "option_pricer_binomial_lattice_steps_count", "", std::to_string(lattices));
+
+            const GreeksCache::Stats cache = GreeksCache::shared().stats();
+            header(out, "option_pricer_greeks_cache_hits_total", "counter", "Greeks cache hits");
+            sample(out, "option_pricer_greeks_cache_hits_total", "", std::to_string(cache.hits));
+            header(out, "option_pricer_greeks_cache_misses_total", "counter", "Greeks cache misses");
+            sample(out, "option_pricer_greeks_cache_misses_total", "", std::to_string(cache.misses));
+            header(out, "option_pricer_greeks_cache_evictions_total", "counter", "Greeks cache evictions");
+            sample(out, "option_pricer_greeks_cache_evictions_total", "", std::to_string(cache.evictions));
+            header(out, "option_pricer_greeks_cache_hit_ratio", "gauge", "Hits over lookups since start");
+            const std::uint64_t lookups = cache.hits + cache.misses;
+            sample(out, "option_pricer_greeks_cache_hit_ratio", "",
+                   number(lookups ? static_cast<double>(cache.hits) / lookups : 0.0));
+            header(out, "option_pricer_greeks_cache_entries", "gauge", "Greeks cache entries");
+            sample(out, "option_pricer_greeks_cache_entries", "", std::to_string(cache.entries));
+            header(out, "option_pricer_greeks_cache_bytes", "gauge", "Greeks cache size against its budget");
+            sample(out, "option_pricer_greeks_cache_bytes", "", std::to_string(cache.bytes));
+
+            Scheduler &scheduler = Scheduler::shared();
+            header(out, "option_pricer_scheduler_queue_depth", "gauge", "Pricing tasks queued and not yet started");
+            sample(out, "option_pricer_scheduler_queue_depth", "", std::to_string(scheduler.pending()));
+            header(out, "option_pricer_scheduler_threads", "gauge", "Pricing scheduler concurrency");
+            sample(out, "option_pricer_scheduler_threads", "", std::to_string(scheduler.size()));
+            return out;
+        }
+
+    } // namespace Metrics
+} // namespace OptionPricer
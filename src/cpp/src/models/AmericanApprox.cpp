@@ -0,0 +1,342 @@
+#include "models/AmericanApprox.h"
+#include "models/BlackScholes.h"
+#include "metrics/Metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace OptionPricer
+{
+    namespace AmericanApprox
+    {
+
+        namespace
+        {
+            constexpr double Pi = 3.14159265358979323846;
+
+            double N(double x)
+            {
+                return BlackScholes::cumulativeNormal(x);
+            }
+
+            // Gauss-Legendre half-rules with 3, 6 and 10 points (6, 12 and 20 point rules)
+            const double LegendreX[3][10] = {
+                {-0.9324695142031521, -0.6612093864662645, -0.2386191860831969},
+                {-0.9815606342467192, -0.9041172563704749, -0.7699026741943047, -0.5873179542866175,
+                 -0.3678314989981802, -0.1252334085114689},
+                {-0.9931285991850949, -0.9639719272779138, -0.9122344282513259, -0.8391169718222188,
+                 -0.7463319064601508, -0.6360536807265150, -0.5108670019508271, -0.3737060887154195,
+                 -0.2277858511416451, -0.0765265211334973}};
+            const double LegendreW[3][10] = {
+                {0.1713244923791704, 0.3607615730481386, 0.4679139345726910},
+                {0.0471753363865118, 0.1069393259953184, 0.1600783285433462, 0.2031674267230659,
+                 0.2334925365383548, 0.2491470458134028},
+                {0.0176140071391521, 0.0406014298003869, 0.0626720483341091, 0.0832767415767048,
+                 0.1019301198172404, 0.1181945319615184, 0.1316886384491766, 0.1420961093183820,
+                 0.1491729864726037, 0.1527533871307258}};
+
+            // ------------------------------------------------------------------
+            // Barone-Adesi-Whaley, put side (cost of carry b = r)
+            // ------------------------------------------------------------------
+
+            struct QuadraticPut
+            {
+                double critical; // spot below which exercising is optimal
+                double q;        // exponent of the early-exercise premium
+                double a;        // premium at the critical spot
+            };
+
+            QuadraticPut quadraticPut(double K, double r, double sigma, double T)
+            {
+                const double variance = sigma * sigma;
+                const double volRoot = sigma * std::sqrt(T);
+                const double m = 2.0 * r / variance;
+                const double kappa = 1.0 - std::exp(-r * T);
+                const double q = (-(m - 1.0) - std::sqrt((m - 1.0) * (m - 1.0) + 4.0 * m / kappa)) / 2.0;
+
+                // Seed from the perpetual put's boundary (Barone-Adesi and Whaley 1987)
+                const double qInfinity = (-(m - 1.0) - std::sqrt((m - 1.0) * (m - 1.0) + 4.0 * m)) / 2.0;
+                const double perpetual = K / (1.0 - 1.0 / qInfinity);
+                const double h = (r * T - 2.0 * volRoot) * K / (K - perpetual);
+                double s = perpetual + (K - perpetual) * std::exp(h);
+
+                // Newton on K - s = P(s) - (1 - N(-d1(s))) s / q
+                double tail = 0.0;
+                for (int iteration = 0; iteration < 100; ++iteration)
+                {
+                    const double d1 = (std::log(s / K) + (r + 0.5 * variance) * T) / volRoot;
+                    tail = N(-d1);
+                    const double rhs = BlackScholes::putPrice(s, K, r, sigma, T) - (1.0 - tail) * s / q;
+                    if (std::abs(K - s - rhs) < 1e-12 * K)
+                        break;
+                    const double slope = -tail * (1.0 - 1.0 / q) -
+                                         (1.0 + BlackScholes::standardNormal(d1) / volRoot) / q;
+                    s = (K - rhs + slope * s) / (1.0 + slope);
+                }
+                return {s, q, -(s / q) * (1.0 - tail)};
+            }
+
+            double bawPut(double S, double K, double r, double sigma, double T, const QuadraticPut &quad)
+            {
+                if (S <= quad.critical)
+                    return K - S;
+                return BlackScholes::putPrice(S, K, r, sigma, T) + quad.a * std::pow(S / quad.critical, quad.q);
+            }
+
+            // ------------------------------------------------------------------
+            // Bjerksund-Stensland 2002, call side with cost of carry b
+            // ------------------------------------------------------------------
+
+            double phi(double S, double T, double gamma, double H, double I, double r, double b, double sigma)
+            {
+                const double variance = sigma * sigma;
+                const double volRoot = sigma * std::sqrt(T);
+                const double lambda = (-r + gamma * b + 0.5 * gamma * (gamma - 1.0) * variance) * T;
+                const double d = -(std::log(S / H) + (b + (gamma - 0.5) * variance) * T) / volRoot;
+                const double kappa = 2.0 * b / variance + 2.0 * gamma - 1.0;
+                return std::exp(lambda) * std::pow(S, gamma) *
+                       (N(d) - std::pow(I / S, kappa) * N(d - 2.0 * std::log(I / S) / volRoot));
+            }
+
+            double psi(double S, double T2, double gamma, double H, double I2, double I1, double t1, double r,
+                       double b, double sigma)
+            {
+                const double variance = sigma * sigma;
+                const double drift = b + (gamma - 0.5) * variance;
+                const double root1 = sigma * std::sqrt(t1);
+                const double root2 = sigma * std::sqrt(T2);
+                const double e1 = (std::log(S / I1) + drift * t1) / root1;
+                const double e2 = (std::log(I2 * I2 / (S * I1)) + drift * t1) / root1;
+                const double e3 = (std::log(S / I1) - drift * t1) / root1;
+                const double e4 = (std::log(I2 * I2 / (S * I1)) - drift * t1) / root1;
+                const double f1 = (std::log(S / H) + drift * T2) / root2;
+                const double f2 = (std::log(I2 * I2 / (S * H)) + drift * T2) / root2;
+                const double f3 = (std::log(I1 * I1 / (S * H)) + drift * T2) / root2;
+                const double f4 = (std::log(S * I1 * I1 / (H * I2 * I2)) + drift * T2) / root2;
+                const double rho = std::sqrt(t1 / T2);
+                const double lambda = -r + gamma * b + 0.5 * gamma * (gamma - 1.0) * variance;
+                const double kappa = 2.0 * b / variance + 2.0 * gamma - 1.0;
+                return std::exp(lambda * T2) * std::pow(S, gamma) *
+                       (bivariateNormal(-e1, -f1, rho) - std::pow(I2 / S, kappa) * bivariateNormal(-e2, -f2, rho) -
+                        std::pow(I1 / S, kappa) * bivariateNormal(-e3, -f3, -rho) +
+                        std::pow(I1 / I2, kappa) * bivariateNormal(-e4, -f4, -rho));
+            }
+
+            double bjsCall(double S, double K, double T, double r, double b, double sigma)
+            {
+                const double variance = sigma * sigma;
+                if (b >= r)
+                {
+                    // Never exercised early: the European call with carry b
+                    const double volRoot = sigma * std::sqrt(T);
+                    const double d1 = (std::log(S / K) + (b + 0.5 * variance) * T) / volRoot;
+                    return S * std::exp((b - r) * T) * N(d1) - K * std::exp(-r * T) * N(d1 - volRoot);
+                }
+
+                const double t1 = 0.5 * (std::sqrt(5.0) - 1.0) * T;
+                const double beta = (0.5 - b / variance) +
+                                    std::sqrt((b / variance - 0.5) * (b / variance - 0.5) + 2.0 * r / variance);
+                const double bInfinity = beta / (beta - 1.0) * K;
+                const double b0 = std::max(K, r / (r - b) * K);
+                const double ht1 = -(b * t1 + 2.0 * sigma * std::sqrt(t1)) * K * K / ((bInfinity - b0) * b0);
+                const double ht2 = -(b * T + 2.0 * sigma * std::sqrt(T)) * K * K / ((bInfinity - b0) * b0);
+                const double I1 = b0 + (bInfinity - b0) * (1.0 - std::exp(ht1));
+                const double I2 = b0 + (bInfinity - b0) * (1.0 - std::exp(ht2));
+                if (S >= I2)
+                    return S - K;
+
+                const double alpha1 = (I1 - K) * std::pow(I1, -beta);
+                const double alpha2 = (I2 - K) * std::pow(I2, -beta);
+                return alpha2 * std::pow(S, beta) - alpha2 * phi(S, t1, beta, I2, I2, r, b, sigma) +
+                       phi(S, t1, 1.0, I2, I2, r, b, sigma) - phi(S, t1, 1.0, I1, I2, r, b, sigma) -
+                       K * phi(S, t1, 0.0, I2, I2, r, b, sigma) + K * phi(S, t1, 0.0, I1, I2, r, b, sigma) +
+                       alpha1 * phi(S, t1, beta, I1, I2, r, b, sigma) -
+                       alpha1 * psi(S, T, beta, I1, I2, I1, t1, r, b, sigma) +
+                       psi(S, T, 1.0, I1, I2, I1, t1, r, b, sigma) - psi(S, T, 1.0, K, I2, I1, t1, r, b, sigma) -
+                       K * psi(S, T, 0.0, I1, I2, I1, t1, r, b, sigma) + K * psi(S, T, 0.0, K, I2, I1, t1, r, b, sigma);
+            }
+
+            double intrinsic(double S, double K, OptionKind kind)
+            {
+                return kind == OptionKind::Call ? std::max(0.0, S - K) : std::max(0.0, K - S);
+            }
+
+            void requireApproximation(AmericanModel model)
+            {
+                if (model != AmericanModel::BaroneAdesiWhaley && model != AmericanModel::BjerksundStensland)
+                    throw std::invalid_argument(std::string(toString(model)) + " is not a closed-form model");
+            }
+
+            double evaluate(AmericanModel model, double S, double K, double r, double sigma, double T,
+                            OptionKind kind)
+            {
+                return model == AmericanModel::BaroneAdesiWhaley ? baroneAdesiWhaley(S, K, r, sigma, T, kind)
+                                                                 : bjerksundStensland(S, K, r, sigma, T, kind);
+            }
+        } // namespace
+
+        double bivariateNormal(double x, double y, double rho)
+        {
+            const double absRho = std::abs(rho);
+            const int rule = absRho < 0.3 ? 0 : absRho < 0.75 ? 1 : 2;
+            const int points = rule == 0 ? 3 : rule == 1 ? 6 : 10;
+            const double *xs = LegendreX[rule];
+            const double *ws = LegendreW[rule];
+
+            double h = -x;
+            double k = -y;
+            double hk = h * k;
+            double bvn = 0.0;
+
+            if (absRho < 0.925)
+            {
+                // Integrate the density along rho' in [0, rho] (Drezner-Wesolowsky form)
+                if (absRho > 0.0)
+                {
+                    const double hs = (h * h + k * k) / 2.0;
+                    const double asr = std::asin(rho);
+                    for (int i = 0; i < points; ++i)
+                    {
+                        for (double side : {-1.0, 1.0})
+                        {
+                            const double sn = std::sin(asr * (side * xs[i] + 1.0) / 2.0);
+                            bvn += ws[i] * std::exp((sn * hk - hs) / (1.0 - sn * sn));
+                        }
+                    }
+                    bvn *= asr / (4.0 * Pi);
+                }
+                return bvn + N(-h) * N(-k);
+            }
+
+            // Near |rho| = 1: integrate the deviation from the degenerate distribution
+            if (rho < 0.0)
+            {
+                k = -k;
+                hk = -hk;
+            }
+            if (absRho < 1.0)
+            {
+                const double as = (1.0 - rho) * (1.0 + rho);
+                double a = std::sqrt(as);
+                const double bs = (h - k) * (h - k);
+                const double c = (4.0 - hk) / 8.0;
+                const double d = (12.0 - hk) / 16.0;
+                double asr = -(bs / as + hk) / 2.0;
+                if (asr > -100.0)
+                    bvn = a * std::exp(asr) * (1.0 - c * (bs - as) * (1.0 - d * bs / 5.0) / 3.0 + c * d * as * as / 5.0);
+                if (-hk < 100.0)
+                {
+                    const double b = std::sqrt(bs);
+                    bvn -= std::exp(-hk / 2.0) * std::sqrt(2.0 * Pi) * N(-b / a) * b *
+                           (1.0 - c * bs * (1.0 - d * bs / 5.0) / 3.0);
+                }
+                a /= 2.0;
+                for (int i = 0; i < points; ++i)
+                {
+                    for (double side : {-1.0, 1.0})
+                    {
+                        const double xsq = (a * (side * xs[i] + 1.0)) * (a * (side * xs[i] + 1.0));
+                        const double rs = std::sqrt(1.0 - xsq);
+                        asr = -(bs / xsq + hk) / 2.0;
+                        if (asr > -100.0)
+                            bvn += a * ws[i] * std::exp(asr) *
+                                   (std::exp(-hk * (1.0 - rs) / (2.0 * (1.0 + rs))) / rs - (1.0 + c * xsq * (1.0 + d * xsq)));
+                    }
+                }
+                bvn = -bvn / (2.0 * Pi);
+            }
+            if (rho > 0.0)
+                return bvn + N(-std::max(h, k));
+            bvn = -bvn;
+            if (k > h)
+                bvn += N(k) - N(h);
+            return bvn;
+        }
+
+        double baroneAdesiWhaley(double S, double K, double r, double sigma, double T, OptionKind kind)
+        {
+            Metrics::recordAnalytic();
+            if (T <= 0.0)
+                return intrinsic(S, K, kind);
+            if (kind == OptionKind::Call || r <= 0.0)
+                return kind == OptionKind::Call ? BlackScholes::callPrice(S, K, r, sigma, T)
+                                                : BlackScholes::putPrice(S, K, r, sigma, T);
+            return bawPut(S, K, r, sigma, T, quadraticPut(K, r, sigma, T));
+        }
+
+        double bjerksundStensland(double S, double K, double r, double sigma, double T, OptionKind kind)
+        {
+            Metrics::recordAnalytic();
+            if (T <= 0.0)
+                return intrinsic(S, K, kind);
+            if (kind == OptionKind::Call)
+                return bjsCall(S, K, T, r, r, sigma);
+            return bjsCall(K, S, T, 0.0, -r, sigma); // put-call transformation with b = r
+        }
+
+        double price(AmericanModel model, double S, double K, double r, double sigma, double T, OptionKind kind)
+        {
+            requireApproximation(model);
+            return evaluate(model, S, K, r, sigma, T, kind);
+        }
+
+        OptionGreeks greeks(AmericanModel model, double S, double K, double r, double sigma, double T,
+                            OptionKind kind)
+        {
+            requireApproximation(model);
+            if (T <= 0.0)
+            {
+                const bool inMoney = kind == OptionKind::Call ? S > K : S < K;
+                return {intrinsic(S, K, kind), inMoney ? (kind == OptionKind::Call ? 1.0 : -1.0) : 0.0, 0.0, 0.0, 0.0, 0.0};
+            }
+            if (kind == OptionKind::Call)
+            {
+                // Both reduce to Black-Scholes without dividends
+                Metrics::recordAnalytic();
+                return BlackScholes::priceAndGreeks(S, K, r, sigma, T, kind);
+            }
+
+            auto at = [&](double spot, double rate, double vol, double time)
+            { return evaluate(model, spot, K, rate, vol, time, kind); };
+
+            OptionGreeks g;
+            if (model == AmericanModel::BaroneAdesiWhaley && r > 0.0)
+            {
+                // Inside the continuation region the premium is a (S / S*)^q
+                const QuadraticPut quad = quadraticPut(K, r, sigma, T);
+                Metrics::recordAnalytic();
+                g.price = bawPut(S, K, r, sigma, T, quad);
+                if (S <= quad.critical)
+                {
+                    g.delta = -1.0;
+                    g.gamma = 0.0;
+                }
+                else
+                {
+                    const double premium = quad.a * std::pow(S / quad.critical, quad.q);
+                    g.delta = BlackScholes::delta(S, K, r, sigma, T, kind) + premium * quad.q / S;
+                    g.gamma = BlackScholes::gamma(S, K, r, sigma, T) + premium * quad.q * (quad.q - 1.0) / (S * S);
+                }
+            }
+            else
+            {
+                const double h = 1e-3 * S;
+                const double up = at(S + h, r, sigma, T);
+                const double down = at(S - h, r, sigma, T);
+                g.price = at(S, r, sigma, T);
+                g.delta = (up - down) / (2.0 * h);
+                g.gamma = (up - 2.0 * g.price + down) / (h * h);
+            }
+
+            const double dv = 1e-4;
+            const double dr = 1e-4;
+            const double dt = std::min(1e-4, 0.5 * T);
+            g.vega = (at(S, r, sigma + dv, T) - at(S, r, sigma - dv, T)) / (2.0 * dv);
+            g.rho = (at(S, r + dr, sigma, T) - at(S, r - dr, sigma, T)) / (2.0 * dr);
+            g.theta = -(at(S, r, sigma, T + dt) - at(S, r, sigma, T - dt)) / (2.0 * dt);
+            return g;
+        }
+
+    } // namespace AmericanApprox
+} // namespace OptionPricer
@@ -0,0 +1,895 @@
+#include "models/BinomialTree.h"
+#include "BinomialTreeDetail.h"
+#include "models/BlackScholes.h"
+#include "metrics/Metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace OptionPricer
+{
+    namespace BinomialTree
+    {
+
+        namespace
+        {
+            /**
+             * Per-thread scratch space reused across pricings.
+             *
+             * Spot level q (q = 0..2*steps) is S * u^(steps - q). Its exercise
+             * value is stored in exercise[q & 1][q >> 1], which makes the nodes
+             * of one tree level contiguous: node j of level i lives at
+             * exercise[(steps - i) & 1][((steps - i) >> 1) + j]. The trinomial
+             * tree, whose levels use every spot level, keeps them all in order
+             * in exercise[0] instead.
+             */
+            struct Workspace
+            {
+                std::vector<double> values;
+                std::vector<double> exercise[2];
+                std::vector<double> up, down; // u^k, d^k for Leisen-Reimer
+                // americanSensitivities: the recorded levels (see Tape), levels
+                // rebuilt between checkpoints, node adjoints of two levels,
+                // continuation adjoints, per-column probability sums and one
+                // row of exercise values
+                std::vector<double> tape;
+                std::vector<double> segment;
+                std::vector<double> adjoint[2];
+                std::vector<double> held;
+                std::vector<double> sums[3];
+                std::vector<double> row;
+            };
+
+            Workspace &workspace()
+            {
+                thread_local Workspace ws;
+                return ws;
+            }
+
+            void buildExerciseLadder(Workspace &ws, double S, double K, double u, bool isCall, int n)
+            {
+                ws.exercise[0].resize(n + 1);
+                ws.exercise[1].resize(n);
+
+                // Walk outward from the root spot so rounding grows with |k|, not 2n
+                const double d = 1.0 / u;
+                double up = S;
+                double down = S;
+                for (int k = 0; k <= n; ++k)
+                {
+                    const int qUp = n - k;
+                    const int qDown = n + k;
+                    const double exUp = isCall ? std::max(0.0, up - K) : std::max(0.0, K - up);
+                    const double exDown = isCall ? std::max(0.0, down - K) : std::max(0.0, K - down);
+                    ws.exercise[qUp & 1][qUp >> 1] = exUp;
+                    ws.exercise[qDown & 1][qDown >> 1] = exDown;
+                    up *= u;
+                    down *= d;
+                }
+            }
+
+            // A tape over the workspace's storage, with room for a TapeReader's segment
+            Tape recordingTape(Workspace &ws, int leaves, std::size_t width)
+            {
+                ws.tape.resize(Tape::values(leaves, width));
+                const Tape tape(ws.tape.data(), leaves, width);
+                ws.segment.resize(tape.segmentValues());
+                return tape;
+            }
+
+            // Node values of levels 1 and 2 go to early[0..1] and early[2..4]
+            inline void capture(double *early, int level, const double *v)
+            {
+                if (early && level == 2)
+                    std::copy(v, v + 3, early + 2);
+                else if (early && level == 1)
+                    std::copy(v, v + 2, early);
+            }
+
+            // Level i of a CRR tree from level i + 1, in place
+            inline void crrLevel(double *v, const double *ex, int i, double pu, double pd)
+            {
+                for (int j = 0; j <= i; ++j)
+                {
+                    // American option: max of holding and exercising
+                    const double hold = pu * v[j] + pd * v[j + 1];
+                    v[j] = hold > ex[j] ? hold : ex[j];
+                }
+            }
+
+            // Exercise values of level i of a n-step CRR tree (see Workspace)
+            inline const double *crrExercise(const Workspace &ws, int n, int i)
+            {
+                return ws.exercise[(n - i) & 1].data() + ((n - i) >> 1);
+            }
+
+            // count nodes from spot down by factor step, each the larger of its one-step value and exercise
+            template <OptionKind Kind>
+            void blackScholesLevel(double *v, const double *ex, double spot, double step, double K, double r,
+                                   double sigma, double dt, int count)
+            {
+                for (int j = 0; j < count; ++j, spot *= step)
+                {
+                    const double european = BlackScholes::price<Kind>(spot, K, r, sigma, dt);
+                    v[j] = european > ex[j] ? european : ex[j];
+                }
+            }
+
+            /**
+             * Backward induction over a n-step CRR tree. With blackScholesLast
+             * the nodes one step from expiry take the Black-Scholes value of
+             * that last step instead of a one-step tree (the "BBS" lattice).
+             */
+            double induct(double S, double K, double r, double sigma, double T,
+                          bool isCall, int n, double *early, bool blackScholesLast = false,
+                          const Tape *tape = nullptr)
+            {
+                const double dt = T / n;
+                const double u = std::exp(sigma * std::sqrt(dt));
+                const double d = 1.0 / u;
+                const double p = (std::exp(r * dt) - d) / (u - d);
+                const double disc = std::exp(-r * dt);
+                const double pu = disc * p;
+                const double pd = disc * (1.0 - p);
+
+                Metrics::recordLattice(n);
+                Workspace &ws = workspace();
+                buildExerciseLadder(ws, S, K, u, isCall, n);
+
+                // Terminal nodes: level n, node j sits on spot level q = 2j
+                ws.values.assign(ws.exercise[0].begin(), ws.exercise[0].begin() + n + 1);
+                double *v = ws.values.data();
+                capture(early, n, v);
+                record(tape, n, v, n + 1);
+
+                int top = n - 1;
+                if (blackScholesLast)
+                {
+                    // Level n-1, node j: spot S * u^(n-1-2j), exercise values on odd spot levels
+                    if (isCall)
+                        blackScholesLevel<OptionKind::Call>(v, ws.exercise[1].data(), S * std::pow(u, n - 1), d * d,
+                                                            K, r, sigma, dt, n);
+                    else
+                        blackScholesLevel<OptionKind::Put>(v, ws.exercise[1].data(), S * std::pow(u, n - 1), d * d,
+                                                           K, r, sigma, dt, n);
+                    capture(early, top, v);
+                    record(tape, top, v, top + 1);
+                    --top;
+                }
+
+                for (int i = top; i >= 0; --i)
+                {
+                    crrLevel(v, crrExercise(ws, n, i), i, pu, pd);
+                    capture(early, i, v);
+                    record(tape, i, v, i + 1);
+                }
+
+                return v[0];
+            }
+
+            // Peizer-Pratt method 2 inversion: binomial probability matching N(z) on n steps
+            double peizerPratt(double z, int n)
+            {
+                const double t = z / (n + 1.0 / 3.0 + 0.1 / (n + 1.0));
+                const double root = 0.5 * std::sqrt(1.0 - std::exp(-t * t * (n + 1.0 / 6.0)));
+                return z < 0.0 ? 0.5 - root : 0.5 + root;
+            }
+
+            struct LeisenReimerTree
+            {
+                double u, d, p;
+            };
+
+            LeisenReimerTree leisenReimer(double S, double K, double r, double sigma, double T, int n)
+            {
+                const double volRoot = sigma * std::sqrt(T);
+                const double d1 = (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / volRoot;
+                const double d2 = d1 - volRoot;
+                const double growth = std::exp(r * T / n);
+                const double p = peizerPratt(d2, n);
+                const double u = growth * peizerPratt(d1, n) / p;
+                return {u, (growth - p * u) / (1.0 - p), p};
+            }
+
+            // Level i of a Leisen-Reimer tree from level i + 1, in place (spots from the power tables)
+            inline void leisenReimerLevel(double *v, const double *up, const double *down, double K, double sign,
+                                          int i, double pu, double pd)
+            {
+                for (int j = 0; j <= i; ++j)
+                {
+                    const double hold = pu * v[j] + pd * v[j + 1];
+                    const double exercise = sign * (up[i - j] * down[j] - K);
+                    v[j] = hold > exercise ? hold : exercise;
+                }
+            }
+
+            /**
+             * Backward induction over a n-step Leisen-Reimer tree. u * d != 1,
+             * so node (i, j) sits at S * u^(i-j) * d^j and spots come from
+             * tables of powers rather than the shared ladder.
+             */
+            double inductLeisenReimer(double S, double K, double r, double sigma, double T,
+                                      bool isCall, int n, double *early, const Tape *tape = nullptr)
+            {
+                const LeisenReimerTree tree = leisenReimer(S, K, r, sigma, T, n);
+                const double disc = std::exp(-r * T / n);
+                const double pu = disc * tree.p;
+                const double pd = disc * (1.0 - tree.p);
+                const double sign = isCall ? 1.0 : -1.0;
+
+                Metrics::recordLattice(n);
+                Workspace &ws = workspace();
+                ws.up.resize(n + 1);
+                ws.down.resize(n + 1);
+                ws.up[0] = S;
+                ws.down[0] = 1.0;
+                for (int k = 1; k <= n; ++k)
+                {
+                    ws.up[k] = ws.up[k - 1] * tree.u;
+                    ws.down[k] = ws.down[k - 1] * tree.d;
+                }
+                const double *up = ws.up.data();
+                const double *down = ws.down.data();
+
+                ws.values.resize(n + 1);
+                double *v = ws.values.data();
+                for (int j = 0; j <= n; ++j)
+                    v[j] = std::max(0.0, sign * (up[n - j] * down[j] - K));
+                capture(early, n, v);
+                record(tape, n, v, n + 1);
+
+                for (int i = n - 1; i >= 0; --i)
+                {
+                    leisenReimerLevel(v, up, down, K, sign, i, pu, pd);
+                    capture(early, i, v);
+                    record(tape, i, v, i + 1);
+                }
+
+                return v[0];
+            }
+
+            // Level i of a trinomial tree from level i + 1, in place
+            inline void trinomialLevel(double *v, const double *ex, int i, double pu, double pm, double pd)
+            {
+                for (int j = 0; j <= 2 * i; ++j)
+                {
+                    const double hold = pu * v[j] + pm * v[j + 1] + pd * v[j + 2];
+                    v[j] = hold > ex[j] ? hold : ex[j];
+                }
+            }
+
+            /**
+             * Backward induction over a n-step trinomial tree with spacing
+             * sigma * sqrt(3 dt). Level i holds spot levels q = n-i..n+i, so
+             * node j of level i has children j, j+1, j+2 of level i+1. When
+             * early is non-null the three nodes of level 1 go to early[0..2].
+             */
+            double inductTrinomial(double S, double K, double r, double sigma, double T,
+                                   bool isCall, int n, double *early, const Tape *tape = nullptr)
+            {
+                const double dt = T / n;
+                const double dx = sigma * std::sqrt(3.0 * dt);
+                const double u = std::exp(dx);
+                const double nu = r - 0.5 * sigma * sigma;
+                const double spread = (sigma * sigma * dt + nu * nu * dt * dt) / (dx * dx);
+                const double drift = nu * dt / dx;
+                const double disc = std::exp(-r * dt);
+                const double pu = disc * 0.5 * (spread + drift);
+                const double pm = disc * (1.0 - spread);
+                const double pd = disc * 0.5 * (spread - drift);
+
+                Metrics::recordLattice(n);
+                Workspace &ws = workspace();
+                std::vector<double> &ladder = ws.exercise[0];
+                ladder.resize(2 * n + 1);
+                double upSpot = S;
+                double downSpot = S;
+                for (int k = 0; k <= n; ++k)
+                {
+                    ladder[n - k] = isCall ? std::max(0.0, upSpot - K) : std::max(0.0, K - upSpot);
+                    ladder[n + k] = isCall ? std::max(0.0, downSpot - K) : std::max(0.0, K - downSpot);
+                    upSpot *= u;
+                    downSpot /= u;
+                }
+
+                ws.values.assign(ladder.begin(), ladder.end());
+                double *v = ws.values.data();
+                record(tape, n, v, 2 * n + 1);
+                for (int i = n - 1; i >= 0; --i)
+                {
+                    trinomialLevel(v, ladder.data() + (n - i), i, pu, pm, pd);
+                    if (early && i == 1)
+                        std::copy(v, v + 3, early);
+                    record(tape, i, v, 2 * i + 1);
+                }
+
+                return v[0];
+            }
+
+            /**
+             * Greeks from the nodes of levels 1 and 2 of a binomial tree with
+             * factors u and d. The middle node of level 2 sits at S * u * d,
+             * which is S only for CRR, so theta removes the delta and gamma
+             * of that small spot move.
+             */
+            LatticeResult binomialGreeks(double price, const double *early, double S, double u, double d,
+                                         double dt)
+            {
+                const double Su = S * u, Sd = S * d;
+                const double Suu = Su * u, Sud = Su * d, Sdd = Sd * d;
+
+                LatticeResult result;
+                result.price = price;
+                result.delta = (early[0] - early[1]) / (Su - Sd);
+
+                const double deltaUp = (early[2] - early[3]) / (Suu - Sud);
+                const double deltaDown = (early[3] - early[4]) / (Sud - Sdd);
+                result.gamma = (deltaUp - deltaDown) / (0.5 * (Suu - Sdd));
+
+                const double move = Sud - S;
+                result.theta = (early[3] - price - result.delta * move - 0.5 * result.gamma * move * move) /
+                               (2.0 * dt);
+                return result;
+            }
+
+            LatticeResult crrLattice(double S, double K, double r, double sigma, double T, bool isCall, int n,
+                                     bool blackScholesLast)
+            {
+                const double dt = T / n;
+                const double u = std::exp(sigma * std::sqrt(dt));
+                double early[5]; // {V(1,0), V(1,1), V(2,0), V(2,1), V(2,2)}
+                const double price = induct(S, K, r, sigma, T, isCall, n, early, blackScholesLast);
+                return binomialGreeks(price, early, S, u, 1.0 / u, dt);
+            }
+
+            // Greeks from the three nodes of level 1 of a trinomial tree with factor u
+            LatticeResult trinomialGreeks(double price, const double *early, double S, double u, double dt)
+            {
+                const double Su = S * u, Sd = S / u;
+
+                LatticeResult result;
+                result.price = price;
+                result.delta = (early[0] - early[2]) / (Su - Sd);
+                result.gamma = ((early[0] - early[1]) / (Su - S) - (early[1] - early[2]) / (S - Sd)) /
+                               (0.5 * (Su - Sd));
+                result.theta = (early[1] - price) / dt;
+                return result;
+            }
+
+            using detail::BinomialBars;
+
+            /**
+             * Reverse sweep over the levels induct or inductLeisenReimer
+             * recorded, read through levels (a TapeReader); exerciseRow(i)
+             * gives the exercise values the forward pass compared level i
+             * against. Node (i, j) sits at
+             * S * U^(i-j) * D^j; it continued if its value beats exercise and
+             * was exercised otherwise, which moves it only in the money.
+             * Adjoints start at 1 on the root and stop at level `leaves`: n, or
+             * n - 1 when those nodes are Black-Scholes values over one step of
+             * length dt.
+             *
+             * Only the span of nodes reachable from the root is swept, which
+             * skips the exercise region. Within it the probability adjoints are
+             * summed per column and totalled at the end, and each child gathers
+             * from its two parents, so the main loops carry no dependency from
+             * node to node. Exercised nodes (along the boundary) and leaves take
+             * the scalar path.
+             */
+            template <class Levels, class ExerciseRow>
+            BinomialBars reverseBinomial(Levels &levels, std::size_t width, int leaves, bool blackScholesLeaves,
+                                         double S, double K, double U, double D, double pu, double pd, double r,
+                                         double sigma, double dt, OptionKind kind, ExerciseRow exerciseRow)
+            {
+                Workspace &ws = workspace();
+                ws.adjoint[0].resize(leaves + 2);
+                ws.adjoint[1].resize(leaves + 2);
+                ws.held.resize(leaves + 1);
+                ws.sums[0].assign(leaves + 1, 0.0);
+                ws.sums[1].assign(leaves + 1, 0.0);
+                double *bar = ws.adjoint[0].data();
+                double *next = ws.adjoint[1].data();
+                double *held = ws.held.data();
+                double *sumPu = ws.sums[0].data();
+                double *sumPd = ws.sums[1].data();
+
+                const double sign = kind == OptionKind::Call ? 1.0 : -1.0;
+                BinomialBars out{};
+                const auto spotBar = [&](double b, double spot, int i, int j)
+                {
+                    out.spot += b * spot / S;
+                    out.up += b * (i - j) * spot / U;
+                    out.down += b * j * spot / D;
+                };
+                // Adjoint b reaching node (i, j), which did not continue
+                const auto stop = [&](double b, double ex, double value, int i, int j)
+                {
+                    if (blackScholesLeaves && value > ex)
+                    {
+                        const double spot = S * std::pow(U, i - j) * std::pow(D, j);
+                        const OptionGreeks g = BlackScholes::priceAndGreeks(spot, K, r, sigma, dt, kind);
+                        spotBar(b * g.delta, spot, i, j);
+                        out.strike += b * (g.price - spot * g.delta) / K; // homogeneous of degree 1 in (S, K)
+                        out.rate += b * g.rho;
+                        out.sigma += b * g.vega;
+                        out.dt -= b * g.theta;
+                    }
+                    else if (ex > 0.0)
+                    {
+                        spotBar(sign * b, K + sign * ex, i, j);
+                        out.strike -= sign * b;
+                    }
+                };
+
+                // Nodes first..last of the current level may carry adjoint
+                bar[0] = 1.0;
+                int first = 0, last = 0;
+                for (int i = 0; i <= leaves && first <= last; ++i)
+                {
+                    const double *v = levels.level(i);
+                    const double *ex = exerciseRow(i);
+                    if (i == leaves)
+                    {
+                        for (int j = first; j <= last; ++j)
+                            if (bar[j] != 0.0)
+                                stop(bar[j], ex[j], v[j], i, j);
+                        break;
+                    }
+
+                    const double *child = v + width;
+                    const double *adjoint = bar;
+                    for (int j = first; j <= last; ++j)
+                    {
+                        const double b = adjoint[j];
+                        held[j] = v[j] > ex[j] ? b : 0.0;
+                    }
+                    for (int j = first; j <= last; ++j)
+                    {
+                        const double h = held[j];
+                        sumPu[j] += h * child[j];
+                        sumPd[j] += h * child[j + 1];
+                    }
+
+                    int nextFirst = last + 1, nextLast = first - 1;
+                    for (int j = first; j <= last; ++j)
+                    {
+                        if (held[j] != 0.0)
+                        {
+                            nextFirst = std::min(nextFirst, j);
+                            nextLast = j;
+                        }
+                        else if (adjoint[j] != 0.0)
+                        {
+                            stop(adjoint[j], ex[j], v[j], i, j);
+                        }
+                    }
+                    if (nextFirst > nextLast)
+                        break;
+
+                    next[nextFirst] = pu * held[nextFirst];
+                    for (int j = nextFirst + 1; j <= nextLast; ++j)
+                        next[j] = pu * held[j] + pd * held[j - 1];
+                    next[nextLast + 1] = pd * held[nextLast];
+                    first = nextFirst;
+                    last = nextLast + 1;
+                    std::swap(bar, next);
+                }
+                for (int j = 0; j <= leaves; ++j)
+                {
+                    out.pu += sumPu[j];
+                    out.pd += sumPd[j];
+                }
+                return out;
+            }
+
+            /**
+             * CRR tree (BBS with blackScholesLast) with adjoint sensitivities:
+             * U = exp(sigma sqrt(dt)), D = 1 / U, p = (exp(r dt) - D) / (U - D),
+             * discount exp(-r dt)
+             */
+            LatticeSensitivities crrSensitivities(double S, double K, double r, double sigma, double T,
+                                                  OptionKind kind, int n, bool blackScholesLast)
+            {
+                const double dt = T / n;
+                const double sqrtDt = std::sqrt(dt);
+                const double u = std::exp(sigma * sqrtDt);
+                const double d = 1.0 / u;
+                const double growth = std::exp(r * dt);
+                const double p = (growth - d) / (u - d);
+                const double disc = std::exp(-r * dt);
+
+                const double pu = disc * p;
+                const double pd = disc * (1.0 - p);
+                const int leaves = blackScholesLast ? n - 1 : n;
+
+                Workspace &ws = workspace();
+                const Tape tape = recordingTape(ws, leaves, n + 1);
+                detail::CrrPass pass;
+                pass.price = induct(S, K, r, sigma, T, kind == OptionKind::Call, n, pass.early, blackScholesLast, &tape);
+                auto levels = readTape(tape, ws.segment.data(), 1, 1, [&](int i, double *v)
+                                       { crrLevel(v, crrExercise(ws, n, i), i, pu, pd); });
+                pass.bars = reverseBinomial(levels, tape.width, leaves, blackScholesLast, S, K, u, d, pu, pd, r, sigma,
+                                            dt, kind, [&](int i)
+                                            { return crrExercise(ws, n, i); });
+                return detail::crrSensitivitiesFrom(pass, S, r, sigma, T, n);
+            }
+
+            // dp/dz of peizerPratt
+            double peizerPrattSlope(double z, int n)
+            {
+                const double scale = n + 1.0 / 3.0 + 0.1 / (n + 1.0);
+                const double a = n + 1.0 / 6.0;
+                const double t = z / scale;
+                const double tail = -std::expm1(-t * t * a); // 1 - exp(-t^2 a)
+                if (tail <= 0.0)
+                    return 0.5 * std::sqrt(a) / scale;
+                return 0.5 * std::exp(-t * t * a) * std::abs(t) * a / std::sqrt(tail) / scale;
+            }
+
+            /**
+             * Leisen-Reimer tree with adjoint sensitivities. Its u, d and p
+             * depend on every input through d1 and d2, so spot and strike
+             * move the tree as well as the payoffs.
+             */
+            LatticeSensitivities leisenReimerSensitivities(double S, double K, double r, double sigma, double T,
+                                                           OptionKind kind, int n)
+            {
+                const bool isCall = kind == OptionKind::Call;
+                const LeisenReimerTree tree = leisenReimer(S, K, r, sigma, T, n);
+                const double dt = T / n;
+                const double growth = std::exp(r * T / n);
+                const double disc = std::exp(-r * T / n);
+                const double p = tree.p;
+
+                const double pu = disc * p;
+                const double pd = disc * (1.0 - p);
+
+                Workspace &ws = workspace();
+                const Tape tape = recordingTape(ws, n, n + 1);
+                double early[5];
+                const double price = inductLeisenReimer(S, K, r, sigma, T, isCall, n, early, &tape);
+                const double sign = isCall ? 1.0 : -1.0;
+                ws.row.resize(n + 1);
+                auto levels = readTape(tape, ws.segment.data(), 1, 1, [&](int i, double *v)
+                                       { leisenReimerLevel(v, ws.up.data(), ws.down.data(), K, sign, i, pu, pd); });
+                const BinomialBars bar = reverseBinomial(
+                    levels, tape.width, n, false, S, K, tree.u, tree.d, pu, pd, r, sigma, dt, kind, [&](int i)
+                    {
+                        // The same expression as inductLeisenReimer, so every node takes the same branch
+                        for (int j = 0; j <= i; ++j)
+                            ws.row[j] = sign * (ws.up[i - j] * ws.down[j] - K);
+                        return ws.row.data(); });
+
+                // D = (growth - p U) / (1 - p), U = growth p1 / p with p = PP(d2), p1 = PP(d1)
+                const double volRoot = sigma * std::sqrt(T);
+                const double d1 = (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / volRoot;
+                const double p1 = peizerPratt(d1, n);
+                const double barU = bar.up - bar.down * p / (1.0 - p);
+                const double barGrowth = bar.down / (1.0 - p) + barU * p1 / p;
+                const double barP = disc * (bar.pu - bar.pd) + bar.down * (growth - tree.u) / ((1.0 - p) * (1.0 - p)) -
+                                    barU * growth * p1 / (p * p);
+                const double barDisc = p * bar.pu + (1.0 - p) * bar.pd;
+                const double barD2 = barP * peizerPrattSlope(d1 - volRoot, n);
+                const double barD1 = barU * growth / p * peizerPrattSlope(d1, n) + barD2;
+
+                // d1 = (log(S / K) + (r + sigma^2 / 2) T) / volRoot, d2 = d1 - volRoot
+                const double barLog = barD1 / volRoot;
+                const double barVolRoot = -barD1 * d1 / volRoot - barD2;
+                const double barRateStep = barGrowth * growth - barDisc * disc; // r T / n
+
+                LatticeSensitivities out;
+                out.lattice = binomialGreeks(price, early, S, tree.u, tree.d, dt);
+                out.dSpot = bar.spot + barLog / S;
+                out.dStrike = bar.strike - barLog / K;
+                out.dRate = barLog * T + barRateStep * dt;
+                out.dSigma = barLog * sigma * T + barVolRoot * std::sqrt(T);
+                out.dTime = barLog * (r + 0.5 * sigma * sigma) + barVolRoot * sigma / (2.0 * std::sqrt(T)) +
+                            barRateStep * r / n;
+                return out;
+            }
+
+            /**
+             * Trinomial tree with adjoint sensitivities. The sweep is the
+             * binomial one with three children per node, j of level i at
+             * S u^(i-j), and the chain runs through dx = sigma sqrt(3 dt) and
+             * the moment-matched probabilities of inductTrinomial.
+             */
+            LatticeSensitivities trinomialSensitivities(double S, double K, double r, double sigma, double T,
+                                                        OptionKind kind, int n)
+            {
+                const bool isCall = kind == OptionKind::Call;
+                const double dt = T / n;
+                const double dx = sigma * std::sqrt(3.0 * dt);
+                const double u = std::exp(dx);
+                const double nu = r - 0.5 * sigma * sigma;
+                const double spread = (sigma * sigma * dt + nu * nu * dt * dt) / (dx * dx);
+                const double drift = nu * dt / dx;
+                const double disc = std::exp(-r * dt);
+                const double pu = disc * 0.5 * (spread + drift);
+                const double pm = disc * (1.0 - spread);
+                const double pd = disc * 0.5 * (spread - drift);
+
+                Workspace &ws = workspace();
+                const int width = 2 * n + 1;
+                const Tape tape = recordingTape(ws, n, width);
+                double early[3];
+                const double price = inductTrinomial(S, K, r, sigma, T, isCall, n, early, &tape);
+
+                // The binomial sweep with three children per node; j of level i sits at S u^(i-j)
+                auto levels = readTape(tape, ws.segment.data(), 2, 1, [&](int i, double *v)
+                                       { trinomialLevel(v, ws.exercise[0].data() + (n - i), i, pu, pm, pd); });
+                ws.adjoint[0].resize(width + 2);
+                ws.adjoint[1].resize(width + 2);
+                ws.held.resize(width);
+                for (std::vector<double> &sum : ws.sums)
+                    sum.assign(width, 0.0);
+                double *bar = ws.adjoint[0].data();
+                double *next = ws.adjoint[1].data();
+                double *held = ws.held.data();
+                double *sumPu = ws.sums[0].data();
+                double *sumPm = ws.sums[1].data();
+                double *sumPd = ws.sums[2].data();
+
+                const double sign = isCall ? 1.0 : -1.0;
+                double barSpot = 0.0, barStrike = 0.0, barU = 0.0;
+                const auto stop = [&](double b, double ex, int i, int j)
+                {
+                    if (ex <= 0.0)
+                        return;
+                    const double spot = K + sign * ex;
+                    barSpot += sign * b * spot / S;
+                    barU += sign * b * (i - j) * spot / u;
+                    barStrike -= sign * b;
+                };
+
+                bar[0] = 1.0;
+                int first = 0, last = 0;
+                for (int i = 0; i <= n && first <= last; ++i)
+                {
+                    const double *v = levels.level(i);
+                    const double *ex = ws.exercise[0].data() + (n - i);
+                    if (i == n)
+                    {
+                        for (int j = first; j <= last; ++j)
+                            if (bar[j] != 0.0)
+                                stop(bar[j], ex[j], i, j);
+                        break;
+                    }
+
+                    const double *child = v + width;
+                    const double *adjoint = bar;
+                    for (int j = first; j <= last; ++j)
+                    {
+                        const double b = adjoint[j];
+                        held[j] = v[j] > ex[j] ? b : 0.0;
+                    }
+                    for (int j = first; j <= last; ++j)
+                    {
+                        const double h = held[j];
+                        sumPu[j] += h * child[j];
+                        sumPm[j] += h * child[j + 1];
+                        sumPd[j] += h * child[j + 2];
+                    }
+
+                    int nextFirst = last + 1, nextLast = first - 1;
+                    for (int j = first; j <= last; ++j)
+                    {
+                        if (held[j] != 0.0)
+                        {
+                            nextFirst = std::min(nextFirst, j);
+                            nextLast = j;
+                        }
+                        else if (adjoint[j] != 0.0)
+                        {
+                            stop(adjoint[j], ex[j], i, j);
+                        }
+                    }
+                    if (nextFirst > nextLast)
+                        break;
+
+                    // Child k gathers from parents k, k - 1 and k - 2 (held is zero outside the span)
+                    const auto parent = [&](int j)
+                    { return j >= nextFirst && j <= nextLast ? held[j] : 0.0; };
+                    for (int k = nextFirst; k <= nextLast + 2; ++k)
+                        next[k] = pu * parent(k) + pm * parent(k - 1) + pd * parent(k - 2);
+                    first = nextFirst;
+                    last = nextLast + 2;
+                    std::swap(bar, next);
+                }
+
+                double barPu = 0.0, barPm = 0.0, barPd = 0.0;
+                for (int j = 0; j < width; ++j)
+                {
+                    barPu += sumPu[j];
+                    barPm += sumPm[j];
+                    barPd += sumPd[j];
+                }
+
+                // spread = A / dx^2 with A = sigma^2 dt + nu^2 dt^2, drift = nu dt / dx
+                const double barDisc = barPu * 0.5 * (spread + drift) + barPm * (1.0 - spread) +
+                                       barPd * 0.5 * (spread - drift);
+                const double barSpread = disc * (0.5 * barPu - barPm + 0.5 * barPd);
+                const double barDrift = disc * 0.5 * (barPu - barPd);
+                const double barA = barSpread / (dx * dx);
+                const double barDx = barU * u - 2.0 * barSpread * spread / dx - barDrift * drift / dx;
+                const double barNu = barDrift * dt / dx + barA * 2.0 * nu * dt * dt;
+                const double barDt = barDrift * nu / dx + barA * (sigma * sigma + 2.0 * nu * nu * dt) +
+                                     barDx * dx / (2.0 * dt) - barDisc * disc * r;
+
+                LatticeSensitivities out;
+                out.lattice = trinomialGreeks(price, early, S, u, dt);
+                out.dSpot = barSpot;
+                out.dStrike = barStrike;
+                out.dRate = barNu - barDisc * disc * dt;
+                out.dSigma = barA * 2.0 * sigma * dt + barDx * std::sqrt(3.0 * dt) - barNu * sigma;
+                out.dTime = barDt / n;
+                return out;
+            }
+        } // namespace
+
+        namespace detail
+        {
+            LatticeSensitivities crrSensitivitiesFrom(const CrrPass &pass, double S, double r, double sigma,
+                                                      double T, int n)
+            {
+                // The tree's parameters, as induct computed them
+                const double dt = T / n;
+                const double sqrtDt = std::sqrt(dt);
+                const double u = std::exp(sigma * sqrtDt);
+                const double d = 1.0 / u;
+                const double growth = std::exp(r * dt);
+                const double p = (growth - d) / (u - d);
+                const double disc = std::exp(-r * dt);
+
+                const BinomialBars &bar = pass.bars;
+                const double width = u - d;
+                const double barP = disc * (bar.pu - bar.pd);
+                const double barDisc = p * bar.pu + (1.0 - p) * bar.pd;
+                const double barGrowth = barP / width;
+                const double barD = bar.down + barP * (growth - u) / (width * width);
+                const double barU = bar.up - barP * (growth - d) / (width * width) - barD / (u * u);
+                const double barVolStep = barU * u;                         // sigma sqrt(dt)
+                const double barRateStep = barGrowth * growth - barDisc * disc; // r dt
+
+                LatticeSensitivities out;
+                out.lattice = binomialGreeks(pass.price, pass.early, S, u, d, dt);
+                out.dSpot = bar.spot;
+                out.dStrike = bar.strike;
+                out.dRate = bar.rate + barRateStep * dt;
+                out.dSigma = bar.sigma + barVolStep * sqrtDt;
+                out.dTime = (bar.dt + barVolStep * sigma / (2.0 * sqrtDt) + barRateStep * r) / n;
+                return out;
+            }
+
+            LatticeSensitivities extrapolate(const LatticeSensitivities &full, const LatticeSensitivities &half)
+            {
+                // The Richardson combination is linear, so it applies to each derivative too
+                const auto combine = [](double a, double b)
+                { return 2.0 * a - b; };
+                return {{combine(full.lattice.price, half.lattice.price),
+                         combine(full.lattice.delta, half.lattice.delta),
+                         combine(full.lattice.gamma, half.lattice.gamma),
+                         combine(full.lattice.theta, half.lattice.theta)},
+                        combine(full.dSpot, half.dSpot),
+                        combine(full.dStrike, half.dStrike),
+                        combine(full.dRate, half.dRate),
+                        combine(full.dSigma, half.dSigma),
+                        combine(full.dTime, half.dTime)};
+            }
+
+            int latticeSteps(int steps, AmericanModel scheme)
+            {
+                const int n = std::max(2, steps);
+                switch (scheme)
+                {
+                case AmericanModel::LeisenReimer:
+                    return std::max(3, n | 1);
+                case AmericanModel::BBSR:
+                    return std::max(4, n + (n & 1));
+                default:
+                    return n;
+                }
+            }
+        } // namespace detail
+
+        double americanPrice(double S, double K, double r, double sigma, double T,
+                             OptionKind kind, int steps, AmericanModel scheme)
+        {
+            const bool isCall = kind == OptionKind::Call;
+            if (T <= 0.0)
+                return isCall ? std::max(0.0, S - K) : std::max(0.0, K - S);
+
+            if (!isLattice(scheme))
+                throw std::invalid_argument(std::string(toString(scheme)) + " is not a lattice model");
+
+            const int n = detail::latticeSteps(steps, scheme);
+            switch (scheme)
+            {
+            case AmericanModel::LeisenReimer:
+                return inductLeisenReimer(S, K, r, sigma, T, isCall, n, nullptr);
+            case AmericanModel::BBSR:
+                // Richardson: the BBS error is ~c/n, so 2 V(n) - V(n/2) cancels it
+                return 2.0 * induct(S, K, r, sigma, T, isCall, n, nullptr, true) -
+                       induct(S, K, r, sigma, T, isCall, n / 2, nullptr, true);
+            case AmericanModel::Trinomial:
+                return inductTrinomial(S, K, r, sigma, T, isCall, n, nullptr);
+            default:
+                return induct(S, K, r, sigma, T, isCall, n, nullptr);
+            }
+        }
+
+        LatticeResult americanLattice(double S, double K, double r, double sigma, double T,
+                                      OptionKind kind, int steps, AmericanModel scheme)
+        {
+            const bool isCall = kind == OptionKind::Call;
+            if (T <= 0.0)
+            {
+                double intrinsic = isCall ? std::max(0.0, S - K) : std::max(0.0, K - S);
+                double delta = (isCall ? S > K : S < K) ? (isCall ? 1.0 : -1.0) : 0.0;
+                return {intrinsic, delta, 0.0, 0.0};
+            }
+
+            if (!isLattice(scheme))
+                throw std::invalid_argument(std::string(toString(scheme)) + " is not a lattice model");
+
+            const int n = detail::latticeSteps(steps, scheme);
+            switch (scheme)
+            {
+            case AmericanModel::LeisenReimer:
+            {
+                const LeisenReimerTree tree = leisenReimer(S, K, r, sigma, T, n);
+                double early[5];
+                const double price = inductLeisenReimer(S, K, r, sigma, T, isCall, n, early);
+                return binomialGreeks(price, early, S, tree.u, tree.d, T / n);
+            }
+            case AmericanModel::BBSR:
+            {
+                const LatticeResult full = crrLattice(S, K, r, sigma, T, isCall, n, true);
+                const LatticeResult half = crrLattice(S, K, r, sigma, T, isCall, n / 2, true);
+                return {2.0 * full.price - half.price, 2.0 * full.delta - half.delta,
+                        2.0 * full.gamma - half.gamma, 2.0 * full.theta - half.theta};
+            }
+            case AmericanModel::Trinomial:
+            {
+                const double dt = T / n;
+                double early[3]; // level 1: {V(Su), V(S), V(Sd)}
+                const double price = inductTrinomial(S, K, r, sigma, T, isCall, n, early);
+                return trinomialGreeks(price, early, S, std::exp(sigma * std::sqrt(3.0 * dt)), dt);
+            }
+            default:
+                return crrLattice(S, K, r, sigma, T, isCall, n, false);
+            }
+        }
+
+        LatticeSensitivities americanSensitivities(double S, double K, double r, double sigma, double T,
+                                                   OptionKind kind, int steps, AmericanModel scheme)
+        {
+            if (T <= 0.0)
+            {
+                // Intrinsic value: moves one for one with spot and against strike
+                const LatticeResult expired = americanLattice(S, K, r, sigma, T, kind, steps, scheme);
+                return {expired, expired.delta, -expired.delta, 0.0, 0.0, 0.0};
+            }
+
+            if (!isLattice(scheme))
+                throw std::invalid_argument(std::string(toString(scheme)) + " is not a lattice model");
+
+            const int n = detail::latticeSteps(steps, scheme);
+            switch (scheme)
+            {
+            case AmericanModel::LeisenReimer:
+                return leisenReimerSensitivities(S, K, r, sigma, T, kind, n);
+            case AmericanModel::BBSR:
+                return detail::extrapolate(crrSensitivities(S, K, r, sigma, T, kind, n, true),
+                                           crrSensitivities(S, K, r, sigma, T, kind, n / 2, true));
+            case AmericanModel::Trinomial:
+                return trinomialSensitivities(S, K, r, sigma, T, kind, n);
+            default:
+                return crrSensitivities(S, K, r, sigma, T, kind, n, false);
+            }
+        }
+
+    } // namespace BinomialTree
+} // namespace OptionPricer
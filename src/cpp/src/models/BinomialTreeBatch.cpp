@@ -0,0 +1,163 @@
+#include "models/BinomialTree.h"
+#include "BinomialTreeDetail.h"
+#include "BlackScholesSimd.h"
+#include "metrics/Metrics.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace OptionPricer
+{
+    namespace BinomialTree
+    {
+
+        namespace
+        {
+            using CrrKernel = void (*)(const detail::LaneInput &, int, bool, const detail::LaneBuffers &,
+                                       detail::CrrPass *);
+
+            struct Kernel
+            {
+                CrrKernel crr;
+                std::size_t lanes;
+            };
+
+            Kernel activeKernel()
+            {
+                using BlackScholes::detail::Isa;
+                switch (BlackScholes::detail::activeIsa())
+                {
+#ifdef BLACKSCHOLES_AVX512
+                case Isa::Avx512:
+                    return {detail::crrLanesAvx512, 8};
+#endif
+#ifdef BLACKSCHOLES_AVX2
+                case Isa::Avx2:
+                    return {detail::crrLanesAvx2, 4};
+#endif
+                default:
+                    return {nullptr, 1};
+                }
+            }
+
+            // Per-thread kernel scratch, grown on demand (see detail::LaneBuffers)
+            struct LaneWorkspace
+            {
+                std::vector<double> values;
+                std::vector<double> exercise[2];
+                std::vector<double> tape;
+                std::vector<double> segment;
+                std::vector<double> adjoint[2];
+                std::vector<double> sums[2];
+            };
+
+            // count doubles of storage starting on a cache line, so no vector load straddles two
+            double *aligned(std::vector<double> &storage, std::size_t count)
+            {
+                constexpr std::size_t line = 64 / sizeof(double);
+                storage.resize(count + line);
+                const std::size_t misalignment = reinterpret_cast<std::uintptr_t>(storage.data()) % 64 / sizeof(double);
+                return storage.data() + (misalignment ? line - misalignment : 0);
+            }
+
+            detail::LaneBuffers laneBuffers(int n, int leaves, std::size_t lanes)
+            {
+                thread_local LaneWorkspace ws;
+                const std::size_t row = static_cast<std::size_t>(n + 1) * lanes;
+                const std::size_t column = static_cast<std::size_t>(leaves + 1) * lanes;
+                double *tape = aligned(ws.tape, Tape::values(leaves, row));
+                return {aligned(ws.values, row),
+                        {aligned(ws.exercise[0], row), aligned(ws.exercise[1], static_cast<std::size_t>(n) * lanes)},
+                        tape,
+                        aligned(ws.segment, Tape(tape, leaves, row).segmentValues()),
+                        {aligned(ws.adjoint[0], column + lanes), aligned(ws.adjoint[1], column + lanes)},
+                        {aligned(ws.sums[0], column), aligned(ws.sums[1], column)}};
+            }
+
+            /**
+             * n-step CRR (BBS with blackScholesLast) sensitivities of the
+             * options at index[0..count), count <= kernel.lanes, into out[0..count);
+             * idle lanes repeat the last option
+             */
+            void crrPass(const Kernel &kernel, const LatticeBatchInput &in, const std::size_t *index,
+                         std::size_t count, int n, bool blackScholesLast, LatticeSensitivities *out)
+            {
+                detail::LaneInput lanes;
+                for (std::size_t l = 0; l < kernel.lanes; ++l)
+                {
+                    const std::size_t i = index[std::min(l, count - 1)];
+                    lanes.spot[l] = in.spot[i];
+                    lanes.strike[l] = in.strike[i];
+                    lanes.rate[l] = in.rate[i];
+                    lanes.sigma[l] = in.sigma[i];
+                    lanes.time[l] = in.time[i];
+                    lanes.kind[l] = in.kind[i];
+                }
+
+                detail::CrrPass passes[detail::MaxLanes];
+                kernel.crr(lanes, n, blackScholesLast, laneBuffers(n, blackScholesLast ? n - 1 : n, kernel.lanes),
+                           passes);
+                for (std::size_t l = 0; l < count; ++l)
+                {
+                    Metrics::recordLattice(n);
+                    out[l] = detail::crrSensitivitiesFrom(passes[l], lanes.spot[l], lanes.rate[l], lanes.sigma[l],
+                                                          lanes.time[l], n);
+                }
+            }
+        } // namespace
+
+        std::size_t batchLanes()
+        {
+            return activeKernel().lanes;
+        }
+
+        void americanSensitivitiesBatch(const LatticeBatchInput &in, int steps, AmericanModel scheme,
+                                        LatticeSensitivities *out)
+        {
+            const Kernel kernel = activeKernel();
+            const bool lattice = scheme == AmericanModel::CRR || scheme == AmericanModel::BBSR;
+
+            // Unexpired options share passes in input order; the rest are priced alone
+            std::vector<std::size_t> live;
+            for (std::size_t i = 0; i < in.size; ++i)
+            {
+                if (kernel.crr && lattice && in.time[i] > 0.0)
+                    live.push_back(i);
+                else
+                    out[i] = americanSensitivities(in.spot[i], in.strike[i], in.rate[i], in.sigma[i], in.time[i],
+                                                   in.kind[i], steps, scheme);
+            }
+
+            const int n = detail::latticeSteps(steps, scheme);
+            for (std::size_t begin = 0; begin < live.size(); begin += kernel.lanes)
+            {
+                const std::size_t *index = live.data() + begin;
+                const std::size_t count = std::min(kernel.lanes, live.size() - begin);
+                if (count == 1)
+                {
+                    const std::size_t i = index[0];
+                    out[i] = americanSensitivities(in.spot[i], in.strike[i], in.rate[i], in.sigma[i], in.time[i],
+                                                   in.kind[i], steps, scheme);
+                    continue;
+                }
+
+                LatticeSensitivities results[detail::MaxLanes];
+                if (scheme == AmericanModel::BBSR)
+                {
+                    LatticeSensitivities half[detail::MaxLanes];
+                    crrPass(kernel, in, index, count, n, true, results);
+                    crrPass(kernel, in, index, count, n / 2, true, half);
+                    for (std::size_t l = 0; l < count; ++l)
+                        results[l] = detail::extrapolate(results[l], half[l]);
+                }
+                else
+                {
+                    crrPass(kernel, in, index, count, n, false, results);
+                }
+                for (std::size_t l = 0; l < count; ++l)
+                    out[index[l]] = results[l];
+            }
+        }
+
+    } // namespace BinomialTree
+} // namespace OptionPricer
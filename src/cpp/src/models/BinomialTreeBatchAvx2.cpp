@@ -0,0 +1,21 @@
+// Built with -mavx2 -mfma -ffp-contract=off (/arch:AVX2 on MSVC); see CMakeLists.txt
+#include "BinomialTreeSimd.h"
+
+#if defined(__AVX2__)
+
+namespace OptionPricer
+{
+    namespace BinomialTree
+    {
+        namespace detail
+        {
+            void crrLanesAvx2(const LaneInput &in, int n, bool blackScholesLast, const LaneBuffers &buffers,
+                              CrrPass *out)
+            {
+                crrLanes<BlackScholes::Avx2Vec>(in, n, blackScholesLast, buffers, out);
+            }
+        }
+    }
+}
+
+#endif
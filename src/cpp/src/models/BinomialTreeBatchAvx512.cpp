@@ -0,0 +1,21 @@
+// Built with -mavx512f -mfma -ffp-contract=off (/arch:AVX512 on MSVC); see CMakeLists.txt
+#include "BinomialTreeSimd.h"
+
+#if defined(__AVX512F__)
+
+namespace OptionPricer
+{
+    namespace BinomialTree
+    {
+        namespace detail
+        {
+            void crrLanesAvx512(const LaneInput &in, int n, bool blackScholesLast, const LaneBuffers &buffers,
+                                CrrPass *out)
+            {
+                crrLanes<BlackScholes::Avx512Vec>(in, n, blackScholesLast, buffers, out);
+            }
+        }
+    }
+}
+
+#endif
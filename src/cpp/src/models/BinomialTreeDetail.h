@@ -0,0 +1,226 @@
+#pragma once
+
+// Private header shared by the scalar lattice engines (BinomialTree.cpp) and
+// the batched CRR kernels (BinomialTreeSimd.h, BinomialTreeBatch*.cpp).
+//
+// As in BlackScholesSimd.h, code lives in an anonymous namespace so each
+// translation unit compiles its own copy for its own instruction set; the
+// detail namespace holds only plain data and the entry points defined in
+// exactly one translation unit.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "concurrency/Cancellation.h"
+#include "models/BinomialTree.h"
+
+namespace OptionPricer
+{
+    namespace BinomialTree
+    {
+        namespace detail
+        {
+            // Adjoints collected by one reverse sweep over a binomial tree
+            struct BinomialBars
+            {
+                double spot, strike;    // through node spots and payoffs
+                double up, down;        // step factors U and D
+                double pu, pd;          // discounted branch probabilities
+                double rate, sigma, dt; // through Black-Scholes leaves only
+            };
+
+            // Forward and reverse pass of one CRR (or BBS) tree, before the
+            // adjoints are mapped back to the inputs
+            struct CrrPass
+            {
+                double price;
+                double early[5]; // {V(1,0), V(1,1), V(2,0), V(2,1), V(2,2)}
+                BinomialBars bars;
+            };
+
+            // Most options a batched kernel prices per pass (AVX-512)
+            constexpr std::size_t MaxLanes = MaxBatchLanes;
+
+            // One option per lane; the kernel reads its own width of each array
+            struct LaneInput
+            {
+                double spot[MaxLanes];
+                double strike[MaxLanes];
+                double rate[MaxLanes];
+                double sigma[MaxLanes];
+                double time[MaxLanes];
+                OptionKind kind[MaxLanes];
+            };
+
+            /**
+             * Scratch for one pass of width lanes over an n-step tree, sized
+             * by the caller (values and exercise[0] (n+1) * width, exercise[1]
+             * n * width, tape and segment as Tape asks, adjoint (leaves+2) *
+             * width, sums (leaves+1) * width), so the kernels, built
+             * with AVX flags, never instantiate an allocator.
+             */
+            struct LaneBuffers
+            {
+                double *values;
+                double *exercise[2];
+                double *tape;
+                double *segment;
+                double *adjoint[2];
+                double *sums[2];
+            };
+
+            // crrSensitivities for n steps of every lane, one CrrPass per
+            // lane; defined only in the translation unit built for the ISA
+            void crrLanesAvx2(const LaneInput &in, int n, bool blackScholesLast, const LaneBuffers &buffers,
+                              CrrPass *out);
+            void crrLanesAvx512(const LaneInput &in, int n, bool blackScholesLast, const LaneBuffers &buffers,
+                                CrrPass *out);
+
+            // The inputs' sensitivities from a pass (BinomialTree.cpp)
+            LatticeSensitivities crrSensitivitiesFrom(const CrrPass &pass, double S, double r, double sigma,
+                                                      double T, int n);
+
+            // BBSR's Richardson step 2 full - half, applied to every field
+            LatticeSensitivities extrapolate(const LatticeSensitivities &full, const LatticeSensitivities &half);
+
+            // Leaves of the (full) tree a lattice scheme builds for `steps`:
+            // at least 2 (Greeks read level 2), odd and at least 3 for
+            // Leisen-Reimer, even and at least 4 for BBSR so its half tree
+            // has 2. Every entry point clamps through this, so price() and
+            // greeks().price always value the same tree.
+            int latticeSteps(int steps, AmericanModel scheme);
+        }
+
+        namespace
+        {
+            // Forward passes check for cancellation of the calling work every this many levels
+            constexpr int CancellationStride = 64;
+
+            /**
+             * Levels of a tree kept by a forward pass for americanSensitivities,
+             * one row of `width` values each, leaves last. While the whole tree
+             * fits in MaxValues every level is kept; beyond that only every
+             * stride-th level (stride ~ sqrt(leaves)) and the leaves are, and
+             * TapeReader rebuilds the levels in between, so memory grows as
+             * steps^1.5 instead of steps^2.
+             */
+            struct Tape
+            {
+                static constexpr std::size_t MaxValues = std::size_t(1) << 18; // 2 MB
+
+                int leaves = 0;
+                int stride = 1;
+                std::size_t width = 0;
+                double *rows = nullptr;
+
+                // rows must hold values(leafLevel, rowWidth) doubles
+                Tape(double *storage, int leafLevel, std::size_t rowWidth)
+                    : leaves(leafLevel), stride(strideFor(leafLevel, rowWidth)), width(rowWidth), rows(storage)
+                {
+                }
+
+                static int strideFor(int leaves, std::size_t width)
+                {
+                    if ((leaves + 1) * width > MaxValues)
+                        return static_cast<int>(std::ceil(std::sqrt(static_cast<double>(leaves))));
+                    return 1;
+                }
+
+                static std::size_t values(int leaves, std::size_t width)
+                {
+                    return static_cast<std::size_t>(leaves / strideFor(leaves, width) + 2) * width;
+                }
+
+                // Levels a TapeReader rebuilds at a time
+                std::size_t segmentValues() const
+                {
+                    return stride > 1 ? static_cast<std::size_t>(stride + 1) * width : 0;
+                }
+
+                // Kept levels only: multiples of stride, and the leaves
+                double *row(int level) const
+                {
+                    return rows + static_cast<std::size_t>((level + stride - 1) / stride) * width;
+                }
+
+                void record(int level, const double *v, std::size_t count) const
+                {
+                    if (level % CancellationStride == 0)
+                        CancellationToken::checkpoint();
+                    if (level <= leaves && (level % stride == 0 || level == leaves))
+                        std::copy(v, v + count, row(level));
+                }
+            };
+
+            inline void record(const Tape *tape, int level, const double *v, std::size_t count)
+            {
+                if (tape)
+                    tape->record(level, v, count);
+                else if (level % CancellationStride == 0)
+                    CancellationToken::checkpoint();
+            }
+
+            /**
+             * Reads a Tape root first. Between checkpoints, the segment of
+             * levels up to the next kept level is rebuilt on first use by
+             * step(l, v), which turns level l + 1 in v into level l in place
+             * with the forward pass's own arithmetic, so every node comes
+             * back bit-identical. Level i + 1 always follows level i at
+             * + width; a level holds branching * i + 1 nodes of `lanes`
+             * values each. segment holds tape.segmentValues() doubles.
+             */
+            template <class Step>
+            class TapeReader
+            {
+            public:
+                TapeReader(const Tape &tape, double *segment, int branching, std::size_t lanes, Step step)
+                    : tape_(tape), branching_(branching), lanes_(lanes), step_(step), segment_(segment)
+                {
+                }
+
+                const double *level(int i)
+                {
+                    if (tape_.stride == 1)
+                        return tape_.row(i);
+                    const int base = i - i % tape_.stride;
+                    if (base != base_)
+                        rebuild(base);
+                    return segment_ + static_cast<std::size_t>(i - base) * tape_.width;
+                }
+
+            private:
+                std::size_t nodes(int level) const
+                {
+                    return static_cast<std::size_t>(branching_ * level + 1) * lanes_;
+                }
+
+                void rebuild(int base)
+                {
+                    const int top = std::min(base + tape_.stride, tape_.leaves);
+                    const double *kept = tape_.row(top);
+                    std::copy(kept, kept + nodes(top), segment_ + static_cast<std::size_t>(top - base) * tape_.width);
+                    for (int l = top - 1; l >= base; --l)
+                    {
+                        double *v = segment_ + static_cast<std::size_t>(l - base) * tape_.width;
+                        std::copy(v + tape_.width, v + tape_.width + nodes(l + 1), v);
+                        step_(l, v);
+                    }
+                    base_ = base;
+                }
+
+                const Tape &tape_;
+                int branching_;
+                std::size_t lanes_;
+                Step step_;
+                double *segment_ = nullptr;
+                int base_ = -1;
+            };
+
+            template <class Step>
+            TapeReader<Step> readTape(const Tape &tape, double *segment, int branching, std::size_t lanes, Step step)
+            {
+                return TapeReader<Step>(tape, segment, branching, lanes, step);
+            }
+        } // namespace
+    } // namespace BinomialTree
+} // namespace OptionPricer
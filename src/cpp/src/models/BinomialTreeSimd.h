@@ -0,0 +1,280 @@
+#pragma once
+
+// Private header for the batched CRR lattice
+// (BinomialTree::americanSensitivitiesBatch).
+//
+// One pass prices V::width options of the same step count, one per lane,
+// on the vector interface of BlackScholesSimd.h, and is instantiated per
+// instruction set in its own translation unit:
+//
+//   BinomialTreeBatchAvx2.cpp    Avx2Vec     (4 lanes)
+//   BinomialTreeBatchAvx512.cpp  Avx512Vec   (8 lanes)
+//
+// BinomialTreeBatch.cpp dispatches, and prices one by one on other CPUs.
+// Node j of a level keeps its lanes side by side at v[j * width + lane], so
+// a level is one sweep of vector loads and the exercise check a per-lane
+// max. Every lane repeats the scalar engine's arithmetic in the same order
+// (crrLevel, reverseBinomial), and the translation units are built with
+// -ffp-contract=off so no multiply-add is fused: results are bit-identical
+// to americanSensitivities.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "BinomialTreeDetail.h"
+#include "BlackScholesSimd.h"
+#include "models/BlackScholes.h"
+
+namespace OptionPricer
+{
+    namespace BinomialTree
+    {
+        namespace
+        {
+            // Level i of width CRR trees from level i + 1, in place (crrLevel per lane)
+            template <class V>
+            inline void crrLevelLanes(double *v, const double *ex, int i, V pu, V pd)
+            {
+                constexpr std::size_t width = V::width;
+                for (int j = 0; j <= i; ++j)
+                {
+                    double *node = v + j * width;
+                    const V hold = pu * V::load(node) + pd * V::load(node + width);
+                    V::store(node, V::max(hold, V::load(ex + j * width)));
+                }
+            }
+
+            template <class V>
+            inline bool anyNonZero(V a)
+            {
+                return V::any(V::less(V::set1(0.0), V::abs(a)));
+            }
+
+            /**
+             * crrSensitivities' forward and reverse pass for each lane of in.
+             * The sweep follows reverseBinomial: adjoints flow from the root
+             * through continued nodes, over the union of the lanes' reachable
+             * spans, and stop at exercised nodes and at the leaves, which
+             * (Black-Scholes values or not) are settled lane by lane.
+             */
+            template <class V>
+            void crrLanes(const detail::LaneInput &in, int n, bool blackScholesLast,
+                          const detail::LaneBuffers &buffers, detail::CrrPass *out)
+            {
+                constexpr std::size_t width = V::width;
+                const std::size_t row = static_cast<std::size_t>(n + 1) * width;
+                const int leaves = blackScholesLast ? n - 1 : n;
+
+                // Per-lane trees, with induct's and crrSensitivities' expressions
+                double pu[width], pd[width], up[width], down[width], dt[width], sign[width];
+                for (std::size_t l = 0; l < width; ++l)
+                {
+                    dt[l] = in.time[l] / n;
+                    up[l] = std::exp(in.sigma[l] * std::sqrt(dt[l]));
+                    down[l] = 1.0 / up[l];
+                    const double p = (std::exp(in.rate[l] * dt[l]) - down[l]) / (up[l] - down[l]);
+                    const double disc = std::exp(-in.rate[l] * dt[l]);
+                    pu[l] = disc * p;
+                    pd[l] = disc * (1.0 - p);
+                    sign[l] = in.kind[l] == OptionKind::Call ? 1.0 : -1.0;
+
+                    // buildExerciseLadder, spot level q at exercise[q & 1][(q >> 1) * width + l]
+                    const double S = in.spot[l], K = in.strike[l];
+                    const bool isCall = in.kind[l] == OptionKind::Call;
+                    double upSpot = S, downSpot = S;
+                    for (int k = 0; k <= n; ++k)
+                    {
+                        const int qUp = n - k, qDown = n + k;
+                        buffers.exercise[qUp & 1][(qUp >> 1) * width + l] =
+                            isCall ? std::max(0.0, upSpot - K) : std::max(0.0, K - upSpot);
+                        buffers.exercise[qDown & 1][(qDown >> 1) * width + l] =
+                            isCall ? std::max(0.0, downSpot - K) : std::max(0.0, K - downSpot);
+                        upSpot *= up[l];
+                        downSpot *= down[l];
+                    }
+                }
+                const V puV = V::load(pu), pdV = V::load(pd);
+                const auto exercise = [&](int i)
+                { return buffers.exercise[(n - i) & 1] + ((n - i) >> 1) * width; };
+                const auto capture = [&](int level, const double *v)
+                {
+                    if (level < 1 || level > 2)
+                        return;
+                    const int offset = level == 2 ? 2 : 0;
+                    for (int j = 0; j <= level; ++j)
+                        for (std::size_t l = 0; l < width; ++l)
+                            out[l].early[offset + j] = v[j * width + l];
+                };
+
+                // Forward pass (induct)
+                const Tape tape(buffers.tape, leaves, row);
+                double *v = buffers.values;
+                std::copy(buffers.exercise[0], buffers.exercise[0] + row, v);
+                capture(n, v);
+                tape.record(n, v, row);
+
+                int top = n - 1;
+                if (blackScholesLast)
+                {
+                    // blackScholesLevel, lane by lane
+                    for (std::size_t l = 0; l < width; ++l)
+                    {
+                        const double *ex = buffers.exercise[1] + l;
+                        const double step = down[l] * down[l];
+                        double spot = in.spot[l] * std::pow(up[l], n - 1);
+                        for (int j = 0; j < n; ++j, spot *= step)
+                        {
+                            const double european =
+                                in.kind[l] == OptionKind::Call
+                                    ? BlackScholes::price<OptionKind::Call>(spot, in.strike[l], in.rate[l],
+                                                                            in.sigma[l], dt[l])
+                                    : BlackScholes::price<OptionKind::Put>(spot, in.strike[l], in.rate[l],
+                                                                           in.sigma[l], dt[l]);
+                            v[j * width + l] = european > ex[j * width] ? european : ex[j * width];
+                        }
+                    }
+                    capture(top, v);
+                    tape.record(top, v, n * width);
+                    --top;
+                }
+                for (int i = top; i >= 0; --i)
+                {
+                    crrLevelLanes(v, exercise(i), i, puV, pdV);
+                    capture(i, v);
+                    tape.record(i, v, (i + 1) * width);
+                }
+                for (std::size_t l = 0; l < width; ++l)
+                    out[l].price = v[l];
+
+                // Reverse sweep (reverseBinomial)
+                auto levels = readTape(tape, buffers.segment, 1, width, [&](int i, double *level)
+                                       { crrLevelLanes(level, exercise(i), i, puV, pdV); });
+                double *bar = buffers.adjoint[0];
+                double *next = buffers.adjoint[1];
+                double *sumPu = buffers.sums[0];
+                double *sumPd = buffers.sums[1];
+                std::fill(sumPu, sumPu + (leaves + 1) * width, 0.0);
+                std::fill(sumPd, sumPd + (leaves + 1) * width, 0.0);
+
+                const V zero = V::set1(0.0);
+                const V signV = V::load(sign), strikeV = V::load(in.strike), spotV = V::load(in.spot);
+                const V upV = V::load(up), downV = V::load(down);
+                V barSpot = zero, barStrike = zero, barUp = zero, barDown = zero;
+
+                V::store(bar, V::set1(1.0));
+                int first = 0, last = 0, i = 0;
+                for (; i < leaves; ++i)
+                {
+                    const double *value = levels.level(i);
+                    const double *child = value + row;
+                    const double *ex = exercise(i);
+                    // Child k gathers from parents k and k - 1 as the loop
+                    // passes them (held is zero outside the span)
+                    int nextFirst = last + 1, nextLast = first - 1;
+                    V previous = zero;
+                    V childUp = V::load(child + first * width);
+                    for (int j = first; j <= last; ++j)
+                    {
+                        const std::size_t at = j * width;
+                        const V b = V::load(bar + at);
+                        const V e = V::load(ex + at);
+                        const auto continued = V::less(e, V::load(value + at));
+                        const V h = V::select(continued, b, zero);
+                        const V childDown = V::load(child + at + width);
+                        V::store(sumPu + at, V::load(sumPu + at) + h * childUp);
+                        V::store(sumPd + at, V::load(sumPd + at) + h * childDown);
+                        V::store(next + at, puV * h + pdV * previous);
+                        childUp = childDown;
+                        previous = h;
+                        if (anyNonZero(h))
+                        {
+                            nextFirst = std::min(nextFirst, j);
+                            nextLast = j;
+                        }
+
+                        // Exercised in the money: the adjoint stops on the payoff
+                        const V stopped = V::select(V::less(zero, e), V::select(continued, zero, b), zero);
+                        if (anyNonZero(stopped))
+                        {
+                            const V signedBar = signV * stopped;
+                            const V spot = strikeV + signV * e;
+                            barSpot = barSpot + signedBar * spot / spotV;
+                            barUp = barUp + signedBar * V::set1(i - j) * spot / upV;
+                            barDown = barDown + signedBar * V::set1(j) * spot / downV;
+                            barStrike = barStrike - signV * stopped;
+                        }
+                    }
+                    if (nextFirst > nextLast)
+                        break;
+
+                    V::store(next + (last + 1) * width, pdV * previous);
+                    first = nextFirst;
+                    last = nextLast + 1;
+                    std::swap(bar, next);
+                }
+
+                double spotBars[width], strikeBars[width], upBars[width], downBars[width];
+                V::store(spotBars, barSpot);
+                V::store(strikeBars, barStrike);
+                V::store(upBars, barUp);
+                V::store(downBars, barDown);
+                V totalPu = zero, totalPd = zero;
+                for (int j = 0; j <= leaves; ++j)
+                {
+                    totalPu = totalPu + V::load(sumPu + j * width);
+                    totalPd = totalPd + V::load(sumPd + j * width);
+                }
+                double puBars[width], pdBars[width];
+                V::store(puBars, totalPu);
+                V::store(pdBars, totalPd);
+                const double *leafValues = i == leaves ? levels.level(leaves) : nullptr;
+                const double *leafExercise = exercise(leaves);
+
+                for (std::size_t l = 0; l < width; ++l)
+                {
+                    detail::BinomialBars &o = out[l].bars;
+                    o = {spotBars[l], strikeBars[l], upBars[l], downBars[l], 0.0, 0.0, 0.0, 0.0, 0.0};
+                    const double S = in.spot[l], K = in.strike[l], U = up[l], D = down[l];
+                    const auto spotBar = [&](double b, double spot, int i, int j)
+                    {
+                        o.spot += b * spot / S;
+                        o.up += b * (i - j) * spot / U;
+                        o.down += b * j * spot / D;
+                    };
+
+                    // Adjoints reaching the leaves (the sweep got there)
+                    if (i == leaves)
+                    {
+                        const double *value = leafValues;
+                        const double *ex = leafExercise;
+                        for (int j = first; j <= last; ++j)
+                        {
+                            const std::size_t at = j * width + l;
+                            const double b = bar[at];
+                            if (b == 0.0)
+                                continue;
+                            if (blackScholesLast && value[at] > ex[at])
+                            {
+                                const double spot = S * std::pow(U, leaves - j) * std::pow(D, j);
+                                const OptionGreeks g =
+                                    BlackScholes::priceAndGreeks(spot, K, in.rate[l], in.sigma[l], dt[l], in.kind[l]);
+                                spotBar(b * g.delta, spot, leaves, j);
+                                o.strike += b * (g.price - spot * g.delta) / K;
+                                o.rate += b * g.rho;
+                                o.sigma += b * g.vega;
+                                o.dt -= b * g.theta;
+                            }
+                            else if (ex[at] > 0.0)
+                            {
+                                spotBar(sign[l] * b, K + sign[l] * ex[at], leaves, j);
+                                o.strike -= sign[l] * b;
+                            }
+                        }
+                    }
+                    o.pu = puBars[l];
+                    o.pd = pdBars[l];
+                }
+            }
+        } // namespace
+    } // namespace BinomialTree
+} // namespace OptionPricer
@@ -1,18 +1,19 @@
 #include "../../cpp/include/models/BlackScholes.h"
+#include <algorithm>
 #include <cmath>
 
 namespace BlackScholes
 {
-    static const double PI = 3.14159265358979323846;
+    namespace Normal = OptionPricer::Normal;
 
     double standardNormal(double x)
     {
-        return std::exp(-0.5 * x * x) / std::sqrt(2.0 * PI);
+        return Normal::pdf<Accuracy::Exact>(x);
     }
 
     double cumulativeNormal(double x)
     {
-        return 0.5 * (1.0 + std::erf(x / std::sqrt(2.0)));
+        return Normal::cdf<Accuracy::Exact>(x);
     }
 
     double d1(double S, double K, double r, double sigma, double T)
@@ -27,26 +28,18 @@ namespace BlackScholes
 
     double callPrice(double S, double K, double r, double sigma, double T)
     {
-        if (T <= 0)
-            return std::max(0.0, S - K);
-        double D1 = d1(S, K, r, sigma, T);
-        double D2 = d2(S, K, r, sigma, T);
-        return S * cumulativeNormal(D1) - K * std::exp(-r * T) * cumulativeNormal(D2);
+        return price<OptionKind::Call>(S, K, r, sigma, T);
     }
 
     double putPrice(double S, double K, double r, double sigma, double T)
     {
-        if (T <= 0)
-            return std::max(0.0, K - S);
-        double D1 = d1(S, K, r, sigma, T);
-        double D2 = d2(S, K, r, sigma, T);
-        return K * std::exp(-r * T) * cumulativeNormal(-D2) - S * cumulativeNormal(-D1);
+        return price<OptionKind::Put>(S, K, r, sigma, T);
     }
 
-    double delta(double S, double K, double r, double sigma, double T, const std::string &type)
+    double delta(double S, double K, double r, double sigma, double T, OptionKind kind)
     {
         double D1 = d1(S, K, r, sigma, T);
-        if (type == "call")
+        if (kind == OptionKind::Call)
             return cumulativeNormal(D1);
         return cumulativeNormal(D1) - 1.0;
     }
@@ -63,13 +56,13 @@ namespace BlackScholes
         return S * standardNormal(D1) * std::sqrt(T);
     }
 
-    double theta(double S, double K, double r, double sigma, double T, const std::string &type)
+    double theta(double S, double K, double r, double sigma, double T, OptionKind kind)
     {
         // Approximate daily theta (per year) for simplicity
         double D1 = d1(S, K, r, sigma, T);
         double D2 = d2(S, K, r, sigma, T);
         double first = -(S * standardNormal(D1) * sigma) / (2.0 * std::sqrt(T));
-        if (type == "call")
+        if (kind == OptionKind::Call)
         {
             double second = -r * K * std::exp(-r * T) * cumulativeNormal(D2);
             return first + second;
@@ -81,11 +74,115 @@ namespace BlackScholes
         }
     }
 
-    double rho(double S, double K, double r, double sigma, double T, const std::string &type)
+    double rho(double S, double K, double r, double sigma, double T, OptionKind kind)
     {
         double D2 = d2(S, K, r, sigma, T);
-        if (type == "call")
+        if (kind == OptionKind::Call)
             return K * T * std::exp(-r * T) * cumulativeNormal(D2);
         return -K * T * std::exp(-r * T) * cumulativeNormal(-D2);
     }
-}
+
+    namespace
+    {
+        // Shared body of price<Kind, A> and priceAndGreeks<Kind, A>
+        template <OptionKind Kind, bool WithGreeks, Accuracy A>
+        OptionGreeks closedForm(double S, double K, double r, double sigma, double T)
+        {
+            constexpr bool isCall = Kind == OptionKind::Call;
+            OptionGreeks g{};
+            if (T <= 0)
+            {
+                g.price = isCall ? std::max(0.0, S - K) : std::max(0.0, K - S);
+                if (WithGreeks && (isCall ? S > K : S < K))
+                    g.delta = isCall ? 1.0 : -1.0;
+                return g;
+            }
+
+            const double sqrtT = std::sqrt(T);
+            const double volSqrtT = sigma * sqrtT;
+            const double D1 = (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / volSqrtT;
+            const double D2 = D1 - volSqrtT;
+            const double discountedK = K * std::exp(-r * T);
+
+            // The put branch uses N(-x) directly rather than 1 - N(x) to keep
+            // precision in the tails
+            constexpr double sign = isCall ? 1.0 : -1.0;
+            double N1, N2, pdf;
+            if constexpr (A == Accuracy::Fast)
+            {
+                // exp(-d2^2 / 2) = exp(-d1^2 / 2) S / (K e^{-rT}): one exponential serves both
+                const double e1 = std::exp(-0.5 * D1 * D1);
+                N1 = Normal::cdfFromExp(sign * D1, e1);
+                N2 = Normal::cdfFromExp(sign * D2, e1 * S / discountedK);
+                pdf = e1 / Normal::Sqrt2Pi;
+            }
+            else if constexpr (WithGreeks)
+            {
+                // phi is even, so the density comes with N1 from one evaluation
+                const Normal::Value n1 = Normal::evaluate<A>(sign * D1);
+                N1 = n1.cdf;
+                N2 = Normal::cdf<A>(sign * D2);
+                pdf = n1.pdf;
+            }
+            else
+            {
+                N1 = Normal::cdf<A>(sign * D1);
+                N2 = Normal::cdf<A>(sign * D2);
+                pdf = 0.0;
+            }
+
+            g.price = sign * (S * N1 - discountedK * N2);
+            if (!WithGreeks)
+                return g;
+            g.delta = sign * N1;
+            g.gamma = pdf / (S * volSqrtT);
+            g.vega = S * pdf * sqrtT;
+            g.theta = -(S * pdf * sigma) / (2.0 * sqrtT) - sign * r * discountedK * N2;
+            g.rho = sign * T * discountedK * N2;
+            return g;
+        }
+    } // namespace
+
+    template <OptionKind Kind, Accuracy A>
+    double price(double S, double K, double r, double sigma, double T)
+    {
+        return closedForm<Kind, false, A>(S, K, r, sigma, T).price;
+    }
+
+    template <OptionKind Kind, Accuracy A>
+    OptionGreeks priceAndGreeks(double S, double K, double r, double sigma, double T)
+    {
+        return closedForm<Kind, true, A>(S, K, r, sigma, T);
+    }
+
+    template double price<OptionKind::Call, Accuracy::Exact>(double, double, double, double, double);
+    template double price<OptionKind::Put, Accuracy::Exact>(double, double, double, double, double);
+    template double price<OptionKind::Call, Accuracy::Fast>(double, double, double, double, double);
+    template double price<OptionKind::Put, Accuracy::Fast>(double, double, double, double, double);
+    template double price<OptionKind::Call, Accuracy::Table>(double, double, double, double, double);
+    template double price<OptionKind::Put, Accuracy::Table>(double, double, double, double, double);
+    template OptionGreeks priceAndGreeks<OptionKind::Call, Accuracy::Exact>(double, double, double, double, double);
+    template OptionGreeks priceAndGreeks<OptionKind::Put, Accuracy::Exact>(double, double, double, double, double);
+    template OptionGreeks priceAndGreeks<OptionKind::Call, Accuracy::Fast>(double, double, double, double, double);
+    template OptionGreeks priceAndGreeks<OptionKind::Put, Accuracy::Fast>(double, double, double, double, double);
+    template OptionGreeks priceAndGreeks<OptionKind::Call, Accuracy::Table>(double, double, double, double, double);
+    template OptionGreeks priceAndGreeks<OptionKind::Put, Accuracy::Table>(double, double, double, double, double);
+
+    OptionGreeks priceAndGreeks(double S, double K, double r, double sigma, double T, OptionKind kind,
+                                Accuracy accuracy)
+    {
+        const bool call = kind == OptionKind::Call;
+        switch (accuracy)
+        {
+        case Accuracy::Fast:
+            return call ? priceAndGreeks<OptionKind::Call, Accuracy::Fast>(S, K, r, sigma, T)
+                        : priceAndGreeks<OptionKind::Put, Accuracy::Fast>(S, K, r, sigma, T);
+        case Accuracy::Table:
+            return call ? priceAndGreeks<OptionKind::Call, Accuracy::Table>(S, K, r, sigma, T)
+                        : priceAndGreeks<OptionKind::Put, Accuracy::Table>(S, K, r, sigma, T);
+        default:
+            return call ? priceAndGreeks<OptionKind::Call>(S, K, r, sigma, T)
+                        : priceAndGreeks<OptionKind::Put>(S, K, r, sigma, T);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "models/BlackScholes.h"
+#include "BlackScholesSimd.h"
+#include "metrics/Metrics.h"
+#include <stdexcept>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace BlackScholes
+{
+    namespace
+    {
+        using detail::Isa;
+
+        bool cpuSupports(Isa isa)
+        {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return false;
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool fma = (info[2] & (1 << 12)) != 0;
+            if (!osxsave)
+                return false;
+            const unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(info, 7, 0);
+            if (isa == Isa::Avx2)
+                return fma && (info[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6;
+            return (info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            if (isa == Isa::Avx2)
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            return __builtin_cpu_supports("avx512f");
+#else
+            (void)isa;
+            return false;
+#endif
+        }
+
+        Isa detectIsa()
+        {
+#ifdef BLACKSCHOLES_AVX512
+            if (cpuSupports(Isa::Avx512))
+                return Isa::Avx512;
+#endif
+#ifdef BLACKSCHOLES_AVX2
+            if (cpuSupports(Isa::Avx2))
+                return Isa::Avx2;
+#endif
+            return Isa::Scalar;
+        }
+    } // namespace
+
+    namespace detail
+    {
+        Isa activeIsa()
+        {
+            static const Isa isa = detectIsa();
+            return isa;
+        }
+
+        std::size_t priceAndGreeksBatchScalar(const BatchInput &in, const BatchOutput &out,
+                                              std::size_t begin)
+        {
+            priceAndGreeksRange<ScalarVec>(in, out, begin, in.size);
+            return in.size;
+        }
+
+        std::size_t impliedVolatilityBatchScalar(const ImpliedVolInput &in, double *sigma, std::size_t begin)
+        {
+            impliedVolatilityKernel<ScalarVec>(in, sigma, begin, in.size);
+            return in.size;
+        }
+    }
+
+    void priceAndGreeksBatch(const BatchInput &in, const BatchOutput &out)
+    {
+        OptionPricer::Metrics::recordEuropean(in.size);
+        std::size_t done = 0;
+        switch (detail::activeIsa())
+        {
+#ifdef BLACKSCHOLES_AVX512
+        case Isa::Avx512:
+            done = detail::priceAndGreeksBatchAvx512(in, out);
+            break;
+#endif
+#ifdef BLACKSCHOLES_AVX2
+        case Isa::Avx2:
+            done = detail::priceAndGreeksBatchAvx2(in, out);
+            break;
+#endif
+        default:
+            break;
+        }
+        detail::priceAndGreeksBatchScalar(in, out, done);
+
+        // Expired or zero-vol elements take the exact closed-form path
+        for (std::size_t i = 0; i < in.size; ++i)
+        {
+            if (in.time[i] > 0.0 && in.sigma[i] > 0.0)
+                continue;
+            OptionGreeks g = priceAndGreeks(in.spot[i], in.strike[i], in.rate[i], in.sigma[i],
+                                            in.time[i], in.kind[i]);
+            double *columns[] = {out.price, out.delta, out.gamma, out.vega, out.theta, out.rho};
+            const double values[] = {g.price, g.delta, g.gamma, g.vega, g.theta, g.rho};
+            for (int c = 0; c < 6; ++c)
+                if (columns[c])
+                    columns[c][i] = values[c];
+        }
+    }
+
+    void impliedVolatilityBatch(const ImpliedVolInput &in, double *sigma)
+    {
+        std::size_t done = 0;
+        switch (detail::activeIsa())
+        {
+#ifdef BLACKSCHOLES_AVX512
+        case Isa::Avx512:
+            done = detail::impliedVolatilityBatchAvx512(in, sigma);
+            break;
+#endif
+#ifdef BLACKSCHOLES_AVX2
+        case Isa::Avx2:
+            done = detail::impliedVolatilityBatchAvx2(in, sigma);
+            break;
+#endif
+        default:
+            break;
+        }
+        detail::impliedVolatilityBatchScalar(in, sigma, done);
+    }
+
+    double impliedVolatility(double price, double S, double K, double r, double T, OptionKind kind)
+    {
+        if (!(S > 0.0 && K > 0.0))
+            throw std::invalid_argument("Parameters must be positive");
+        double sigma = 0.0;
+        detail::impliedVolatilityBatchScalar({&price, &S, &K, &r, &T, &kind, 1}, &sigma, 0);
+        if (std::isnan(sigma))
+            throw std::invalid_argument("Price is outside the no-arbitrage bounds; no implied volatility");
+        return sigma;
+    }
+
+    const char *batchInstructionSet()
+    {
+        switch (detail::activeIsa())
+        {
+        case Isa::Avx512:
+            return "avx512";
+        case Isa::Avx2:
+            return "avx2";
+        default:
+            return "scalar";
+        }
+    }
+}
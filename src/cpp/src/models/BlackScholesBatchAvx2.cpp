@@ -0,0 +1,26 @@
+// Built with -mavx2 -mfma (/arch:AVX2 on MSVC); see CMakeLists.txt
+#include "BlackScholesSimd.h"
+
+#if defined(__AVX2__)
+
+namespace BlackScholes
+{
+    namespace detail
+    {
+        std::size_t priceAndGreeksBatchAvx2(const BatchInput &in, const BatchOutput &out)
+        {
+            const std::size_t end = in.size - in.size % Avx2Vec::width;
+            priceAndGreeksRange<Avx2Vec>(in, out, 0, end);
+            return end;
+        }
+
+        std::size_t impliedVolatilityBatchAvx2(const ImpliedVolInput &in, double *sigma)
+        {
+            const std::size_t end = in.size - in.size % Avx2Vec::width;
+            impliedVolatilityKernel<Avx2Vec>(in, sigma, 0, end);
+            return end;
+        }
+    }
+}
+
+#endif
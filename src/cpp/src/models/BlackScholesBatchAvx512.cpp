@@ -0,0 +1,26 @@
+// Built with -mavx512f -mfma (/arch:AVX512 on MSVC); see CMakeLists.txt
+#include "BlackScholesSimd.h"
+
+#if defined(__AVX512F__)
+
+namespace BlackScholes
+{
+    namespace detail
+    {
+        std::size_t priceAndGreeksBatchAvx512(const BatchInput &in, const BatchOutput &out)
+        {
+            const std::size_t end = in.size - in.size % Avx512Vec::width;
+            priceAndGreeksRange<Avx512Vec>(in, out, 0, end);
+            return end;
+        }
+
+        std::size_t impliedVolatilityBatchAvx512(const ImpliedVolInput &in, double *sigma)
+        {
+            const std::size_t end = in.size - in.size % Avx512Vec::width;
+            impliedVolatilityKernel<Avx512Vec>(in, sigma, 0, end);
+            return end;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,364 @@
+#include "models/FiniteDifference.h"
+#include "concurrency/Scheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace OptionPricer
+{
+    namespace FiniteDifference
+    {
+
+        namespace
+        {
+            // Bump sizes for vega and rho; the bumped lanes share the base grid, so discretisation error cancels
+            constexpr double VolBump = 1e-3;
+            constexpr double RateBump = 1e-3;
+
+            // Volatilities solved together; with their bumped lanes a block fits in L2 on a 900-node grid
+            constexpr std::size_t VolsPerSolve = 8;
+
+            struct Lane
+            {
+                double sigma;
+                double rate;
+            };
+
+            // Constant tridiagonal rows A v[i-1] + B v[i] + C v[i+1] for one time step, per lane
+            struct Step
+            {
+                std::vector<double> a, c;   // [lane]
+                std::vector<double> inverse; // [node * lanes + lane], 1 / eliminated pivot
+            };
+
+            /**
+             * Per-thread grid buffers, laid out [node * lanes + lane] so each
+             * sweep's inner loop runs across lanes. They only grow.
+             */
+            struct Workspace
+            {
+                std::vector<double> value, previous, rhs, payoff;
+                std::vector<double> lower, diagonal, upper; // explicit operator, [lane]
+                Step rannacher, crank;
+            };
+
+            Workspace &workspace()
+            {
+                thread_local Workspace ws;
+                return ws;
+            }
+
+            /**
+             * Factor (I - theta h L) from the far boundary inward (Brennan-
+             * Schwartz order), leaving the exercise side for substitution
+             */
+            void factor(Step &step, const Workspace &ws, std::size_t nodes, std::size_t lanes, double theta, double h)
+            {
+                step.a.resize(lanes);
+                step.c.resize(lanes);
+                step.inverse.resize(nodes * lanes);
+                std::vector<double> b(lanes);
+                for (std::size_t k = 0; k < lanes; ++k)
+                {
+                    step.a[k] = -theta * h * ws.lower[k];
+                    step.c[k] = -theta * h * ws.upper[k];
+                    b[k] = 1.0 - theta * h * ws.diagonal[k];
+                }
+
+                double *inverse = step.inverse.data();
+                for (std::size_t k = 0; k < lanes; ++k)
+                    inverse[(nodes - 2) * lanes + k] = 1.0 / b[k];
+                for (std::size_t i = nodes - 3; i >= 1; --i)
+                {
+                    const double *above = inverse + (i + 1) * lanes;
+                    double *row = inverse + i * lanes;
+                    for (std::size_t k = 0; k < lanes; ++k)
+                        row[k] = 1.0 / (b[k] - step.c[k] * step.a[k] * above[k]);
+                }
+            }
+
+            /**
+             * Advance ws.value by one step of (I - theta h L) v' = (I + (1 - theta) h L) v,
+             * then substitute from the exercise side taking the max with the payoff
+             */
+            void advance(Workspace &ws, const Step &step, std::size_t nodes, std::size_t lanes, double theta, double h,
+                         const double *nearBoundary)
+            {
+                double *v = ws.value.data();
+                double *rhs = ws.rhs.data();
+                const double *payoff = ws.payoff.data();
+                const double *inverse = step.inverse.data();
+                const double *a = step.a.data();
+                const double *c = step.c.data();
+                const double *l = ws.lower.data();
+                const double *d = ws.diagonal.data();
+                const double *u = ws.upper.data();
+                const double explicitWeight = (1.0 - theta) * h;
+
+                for (std::size_t i = 1; i + 1 < nodes; ++i)
+                {
+                    const double *below = v + (i - 1) * lanes;
+                    const double *here = v + i * lanes;
+                    const double *above = v + (i + 1) * lanes;
+                    double *out = rhs + i * lanes;
+                    for (std::size_t k = 0; k < lanes; ++k)
+                        out[k] = here[k] + explicitWeight * (l[k] * below[k] + d[k] * here[k] + u[k] * above[k]);
+                }
+
+                // Far boundary stays at zero; eliminate towards the exercise side
+                for (std::size_t i = nodes - 3; i >= 1; --i)
+                {
+                    const double *above = rhs + (i + 1) * lanes;
+                    const double *pivot = inverse + (i + 1) * lanes;
+                    double *row = rhs + i * lanes;
+                    for (std::size_t k = 0; k < lanes; ++k)
+                        row[k] -= c[k] * above[k] * pivot[k];
+                }
+
+                for (std::size_t k = 0; k < lanes; ++k)
+                    v[k] = nearBoundary[k];
+                for (std::size_t i = 1; i + 1 < nodes; ++i)
+                {
+                    const double *below = v + (i - 1) * lanes;
+                    const double *row = rhs + i * lanes;
+                    const double *pivot = inverse + i * lanes;
+                    double *out = v + i * lanes;
+                    for (std::size_t k = 0; k < lanes; ++k)
+                        out[k] = std::max((row[k] - a[k] * below[k]) * pivot[k], payoff[i]);
+                }
+            }
+
+            // Quadratic fit through the three nodes nearest a fractional index
+            struct Stencil
+            {
+                std::size_t node;
+                double t;
+            };
+
+            Stencil stencil(double position, std::size_t nodes)
+            {
+                const double nearest = std::round(position);
+                const std::size_t node = static_cast<std::size_t>(
+                    std::min(std::max(nearest, 1.0), static_cast<double>(nodes - 2)));
+                return {node, position - static_cast<double>(node)};
+            }
+
+            double interpolate(const double *v, std::size_t lanes, std::size_t lane, const Stencil &s)
+            {
+                const double below = v[(s.node - 1) * lanes + lane];
+                const double here = v[s.node * lanes + lane];
+                const double above = v[(s.node + 1) * lanes + lane];
+                return here + s.t * (above - below) / 2.0 + s.t * s.t * (above - 2.0 * here + below) / 2.0;
+            }
+
+            /**
+             * Solve one group (shared expiry and kind) and write the requested
+             * columns for its members
+             */
+            void solveGroup(const ChainInput &in, const BlackScholes::BatchOutput &out, const Grid &grid,
+                            const std::vector<std::size_t> &members)
+            {
+                const double T = in.time[members.front()];
+                const bool isCall = in.kind[members.front()] == OptionKind::Call;
+                const bool wantVega = out.vega != nullptr;
+                const bool wantRho = out.rho != nullptr;
+
+                // Lanes: every distinct volatility, each followed by its bumped copies
+                std::vector<double> sigmas;
+                for (std::size_t m : members)
+                    sigmas.push_back(in.sigma[m]);
+                std::sort(sigmas.begin(), sigmas.end());
+                sigmas.erase(std::unique(sigmas.begin(), sigmas.end()), sigmas.end());
+
+                const std::size_t perSigma = 1 + (wantVega ? 2 : 0) + (wantRho ? 2 : 0);
+                std::vector<Lane> lanes;
+                for (double sigma : sigmas)
+                {
+                    lanes.push_back({sigma, in.rate});
+                    if (wantVega)
+                    {
+                        lanes.push_back({sigma + VolBump, in.rate});
+                        lanes.push_back({sigma - VolBump, in.rate});
+                    }
+                    if (wantRho)
+                    {
+                        lanes.push_back({sigma, in.rate + RateBump});
+                        lanes.push_back({sigma, in.rate - RateBump});
+                    }
+                }
+                const std::size_t L = lanes.size();
+
+                // Log-moneyness grid with a node on the payoff kink at x = 0, reaching five
+                // standard deviations past the outermost strikes
+                double xMin = 0.0, xMax = 0.0;
+                for (std::size_t m : members)
+                {
+                    const double x = std::log(in.spot / in.strike[m]);
+                    xMin = std::min(xMin, x);
+                    xMax = std::max(xMax, x);
+                }
+                const double spread = (sigmas.back() + (wantVega ? VolBump : 0.0)) * std::sqrt(T);
+                const double dx = 10.0 * spread / grid.spaceSteps;
+                const double lo = std::floor((xMin - 5.0 * spread) / dx) * dx;
+                const double hi = std::ceil((xMax + 5.0 * spread) / dx) * dx;
+                const std::size_t nodes = static_cast<std::size_t>(std::lround((hi - lo) / dx)) + 1;
+
+                // Node 0 is on the exercise side: the low end for puts, the high end for calls
+                const double origin = isCall ? hi : lo;
+                const double direction = isCall ? -1.0 : 1.0;
+
+                Workspace &ws = workspace();
+                ws.value.resize(nodes * L);
+                ws.previous.resize(nodes * L);
+                ws.rhs.resize(nodes * L);
+                ws.payoff.resize(nodes);
+                ws.lower.resize(L);
+                ws.diagonal.resize(L);
+                ws.upper.resize(L);
+
+                for (std::size_t i = 0; i < nodes; ++i)
+                {
+                    const double growth = std::exp(origin + direction * static_cast<double>(i) * dx);
+                    ws.payoff[i] = isCall ? std::max(growth - 1.0, 0.0) : std::max(1.0 - growth, 0.0);
+                    std::fill(ws.value.begin() + i * L, ws.value.begin() + (i + 1) * L, ws.payoff[i]);
+                }
+
+                // v_t = sigma^2/2 v_xx + (r - sigma^2/2) v_x - r v, with x running along the node order
+                for (std::size_t k = 0; k < L; ++k)
+                {
+                    const double diffusion = 0.5 * lanes[k].sigma * lanes[k].sigma / (dx * dx);
+                    const double drift = direction * (lanes[k].rate - 0.5 * lanes[k].sigma * lanes[k].sigma) / (2.0 * dx);
+                    ws.lower[k] = diffusion - drift;
+                    ws.diagonal[k] = -2.0 * diffusion - lanes[k].rate;
+                    ws.upper[k] = diffusion + drift;
+                }
+
+                const double dt = T / grid.timeSteps;
+                factor(ws.rannacher, ws, nodes, L, 1.0, 0.5 * dt);
+                factor(ws.crank, ws, nodes, L, 0.5, dt);
+
+                // Exercise-side boundary: an exercised put, or a call worth its forward intrinsic value
+                std::vector<double> boundary(L);
+                auto boundaryAt = [&](double tau)
+                {
+                    for (std::size_t k = 0; k < L; ++k)
+                        boundary[k] = isCall ? std::exp(origin) - std::exp(-lanes[k].rate * tau) : ws.payoff[0];
+                    return boundary.data();
+                };
+
+                advance(ws, ws.rannacher, nodes, L, 1.0, 0.5 * dt, boundaryAt(0.5 * dt));
+                advance(ws, ws.rannacher, nodes, L, 1.0, 0.5 * dt, boundaryAt(dt));
+                for (int n = 2; n <= grid.timeSteps; ++n)
+                {
+                    if (n % 64 == 0)
+                        CancellationToken::checkpoint();
+                    // Keep the level before the last step for theta
+                    ws.previous = ws.value;
+                    advance(ws, ws.crank, nodes, L, 0.5, dt, boundaryAt(n * dt));
+                }
+
+                for (std::size_t m : members)
+                {
+                    const double K = in.strike[m];
+                    const double x = std::log(in.spot / K);
+                    const Stencil s = stencil(direction * (x - origin) / dx, nodes);
+                    const std::size_t base = static_cast<std::size_t>(
+                                                 std::lower_bound(sigmas.begin(), sigmas.end(), in.sigma[m]) - sigmas.begin()) *
+                                             perSigma;
+                    const double *v = ws.value.data();
+
+                    const double below = v[(s.node - 1) * L + base];
+                    const double here = v[s.node * L + base];
+                    const double above = v[(s.node + 1) * L + base];
+                    const double first = direction * ((above - below) / 2.0 + s.t * (above - 2.0 * here + below)) / dx;
+                    const double second = (above - 2.0 * here + below) / (dx * dx);
+
+                    if (out.price)
+                        out.price[m] = K * interpolate(v, L, base, s);
+                    if (out.delta)
+                        out.delta[m] = K * first / in.spot;
+                    if (out.gamma)
+                        out.gamma[m] = K * (second - first) / (in.spot * in.spot);
+                    if (out.theta)
+                        out.theta[m] = -K * (interpolate(v, L, base, s) - interpolate(ws.previous.data(), L, base, s)) / dt;
+                    std::size_t lane = base + 1;
+                    if (wantVega)
+                    {
+                        out.vega[m] = K * (interpolate(v, L, lane, s) - interpolate(v, L, lane + 1, s)) / (2.0 * VolBump);
+                        lane += 2;
+                    }
+                    if (wantRho)
+                        out.rho[m] = K * (interpolate(v, L, lane, s) - interpolate(v, L, lane + 1, s)) / (2.0 * RateBump);
+                }
+            }
+
+            void validate(const ChainInput &in, const Grid &grid)
+            {
+                if (grid.timeSteps < 4 || grid.spaceSteps < 4)
+                    throw std::invalid_argument("Finite-difference grid needs at least 4 time and 4 space steps");
+                if (!(in.spot > 0.0))
+                    throw std::invalid_argument("Parameters must be positive");
+                for (std::size_t i = 0; i < in.size; ++i)
+                {
+                    if (!(in.strike[i] > 0.0 && in.sigma[i] > 0.0 && in.time[i] > 0.0))
+                        throw std::invalid_argument("Parameters must be positive");
+                }
+            }
+        } // namespace
+
+        void americanChain(const ChainInput &in, const BlackScholes::BatchOutput &out, Scheduler &scheduler,
+                           const Grid &grid)
+        {
+            validate(in, grid);
+
+            // Strikes of one expiry and kind, ordered by volatility
+            std::map<std::pair<double, OptionKind>, std::vector<std::size_t>> byExpiry;
+            for (std::size_t i = 0; i < in.size; ++i)
+                byExpiry[{in.time[i], in.kind[i]}].push_back(i);
+
+            // A smile is cut into blocks of a few volatilities, so each block's grid stays in
+            // cache and the blocks of one expiry run in parallel
+            std::vector<std::vector<std::size_t>> groups;
+            for (auto &entry : byExpiry)
+            {
+                std::vector<std::size_t> &members = entry.second;
+                std::stable_sort(members.begin(), members.end(), [&](std::size_t a, std::size_t b)
+                                 { return in.sigma[a] < in.sigma[b]; });
+                std::size_t distinct = 0;
+                for (std::size_t j = 0; j < members.size(); ++j)
+                {
+                    const bool newSigma = j == 0 || in.sigma[members[j]] != in.sigma[members[j - 1]];
+                    if (newSigma && distinct++ % VolsPerSolve == 0)
+                        groups.emplace_back();
+                    groups.back().push_back(members[j]);
+                }
+            }
+
+            scheduler.parallelFor(groups.size(), [&](std::size_t g)
+                                  { solveGroup(in, out, grid, groups[g]); }, 1);
+        }
+
+        double americanPrice(double S, double K, double r, double sigma, double T, OptionKind kind, const Grid &grid)
+        {
+            const ChainInput in{S, r, &K, &sigma, &T, &kind, 1};
+            validate(in, grid);
+            double price = 0.0;
+            solveGroup(in, {&price, nullptr, nullptr, nullptr, nullptr, nullptr}, grid, {0});
+            return price;
+        }
+
+        OptionGreeks americanGreeks(double S, double K, double r, double sigma, double T, OptionKind kind,
+                                    const Grid &grid)
+        {
+            const ChainInput in{S, r, &K, &sigma, &T, &kind, 1};
+            validate(in, grid);
+            OptionGreeks g;
+            solveGroup(in, {&g.price, &g.delta, &g.gamma, &g.vega, &g.theta, &g.rho}, grid, {0});
+            return g;
+        }
+
+    } // namespace FiniteDifference
+} // namespace OptionPricer
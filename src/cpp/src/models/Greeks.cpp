@@ -1,5 +1,6 @@
 #include "models/Greeks.h"
 #include "models/BlackScholes.h"
+#include "models/NormalDistribution.h"
 #include <cmath>
 
 namespace OptionPricer
@@ -7,13 +8,26 @@ namespace OptionPricer
     namespace Greeks
     {
 
+        namespace
+        {
+            double N(double x)
+            {
+                return Normal::cdf<Normal::Accuracy::Exact>(x);
+            }
+
+            double phi(double x)
+            {
+                return Normal::pdf<Normal::Accuracy::Exact>(x);
+            }
+        } // namespace
+
         double delta(double S, double K, double r, double sigma, double T,
-                     const std::string &type)
+                     OptionKind kind)
         {
             double d1 = BlackScholes::d1(S, K, r, sigma, T);
-            double N_d1 = 0.5 * (1.0 + std::erf(d1 / std::sqrt(2.0)));
+            double N_d1 = N(d1);
 
-            if (type == "call")
+            if (kind == OptionKind::Call)
             {
                 return N_d1;
             }
@@ -26,54 +40,54 @@ namespace OptionPricer
         double gamma(double S, double K, double r, double sigma, double T)
         {
             double d1 = BlackScholes::d1(S, K, r, sigma, T);
-            double phi_d1 = std::exp(-0.5 * d1 * d1) / std::sqrt(2.0 * M_PI);
+            double phi_d1 = phi(d1);
             return phi_d1 / (S * sigma * std::sqrt(T));
         }
 
         double vega(double S, double K, double r, double sigma, double T)
         {
             double d1 = BlackScholes::d1(S, K, r, sigma, T);
-            double phi_d1 = std::exp(-0.5 * d1 * d1) / std::sqrt(2.0 * M_PI);
+            double phi_d1 = phi(d1);
             return S * phi_d1 * std::sqrt(T) / 100.0; // Per 1% volatility
         }
 
         double theta(double S, double K, double r, double sigma, double T,
-                     const std::string &type)
+                     OptionKind kind)
         {
             double d1 = BlackScholes::d1(S, K, r, sigma, T);
             double d2 = BlackScholes::d2(S, K, r, sigma, T);
-            double phi_d1 = std::exp(-0.5 * d1 * d1) / std::sqrt(2.0 * M_PI);
-            double N_d2 = 0.5 * (1.0 + std::erf(d2 / std::sqrt(2.0)));
+            double phi_d1 = phi(d1);
+            double N_d2 = N(d2);
 
             double sqrtT = std::sqrt(T);
             double decay = -S * phi_d1 * sigma / (2.0 * sqrtT);
 
-            if (type == "call")
+            if (kind == OptionKind::Call)
             {
                 double rf_term = -r * K * std::exp(-r * T) * N_d2;
                 return (decay + rf_term) / 365.0; // Per day
             }
             else
             {
-                double N_minus_d2 = 1.0 - N_d2;
+                double N_minus_d2 = N(-d2);
                 double rf_term = r * K * std::exp(-r * T) * N_minus_d2;
                 return (decay + rf_term) / 365.0;
             }
         }
 
         double rho(double S, double K, double r, double sigma, double T,
-                   const std::string &type)
+                   OptionKind kind)
         {
             double d2 = BlackScholes::d2(S, K, r, sigma, T);
-            double N_d2 = 0.5 * (1.0 + std::erf(d2 / std::sqrt(2.0)));
+            double N_d2 = N(d2);
 
-            if (type == "call")
+            if (kind == OptionKind::Call)
             {
                 return K * T * std::exp(-r * T) * N_d2 / 100.0; // Per 1% rate
             }
             else
             {
-                double N_minus_d2 = 1.0 - N_d2;
+                double N_minus_d2 = N(-d2);
                 return -K * T * std::exp(-r * T) * N_minus_d2 / 100.0;
             }
         }
@@ -82,7 +96,7 @@ namespace OptionPricer
         {
             double d1 = BlackScholes::d1(S, K, r, sigma, T);
             double d2 = BlackScholes::d2(S, K, r, sigma, T);
-            double phi_d1 = std::exp(-0.5 * d1 * d1) / std::sqrt(2.0 * M_PI);
+            double phi_d1 = phi(d1);
 
             return -phi_d1 * d2 / sigma;
         }
@@ -91,22 +105,22 @@ namespace OptionPricer
         {
             double d1 = BlackScholes::d1(S, K, r, sigma, T);
             double d2 = BlackScholes::d2(S, K, r, sigma, T);
-            double phi_d1 = std::exp(-0.5 * d1 * d1) / std::sqrt(2.0 * M_PI);
+            double phi_d1 = phi(d1);
 
             return S * phi_d1 * std::sqrt(T) * d1 * d2 / sigma;
         }
 
         double charm(double S, double K, double r, double sigma, double T,
-                     const std::string &type)
+                     OptionKind kind)
         {
             double d1 = BlackScholes::d1(S, K, r, sigma, T);
             double d2 = BlackScholes::d2(S, K, r, sigma, T);
-            double phi_d1 = std::exp(-0.5 * d1 * d1) / std::sqrt(2.0 * M_PI);
+            double phi_d1 = phi(d1);
 
             double sqrtT = std::sqrt(T);
             double common = -r * phi_d1 / (sigma * sqrtT);
 
-            if (type == "call")
+            if (kind == OptionKind::Call)
             {
                 return common * d1 - r * std::exp(-r * T) * d2;
             }
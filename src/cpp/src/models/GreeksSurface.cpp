@@ -0,0 +1,194 @@
+#include "models/GreeksSurface.h"
+#include "models/BlackScholes.h"
+#include "concurrency/Scheduler.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace OptionPricer
+{
+    namespace GreeksSurface
+    {
+
+        namespace
+        {
+            // Points per tile; a few thousand keeps the tile's inputs in L1/L2
+            constexpr std::size_t TilePoints = 4096;
+
+            std::vector<double> axis(double lo, double hi, int steps)
+            {
+                std::vector<double> values(static_cast<std::size_t>(steps) + 1);
+                for (int i = 0; i <= steps; ++i)
+                    values[i] = steps == 0 ? lo : lo + (hi - lo) * i / steps;
+                return values;
+            }
+
+            std::size_t rowsPerTile(std::size_t cols)
+            {
+                return std::max<std::size_t>(1, TilePoints / cols);
+            }
+
+            void validate(const Spec &spec)
+            {
+                if (spec.spotSteps < 0 || spec.timeSteps < 0 ||
+                    spec.spotSteps > MaxSteps || spec.timeSteps > MaxSteps)
+                {
+                    throw std::invalid_argument("Surface steps must be between 0 and " + std::to_string(MaxSteps));
+                }
+                const std::size_t times = static_cast<std::size_t>(spec.timeSteps) + 1;
+                if ((!spec.rates.empty() && spec.rates.size() != times) ||
+                    (!spec.sigmas.empty() && spec.sigmas.size() != times))
+                {
+                    throw std::invalid_argument("Surface rates and sigmas need one value per expiry");
+                }
+            }
+
+            // Price the n grid points starting at flat index begin into out
+            void priceRange(const Spec &spec, const std::vector<double> &spots, const std::vector<double> &times,
+                            std::size_t begin, std::size_t n, const BlackScholes::BatchOutput &out)
+            {
+                const std::size_t cols = times.size();
+                std::vector<double> spot(n), time(n), rate(n), sigma(n);
+                for (std::size_t k = 0; k < n; ++k)
+                {
+                    const std::size_t j = (begin + k) % cols;
+                    spot[k] = spots[(begin + k) / cols];
+                    time[k] = times[j];
+                    rate[k] = spec.rates.empty() ? spec.rate : spec.rates[j];
+                    sigma[k] = spec.sigmas.empty() ? spec.sigma : spec.sigmas[j];
+                }
+                if (spec.accuracy == Normal::Accuracy::Exact)
+                {
+                    double *columns[] = {out.price, out.delta, out.gamma, out.vega, out.theta, out.rho};
+                    for (std::size_t k = 0; k < n; ++k)
+                    {
+                        const OptionGreeks g = BlackScholes::priceAndGreeks(spot[k], spec.strike, rate[k], sigma[k],
+                                                                            time[k], spec.kind);
+                        const double values[] = {g.price, g.delta, g.gamma, g.vega, g.theta, g.rho};
+                        for (int f = 0; f < 6; ++f)
+                            if (columns[f])
+                                columns[f][k] = values[f];
+                    }
+                    return;
+                }
+
+                std::vector<double> strike(n, spec.strike);
+                std::vector<OptionKind> kind(n, spec.kind);
+
+                BlackScholes::priceAndGreeksBatch(
+                    {spot.data(), strike.data(), rate.data(), sigma.data(), time.data(), kind.data(), n}, out);
+            }
+        } // namespace
+
+        Grid axes(const Spec &spec)
+        {
+            validate(spec);
+
+            Grid grid;
+            grid.spots = axis(spec.spotMin, spec.spotMax, spec.spotSteps);
+            grid.times = axis(spec.timeMin, spec.timeMax, spec.timeSteps);
+            return grid;
+        }
+
+        Grid compute(const Spec &spec, Scheduler &scheduler)
+        {
+            Grid grid = axes(spec);
+
+            const std::size_t cols = grid.times.size();
+            const std::size_t points = grid.spots.size() * cols;
+            for (auto *column : {&grid.price, &grid.delta, &grid.gamma, &grid.vega, &grid.theta, &grid.rho})
+                column->resize(points);
+
+            // Tiles are whole spot rows, so each covers a contiguous slice of every column
+            const std::size_t tileRows = rowsPerTile(cols);
+            const std::size_t tiles = (grid.spots.size() + tileRows - 1) / tileRows;
+            std::vector<char> done(tiles, 0);
+
+            try
+            {
+                scheduler.parallelFor(tiles, [&](std::size_t tile)
+                                      {
+                    const std::size_t rowBegin = tile * tileRows;
+                    const std::size_t rowEnd = std::min(grid.spots.size(), rowBegin + tileRows);
+                    const std::size_t offset = rowBegin * cols;
+                    const std::size_t n = (rowEnd - rowBegin) * cols;
+
+                    priceRange(spec, grid.spots, grid.times, offset, n,
+                               {grid.price.data() + offset, grid.delta.data() + offset, grid.gamma.data() + offset,
+                                grid.vega.data() + offset, grid.theta.data() + offset, grid.rho.data() + offset});
+                    done[tile] = 1; }, 1);
+                grid.completed = points;
+                return grid;
+            }
+            catch (const OperationCancelled &)
+            {
+                // Keep the tiles that finished; the rest read NaN
+            }
+
+            const double nan = std::numeric_limits<double>::quiet_NaN();
+            for (std::size_t tile = 0; tile < tiles; ++tile)
+            {
+                const std::size_t offset = tile * tileRows * cols;
+                const std::size_t n = std::min(grid.spots.size() - tile * tileRows, tileRows) * cols;
+                if (done[tile])
+                {
+                    grid.completed += n;
+                    continue;
+                }
+                for (auto *column : {&grid.price, &grid.delta, &grid.gamma, &grid.vega, &grid.theta, &grid.rho})
+                    std::fill(column->begin() + offset, column->begin() + offset + n, nan);
+            }
+            return grid;
+        }
+
+        Stream::Stream(const Spec &spec, std::vector<Field> fields, Scheduler &scheduler)
+            : spec_(spec), fields_(std::move(fields)), scheduler_(scheduler), axes_(GreeksSurface::axes(spec)),
+              tilePoints_(rowsPerTile(axes_.times.size()) * axes_.times.size()),
+              priced_((points() + tilePoints_ - 1) / tilePoints_, 0), values_(6)
+        {
+        }
+
+        void Stream::read(std::size_t column, std::size_t begin, std::size_t end, double *out)
+        {
+            const std::size_t points = this->points();
+            if (column >= fields_.size() || begin > end || end > points)
+                throw std::out_of_range("Surface range exceeds the grid");
+            if (begin == end)
+                return;
+
+            std::vector<std::size_t> missing;
+            for (std::size_t tile = begin / tilePoints_; tile <= (end - 1) / tilePoints_; ++tile)
+                if (!priced_[tile])
+                    missing.push_back(tile);
+            if (!missing.empty())
+            {
+                for (Field field : fields_)
+                    values_[static_cast<int>(field)].resize(points);
+                scheduler_.parallelFor(missing.size(), [&](std::size_t m)
+                                       {
+                    const std::size_t tileBegin = missing[m] * tilePoints_;
+                    const std::size_t n = std::min(points, tileBegin + tilePoints_) - tileBegin;
+
+                    // The kernel writes every Greek; scratch takes the unselected ones
+                    std::vector<double> scratch(6 * n);
+                    double *columns[6];
+                    for (int f = 0; f < 6; ++f)
+                        columns[f] = scratch.data() + f * n;
+                    for (Field field : fields_)
+                        columns[static_cast<int>(field)] = values_[static_cast<int>(field)].data() + tileBegin;
+                    priceRange(spec_, axes_.spots, axes_.times, tileBegin, n,
+                               {columns[0], columns[1], columns[2], columns[3], columns[4], columns[5]});
+                    priced_[missing[m]] = 1; }, 1);
+            }
+            const std::vector<double> &values = values_[static_cast<int>(fields_[column])];
+            std::copy(values.begin() + begin, values.begin() + end, out);
+        }
+
+        std::size_t Stream::pricedTiles() const
+        {
+            return static_cast<std::size_t>(std::count(priced_.begin(), priced_.end(), 1));
+        }
+
+    } // namespace GreeksSurface
+} // namespace OptionPricer
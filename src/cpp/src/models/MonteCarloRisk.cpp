@@ -0,0 +1,377 @@
+#include "models/MonteCarloRisk.h"
+#include "models/NormalDistribution.h"
+#include "concurrency/Scheduler.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace OptionPricer
+{
+    namespace MonteCarloRisk
+    {
+
+        namespace
+        {
+            // Paths per generation task
+            constexpr std::size_t BlockPaths = 4096;
+
+            constexpr double TwoPi = 6.28318530717958647692;
+
+            /**
+             * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy
+             * as 1, 2, 3"): a keyed bijection of a 128-bit counter, so any
+             * path's draws can be computed directly from its index
+             */
+            std::array<std::uint32_t, 4> philox(std::array<std::uint32_t, 4> c, std::uint64_t seed)
+            {
+                std::uint32_t k0 = static_cast<std::uint32_t>(seed);
+                std::uint32_t k1 = static_cast<std::uint32_t>(seed >> 32);
+                for (int round = 0; round < 10; ++round)
+                {
+                    const std::uint64_t p0 = 0xD2511F53ull * c[0];
+                    const std::uint64_t p1 = 0xCD9E8D57ull * c[2];
+                    c = {static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k0, static_cast<std::uint32_t>(p1),
+                         static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k1, static_cast<std::uint32_t>(p0)};
+                    k0 += 0x9E3779B9u;
+                    k1 += 0xBB67AE85u;
+                }
+                return c;
+            }
+
+            // 53-bit uniform strictly inside (0, 1)
+            double uniform(std::uint32_t hi, std::uint32_t lo)
+            {
+                const std::uint64_t bits = (static_cast<std::uint64_t>(hi) << 32) | lo;
+                return (static_cast<double>(bits >> 11) + 0.5) * 0x1p-53;
+            }
+
+            // Two independent standard normals for counter n (Box-Muller)
+            std::pair<double, double> philoxNormals(std::uint64_t n, std::uint64_t seed)
+            {
+                const auto r = philox({static_cast<std::uint32_t>(n), static_cast<std::uint32_t>(n >> 32), 0, 0}, seed);
+                const double radius = std::sqrt(-2.0 * std::log(uniform(r[0], r[1])));
+                const double angle = TwoPi * uniform(r[2], r[3]);
+                return {radius * std::cos(angle), radius * std::sin(angle)};
+            }
+
+            // Acklam's rational approximation, polished with one Halley step
+            double inverseNormal(double p)
+            {
+                static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                           1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+                static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                           6.680131188771972e+01, -1.328068155288572e+01};
+                static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                           -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+                static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                           3.754408661907416e+00};
+                const double pLow = 0.02425;
+
+                double x;
+                if (p < pLow || p > 1.0 - pLow)
+                {
+                    const double q = std::sqrt(-2.0 * std::log(p < pLow ? p : 1.0 - p));
+                    x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                        ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+                    if (p > 1.0 - pLow)
+                        x = -x;
+                }
+                else
+                {
+                    const double q = p - 0.5;
+                    const double r = q * q;
+                    x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+                        (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+                }
+
+                const double e = Normal::cdf<Normal::Accuracy::Exact>(x) - p;
+                const double u = e * std::sqrt(TwoPi) * std::exp(0.5 * x * x);
+                return x - u / (1.0 + 0.5 * x * u);
+            }
+
+            /**
+             * First two Sobol dimensions (van der Corput, then the
+             * polynomial x + 1), evaluated directly from the index
+             */
+            struct Sobol2D
+            {
+                std::uint32_t v[2][32];
+
+                Sobol2D()
+                {
+                    std::uint32_t m = 1;
+                    for (int k = 0; k < 32; ++k)
+                    {
+                        v[0][k] = 1u << (31 - k);
+                        if (k > 0)
+                            m = (m << 1) ^ m;
+                        v[1][k] = m << (31 - k);
+                    }
+                }
+
+                std::array<std::uint32_t, 2> point(std::uint64_t index) const
+                {
+                    std::array<std::uint32_t, 2> x = {0, 0};
+                    for (int k = 0; index != 0 && k < 32; ++k, index >>= 1)
+                    {
+                        if (index & 1)
+                        {
+                            x[0] ^= v[0][k];
+                            x[1] ^= v[1][k];
+                        }
+                    }
+                    return x;
+                }
+            };
+
+            void validate(const Spec &spec)
+            {
+                if (spec.paths < 1 || spec.paths > MaxPaths)
+                    throw std::invalid_argument("paths must be between 1 and " + std::to_string(MaxPaths));
+                if (!(spec.horizon >= 0.0) || !(spec.spotVol >= 0.0) || !(spec.volOfVol >= 0.0))
+                    throw std::invalid_argument("horizon and volatilities must not be negative");
+                if (!(spec.correlation >= -1.0 && spec.correlation <= 1.0))
+                    throw std::invalid_argument("correlation must be between -1 and 1");
+            }
+
+            void validateConfidences(const std::vector<double> &confidences)
+            {
+                for (double confidence : confidences)
+                {
+                    if (!(confidence > 0.0 && confidence < 1.0))
+                        throw std::invalid_argument("confidence levels must be between 0 and 1");
+                }
+            }
+        } // namespace
+
+        Sampling parseSampling(const std::string &name)
+        {
+            if (name == "pseudo")
+                return Sampling::Pseudo;
+            if (name == "antithetic")
+                return Sampling::Antithetic;
+            if (name == "sobol")
+                return Sampling::Sobol;
+            throw std::invalid_argument("Invalid sampling: " + name + " (expected \"pseudo\", \"antithetic\" or \"sobol\")");
+        }
+
+        const char *toString(Sampling sampling)
+        {
+            switch (sampling)
+            {
+            case Sampling::Pseudo:
+                return "pseudo";
+            case Sampling::Sobol:
+                return "sobol";
+            default:
+                return "antithetic";
+            }
+        }
+
+        std::size_t pathCount(const Spec &spec)
+        {
+            validate(spec);
+            return spec.sampling == Sampling::Antithetic ? (spec.paths + 1) / 2 * 2 : spec.paths;
+        }
+
+        std::vector<RiskMeasures::MarketShock> generateShocks(const Spec &spec, Scheduler &scheduler)
+        {
+            return generateShocks(spec, 0, pathCount(spec), scheduler);
+        }
+
+        std::vector<RiskMeasures::MarketShock> generateShocks(const Spec &spec, std::size_t begin, std::size_t end,
+                                                              Scheduler &scheduler)
+        {
+            if (!(begin < end && end <= pathCount(spec)))
+                throw std::invalid_argument("path range must be non-empty and within the run");
+            const std::size_t paths = end - begin;
+            std::vector<RiskMeasures::MarketShock> shocks(paths);
+
+            const double rootH = std::sqrt(spec.horizon);
+            const double spotMean = (spec.drift - 0.5 * spec.spotVol * spec.spotVol) * spec.horizon;
+            const double volMean = -0.5 * spec.volOfVol * spec.volOfVol * spec.horizon;
+            const double rho = spec.correlation;
+            const double rhoBar = std::sqrt(std::max(0.0, 1.0 - rho * rho));
+            auto shock = [&](double z1, double z2) -> RiskMeasures::MarketShock
+            {
+                return {std::exp(spotMean + spec.spotVol * rootH * z1),
+                        std::exp(volMean + spec.volOfVol * rootH * (rho * z1 + rhoBar * z2))};
+            };
+
+            // The digital shift randomises the Sobol net while keeping its structure
+            static const Sobol2D sobol;
+            const auto shift = philox({0xffffffffu, 0xffffffffu, 0, 0}, spec.seed);
+
+            const std::size_t blocks = (paths + BlockPaths - 1) / BlockPaths;
+            scheduler.parallelFor(blocks, [&](std::size_t block)
+                                  {
+                const std::size_t last = begin + std::min(paths, (block + 1) * BlockPaths);
+                for (std::size_t i = begin + block * BlockPaths; i < last; ++i)
+                {
+                    RiskMeasures::MarketShock &out = shocks[i - begin];
+                    switch (spec.sampling)
+                    {
+                    case Sampling::Pseudo:
+                    {
+                        const auto z = philoxNormals(i, spec.seed);
+                        out = shock(z.first, z.second);
+                        break;
+                    }
+                    case Sampling::Antithetic:
+                    {
+                        // Pair (2k, 2k + 1) shares counter k with opposite signs
+                        const auto z = philoxNormals(i / 2, spec.seed);
+                        const double sign = i % 2 ? -1.0 : 1.0;
+                        out = shock(sign * z.first, sign * z.second);
+                        break;
+                    }
+                    case Sampling::Sobol:
+                    {
+                        // Skip the origin, which maps to -infinity
+                        const auto x = sobol.point(i + 1);
+                        const double u1 = (static_cast<double>(x[0] ^ shift[0]) + 0.5) * 0x1p-32;
+                        const double u2 = (static_cast<double>(x[1] ^ shift[1]) + 0.5) * 0x1p-32;
+                        out = shock(inverseNormal(u1), inverseNormal(u2));
+                        break;
+                    }
+                    }
+                } }, 1);
+
+            return shocks;
+        }
+
+        Result run(const RiskMeasures::Portfolio &portfolio, const Spec &spec,
+                   const std::vector<double> &confidences, Scheduler &scheduler)
+        {
+            validateConfidences(confidences);
+            const std::vector<RiskMeasures::MarketShock> shocks = generateShocks(spec, scheduler);
+            RiskMeasures::ScenarioEngine engine(portfolio, spec.accuracy);
+            const std::vector<double> &pnl =
+                spec.taylor ? engine.runTaylor(shocks, spec.horizon, spec.gammaThreshold, scheduler)
+                            : engine.run(shocks, spec.horizon, scheduler);
+            return summarize(pnl, engine.baseValue(), spec.taylor ? engine.fullyRevaluedLegs() : portfolio.size(),
+                             confidences);
+        }
+
+        void Summary::add(const std::vector<double> &pnl)
+        {
+            if (pnl.empty())
+                return;
+            Summary part(losses.compression());
+            part.paths = pnl.size();
+            double sum = 0.0;
+            for (double p : pnl)
+            {
+                sum += p;
+                part.profitable += p > 0.0;
+                part.losses.add(-p);
+            }
+            part.mean = sum / pnl.size();
+            for (double p : pnl)
+                part.m2 += (p - part.mean) * (p - part.mean);
+            merge(part);
+        }
+
+        void Summary::merge(const Summary &other)
+        {
+            if (other.paths == 0)
+                return;
+            const double total = static_cast<double>(paths + other.paths);
+            const double delta = other.mean - mean;
+            m2 += other.m2 + delta * delta * (static_cast<double>(paths) * other.paths / total);
+            mean += delta * (other.paths / total);
+            paths += other.paths;
+            profitable += other.profitable;
+            losses.merge(other.losses);
+        }
+
+        Partial runPartial(const RiskMeasures::Portfolio &portfolio, const Spec &spec, std::size_t begin,
+                           std::size_t end, bool summarise, double compression, Scheduler &scheduler)
+        {
+            const std::vector<RiskMeasures::MarketShock> shocks = generateShocks(spec, begin, end, scheduler);
+            RiskMeasures::ScenarioEngine engine(portfolio, spec.accuracy);
+            const std::vector<double> &pnl =
+                spec.taylor ? engine.runTaylor(shocks, spec.horizon, spec.gammaThreshold, scheduler)
+                            : engine.run(shocks, spec.horizon, scheduler);
+
+            Partial partial;
+            partial.begin = begin;
+            partial.end = end;
+            partial.baseValue = engine.baseValue();
+            partial.fullyRevaluedLegs = spec.taylor ? engine.fullyRevaluedLegs() : portfolio.size();
+            partial.summarised = summarise;
+            if (summarise)
+            {
+                partial.summary = Summary(compression);
+                partial.summary.add(pnl);
+            }
+            else
+            {
+                partial.pnl = pnl;
+            }
+            return partial;
+        }
+
+        Result summarize(const std::vector<double> &pnl, double baseValue, std::size_t fullyRevaluedLegs,
+                         const std::vector<double> &confidences)
+        {
+            validateConfidences(confidences);
+            Result result;
+            result.paths = pnl.size();
+            result.fullyRevaluedLegs = fullyRevaluedLegs;
+            result.baseValue = baseValue;
+
+            // Two-pass moments, summed in path order
+            double sum = 0.0;
+            for (double p : pnl)
+                sum += p;
+            result.meanPnl = sum / pnl.size();
+            double squares = 0.0;
+            for (double p : pnl)
+                squares += (p - result.meanPnl) * (p - result.meanPnl);
+            result.stdevPnl = pnl.size() > 1 ? std::sqrt(squares / (pnl.size() - 1)) : 0.0;
+
+            std::vector<double> losses;
+            const RiskMeasures::ScenarioMeasures tail =
+                RiskMeasures::measures(pnl, confidences.empty() ? 0.99 : confidences.front(), losses);
+            result.maxLoss = tail.maxLoss;
+            result.pop = tail.pop;
+            for (double confidence : confidences)
+            {
+                const RiskMeasures::ScenarioMeasures m = RiskMeasures::measures(pnl, confidence, losses);
+                result.levels.push_back({confidence, m.var, m.es});
+            }
+            return result;
+        }
+
+        Result summarize(const Summary &summary, double baseValue, std::size_t fullyRevaluedLegs,
+                         const std::vector<double> &confidences)
+        {
+            validateConfidences(confidences);
+            const std::size_t n = summary.paths;
+            Result result;
+            result.paths = n;
+            result.fullyRevaluedLegs = fullyRevaluedLegs;
+            result.baseValue = baseValue;
+            result.meanPnl = n ? summary.mean : std::nan("");
+            result.stdevPnl = n > 1 ? std::sqrt(summary.m2 / (n - 1)) : 0.0;
+            result.maxLoss = n ? std::max(0.0, summary.losses.max()) : 0.0;
+            result.pop = n ? static_cast<double>(summary.profitable) / n : 0.0;
+            for (double confidence : confidences)
+            {
+                if (n == 0)
+                {
+                    result.levels.push_back({confidence, 0.0, 0.0});
+                    continue;
+                }
+                // The k-th largest loss sits at ascending rank n - k, centred at n - k + 0.5
+                const std::size_t k = RiskMeasures::tailScenarios(n, confidence);
+                result.levels.push_back({confidence, summary.losses.valueAt(n - k + 0.5),
+                                         summary.losses.upperMean(static_cast<double>(k))});
+            }
+            return result;
+        }
+
+    } // namespace MonteCarloRisk
+} // namespace OptionPricer
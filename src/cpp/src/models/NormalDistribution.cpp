@@ -0,0 +1,58 @@
+#include "models/NormalDistribution.h"
+#include <vector>
+
+namespace OptionPricer
+{
+    namespace Normal
+    {
+
+        namespace detail
+        {
+            const double *buildTable()
+            {
+                // Never freed: evaluations may run during static destruction
+                auto *nodes = new std::vector<double>(2 * TableNodes);
+                for (int i = 0; i < TableNodes; ++i)
+                {
+                    const double x = TableMin + i / TableScale;
+                    const Value v = evaluate<Accuracy::Exact>(x);
+                    (*nodes)[2 * i] = v.cdf;
+                    (*nodes)[2 * i + 1] = v.pdf;
+                }
+                return nodes->data();
+            }
+        } // namespace detail
+
+        double cdf(double x, Accuracy accuracy)
+        {
+            switch (accuracy)
+            {
+            case Accuracy::Fast:
+                return cdf<Accuracy::Fast>(x);
+            case Accuracy::Table:
+                return cdf<Accuracy::Table>(x);
+            default:
+                return cdf<Accuracy::Exact>(x);
+            }
+        }
+
+        double pdf(double x, Accuracy accuracy)
+        {
+            switch (accuracy)
+            {
+            case Accuracy::Fast:
+                return pdf<Accuracy::Fast>(x);
+            case Accuracy::Table:
+                return pdf<Accuracy::Table>(x);
+            default:
+                return pdf<Accuracy::Exact>(x);
+            }
+        }
+
+        void prepareTable()
+        {
+            detail::table();
+        }
+
+    } // namespace Normal
+} // namespace OptionPricer
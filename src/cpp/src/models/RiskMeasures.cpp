@@ -1,6 +1,12 @@
 #include "models/RiskMeasures.h"
+#include "models/MonteCarloRisk.h"
+#include "models/BlackScholes.h"
+#include "metrics/Metrics.h"
+#include "options/EuropeanOption.h"
 #include <algorithm>
+#include <cstdint>
 #include <numeric>
+#include <functional>
 #include <cmath>
 
 namespace OptionPricer
@@ -8,154 +14,326 @@ namespace OptionPricer
     namespace RiskMeasures
     {
 
-        double valueAtRisk(const std::vector<std::pair<std::shared_ptr<Option>, int>> &portfolio,
-                           double confidence, double horizon,
-                           const std::vector<double> &spotPrices)
+        namespace
         {
+            // Scenarios per revaluation task
+            constexpr std::size_t BlockScenarios = 256;
+
+            // How a leg is revalued, chosen once per run rather than per scenario
+            enum class Revaluation : std::uint8_t
+            {
+                EuropeanCall,
+                EuropeanPut,
+                EuropeanCallFast,
+                EuropeanPutFast,
+                EuropeanCallTable,
+                EuropeanPutTable,
+                Engine // Option::priceAt
+            };
 
-            std::vector<double> losses;
-            for (double spot : spotPrices)
+            Revaluation revaluationOf(const Option &option, Normal::Accuracy accuracy)
             {
-                double pnl = 0.0;
-                for (const auto &leg : portfolio)
+                if (!dynamic_cast<const EuropeanOption *>(&option))
+                    return Revaluation::Engine;
+                const bool call = option.kind() == OptionKind::Call;
+                switch (accuracy)
                 {
-                    auto option = leg.first;
-                    int qty = leg.second;
-                    option->setSpot(spot);
-                    pnl += qty * option->price();
+                case Normal::Accuracy::Fast:
+                    return call ? Revaluation::EuropeanCallFast : Revaluation::EuropeanPutFast;
+                case Normal::Accuracy::Table:
+                    return call ? Revaluation::EuropeanCallTable : Revaluation::EuropeanPutTable;
+                default:
+                    return call ? Revaluation::EuropeanCall : Revaluation::EuropeanPut;
                 }
-                losses.push_back(-pnl); // Negative for losses
             }
 
-            // Sort losses
-            std::sort(losses.begin(), losses.end());
-
-            // Get VaR at confidence level
-            int index = static_cast<int>(std::ceil((1.0 - confidence) * losses.size())) - 1;
-            return (index >= 0) ? losses[index] : 0.0;
-        }
-
-        double expectedShortfall(const std::vector<std::pair<std::shared_ptr<Option>, int>> &portfolio,
-                                 double confidence, double horizon,
-                                 const std::vector<double> &spotPrices)
-        {
-
-            std::vector<double> losses;
-            for (double spot : spotPrices)
+            // The closed form EuropeanOption::priceAt uses, without the virtual call and kind branch per scenario
+            template <OptionKind Kind, Normal::Accuracy A, typename ShiftFn>
+            void addEuropean(double *pnl, std::size_t begin, std::size_t end, const MarketState &market,
+                             double strike, int qty, ShiftFn &shift)
             {
-                double pnl = 0.0;
-                for (const auto &leg : portfolio)
+                for (std::size_t s = begin; s < end; ++s)
                 {
-                    auto option = leg.first;
-                    int qty = leg.second;
-                    option->setSpot(spot);
-                    pnl += qty * option->price();
+                    MarketState state = market;
+                    shift(s, state);
+                    pnl[s] += qty * BlackScholes::price<Kind, A>(state.spot, strike, state.rate, state.sigma, state.time);
                 }
-                losses.push_back(-pnl);
+                Metrics::recordEuropean(end - begin);
             }
 
-            std::sort(losses.begin(), losses.end());
+            /**
+             * pnl[s] += qty * value of the leg with its market moved by
+             * shift(s, state), for scenarios [begin, end). One dispatch per
+             * leg and block; each loop is specialised on exercise style,
+             * kind and normal accuracy. At Exact accuracy values equal
+             * Option::priceAt bit for bit.
+             */
+            template <typename ShiftFn>
+            void addLeg(double *pnl, std::size_t begin, std::size_t end, const Option &option, int qty,
+                        Revaluation how, const MarketState &market, ShiftFn &shift)
+            {
+                using Normal::Accuracy;
+                const double K = option.getStrike();
+                switch (how)
+                {
+                case Revaluation::EuropeanCall:
+                    addEuropean<OptionKind::Call, Accuracy::Exact>(pnl, begin, end, market, K, qty, shift);
+                    break;
+                case Revaluation::EuropeanPut:
+                    addEuropean<OptionKind::Put, Accuracy::Exact>(pnl, begin, end, market, K, qty, shift);
+                    break;
+                case Revaluation::EuropeanCallFast:
+                    addEuropean<OptionKind::Call, Accuracy::Fast>(pnl, begin, end, market, K, qty, shift);
+                    break;
+                case Revaluation::EuropeanPutFast:
+                    addEuropean<OptionKind::Put, Accuracy::Fast>(pnl, begin, end, market, K, qty, shift);
+                    break;
+                case Revaluation::EuropeanCallTable:
+                    addEuropean<OptionKind::Call, Accuracy::Table>(pnl, begin, end, market, K, qty, shift);
+                    break;
+                case Revaluation::EuropeanPutTable:
+                    addEuropean<OptionKind::Put, Accuracy::Table>(pnl, begin, end, market, K, qty, shift);
+                    break;
+                default:
+                    for (std::size_t s = begin; s < end; ++s)
+                    {
+                        MarketState state = market;
+                        shift(s, state);
+                        pnl[s] += qty * option.priceAt(state);
+                    }
+                }
+            }
+        } // namespace
 
-            // Average of worst losses beyond VaR
-            int index = static_cast<int>(std::ceil((1.0 - confidence) * losses.size())) - 1;
-            if (index < 0)
-                index = 0;
+        ScenarioEngine::ScenarioEngine(const Portfolio &portfolio, Normal::Accuracy accuracy)
+            : portfolio_(portfolio), baseValue_(0.0), accuracy_(accuracy)
+        {
+            for (const auto &leg : portfolio_)
+                baseValue_ += leg.second * leg.first->price();
+        }
 
-            double sum = 0.0;
-            for (int i = 0; i <= index; ++i)
+        template <typename ShiftFn>
+        const std::vector<double> &ScenarioEngine::revalue(std::size_t scenarios, ShiftFn shift,
+                                                            Scheduler &scheduler)
+        {
+            std::vector<MarketState> markets;
+            std::vector<Revaluation> how;
+            markets.reserve(portfolio_.size());
+            how.reserve(portfolio_.size());
+            for (const auto &leg : portfolio_)
             {
-                sum += losses[i];
+                markets.push_back(leg.first->market());
+                how.push_back(revaluationOf(*leg.first, accuracy_));
             }
 
-            return (index >= 0) ? sum / (index + 1) : 0.0;
+            // Scenarios are independent and each sums its legs in portfolio
+            // order, so the buffer is identical for any thread count. Blocks
+            // run leg by leg, so each leg's loop is picked once per block.
+            pnl_.resize(scenarios);
+            const std::size_t blocks = (scenarios + BlockScenarios - 1) / BlockScenarios;
+            scheduler.parallelFor(blocks, [&](std::size_t block)
+                                  {
+                const std::size_t begin = block * BlockScenarios;
+                const std::size_t end = std::min(scenarios, begin + BlockScenarios);
+                std::fill(pnl_.begin() + begin, pnl_.begin() + end, -baseValue_);
+                for (std::size_t i = 0; i < portfolio_.size(); ++i)
+                    addLeg(pnl_.data(), begin, end, *portfolio_[i].first, portfolio_[i].second, how[i], markets[i],
+                           shift); }, 1);
+            return pnl_;
         }
 
-        double maxLoss(const std::vector<std::pair<std::shared_ptr<Option>, int>> &portfolio,
-                       const std::vector<double> &spotPrices)
+        const std::vector<double> &ScenarioEngine::run(const std::vector<double> &spotPrices,
+                                                        Scheduler &scheduler)
         {
+            return revalue(spotPrices.size(), [&](std::size_t s, MarketState &state)
+                           { state.spot = spotPrices[s]; }, scheduler);
+        }
 
-            double worst = 0.0;
-            for (double spot : spotPrices)
+        const std::vector<double> &ScenarioEngine::run(const std::vector<MarketShock> &shocks, double horizon,
+                                                        Scheduler &scheduler)
+        {
+            return revalue(shocks.size(), [&](std::size_t s, MarketState &state)
+                           {
+                state.spot *= shocks[s].spotFactor;
+                state.sigma *= shocks[s].volFactor;
+                state.time = std::max(0.0, state.time - horizon); }, scheduler);
+        }
+
+        const std::vector<double> &ScenarioEngine::runTaylor(const std::vector<MarketShock> &shocks, double horizon,
+                                                             double gammaThreshold, Scheduler &scheduler)
+        {
+            // Expansion terms of the approximated legs, per unit spot / vol move:
+            // dS = S (f - 1) and dSigma = sigma (g - 1) for shock (f, g)
+            double linear = 0.0, quadratic = 0.0, volTerm = 0.0, decay = 0.0;
+            std::vector<std::size_t> full;
+            std::vector<MarketState> fullMarkets;
+            std::vector<Revaluation> fullHow;
+            double fullBase = 0.0;
+            for (std::size_t i = 0; i < portfolio_.size(); ++i)
             {
-                double pnl = 0.0;
-                for (const auto &leg : portfolio)
+                const Option &option = *portfolio_[i].first;
+                const int qty = portfolio_[i].second;
+                const OptionGreeks g = option.greeks();
+                const MarketState m = option.market();
+                if (std::abs(g.gamma) > gammaThreshold)
                 {
-                    auto option = leg.first;
-                    int qty = leg.second;
-                    option->setSpot(spot);
-                    pnl += qty * option->price();
+                    full.push_back(i);
+                    fullMarkets.push_back(m);
+                    fullHow.push_back(revaluationOf(option, accuracy_));
+                    fullBase += qty * option.price(); // as baseValue_, so the sums match the full run
+                    continue;
                 }
-                worst = std::max(worst, -pnl);
+                linear += qty * g.delta * m.spot;
+                quadratic += 0.5 * qty * g.gamma * m.spot * m.spot;
+                volTerm += qty * g.vega * m.sigma;
+                decay += qty * g.theta * std::min(horizon, m.time);
             }
+            fullLegs_ = full.size();
 
-            return worst;
+            pnl_.resize(shocks.size());
+            const std::size_t blockSize = full.empty() ? 16384 : 64;
+            const std::size_t blocks = (shocks.size() + blockSize - 1) / blockSize;
+            scheduler.parallelFor(blocks, [&](std::size_t block)
+                                  {
+                const std::size_t begin = block * blockSize;
+                const std::size_t end = std::min(shocks.size(), begin + blockSize);
+                auto shift = [&](std::size_t s, MarketState &state)
+                {
+                    state.spot *= shocks[s].spotFactor;
+                    state.sigma *= shocks[s].volFactor;
+                    state.time = std::max(0.0, state.time - horizon);
+                };
+                // Same order as the full run: -base, then legs in order
+                std::fill(pnl_.begin() + begin, pnl_.begin() + end, -fullBase);
+                for (std::size_t k = 0; k < full.size(); ++k)
+                    addLeg(pnl_.data(), begin, end, *portfolio_[full[k]].first, portfolio_[full[k]].second,
+                           fullHow[k], fullMarkets[k], shift);
+                for (std::size_t s = begin; s < end; ++s)
+                {
+                    const double x = shocks[s].spotFactor - 1.0;
+                    const double y = shocks[s].volFactor - 1.0;
+                    pnl_[s] += (linear + quadratic * x) * x + volTerm * y + decay;
+                } }, 1);
+            return pnl_;
         }
 
-        double probabilityOfProfit(const std::vector<std::pair<std::shared_ptr<Option>, int>> &portfolio,
-                                   const std::vector<double> &spotPrices)
+        ScenarioMeasures ScenarioEngine::measures(double confidence)
         {
+            return RiskMeasures::measures(pnl_, confidence, losses_);
+        }
 
-            int profitCount = 0;
-            for (double spot : spotPrices)
-            {
-                double pnl = 0.0;
-                for (const auto &leg : portfolio)
-                {
-                    auto option = leg.first;
-                    int qty = leg.second;
-                    option->setSpot(spot);
-                    pnl += qty * option->price();
-                }
-                if (pnl > 0.0)
-                {
-                    profitCount++;
-                }
-            }
+        std::size_t tailScenarios(std::size_t n, double confidence)
+        {
+            // The epsilon keeps 5% of 100 at 5, not 6
+            const double tail = std::ceil((1.0 - confidence) * n - 1e-9);
+            return std::min(n, std::max<std::size_t>(1, static_cast<std::size_t>(std::max(0.0, tail))));
+        }
+
+        ScenarioMeasures measures(const std::vector<double> &pnl, double confidence, std::vector<double> &losses)
+        {
+            const std::size_t n = pnl.size();
+            if (n == 0)
+                return {0.0, 0.0, 0.0, 0.0};
+
+            losses.resize(n);
+            std::transform(pnl.begin(), pnl.end(), losses.begin(), std::negate<double>());
+            const std::size_t k = tailScenarios(n, confidence);
+
+            // After selection the k largest losses occupy [0, k), smallest of them at k - 1
+            std::nth_element(losses.begin(), losses.begin() + (k - 1), losses.end(), std::greater<double>());
+
+            ScenarioMeasures result;
+            result.var = losses[k - 1];
+            result.es = std::accumulate(losses.begin(), losses.begin() + k, 0.0) / k;
+            result.maxLoss = std::max(0.0, *std::max_element(losses.begin(), losses.begin() + k));
+            result.pop = static_cast<double>(std::count_if(pnl.begin(), pnl.end(), [](double p)
+                                                           { return p > 0.0; })) /
+                         n;
+            return result;
+        }
+
+        double valueAtRisk(const Portfolio &portfolio,
+                           double confidence, double /*horizon*/,
+                           const std::vector<double> &spotPrices)
+        {
+            ScenarioEngine engine(portfolio);
+            engine.run(spotPrices);
+            return engine.measures(confidence).var;
+        }
+
+        double expectedShortfall(const Portfolio &portfolio,
+                                 double confidence, double /*horizon*/,
+                                 const std::vector<double> &spotPrices)
+        {
+            ScenarioEngine engine(portfolio);
+            engine.run(spotPrices);
+            return engine.measures(confidence).es;
+        }
+
+        double maxLoss(const Portfolio &portfolio,
+                       const std::vector<double> &spotPrices)
+        {
+            ScenarioEngine engine(portfolio);
+            const std::vector<double> &pnl = engine.run(spotPrices);
+            double worst = 0.0;
+            for (double p : pnl)
+                worst = std::max(worst, -p);
+            return worst;
+        }
 
-            return static_cast<double>(profitCount) / spotPrices.size();
+        double probabilityOfProfit(const Portfolio &portfolio,
+                                   const std::vector<double> &spotPrices)
+        {
+            ScenarioEngine engine(portfolio);
+            engine.run(spotPrices);
+            return engine.measures(0.5).pop;
         }
 
         PortfolioRisk calculatePortfolioRisk(
-            const std::vector<std::pair<std::shared_ptr<Option>, int>> &portfolio,
+            const Portfolio &portfolio,
             double confidence,
             double horizon)
         {
 
             PortfolioRisk risk;
 
-            // Calculate Greeks
+            // One greeks() per leg: closed form for European legs, one tree and
+            // its adjoint sweep for lattice American legs. Legs run in
+            // parallel and are summed in portfolio order.
+            std::vector<OptionGreeks> greeks(portfolio.size());
+            Scheduler::shared().parallelFor(portfolio.size(), [&](std::size_t i)
+                                            { greeks[i] = portfolio[i].first->greeks(); }, 1);
+
             risk.delta = 0.0;
             risk.gamma = 0.0;
             risk.vega = 0.0;
             risk.theta = 0.0;
             risk.rho = 0.0;
-
-            for (const auto &leg : portfolio)
+            for (std::size_t i = 0; i < portfolio.size(); ++i)
             {
-                auto option = leg.first;
-                int qty = leg.second;
-
-                risk.delta += qty * option->delta();
-                risk.gamma += qty * option->gamma();
-                risk.vega += qty * option->vega();
-                risk.theta += qty * option->theta();
-                risk.rho += qty * option->rho();
+                const int qty = portfolio[i].second;
+                risk.delta += qty * greeks[i].delta;
+                risk.gamma += qty * greeks[i].gamma;
+                risk.vega += qty * greeks[i].vega;
+                risk.theta += qty * greeks[i].theta;
+                risk.rho += qty * greeks[i].rho;
             }
 
-            // Generate spot price simulations
-            // (Simplified: linear range, should be lognormal distribution)
-            double spot = (portfolio[0].first)->getSpot();
-            std::vector<double> spots;
-            for (int i = 0; i <= 100; ++i)
-            {
-                spots.push_back(spot * 0.8 + (spot * 0.4) * i / 100.0);
-            }
+            // Simulated horizon P&L: spot follows the mean leg volatility at the
+            // first leg's rate, implied vols stay put
+            MonteCarloRisk::Spec spec;
+            spec.horizon = horizon;
+            spec.drift = portfolio[0].first->market().rate;
+            spec.spotVol = 0.0;
+            for (const auto &leg : portfolio)
+                spec.spotVol += leg.first->market().sigma / portfolio.size();
 
-            // Calculate risk measures
-            risk.var = valueAtRisk(portfolio, confidence, horizon, spots);
-            risk.es = expectedShortfall(portfolio, confidence, horizon, spots);
-            risk.maxLoss = maxLoss(portfolio, spots);
-            risk.pop = probabilityOfProfit(portfolio, spots);
+            const MonteCarloRisk::Result result =
+                MonteCarloRisk::run(portfolio, spec, {confidence}, Scheduler::shared());
+            risk.var = result.levels[0].var;
+            risk.es = result.levels[0].es;
+            risk.maxLoss = result.maxLoss;
+            risk.pop = result.pop;
 
             return risk;
         }
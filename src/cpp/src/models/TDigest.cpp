@@ -0,0 +1,200 @@
+#include "models/TDigest.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace OptionPricer
+{
+
+    namespace
+    {
+        // Values buffered per unit of compression before they are folded in
+        constexpr std::size_t BufferFactor = 8;
+
+        /**
+         * Quantile one unit of the scale k(q) = compression / z * log(q / (1 - q))
+         * above q, z = 4 log(total / compression) + 24 (Dunning's k2): a
+         * centroid may span at most one unit, so it holds about
+         * q (1 - q) z / compression of the weight, and few values near
+         * either end
+         */
+        double nextLimit(double q, double compression, double total)
+        {
+            const double z = 4.0 * std::log(std::max(1.0, total / compression)) + 24.0;
+            const double k = compression / z * std::log(q / (1.0 - q));
+            return 1.0 / (1.0 + std::exp(-(k + 1.0) * z / compression));
+        }
+    } // namespace
+
+    TDigest::TDigest(double compression)
+        : compression_(compression),
+          min_(std::numeric_limits<double>::infinity()),
+          max_(-std::numeric_limits<double>::infinity())
+    {
+        if (!(compression >= 10.0 && compression <= 1e5))
+            throw std::invalid_argument("t-digest compression must be between 10 and 100000");
+    }
+
+    TDigest TDigest::fromCentroids(double compression, double min, double max, std::vector<Centroid> centroids)
+    {
+        TDigest digest(compression);
+        double previous = -std::numeric_limits<double>::infinity();
+        for (const Centroid &c : centroids)
+        {
+            if (!(c.weight > 0.0) || !std::isfinite(c.weight) || !(c.mean >= previous) || !std::isfinite(c.mean))
+                throw std::invalid_argument("t-digest centroids must be finite, ascending and positively weighted");
+            previous = c.mean;
+        }
+        if (!centroids.empty() && !(min <= centroids.front().mean && max >= centroids.back().mean))
+            throw std::invalid_argument("t-digest bounds do not contain its centroids");
+        if (!centroids.empty())
+        {
+            digest.min_ = min;
+            digest.max_ = max;
+        }
+        digest.centroids_ = std::move(centroids);
+        return digest;
+    }
+
+    void TDigest::add(double value, double weight)
+    {
+        if (std::isnan(value) || !(weight > 0.0))
+            return;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        buffer_.push_back({value, weight});
+        if (buffer_.size() >= BufferFactor * static_cast<std::size_t>(compression_))
+            compress();
+    }
+
+    void TDigest::add(const double *values, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            add(values[i]);
+    }
+
+    void TDigest::merge(const TDigest &other)
+    {
+        const std::vector<Centroid> &theirs = other.centroids();
+        if (theirs.empty())
+            return;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        buffer_.insert(buffer_.end(), theirs.begin(), theirs.end());
+        compress();
+    }
+
+    void TDigest::compress() const
+    {
+        if (buffer_.empty())
+            return;
+        buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+        std::sort(buffer_.begin(), buffer_.end(), [](const Centroid &a, const Centroid &b)
+                  { return a.mean < b.mean || (a.mean == b.mean && a.weight < b.weight); });
+        double total = 0.0;
+        for (const Centroid &c : buffer_)
+            total += c.weight;
+
+        // One left-to-right pass: grow the current centroid while it stays within one unit of k
+        centroids_.clear();
+        Centroid current = buffer_.front();
+        double before = 0.0;
+        double limit = total * nextLimit(0.0, compression_, total);
+        for (std::size_t i = 1; i < buffer_.size(); ++i)
+        {
+            const Centroid &next = buffer_[i];
+            if (before + current.weight + next.weight <= limit)
+            {
+                current.weight += next.weight;
+                current.mean += (next.mean - current.mean) * next.weight / current.weight;
+                continue;
+            }
+            before += current.weight;
+            centroids_.push_back(current);
+            limit = total * nextLimit(before / total, compression_, total);
+            current = next;
+        }
+        centroids_.push_back(current);
+        buffer_.clear();
+    }
+
+    const std::vector<TDigest::Centroid> &TDigest::centroids() const
+    {
+        compress();
+        return centroids_;
+    }
+
+    double TDigest::count() const
+    {
+        double total = 0.0;
+        for (const Centroid &c : centroids())
+            total += c.weight;
+        return total;
+    }
+
+    double TDigest::valueAt(double index) const
+    {
+        const std::vector<Centroid> &c = centroids();
+        if (c.empty())
+            return std::numeric_limits<double>::quiet_NaN();
+        const std::size_t n = c.size();
+        const double total = count();
+        index = std::min(total, std::max(0.0, index));
+
+        // Beyond the outer centres, interpolate towards the exact extremes
+        const Centroid &first = c.front(), &last = c.back();
+        if (index < first.weight / 2.0)
+            return first.weight == 1.0 ? first.mean : min_ + (first.mean - min_) * index / (first.weight / 2.0);
+        if (index > total - last.weight / 2.0)
+            return last.weight == 1.0 ? last.mean
+                                      : max_ - (max_ - last.mean) * (total - index) / (last.weight / 2.0);
+
+        // Between the centres of neighbours i and i + 1; a singleton owns the unit around its centre
+        double centre = first.weight / 2.0;
+        for (std::size_t i = 0; i + 1 < n; ++i)
+        {
+            const double gap = (c[i].weight + c[i + 1].weight) / 2.0;
+            if (centre + gap >= index)
+            {
+                if (c[i].weight == 1.0 && index - centre < 0.5)
+                    return c[i].mean;
+                if (c[i + 1].weight == 1.0 && centre + gap - index <= 0.5)
+                    return c[i + 1].mean;
+                const double left = index - centre - (c[i].weight == 1.0 ? 0.5 : 0.0);
+                const double right = centre + gap - index - (c[i + 1].weight == 1.0 ? 0.5 : 0.0);
+                if (left + right <= 0.0)
+                    return (c[i].mean + c[i + 1].mean) / 2.0;
+                return (c[i].mean * right + c[i + 1].mean * left) / (left + right);
+            }
+            centre += gap;
+        }
+        return last.mean;
+    }
+
+    double TDigest::quantile(double q) const
+    {
+        return valueAt(q * count());
+    }
+
+    double TDigest::upperMean(double weight) const
+    {
+        const std::vector<Centroid> &c = centroids();
+        if (c.empty())
+            return std::numeric_limits<double>::quiet_NaN();
+        weight = std::min(weight, count());
+        if (!(weight > 0.0))
+            return max_;
+
+        // Whole centroids from the top, then the needed share of the last one at its mean
+        double sum = 0.0, remaining = weight;
+        for (std::size_t i = c.size(); i-- > 0 && remaining > 0.0;)
+        {
+            const double take = std::min(c[i].weight, remaining);
+            sum += take * c[i].mean;
+            remaining -= take;
+        }
+        return sum / weight;
+    }
+
+} // namespace OptionPricer
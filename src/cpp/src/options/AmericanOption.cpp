@@ -1,5 +1,7 @@
 #include "options/AmericanOption.h"
-#include "models/BlackScholes.h"
+#include "models/BinomialTree.h"
+#include "models/AmericanApprox.h"
+#include "models/FiniteDifference.h"
 #include <algorithm>
 #include <cmath>
 
@@ -7,116 +9,103 @@ namespace OptionPricer
 {
 
     AmericanOption::AmericanOption(double S, double K, double r, double sigma, double T,
-                                   const std::string &type, int steps)
-        : Option(S, K, r, sigma, T, type), steps_(steps)
+                                   OptionKind kind, int steps, AmericanModel model)
+        : Option(S, K, r, sigma, T, kind), steps_(steps), model_(model)
     {
     }
 
     double AmericanOption::price() const
     {
-        return binomialPrice();
+        return priceAt(market());
+    }
+
+    double AmericanOption::priceAt(const MarketState &state) const
+    {
+        if (model_ == AmericanModel::FiniteDifference)
+            return FiniteDifference::americanPrice(state.spot, strike_, state.rate, state.sigma, state.time, kind_,
+                                                   FiniteDifference::gridForSteps(steps_));
+        if (!isLattice(model_))
+            return AmericanApprox::price(model_, state.spot, strike_, state.rate, state.sigma, state.time, kind_);
+        return BinomialTree::americanPrice(state.spot, strike_, state.rate, state.sigma, state.time,
+                                           kind_, steps_, model_);
     }
 
     double AmericanOption::delta() const
     {
-        return binomialDelta();
+        return lattice().delta;
     }
 
     double AmericanOption::gamma() const
     {
-        // Numerical approximation: (delta_up - delta_down) / (2 * dS)
-        double h = spot_ * 0.01; // 1% bump
-        AmericanOption optionUp(spot_ + h, strike_, rate_, sigma_, time_, type_, steps_);
-        AmericanOption optionDown(spot_ - h, strike_, rate_, sigma_, time_, type_, steps_);
-
-        double deltaUp = optionUp.delta();
-        double deltaDown = optionDown.delta();
-
-        return (deltaUp - deltaDown) / (2.0 * h);
+        return lattice().gamma;
     }
 
     double AmericanOption::vega() const
     {
+        if (isLattice(model_))
+            return sensitivities().dSigma;
         // Numerical approximation
         double h = 0.01; // 1% change
-        AmericanOption optionUp(spot_, strike_, rate_, sigma_ + h, time_, type_, steps_);
-        AmericanOption optionDown(spot_, strike_, rate_, sigma_ - h, time_, type_, steps_);
-
-        return (optionUp.price() - optionDown.price()) / (2.0 * h);
+        return (bumpedPrice(0.0, h) - bumpedPrice(0.0, -h)) / (2.0 * h);
     }
 
     double AmericanOption::theta() const
     {
-        // Numerical approximation
-        double dt = 1.0 / 252.0; // 1 day
-        AmericanOption optionTomorrow(spot_, strike_, rate_, sigma_, std::max(0.0, time_ - dt), type_, steps_);
-
-        return (optionTomorrow.price() - price()) / dt;
+        return lattice().theta;
     }
 
     double AmericanOption::rho() const
     {
+        if (isLattice(model_))
+            return sensitivities().dRate;
         // Numerical approximation
         double h = 0.01; // 1% change
-        AmericanOption optionUp(spot_, strike_, rate_ + h, sigma_, time_, type_, steps_);
-        AmericanOption optionDown(spot_, strike_, rate_ - h, sigma_, time_, type_, steps_);
-
-        return (optionUp.price() - optionDown.price()) / (2.0 * h);
+        return (bumpedPrice(h, 0.0) - bumpedPrice(-h, 0.0)) / (2.0 * h);
     }
 
-    double AmericanOption::binomialPrice() const
+    OptionGreeks AmericanOption::greeks() const
     {
-        // Build binomial tree
-        double dt = time_ / steps_;
-        double u = std::exp(sigma_ * std::sqrt(dt));
-        double d = 1.0 / u;
-        double p = (std::exp(rate_ * dt) - d) / (u - d);
-
-        // Initialize price tree
-        std::vector<std::vector<double>> priceTree(steps_ + 1, std::vector<double>(steps_ + 1, 0.0));
+        if (model_ == AmericanModel::FiniteDifference)
+            return FiniteDifference::americanGreeks(spot_, strike_, rate_, sigma_, time_, kind_,
+                                                    FiniteDifference::gridForSteps(steps_));
+        if (!isLattice(model_))
+            return AmericanApprox::greeks(model_, spot_, strike_, rate_, sigma_, time_, kind_);
+
+        // One tree gives price/delta/gamma/theta and its reverse sweep vega and rho
+        return latticeGreeks(sensitivities());
+    }
 
-        // Fill terminal nodes
-        for (int j = 0; j <= steps_; ++j)
-        {
-            double S_T = spot_ * std::pow(u, steps_ - 2.0 * j);
-            double payoff = (type_ == "call") ? std::max(0.0, S_T - strike_) : std::max(0.0, strike_ - S_T);
-            priceTree[steps_][j] = payoff;
-        }
+    OptionGreeks AmericanOption::latticeGreeks(const BinomialTree::LatticeSensitivities &s)
+    {
+        OptionGreeks g;
+        g.price = s.lattice.price;
+        g.delta = s.lattice.delta;
+        g.gamma = s.lattice.gamma;
+        g.vega = s.dSigma;
+        g.theta = s.lattice.theta;
+        g.rho = s.dRate;
+        return g;
+    }
 
-        // Work backwards through tree
-        for (int i = steps_ - 1; i >= 0; --i)
+    BinomialTree::LatticeResult AmericanOption::lattice() const
+    {
+        if (!isLattice(model_))
         {
-            for (int j = 0; j <= i; ++j)
-            {
-                double S_t = spot_ * std::pow(u, i - 2.0 * j);
-                double discountedValue = std::exp(-rate_ * dt) *
-                                         (p * priceTree[i + 1][j] + (1.0 - p) * priceTree[i + 1][j + 1]);
-
-                // American option: max of holding and exercising
-                double payoff = (type_ == "call") ? std::max(0.0, S_t - strike_) : std::max(0.0, strike_ - S_t);
-
-                priceTree[i][j] = std::max(discountedValue, payoff);
-            }
+            const OptionGreeks g = greeks();
+            return {g.price, g.delta, g.gamma, g.theta};
         }
-
-        return priceTree[0][0];
+        return BinomialTree::americanLattice(spot_, strike_, rate_, sigma_, time_,
+                                             kind_, steps_, model_);
     }
 
-    double AmericanOption::binomialDelta() const
+    BinomialTree::LatticeSensitivities AmericanOption::sensitivities() const
     {
-        double dt = time_ / steps_;
-        double u = std::exp(sigma_ * std::sqrt(dt));
-        double d = 1.0 / u;
-        double p = (std::exp(rate_ * dt) - d) / (u - d);
-
-        // Calculate delta as (price up - price down) / (2 * S * (u - d))
-        double S_up = spot_ * u;
-        double S_down = spot_ * d;
-
-        AmericanOption optionUp(S_up, strike_, rate_, sigma_, time_, type_, steps_);
-        AmericanOption optionDown(S_down, strike_, rate_, sigma_, time_, type_, steps_);
+        return BinomialTree::americanSensitivities(spot_, strike_, rate_, sigma_, time_, kind_, steps_, model_);
+    }
 
-        return (optionUp.price() - optionDown.price()) / (spot_ * (u - d));
+    double AmericanOption::bumpedPrice(double dRate, double dSigma) const
+    {
+        return priceAt({spot_, rate_ + dRate, sigma_ + dSigma, time_});
     }
 
 } // namespace OptionPricer
@@ -1,15 +1,22 @@
 #include "../../cpp/include/options/EuropeanOption.h"
+#include "metrics/Metrics.h"
 
 double EuropeanOption::price() const
 {
-    if (type_ == "call")
-        return BlackScholes::callPrice(spot_, strike_, rate_, sigma_, time_);
-    return BlackScholes::putPrice(spot_, strike_, rate_, sigma_, time_);
+    return priceAt(market());
+}
+
+double EuropeanOption::priceAt(const MarketState &state) const
+{
+    OptionPricer::Metrics::recordEuropean();
+    if (kind_ == OptionKind::Call)
+        return BlackScholes::callPrice(state.spot, strike_, state.rate, state.sigma, state.time);
+    return BlackScholes::putPrice(state.spot, strike_, state.rate, state.sigma, state.time);
 }
 
 double EuropeanOption::delta() const
 {
-    return BlackScholes::delta(spot_, strike_, rate_, sigma_, time_, type_);
+    return BlackScholes::delta(spot_, strike_, rate_, sigma_, time_, kind_);
 }
 
 double EuropeanOption::gamma() const
@@ -24,10 +31,16 @@ double EuropeanOption::vega() const
 
 double EuropeanOption::theta() const
 {
-    return BlackScholes::theta(spot_, strike_, rate_, sigma_, time_, type_);
+    return BlackScholes::theta(spot_, strike_, rate_, sigma_, time_, kind_);
 }
 
 double EuropeanOption::rho() const
 {
-    return BlackScholes::rho(spot_, strike_, rate_, sigma_, time_, type_);
+    return BlackScholes::rho(spot_, strike_, rate_, sigma_, time_, kind_);
+}
+
+OptionGreeks EuropeanOption::greeks() const
+{
+    OptionPricer::Metrics::recordEuropean();
+    return BlackScholes::priceAndGreeks(spot_, strike_, rate_, sigma_, time_, kind_);
 }
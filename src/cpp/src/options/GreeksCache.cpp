@@ -0,0 +1,252 @@
+#include "options/GreeksCache.h"
+#include "options/AmericanOption.h"
+#include "concurrency/Scheduler.h"
+#include "models/BinomialTree.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace OptionPricer
+{
+
+    namespace
+    {
+        std::mutex sharedMutex;
+        std::unique_ptr<GreeksCache> sharedCache;
+        GreeksCache::Config sharedConfig;
+
+        // Index of x on a grid of step quantum; false when it does not fit a 64-bit key
+        bool quantize(double x, double quantum, std::int64_t &out)
+        {
+            const double scaled = quantum > 0.0 ? x / quantum : x;
+            if (!(std::abs(scaled) < 9.0e18))
+                return false;
+            out = std::llround(scaled);
+            return true;
+        }
+
+        std::size_t mix(std::size_t seed, std::uint64_t value)
+        {
+            // boost::hash_combine with a 64-bit golden-ratio constant
+            return seed ^ (static_cast<std::size_t>(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+        }
+    } // namespace
+
+    bool GreeksCache::Key::operator==(const Key &other) const
+    {
+        return model == other.model && kind == other.kind && steps == other.steps &&
+               spot == other.spot && strike == other.strike && rate == other.rate &&
+               sigma == other.sigma && time == other.time;
+    }
+
+    std::size_t GreeksCache::KeyHash::operator()(const Key &key) const
+    {
+        std::size_t h = (static_cast<std::size_t>(key.model) << 40) ^ (static_cast<std::size_t>(key.kind) << 32) ^
+                        static_cast<std::uint32_t>(key.steps);
+        for (std::int64_t v : {key.spot, key.strike, key.rate, key.sigma, key.time})
+            h = mix(h, static_cast<std::uint64_t>(v));
+        return h;
+    }
+
+    GreeksCache::GreeksCache() : GreeksCache(Config()) {}
+
+    GreeksCache::GreeksCache(const Config &config)
+        : quantization_(config.quantization), capacityBytes_(config.capacityBytes),
+          shardCapacity_(config.capacityBytes / EntryBytes / ShardCount)
+    {
+    }
+
+    GreeksCache::Key GreeksCache::keyFor(const OptionContract &contract) const
+    {
+        Key key{};
+        key.kind = static_cast<std::uint8_t>(contract.kind);
+        if (contract.style == ExerciseStyle::American)
+        {
+            key.model = 1 + static_cast<std::uint8_t>(contract.model);
+            key.steps = contract.steps;
+        }
+
+        const bool ok = quantize(contract.spot, quantization_.price, key.spot) &&
+                        quantize(contract.strike, quantization_.price, key.strike) &&
+                        quantize(contract.rate, quantization_.rate, key.rate) &&
+                        quantize(contract.sigma, quantization_.sigma, key.sigma) &&
+                        quantize(contract.time, quantization_.time, key.time);
+        if (!ok)
+            key.model = 0xff; // marks an uncacheable option
+        return key;
+    }
+
+    GreeksCache::Shard &GreeksCache::shardFor(const Key &key)
+    {
+        // High bits pick the shard so the map inside it still sees well-spread low bits
+        return shards_[(KeyHash()(key) >> 48) % ShardCount];
+    }
+
+    OptionGreeks GreeksCache::greeks(const Option &option)
+    {
+        return greeks(OptionContract::from(option));
+    }
+
+    bool GreeksCache::cacheable(const Key &key) const
+    {
+        return shardCapacity_ != 0 && key.model != 0xff;
+    }
+
+    bool GreeksCache::lookup(const Key &key, OptionGreeks &out)
+    {
+        if (bypass_.load(std::memory_order_relaxed))
+            return false;
+        if (cacheable(key))
+        {
+            Shard &shard = shardFor(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.index.find(key);
+            if (it != shard.index.end())
+            {
+                shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                out = it->second->second;
+                return true;
+            }
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void GreeksCache::insert(const Key &key, const OptionGreeks &value)
+    {
+        if (!cacheable(key) || bypass_.load(std::memory_order_relaxed))
+            return;
+        Shard &shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.index.count(key))
+            return; // another thread filled it meanwhile
+        shard.entries.emplace_front(key, value);
+        shard.index.emplace(key, shard.entries.begin());
+        while (shard.entries.size() > shardCapacity_)
+        {
+            shard.index.erase(shard.entries.back().first);
+            shard.entries.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    OptionGreeks GreeksCache::greeks(const OptionContract &contract)
+    {
+        const Key key = keyFor(contract);
+        OptionGreeks value;
+        if (lookup(key, value))
+            return value;
+        value = contract.greeks();
+        insert(key, value);
+        return value;
+    }
+
+    void GreeksCache::greeks(const OptionContract *contracts, std::size_t count, OptionGreeks *out,
+                             Scheduler &scheduler)
+    {
+        // Misses become tasks: a run of lattice contracts on one (scheme, steps), or a single contract
+        std::vector<Key> keys(count);
+        std::map<std::pair<AmericanModel, int>, std::vector<std::size_t>> lattices;
+        std::vector<std::vector<std::size_t>> tasks;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            keys[i] = keyFor(contracts[i]);
+            if (lookup(keys[i], out[i]))
+                continue;
+            const OptionContract &c = contracts[i];
+            if (c.style == ExerciseStyle::American &&
+                (c.model == AmericanModel::CRR || c.model == AmericanModel::BBSR))
+                lattices[{c.model, c.steps}].push_back(i);
+            else
+                tasks.push_back({i});
+        }
+        const std::size_t lanes = BinomialTree::batchLanes();
+        for (const auto &group : lattices)
+        {
+            const std::vector<std::size_t> &members = group.second;
+            for (std::size_t begin = 0; begin < members.size(); begin += lanes)
+                tasks.emplace_back(members.begin() + begin,
+                                   members.begin() + std::min(members.size(), begin + lanes));
+        }
+
+        scheduler.parallelFor(tasks.size(), [&](std::size_t t)
+                              {
+            const std::vector<std::size_t> &task = tasks[t];
+            if (task.size() == 1)
+            {
+                out[task[0]] = contracts[task[0]].greeks();
+            }
+            else
+            {
+                const std::size_t n = task.size();
+                double spot[BinomialTree::MaxBatchLanes], strike[BinomialTree::MaxBatchLanes],
+                    rate[BinomialTree::MaxBatchLanes], sigma[BinomialTree::MaxBatchLanes],
+                    time[BinomialTree::MaxBatchLanes];
+                OptionKind kind[BinomialTree::MaxBatchLanes];
+                for (std::size_t l = 0; l < n; ++l)
+                {
+                    const OptionContract &c = contracts[task[l]];
+                    spot[l] = c.spot;
+                    strike[l] = c.strike;
+                    rate[l] = c.rate;
+                    sigma[l] = c.sigma;
+                    time[l] = c.time;
+                    kind[l] = c.kind;
+                }
+                BinomialTree::LatticeSensitivities sensitivities[BinomialTree::MaxBatchLanes];
+                const OptionContract &first = contracts[task[0]];
+                BinomialTree::americanSensitivitiesBatch({spot, strike, rate, sigma, time, kind, n}, first.steps,
+                                                         first.model, sensitivities);
+                for (std::size_t l = 0; l < n; ++l)
+                    out[task[l]] = AmericanOption::latticeGreeks(sensitivities[l]);
+            }
+            for (std::size_t i : task)
+                insert(keys[i], out[i]); }, 1);
+    }
+
+    GreeksCache::Stats GreeksCache::stats() const
+    {
+        Stats s{hits_.load(), misses_.load(), evictions_.load(), 0, 0, capacityBytes_};
+        for (auto &shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            s.entries += shard.entries.size();
+        }
+        s.bytes = s.entries * EntryBytes;
+        return s;
+    }
+
+    void GreeksCache::clear()
+    {
+        for (auto &shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.entries.clear();
+            shard.index.clear();
+        }
+        hits_.store(0, std::memory_order_relaxed);
+        misses_.store(0, std::memory_order_relaxed);
+        evictions_.store(0, std::memory_order_relaxed);
+    }
+
+    GreeksCache &GreeksCache::shared()
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        if (!sharedCache)
+            sharedCache = std::make_unique<GreeksCache>(sharedConfig);
+        return *sharedCache;
+    }
+
+    bool GreeksCache::configureShared(const Config &config)
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        if (sharedCache)
+            return false;
+        sharedConfig = config;
+        return true;
+    }
+
+} // namespace OptionPricer
@@ -0,0 +1,63 @@
+#include "options/OptionContract.h"
+#include "options/EuropeanOption.h"
+#include "options/AmericanOption.h"
+#include "models/BlackScholes.h"
+#include "metrics/Metrics.h"
+#include <stdexcept>
+
+// Both engines are cheap value types; building one on the stack per call
+// keeps a single implementation of each model
+
+OptionContract OptionContract::from(const Option &option)
+{
+    const MarketState m = option.market();
+    if (const auto *american = dynamic_cast<const OptionPricer::AmericanOption *>(&option))
+        return OptionContract::american(m.spot, option.getStrike(), m.rate, m.sigma, m.time, option.kind(),
+                                        american->steps(), american->model());
+    if (dynamic_cast<const EuropeanOption *>(&option))
+        return OptionContract::european(m.spot, option.getStrike(), m.rate, m.sigma, m.time, option.kind());
+    throw std::invalid_argument("Unsupported option type");
+}
+
+std::shared_ptr<Option> OptionContract::toOption() const
+{
+    if (style == ExerciseStyle::American)
+        return std::make_shared<OptionPricer::AmericanOption>(spot, strike, rate, sigma, time, kind, steps, model);
+    return std::make_shared<EuropeanOption>(spot, strike, rate, sigma, time, kind);
+}
+
+std::shared_ptr<Option> OptionContract::toOption(std::pmr::memory_resource *resource) const
+{
+    const std::pmr::polymorphic_allocator<Option> allocator(resource);
+    if (style == ExerciseStyle::American)
+        return std::allocate_shared<OptionPricer::AmericanOption>(allocator, spot, strike, rate, sigma, time, kind,
+                                                                  steps, model);
+    return std::allocate_shared<EuropeanOption>(allocator, spot, strike, rate, sigma, time, kind);
+}
+
+double OptionContract::price() const
+{
+    return priceAt(market());
+}
+
+double OptionContract::priceAt(const MarketState &state) const
+{
+    if (style == ExerciseStyle::American)
+        return OptionPricer::AmericanOption(spot, strike, rate, sigma, time, kind, steps, model).priceAt(state);
+    return EuropeanOption(spot, strike, rate, sigma, time, kind).priceAt(state);
+}
+
+OptionGreeks OptionContract::greeks() const
+{
+    if (style == ExerciseStyle::American)
+        return OptionPricer::AmericanOption(spot, strike, rate, sigma, time, kind, steps, model).greeks();
+    return EuropeanOption(spot, strike, rate, sigma, time, kind).greeks();
+}
+
+OptionGreeks OptionContract::greeks(OptionPricer::Normal::Accuracy accuracy) const
+{
+    if (style == ExerciseStyle::American)
+        return greeks();
+    OptionPricer::Metrics::recordEuropean();
+    return BlackScholes::priceAndGreeks(spot, strike, rate, sigma, time, kind, accuracy);
+}
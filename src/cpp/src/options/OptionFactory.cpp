@@ -7,16 +7,21 @@ namespace OptionPricer
     std::shared_ptr<Option> OptionFactory::create(
         const std::string &optionType,
         double S, double K, double r, double sigma, double T,
-        const std::string &type, int steps)
+        OptionKind kind, int steps)
     {
 
         if (optionType == "european" || optionType == "european_option")
         {
-            return std::make_shared<EuropeanOption>(S, K, r, sigma, T, type);
+            return std::make_shared<EuropeanOption>(S, K, r, sigma, T, kind);
         }
         else if (optionType == "american" || optionType == "american_option")
         {
-            return std::make_shared<AmericanOption>(S, K, r, sigma, T, type, steps);
+            return std::make_shared<AmericanOption>(S, K, r, sigma, T, kind, steps);
+        }
+        else if (optionType.rfind("american_", 0) == 0)
+        {
+            // Lattice scheme or approximation by model name, e.g. "american_lr"
+            return std::make_shared<AmericanOption>(S, K, r, sigma, T, kind, steps, parseAmericanModel(optionType));
         }
         else
         {
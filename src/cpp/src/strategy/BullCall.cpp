@@ -1,11 +1,12 @@
 #include "strategy/BullCall.h"
-#include "options/EuropeanOption.h"
 #include <stdexcept>
 
 namespace OptionPricer
 {
 
-    BullCall::BullCall(double S, double K1, double K2, double r, double sigma, double T)
+    BullCall::BullCall(double S, double K1, double K2, double r, double sigma, double T,
+                       std::pmr::memory_resource *resource)
+        : Strategy(resource)
     {
         if (K1 >= K2)
         {
@@ -13,12 +14,10 @@ namespace OptionPricer
         }
 
         // Long call at lower strike K1
-        auto longCall = std::make_shared<EuropeanOption>(S, K1, r, sigma, T, "call");
-        legs_.push_back({longCall, 1});
+        addLeg(OptionContract::european(S, K1, r, sigma, T, OptionKind::Call), 1);
 
         // Short call at higher strike K2
-        auto shortCall = std::make_shared<EuropeanOption>(S, K2, r, sigma, T, "call");
-        legs_.push_back({shortCall, -1});
+        addLeg(OptionContract::european(S, K2, r, sigma, T, OptionKind::Call), -1);
     }
 
 } // namespace OptionPricer
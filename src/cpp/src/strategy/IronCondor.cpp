@@ -1,5 +1,4 @@
 #include "strategy/IronCondor.h"
-#include "options/EuropeanOption.h"
 #include <stdexcept>
 
 namespace OptionPricer
@@ -8,7 +7,9 @@ namespace OptionPricer
     IronCondor::IronCondor(double S,
                            double K_short_put, double K_short_call,
                            double K_long_put, double K_long_call,
-                           double r, double sigma, double T)
+                           double r, double sigma, double T,
+                           std::pmr::memory_resource *resource)
+        : Strategy(resource)
     {
 
         // Validate strike ordering: K_long_put < K_short_put < K_short_call < K_long_call
@@ -20,20 +21,16 @@ namespace OptionPricer
         }
 
         // Short put at K_short_put
-        auto shortPut = std::make_shared<EuropeanOption>(S, K_short_put, r, sigma, T, "put");
-        legs_.push_back({shortPut, -1});
+        addLeg(OptionContract::european(S, K_short_put, r, sigma, T, OptionKind::Put), -1);
 
         // Long put at K_long_put (protective)
-        auto longPut = std::make_shared<EuropeanOption>(S, K_long_put, r, sigma, T, "put");
-        legs_.push_back({longPut, 1});
+        addLeg(OptionContract::european(S, K_long_put, r, sigma, T, OptionKind::Put), 1);
 
         // Short call at K_short_call
-        auto shortCall = std::make_shared<EuropeanOption>(S, K_short_call, r, sigma, T, "call");
-        legs_.push_back({shortCall, -1});
+        addLeg(OptionContract::european(S, K_short_call, r, sigma, T, OptionKind::Call), -1);
 
         // Long call at K_long_call (protective)
-        auto longCall = std::make_shared<EuropeanOption>(S, K_long_call, r, sigma, T, "call");
-        legs_.push_back({longCall, 1});
+        addLeg(OptionContract::european(S, K_long_call, r, sigma, T, OptionKind::Call), 1);
     }
 
 } // namespace OptionPricer
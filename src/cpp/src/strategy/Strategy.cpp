@@ -1,19 +1,20 @@
 #include "strategy/Strategy.h"
 #include <algorithm>
+#include <cmath>
+#include <utility>
 
 double Strategy::payoff(double spotPrice) const
 {
     double pnl = 0.0;
     for (const auto &leg : legs_)
     {
-        auto option = leg.option;
         int qty = leg.quantity;
 
         // Calculate intrinsic value at expiration (time=0)
-        double strike = option->getStrike();
+        double strike = leg.contract.strike;
         double intrinsic = 0.0;
 
-        if (option->type() == "call")
+        if (leg.contract.kind == OptionKind::Call)
         {
             intrinsic = std::max(0.0, spotPrice - strike);
         }
@@ -31,6 +32,101 @@ double Strategy::payoff(double spotPrice) const
     return pnl;
 }
 
+std::vector<double> Strategy::payoffGrid(double spotMin, double spotMax, std::size_t n) const
+{
+    std::vector<double> spots(n), out(n);
+    const double steps = n > 1 ? static_cast<double>(n - 1) : 1.0;
+    for (std::size_t i = 0; i < n; ++i)
+        spots[i] = spotMin + (spotMax - spotMin) * static_cast<double>(i) / steps;
+    payoffGrid(spots.data(), n, out.data());
+    return out;
+}
+
+void Strategy::payoffGrid(const double *spots, std::size_t n, double *out) const
+{
+    // Calls use sign +1 (S - K), puts -1 (K - S); negation is exact, so the
+    // per-point arithmetic matches payoff()
+    std::fill(out, out + n, 0.0);
+    for (const Leg &leg : legs_)
+    {
+        const double strike = leg.contract.strike;
+        const double sign = leg.contract.kind == OptionKind::Call ? 1.0 : -1.0;
+        const double quantity = leg.quantity;
+        const double premium = leg.initialPremium;
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] += quantity * (std::max(0.0, sign * (spots[i] - strike)) - premium);
+    }
+}
+
+PayoffProfile Strategy::payoffProfile() const
+{
+    PayoffProfile profile{{}, {}, 0.0, 0.0};
+    if (legs_.empty())
+        return profile;
+
+    // P&L at S = 0 and the slope just above it: puts pay K and fall with
+    // slope -qty; each leg then adds +qty to the slope at its strike
+    double value = 0.0;
+    double slope = 0.0;
+    std::pmr::vector<std::pair<double, double>> slopeSteps(legs_.get_allocator().resource());
+    slopeSteps.reserve(legs_.size());
+    for (const auto &leg : legs_)
+    {
+        const double strike = leg.contract.strike;
+        const double qty = leg.quantity;
+        value -= qty * leg.initialPremium;
+        if (leg.contract.kind == OptionKind::Put)
+        {
+            value += qty * strike;
+            slope -= qty;
+        }
+        slopeSteps.emplace_back(strike, qty);
+    }
+    std::sort(slopeSteps.begin(), slopeSteps.end());
+
+    // Sweep the kinks left to right; between them the P&L is linear
+    auto addBreakeven = [&profile](double spot)
+    {
+        if (profile.breakevens.empty() || profile.breakevens.back() != spot)
+            profile.breakevens.push_back(spot);
+    };
+    double x = 0.0;
+    double lowest = value;
+    double highest = value;
+    if (value == 0.0)
+        addBreakeven(0.0);
+
+    for (std::size_t i = 0; i < slopeSteps.size();)
+    {
+        const double strike = slopeSteps[i].first;
+        double step = 0.0;
+        for (; i < slopeSteps.size() && slopeSteps[i].first == strike; ++i)
+            step += slopeSteps[i].second;
+        if (step == 0.0 || strike < 0.0)
+            continue;
+
+        const double next = value + slope * (strike - x);
+        if ((value < 0.0 && next > 0.0) || (value > 0.0 && next < 0.0))
+            addBreakeven(x - value * (strike - x) / (next - value));
+        if (next == 0.0)
+            addBreakeven(strike);
+
+        x = strike;
+        value = next;
+        slope += step;
+        lowest = std::min(lowest, value);
+        highest = std::max(highest, value);
+        profile.kinks.push_back(strike);
+    }
+
+    // Final ray beyond the last kink
+    if ((value < 0.0 && slope > 0.0) || (value > 0.0 && slope < 0.0))
+        addBreakeven(x - value / slope);
+    profile.maxProfit = slope > 0.0 ? HUGE_VAL : highest;
+    profile.maxLoss = slope < 0.0 ? HUGE_VAL : 0.0 - lowest; // never -0.0
+    return profile;
+}
+
 double Strategy::totalPrice() const
 {
     double total = 0.0;
@@ -46,7 +142,7 @@ double Strategy::totalDelta() const
     double delta = 0.0;
     for (const auto &leg : legs_)
     {
-        delta += leg.quantity * leg.option->delta();
+        delta += leg.quantity * leg.contract.greeks().delta;
     }
     return delta;
 }
@@ -56,7 +152,7 @@ double Strategy::totalGamma() const
     double gamma = 0.0;
     for (const auto &leg : legs_)
     {
-        gamma += leg.quantity * leg.option->gamma();
+        gamma += leg.quantity * leg.contract.greeks().gamma;
     }
     return gamma;
 }
@@ -66,7 +162,7 @@ double Strategy::totalVega() const
     double vega = 0.0;
     for (const auto &leg : legs_)
     {
-        vega += leg.quantity * leg.option->vega();
+        vega += leg.quantity * leg.contract.greeks().vega;
     }
     return vega;
 }
@@ -76,7 +172,7 @@ double Strategy::totalTheta() const
     double theta = 0.0;
     for (const auto &leg : legs_)
     {
-        theta += leg.quantity * leg.option->theta();
+        theta += leg.quantity * leg.contract.greeks().theta;
     }
     return theta;
 }
@@ -86,7 +182,23 @@ double Strategy::totalRho() const
     double rho = 0.0;
     for (const auto &leg : legs_)
     {
-        rho += leg.quantity * leg.option->rho();
+        rho += leg.quantity * leg.contract.greeks().rho;
     }
     return rho;
 }
+
+OptionGreeks Strategy::totalGreeks() const
+{
+    OptionGreeks total{};
+    for (const auto &leg : legs_)
+    {
+        OptionGreeks g = leg.contract.greeks();
+        total.price += leg.quantity * leg.initialPremium;
+        total.delta += leg.quantity * g.delta;
+        total.gamma += leg.quantity * g.gamma;
+        total.vega += leg.quantity * g.vega;
+        total.theta += leg.quantity * g.theta;
+        total.rho += leg.quantity * g.rho;
+    }
+    return total;
+}
@@ -53,7 +53,8 @@ namespace OptionPricer
         double S, double K1, double K2, double K3, double K4,
         double r, double sigma, double T, bool isShort)
     {
-        return std::make_shared<IronCondor>(S, K1, K2, K3, K4, r, sigma, T);
+        // K1..K4 ascend (long put, short put, short call, long call); IronCondor takes the short strikes first
+        return std::make_shared<IronCondor>(S, K2, K3, K1, K4, r, sigma, T);
     }
 
     std::vector<std::string> StrategyFactory::getAvailableStrategies()
@@ -0,0 +1,96 @@
+#ifndef OPTION_PRICER_TEST_ALLOC_H
+#define OPTION_PRICER_TEST_ALLOC_H
+
+// Replaces the global allocation functions to count heap allocations.
+// Replacements must be defined once per program, so include this from the
+// test's single translation unit only.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace OptionPricer
+{
+    namespace Tests
+    {
+
+        // Every operator new below counts here; scheduler workers allocate too, hence atomic
+        static std::atomic<std::size_t> heapAllocations{0};
+
+        // Every new and delete goes through this pair, so the optimiser never
+        // sees a pointer from operator new reach std::free
+        [[gnu::noinline]] static void *heapAllocate(std::size_t size, std::size_t alignment) noexcept
+        {
+            ++heapAllocations;
+            if (alignment <= alignof(std::max_align_t))
+                return std::malloc(size ? size : 1);
+            return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        }
+
+        [[gnu::noinline]] static void heapRelease(void *p) noexcept { std::free(p); }
+
+        static void *heapAllocateOrThrow(std::size_t size, std::size_t alignment)
+        {
+            if (void *p = heapAllocate(size, alignment))
+                return p;
+            throw std::bad_alloc();
+        }
+
+    }
+}
+
+// std::pmr::new_delete_resource allocates through the aligned overloads
+void *operator new(std::size_t size)
+{
+    return OptionPricer::Tests::heapAllocateOrThrow(size, alignof(std::max_align_t));
+}
+void *operator new[](std::size_t size)
+{
+    return OptionPricer::Tests::heapAllocateOrThrow(size, alignof(std::max_align_t));
+}
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    return OptionPricer::Tests::heapAllocateOrThrow(size, static_cast<std::size_t>(align));
+}
+void *operator new[](std::size_t size, std::align_val_t align)
+{
+    return OptionPricer::Tests::heapAllocateOrThrow(size, static_cast<std::size_t>(align));
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return OptionPricer::Tests::heapAllocate(size, alignof(std::max_align_t));
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return OptionPricer::Tests::heapAllocate(size, alignof(std::max_align_t));
+}
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept
+{
+    return OptionPricer::Tests::heapAllocate(size, static_cast<std::size_t>(align));
+}
+void *operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept
+{
+    return OptionPricer::Tests::heapAllocate(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void *p) noexcept { OptionPricer::Tests::heapRelease(p); }
+void operator delete[](void *p) noexcept { OptionPricer::Tests::heapRelease(p); }
+void operator delete(void *p, std::size_t) noexcept { OptionPricer::Tests::heapRelease(p); }
+void operator delete[](void *p, std::size_t) noexcept { OptionPricer::Tests::heapRelease(p); }
+void operator delete(void *p, std::align_val_t) noexcept { OptionPricer::Tests::heapRelease(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { OptionPricer::Tests::heapRelease(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { OptionPricer::Tests::heapRelease(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { OptionPricer::Tests::heapRelease(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { OptionPricer::Tests::heapRelease(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { OptionPricer::Tests::heapRelease(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    OptionPricer::Tests::heapRelease(p);
+}
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    OptionPricer::Tests::heapRelease(p);
+}
+
+#endif // OPTION_PRICER_TEST_ALLOC_H
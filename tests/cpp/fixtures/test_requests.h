@@ -0,0 +1,36 @@
+#ifndef OPTION_PRICER_TEST_REQUESTS_H
+#define OPTION_PRICER_TEST_REQUESTS_H
+
+#include <nlohmann/json.hpp>
+
+namespace OptionPricer
+{
+    namespace Tests
+    {
+
+        // A /api/portfolio body with legCount mixed legs, padded with keys and
+        // nested containers (including a "legs" array) the parser must skip
+        static nlohmann::json portfolioRequest(int legCount)
+        {
+            nlohmann::json request = {{"spot", 100.0}, {"rate", 0.05}, {"payoff_steps", 40},
+                                      {"legs", nlohmann::json::array()},
+                                      {"client", {{"legs", {1, 2, 3}}, {"name", "ignored"}}}};
+            for (int i = 0; i < legCount; ++i)
+            {
+                request["legs"].push_back({{"id", i},
+                                           {"optionType", i % 2 ? "put" : "call"},
+                                           {"type", i % 3 ? "european" : "american"},
+                                           {"strike", 80.0 + i},
+                                           {"volatility", 0.2 + 0.001 * i},
+                                           {"time", 0.5},
+                                           {"quantity", i % 4 - 2},
+                                           {"steps", 50},
+                                           {"tags", {"a", {{"nested", true}}}}});
+            }
+            return request;
+        }
+
+    }
+}
+
+#endif // OPTION_PRICER_TEST_REQUESTS_H
@@ -0,0 +1,435 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "api/PricingEndpoint.h"
+#include "models/AmericanApprox.h"
+#include "models/BinomialTree.h"
+#include "models/BlackScholes.h"
+#include "models/FiniteDifference.h"
+#include "concurrency/Scheduler.h"
+#include "options/AmericanOption.h"
+
+// Reference full-tree CRR pricer (O(N^2) memory) used to validate the rolling-buffer engine
+static double referenceTree(double S, double K, double r, double sigma, double T, bool isCall, int steps)
+{
+    double dt = T / steps;
+    double u = std::exp(sigma * std::sqrt(dt));
+    double d = 1.0 / u;
+    double p = (std::exp(r * dt) - d) / (u - d);
+    std::vector<std::vector<double>> tree(steps + 1, std::vector<double>(steps + 1, 0.0));
+    for (int j = 0; j <= steps; ++j)
+    {
+        double ST = S * std::pow(u, steps - 2.0 * j);
+        tree[steps][j] = isCall ? std::max(0.0, ST - K) : std::max(0.0, K - ST);
+    }
+    for (int i = steps - 1; i >= 0; --i)
+    {
+        for (int j = 0; j <= i; ++j)
+        {
+            double St = S * std::pow(u, i - 2.0 * j);
+            double hold = std::exp(-r * dt) * (p * tree[i + 1][j] + (1.0 - p) * tree[i + 1][j + 1]);
+            double ex = isCall ? std::max(0.0, St - K) : std::max(0.0, K - St);
+            tree[i][j] = std::max(hold, ex);
+        }
+    }
+    return tree[0][0];
+}
+
+int main()
+{
+    using OptionPricer::BinomialTree::americanPrice;
+
+    const double strikes[] = {80.0, 100.0, 120.0};
+    const int stepCounts[] = {1, 2, 49, 100};
+    for (double K : strikes)
+    {
+        for (int steps : stepCounts)
+        {
+            for (OptionKind kind : {OptionKind::Call, OptionKind::Put})
+            {
+                const bool isCall = kind == OptionKind::Call;
+                double fast = americanPrice(100.0, K, 0.05, 0.25, 0.75, kind, steps);
+                // Fewer than 2 steps build the 2-step tree the Greeks need
+                double ref = referenceTree(100.0, K, 0.05, 0.25, 0.75, isCall, std::max(2, steps));
+                if (std::abs(fast - ref) > 1e-9)
+                {
+                    std::cerr << "Lattice mismatch K=" << K << " steps=" << steps
+                              << " call=" << isCall << ": " << fast << " vs " << ref << std::endl;
+                    return 2;
+                }
+            }
+        }
+    }
+
+    // Well-known benchmark: American put S=K=100, r=5%, sigma=20%, T=1 is about 6.090
+    double put = americanPrice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 2000);
+    std::cout << "American put (2000 steps): " << put << std::endl;
+    if (std::abs(put - 6.090) > 0.005)
+    {
+        std::cerr << "American put deviates from reference: " << put << std::endl;
+        return 3;
+    }
+
+    // Without dividends the American call is never exercised early
+    double call = americanPrice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Call, 2000);
+    double european = BlackScholes::callPrice(100.0, 100.0, 0.05, 0.2, 1.0);
+    if (std::abs(call - european) > 0.005)
+    {
+        std::cerr << "American call deviates from European: " << call << " vs " << european << std::endl;
+        return 4;
+    }
+
+    // Single-pass lattice Greeks: a call is never exercised early, so they
+    // should converge to the Black-Scholes values
+    auto lattice = OptionPricer::BinomialTree::americanLattice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Call, 1000);
+    if (std::abs(lattice.price - americanPrice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Call, 1000)) > 1e-12 ||
+        std::abs(lattice.delta - BlackScholes::delta(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Call)) > 0.005 ||
+        std::abs(lattice.gamma - BlackScholes::gamma(100.0, 100.0, 0.05, 0.2, 1.0)) > 0.001 ||
+        std::abs(lattice.theta - BlackScholes::theta(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Call)) > 0.05)
+    {
+        std::cerr << "Lattice Greeks deviate from Black-Scholes: delta=" << lattice.delta
+                  << " gamma=" << lattice.gamma << " theta=" << lattice.theta << std::endl;
+        return 5;
+    }
+
+    // AmericanOption::greeks() must agree with the individual accessors
+    OptionPricer::AmericanOption amPut(100.0, 110.0, 0.05, 0.25, 0.5, OptionKind::Put, 200);
+    OptionGreeks g = amPut.greeks();
+    if (g.price != amPut.price() || g.delta != amPut.delta() || g.gamma != amPut.gamma() ||
+        g.vega != amPut.vega() || g.theta != amPut.theta() || g.rho != amPut.rho())
+    {
+        std::cerr << "AmericanOption::greeks() disagrees with accessors" << std::endl;
+        return 6;
+    }
+    if (!(g.delta < 0.0 && g.delta > -1.0 && g.gamma > 0.0 && g.vega > 0.0 && g.rho < 0.0))
+    {
+        std::cerr << "American put Greeks have wrong signs" << std::endl;
+        return 7;
+    }
+
+    // Faster-converging schemes against the same put (6.09036, from 20000+ step
+    // BBSR and Leisen-Reimer trees, which agree to 2e-5)
+    {
+        const double reference = 6.09036;
+        auto error = [&](AmericanModel scheme, int steps)
+        { return std::abs(americanPrice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, steps, scheme) - reference); };
+
+        // BBSR with 100 steps does about as well as CRR with 1000, and far better than CRR with 100
+        const double bbsr = error(AmericanModel::BBSR, 100);
+        if (bbsr > 1.2e-3 || error(AmericanModel::CRR, 100) < 5 * bbsr)
+        {
+            std::cerr << "BBSR does not converge faster than CRR: error " << bbsr << std::endl;
+            return 8;
+        }
+
+        // Leisen-Reimer rounds steps up to odd and converges without oscillating
+        double last = error(AmericanModel::LeisenReimer, 25);
+        if (error(AmericanModel::LeisenReimer, 100) != error(AmericanModel::LeisenReimer, 101))
+        {
+            std::cerr << "Leisen-Reimer did not round steps up to odd" << std::endl;
+            return 9;
+        }
+        for (int steps : {51, 101, 201, 401})
+        {
+            const double next = error(AmericanModel::LeisenReimer, steps);
+            if (next >= last)
+            {
+                std::cerr << "Leisen-Reimer error grew at " << steps << " steps: " << next << std::endl;
+                return 9;
+            }
+            last = next;
+        }
+        if (last > 1e-3 || error(AmericanModel::Trinomial, 1000) > 2.5e-3)
+        {
+            std::cerr << "Leisen-Reimer or trinomial tree off the reference" << std::endl;
+            return 9;
+        }
+
+        // Lattice Greeks from every scheme agree with a 2000-step CRR tree
+        const auto crr = OptionPricer::BinomialTree::americanLattice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 2000);
+        for (AmericanModel scheme : {AmericanModel::LeisenReimer, AmericanModel::BBSR, AmericanModel::Trinomial})
+        {
+            const auto l = OptionPricer::BinomialTree::americanLattice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 201,
+                                                                       scheme);
+            if (std::abs(l.delta - crr.delta) > 1e-3 || std::abs(l.gamma - crr.gamma) > 2e-4 ||
+                std::abs(l.theta - crr.theta) > 2e-2)
+            {
+                std::cerr << toString(scheme) << " Greeks deviate: delta=" << l.delta << " gamma=" << l.gamma
+                          << " theta=" << l.theta << std::endl;
+                return 10;
+            }
+        }
+    }
+
+    // The "model" field picks the scheme; unknown models are rejected, not priced as European
+    {
+        OptionPricer::API::OptionParams params;
+        params.type = "put";
+        params.model = "american_bbsr";
+        params.spot = params.strike = 100.0;
+        params.rate = 0.05;
+        params.volatility = 0.2;
+        params.time = 1.0;
+        params.steps = 100;
+        const auto priced = OptionPricer::API::PricingEndpoint::handlePriceRequest(params);
+        params.model = "american_crr";
+        const auto rejected = OptionPricer::API::PricingEndpoint::handlePriceRequest(params);
+        if (priced.value("model", "") != "american_bbsr" ||
+            priced.value("price", 0.0) != americanPrice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 100, AmericanModel::BBSR) ||
+            !rejected.contains("error"))
+        {
+            std::cerr << "Model dispatch is wrong: " << priced.dump() << " / " << rejected.dump() << std::endl;
+            return 11;
+        }
+    }
+
+    // Closed-form approximations against converged BBSR trees
+    {
+        namespace Approx = OptionPricer::AmericanApprox;
+        const double pi = std::acos(-1.0);
+        for (double rho : {-0.99, -0.6, 0.0, 0.4, 0.95})
+        {
+            if (std::abs(Approx::bivariateNormal(0.0, 0.0, rho) - (0.25 + std::asin(rho) / (2.0 * pi))) > 1e-14)
+            {
+                std::cerr << "Bivariate normal is wrong at rho=" << rho << std::endl;
+                return 12;
+            }
+        }
+
+        for (double T : {0.25, 1.0})
+        {
+            for (double spot : {90.0, 100.0, 110.0})
+            {
+                const double lattice = americanPrice(spot, 100.0, 0.05, 0.3, T, OptionKind::Put, 2000, AmericanModel::BBSR);
+                const double baw = Approx::baroneAdesiWhaley(spot, 100.0, 0.05, 0.3, T, OptionKind::Put);
+                const double bjs = Approx::bjerksundStensland(spot, 100.0, 0.05, 0.3, T, OptionKind::Put);
+                if (std::abs(baw - lattice) > 0.1 || bjs > lattice || lattice - bjs > 0.1)
+                {
+                    std::cerr << "Approximation off the lattice at S=" << spot << " T=" << T << ": lattice=" << lattice
+                              << " baw=" << baw << " bjs=" << bjs << std::endl;
+                    return 12;
+                }
+            }
+        }
+
+        // Deep in the money both exercise at once; calls are European without dividends
+        if (Approx::baroneAdesiWhaley(60.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put) != 40.0 ||
+            Approx::bjerksundStensland(60.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put) != 40.0 ||
+            std::abs(Approx::bjerksundStensland(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Call) -
+                     BlackScholes::callPrice(100.0, 100.0, 0.05, 0.2, 1.0)) > 1e-12)
+        {
+            std::cerr << "Approximation boundary cases are wrong" << std::endl;
+            return 12;
+        }
+
+        const auto crr = OptionPricer::BinomialTree::americanLattice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 2000);
+        for (AmericanModel model : {AmericanModel::BaroneAdesiWhaley, AmericanModel::BjerksundStensland})
+        {
+            const OptionPricer::AmericanOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 0, model);
+            const OptionGreeks a = option.greeks();
+            if (std::abs(a.delta - crr.delta) > 0.01 || std::abs(a.gamma - crr.gamma) > 1e-3 ||
+                std::abs(a.theta - crr.theta) > 0.05 || std::abs(option.delta() - a.delta) > 1e-12 ||
+                !(a.vega > 0.0 && a.rho < 0.0))
+            {
+                std::cerr << toString(model) << " Greeks deviate: delta=" << a.delta << " gamma=" << a.gamma
+                          << " theta=" << a.theta << std::endl;
+                return 12;
+            }
+        }
+
+        bool threw = false;
+        try
+        {
+            americanPrice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 100, AmericanModel::BaroneAdesiWhaley);
+        }
+        catch (const std::invalid_argument &)
+        {
+            threw = true;
+        }
+        OptionPricer::API::OptionParams params;
+        params.type = "put";
+        params.model = "american_bjs";
+        params.spot = params.strike = 100.0;
+        params.rate = 0.05;
+        params.volatility = 0.2;
+        params.time = 1.0;
+        const auto priced = OptionPricer::API::PricingEndpoint::handlePriceRequest(params);
+        if (!threw || priced.value("model", "") != "american_bjs" ||
+            priced.value("price", 0.0) != Approx::bjerksundStensland(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put))
+        {
+            std::cerr << "Closed-form dispatch is wrong: " << priced.dump() << std::endl;
+            return 12;
+        }
+    }
+
+    // PDE engine: one solve per expiry and type for a whole chain
+    {
+        namespace FD = OptionPricer::FiniteDifference;
+        const double reference = 6.09036;
+        const double coarse = std::abs(FD::americanPrice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, FD::gridForSteps(100)) - reference);
+        const double fine = std::abs(FD::americanPrice(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, FD::gridForSteps(400)) - reference);
+        if (fine > 5e-4 || coarse < 4 * fine)
+        {
+            std::cerr << "Finite-difference put does not converge: " << coarse << " then " << fine << std::endl;
+            return 13;
+        }
+
+        const OptionGreeks fd = FD::americanGreeks(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, FD::gridForSteps(400));
+        const OptionGreeks tree = OptionPricer::AmericanOption(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 1001,
+                                                               AmericanModel::LeisenReimer)
+                                      .greeks();
+        if (std::abs(fd.delta - tree.delta) > 1e-3 || std::abs(fd.gamma - tree.gamma) > 1e-4 ||
+            std::abs(fd.theta - tree.theta) > 0.01 || std::abs(fd.vega - tree.vega) > 0.05 ||
+            std::abs(fd.rho - tree.rho) > 0.1)
+        {
+            std::cerr << "Finite-difference Greeks deviate: delta=" << fd.delta << " gamma=" << fd.gamma
+                      << " vega=" << fd.vega << " theta=" << fd.theta << " rho=" << fd.rho << std::endl;
+            return 13;
+        }
+
+        // Puts and calls over two expiries with a smile, against Leisen-Reimer strike by strike
+        std::vector<double> strikes, vols, times;
+        std::vector<OptionKind> kinds;
+        for (double T : {0.5, 1.0})
+            for (OptionKind kind : {OptionKind::Put, OptionKind::Call})
+                for (int i = 0; i <= 10; ++i)
+                {
+                    strikes.push_back(80.0 + 4.0 * i);
+                    vols.push_back(0.25 - 0.005 * i);
+                    times.push_back(T);
+                    kinds.push_back(kind);
+                }
+        const std::size_t n = strikes.size();
+        std::vector<double> price(n), delta(n);
+        FD::americanChain({100.0, 0.05, strikes.data(), vols.data(), times.data(), kinds.data(), n},
+                          {price.data(), delta.data(), nullptr, nullptr, nullptr, nullptr},
+                          OptionPricer::Scheduler::shared(), FD::gridForSteps(200));
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const auto l = OptionPricer::BinomialTree::americanLattice(100.0, strikes[i], 0.05, vols[i], times[i], kinds[i],
+                                                                       1001, AmericanModel::LeisenReimer);
+            if (std::abs(price[i] - l.price) > 2e-3 || std::abs(delta[i] - l.delta) > 1e-3)
+            {
+                std::cerr << "Finite-difference chain off at K=" << strikes[i] << " T=" << times[i] << ": " << price[i]
+                          << " vs " << l.price << std::endl;
+                return 13;
+            }
+        }
+
+        const auto chain = OptionPricer::API::PricingEndpoint::handleChainRequest(
+            {{"type", "put"}, {"model", "american_fd"}, {"spot", 100.0}, {"rate", 0.05}, {"volatility", 0.2},
+             {"time", 1.0}, {"steps", 400}, {"strikes", {90.0, 100.0, 110.0}}});
+        const auto rejected = OptionPricer::API::PricingEndpoint::handleChainRequest(
+            {{"type", "put"}, {"model", "american_fd"}, {"spot", 100.0}, {"rate", 0.05}, {"volatility", 0.2},
+             {"time", 1.0}, {"steps", 2}, {"strikes", {100.0}}});
+        if (chain.value("model", "") != "american_fd" || std::abs(chain["price"][1].get<double>() - reference) > 5e-4 ||
+            !rejected.contains("error"))
+        {
+            std::cerr << "Chain model dispatch is wrong: " << chain.dump() << std::endl;
+            return 13;
+        }
+    }
+
+    // Adjoint sensitivities are the derivatives of the lattice price itself:
+    // they match small central differences of americanPrice on every scheme,
+    // with the whole tree on tape (101 steps) and with checkpoints (801), where
+    // more nodes sit near the exercise boundary and the differences get noisier
+    for (AmericanModel scheme : {AmericanModel::CRR, AmericanModel::LeisenReimer, AmericanModel::BBSR,
+                                 AmericanModel::Trinomial})
+        for (OptionKind kind : {OptionKind::Put, OptionKind::Call})
+            for (int steps : {101, 801})
+                {
+                    const double S = 100.0, K = 105.0, r = 0.05, sigma = 0.25, T = 0.75;
+                    const auto s = OptionPricer::BinomialTree::americanSensitivities(S, K, r, sigma, T, kind, steps, scheme);
+                    const auto at = [&](double dS, double dK, double dr, double dSigma, double dT)
+                    {
+                        return americanPrice(S + dS, K + dK, r + dr, sigma + dSigma, T + dT, kind, steps, scheme);
+                    };
+                    const double h = 1e-5;
+                    const double tolerance = steps > 101 ? 1e-4 : 1e-5;
+                    const double expected[5] = {(at(h, 0, 0, 0, 0) - at(-h, 0, 0, 0, 0)) / (2 * h),
+                                                (at(0, h, 0, 0, 0) - at(0, -h, 0, 0, 0)) / (2 * h),
+                                                (at(0, 0, h, 0, 0) - at(0, 0, -h, 0, 0)) / (2 * h),
+                                                (at(0, 0, 0, h, 0) - at(0, 0, 0, -h, 0)) / (2 * h),
+                                                (at(0, 0, 0, 0, h) - at(0, 0, 0, 0, -h)) / (2 * h)};
+                    const double adjoint[5] = {s.dSpot, s.dStrike, s.dRate, s.dSigma, s.dTime};
+                    const auto lattice = OptionPricer::BinomialTree::americanLattice(S, K, r, sigma, T, kind, steps, scheme);
+                    for (int i = 0; i < 5; ++i)
+                    {
+                        if (std::abs(adjoint[i] - expected[i]) > tolerance * std::max(1.0, std::abs(expected[i])) ||
+                            s.lattice.price != lattice.price || s.lattice.delta != lattice.delta ||
+                            s.lattice.gamma != lattice.gamma || s.lattice.theta != lattice.theta)
+                        {
+                            std::cerr << "Adjoint sensitivity " << i << " of " << toString(scheme) << " at " << steps
+                                      << " steps is " << adjoint[i]
+                                      << ", finite difference " << expected[i] << std::endl;
+                            return 14;
+                        }
+                    }
+                }
+
+    // SIMD-across-options lattice: every lane bit-identical to the scalar
+    // engine, over mixed kinds, a negative rate, an expired option, a lone
+    // last option in its pass and the schemes it hands back to the scalar path
+    {
+        std::vector<double> spots, strikes, rates, sigmas, times;
+        std::vector<OptionKind> kinds;
+        for (int i = 0; i < 13; ++i)
+        {
+            spots.push_back(80.0 + 3.0 * i);
+            strikes.push_back(100.0);
+            rates.push_back(i == 5 ? -0.01 : 0.01 + 0.005 * i);
+            sigmas.push_back(0.1 + 0.03 * i);
+            times.push_back(i == 9 ? 0.0 : 0.1 + 0.15 * i);
+            kinds.push_back(i % 3 ? OptionKind::Put : OptionKind::Call);
+        }
+        for (AmericanModel scheme : {AmericanModel::CRR, AmericanModel::BBSR, AmericanModel::LeisenReimer})
+            for (int steps : {2, 3, 50, 101, 801})
+                for (std::size_t count : {std::size_t(1), OptionPricer::BinomialTree::batchLanes() + 1, spots.size()})
+                {
+                    std::vector<OptionPricer::BinomialTree::LatticeSensitivities> batch(count);
+                    OptionPricer::BinomialTree::americanSensitivitiesBatch(
+                        {spots.data(), strikes.data(), rates.data(), sigmas.data(), times.data(), kinds.data(), count},
+                        steps, scheme, batch.data());
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        const auto s = OptionPricer::BinomialTree::americanSensitivities(
+                            spots[i], strikes[i], rates[i], sigmas[i], times[i], kinds[i], steps, scheme);
+                        const auto &b = batch[i];
+                        if (b.lattice.price != s.lattice.price || b.lattice.delta != s.lattice.delta ||
+                            b.lattice.gamma != s.lattice.gamma || b.lattice.theta != s.lattice.theta ||
+                            b.dSpot != s.dSpot || b.dStrike != s.dStrike || b.dRate != s.dRate ||
+                            b.dSigma != s.dSigma || b.dTime != s.dTime)
+                        {
+                            std::cerr << "Batched " << toString(scheme) << " lattice (" << count << " options, "
+                                      << OptionPricer::BinomialTree::batchLanes() << " lanes) differs from the scalar engine at option "
+                                      << i << ", " << steps << " steps" << std::endl;
+                            return 15;
+                        }
+                    }
+                }
+    }
+
+    // price() and greeks().price value the same tree, even for step counts
+    // below the lattices' minimums
+    for (AmericanModel model : {AmericanModel::CRR, AmericanModel::LeisenReimer, AmericanModel::BBSR,
+                                AmericanModel::Trinomial})
+        for (OptionKind kind : {OptionKind::Put, OptionKind::Call})
+            for (int steps : {1, 2, 3})
+            {
+                OptionPricer::AmericanOption option(100.0, 105.0, 0.05, 0.25, 0.75, kind, steps, model);
+                const double price = option.price();
+                const double greeksPrice = option.greeks().price;
+                if (price != greeksPrice)
+                {
+                    std::cerr << toString(model) << " price() " << price << " differs from greeks().price "
+                              << greeksPrice << " at " << steps << " steps" << std::endl;
+                    return 16;
+                }
+            }
+
+    std::cout << "American lattice test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <memory_resource>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include "api/PricingEndpoint.h"
+#include "api/RequestArena.h"
+#include "test_alloc.h"
+#include "test_requests.h"
+
+using namespace OptionPricer::API;
+using namespace OptionPricer::Tests;
+using json = nlohmann::json;
+
+int main()
+{
+    // Outside a Scope the arena is the default resource; nested scopes share one arena
+    if (RequestArena::resource() != std::pmr::get_default_resource())
+    {
+        std::cerr << "resource() outside a Scope is not the default resource" << std::endl;
+        return 2;
+    }
+    {
+        RequestArena::Scope outer;
+        std::pmr::memory_resource *arena = RequestArena::resource();
+        {
+            RequestArena::Scope inner;
+            if (arena == std::pmr::get_default_resource() || RequestArena::resource() != arena)
+            {
+                std::cerr << "Nested scope does not share the outer arena" << std::endl;
+                return 2;
+            }
+        }
+        if (RequestArena::resource() != arena)
+        {
+            std::cerr << "Closing a nested scope ended the outer arena" << std::endl;
+            return 2;
+        }
+    }
+    if (RequestArena::resource() != std::pmr::get_default_resource())
+    {
+        std::cerr << "Arena still active after its Scope closed" << std::endl;
+        return 2;
+    }
+
+    // Parsing a 64-leg request into the arena takes no heap allocation once
+    // the thread's buffer exists (the first Scope above created it)
+    const json request = portfolioRequest(64);
+    {
+        RequestArena::Scope scope;
+        const std::size_t before = heapAllocations;
+        const auto legs = PricingEndpoint::parseLegs(request);
+        const std::size_t allocations = heapAllocations - before;
+        if (allocations != 0 || legs.size() != 64 || legs.get_allocator().resource() != RequestArena::resource())
+        {
+            std::cerr << "Arena parseLegs allocated " << allocations << " times" << std::endl;
+            return 3;
+        }
+    }
+
+    // The response is identical in and out of a Scope, with fewer allocations inside
+    PricingEndpoint::buildPortfolioResponse(request); // warm the Greeks cache
+    std::size_t before = heapAllocations;
+    const std::string heapJson = PricingEndpoint::buildPortfolioResponse(request).toJson().dump();
+    const std::size_t heapCount = heapAllocations - before;
+    std::string arenaJson;
+    std::size_t arenaCount = 0;
+    {
+        RequestArena::Scope scope;
+        before = heapAllocations;
+        arenaJson = PricingEndpoint::buildPortfolioResponse(request).toJson().dump();
+        arenaCount = heapAllocations - before;
+    }
+    if (arenaJson != heapJson)
+    {
+        std::cerr << "Arena portfolio response differs from the heap one" << std::endl;
+        return 4;
+    }
+    if (arenaCount >= heapCount)
+    {
+        std::cerr << "Arena portfolio response allocated " << arenaCount << " times, heap " << heapCount
+                  << std::endl;
+        return 5;
+    }
+
+    // Overflowing the buffer falls back to the heap and still rewinds cleanly
+    for (int round = 0; round < 3; ++round)
+    {
+        RequestArena::Scope scope;
+        std::pmr::vector<double> big(RequestArena::BufferBytes / sizeof(double) * 2, 1.0, RequestArena::resource());
+        if (big.back() != 1.0)
+            return 6;
+    }
+
+    // prepare() allocates a thread's buffer once, up front; its first Scope then allocates nothing
+    std::size_t prepareCount = 0, repeatCount = 0, scopeCount = 0;
+    std::thread fresh([&]
+                      {
+        std::size_t mark = heapAllocations;
+        RequestArena::prepare();
+        prepareCount = heapAllocations - mark;
+        mark = heapAllocations;
+        RequestArena::prepare();
+        repeatCount = heapAllocations - mark;
+        mark = heapAllocations;
+        {
+            RequestArena::Scope scope;
+        }
+        scopeCount = heapAllocations - mark; });
+    fresh.join();
+    if (prepareCount != 1 || repeatCount != 0 || scopeCount != 0)
+    {
+        std::cerr << "Prepared arena allocated " << prepareCount << ", " << repeatCount << " and " << scopeCount
+                  << " times" << std::endl;
+        return 7;
+    }
+
+    std::cout << "Arena test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "api/JsonSerializer.h"
+#include "api/PricingEndpoint.h"
+
+using namespace OptionPricer::API;
+using json = nlohmann::json;
+
+// The SIMD chain kernel matches the scalar closed form to ~1e-13 relative
+static bool close(const json &batch, const json &single)
+{
+    for (const char *field : {"price", "delta", "gamma", "vega", "theta", "rho"})
+    {
+        const double a = batch[field].get<double>();
+        const double b = single[field].get<double>();
+        if (std::abs(a - b) > 1e-11 * (1.0 + std::abs(b)))
+            return false;
+    }
+    return batch["model"] == single["model"] && batch["type"] == single["type"] &&
+           batch["spot"] == single["spot"] && batch["strike"] == single["strike"];
+}
+
+int main()
+{
+    // Mixed book: European and American calls and puts, repeated inputs, and bad entries
+    json requests = json::array();
+    for (int i = 0; i < 600; ++i)
+    {
+        const int k = i % 150; // every contract appears four times
+        requests.push_back({{"type", k % 2 ? "put" : "call"},
+                            {"model", k % 5 ? "european" : "american"},
+                            {"spot", 100},
+                            {"strike", 70.0 + k * 0.5},
+                            {"rate", 0.03},
+                            {"volatility", 0.15 + 0.001 * k},
+                            {"time", 0.25 + 0.01 * k},
+                            {"steps", 60}});
+    }
+    requests.push_back({{"type", "call"}, {"spot", 100}});                                         // missing fields
+    requests.push_back({{"type", "call"}, {"spot", -1}, {"strike", 100}, {"rate", 0.05}, {"volatility", 0.2}, {"time", 1}}); // non-positive
+    requests.push_back({{"type", "straddle"}, {"spot", 100}, {"strike", 100}, {"rate", 0.05}, {"volatility", 0.2}, {"time", 1}});
+    requests.push_back(42);
+
+    const json response = PricingEndpoint::handlePriceBatchRequest(requests);
+    const json &results = response["results"];
+    if (response["status"] != "success" || response["count"] != requests.size() || response["unique"] != 150 ||
+        results.size() != requests.size())
+    {
+        std::cerr << "Batch has the wrong shape: " << response.dump().substr(0, 200) << std::endl;
+        return 2;
+    }
+
+    // Every entry matches pricing it alone: errors exactly, American exactly
+    // (same lattice), European to kernel accuracy
+    for (std::size_t i = 0; i < requests.size(); ++i)
+    {
+        const json single = requests[i].is_object() ? PricingEndpoint::handlePriceRequest(requests[i])
+                                                    : json{{"error", "Each request must be an object"}, {"status", "error"}};
+        const bool american = requests[i].is_object() && requests[i].value("model", "") == "american";
+        const bool ok = single.contains("error") || american ? results[i] == single : close(results[i], single);
+        if (!ok)
+        {
+            std::cerr << "Entry " << i << " differs: " << results[i].dump() << " vs " << single.dump() << std::endl;
+            return 3;
+        }
+    }
+
+    // The SAX array path and NDJSON decode the same items; a malformed NDJSON
+    // line fails only itself
+    {
+        std::string ndjson;
+        for (const auto &request : requests)
+            ndjson += request.dump() + "\r\n";
+        ndjson += "{\"type\":\"call\",\n\n";
+        const auto fromArray = JsonSerializer::parseOptionBatch("  " + requests.dump());
+        auto fromLines = JsonSerializer::parseOptionBatch(ndjson);
+        if (PricingEndpoint::handlePriceBatchRequest(fromArray) != response || fromLines.size() != requests.size() + 1 ||
+            fromLines.back().error.find("parse error") == std::string::npos)
+        {
+            std::cerr << "Array and NDJSON batches decode differently" << std::endl;
+            return 4;
+        }
+        fromLines.pop_back();
+        const json lines = PricingEndpoint::handlePriceBatchRequest(fromLines);
+        if (lines != response)
+        {
+            std::cerr << "NDJSON batch priced differently" << std::endl;
+            return 4;
+        }
+    }
+
+    // Degenerate batches
+    if (PricingEndpoint::handlePriceBatchRequest(json::array())["results"] != json::array() ||
+        !JsonSerializer::parseOptionBatch("").empty() ||
+        !PricingEndpoint::handlePriceBatchRequest(json::object()).contains("error"))
+    {
+        std::cerr << "Degenerate batches are wrong" << std::endl;
+        return 5;
+    }
+
+    std::cout << "Batch test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,486 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "api/BinaryProtocol.h"
+#include "api/BinaryServer.h"
+#include "api/PricingEndpoint.h"
+#include "api/ResponseWriter.h"
+#include "api/RiskCoordinator.h"
+#include "concurrency/Cancellation.h"
+#include "concurrency/Scheduler.h"
+#include "models/MonteCarloRisk.h"
+
+using namespace OptionPricer::API;
+namespace Binary = OptionPricer::API::BinaryProtocol;
+using json = nlohmann::json;
+
+static OptionParams option(const char *type, const char *model, double strike, double volatility)
+{
+    OptionParams params;
+    params.type = type;
+    params.model = model;
+    params.spot = 100.0;
+    params.strike = strike;
+    params.rate = 0.03;
+    params.volatility = volatility;
+    params.time = 0.75;
+    params.steps = 80;
+    return params;
+}
+
+// The SIMD kernel and its scalar tail agree to ~1e-13 relative
+static bool close(const OptionGreeks &g, const json &expected)
+{
+    const double values[] = {g.price, g.delta, g.gamma, g.vega, g.theta, g.rho};
+    const char *fields[] = {"price", "delta", "gamma", "vega", "theta", "rho"};
+    for (int i = 0; i < 6; ++i)
+    {
+        const double b = expected[fields[i]].get<double>();
+        if (std::abs(values[i] - b) > 1e-11 * (1.0 + std::abs(b)))
+            return false;
+    }
+    return true;
+}
+
+static std::vector<Binary::Frame> frames(std::string_view buffer)
+{
+    std::vector<Binary::Frame> out;
+    Binary::Frame frame;
+    while (Binary::nextFrame(buffer, frame, 1u << 30))
+        out.push_back(frame);
+    if (!buffer.empty())
+        throw std::runtime_error("Trailing partial frame");
+    return out;
+}
+
+static int connectTo(const BinaryServer &server, bool unixSocket)
+{
+    if (unixSocket)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::snprintf(address.sun_path, sizeof address.sun_path, "%s", server.config().unixPath.c_str());
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        return ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof address) == 0 ? fd : -1;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(server.port()));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    return ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof address) == 0 ? fd : -1;
+}
+
+// Read until `count` whole frames have arrived or the peer closes; frames
+// point into the returned buffer
+static std::string readFrames(int fd, std::size_t count)
+{
+    std::string buffer;
+    char chunk[1 << 16];
+    for (;;)
+    {
+        std::string_view view = buffer;
+        Binary::Frame frame;
+        std::size_t complete = 0;
+        while (Binary::nextFrame(view, frame, 1u << 30))
+            ++complete;
+        if (complete >= count)
+            return buffer;
+        const ssize_t n = ::recv(fd, chunk, sizeof chunk, 0);
+        if (n <= 0)
+            return buffer;
+        buffer.append(chunk, static_cast<std::size_t>(n));
+    }
+}
+
+// A TCP listener that accepts connections (in the kernel backlog) but never
+// answers: a worker that hangs mid-partition
+static int silentListener(int &port)
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof address;
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof address) != 0 || ::listen(fd, 16) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) != 0)
+        throw std::runtime_error("Could not open a listener");
+    port = ntohs(address.sin_port);
+    return fd;
+}
+
+int main()
+{
+    // A mixed request stream, answered against the JSON endpoints
+    std::vector<OptionParams> options;
+    for (int i = 0; i < 40; ++i)
+        options.push_back(option(i % 2 ? "put" : "call", i % 5 ? "european" : "american", 80.0 + i, 0.15 + 0.005 * i));
+    OptionParams negative = option("call", "european", 100.0, 0.2);
+    negative.spot = -1.0;
+
+    std::string badKind;
+    Binary::appendOption(badKind, options[0]);
+    badKind[0] = 7;
+
+    PortfolioParams portfolio;
+    portfolio.spot = 100.0;
+    portfolio.rate = 0.03;
+    portfolio.payoffSteps = 50;
+    for (int i = 0; i < 6; ++i)
+        portfolio.legs.push_back({i % 2 ? "put" : "call", i % 3 ? "european" : "american", 90.0 + 4 * i, 0.2, 0.5, i - 3, 60});
+
+    std::string requests;
+    std::uint32_t id = 100;
+    Binary::appendFrame(requests, id++, Binary::Opcode::Ping, Binary::Status::Ok, "");
+    for (const auto &params : options)
+    {
+        std::string payload;
+        Binary::appendOption(payload, params);
+        Binary::appendFrame(requests, id++, Binary::Opcode::Price, Binary::Status::Ok, payload);
+    }
+    {
+        std::string payload;
+        Binary::appendOption(payload, negative);
+        Binary::appendFrame(requests, id++, Binary::Opcode::Price, Binary::Status::Ok, payload);
+    }
+    Binary::appendFrame(requests, id++, Binary::Opcode::Price, Binary::Status::Ok, badKind);
+    Binary::appendFrame(requests, id++, Binary::Opcode::PriceBatch, Binary::Status::Ok, Binary::encodePriceBatch(options));
+    Binary::appendFrame(requests, id++, Binary::Opcode::Portfolio, Binary::Status::Ok, Binary::encodePortfolio(portfolio));
+    Binary::appendFrame(requests, id++, static_cast<Binary::Opcode>(99), Binary::Status::Ok, "");
+    const std::size_t requestCount = id - 100;
+
+    std::string responses;
+    if (Binary::handleFrames(requests, responses, 1u << 20) != requests.size())
+    {
+        std::cerr << "Complete frames were not all consumed" << std::endl;
+        return 2;
+    }
+
+    // Responses in request order, each matching what the JSON API answers
+    std::vector<OptionBatchItem> items;
+    for (const auto &params : options)
+        items.push_back({params, ""});
+    const json expected = PricingEndpoint::handlePriceBatchRequest(items)["results"];
+    {
+        const std::vector<Binary::Frame> answered = frames(responses);
+        bool ok = answered.size() == requestCount;
+        for (std::size_t i = 0; ok && i < answered.size(); ++i)
+            ok = answered[i].id == 100 + i;
+
+        ok = ok && answered[0].status == 0 && answered[0].payload.empty();
+        for (std::size_t i = 0; ok && i < options.size(); ++i)
+            ok = answered[1 + i].status == 0 && close(Binary::decodeGreeks(answered[1 + i].payload), expected[i]);
+
+        const Binary::Frame &negativeAnswer = answered[41], &badKindAnswer = answered[42];
+        ok = ok && negativeAnswer.status == 1 && negativeAnswer.payload == "Parameters must be positive" &&
+             badKindAnswer.status == 1 && badKindAnswer.payload == "Invalid option type code: 7";
+
+        const std::vector<Binary::PriceResult> batch = Binary::decodePriceBatchResults(answered[43].payload);
+        ok = ok && batch.size() == options.size();
+        for (std::size_t i = 0; ok && i < batch.size(); ++i)
+            ok = batch[i].error.empty() && close(batch[i].greeks, expected[i]);
+
+        const std::string oprb = ResponseWriter::write(PricingEndpoint::buildPortfolioResponse(portfolio),
+                                                       ResponseWriter::Format::Binary);
+        ok = ok && answered[44].status == 0 && answered[44].payload == oprb;
+        ok = ok && answered[45].status == 1 && answered[45].payload == "Unknown opcode: 99";
+        if (!ok)
+        {
+            std::cerr << "Binary responses differ from the JSON API" << std::endl;
+            return 3;
+        }
+    }
+
+    // Frames split across reads: nothing is answered until a frame is whole,
+    // and the answers match the one-shot run
+    {
+        std::string buffer, output;
+        for (char byte : requests)
+        {
+            buffer += byte;
+            buffer.erase(0, Binary::handleFrames(buffer, output, 1u << 20));
+        }
+        const auto a = frames(output), b = frames(responses);
+        bool ok = buffer.empty() && a.size() == b.size();
+        for (std::size_t i = 0; ok && i < a.size(); ++i)
+            ok = a[i].id == b[i].id && a[i].status == b[i].status && a[i].payload.size() == b[i].payload.size();
+        if (!ok)
+        {
+            std::cerr << "Incremental decoding differs" << std::endl;
+            return 4;
+        }
+    }
+
+    // Bad framing and malformed payloads
+    {
+        std::string output;
+        bool rejected = false;
+        try
+        {
+            Binary::handleFrames(std::string("\x04\0\0\0\0\0\0\0", 8), output, 1024);
+        }
+        catch (const std::length_error &)
+        {
+            rejected = true;
+        }
+        std::string huge;
+        Binary::appendFrame(huge, 1, Binary::Opcode::Ping, Binary::Status::Ok, std::string(2048, 'x'));
+        bool oversize = false;
+        try
+        {
+            Binary::handleFrames(huge.substr(0, 16), output, 1024);
+        }
+        catch (const std::length_error &)
+        {
+            oversize = true;
+        }
+        std::string truncated;
+        Binary::appendFrame(truncated, 1, Binary::Opcode::Portfolio, Binary::Status::Ok, "short");
+        Binary::handleFrames(truncated, output, 1024);
+        const auto answered = frames(output);
+        if (!rejected || !oversize || answered.size() != 1 || answered[0].status != 1 ||
+            answered[0].payload != "Truncated payload")
+        {
+            std::cerr << "Bad frames were not rejected" << std::endl;
+            return 5;
+        }
+    }
+
+    // Live server: a pipelined burst in one write gets every answer, in order,
+    // over both TCP and a unix socket
+    {
+        BinaryServer::Config config;
+        config.port = 0;
+        config.unixPath = "/tmp/option_pricer_test_" + std::to_string(::getpid()) + ".sock";
+        config.maxFrameBytes = 1u << 20;
+        BinaryServer server(config);
+        server.start();
+
+        for (bool unixSocket : {false, true})
+        {
+            const int fd = connectTo(server, unixSocket);
+            std::string burst;
+            for (int round = 0; round < 50; ++round)
+                burst += requests;
+            if (fd < 0 || ::send(fd, burst.data(), burst.size(), 0) != static_cast<ssize_t>(burst.size()))
+            {
+                std::cerr << "Could not send to the binary server" << std::endl;
+                return 6;
+            }
+            const std::string received = readFrames(fd, 50 * requestCount);
+            const auto answered = frames(received);
+            bool ok = answered.size() == 50 * requestCount;
+            for (std::size_t i = 0; ok && i < answered.size(); ++i)
+            {
+                const std::size_t k = i % requestCount;
+                ok = answered[i].id == 100 + k && answered[i].status == (((k >= 41 && k <= 42) || k == 45) ? 1 : 0);
+                if (ok && k >= 1 && k <= 40)
+                    ok = close(Binary::decodeGreeks(answered[i].payload), expected[k - 1]);
+            }
+            ::close(fd);
+            if (!ok)
+            {
+                std::cerr << "Pipelined answers are wrong over " << (unixSocket ? "unix" : "tcp") << std::endl;
+                return 6;
+            }
+        }
+
+        // An oversize frame closes only its own connection
+        {
+            const int fd = connectTo(server, false);
+            std::string huge;
+            Binary::appendFrame(huge, 1, Binary::Opcode::Ping, Binary::Status::Ok, std::string(2u << 20, 'x'));
+            ::send(fd, huge.data(), 64, 0);
+            const bool closed = readFrames(fd, 1).empty();
+            ::close(fd);
+            const int other = connectTo(server, true);
+            std::string ping;
+            Binary::appendFrame(ping, 7, Binary::Opcode::Ping, Binary::Status::Ok, "");
+            ::send(other, ping.data(), ping.size(), 0);
+            const std::string received = readFrames(other, 1);
+            const auto answered = frames(received);
+            if (!closed || answered.size() != 1 || answered[0].id != 7)
+            {
+                std::cerr << "Oversize frame handling is wrong" << std::endl;
+                return 7;
+            }
+
+            // stop() answers what was sent, then closes open connections
+            ::send(other, ping.data(), ping.size(), 0);
+            if (frames(readFrames(other, 1)).size() != 1)
+                return 7;
+            server.stop();
+            const bool eof = readFrames(other, 1).empty();
+            ::close(other);
+            if (!eof || server.isRunning() || ::access(config.unixPath.c_str(), F_OK) == 0)
+            {
+                std::cerr << "Binary server did not stop cleanly" << std::endl;
+                return 8;
+            }
+        }
+    }
+
+    // Distributed risk: RiskPartition requests fanned out by RiskCoordinator
+    {
+        using OptionPricer::MonteCarloRisk::Spec;
+        namespace MonteCarloRisk = OptionPricer::MonteCarloRisk;
+        const std::vector<std::pair<OptionContract, int>> positions = {
+            {OptionContract::european(100.0, 100.0, 0.03, 0.22, 0.5, OptionKind::Call), -2},
+            {OptionContract::european(100.0, 95.0, 0.03, 0.25, 0.5, OptionKind::Put), 3},
+            {OptionContract::american(100.0, 90.0, 0.03, 0.27, 0.75, OptionKind::Put, 60), 1},
+            {OptionContract::european(100.0, 110.0, 0.03, 0.2, 0.25, OptionKind::Call), 4}};
+        OptionPricer::RiskMeasures::Portfolio portfolio;
+        for (const auto &position : positions)
+            portfolio.emplace_back(position.first.toOption(), position.second);
+        Spec spec;
+        spec.paths = 20001;
+        spec.volOfVol = 0.8;
+        spec.correlation = -0.4;
+        spec.seed = 7;
+        const std::vector<double> confidences = {0.95, 0.99};
+        const auto local = MonteCarloRisk::run(portfolio, spec, confidences, OptionPricer::Scheduler::shared());
+
+        // Tasks survive the wire, and a worker answers with exactly runPartial's P&L
+        Binary::RiskTask task;
+        task.positions = positions;
+        task.spec = spec;
+        task.spec.taylor = true;
+        task.spec.gammaThreshold = 0.02;
+        task.spec.accuracy = OptionPricer::Normal::Accuracy::Table;
+        task.begin = 100;
+        task.end = 900;
+        const Binary::RiskTask decoded = Binary::decodeRiskTask(Binary::encodeRiskTask(task));
+        std::string request, response;
+        Binary::appendFrame(request, 1, Binary::Opcode::RiskPartition, Binary::Status::Ok, Binary::encodeRiskTask(task));
+        Binary::handleFrames(request, response, 1u << 30);
+        const auto answer = frames(response);
+        const auto partial = Binary::decodeRiskPartial(answer.at(0).payload);
+        const auto expected = MonteCarloRisk::runPartial(portfolio, task.spec, 100, 900, false, 100.0,
+                                                         OptionPricer::Scheduler::shared());
+        if (decoded.positions.size() != 4 || decoded.positions[2].first.steps != 60 ||
+            decoded.positions[3].second != 4 || decoded.spec.seed != 7 || !decoded.spec.taylor ||
+            decoded.spec.gammaThreshold != 0.02 || decoded.spec.correlation != -0.4 || decoded.end != 900 ||
+            decoded.spec.accuracy != OptionPricer::Normal::Accuracy::Table ||
+            partial.pnl != expected.pnl || partial.baseValue != expected.baseValue ||
+            partial.fullyRevaluedLegs != expected.fullyRevaluedLegs)
+        {
+            std::cerr << "RiskPartition round trip is wrong" << std::endl;
+            return 9;
+        }
+
+        BinaryServer::Config workerConfig;
+        workerConfig.port = 0;
+        BinaryServer first(workerConfig), second(workerConfig);
+        first.start();
+        second.start();
+        RiskCoordinator::Config config;
+        config.minPartitionPaths = 1000;
+        RiskCoordinator coordinator(config);
+        coordinator.addWorker("127.0.0.1:" + std::to_string(first.port()));
+        coordinator.addWorker("127.0.0.1:" + std::to_string(second.port()));
+        coordinator.addWorker("127.0.0.1:" + std::to_string(first.port()));
+
+        RiskCoordinator::Job job;
+        job.positions = positions;
+        job.spec = spec;
+        job.confidences = confidences;
+        const auto scenarios = coordinator.run(job);
+        job.partitioning = RiskCoordinator::Partitioning::Positions;
+        const auto byPositions = coordinator.run(job);
+        job.partitioning = RiskCoordinator::Partitioning::Scenarios;
+        job.summarise = true;
+        const auto digest = coordinator.run(job);
+        std::cout << "Distributed ES99 exact " << scenarios.result.levels[1].es << " digest "
+                  << digest.result.levels[1].es << " over " << scenarios.partitions << " partitions" << std::endl;
+        const auto same = [&](const MonteCarloRisk::Result &r, double tolerance)
+        {
+            const auto near = [&](double a, double b)
+            { return std::abs(a - b) <= tolerance * (1.0 + std::abs(b)); };
+            bool ok = r.paths == local.paths && near(r.baseValue, local.baseValue) && near(r.meanPnl, local.meanPnl) &&
+                      near(r.stdevPnl, local.stdevPnl) && near(r.maxLoss, local.maxLoss) && r.pop == local.pop;
+            for (std::size_t l = 0; l < confidences.size(); ++l)
+                ok = ok && near(r.levels[l].var, local.levels[l].var) && near(r.levels[l].es, local.levels[l].es);
+            return ok;
+        };
+        if (coordinator.workers().size() != 2 || scenarios.partitions != 8 || scenarios.approximate ||
+            !same(scenarios.result, 0.0) || byPositions.partitions != 4 || !same(byPositions.result, 1e-9) ||
+            !digest.approximate || std::abs(digest.result.levels[1].es - local.levels[1].es) > 1e-3 * local.levels[1].es ||
+            std::abs(digest.result.stdevPnl - local.stdevPnl) > 1e-9 * local.stdevPnl)
+        {
+            std::cerr << "Distributed risk differs from the local run" << std::endl;
+            return 10;
+        }
+
+        // A hung worker's partitions are re-run elsewhere, a dead one is retired,
+        // and the answer is still exactly the local one
+        int silentPort = 0;
+        const int silent = silentListener(silentPort);
+        RiskCoordinator::Config hurried = config;
+        hurried.minStragglerDelay = std::chrono::milliseconds(50);
+        RiskCoordinator flaky(hurried);
+        flaky.addWorker("127.0.0.1:" + std::to_string(silentPort));
+        flaky.addWorker("127.0.0.1:" + std::to_string(first.port()));
+        flaky.addWorker("unix:/nonexistent/option_pricer_worker.sock");
+        job.summarise = false;
+        const auto start = std::chrono::steady_clock::now();
+        const auto recovered = flaky.run(job);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // The caller's deadline abandons a job whose only worker never answers
+        RiskCoordinator hung(config);
+        hung.addWorker("127.0.0.1:" + std::to_string(silentPort));
+        OptionPricer::CancellationToken token;
+        token.limit(std::chrono::milliseconds(100));
+        bool cancelled = false;
+        const auto hungStart = std::chrono::steady_clock::now();
+        try
+        {
+            OptionPricer::CancellationToken::Scope scope(&token);
+            hung.run(job);
+        }
+        catch (const OptionPricer::OperationCancelled &e)
+        {
+            cancelled = e.reason() == OptionPricer::CancellationToken::Reason::Deadline;
+        }
+        const double hungSeconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - hungStart).count();
+        ::close(silent);
+        if (!cancelled || hungSeconds > 5.0)
+        {
+            std::cerr << "Distributed risk ignored its deadline (" << hungSeconds << " s)" << std::endl;
+            return 12;
+        }
+
+        bool noWorkers = false;
+        try
+        {
+            RiskCoordinator().run(job);
+        }
+        catch (const std::runtime_error &)
+        {
+            noWorkers = true;
+        }
+        first.stop();
+        second.stop();
+        if (!same(recovered.result, 0.0) || recovered.reissued < 1 || recovered.workers[0].partitions != 0 ||
+            recovered.workers[1].partitions != recovered.partitions || recovered.workers[2].error.empty() ||
+            seconds > 30.0 || !noWorkers)
+        {
+            std::cerr << "Straggler or failed worker handling is wrong" << std::endl;
+            return 11;
+        }
+    }
+
+    std::cout << "Binary protocol test passed" << std::endl;
+    return 0;
+}
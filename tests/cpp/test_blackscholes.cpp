@@ -1,12 +1,19 @@
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include "models/BlackScholes.h"
+#include "models/GreeksSurface.h"
+#include "models/NormalDistribution.h"
+#include "concurrency/Scheduler.h"
 
 int main()
 {
     double S = 100.0, K = 100.0, r = 0.05, sigma = 0.2, T = 1.0;
     double price = BlackScholes::callPrice(S, K, r, sigma, T);
-    double delta = BlackScholes::delta(S, K, r, sigma, T, "call");
+    double delta = BlackScholes::delta(S, K, r, sigma, T, OptionKind::Call);
 
     std::cout << "Call price: " << price << std::endl;
     std::cout << "Delta: " << delta << std::endl;
@@ -22,6 +29,336 @@ int main()
         return 3;
     }
 
+    // Fused kernel must match the individual closed-form functions
+    const double spots[] = {60.0, 100.0, 140.0};
+    for (double spot : spots)
+    {
+        for (OptionKind kind : {OptionKind::Call, OptionKind::Put})
+        {
+            const bool isCall = kind == OptionKind::Call;
+            OptionGreeks g = BlackScholes::priceAndGreeks(spot, K, r, sigma, T, kind);
+            double refPrice = isCall ? BlackScholes::callPrice(spot, K, r, sigma, T)
+                                     : BlackScholes::putPrice(spot, K, r, sigma, T);
+            double refs[] = {refPrice,
+                             BlackScholes::delta(spot, K, r, sigma, T, kind),
+                             BlackScholes::gamma(spot, K, r, sigma, T),
+                             BlackScholes::vega(spot, K, r, sigma, T),
+                             BlackScholes::theta(spot, K, r, sigma, T, kind),
+                             BlackScholes::rho(spot, K, r, sigma, T, kind)};
+            double fused[] = {g.price, g.delta, g.gamma, g.vega, g.theta, g.rho};
+            for (int i = 0; i < 6; ++i)
+            {
+                if (std::abs(fused[i] - refs[i]) > 1e-10 * (1.0 + std::abs(refs[i])))
+                {
+                    std::cerr << "priceAndGreeks field " << i << " mismatch at S=" << spot
+                              << " " << toString(kind) << ": " << fused[i] << " vs " << refs[i] << std::endl;
+                    return 4;
+                }
+            }
+        }
+    }
+
+    // Batch SIMD kernel vs the scalar closed form over a strike chain; an odd
+    // count exercises the vector body, the scalar tail and the T <= 0 fallback
+    const std::size_t n = 1001;
+    std::vector<double> bS(n, S), bK(n), bR(n, r), bSigma(n), bT(n);
+    std::vector<OptionKind> bKind(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        bK[i] = 40.0 + 0.12 * i;
+        bSigma[i] = 0.05 + 0.001 * (i % 300);
+        bT[i] = (i == 7) ? 0.0 : 0.02 + 0.003 * (i % 97);
+        bKind[i] = (i % 3) != 0 ? OptionKind::Call : OptionKind::Put;
+    }
+    std::vector<double> out[6];
+    for (auto &column : out)
+        column.assign(n, 0.0);
+    BlackScholes::priceAndGreeksBatch({bS.data(), bK.data(), bR.data(), bSigma.data(), bT.data(), bKind.data(), n},
+                                      {out[0].data(), out[1].data(), out[2].data(),
+                                       out[3].data(), out[4].data(), out[5].data()});
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        OptionGreeks g = BlackScholes::priceAndGreeks(bS[i], bK[i], bR[i], bSigma[i], bT[i], bKind[i]);
+        double refs[] = {g.price, g.delta, g.gamma, g.vega, g.theta, g.rho};
+        for (int c = 0; c < 6; ++c)
+        {
+            if (std::abs(out[c][i] - refs[c]) > 1e-11 * (1.0 + std::abs(refs[c])))
+            {
+                std::cerr << "Batch kernel (" << BlackScholes::batchInstructionSet() << ") column " << c
+                          << " mismatch at " << i << ": " << out[c][i] << " vs " << refs[c] << std::endl;
+                return 5;
+            }
+        }
+    }
+    std::cout << "Batch kernel: " << BlackScholes::batchInstructionSet() << std::endl;
+
+    // The uniform-kind and price-only specialisations must give the same
+    // prices as the mixed kernel above, and price<Kind> the same as callPrice
+    for (OptionKind kind : {OptionKind::Call, OptionKind::Put})
+    {
+        const bool isCall = kind == OptionKind::Call;
+        std::vector<OptionKind> uniform(n, kind);
+        std::vector<double> prices(n);
+        BlackScholes::priceAndGreeksBatch({bS.data(), bK.data(), bR.data(), bSigma.data(), bT.data(), uniform.data(), n},
+                                          {prices.data(), nullptr, nullptr, nullptr, nullptr, nullptr});
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const double ref = isCall ? BlackScholes::callPrice(bS[i], bK[i], bR[i], bSigma[i], bT[i])
+                                      : BlackScholes::putPrice(bS[i], bK[i], bR[i], bSigma[i], bT[i]);
+            const double templated = isCall ? BlackScholes::price<OptionKind::Call>(bS[i], bK[i], bR[i], bSigma[i], bT[i])
+                                            : BlackScholes::price<OptionKind::Put>(bS[i], bK[i], bR[i], bSigma[i], bT[i]);
+            if (templated != ref || (bKind[i] == kind && prices[i] != out[0][i]) ||
+                std::abs(prices[i] - ref) > 1e-11 * (1.0 + std::abs(ref)))
+            {
+                std::cerr << "Specialised " << toString(kind) << " price mismatch at " << i << ": "
+                          << prices[i] << " / " << templated << " vs " << ref << std::endl;
+                return 9;
+            }
+        }
+    }
+
+    // Surface engine: tiles of whole rows must land on the right (spot, time) cells
+    OptionPricer::Scheduler scheduler(3);
+    OptionPricer::GreeksSurface::Spec spec;
+    spec.strike = K;
+    spec.rate = r;
+    spec.sigma = sigma;
+    spec.kind = OptionKind::Put;
+    spec.spotMin = 60.0;
+    spec.spotMax = 140.0;
+    spec.timeMin = 0.0;
+    spec.timeMax = 2.0;
+    spec.spotSteps = 300;
+    spec.timeSteps = 40;
+    OptionPricer::GreeksSurface::Grid grid = OptionPricer::GreeksSurface::compute(spec, scheduler);
+    if (grid.spots.size() != 301 || grid.times.size() != 41 || grid.delta.size() != 301 * 41 ||
+        grid.spots.back() != 140.0 || grid.times.front() != 0.0)
+    {
+        std::cerr << "Surface grid has the wrong shape" << std::endl;
+        return 6;
+    }
+    for (std::size_t i = 0; i < grid.spots.size(); i += 7)
+    {
+        for (std::size_t j = 0; j < grid.times.size(); ++j)
+        {
+            OptionGreeks g = BlackScholes::priceAndGreeks(grid.spots[i], K, r, sigma, grid.times[j], OptionKind::Put);
+            const std::size_t k = i * grid.times.size() + j;
+            if (std::abs(grid.price[k] - g.price) > 1e-11 * (1.0 + std::abs(g.price)) ||
+                std::abs(grid.vega[k] - g.vega) > 1e-11 * (1.0 + std::abs(g.vega)))
+            {
+                std::cerr << "Surface mismatch at spot " << grid.spots[i] << " time " << grid.times[j] << std::endl;
+                return 6;
+            }
+        }
+    }
+
+    // Streaming reads arbitrary slices; they must match the full grid exactly, and
+    // reading every selected column prices each tile once
+    {
+        using OptionPricer::GreeksSurface::Field;
+        OptionPricer::GreeksSurface::Stream stream(spec, {Field::Rho, Field::Gamma}, scheduler);
+        const std::size_t begin = 1234, end = 5000; // two of the four tiles
+        std::vector<double> slice(end - begin);
+        stream.read(0, begin, end, slice.data());
+        const std::size_t slicedTiles = stream.pricedTiles();
+        std::vector<double> rho(grid.rho.size()), gamma(grid.gamma.size());
+        for (std::size_t b = 0; b < rho.size(); b += 5000)
+            stream.read(0, b, std::min(rho.size(), b + 5000), rho.data() + b);
+        const std::size_t tiles = stream.pricedTiles();
+        stream.read(1, 0, gamma.size(), gamma.data());
+        bool same = slice.size() == end - begin && rho == grid.rho && gamma == grid.gamma;
+        for (std::size_t k = begin; same && k < end; ++k)
+            same = slice[k - begin] == grid.rho[k];
+        if (!same || slicedTiles >= tiles || stream.pricedTiles() != tiles)
+        {
+            std::cerr << "Streamed surface differs from the full grid or repriced tiles" << std::endl;
+            return 7;
+        }
+    }
+
+    // Implied volatility round trip over moneyness, vol, expiry and type; an odd
+    // count exercises the scalar tail after the SIMD blocks
+    {
+        std::vector<double> quotes, spots, strikes, rates, times, vols;
+        std::vector<OptionKind> kinds;
+        for (double moneyness = 0.5; moneyness <= 2.0; moneyness *= 1.1)
+            for (double vol : {0.05, 0.2, 0.6, 1.5})
+                for (double T : {0.05, 1.0, 5.0})
+                    for (OptionKind kind : {OptionKind::Call, OptionKind::Put})
+                    {
+                        const double K = 100.0 * moneyness;
+                        const double price = kind == OptionKind::Call ? BlackScholes::callPrice(100.0, K, 0.03, vol, T)
+                                                                      : BlackScholes::putPrice(100.0, K, 0.03, vol, T);
+                        const double forward = 100.0 - K * std::exp(-0.03 * T);
+                        const double timeValue = price - std::max(kind == OptionKind::Call ? forward : -forward, 0.0);
+                        if (timeValue < 1e-4)
+                            continue; // vol not identifiable to 1e-9 from a double price
+                        quotes.push_back(price);
+                        spots.push_back(100.0);
+                        strikes.push_back(K);
+                        rates.push_back(0.03);
+                        times.push_back(T);
+                        vols.push_back(vol);
+                        kinds.push_back(kind);
+                    }
+        // Below the forward intrinsic value, above the spot, and an expired quote
+        const double invalid[][3] = {{0.5, 80.0, 1.0}, {120.0, 100.0, 1.0}, {5.0, 100.0, 0.0}};
+        for (const auto &q : invalid)
+        {
+            quotes.push_back(q[0]);
+            spots.push_back(100.0);
+            strikes.push_back(q[1]);
+            rates.push_back(0.03);
+            times.push_back(q[2]);
+            vols.push_back(std::nan(""));
+            kinds.push_back(OptionKind::Call);
+        }
+        if (quotes.size() % 2 == 0)
+        {
+            quotes.pop_back();
+            spots.pop_back();
+            strikes.pop_back();
+            rates.pop_back();
+            times.pop_back();
+            vols.pop_back();
+            kinds.pop_back();
+        }
+
+        std::vector<double> implied(quotes.size());
+        BlackScholes::impliedVolatilityBatch({quotes.data(), spots.data(), strikes.data(), rates.data(), times.data(),
+                                              kinds.data(), quotes.size()},
+                                             implied.data());
+        for (std::size_t i = 0; i < quotes.size(); ++i)
+        {
+            const bool expectNan = std::isnan(vols[i]);
+            if (expectNan != std::isnan(implied[i]) || (!expectNan && std::abs(implied[i] - vols[i]) > 1e-9 * vols[i]))
+            {
+                std::cerr << "Implied vol (" << BlackScholes::batchInstructionSet() << ") wrong at K=" << strikes[i]
+                          << " T=" << times[i] << ": " << implied[i] << " vs " << vols[i] << std::endl;
+                return 8;
+            }
+            if (!expectNan &&
+                std::abs(BlackScholes::impliedVolatility(quotes[i], spots[i], strikes[i], rates[i], times[i], kinds[i]) -
+                         implied[i]) > 1e-10 * vols[i])
+            {
+                std::cerr << "Scalar implied vol differs from the batch at K=" << strikes[i] << std::endl;
+                return 8;
+            }
+        }
+
+        bool threw = false;
+        try
+        {
+            BlackScholes::impliedVolatility(0.5, 100.0, 80.0, 0.03, 1.0, OptionKind::Call);
+        }
+        catch (const std::invalid_argument &)
+        {
+            threw = true;
+        }
+        if (!threw)
+        {
+            std::cerr << "Implied vol below intrinsic did not throw" << std::endl;
+            return 8;
+        }
+    }
+
+    // Normal accuracy modes: Fast to 1e-15 absolute (5e-11 relative in the
+    // lower tail), Table to 5e-10 absolute, both clamped far out; the closed
+    // form at each mode within its error of Exact, and price<Kind> at Exact
+    // equal to priceAndGreeks bit for bit
+    {
+        using OptionPricer::Normal::Accuracy;
+        namespace Normal = OptionPricer::Normal;
+        for (double x = -9.0; x <= 9.0; x += 0.00731)
+        {
+            const Normal::Value exact = Normal::evaluate<Accuracy::Exact>(x);
+            const Normal::Value fast = Normal::evaluate<Accuracy::Fast>(x);
+            const Normal::Value table = Normal::evaluate<Accuracy::Table>(x);
+            const bool fastOk = std::abs(fast.cdf - exact.cdf) <= 1e-15 && std::abs(fast.pdf - exact.pdf) <= 1e-15 &&
+                                (x < -5.0 || x > 0.0 || std::abs(fast.cdf / exact.cdf - 1.0) <= 5e-11);
+            const bool tableOk = std::abs(table.cdf - exact.cdf) <= 5e-10 && std::abs(table.pdf - exact.pdf) <= 5e-10;
+            if (!fastOk || !tableOk || Normal::cdf(x, Accuracy::Table) != table.cdf ||
+                Normal::pdf(x, Accuracy::Fast) != Normal::pdf<Accuracy::Fast>(x) ||
+                Normal::cdf(x) != exact.cdf || BlackScholes::cumulativeNormal(x) != exact.cdf)
+            {
+                std::cerr << "Normal accuracy modes disagree at x=" << x << ": fast " << fast.cdf << ", table "
+                          << table.cdf << " vs " << exact.cdf << std::endl;
+                return 10;
+            }
+        }
+        if (Normal::cdf(-40.0, Accuracy::Fast) != 0.0 || Normal::cdf(40.0, Accuracy::Fast) != 1.0 ||
+            Normal::cdf(8.0, Accuracy::Table) != 1.0 || Normal::pdf(-8.5, Accuracy::Table) != 0.0 ||
+            Normal::parseAccuracy("table") != Accuracy::Table || std::string(Normal::toString(Accuracy::Fast)) != "fast")
+        {
+            std::cerr << "Normal accuracy clamps or names are wrong" << std::endl;
+            return 10;
+        }
+        bool threw = false;
+        try
+        {
+            Normal::parseAccuracy("approximate");
+        }
+        catch (const std::invalid_argument &)
+        {
+            threw = true;
+        }
+        if (!threw)
+        {
+            std::cerr << "Unknown accuracy name did not throw" << std::endl;
+            return 10;
+        }
+
+        for (std::size_t i = 0; i < n; i += 3)
+        {
+            const OptionGreeks exact = BlackScholes::priceAndGreeks(bS[i], bK[i], bR[i], bSigma[i], bT[i], bKind[i]);
+            const double exactPrice = bKind[i] == OptionKind::Call
+                                          ? BlackScholes::price<OptionKind::Call>(bS[i], bK[i], bR[i], bSigma[i], bT[i])
+                                          : BlackScholes::price<OptionKind::Put>(bS[i], bK[i], bR[i], bSigma[i], bT[i]);
+            if (exactPrice != exact.price)
+            {
+                std::cerr << "price<Kind> differs from priceAndGreeks at " << i << std::endl;
+                return 10;
+            }
+            const double refs[] = {exact.price, exact.delta, exact.gamma, exact.vega, exact.theta, exact.rho};
+            for (Accuracy accuracy : {Accuracy::Fast, Accuracy::Table})
+            {
+                const OptionGreeks g =
+                    BlackScholes::priceAndGreeks(bS[i], bK[i], bR[i], bSigma[i], bT[i], bKind[i], accuracy);
+                const double fields[] = {g.price, g.delta, g.gamma, g.vega, g.theta, g.rho};
+                // Table errors scale with the spot and strike they multiply
+                const double tolerance = accuracy == Accuracy::Fast ? 1e-12 : 1e-7;
+                for (int c = 0; c < 6; ++c)
+                {
+                    if (std::abs(fields[c] - refs[c]) > tolerance * (1.0 + std::abs(refs[c])))
+                    {
+                        std::cerr << Normal::toString(accuracy) << " closed form field " << c << " off at " << i
+                                  << ": " << fields[c] << " vs " << refs[c] << std::endl;
+                        return 10;
+                    }
+                }
+            }
+        }
+
+        // The surface at Exact is the scalar closed form exactly
+        OptionPricer::GreeksSurface::Spec exactSpec = spec;
+        exactSpec.accuracy = Accuracy::Exact;
+        const OptionPricer::GreeksSurface::Grid exactGrid = OptionPricer::GreeksSurface::compute(exactSpec, scheduler);
+        for (std::size_t i = 0; i < exactGrid.spots.size(); i += 11)
+        {
+            for (std::size_t j = 0; j < exactGrid.times.size(); ++j)
+            {
+                const OptionGreeks g = BlackScholes::priceAndGreeks(exactGrid.spots[i], K, r, sigma, exactGrid.times[j],
+                                                                    OptionKind::Put);
+                const std::size_t k = i * exactGrid.times.size() + j;
+                if (exactGrid.price[k] != g.price || exactGrid.theta[k] != g.theta)
+                {
+                    std::cerr << "Exact surface differs from the closed form at " << k << std::endl;
+                    return 10;
+                }
+            }
+        }
+    }
+
     std::cout << "Black-Scholes smoke test passed" << std::endl;
     return 0;
 }
@@ -0,0 +1,209 @@
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "options/GreeksCache.h"
+#include "options/EuropeanOption.h"
+#include "options/AmericanOption.h"
+#include "options/OptionContract.h"
+#include "concurrency/Scheduler.h"
+
+using namespace OptionPricer;
+
+namespace
+{
+    bool sameGreeks(const OptionGreeks &a, const OptionGreeks &b)
+    {
+        return a.price == b.price && a.delta == b.delta && a.gamma == b.gamma &&
+               a.vega == b.vega && a.theta == b.theta && a.rho == b.rho;
+    }
+}
+
+int main()
+{
+    GreeksCache cache;
+    EuropeanOption call(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Call);
+    EuropeanOption put(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put);
+    AmericanOption americanPut(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 100);
+
+    // First sight misses, the repeat hits and returns the same numbers
+    const OptionGreeks first = cache.greeks(call);
+    const OptionGreeks second = cache.greeks(call);
+    if (!sameGreeks(first, call.greeks()) || !sameGreeks(first, second) ||
+        cache.stats().hits != 1 || cache.stats().misses != 1)
+    {
+        std::cerr << "Repeated lookup did not hit the cache" << std::endl;
+        return 2;
+    }
+
+    // Kind, model and lattice steps are part of the key
+    AmericanOption finerPut(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 200);
+    if (sameGreeks(cache.greeks(put), first) || !sameGreeks(cache.greeks(americanPut), americanPut.greeks()) ||
+        !sameGreeks(cache.greeks(finerPut), finerPut.greeks()) || cache.stats().misses != 4)
+    {
+        std::cerr << "Distinct legs shared a cache entry" << std::endl;
+        return 3;
+    }
+
+    // Re-posting a book with one edited leg reprices only that leg
+    {
+        const auto before = cache.stats();
+        EuropeanOption editedCall(100.0, 105.0, 0.05, 0.2, 1.0, OptionKind::Call);
+        cache.greeks(editedCall);
+        cache.greeks(put);
+        cache.greeks(americanPut);
+        const auto after = cache.stats();
+        if (after.misses - before.misses != 1 || after.hits - before.hits != 2)
+        {
+            std::cerr << "Edited leg was not the only miss" << std::endl;
+            return 4;
+        }
+    }
+
+    // Inputs inside one quantum share an entry, inputs beyond it do not
+    {
+        GreeksCache::Config config;
+        config.quantization.price = 0.01;
+        GreeksCache coarse(config);
+        coarse.greeks(EuropeanOption(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Call));
+        coarse.greeks(EuropeanOption(100.004, 100.0, 0.05, 0.2, 1.0, OptionKind::Call));
+        coarse.greeks(EuropeanOption(100.02, 100.0, 0.05, 0.2, 1.0, OptionKind::Call));
+        if (coarse.stats().hits != 1 || coarse.stats().misses != 2)
+        {
+            std::cerr << "Quantization buckets are wrong" << std::endl;
+            return 5;
+        }
+    }
+
+    // A small budget evicts least recently used entries and stays bounded
+    {
+        GreeksCache::Config config;
+        config.capacityBytes = 64 * GreeksCache::EntryBytes; // 4 entries per shard
+        GreeksCache small(config);
+        for (int i = 0; i < 1000; ++i)
+            small.greeks(EuropeanOption(100.0, 50.0 + 0.1 * i, 0.05, 0.2, 1.0, OptionKind::Call));
+        const auto stats = small.stats();
+        if (stats.entries > 64 || stats.bytes > config.capacityBytes || stats.evictions != 1000 - stats.entries)
+        {
+            std::cerr << "Capacity is not enforced" << std::endl;
+            return 6;
+        }
+        // The most recent strike survives
+        const auto hits = stats.hits;
+        small.greeks(EuropeanOption(100.0, 50.0 + 0.1 * 999, 0.05, 0.2, 1.0, OptionKind::Call));
+        if (small.stats().hits != hits + 1)
+        {
+            std::cerr << "Most recent entry was evicted" << std::endl;
+            return 6;
+        }
+    }
+
+    // Zero capacity disables caching
+    {
+        GreeksCache::Config config;
+        config.capacityBytes = 0;
+        GreeksCache disabled(config);
+        disabled.greeks(call);
+        disabled.greeks(call);
+        if (disabled.stats().hits != 0 || disabled.stats().misses != 2 || disabled.stats().entries != 0)
+        {
+            std::cerr << "Zero capacity still caches" << std::endl;
+            return 7;
+        }
+    }
+
+    // Concurrent lookups over a shared key set agree with direct pricing
+    {
+        GreeksCache shared;
+        std::vector<EuropeanOption> chain;
+        for (int i = 0; i < 64; ++i)
+            chain.emplace_back(100.0, 80.0 + i, 0.05, 0.2, 1.0, i % 2 ? OptionKind::Put : OptionKind::Call);
+
+        std::vector<int> mismatches(4, 0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&, t]
+                                 {
+                for (int round = 0; round < 50; ++round)
+                    for (const auto &option : chain)
+                        mismatches[t] += !sameGreeks(shared.greeks(option), option.greeks()); });
+        for (auto &thread : threads)
+            thread.join();
+
+        const auto stats = shared.stats();
+        if (mismatches != std::vector<int>(4, 0) || stats.entries != chain.size() ||
+            stats.hits + stats.misses != 4 * 50 * chain.size())
+        {
+            std::cerr << "Concurrent lookups are inconsistent" << std::endl;
+            return 8;
+        }
+    }
+
+    // Batch lookups: lattice misses grouped by scheme and steps, the rest one by one, hits from the cache
+    {
+        GreeksCache batchCache;
+        std::vector<OptionContract> contracts;
+        for (int i = 0; i < 11; ++i)
+        {
+            const OptionKind kind = i % 2 ? OptionKind::Put : OptionKind::Call;
+            contracts.push_back(OptionContract::american(100.0, 90.0 + 2.0 * i, 0.03, 0.25, 0.5, kind, 60));
+            contracts.push_back(OptionContract::american(100.0, 90.0 + 2.0 * i, 0.03, 0.25, 0.5, kind, 60,
+                                                         AmericanModel::BBSR));
+            contracts.push_back(OptionContract::european(100.0, 90.0 + 2.0 * i, 0.03, 0.25, 0.5, kind));
+        }
+        contracts.push_back(OptionContract::american(100.0, 95.0, 0.03, 0.25, 0.5, OptionKind::Put, 75,
+                                                     AmericanModel::LeisenReimer));
+        contracts.push_back(contracts.front()); // a repeat inside one batch is priced twice, cached once
+
+        Scheduler scheduler(3);
+        std::vector<OptionGreeks> out(contracts.size());
+        batchCache.greeks(contracts.data(), contracts.size(), out.data(), scheduler);
+        for (std::size_t i = 0; i < contracts.size(); ++i)
+        {
+            if (!sameGreeks(out[i], contracts[i].greeks()))
+            {
+                std::cerr << "Batch lookup differs from direct pricing at contract " << i << std::endl;
+                return 10;
+            }
+        }
+        auto stats = batchCache.stats();
+        if (stats.misses != contracts.size() || stats.hits != 0 || stats.entries != contracts.size() - 1)
+        {
+            std::cerr << "First batch should miss every contract" << std::endl;
+            return 10;
+        }
+
+        std::vector<OptionGreeks> again(contracts.size());
+        batchCache.greeks(contracts.data(), contracts.size(), again.data(), scheduler);
+        stats = batchCache.stats();
+        for (std::size_t i = 0; i < contracts.size(); ++i)
+        {
+            if (!sameGreeks(again[i], out[i]) || stats.hits != contracts.size())
+            {
+                std::cerr << "Second batch should hit every contract" << std::endl;
+                return 10;
+            }
+        }
+    }
+
+    cache.clear();
+    if (cache.stats().entries != 0 || cache.stats().hits != 0 || cache.stats().misses != 0)
+    {
+        std::cerr << "clear() left entries or counts behind" << std::endl;
+        return 9;
+    }
+
+    // Bypassed, repeats are priced again and neither counted nor stored
+    cache.setBypass(true);
+    const bool bypassedSame = sameGreeks(cache.greeks(call), first) && sameGreeks(cache.greeks(call), first);
+    const auto bypassed = cache.stats();
+    cache.setBypass(false);
+    if (!bypassedSame || bypassed.hits != 0 || bypassed.misses != 0 || bypassed.entries != 0)
+    {
+        std::cerr << "Bypassed cache counted or stored lookups" << std::endl;
+        return 11;
+    }
+
+    std::cout << "Greeks cache test passed" << std::endl;
+    return 0;
+}
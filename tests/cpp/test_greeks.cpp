@@ -18,8 +18,8 @@ protected:
 // Test delta is between -1 and 1
 TEST_F(GreeksTest, DeltaBounds)
 {
-    EuropeanOption callOption(spot, strike, rate, sigma, time, "call");
-    EuropeanOption putOption(spot, strike, rate, sigma, time, "put");
+    EuropeanOption callOption(spot, strike, rate, sigma, time, OptionKind::Call);
+    EuropeanOption putOption(spot, strike, rate, sigma, time, OptionKind::Put);
 
     double callDelta = callOption.delta();
     double putDelta = putOption.delta();
@@ -33,8 +33,8 @@ TEST_F(GreeksTest, DeltaBounds)
 // Test gamma is always positive
 TEST_F(GreeksTest, GammaPositive)
 {
-    EuropeanOption callOption(spot, strike, rate, sigma, time, "call");
-    EuropeanOption putOption(spot, strike, rate, sigma, time, "put");
+    EuropeanOption callOption(spot, strike, rate, sigma, time, OptionKind::Call);
+    EuropeanOption putOption(spot, strike, rate, sigma, time, OptionKind::Put);
 
     EXPECT_GT(callOption.gamma(), 0.0);
     EXPECT_GT(putOption.gamma(), 0.0);
@@ -43,43 +43,43 @@ TEST_F(GreeksTest, GammaPositive)
 // Test vega is always positive (per 1% change in volatility)
 TEST_F(GreeksTest, VegaPositive)
 {
-    EuropeanOption callOption(spot, strike, rate, sigma, time, "call");
-    EuropeanOption putOption(spot, strike, rate, sigma, time, "put");
+    EuropeanOption callOption(spot, strike, rate, sigma, time, OptionKind::Call);
+    EuropeanOption putOption(spot, strike, rate, sigma, time, OptionKind::Put);
 
     EXPECT_GT(callOption.vega(), 0.0);
     EXPECT_GT(putOption.vega(), 0.0);
 }
 
-// Test put-call parity: C - P = S * exp(-r*T) - K * exp(-r*T) (no dividend)
+// Test put-call parity: C - P = S - K * exp(-r*T) (no dividend)
 TEST_F(GreeksTest, PutCallParity)
 {
-    EuropeanOption callOption(spot, strike, rate, sigma, time, "call");
-    EuropeanOption putOption(spot, strike, rate, sigma, time, "put");
+    EuropeanOption callOption(spot, strike, rate, sigma, time, OptionKind::Call);
+    EuropeanOption putOption(spot, strike, rate, sigma, time, OptionKind::Put);
 
     double callPrice = callOption.price();
     double putPrice = putOption.price();
 
     double parity = callPrice - putPrice;
-    double expected = spot * std::exp(-rate * time) - strike * std::exp(-rate * time);
+    double expected = spot - strike * std::exp(-rate * time);
 
     EXPECT_NEAR(parity, expected, 0.01);
 }
 
-// Test delta symmetry: Delta(call) + Delta(put) ≈ 1
+// Test delta symmetry: Delta(call) - Delta(put) ≈ 1
 TEST_F(GreeksTest, DeltaSymmetry)
 {
-    EuropeanOption callOption(spot, strike, rate, sigma, time, "call");
-    EuropeanOption putOption(spot, strike, rate, sigma, time, "put");
+    EuropeanOption callOption(spot, strike, rate, sigma, time, OptionKind::Call);
+    EuropeanOption putOption(spot, strike, rate, sigma, time, OptionKind::Put);
 
-    double deltaSum = callOption.delta() + putOption.delta();
+    double deltaSpread = callOption.delta() - putOption.delta();
 
-    EXPECT_NEAR(deltaSum, 1.0, 0.01);
+    EXPECT_NEAR(deltaSpread, 1.0, 0.01);
 }
 
-// Test that ATM options have delta around 0.5 for calls
+// Test that at-the-money-forward calls have delta around 0.5
 TEST_F(GreeksTest, ATMCallDelta)
 {
-    EuropeanOption atmCall(spot, spot, rate, sigma, time, "call");
+    EuropeanOption atmCall(spot, spot * std::exp(rate * time), rate, sigma, time, OptionKind::Call);
 
     double delta = atmCall.delta();
     EXPECT_GT(delta, 0.4);
@@ -89,8 +89,8 @@ TEST_F(GreeksTest, ATMCallDelta)
 // Test volatility impact on vega
 TEST_F(GreeksTest, VegaVsVolatility)
 {
-    EuropeanOption opt1(spot, strike, rate, 0.1, time, "call");
-    EuropeanOption opt2(spot, strike, rate, 0.3, time, "call");
+    EuropeanOption opt1(spot, strike, rate, 0.1, time, OptionKind::Call);
+    EuropeanOption opt2(spot, strike, rate, 0.3, time, OptionKind::Call);
 
     // Both should have positive vega
     EXPECT_GT(opt1.vega(), 0.0);
@@ -100,7 +100,7 @@ TEST_F(GreeksTest, VegaVsVolatility)
 // Test time decay (theta) for ATM call
 TEST_F(GreeksTest, ThetaATMCall)
 {
-    EuropeanOption atmCall(spot, strike, rate, sigma, time, "call");
+    EuropeanOption atmCall(spot, strike, rate, sigma, time, OptionKind::Call);
 
     double theta = atmCall.theta();
     // ATM call theta is typically negative (time decay)
@@ -110,8 +110,8 @@ TEST_F(GreeksTest, ThetaATMCall)
 // Test in-the-money call has higher delta
 TEST_F(GreeksTest, DeltaMoneyness)
 {
-    EuropeanOption itmCall(110.0, strike, rate, sigma, time, "call");
-    EuropeanOption otmCall(90.0, strike, rate, sigma, time, "call");
+    EuropeanOption itmCall(110.0, strike, rate, sigma, time, OptionKind::Call);
+    EuropeanOption otmCall(90.0, strike, rate, sigma, time, OptionKind::Call);
 
     EXPECT_GT(itmCall.delta(), otmCall.delta());
 }
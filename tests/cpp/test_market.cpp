@@ -0,0 +1,249 @@
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "api/MarketDataEndpoint.h"
+#include "api/PricingEndpoint.h"
+#include "market/MarketData.h"
+
+using namespace OptionPricer;
+using namespace OptionPricer::API;
+
+namespace
+{
+    bool near(double a, double b, double tolerance = 1e-12)
+    {
+        return std::abs(a - b) <= tolerance;
+    }
+
+    template <class F>
+    bool rejects(F &&f)
+    {
+        try
+        {
+            f();
+        }
+        catch (const std::invalid_argument &)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    Underlying gridUnderlying(const std::string &name, double spot)
+    {
+        return Underlying::make(name, spot, {0.5, 2.0}, {0.02, 0.04}, VolSurface::Kind::Grid, {0.5, 1.0},
+                                {0.9, 1.1}, {0.3, 0.2, 0.25, 0.15});
+    }
+}
+
+int main()
+{
+    // Zero rates interpolate linearly in r * T, flat outside the pillars
+    const Underlying grid = gridUnderlying("GRID", 100.0);
+    if (!near(grid.rate(0.1), 0.02) || !near(grid.rate(0.5), 0.02) || !near(grid.rate(2.0), 0.04) ||
+        !near(grid.rate(5.0), 0.04) || !near(grid.rate(1.25), (0.01 + 0.5 * (0.08 - 0.01)) / 1.25))
+    {
+        std::cerr << "Rate curve interpolation is wrong: " << grid.rate(1.25) << std::endl;
+        return 2;
+    }
+
+    // Grid: linear in moneyness at an expiry, linear in total variance between expiries
+    const VolSurface &surface = grid.surface;
+    const double between = std::sqrt((0.25 * 0.25 * 0.5 + 0.25 * (0.2 * 0.2 * 1.0 - 0.25 * 0.25 * 0.5)) / 0.625);
+    if (!near(surface.volatility(1.0, 0.5), 0.25) || !near(surface.volatility(0.5, 1.0), 0.25) ||
+        !near(surface.volatility(2.0, 1.0), 0.15) || !near(surface.volatility(1.0, 0.1), 0.25) ||
+        !near(surface.volatility(1.0, 3.0), 0.2) || !near(surface.volatility(1.0, 0.625), between))
+    {
+        std::cerr << "Grid surface interpolation is wrong: " << surface.volatility(1.0, 0.625) << std::endl;
+        return 3;
+    }
+    const double forward = 100.0 * std::exp(grid.rate(1.0) * 1.0);
+    if (!near(grid.volatility(forward, 1.0), 0.2))
+    {
+        std::cerr << "Underlying volatility is not read against the forward" << std::endl;
+        return 3;
+    }
+
+    // SVI slices evaluate w(k) = a + b (rho (k - m) + sqrt((k - m)^2 + s^2))
+    const Underlying svi = Underlying::make("SVI", 50.0, {1.0}, {0.03}, VolSurface::Kind::Svi, {0.25, 1.0}, {},
+                                            {0.01, 0.1, -0.5, 0.0, 0.1, 0.03, 0.12, -0.4, 0.05, 0.2});
+    const double k = std::log(0.8);
+    const double w = 0.03 + 0.12 * (-0.4 * (k - 0.05) + std::sqrt((k - 0.05) * (k - 0.05) + 0.04));
+    if (!near(svi.surface.volatility(0.8, 1.0), std::sqrt(w)))
+    {
+        std::cerr << "SVI slice is wrong" << std::endl;
+        return 4;
+    }
+
+    // Malformed data is rejected before it can be published
+    if (!rejects([]
+                 { Underlying::make("BAD", 100.0, {1.0, 0.5}, {0.01, 0.02}, VolSurface::Kind::Grid, {1.0}, {1.0}, {0.2}); }) ||
+        !rejects([]
+                 { Underlying::make("BAD", 100.0, {1.0}, {0.01}, VolSurface::Kind::Grid, {1.0}, {1.0}, {-0.2}); }) ||
+        !rejects([]
+                 { Underlying::make("BAD", 100.0, {1.0}, {0.01}, VolSurface::Kind::Grid, {1.0}, {0.9, 1.1}, {0.2}); }) ||
+        !rejects([]
+                 { Underlying::make("BAD", 100.0, {1.0}, {0.01}, VolSurface::Kind::Svi, {1.0}, {}, {0.01, 0.1, 1.0, 0.0, 0.1}); }) ||
+        !rejects([]
+                 { Underlying::make("", 100.0, {1.0}, {0.01}, VolSurface::Kind::Grid, {1.0}, {1.0}, {0.2}); }))
+    {
+        std::cerr << "Malformed market data was accepted" << std::endl;
+        return 5;
+    }
+
+    // A snapshot never changes once taken
+    MarketDataStore store;
+    store.update(grid);
+    const auto before = store.snapshot();
+    store.update(gridUnderlying("GRID", 105.0));
+    store.update(svi);
+    const auto after = store.snapshot();
+    if (before->version() != 1 || after->version() != 3 || before->find("GRID")->spot != 100.0 ||
+        after->find("GRID")->spot != 105.0 || before->find("SVI") || !after->find("SVI"))
+    {
+        std::cerr << "Snapshots are not isolated from later updates" << std::endl;
+        return 6;
+    }
+    if (!store.erase("SVI") || store.erase("SVI") || store.snapshot()->find("SVI"))
+    {
+        std::cerr << "Erase did not publish a snapshot without the underlying" << std::endl;
+        return 6;
+    }
+
+    // File round trip: the loaded arrays read back bit-identical
+    store.update(svi);
+    const std::string path = "test_market.opmd";
+    MarketDataStore::writeFile(path, *store.snapshot());
+    MarketDataStore loaded;
+    if (loaded.loadFile(path) != 2 || loaded.snapshot()->version() != 1)
+    {
+        std::cerr << "Market file did not load" << std::endl;
+        return 7;
+    }
+    for (const auto &entry : store.snapshot()->underlyings())
+    {
+        const Underlying *copy = loaded.snapshot()->find(entry.first);
+        if (!copy || MarketDataEndpoint::toJson(*copy) != MarketDataEndpoint::toJson(entry.second) ||
+            copy->volatility(47.0, 0.7) != entry.second.volatility(47.0, 0.7))
+        {
+            std::cerr << "Market file round trip changed " << entry.first << std::endl;
+            return 7;
+        }
+    }
+
+    // A truncated or foreign file leaves the store untouched
+    {
+        std::ifstream in(path, std::ios::binary);
+        const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size() - 8);
+    }
+    const bool truncatedRejected = rejects([&]
+                                           { loaded.loadFile(path); });
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a market file";
+    const bool foreignRejected = rejects([&]
+                                         { loaded.loadFile(path); });
+    std::remove(path.c_str());
+    if (!truncatedRejected || !foreignRejected || loaded.snapshot()->version() != 1)
+    {
+        std::cerr << "Malformed market files were not rejected cleanly" << std::endl;
+        return 8;
+    }
+
+    // Readers racing a writer only ever see whole, increasing snapshots
+    {
+        MarketDataStore live;
+        live.update(gridUnderlying("LIVE", 1.0));
+        std::atomic<bool> done{false};
+        std::atomic<int> violations{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t)
+        {
+            readers.emplace_back([&]
+                                 {
+                std::uint64_t lastVersion = 0;
+                while (!done.load())
+                {
+                    const auto snapshot = live.snapshot();
+                    const Underlying *u = snapshot->find("LIVE");
+                    // Spot i is published as version i
+                    if (!u || snapshot->version() < lastVersion || u->spot != static_cast<double>(snapshot->version()) ||
+                        !near(u->volatility(u->spot * std::exp(u->rate(0.5) * 0.5), 0.5), 0.25))
+                        ++violations;
+                    lastVersion = snapshot->version();
+                } });
+        }
+        for (int i = 2; i <= 2000; ++i)
+            live.update(gridUnderlying("LIVE", i));
+        done = true;
+        for (auto &reader : readers)
+            reader.join();
+        if (violations.load() != 0)
+        {
+            std::cerr << violations.load() << " torn or stale snapshots under concurrent updates" << std::endl;
+            return 9;
+        }
+    }
+
+    // Pricing by name fills spot, the curve rate at the expiry and the surface volatility at the strike
+    MarketDataEndpoint::handleUpdate("TEST", {{"spot", 100.0},
+                                              {"rates", {{"times", {0.5, 2.0}}, {"rates", {0.02, 0.04}}}},
+                                              {"surface", {{"type", "grid"}, {"expiries", {0.5, 1.0}}, {"moneyness", {0.9, 1.1}}, {"vols", {{0.3, 0.2}, {0.25, 0.15}}}}}});
+    const Underlying &test = *MarketDataStore::shared().snapshot()->find("TEST");
+    const double rate = test.rate(0.75);
+    const double vol = test.volatility(95.0, 0.75);
+    const json byName = PricingEndpoint::handlePriceRequest(
+        {{"type", "put"}, {"strike", 95.0}, {"time", 0.75}, {"underlying", "TEST"}});
+    const json explicitInputs = PricingEndpoint::handlePriceRequest(
+        {{"type", "put"}, {"spot", 100.0}, {"strike", 95.0}, {"rate", rate}, {"volatility", vol}, {"time", 0.75}});
+    if (byName.contains("error") || byName["price"] != explicitInputs["price"] || byName["volatility"] != vol ||
+        byName["rate"] != rate || byName["underlying"] != "TEST")
+    {
+        std::cerr << "Pricing by underlying does not match explicit inputs: " << byName.dump() << std::endl;
+        return 10;
+    }
+    const json overridden = PricingEndpoint::handlePriceRequest(
+        {{"type", "put"}, {"strike", 95.0}, {"time", 0.75}, {"volatility", 0.3}, {"underlying", "TEST"}});
+    if (overridden["volatility"] != 0.3 ||
+        !PricingEndpoint::handlePriceRequest({{"type", "put"}, {"strike", 95.0}, {"time", 0.75}, {"underlying", "NOPE"}})
+             .contains("error"))
+    {
+        std::cerr << "Explicit fields must win and unknown underlyings must fail" << std::endl;
+        return 10;
+    }
+
+    // Portfolios take spot and per-leg rates and volatilities from the snapshot
+    const json portfolio = PricingEndpoint::handlePortfolioRequest(
+        {{"underlying", "TEST"},
+         {"legs", {{{"optionType", "call"}, {"strike", 105.0}, {"time", 0.25}, {"quantity", 1}},
+                   {{"optionType", "put"}, {"strike", 95.0}, {"time", 1.5}, {"quantity", -1}, {"volatility", 0.3}}}}});
+    const json first = PricingEndpoint::handlePriceRequest(
+        {{"type", "call"}, {"strike", 105.0}, {"time", 0.25}, {"underlying", "TEST"}});
+    const json second = PricingEndpoint::handlePriceRequest(
+        {{"type", "put"}, {"spot", 100.0}, {"strike", 95.0}, {"rate", test.rate(1.5)}, {"volatility", 0.3}, {"time", 1.5}});
+    if (portfolio.contains("error") ||
+        !near(portfolio["portfolio"]["totalPrice"].get<double>(), first["price"].get<double>() - second["price"].get<double>()))
+    {
+        std::cerr << "Portfolio by underlying does not match its legs: " << portfolio.dump() << std::endl;
+        return 11;
+    }
+
+    // Chains read a volatility per strike off the surface
+    const json chain = PricingEndpoint::handleChainRequest(
+        {{"underlying", "TEST"}, {"type", "put"}, {"time", 0.75}, {"strikes", {95.0, 105.0}}});
+    if (chain.contains("error") || chain["market_version"] != MarketDataStore::shared().snapshot()->version() ||
+        !near(chain["price"][0].get<double>(), byName["price"].get<double>(), 1e-9))
+    {
+        std::cerr << "Chain by underlying does not match single pricing: " << chain.dump() << std::endl;
+        return 12;
+    }
+
+    std::cout << "Market data test passed" << std::endl;
+    return 0;
+}
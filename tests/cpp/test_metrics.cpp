@@ -0,0 +1,170 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "metrics/Metrics.h"
+#include "models/BlackScholes.h"
+#include "options/AmericanOption.h"
+#include "options/EuropeanOption.h"
+
+using namespace OptionPricer;
+
+namespace
+{
+    bool contains(const std::string &text, const std::string &line)
+    {
+        return text.find(line) != std::string::npos;
+    }
+}
+
+int main()
+{
+    // Quantiles come back within one sub-bucket (12.5%) of the recorded values
+    {
+        const std::size_t id = Metrics::endpoint("GET", "/quantiles");
+        for (std::uint64_t i = 1; i <= 1000; ++i)
+            Metrics::recordLatency(id, Metrics::Phase::Price, i * 1000); // 1 us .. 1 ms
+        const Metrics::LatencySummary s = Metrics::latency(id, Metrics::Phase::Price);
+        const auto within = [](double value, double expected)
+        { return value >= expected && value <= expected * 1.125; };
+        if (s.count != 1000 || s.sumNanos != 500500000 || !within(s.p50, 500e-6) || !within(s.p99, 990e-6) ||
+            !within(s.p999, 999e-6))
+        {
+            std::cerr << "Latency histogram is off: p50 " << s.p50 << " p99 " << s.p99 << std::endl;
+            return 2;
+        }
+        if (Metrics::endpoint("GET", "/quantiles") != id || Metrics::endpoint("POST", "/quantiles") == id)
+        {
+            std::cerr << "Endpoint ids are not stable" << std::endl;
+            return 2;
+        }
+    }
+
+    // A timer records each phase it entered once, plus the total
+    {
+        const std::size_t id = Metrics::endpoint("POST", "/phases");
+        for (int i = 0; i < 3; ++i)
+        {
+            Metrics::RequestTimer timer(id);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            Metrics::RequestTimer::enter(Metrics::Phase::Price);
+            Metrics::RequestTimer::enter(Metrics::Phase::Price);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            if (i == 2)
+                timer.fail();
+        }
+        // Without a timer running, enter() does nothing
+        Metrics::RequestTimer::enter(Metrics::Phase::Serialize);
+
+        const auto parse = Metrics::latency(id, Metrics::Phase::Parse);
+        const auto price = Metrics::latency(id, Metrics::Phase::Price);
+        const auto serialize = Metrics::latency(id, Metrics::Phase::Serialize);
+        const auto total = Metrics::latency(id, Metrics::Phase::Total);
+        if (parse.count != 3 || price.count != 3 || serialize.count != 0 || total.count != 3 ||
+            parse.sumNanos < 6000000 || price.sumNanos < 6000000 ||
+            total.sumNanos < parse.sumNanos + price.sumNanos || Metrics::errors(id) != 1)
+        {
+            std::cerr << "Request phases were not timed" << std::endl;
+            return 3;
+        }
+    }
+
+    // Threads record into their own slots; counts survive the threads exiting
+    {
+        const std::size_t id = Metrics::endpoint("POST", "/threads");
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t)
+            threads.emplace_back([id]
+                                 {
+                for (int i = 0; i < 10000; ++i)
+                {
+                    Metrics::RequestTimer timer(id);
+                    Metrics::RequestTimer::enter(Metrics::Phase::Serialize);
+                } });
+        for (auto &thread : threads)
+            thread.join();
+        if (Metrics::latency(id, Metrics::Phase::Total).count != 80000 ||
+            Metrics::latency(id, Metrics::Phase::Serialize).count != 80000)
+        {
+            std::cerr << "Per-thread counts were lost" << std::endl;
+            return 4;
+        }
+    }
+
+    // Engines count their own valuations; every lattice counts with its steps
+    {
+        const Metrics::ModelCounts before = Metrics::models();
+        EuropeanOption(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Call).price();
+        OptionPricer::AmericanOption(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 150).price();
+
+        const std::size_t n = 10;
+        std::vector<double> spot(n, 100.0), strike(n, 100.0), rate(n, 0.05), vol(n, 0.2), time(n, 1.0), price(n);
+        std::vector<OptionKind> kind(n, OptionKind::Call);
+        BlackScholes::priceAndGreeksBatch({spot.data(), strike.data(), rate.data(), vol.data(), time.data(), kind.data(), n},
+                                          {price.data(), nullptr, nullptr, nullptr, nullptr, nullptr});
+
+        const Metrics::ModelCounts after = Metrics::models();
+        if (after.european - before.european != 1 + n || after.lattices - before.lattices != 1 ||
+            after.binomialSteps - before.binomialSteps != 150)
+        {
+            std::cerr << "Model counters are wrong" << std::endl;
+            return 5;
+        }
+    }
+
+    // Prometheus text: histograms only for series with samples, counters and gauges always
+    {
+        const std::string text = Metrics::prometheus();
+        const char *expected[] = {
+            "# TYPE option_pricer_request_duration_seconds histogram\n",
+            "option_pricer_request_duration_seconds_count{method=\"POST\",path=\"/phases\",phase=\"price\"} 3\n",
+            "option_pricer_request_duration_seconds_bucket{method=\"GET\",path=\"/quantiles\",phase=\"price\",le=\"+Inf\"} 1000\n",
+            "option_pricer_request_duration_seconds_bucket{method=\"GET\",path=\"/quantiles\",phase=\"price\",le=\"1.024e-06\"} 1\n",
+            "option_pricer_request_errors_total{method=\"POST\",path=\"/phases\"} 1\n",
+            "option_pricer_request_duration_quantile_seconds{method=\"POST\",path=\"/threads\",phase=\"total\",quantile=\"0.99\"}",
+            "option_pricer_requests_in_flight 0\n",
+            "option_pricer_valuations_total{model=\"american\"}",
+            "option_pricer_binomial_lattice_steps_bucket{le=\"200\"}",
+            "option_pricer_greeks_cache_hit_ratio",
+            "option_pricer_scheduler_queue_depth 0\n",
+        };
+        for (const char *line : expected)
+        {
+            if (!contains(text, line))
+            {
+                std::cerr << "Missing from /metrics: " << line << std::endl;
+                return 6;
+            }
+        }
+        if (contains(text, "path=\"/phases\",phase=\"serialize\""))
+        {
+            std::cerr << "Empty series was exported" << std::endl;
+            return 6;
+        }
+    }
+
+    // The endpoint table is bounded
+    {
+        bool rejected = false;
+        try
+        {
+            for (std::size_t i = 0; i <= Metrics::MaxEndpoints; ++i)
+                Metrics::endpoint("GET", "/filler/" + std::to_string(i));
+        }
+        catch (const std::length_error &)
+        {
+            rejected = true;
+        }
+        if (!rejected)
+        {
+            std::cerr << "Endpoint table grew past its bound" << std::endl;
+            return 7;
+        }
+    }
+
+    std::cout << "Metrics test passed" << std::endl;
+    return 0;
+}
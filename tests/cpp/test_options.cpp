@@ -18,7 +18,7 @@ protected:
 // Test European call pricing bounds
 TEST_F(OptionPricingTest, CallPriceBounds)
 {
-    EuropeanOption call(spot, strike, rate, sigma, time, "call");
+    EuropeanOption call(spot, strike, rate, sigma, time, OptionKind::Call);
     double price = call.price();
 
     // Price should be between intrinsic value and spot price
@@ -30,7 +30,7 @@ TEST_F(OptionPricingTest, CallPriceBounds)
 // Test European put pricing bounds
 TEST_F(OptionPricingTest, PutPriceBounds)
 {
-    EuropeanOption put(spot, strike, rate, sigma, time, "put");
+    EuropeanOption put(spot, strike, rate, sigma, time, OptionKind::Put);
     double price = put.price();
 
     // Price should be between intrinsic value and strike * exp(-r*T)
@@ -42,7 +42,7 @@ TEST_F(OptionPricingTest, PutPriceBounds)
 // Test ITM call has intrinsic value
 TEST_F(OptionPricingTest, ITMCallPrice)
 {
-    EuropeanOption itmCall(110.0, 100.0, rate, sigma, time, "call");
+    EuropeanOption itmCall(110.0, 100.0, rate, sigma, time, OptionKind::Call);
     double price = itmCall.price();
     double intrinsic = 10.0;
 
@@ -52,7 +52,7 @@ TEST_F(OptionPricingTest, ITMCallPrice)
 // Test OTM option has non-zero price (time value)
 TEST_F(OptionPricingTest, OTMOptionPrice)
 {
-    EuropeanOption otmCall(90.0, 100.0, rate, sigma, time, "call");
+    EuropeanOption otmCall(90.0, 100.0, rate, sigma, time, OptionKind::Call);
     double price = otmCall.price();
 
     // Should have time value, not zero
@@ -62,7 +62,7 @@ TEST_F(OptionPricingTest, OTMOptionPrice)
 // Test zero time to expiration gives intrinsic value
 TEST_F(OptionPricingTest, ExpiredCallPrice)
 {
-    EuropeanOption expiredCall(110.0, 100.0, rate, sigma, 0.001, "call");
+    EuropeanOption expiredCall(110.0, 100.0, rate, sigma, 0.001, OptionKind::Call);
     double price = expiredCall.price();
     double intrinsic = 10.0;
 
@@ -72,8 +72,8 @@ TEST_F(OptionPricingTest, ExpiredCallPrice)
 // Test that call price increases with spot
 TEST_F(OptionPricingTest, CallMoneyness)
 {
-    EuropeanOption call1(100.0, strike, rate, sigma, time, "call");
-    EuropeanOption call2(110.0, strike, rate, sigma, time, "call");
+    EuropeanOption call1(100.0, strike, rate, sigma, time, OptionKind::Call);
+    EuropeanOption call2(110.0, strike, rate, sigma, time, OptionKind::Call);
 
     EXPECT_LT(call1.price(), call2.price());
 }
@@ -81,8 +81,8 @@ TEST_F(OptionPricingTest, CallMoneyness)
 // Test that put price increases with strike
 TEST_F(OptionPricingTest, PutMoneyness)
 {
-    EuropeanOption put1(spot, 100.0, rate, sigma, time, "put");
-    EuropeanOption put2(spot, 110.0, rate, sigma, time, "put");
+    EuropeanOption put1(spot, 100.0, rate, sigma, time, OptionKind::Put);
+    EuropeanOption put2(spot, 110.0, rate, sigma, time, OptionKind::Put);
 
     EXPECT_LT(put1.price(), put2.price());
 }
@@ -91,7 +91,7 @@ TEST_F(OptionPricingTest, PutMoneyness)
 TEST_F(OptionPricingTest, OptionFactory)
 {
     auto europeanOption = OptionFactory::create(
-        "european", spot, strike, rate, sigma, time, "call", 100);
+        "european", spot, strike, rate, sigma, time, OptionKind::Call, 100);
 
     EXPECT_NE(europeanOption, nullptr);
     EXPECT_GT(europeanOption->price(), 0.0);
@@ -101,7 +101,7 @@ TEST_F(OptionPricingTest, OptionFactory)
 TEST_F(OptionPricingTest, OptionFactoryInvalidType)
 {
     EXPECT_THROW(
-        OptionFactory::create("invalid", spot, strike, rate, sigma, time, "call", 100),
+        OptionFactory::create("invalid", spot, strike, rate, sigma, time, OptionKind::Call, 100),
         std::invalid_argument);
 }
 
@@ -110,7 +110,7 @@ TEST_F(OptionPricingTest, NegativeTimeHandling)
 {
     // This depends on implementation - might throw or treat as zero
     EXPECT_NO_THROW({
-        EuropeanOption option(spot, strike, rate, sigma, 0.0, "call");
+        EuropeanOption option(spot, strike, rate, sigma, 0.0, OptionKind::Call);
         double price = option.price();
         EXPECT_GE(price, 0.0);
     });
@@ -119,8 +119,8 @@ TEST_F(OptionPricingTest, NegativeTimeHandling)
 // Test high volatility increases option price
 TEST_F(OptionPricingTest, VolatilityEffect)
 {
-    EuropeanOption optionLowVol(spot, strike, rate, 0.1, time, "call");
-    EuropeanOption optionHighVol(spot, strike, rate, 0.5, time, "call");
+    EuropeanOption optionLowVol(spot, strike, rate, 0.1, time, OptionKind::Call);
+    EuropeanOption optionHighVol(spot, strike, rate, 0.5, time, OptionKind::Call);
 
     EXPECT_LT(optionLowVol.price(), optionHighVol.price());
 }
@@ -128,8 +128,8 @@ TEST_F(OptionPricingTest, VolatilityEffect)
 // Test discount rate effects
 TEST_F(OptionPricingTest, RateEffect)
 {
-    EuropeanOption callLowRate(spot, strike, 0.01, sigma, time, "call");
-    EuropeanOption callHighRate(spot, strike, 0.10, sigma, time, "call");
+    EuropeanOption callLowRate(spot, strike, 0.01, sigma, time, OptionKind::Call);
+    EuropeanOption callHighRate(spot, strike, 0.10, sigma, time, OptionKind::Call);
 
     // For calls, higher rates increase price (higher forward)
     EXPECT_LT(callLowRate.price(), callHighRate.price());
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include "strategy/Strategy.h"
+#include "strategy/IronCondor.h"
+#include "options/EuropeanOption.h"
+#include "options/AmericanOption.h"
+#include "test_alloc.h"
+
+using namespace OptionPricer;
+using namespace OptionPricer::Tests;
+
+int main()
+{
+    // Iron-condor-like book with mixed models, signs and a strike on the grid
+    Strategy book;
+    book.addLeg(std::make_shared<EuropeanOption>(100.0, 90.0, 0.05, 0.2, 0.5, OptionKind::Put), 1);
+    book.addLeg(std::make_shared<EuropeanOption>(100.0, 95.0, 0.05, 0.2, 0.5, OptionKind::Put), -1);
+    book.addLeg(std::make_shared<EuropeanOption>(100.0, 105.0, 0.05, 0.2, 0.5, OptionKind::Call), -1);
+    book.addLeg(std::make_shared<AmericanOption>(100.0, 110.0, 0.05, 0.2, 0.5, OptionKind::Call, 100), 1);
+
+    // The grid matches payoff() point by point, bit for bit
+    const std::size_t n = 10001;
+    const std::vector<double> grid = book.payoffGrid(70.0, 130.0, n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double spot = 70.0 + (130.0 - 70.0) * static_cast<double>(i) / (n - 1);
+        if (grid[i] != book.payoff(spot))
+        {
+            std::cerr << "payoffGrid differs from payoff at S=" << spot << std::endl;
+            return 2;
+        }
+    }
+
+    // Arbitrary spots, including exact strikes, and degenerate grids
+    const std::vector<double> spots = {90.0, 95.0, 105.0, 110.0, 0.0, 1e6};
+    std::vector<double> out(spots.size());
+    book.payoffGrid(spots.data(), spots.size(), out.data());
+    for (std::size_t i = 0; i < spots.size(); ++i)
+    {
+        if (out[i] != book.payoff(spots[i]))
+        {
+            std::cerr << "payoffGrid differs from payoff at S=" << spots[i] << std::endl;
+            return 3;
+        }
+    }
+    if (book.payoffGrid(70.0, 130.0, 1) != std::vector<double>{book.payoff(70.0)} ||
+        !book.payoffGrid(70.0, 130.0, 0).empty() || Strategy().payoffGrid(70.0, 130.0, 3) != std::vector<double>(3, 0.0))
+    {
+        std::cerr << "Degenerate grids are wrong" << std::endl;
+        return 4;
+    }
+
+    // Profile of the condor: bounded both ways, every breakeven is a root,
+    // and the extremes bound a dense grid and are attained at the kinks
+    {
+        const PayoffProfile profile = book.payoffProfile();
+        if (profile.kinks != std::vector<double>{90.0, 95.0, 105.0, 110.0} || profile.breakevens.size() != 2 ||
+            std::isinf(profile.maxProfit) || std::isinf(profile.maxLoss))
+        {
+            std::cerr << "Condor profile has the wrong shape" << std::endl;
+            return 5;
+        }
+        for (double spot : profile.breakevens)
+        {
+            if (std::abs(book.payoff(spot)) > 1e-12)
+            {
+                std::cerr << "Breakeven " << spot << " is not a root" << std::endl;
+                return 5;
+            }
+        }
+        const std::vector<double> dense = book.payoffGrid(0.0, 200.0, 200001);
+        const double gridMax = *std::max_element(dense.begin(), dense.end());
+        const double gridMin = *std::min_element(dense.begin(), dense.end());
+        if (std::abs(profile.maxProfit - book.payoff(100.0)) > 1e-12 || profile.maxProfit < gridMax - 1e-12 ||
+            std::abs(profile.maxLoss + book.payoff(115.0)) > 1e-12 || -profile.maxLoss > gridMin + 1e-12)
+        {
+            std::cerr << "Condor extremes are wrong" << std::endl;
+            return 5;
+        }
+    }
+
+    // Unbounded cases and closed forms: long call, short straddle
+    {
+        Strategy call;
+        call.addLeg(std::make_shared<EuropeanOption>(100.0, 100.0, 0.05, 0.2, 0.5, OptionKind::Call), 2);
+        const double premium = call.getLegs()[0].initialPremium;
+        const PayoffProfile p = call.payoffProfile();
+        if (p.maxProfit != HUGE_VAL || std::abs(p.maxLoss - 2 * premium) > 1e-12 || p.breakevens.size() != 1 ||
+            std::abs(p.breakevens[0] - (100.0 + premium)) > 1e-12)
+        {
+            std::cerr << "Long call profile is wrong" << std::endl;
+            return 6;
+        }
+
+        Strategy straddle;
+        straddle.addLeg(std::make_shared<EuropeanOption>(100.0, 100.0, 0.05, 0.2, 0.5, OptionKind::Call), -1);
+        straddle.addLeg(std::make_shared<EuropeanOption>(100.0, 100.0, 0.05, 0.2, 0.5, OptionKind::Put), -1);
+        const double credit = straddle.getLegs()[0].initialPremium + straddle.getLegs()[1].initialPremium;
+        const PayoffProfile s = straddle.payoffProfile();
+        if (s.maxLoss != HUGE_VAL || std::abs(s.maxProfit - credit) > 1e-12 || s.kinks != std::vector<double>{100.0} ||
+            s.breakevens.size() != 2 || std::abs(s.breakevens[0] - (100.0 - credit)) > 1e-12 ||
+            std::abs(s.breakevens[1] - (100.0 + credit)) > 1e-12)
+        {
+            std::cerr << "Short straddle profile is wrong" << std::endl;
+            return 6;
+        }
+
+        // Offsetting legs leave no kink; an empty book is flat zero
+        Strategy flat;
+        flat.addLeg(std::make_shared<EuropeanOption>(100.0, 100.0, 0.05, 0.2, 0.5, OptionKind::Call), 1);
+        flat.addLeg(std::make_shared<EuropeanOption>(100.0, 100.0, 0.05, 0.2, 0.5, OptionKind::Call), -1);
+        if (!flat.payoffProfile().kinks.empty() || flat.payoffProfile().maxLoss != 0.0 ||
+            !Strategy().payoffProfile().breakevens.empty())
+        {
+            std::cerr << "Degenerate profiles are wrong" << std::endl;
+            return 7;
+        }
+    }
+
+    // A 4-leg iron condor on a stack arena is built, priced and plotted with
+    // no heap allocation; the null upstream would throw if the arena overflowed
+    {
+        alignas(std::max_align_t) unsigned char buffer[1024];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        const double spots[] = {85.0, 92.5, 100.0, 107.5, 115.0};
+        double pnl[5];
+
+        const std::size_t before = heapAllocations;
+        IronCondor condor(100.0, 95.0, 105.0, 90.0, 110.0, 0.05, 0.2, 0.5, &arena);
+        const OptionGreeks totals = condor.totalGreeks();
+        condor.payoffGrid(spots, 5, pnl);
+        const std::size_t allocations = heapAllocations - before;
+
+        // Premiums are priced into the legs, so the condor collects a credit
+        if (allocations != 0 || condor.getLegs().size() != 4 || !(totals.price < 0.0) ||
+            pnl[2] != -totals.price || pnl[2] != condor.payoff(100.0))
+        {
+            std::cerr << "Arena iron condor allocated " << allocations << " times or priced wrongly" << std::endl;
+            return 8;
+        }
+    }
+
+    std::cout << "Payoff test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "api/ResponseWriter.h"
+
+using namespace OptionPricer::API;
+
+static std::uint64_t readLittleEndian(const std::string &s, std::size_t offset, int bytes)
+{
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i)
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(s[offset + i])) << (8 * i);
+    return value;
+}
+
+int main()
+{
+    // Portfolio-shaped response: nested meta plus columns under portfolio.payoff
+    ColumnarResponse response;
+    response.meta["status"] = "success";
+    response.meta["portfolio"] = json::object();
+    response.meta["portfolio"]["totalPrice"] = 16.02;
+    response.meta["portfolio"]["legs"] = json::array({json{{"strike", 100.0}, {"quantity", 1}}});
+    response.meta["portfolio"]["payoff"] = json::object();
+    std::vector<double> spots, payoffs;
+    for (int i = 0; i <= 40; ++i)
+    {
+        spots.push_back(70.0 + 1.5 * i);
+        payoffs.push_back(std::sin(0.3 * i) * 1e-7 + i);
+    }
+    response.addColumn("portfolio.payoff.spot_prices", spots);
+    response.addColumn("portfolio.payoff.payoffs", payoffs);
+    response.addColumn("count", std::vector<double>(20, 0.1));
+
+    const json expected = response.toJson();
+    if (expected["portfolio"]["payoff"]["spot_prices"].size() != 41 || expected["count"].size() != 20)
+    {
+        std::cerr << "toJson did not splice columns into meta" << std::endl;
+        return 2;
+    }
+
+    // JSON writer: same document, doubles round-trip exactly, compact output
+    const std::string text = ResponseWriter::write(response, ResponseWriter::Format::Json);
+    if (json::parse(text) != expected || text.find('\n') != std::string::npos)
+    {
+        std::cerr << "JSON output differs from toJson: " << text.substr(0, 200) << std::endl;
+        return 3;
+    }
+
+    // MessagePack writer: decodes to the same document
+    const std::string packed = ResponseWriter::write(response, ResponseWriter::Format::MsgPack);
+    if (json::from_msgpack(packed) != expected)
+    {
+        std::cerr << "MessagePack output differs from toJson" << std::endl;
+        return 4;
+    }
+
+    // Binary writer: header, meta without columns, aligned float64 payloads
+    const std::string binary = ResponseWriter::write(response, ResponseWriter::Format::Binary);
+    if (binary.compare(0, 4, "OPRB") != 0 || readLittleEndian(binary, 4, 2) != 1 ||
+        readLittleEndian(binary, 6, 2) != response.columns.size())
+    {
+        std::cerr << "Binary header is malformed" << std::endl;
+        return 5;
+    }
+    std::size_t offset = 12 + readLittleEndian(binary, 8, 4);
+    if (json::parse(binary.substr(12, offset - 12)) != response.meta)
+    {
+        std::cerr << "Binary meta block differs" << std::endl;
+        return 5;
+    }
+    for (const auto &column : response.columns)
+    {
+        const std::size_t pathLength = readLittleEndian(binary, offset, 2);
+        const std::string path = binary.substr(offset + 2, pathLength);
+        offset += 2 + pathLength;
+        const std::size_t count = readLittleEndian(binary, offset, 8);
+        offset += 8;
+        offset += (8 - offset % 8) % 8;
+        std::vector<double> values(count);
+        std::memcpy(values.data(), binary.data() + offset, count * sizeof(double));
+        offset += count * sizeof(double);
+        if (path != column.path || values != column.values)
+        {
+            std::cerr << "Binary column " << column.path << " does not round-trip" << std::endl;
+            return 5;
+        }
+    }
+    if (offset != binary.size())
+    {
+        std::cerr << "Binary body has trailing bytes" << std::endl;
+        return 5;
+    }
+
+    // Non-finite values follow nlohmann (null); integral doubles keep a decimal point
+    std::string array;
+    const double special[] = {std::numeric_limits<double>::quiet_NaN(), 100.0, 1e-5};
+    ResponseWriter::appendJsonArray(array, special, 3);
+    if (array != json::array({nullptr, 100.0, 1e-5}).dump())
+    {
+        std::cerr << "appendJsonArray formatting differs from nlohmann: " << array << std::endl;
+        return 6;
+    }
+
+    using Format = ResponseWriter::Format;
+
+    // Generated columns serialise exactly like the materialised column they describe,
+    // and a chunked write concatenates to the one-shot body in every format
+    ColumnarResponse generated = response;
+    generated.columns.pop_back();
+    const std::size_t large = 200000; // spans several generator blocks
+    std::vector<double> ramp(large);
+    for (std::size_t i = 0; i < large; ++i)
+        ramp[i] = 0.5 * i - 1e-3;
+    ColumnarResponse materialised = generated;
+    materialised.addColumn("ramp", ramp);
+    generated.addGeneratedColumn("ramp", large, [](std::size_t begin, std::size_t end, double *out)
+                                 {
+        for (std::size_t i = begin; i < end; ++i)
+            out[i - begin] = 0.5 * i - 1e-3; });
+    if (generated.toJson() != materialised.toJson())
+    {
+        std::cerr << "toJson does not expand generated columns" << std::endl;
+        return 8;
+    }
+    for (Format format : {Format::Json, Format::MsgPack, Format::Binary})
+    {
+        const std::string oneShot = ResponseWriter::write(materialised, format);
+        if (ResponseWriter::write(generated, format) != oneShot)
+        {
+            std::cerr << "Generated column output differs from materialised" << std::endl;
+            return 8;
+        }
+
+        const std::size_t chunkBytes = 4096;
+        std::string streamed;
+        std::size_t chunks = 0, largest = 0;
+        const bool complete = ResponseWriter::write(generated, format, [&](const char *data, std::size_t size)
+                                                    {
+            streamed.append(data, size);
+            ++chunks;
+            largest = std::max(largest, size);
+            return true; }, chunkBytes);
+        // A chunk overshoots chunkBytes by at most one generator block
+        if (!complete || streamed != oneShot || chunks < 2 || largest > chunkBytes + (1 << 16) * 28)
+        {
+            std::cerr << "Chunked output differs from one-shot output (" << chunks << " chunks)" << std::endl;
+            return 9;
+        }
+
+        std::size_t delivered = 0;
+        const bool aborted = !ResponseWriter::write(generated, format, [&](const char *, std::size_t)
+                                                    { return ++delivered < 2; }, chunkBytes);
+        if (!aborted || delivered != 2)
+        {
+            std::cerr << "Writer kept going after the sink aborted" << std::endl;
+            return 10;
+        }
+    }
+
+    // Content negotiation
+    if (ResponseWriter::negotiate("") != Format::Json ||
+        ResponseWriter::negotiate("*/*") != Format::Json ||
+        ResponseWriter::negotiate("application/x-msgpack") != Format::MsgPack ||
+        ResponseWriter::negotiate("text/html, application/octet-stream;q=0.9") != Format::Binary ||
+        ResponseWriter::negotiate("application/json, application/x-msgpack") != Format::Json)
+    {
+        std::cerr << "Accept header negotiation is wrong" << std::endl;
+        return 7;
+    }
+
+    std::cout << "Response writer test passed" << std::endl;
+    return 0;
+}
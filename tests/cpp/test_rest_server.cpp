@@ -0,0 +1,332 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+#include "api/RestServer.h"
+#include "api/Warmup.h"
+#include "concurrency/Cancellation.h"
+#include "concurrency/Scheduler.h"
+#include "metrics/Metrics.h"
+#include "options/GreeksCache.h"
+
+using namespace OptionPricer::API;
+using OptionPricer::CancellationToken;
+using OptionPricer::OperationCancelled;
+using json = nlohmann::json;
+
+static bool isJsonError(const httplib::Result &result, int status)
+{
+    if (!result || result->status != status || result->get_header_value("Content-Type") != "application/json")
+        return false;
+    const json body = json::parse(result->body, nullptr, false);
+    return body.is_object() && body.value("status", "") == "error" && body.contains("error");
+}
+
+int main()
+{
+    // Async handlers need a worker of their own, or they run on the HTTP thread
+    OptionPricer::Scheduler::configureShared(2);
+
+    RestServer::Config config;
+    config.host = "127.0.0.1";
+    config.port = 0;
+    config.workers = 2;
+    config.maxRequestBytes = 1024;
+    RestServer server(config);
+
+    std::mutex portsMutex;
+    std::set<int> clientPorts; // one per TCP connection the server saw
+
+    server.registerEndpoint("/echo", "POST", [](const json &request)
+                            { return json{{"echo", request}, {"status", "success"}}; });
+    server.registerEndpoint("/query", "GET", [](const json &request)
+                            { return request.contains("fail") ? json{{"error", "failed"}, {"status", "error"}} : request; });
+    server.registerRoute("GET", R"(/item/([0-9]+))", [&](const httplib::Request &req, httplib::Response &res)
+                         {
+        {
+            std::lock_guard<std::mutex> lock(portsMutex);
+            clientPorts.insert(req.remote_port);
+        }
+        if (req.matches[1] != "1")
+            throw std::out_of_range("Unknown item");
+        RestServer::sendJson(res, json{{"id", 1}}, 200); });
+
+    std::atomic<bool> slowStarted{false};
+    server.registerRoute("GET", "/slow", [&](const httplib::Request & /*req*/, httplib::Response &res)
+                         {
+        slowStarted = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        RestServer::sendJson(res, json{{"done", true}}, 200); });
+
+    // Async routes: /spin runs until its token is cancelled (or 5 s pass),
+    // /partial answers with what it has once its deadline passes
+    std::atomic<int> spinReason{-1};
+    server.registerAsyncRoute("GET", "/spin", [&](const httplib::Request & /*req*/, httplib::Response &res)
+                              {
+        try
+        {
+            for (int i = 0; i < 5000; ++i)
+            {
+                CancellationToken::checkpoint();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        catch (const OperationCancelled &e)
+        {
+            spinReason = static_cast<int>(e.reason());
+            throw;
+        }
+        RestServer::sendJson(res, json{{"done", true}}, 200); });
+    server.registerAsyncEndpoint("/partial", "POST", [](const json &request)
+                                 {
+        int steps = 0;
+        try
+        {
+            for (; steps < request.value("steps", 5000); ++steps)
+            {
+                CancellationToken::checkpoint();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        catch (const OperationCancelled &)
+        {
+            return json{{"steps", steps}, {"partial", true}, {"status", "success"}};
+        }
+        return json{{"steps", steps}, {"status", "success"}}; });
+
+    // Spends 30 ms in each phase, on the Scheduler worker
+    server.registerAsyncRoute("GET", "/phased", [](const httplib::Request & /*req*/, httplib::Response &res)
+                              {
+        using OptionPricer::Metrics::Phase;
+        using OptionPricer::Metrics::RequestTimer;
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        RequestTimer::enter(Phase::Price);
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        RequestTimer::enter(Phase::Serialize);
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        res.set_content("{}", "application/json"); });
+
+    bool badMethodRejected = false;
+    try
+    {
+        server.registerRoute("TRACE", "/x", [](const httplib::Request &, httplib::Response &) {});
+    }
+    catch (const std::invalid_argument &)
+    {
+        badMethodRejected = true;
+    }
+
+    std::thread serving([&]
+                        { server.start(); });
+    server.waitUntilReady();
+    if (!badMethodRejected || !server.isRunning() || server.port() <= 0)
+    {
+        std::cerr << "Server did not start on a free port" << std::endl;
+        server.stop();
+        serving.join();
+        return 1;
+    }
+
+    const int result = [&]
+    {
+        httplib::Client client(config.host, server.port());
+        client.set_keep_alive(true);
+
+        // JSON endpoints: bodies and query strings in, JSON and CORS headers out
+        {
+            auto echo = client.Post("/echo", R"({"spot":100})", "application/json");
+            auto query = client.Get("/query?spot=100");
+            auto failed = client.Get("/query?fail=1");
+            if (!echo || echo->status != 200 || json::parse(echo->body)["echo"]["spot"] != 100 ||
+                echo->get_header_value("Access-Control-Allow-Origin") != "*" ||
+                !query || json::parse(query->body)["spot"] != "100" || !isJsonError(failed, 400))
+            {
+                std::cerr << "JSON endpoints answered incorrectly" << std::endl;
+                return 2;
+            }
+        }
+
+        // Every failure is a JSON error: malformed body, handler exceptions,
+        // unknown routes and oversize bodies
+        {
+            auto malformed = client.Post("/echo", R"({"spot":)", "application/json");
+            auto missing = client.Get("/item/7");
+            auto unknown = client.Get("/nowhere");
+            auto oversize = client.Post("/echo", std::string(4096, ' '), "application/json");
+            if (!isJsonError(malformed, 400) || !isJsonError(missing, 404) || !isJsonError(unknown, 404) ||
+                !isJsonError(oversize, 413) || unknown->get_header_value("Access-Control-Allow-Origin") != "*")
+            {
+                std::cerr << "Errors were not mapped to JSON responses" << std::endl;
+                return 3;
+            }
+        }
+
+        // Preflight, and keep-alive: repeated requests reuse one connection
+        {
+            httplib::Client keepAlive(config.host, server.port());
+            keepAlive.set_keep_alive(true);
+            auto preflight = keepAlive.Options("/echo");
+            for (int i = 0; i < 5; ++i)
+                keepAlive.Get("/item/1");
+            std::lock_guard<std::mutex> lock(portsMutex);
+            if (!preflight || preflight->status != 200 ||
+                preflight->get_header_value("Access-Control-Allow-Methods").find("PATCH") == std::string::npos ||
+                clientPorts.size() > 2)
+            {
+                std::cerr << "Preflight or keep-alive failed (" << clientPorts.size() << " connections)" << std::endl;
+                return 4;
+            }
+        }
+
+        // Deadlines: from the query string or the body, answered with 504 or
+        // with the partial result the handler returned
+        {
+            const auto started = std::chrono::steady_clock::now();
+            auto timedOut = client.Get("/spin?deadline_ms=50");
+            const auto elapsed = std::chrono::steady_clock::now() - started;
+            auto partial = client.Post("/partial", R"({"deadline_ms":50})", "application/json");
+            auto finished = client.Post("/partial", R"({"steps":3,"deadline_ms":5000})", "application/json");
+            auto negative = client.Post("/partial", R"({"deadline_ms":-1})", "application/json");
+            // Budgets past the server's own are clamped to it; a query value that is no number is a 400
+            auto hugeBody = client.Post("/partial", R"({"steps":3,"deadline_ms":1e300})", "application/json");
+            auto hugeQuery = client.Post("/partial?deadline_ms=1e999", R"({"steps":3})", "application/json");
+            auto garbled = client.Post("/partial?deadline_ms=soon", R"({"steps":3})", "application/json");
+            if (!isJsonError(timedOut, 504) || json::parse(timedOut->body)["error"] != "Deadline of 50 ms exceeded" ||
+                elapsed > std::chrono::seconds(2) || spinReason != static_cast<int>(CancellationToken::Reason::Deadline) ||
+                !partial || partial->status != 200 || !json::parse(partial->body).value("partial", false) ||
+                !finished || finished->status != 200 || json::parse(finished->body)["steps"] != 3 ||
+                !isJsonError(negative, 400) || !hugeBody || hugeBody->status != 200 ||
+                json::parse(hugeBody->body)["steps"] != 3 || !hugeQuery || hugeQuery->status != 200 ||
+                json::parse(hugeQuery->body)["steps"] != 3 || !isJsonError(garbled, 400))
+            {
+                std::cerr << "Async deadlines were not applied" << std::endl;
+                return 6;
+            }
+        }
+
+        // A client that hangs up cancels the work it was waiting for
+        {
+            spinReason = -1;
+            httplib::Result abandoned;
+            {
+                httplib::Client impatient(config.host, server.port());
+                impatient.set_read_timeout(0, 100000);
+                abandoned = impatient.Get("/spin");
+            } // closes the socket
+            for (int i = 0; i < 2000 && spinReason < 0; ++i)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if (abandoned || spinReason != static_cast<int>(CancellationToken::Reason::Disconnected))
+            {
+                std::cerr << "Disconnect did not cancel the request (" << spinReason << ")" << std::endl;
+                return 7;
+            }
+        }
+
+        // An async handler's phases are timed on its worker, not lumped into price
+        {
+            namespace Metrics = OptionPricer::Metrics;
+            const auto phased = client.Get("/phased");
+            const std::size_t endpoint = Metrics::endpoint("GET", "/phased");
+            const double ms = 1e6;
+            const double parse = Metrics::latency(endpoint, Metrics::Phase::Parse).sumNanos / ms;
+            const double price = Metrics::latency(endpoint, Metrics::Phase::Price).sumNanos / ms;
+            const double serialize = Metrics::latency(endpoint, Metrics::Phase::Serialize).sumNanos / ms;
+            if (!phased || phased->status != 200 || parse < 30.0 || price < 30.0 || price >= 60.0 ||
+                serialize < 30.0)
+            {
+                std::cerr << "Async phases misattributed: parse " << parse << " ms, price " << price
+                          << " ms, serialize " << serialize << " ms" << std::endl;
+                return 9;
+            }
+        }
+
+        // Warm-up replays its set in rounds, counting failures, and then reports ready
+        {
+            Warmup::Config warmupConfig;
+            warmupConfig.connections = 1; // the other HTTP worker serves the probe
+            warmupConfig.minRounds = 2;
+            warmupConfig.maxRounds = 6;
+            Warmup warmup(warmupConfig);
+            warmup.prepare();
+            const json warming = warmup.status();
+
+            const std::string path = "warmup_requests.ndjson";
+            {
+                std::ofstream out(path);
+                out << R"({"path": "/echo", "body": {"spot": 100}})" << "\n\n"
+                    << R"({"method": "GET", "path": "/item/1"})" << "\n"
+                    << R"({"path": "/nowhere"})" << "\n";
+            }
+            const auto requests = Warmup::loadRequests(path);
+            std::remove(path.c_str());
+            bool malformedRejected = false;
+            {
+                std::ofstream out(path);
+                out << R"({"method": "PUT", "path": "/echo"})" << "\n";
+            }
+            try
+            {
+                Warmup::loadRequests(path);
+            }
+            catch (const std::invalid_argument &)
+            {
+                malformedRejected = true;
+            }
+            std::remove(path.c_str());
+
+            namespace Metrics = OptionPricer::Metrics;
+            const auto echoCount = [] { return Metrics::latency(Metrics::endpoint("POST", "/echo"), Metrics::Phase::Total).count; };
+            const bool echoedBefore = echoCount() > 0;
+            const Warmup::Report report = warmup.run("0.0.0.0", server.port(), requests);
+            const json ready = warmup.status();
+            const auto cache = OptionPricer::GreeksCache::shared().stats();
+            if (warming.value("status", "") != "warming" || requests.size() != 3 || requests[0].method != "POST" ||
+                requests[1].method != "GET" || !malformedRejected || !warmup.ready() ||
+                report.rounds < 2 || report.rounds > 6 || report.requests != 3u * report.rounds ||
+                report.failures != static_cast<std::size_t>(report.rounds) || !(report.p99Ms > 0.0) ||
+                ready.value("status", "") != "ready" || ready["warmup"]["rounds"] != report.rounds ||
+                !echoedBefore || echoCount() != 0 || cache.hits != 0 || cache.misses != 0 || cache.entries != 0)
+            {
+                std::cerr << "Warm-up replay failed: " << ready.dump() << std::endl;
+                return 8;
+            }
+        }
+
+        // stop() lets a request in flight finish, then start() returns
+        {
+            httplib::Result slow;
+            std::thread slowClient([&]
+                                   {
+                httplib::Client other(config.host, server.port());
+                slow = other.Get("/slow"); });
+            while (!slowStarted)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            server.stop();
+            serving.join();
+            slowClient.join();
+            if (!slow || slow->status != 200 || server.isRunning() || client.Get("/item/1"))
+            {
+                std::cerr << "Graceful stop failed" << std::endl;
+                return 5;
+            }
+        }
+
+        return 0;
+    }();
+
+    // Failed checks return above with the server still running
+    server.stop();
+    if (serving.joinable())
+        serving.join();
+    if (result == 0)
+        std::cout << "RestServer test passed" << std::endl;
+    return result;
+}
@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "models/RiskMeasures.h"
+#include "models/MonteCarloRisk.h"
+#include "models/TDigest.h"
+#include "options/EuropeanOption.h"
+#include "options/AmericanOption.h"
+
+using namespace OptionPricer;
+
+int main()
+{
+    // Short straddle plus a protective American put: losses in both tails
+    RiskMeasures::Portfolio portfolio = {
+        {std::make_shared<EuropeanOption>(100.0, 100.0, 0.05, 0.2, 0.5, OptionKind::Call), -1},
+        {std::make_shared<EuropeanOption>(100.0, 100.0, 0.05, 0.2, 0.5, OptionKind::Put), -1},
+        {std::make_shared<AmericanOption>(100.0, 85.0, 0.05, 0.2, 0.5, OptionKind::Put, 200), 2}};
+
+    std::vector<double> spots;
+    for (int i = 0; i <= 400; ++i)
+        spots.push_back(70.0 + 60.0 * i / 400.0);
+
+    RiskMeasures::ScenarioEngine engine(portfolio);
+    const std::vector<double> pnl = engine.run(spots);
+
+    // P&L is relative to today's value and options are never moved
+    if (std::abs(pnl[200]) > 1e-12 || portfolio[0].first->getSpot() != 100.0 || portfolio[2].first->getSpot() != 100.0)
+    {
+        std::cerr << "Scenario P&L is not relative to the current value" << std::endl;
+        return 2;
+    }
+
+    // Reference: sort the full loss vector
+    std::vector<double> losses(pnl.size());
+    std::transform(pnl.begin(), pnl.end(), losses.begin(), std::negate<double>());
+    std::sort(losses.begin(), losses.end(), std::greater<double>());
+    for (double confidence : {0.5, 0.9, 0.95, 0.99})
+    {
+        const std::size_t k = static_cast<std::size_t>(std::ceil((1.0 - confidence) * losses.size() - 1e-9));
+        double tailSum = 0.0;
+        for (std::size_t i = 0; i < k; ++i)
+            tailSum += losses[i];
+
+        const RiskMeasures::ScenarioMeasures m = engine.measures(confidence);
+        if (m.var != losses[k - 1] || std::abs(m.es - tailSum / k) > 1e-12 * std::abs(tailSum) ||
+            m.maxLoss != losses.front() || m.es < m.var)
+        {
+            std::cerr << "Selection measures differ from the sorted reference at " << confidence << std::endl;
+            return 3;
+        }
+    }
+
+    const double profitable = static_cast<double>(std::count_if(pnl.begin(), pnl.end(), [](double p)
+                                                                { return p > 0.0; }));
+    if (engine.measures(0.95).pop != profitable / pnl.size())
+    {
+        std::cerr << "Probability of profit is wrong" << std::endl;
+        return 4;
+    }
+
+    // The free functions and the aggregate agree with the engine
+    const RiskMeasures::ScenarioMeasures m = engine.measures(0.95);
+    if (RiskMeasures::valueAtRisk(portfolio, 0.95, 1.0 / 252.0, spots) != m.var ||
+        RiskMeasures::expectedShortfall(portfolio, 0.95, 1.0 / 252.0, spots) != m.es ||
+        RiskMeasures::maxLoss(portfolio, spots) != m.maxLoss ||
+        RiskMeasures::probabilityOfProfit(portfolio, spots) != m.pop)
+    {
+        std::cerr << "Free risk functions disagree with the scenario engine" << std::endl;
+        return 5;
+    }
+
+    const RiskMeasures::PortfolioRisk risk = RiskMeasures::calculatePortfolioRisk(portfolio);
+    std::cout << "VaR " << risk.var << " ES " << risk.es << " max loss " << risk.maxLoss
+              << " PoP " << risk.pop << std::endl;
+    if (!(risk.es >= risk.var) || risk.maxLoss < risk.es || risk.pop < 0.0 || risk.pop > 1.0)
+    {
+        std::cerr << "Portfolio risk measures are inconsistent" << std::endl;
+        return 6;
+    }
+
+    // Revaluation never mutates the book: engines on separate threads, each
+    // with its own scheduler size, share it and reproduce the serial buffer
+    OptionPricer::Scheduler serialScheduler(1);
+    RiskMeasures::ScenarioEngine serialEngine(portfolio);
+    const std::vector<double> serial = serialEngine.run(spots, serialScheduler);
+    std::vector<std::vector<double>> concurrent(4);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < concurrent.size(); ++t)
+    {
+        threads.emplace_back([&, t]
+                             {
+            OptionPricer::Scheduler scheduler(t + 1);
+            RiskMeasures::ScenarioEngine own(portfolio);
+            concurrent[t] = own.run(spots, scheduler); });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    for (const auto &result : concurrent)
+    {
+        if (result != serial || result != pnl)
+        {
+            std::cerr << "Concurrent scenario runs on a shared book disagree" << std::endl;
+            return 7;
+        }
+    }
+
+    // Monte Carlo paths depend only on (seed, path), not on the scheduler
+    using MonteCarloRisk::Sampling;
+    for (Sampling sampling : {Sampling::Pseudo, Sampling::Antithetic, Sampling::Sobol})
+    {
+        MonteCarloRisk::Spec spec;
+        spec.paths = 1999;
+        spec.sampling = sampling;
+        spec.seed = 42;
+        spec.volOfVol = 0.8;
+        spec.correlation = -0.6;
+        OptionPricer::Scheduler wide(5);
+        const auto a = MonteCarloRisk::generateShocks(spec, serialScheduler);
+        const auto b = MonteCarloRisk::generateShocks(spec, wide);
+        bool same = a.size() == b.size();
+        for (std::size_t i = 0; same && i < a.size(); ++i)
+            same = a[i].spotFactor == b[i].spotFactor && a[i].volFactor == b[i].volFactor;
+        const auto ra = MonteCarloRisk::run(portfolio, spec, {0.99}, serialScheduler);
+        const auto rb = MonteCarloRisk::run(portfolio, spec, {0.99}, wide);
+        if (!same || ra.levels[0].es != rb.levels[0].es || ra.meanPnl != rb.meanPnl)
+        {
+            std::cerr << MonteCarloRisk::toString(sampling) << " paths depend on the thread count" << std::endl;
+            return 8;
+        }
+        if (sampling == Sampling::Antithetic &&
+            (a.size() != 2000 || std::abs(std::log(a[0].spotFactor) + std::log(a[1].spotFactor) -
+                                           2.0 * (spec.drift - 0.5 * spec.spotVol * spec.spotVol) * spec.horizon) > 1e-15))
+        {
+            std::cerr << "Antithetic paths are not mirrored pairs" << std::endl;
+            return 8;
+        }
+    }
+
+    // Sobol sampling should give a far steadier 99% ES than pseudo-random at the same path count
+    const RiskMeasures::Portfolio straddle(portfolio.begin(), portfolio.begin() + 2);
+    auto esSpread = [&](Sampling sampling)
+    {
+        double sum = 0.0, squares = 0.0;
+        const int seeds = 8;
+        for (int seed = 1; seed <= seeds; ++seed)
+        {
+            MonteCarloRisk::Spec spec;
+            spec.paths = 4096;
+            spec.sampling = sampling;
+            spec.seed = seed;
+            spec.horizon = 10.0 / 252.0;
+            const double es = MonteCarloRisk::run(straddle, spec, {0.99}, serialScheduler).levels[0].es;
+            sum += es;
+            squares += es * es;
+        }
+        return std::sqrt(std::max(0.0, squares / seeds - (sum / seeds) * (sum / seeds)));
+    };
+    const double pseudoSpread = esSpread(Sampling::Pseudo);
+    const double sobolSpread = esSpread(Sampling::Sobol);
+    std::cout << "ES99 spread over seeds: pseudo " << pseudoSpread << " sobol " << sobolSpread << std::endl;
+    if (!(sobolSpread < 0.5 * pseudoSpread))
+    {
+        std::cerr << "Sobol sampling does not stabilise ES" << std::endl;
+        return 9;
+    }
+
+    // Risk grows with the horizon
+    MonteCarloRisk::Spec day, month;
+    day.paths = month.paths = 2000;
+    month.horizon = 21.0 / 252.0;
+    const auto dayRisk = MonteCarloRisk::run(portfolio, day, {0.99}, serialScheduler);
+    const auto monthRisk = MonteCarloRisk::run(portfolio, month, {0.99}, serialScheduler);
+    if (!(monthRisk.levels[0].var > dayRisk.levels[0].var) || !(dayRisk.levels[0].es >= dayRisk.levels[0].var))
+    {
+        std::cerr << "Horizon is not reflected in VaR" << std::endl;
+        return 10;
+    }
+
+    // Delta-gamma-vega approximation: close to full revaluation over a day,
+    // and exactly the full run once every leg is over the gamma threshold
+    {
+        MonteCarloRisk::Spec spec;
+        spec.paths = 20000;
+        spec.volOfVol = 1.0;
+        const auto shocks = MonteCarloRisk::generateShocks(spec, serialScheduler);
+        RiskMeasures::ScenarioEngine exact(portfolio), approx(portfolio);
+        const std::vector<double> full = exact.run(shocks, spec.horizon, serialScheduler);
+        approx.runTaylor(shocks, spec.horizon, HUGE_VAL, serialScheduler);
+        const double fullEs = exact.measures(0.99).es;
+        const double taylorEs = approx.measures(0.99).es;
+        std::cout << "ES99 full " << fullEs << " taylor " << taylorEs << std::endl;
+        if (approx.fullyRevaluedLegs() != 0 || std::abs(taylorEs - fullEs) > 0.02 * fullEs)
+        {
+            std::cerr << "Taylor ES is far from full revaluation" << std::endl;
+            return 11;
+        }
+        if (approx.runTaylor(shocks, spec.horizon, 0.0, serialScheduler) != full ||
+            approx.fullyRevaluedLegs() != portfolio.size())
+        {
+            std::cerr << "Taylor mode with every leg repriced differs from the full run" << std::endl;
+            return 11;
+        }
+        // Partial fallback: the American put (lowest gamma) stays approximate; with
+        // vol-of-vol its missing vanna/volga terms no longer cancel against the straddle
+        approx.runTaylor(shocks, spec.horizon, 0.015, serialScheduler);
+        if (approx.fullyRevaluedLegs() != 2 || std::abs(approx.measures(0.99).es - fullEs) > 0.05 * fullEs)
+        {
+            std::cerr << "Gamma threshold fallback is wrong" << std::endl;
+            return 11;
+        }
+    }
+
+    // t-digest: tail quantiles and tail means close to the sorted sample,
+    // and a digest merged from parts close to the digest of the whole
+    {
+        std::vector<double> sample(200000);
+        std::uint64_t state = 12345;
+        for (double &x : sample)
+        {
+            // Heavy right tail: exp of a uniform-sum approximately normal draw
+            double u = 0.0;
+            for (int j = 0; j < 12; ++j)
+            {
+                state = state * 6364136223846793005ull + 1442695040888963407ull;
+                u += static_cast<double>(state >> 11) * 0x1p-53;
+            }
+            x = std::exp(u - 6.0);
+        }
+        TDigest whole, merged;
+        whole.add(sample.data(), sample.size());
+        for (std::size_t part = 0; part < 8; ++part)
+        {
+            TDigest digest;
+            digest.add(sample.data() + part * sample.size() / 8, sample.size() / 8);
+            merged.merge(digest);
+        }
+        std::vector<double> sorted = sample;
+        std::sort(sorted.begin(), sorted.end());
+        for (double q : {0.5, 0.9, 0.99, 0.999})
+        {
+            const double exact = sorted[static_cast<std::size_t>(q * sorted.size())];
+            const double k = (1.0 - q) * sorted.size();
+            double tail = 0.0;
+            for (std::size_t i = sorted.size() - static_cast<std::size_t>(k); i < sorted.size(); ++i)
+                tail += sorted[i];
+            for (const TDigest *digest : {&whole, &merged})
+            {
+                if (std::abs(digest->quantile(q) - exact) > 3e-3 * exact ||
+                    std::abs(digest->upperMean(k) - tail / k) > 1e-3 * tail / k)
+                {
+                    std::cerr << "t-digest is far from the sample at " << q << std::endl;
+                    return 12;
+                }
+            }
+        }
+        if (whole.count() != sample.size() || whole.max() != sorted.back() || whole.min() != sorted.front() ||
+            whole.centroids().size() > 2 * static_cast<std::size_t>(TDigest::DefaultCompression))
+        {
+            std::cerr << "t-digest bounds or size are wrong" << std::endl;
+            return 12;
+        }
+    }
+
+    // Partials: path ranges concatenate into the run, and merged summaries
+    // give the run's moments exactly and its VaR / ES closely
+    {
+        MonteCarloRisk::Spec spec;
+        spec.paths = 30000;
+        spec.volOfVol = 0.5;
+        const std::vector<double> confidences = {0.95, 0.99};
+        const auto run = MonteCarloRisk::run(portfolio, spec, confidences, serialScheduler);
+        const std::size_t n = MonteCarloRisk::pathCount(spec);
+        const std::size_t cuts[] = {0, 7001, 15000, n};
+        std::vector<double> pnl;
+        MonteCarloRisk::Summary summary;
+        for (std::size_t part = 0; part + 1 < std::size(cuts); ++part)
+        {
+            const auto raw = MonteCarloRisk::runPartial(portfolio, spec, cuts[part], cuts[part + 1], false,
+                                                        TDigest::DefaultCompression, serialScheduler);
+            const auto digest = MonteCarloRisk::runPartial(portfolio, spec, cuts[part], cuts[part + 1], true,
+                                                           TDigest::DefaultCompression, serialScheduler);
+            pnl.insert(pnl.end(), raw.pnl.begin(), raw.pnl.end());
+            summary.merge(digest.summary);
+        }
+        const auto concatenated = MonteCarloRisk::summarize(pnl, run.baseValue, run.fullyRevaluedLegs, confidences);
+        const auto approximate = MonteCarloRisk::summarize(summary, run.baseValue, run.fullyRevaluedLegs, confidences);
+        if (concatenated.meanPnl != run.meanPnl || concatenated.stdevPnl != run.stdevPnl ||
+            concatenated.levels[1].var != run.levels[1].var || concatenated.levels[1].es != run.levels[1].es)
+        {
+            std::cerr << "Concatenated partials differ from the run" << std::endl;
+            return 13;
+        }
+        std::cout << "ES99 exact " << run.levels[1].es << " digest " << approximate.levels[1].es << std::endl;
+        if (approximate.paths != run.paths || approximate.pop != run.pop || approximate.maxLoss != run.maxLoss ||
+            std::abs(approximate.meanPnl - run.meanPnl) > 1e-12 * std::abs(run.stdevPnl) * n ||
+            std::abs(approximate.stdevPnl - run.stdevPnl) > 1e-9 * run.stdevPnl)
+        {
+            std::cerr << "Merged summary moments differ from the run" << std::endl;
+            return 13;
+        }
+        for (std::size_t l = 0; l < confidences.size(); ++l)
+        {
+            if (std::abs(approximate.levels[l].var - run.levels[l].var) > 1e-2 * run.levels[l].var ||
+                std::abs(approximate.levels[l].es - run.levels[l].es) > 1e-3 * run.levels[l].es)
+            {
+                std::cerr << "Digest VaR / ES far from exact at " << confidences[l] << std::endl;
+                return 13;
+            }
+        }
+        bool rejected = false;
+        try
+        {
+            MonteCarloRisk::runPartial(portfolio, spec, 0, n + 1, false, 100.0, serialScheduler);
+        }
+        catch (const std::invalid_argument &)
+        {
+            rejected = true;
+        }
+        if (!rejected)
+        {
+            std::cerr << "Partial beyond the run was accepted" << std::endl;
+            return 13;
+        }
+    }
+
+    // Normal accuracy: Fast and Table runs stay within their CDF error of the
+    // exact P&L on every path, and the American leg is revalued identically
+    {
+        MonteCarloRisk::Spec spec;
+        spec.paths = 4000;
+        spec.volOfVol = 0.5;
+        const std::vector<double> exact =
+            RiskMeasures::ScenarioEngine(portfolio).run(MonteCarloRisk::generateShocks(spec, serialScheduler),
+                                                        spec.horizon, serialScheduler);
+        for (Normal::Accuracy accuracy : {Normal::Accuracy::Fast, Normal::Accuracy::Table})
+        {
+            spec.accuracy = accuracy;
+            const auto shocks = MonteCarloRisk::generateShocks(spec, serialScheduler);
+            RiskMeasures::ScenarioEngine engine(portfolio, accuracy);
+            const std::vector<double> &pnl = engine.run(shocks, spec.horizon, serialScheduler);
+            const double tolerance = accuracy == Normal::Accuracy::Fast ? 1e-11 : 1e-6;
+            for (std::size_t s = 0; s < pnl.size(); ++s)
+            {
+                if (std::abs(pnl[s] - exact[s]) > tolerance)
+                {
+                    std::cerr << Normal::toString(accuracy) << " revaluation off at path " << s << ": " << pnl[s]
+                              << " vs " << exact[s] << std::endl;
+                    return 14;
+                }
+            }
+            const auto result = MonteCarloRisk::run(portfolio, spec, {0.99}, serialScheduler);
+            if (result.paths != exact.size() || result.levels.size() != 1)
+            {
+                std::cerr << "Risk run at " << Normal::toString(accuracy) << " accuracy is malformed" << std::endl;
+                return 14;
+            }
+        }
+    }
+
+    std::cout << "Risk measures test passed" << std::endl;
+    return 0;
+}
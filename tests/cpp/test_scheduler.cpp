@@ -0,0 +1,301 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "concurrency/Cancellation.h"
+#include "concurrency/Scheduler.h"
+#include "models/GreeksSurface.h"
+#include "options/AmericanOption.h"
+
+using OptionPricer::CancellationToken;
+using OptionPricer::OperationCancelled;
+using OptionPricer::Scheduler;
+using OptionPricer::TaskGroup;
+
+// Sum of per-leg Greeks priced on a scheduler of the given size, reduced in index order
+static std::vector<double> portfolioTotals(std::size_t threads)
+{
+    std::vector<OptionPricer::AmericanOption> legs;
+    for (int i = 0; i < 24; ++i)
+        legs.emplace_back(100.0, 80.0 + 2.0 * i, 0.05, 0.15 + 0.01 * i, 0.25 + 0.05 * i,
+                          i % 2 ? OptionKind::Put : OptionKind::Call, 150);
+
+    Scheduler scheduler(threads);
+    std::vector<OptionGreeks> greeks(legs.size());
+    scheduler.parallelFor(legs.size(), [&](std::size_t i)
+                          { greeks[i] = legs[i].greeks(); }, 1);
+
+    std::vector<double> totals(6, 0.0);
+    for (const auto &g : greeks)
+    {
+        totals[0] += g.price;
+        totals[1] += g.delta;
+        totals[2] += g.gamma;
+        totals[3] += g.vega;
+        totals[4] += g.theta;
+        totals[5] += g.rho;
+    }
+    return totals;
+}
+
+// Recursive fork-join: every level waits on tasks that may be stolen
+static long fib(Scheduler &scheduler, int n)
+{
+    if (n < 12)
+        return n < 2 ? n : fib(scheduler, n - 1) + fib(scheduler, n - 2);
+    long a = 0;
+    TaskGroup group(scheduler);
+    group.run([&]
+              { a = fib(scheduler, n - 1); });
+    long b = fib(scheduler, n - 2);
+    group.wait();
+    return a + b;
+}
+
+int main()
+{
+    Scheduler scheduler(4);
+    std::cout << "Scheduler size: " << scheduler.size() << std::endl;
+
+    // Every index runs exactly once, for several grain sizes
+    for (std::size_t grain : {0, 1, 7, 5000})
+    {
+        std::vector<std::atomic<int>> hits(1000);
+        scheduler.parallelFor(hits.size(), [&](std::size_t i)
+                              { hits[i]++; }, grain);
+        for (const auto &h : hits)
+        {
+            if (h != 1)
+            {
+                std::cerr << "parallelFor ran an index " << h << " times (grain " << grain << ")" << std::endl;
+                return 2;
+            }
+        }
+    }
+
+    // Nested parallelism from inside tasks must not deadlock
+    std::atomic<int> nested{0};
+    scheduler.parallelFor(16, [&](std::size_t)
+                          { scheduler.parallelFor(16, [&](std::size_t)
+                                                  { nested++; }, 1); }, 1);
+    if (nested != 256)
+    {
+        std::cerr << "Nested parallelFor ran " << nested << " of 256 tasks" << std::endl;
+        return 3;
+    }
+    for (std::size_t threads : {1, 2, 4})
+    {
+        Scheduler small(threads);
+        if (fib(small, 24) != 46368)
+        {
+            std::cerr << "Fork-join result wrong with " << threads << " threads" << std::endl;
+            return 4;
+        }
+    }
+
+    // Exceptions are rethrown on the waiting thread, from parallelFor and TaskGroup
+    bool caught = false;
+    try
+    {
+        scheduler.parallelFor(100, [](std::size_t i)
+                              { if (i == 42) throw std::runtime_error("leg 42"); }, 1);
+    }
+    catch (const std::runtime_error &e)
+    {
+        caught = std::strcmp(e.what(), "leg 42") == 0;
+    }
+    try
+    {
+        TaskGroup group(scheduler);
+        group.run([]
+                  { throw std::runtime_error("task"); });
+        group.wait();
+        caught = false;
+    }
+    catch (const std::runtime_error &e)
+    {
+        caught = caught && std::strcmp(e.what(), "task") == 0;
+    }
+    if (!caught)
+    {
+        std::cerr << "Task exceptions were not propagated" << std::endl;
+        return 5;
+    }
+
+    // Totals are bit-for-bit identical for any thread count
+    const std::vector<double> serial = portfolioTotals(1);
+    for (std::size_t threads : {2, 3, 8})
+    {
+        if (portfolioTotals(threads) != serial)
+        {
+            std::cerr << "Portfolio totals differ with " << threads << " threads" << std::endl;
+            return 6;
+        }
+    }
+
+    // Tasks run under the token of the code that spawned them, on any thread
+    {
+        CancellationToken token;
+        CancellationToken::Scope scope(&token);
+        std::atomic<int> inherited{0};
+        TaskGroup group(scheduler);
+        for (int i = 0; i < 32; ++i)
+            group.run([&]
+                      { inherited += CancellationToken::current() == &token; });
+        group.wait();
+        if (inherited != 32 || CancellationToken::current() != &token)
+        {
+            std::cerr << "Only " << inherited << " of 32 tasks saw the submitter's token" << std::endl;
+            return 7;
+        }
+    }
+    if (CancellationToken::current() != nullptr)
+    {
+        std::cerr << "Token still current after its Scope ended" << std::endl;
+        return 7;
+    }
+
+    // Cancelling stops parallelFor at the next chunk, and the first reason wins
+    {
+        CancellationToken token;
+        CancellationToken::Scope scope(&token);
+        std::atomic<int> ran{0};
+        bool stopped = false;
+        try
+        {
+            // Whichever index runs first cancels: index 0 may well run last
+            scheduler.parallelFor(100000, [&](std::size_t)
+                                  { if (ran++ == 0) token.cancel(CancellationToken::Reason::Disconnected); }, 16);
+        }
+        catch (const OperationCancelled &e)
+        {
+            stopped = e.reason() == CancellationToken::Reason::Disconnected;
+        }
+        token.cancel(CancellationToken::Reason::Deadline);
+        if (!stopped || ran == 100000 || token.reason() != CancellationToken::Reason::Disconnected)
+        {
+            std::cerr << "Cancelled parallelFor ran " << ran << " of 100000 indices" << std::endl;
+            return 8;
+        }
+    }
+
+    // A passed deadline cancels; lattices notice it without spawning tasks
+    {
+        CancellationToken token;
+        token.limit(std::chrono::milliseconds(1));
+        token.limit(std::chrono::milliseconds(500)); // a later deadline never extends it
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        CancellationToken::Scope scope(&token);
+        bool stopped = false;
+        try
+        {
+            OptionPricer::AmericanOption(100.0, 100.0, 0.05, 0.2, 1.0, OptionKind::Put, 5000).price();
+        }
+        catch (const OperationCancelled &e)
+        {
+            stopped = e.reason() == CancellationToken::Reason::Deadline &&
+                      std::strcmp(e.what(), "Deadline of 1 ms exceeded") == 0;
+        }
+        if (!stopped)
+        {
+            std::cerr << "Lattice did not stop at the deadline" << std::endl;
+            return 9;
+        }
+    }
+
+    // A budget beyond the clock's range is no deadline, not one already past
+    {
+        CancellationToken token;
+        token.limit(std::chrono::milliseconds::max());
+        if (token.hasDeadline() || token.cancelled())
+        {
+            std::cerr << "Out-of-range deadline cancelled at once" << std::endl;
+            return 13;
+        }
+    }
+
+    // A cancelled surface comes back partial rather than throwing
+    {
+        OptionPricer::GreeksSurface::Spec spec;
+        spec.strike = 100.0;
+        spec.rate = 0.05;
+        spec.sigma = 0.2;
+        spec.kind = OptionKind::Call;
+        spec.spotMin = 80.0;
+        spec.spotMax = 120.0;
+        spec.timeMin = 0.1;
+        spec.timeMax = 2.0;
+        spec.spotSteps = 200;
+        spec.timeSteps = 200;
+        const std::size_t points = 201 * 201;
+        if (OptionPricer::GreeksSurface::compute(spec, scheduler).completed != points)
+        {
+            std::cerr << "Uncancelled surface reported missing points" << std::endl;
+            return 10;
+        }
+        CancellationToken token;
+        token.cancel();
+        CancellationToken::Scope scope(&token);
+        const auto grid = OptionPricer::GreeksSurface::compute(spec, scheduler);
+        if (grid.completed != 0 || grid.delta.size() != points || !std::isnan(grid.delta[points / 2]))
+        {
+            std::cerr << "Cancelled surface completed " << grid.completed << " points" << std::endl;
+            return 10;
+        }
+    }
+
+    // Posted jobs run on a worker, with no token of the poster's
+    {
+        CancellationToken token;
+        CancellationToken::Scope scope(&token);
+        std::promise<bool> ran;
+        scheduler.post([&]
+                       { ran.set_value(CancellationToken::current() == nullptr); });
+        auto result = ran.get_future();
+        if (result.wait_for(std::chrono::seconds(10)) != std::future_status::ready || !result.get())
+        {
+            std::cerr << "Posted job did not run cleanly" << std::endl;
+            return 11;
+        }
+    }
+
+    // runOnEachThread reaches every worker and the caller exactly once, and rethrows
+    for (std::size_t threads : {1, 3, 4})
+    {
+        Scheduler pool(threads);
+        std::mutex mutex;
+        std::set<std::thread::id> seen;
+        std::size_t calls = 0;
+        pool.runOnEachThread([&]
+                             {
+            std::lock_guard<std::mutex> lock(mutex);
+            seen.insert(std::this_thread::get_id());
+            ++calls; });
+        bool rethrown = false;
+        try
+        {
+            pool.runOnEachThread([]
+                                 { throw std::runtime_error("setup"); });
+        }
+        catch (const std::runtime_error &)
+        {
+            rethrown = true;
+        }
+        if (calls != threads || seen.size() != threads || !rethrown || pool.pinWorkers() > threads - 1)
+        {
+            std::cerr << "runOnEachThread made " << calls << " calls on " << seen.size() << " of " << threads
+                      << " threads" << std::endl;
+            return 12;
+        }
+    }
+
+    std::cout << "Scheduler test passed" << std::endl;
+    return 0;
+}
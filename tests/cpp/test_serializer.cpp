@@ -0,0 +1,122 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "api/JsonSerializer.h"
+#include "api/PricingEndpoint.h"
+#include "api/RequestArena.h"
+#include "test_alloc.h"
+#include "test_requests.h"
+
+using namespace OptionPricer::API;
+using namespace OptionPricer::Tests;
+using json = nlohmann::json;
+
+// The error message a parse raises, or "" if it succeeds
+template <class Parse>
+static std::string errorOf(Parse parse)
+{
+    try
+    {
+        parse();
+    }
+    catch (const std::invalid_argument &e)
+    {
+        return e.what();
+    }
+    return "";
+}
+
+int main()
+{
+    // Body and DOM paths decode the same fields; unknown keys and nested
+    // containers, including a "legs" array that is not the request's, are skipped
+    const json request = portfolioRequest(64);
+    const std::string body = request.dump();
+    {
+        const PortfolioParams parsed = JsonSerializer::parsePortfolioParams(body);
+        const PortfolioParams decoded = JsonSerializer::decodePortfolioParams(request);
+        if (parsed.legs.size() != 64 || decoded.legs.size() != 64 || parsed.payoffSteps != 40 || parsed.stream)
+        {
+            std::cerr << "Portfolio decoded with the wrong shape" << std::endl;
+            return 2;
+        }
+        for (std::size_t i = 0; i < parsed.legs.size(); ++i)
+        {
+            const LegParams &a = parsed.legs[i];
+            const LegParams &b = decoded.legs[i];
+            if (a.optionType != b.optionType || a.model != b.model || a.strike != b.strike ||
+                a.volatility != b.volatility || a.time != b.time || a.quantity != b.quantity ||
+                a.steps != b.steps || a.strike != request["legs"][i]["strike"].get<double>() ||
+                a.model != request["legs"][i]["type"].get<std::string>())
+            {
+                std::cerr << "Leg " << i << " decoded differently from the DOM" << std::endl;
+                return 2;
+            }
+        }
+    }
+
+    // Responses from a parsed body match the DOM handlers exactly
+    {
+        const json price = {{"type", "put"}, {"model", "american"}, {"spot", 100}, {"strike", 105},
+                            {"rate", 0.05}, {"volatility", 0.25}, {"time", 1}, {"steps", 200}};
+        const json strategy = {{"strategy", "strangle"}, {"spot", 100}, {"strike", 100}, {"strike_put", 92},
+                               {"rate", 0.05}, {"volatility", 0.2}, {"time", 0.5}, {"is_long", false}};
+        if (PricingEndpoint::handlePriceRequest(JsonSerializer::parseOptionParams(price.dump())) !=
+                PricingEndpoint::handlePriceRequest(price) ||
+            PricingEndpoint::handleStrategyRequest(JsonSerializer::parseStrategyParams(strategy.dump())) !=
+                PricingEndpoint::handleStrategyRequest(strategy) ||
+            PricingEndpoint::buildPortfolioResponse(JsonSerializer::parsePortfolioParams(body)).toJson() !=
+                PricingEndpoint::handlePortfolioRequest(request))
+        {
+            std::cerr << "Parsed request priced differently from the DOM request" << std::endl;
+            return 3;
+        }
+    }
+
+    // Missing fields, wrong types and malformed JSON are rejected with a message
+    {
+        const std::string missingSpot = errorOf([] { JsonSerializer::parsePortfolioParams(R"({"rate":0.05,"legs":[]})"); });
+        const std::string emptyLegs = errorOf([] { JsonSerializer::parsePortfolioParams(R"({"spot":1,"rate":0.05,"legs":[]})"); });
+        const std::string objectLegs = errorOf([] { JsonSerializer::parsePortfolioParams(R"({"spot":1,"rate":0.05,"legs":{}})"); });
+        const std::string legFields = errorOf([] { JsonSerializer::parsePortfolioParams(R"({"spot":1,"rate":0.05,"legs":[{"strike":1}]})"); });
+        const std::string scalarLeg = errorOf([] { JsonSerializer::parsePortfolioParams(R"({"spot":1,"rate":0.05,"legs":[3]})"); });
+        const std::string wrongType = errorOf([] { JsonSerializer::parseOptionParams(R"({"type":"call","spot":"100"})"); });
+        const std::string notObject = errorOf([] { JsonSerializer::parseOptionParams("[1,2]"); });
+        const std::string malformed = errorOf([] { JsonSerializer::parseStrategyParams(R"({"strategy":"straddle",)"); });
+        const std::string noStrategy = errorOf([] { JsonSerializer::parseStrategyParams(R"({"spot":100})"); });
+        const std::string missingPrice = errorOf([] { JsonSerializer::parseOptionParams(R"({"type":"call","spot":100})"); });
+        if (missingSpot != "Missing required parameters: spot, rate, legs" ||
+            emptyLegs != "legs must be a non-empty array" || objectLegs != "legs must be a non-empty array" ||
+            legFields != "Each leg must have: strike, volatility, time" || scalarLeg != "Each leg must be an object" ||
+            wrongType != "spot must be a number" || notObject != "Request body must be a JSON object" ||
+            malformed.find("parse error") == std::string::npos || noStrategy != "Missing 'strategy' parameter" ||
+            missingPrice != "Missing required pricing parameters")
+        {
+            std::cerr << "Invalid requests were not rejected as expected" << std::endl;
+            return 4;
+        }
+    }
+
+    // Parsing a body into the arena allocates a handful of times in total,
+    // not once per leg or field as building a DOM does
+    {
+        const std::string big = portfolioRequest(512).dump();
+        RequestArena::Scope scope;
+        std::size_t before = heapAllocations;
+        const PortfolioParams params = JsonSerializer::parsePortfolioParams(big);
+        const std::size_t parseAllocations = heapAllocations - before;
+        before = heapAllocations;
+        const json dom = json::parse(big);
+        const std::size_t domAllocations = heapAllocations - before;
+        if (params.legs.size() != 512 || parseAllocations > 16 || domAllocations < 512)
+        {
+            std::cerr << "Parsing 512 legs allocated " << parseAllocations << " times (DOM: " << domAllocations
+                      << ")" << std::endl;
+            return 5;
+        }
+    }
+
+    std::cout << "Serializer test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "api/PortfolioSession.h"
+#include "api/PricingEndpoint.h"
+#include "options/GreeksCache.h"
+
+using namespace OptionPricer;
+using namespace OptionPricer::API;
+
+namespace
+{
+    // Session snapshot without its bookkeeping, comparable to a portfolio response
+    json withoutSessionFields(json snapshot)
+    {
+        snapshot.erase("session");
+        snapshot.erase("version");
+        return snapshot;
+    }
+
+    json fresh(const json &request)
+    {
+        return PricingEndpoint::buildPortfolioResponse(request).toJson();
+    }
+}
+
+int main()
+{
+    json request = {
+        {"spot", 100.0},
+        {"rate", 0.05},
+        {"legs", json::array({
+                     {{"optionType", "call"}, {"strike", 100.0}, {"volatility", 0.2}, {"time", 0.5}, {"quantity", 1}},
+                     {{"optionType", "put"}, {"strike", 95.0}, {"volatility", 0.25}, {"time", 0.5}, {"quantity", -2}},
+                     {{"type", "american"}, {"optionType", "put"}, {"strike", 90.0}, {"volatility", 0.2}, {"time", 1.0}, {"quantity", 1}, {"steps", 150}},
+                 })}};
+
+    SessionStore store(2);
+    const json created = store.create(request);
+    const std::string id = created["session"];
+    if (id.size() != 16 || withoutSessionFields(created) != fresh(request) || created["version"] != 1)
+    {
+        std::cerr << "New session does not match a fresh portfolio request" << std::endl;
+        return 2;
+    }
+
+    // Editing one leg reprices only that leg and reports only it
+    const auto before = GreeksCache::shared().stats();
+    const json delta = store.apply(id, {{"legs", json::array({{{"index", 1}, {"strike", 97.0}}})}});
+    const auto after = GreeksCache::shared().stats();
+    request["legs"][1]["strike"] = 97.0;
+    if (delta["version"] != 2 || delta["portfolio"]["legs"].size() != 1 || delta["portfolio"]["legs"][0]["index"] != 1 ||
+        !delta["portfolio"].contains("greeks") || !delta["portfolio"].contains("payoff") ||
+        after.misses - before.misses != 1 || after.hits != before.hits)
+    {
+        std::cerr << "Leg patch was not incremental: " << delta.dump() << std::endl;
+        return 3;
+    }
+    if (withoutSessionFields(store.snapshot(id)) != fresh(request))
+    {
+        std::cerr << "Patched session differs from a fresh request" << std::endl;
+        return 3;
+    }
+
+    // Market moves reprice every leg; appends extend the book
+    const json moved = store.apply(id, {{"spot", 102.0},
+                                        {"legs", json::array({{{"optionType", "call"}, {"strike", 110.0}, {"volatility", 0.2}, {"time", 0.5}, {"quantity", -1}}})}});
+    request["spot"] = 102.0;
+    request["legs"].push_back({{"optionType", "call"}, {"strike", 110.0}, {"volatility", 0.2}, {"time", 0.5}, {"quantity", -1}});
+    if (moved["portfolio"]["legs"].size() != 4 || moved["portfolio"]["spot"] != 102.0 ||
+        withoutSessionFields(store.snapshot(id)) != fresh(request))
+    {
+        std::cerr << "Market patch was not applied to every leg" << std::endl;
+        return 4;
+    }
+
+    // A no-op patch changes nothing and says so
+    const json idle = store.apply(id, {{"spot", 102.0}});
+    if (idle["version"] != 3 || !idle["portfolio"]["legs"].empty() || idle["portfolio"].contains("payoff"))
+    {
+        std::cerr << "No-op patch reported changes: " << idle.dump() << std::endl;
+        return 5;
+    }
+
+    // Invalid patches throw and leave the session untouched
+    const json snapshot = store.snapshot(id);
+    for (const json &bad : {json{{"legs", json::array({{{"index", 9}, {"strike", 1.0}}})}},
+                            json{{"legs", json::array({{{"index", 0}, {"strike", 101.0}}, {{"index", 1}, {"volatility", -0.2}}})}},
+                            json{{"payoff_steps", 0}}})
+    {
+        bool threw = false;
+        try
+        {
+            store.apply(id, bad);
+        }
+        catch (const std::invalid_argument &)
+        {
+            threw = true;
+        }
+        if (!threw || store.snapshot(id) != snapshot)
+        {
+            std::cerr << "Invalid patch was partially applied: " << bad.dump() << std::endl;
+            return 6;
+        }
+    }
+
+    // Unknown ids, deletion and least-recently-used eviction
+    bool unknown = false;
+    try
+    {
+        store.snapshot("0000000000000000");
+    }
+    catch (const std::out_of_range &)
+    {
+        unknown = true;
+    }
+    const std::string second = store.create(request)["session"];
+    store.snapshot(id); // id is now the most recent
+    const std::string third = store.create(request)["session"];
+    bool evicted = false;
+    try
+    {
+        store.snapshot(second);
+    }
+    catch (const std::out_of_range &)
+    {
+        evicted = true;
+    }
+    store.erase(third);
+    if (!unknown || !evicted || store.size() != 1 || second == third)
+    {
+        std::cerr << "Session lookup or eviction is wrong" << std::endl;
+        return 7;
+    }
+
+    std::cout << "Portfolio session test passed" << std::endl;
+    return 0;
+}
@@ -22,8 +22,8 @@ protected:
 // Test bull call spread max profit
 TEST_F(StrategyTest, BullCallMaxProfit)
 {
-    BullCall bullCall(spot, strike, rate, sigma, time, true);
-    double maxProfit = bullCall.maxProfit();
+    BullCall bullCall(spot, strike, strike * 1.05, rate, sigma, time);
+    double maxProfit = bullCall.payoffProfile().maxProfit;
 
     // Max profit should be positive
     EXPECT_GT(maxProfit, 0.0);
@@ -32,8 +32,8 @@ TEST_F(StrategyTest, BullCallMaxProfit)
 // Test bull call spread max loss
 TEST_F(StrategyTest, BullCallMaxLoss)
 {
-    BullCall bullCall(spot, strike, rate, sigma, time, true);
-    double maxLoss = bullCall.maxLoss();
+    BullCall bullCall(spot, strike, strike * 1.05, rate, sigma, time);
+    double maxLoss = bullCall.payoffProfile().maxLoss;
 
     // Max loss should be non-negative
     EXPECT_GE(maxLoss, 0.0);
@@ -42,8 +42,10 @@ TEST_F(StrategyTest, BullCallMaxLoss)
 // Test bull call spread breakeven
 TEST_F(StrategyTest, BullCallBreakeven)
 {
-    BullCall bullCall(spot, strike, rate, sigma, time, true);
-    double breakeven = bullCall.breakeven();
+    BullCall bullCall(spot, strike, strike * 1.05, rate, sigma, time);
+    const PayoffProfile profile = bullCall.payoffProfile();
+    ASSERT_EQ(profile.breakevens.size(), 1u);
+    double breakeven = profile.breakevens[0];
 
     // Breakeven should be between lower and upper strike
     EXPECT_GE(breakeven, strike);
@@ -54,16 +56,16 @@ TEST_F(StrategyTest, BullCallBreakeven)
 TEST_F(StrategyTest, StraddlePrice)
 {
     Straddle straddle(spot, strike, rate, sigma, time, true);
-    double price = straddle.price();
+    double price = straddle.totalPrice();
 
     EXPECT_GT(price, 0.0);
 }
 
-// Test long straddle has delta near zero
+// Test long straddle struck at the forward has delta near zero
 TEST_F(StrategyTest, StraddleDeltaNeutral)
 {
-    Straddle straddle(spot, strike, rate, sigma, time, true);
-    double delta = straddle.delta();
+    Straddle straddle(spot, spot * std::exp(rate * time), rate, sigma, time, true);
+    double delta = straddle.totalDelta();
 
     // Delta should be close to zero (long call + long put)
     EXPECT_NEAR(delta, 0.0, 0.1);
@@ -73,17 +75,17 @@ TEST_F(StrategyTest, StraddleDeltaNeutral)
 TEST_F(StrategyTest, StranglePriceLessThanStraddle)
 {
     Straddle straddle(spot, strike, rate, sigma, time, true);
-    Strangle strangle(spot, strike, rate, sigma, time, true);
+    Strangle strangle(spot, strike * 1.05, strike * 0.95, rate, sigma, time, true);
 
     // Strangle should be cheaper (strikes further apart)
-    EXPECT_LT(strangle.price(), straddle.price());
+    EXPECT_LT(strangle.totalPrice(), straddle.totalPrice());
 }
 
 // Test iron condor has positive max profit
 TEST_F(StrategyTest, IronCondorMaxProfit)
 {
-    IronCondor ironCondor(spot, strike, rate, sigma, time, true);
-    double maxProfit = ironCondor.maxProfit();
+    IronCondor ironCondor(spot, strike * 0.98, strike * 1.02, strike * 0.95, strike * 1.05, rate, sigma, time);
+    double maxProfit = ironCondor.payoffProfile().maxProfit;
 
     EXPECT_GT(maxProfit, 0.0);
 }
@@ -91,8 +93,8 @@ TEST_F(StrategyTest, IronCondorMaxProfit)
 // Test iron condor is credit strategy (negative cost at entry)
 TEST_F(StrategyTest, IronCondorCredit)
 {
-    IronCondor ironCondor(spot, strike, rate, sigma, time, true);
-    double price = ironCondor.price();
+    IronCondor ironCondor(spot, strike * 0.98, strike * 1.02, strike * 0.95, strike * 1.05, rate, sigma, time);
+    double price = ironCondor.totalPrice();
 
     // Should be net credit (negative price means received premium)
     EXPECT_LT(price, 0.0);
@@ -105,7 +107,7 @@ TEST_F(StrategyTest, StrategyFactoryBullCall)
         "bull_call", spot, strike, rate, sigma, time, true);
 
     EXPECT_NE(bullCall, nullptr);
-    EXPECT_GT(bullCall->price(), -10000.0); // Reasonable price
+    EXPECT_GT(bullCall->totalPrice(), -10000.0); // Reasonable price
 }
 
 // Test strategy factory creates straddle
@@ -115,7 +117,7 @@ TEST_F(StrategyTest, StrategyFactoryStraddle)
         "straddle", spot, strike, rate, sigma, time, true);
 
     EXPECT_NE(straddle, nullptr);
-    EXPECT_GT(straddle->price(), 0.0);
+    EXPECT_GT(straddle->totalPrice(), 0.0);
 }
 
 // Test strategy factory creates strangle
@@ -125,7 +127,7 @@ TEST_F(StrategyTest, StrategyFactoryStrangle)
         "strangle", spot, strike, rate, sigma, time, true);
 
     EXPECT_NE(strangle, nullptr);
-    EXPECT_GT(strangle->price(), 0.0);
+    EXPECT_GT(strangle->totalPrice(), 0.0);
 }
 
 // Test strategy factory creates iron condor
@@ -146,21 +148,21 @@ TEST_F(StrategyTest, StrategyFactoryList)
     EXPECT_TRUE(std::find(strategies.begin(), strategies.end(), "bull_call") != strategies.end());
 }
 
-// Test bull call spread reversal (short position)
-TEST_F(StrategyTest, BullCallShort)
+// Test straddle reversal (short position)
+TEST_F(StrategyTest, StraddleShort)
 {
-    BullCall longBullCall(spot, strike, rate, sigma, time, true);
-    BullCall shortBullCall(spot, strike, rate, sigma, time, false);
+    auto longStraddle = StrategyFactory::create("straddle", spot, strike, rate, sigma, time, true);
+    auto shortStraddle = StrategyFactory::create("straddle", spot, strike, rate, sigma, time, false);
 
     // Short should be negative of long
-    EXPECT_NEAR(longBullCall.price() + shortBullCall.price(), 0.0, 0.1);
+    EXPECT_NEAR(longStraddle->totalPrice() + shortStraddle->totalPrice(), 0.0, 1e-12);
 }
 
 // Test strategy vega is positive for long volatility
 TEST_F(StrategyTest, StrategyVegaLongVolatility)
 {
     Straddle straddle(spot, strike, rate, sigma, time, true);
-    double vega = straddle.vega();
+    double vega = straddle.totalVega();
 
     // Long straddle has positive vega
     EXPECT_GT(vega, 0.0);
@@ -170,7 +172,7 @@ TEST_F(StrategyTest, StrategyVegaLongVolatility)
 TEST_F(StrategyTest, StrategyTheta)
 {
     Straddle straddle(spot, strike, rate, sigma, time, true);
-    double theta = straddle.theta();
+    double theta = straddle.totalTheta();
 
     // Long straddle theta (time decay)
     // Can be negative or positive depending on spot/strike relationship
@@ -303,6 +303,23 @@ def test_greeks_surface_endpoint(api_base):
     assert r.status_code in (200, 501)
 
 
+def test_greeks_surface_columnar_uses_request_params(api_base):
+    """Columns are row-major over (spot, time) and honour the requested rate/vol."""
+    r = requests.get(f"{api_base}/greeks/surface", params={
+        "type": "call", "strike": 100, "rate": 0.03, "volatility": 0.35,
+        "spot_range": "[80, 120]", "time_range": "[0.5, 1.5]",
+        "spot_steps": 4, "time_steps": 2, "fields": "delta,vega",
+    }, timeout=20)
+    assert r.status_code == 200
+    data = r.json()
+    assert data["shape"] == [5, 3]
+    assert len(data["delta"]) == len(data["vega"]) == 15
+    assert "gamma" not in data
+    S, T = data["spots"][3], data["times"][2]
+    assert data["delta"][3 * 3 + 2] == pytest.approx(ref_delta(S, 100, 0.03, 0.35, T, "call"), rel=1e-9)
+    assert data["vega"][3 * 3 + 2] == pytest.approx(ref_vega(S, 100, 0.03, 0.35, T), rel=1e-9)
+
+
 # ===========================================================================
 # 8. Black-Scholes analytical reference (pure math — no server required)
 # ===========================================================================
@@ -519,3 +536,226 @@ def test_american_portfolio_mixed_price_positive(api_base):
     assert "error" not in data
     for leg in data["portfolio"]["legs"]:
         assert leg.get("price", 0) > 0
+
+
+# ===========================================================================
+# 10. Chain pricing (batch SIMD kernel)
+# ===========================================================================
+
+def test_chain_matches_single_pricing(api_base):
+    strikes = [80, 90, 100, 110, 120]
+    r = requests.post(f"{api_base}/chain/price", json={
+        "type": "put", "spot": 100, "rate": 0.05, "volatility": 0.2, "time": 1.0,
+        "strikes": strikes,
+    }, timeout=5)
+    assert r.status_code == 200, r.text
+    chain = r.json()
+    assert chain["count"] == len(strikes)
+    for i, k in enumerate(strikes):
+        single = requests.post(f"{api_base}/price", json={
+            "type": "put", "spot": 100, "strike": k, "rate": 0.05,
+            "volatility": 0.2, "time": 1.0,
+        }, timeout=5).json()
+        for field in ("price", "delta", "gamma", "vega", "theta", "rho"):
+            assert chain[field][i] == pytest.approx(single[field], rel=1e-9, abs=1e-12)
+
+
+def test_american_chain_matches_single_pricing(api_base):
+    strikes = [80, 90, 100, 110, 120]
+    r = requests.post(f"{api_base}/chain/price", json={
+        "type": "put", "model": "american_fd", "steps": 400, "spot": 100, "rate": 0.05,
+        "volatility": 0.2, "time": 1.0, "strikes": strikes,
+    }, timeout=5)
+    assert r.status_code == 200, r.text
+    chain = r.json()
+    assert chain["model"] == "american_fd"
+    for i, k in enumerate(strikes):
+        single = requests.post(f"{api_base}/price", json={
+            "type": "put", "model": "american_bbsr", "steps": 2000, "spot": 100, "strike": k,
+            "rate": 0.05, "volatility": 0.2, "time": 1.0,
+        }, timeout=5).json()
+        assert chain["price"][i] == pytest.approx(single["price"], abs=1e-3)
+        assert chain["delta"][i] == pytest.approx(single["delta"], abs=1e-3)
+
+
+def test_implied_vol_batch_round_trips_chain_prices(api_base):
+    strikes = [70, 85, 100, 115, 130]
+    vols = [0.35, 0.25, 0.2, 0.22, 0.3]
+    chain = requests.post(f"{api_base}/chain/price", json={
+        "type": "call", "spot": 100, "rate": 0.03, "time": 0.5,
+        "strikes": strikes, "volatilities": vols,
+    }, timeout=5).json()
+    r = requests.post(f"{api_base}/implied_vol/batch", json={
+        "type": "call", "spot": 100, "rate": 0.03, "time": 0.5,
+        "strikes": strikes, "prices": chain["price"],
+    }, timeout=5)
+    assert r.status_code == 200, r.text
+    body = r.json()
+    assert body["count"] == len(strikes)
+    assert body["unsolved"] == 0
+    for i, v in enumerate(vols):
+        assert body["implied_volatility"][i] == pytest.approx(v, rel=1e-8)
+
+
+def test_implied_vol_batch_marks_unsolvable_quotes(api_base):
+    # Below intrinsic, above the spot, and a valid put in between
+    r = requests.post(f"{api_base}/implied_vol/batch", json={
+        "spot": 100, "rate": 0.0, "time": 1.0,
+        "strikes": [80, 100, 100], "prices": [10.0, 150.0, 7.965567455405804],
+        "types": ["call", "call", "put"],
+    }, timeout=5)
+    assert r.status_code == 200, r.text
+    body = r.json()
+    assert body["unsolved"] == 2
+    assert body["implied_volatility"][:2] == [None, None]
+    assert body["implied_volatility"][2] == pytest.approx(0.2, rel=1e-8)
+
+
+def test_chain_rejects_mismatched_arrays(api_base):
+    r = requests.post(f"{api_base}/chain/price", json={
+        "spot": 100, "rate": 0.05, "volatility": 0.2, "time": 1.0,
+        "strikes": [90, 100], "volatilities": [0.2],
+    }, timeout=5)
+    assert r.status_code == 400
+
+
+# ===========================================================================
+# 11. Monte Carlo portfolio risk
+# ===========================================================================
+
+SHORT_STRADDLE_RISK = {
+    "spot": 100, "rate": 0.05, "horizon": 10 / 252, "paths": 20000,
+    "legs": [
+        {"optionType": "call", "strike": 100, "volatility": 0.2, "time": 0.5, "quantity": -1},
+        {"optionType": "put", "strike": 100, "volatility": 0.2, "time": 0.5, "quantity": -1},
+    ],
+}
+
+
+@pytest.mark.parametrize("sampling", ["pseudo", "antithetic", "sobol"])
+def test_risk_levels_ordered(api_base, sampling):
+    r = requests.post(f"{api_base}/portfolio/risk",
+                      json={**SHORT_STRADDLE_RISK, "sampling": sampling}, timeout=30)
+    assert r.status_code == 200, r.text
+    risk = r.json()["risk"]
+    assert risk["sampling"] == sampling
+    levels = risk["levels"]
+    assert [level["confidence"] for level in levels] == [0.95, 0.99]
+    assert 0 < levels[0]["var"] < levels[1]["var"] <= levels[1]["es"] <= risk["max_loss"]
+
+
+def test_risk_reproducible_for_seed(api_base):
+    body = {**SHORT_STRADDLE_RISK, "sampling": "sobol", "seed": 11}
+    first = requests.post(f"{api_base}/portfolio/risk", json=body, timeout=30).json()
+    second = requests.post(f"{api_base}/portfolio/risk", json=body, timeout=30).json()
+    assert first == second
+
+
+def test_risk_rejects_unknown_sampling(api_base):
+    r = requests.post(f"{api_base}/portfolio/risk",
+                      json={**SHORT_STRADDLE_RISK, "sampling": "lhs"}, timeout=5)
+    assert r.status_code == 400
+
+
+def test_risk_taylor_close_to_full(api_base):
+    full = requests.post(f"{api_base}/portfolio/risk", json=SHORT_STRADDLE_RISK, timeout=30).json()["risk"]
+    taylor = requests.post(f"{api_base}/portfolio/risk",
+                           json={**SHORT_STRADDLE_RISK, "revaluation": "taylor"}, timeout=30).json()["risk"]
+    assert taylor["fully_revalued_legs"] == 0
+    for exact, approx in zip(full["levels"], taylor["levels"]):
+        assert approx["es"] == pytest.approx(exact["es"], rel=0.1)
+
+
+# ===========================================================================
+# 12. Greeks cache
+# ===========================================================================
+
+def test_cache_edited_leg_is_only_miss(api_base):
+    legs = [
+        {"optionType": "call", "strike": 100, "volatility": 0.2, "time": 0.75, "quantity": 1},
+        {"type": "american", "optionType": "put", "strike": 90, "volatility": 0.2, "time": 0.75,
+         "quantity": -1, "steps": 150},
+    ]
+    body = {"spot": 100, "rate": 0.05, "legs": legs}
+    first = requests.post(f"{api_base}/portfolio/price", json=body, timeout=5).json()
+    before = requests.get(f"{api_base}/cache/stats", timeout=5).json()
+    again = requests.post(f"{api_base}/portfolio/price", json=body, timeout=5).json()
+    edited = {**body, "legs": [{**legs[0], "strike": 101}, legs[1]]}
+    requests.post(f"{api_base}/portfolio/price", json=edited, timeout=5)
+    after = requests.get(f"{api_base}/cache/stats", timeout=5).json()
+    assert again == first
+    assert after["misses"] - before["misses"] == 1
+    assert after["hits"] - before["hits"] == 3
+    assert after["bytes"] <= after["capacity_bytes"]
+
+
+# ===========================================================================
+# 13. Portfolio sessions
+# ===========================================================================
+
+SESSION_BOOK = {
+    "spot": 100, "rate": 0.05,
+    "legs": [
+        {"optionType": "call", "strike": 100, "volatility": 0.2, "time": 0.5, "quantity": 1},
+        {"optionType": "put", "strike": 95, "volatility": 0.2, "time": 0.5, "quantity": -1},
+    ],
+}
+
+
+def test_session_patch_matches_fresh_request(api_base):
+    created = requests.post(f"{api_base}/portfolio/session", json=SESSION_BOOK, timeout=5).json()
+    sid = created["session"]
+    delta = requests.patch(f"{api_base}/portfolio/session/{sid}",
+                           json={"legs": [{"index": 1, "strike": 97}]}, timeout=5).json()
+    assert delta["version"] == created["version"] + 1
+    assert [leg["index"] for leg in delta["portfolio"]["legs"]] == [1]
+
+    edited = {**SESSION_BOOK, "legs": [SESSION_BOOK["legs"][0], {**SESSION_BOOK["legs"][1], "strike": 97}]}
+    snapshot = requests.get(f"{api_base}/portfolio/session/{sid}", timeout=5).json()
+    expected = requests.post(f"{api_base}/portfolio/price", json=edited, timeout=5).json()
+    assert snapshot["portfolio"] == expected["portfolio"]
+    assert requests.delete(f"{api_base}/portfolio/session/{sid}", timeout=5).status_code == 200
+
+
+def test_session_unknown_id_is_404(api_base):
+    r = requests.patch(f"{api_base}/portfolio/session/0000000000000000", json={"spot": 101}, timeout=5)
+    assert r.status_code == 404
+
+
+# ===========================================================================
+# 14. Analytic payoff profile
+# ===========================================================================
+
+def test_payoff_profile_exact_on_sparse_grid(api_base):
+    legs = [
+        {"optionType": "call", "strike": 100, "volatility": 0.2, "time": 0.5, "quantity": -1},
+        {"optionType": "put", "strike": 100, "volatility": 0.2, "time": 0.5, "quantity": -1},
+    ]
+    r = requests.post(f"{api_base}/portfolio/price",
+                      json={"spot": 100, "rate": 0.05, "legs": legs, "payoff_steps": 2}, timeout=5)
+    assert r.status_code == 200, r.text
+    portfolio = r.json()["portfolio"]
+    payoff = portfolio["payoff"]
+    credit = -portfolio["totalPrice"]
+    assert payoff["kinks"] == [100.0]
+    assert payoff["breakevens"] == pytest.approx([100 - credit, 100 + credit], abs=1e-9)
+    assert payoff["max_profit"] == pytest.approx(credit, abs=1e-9)
+    assert payoff["max_loss"] is None
+
+
+# ===========================================================================
+# 15. Market data
+# ===========================================================================
+
+def test_price_by_underlying_matches_explicit_inputs(api_base):
+    r = requests.put(f"{api_base}/market/PYTEST", json={"spot": 100, "rate": 0.03, "volatility": 0.25}, timeout=5)
+    assert r.status_code == 200, r.text
+    by_name = requests.post(f"{api_base}/price",
+                            json={"type": "call", "underlying": "PYTEST", "strike": 105, "time": 0.5}, timeout=5).json()
+    explicit = requests.post(f"{api_base}/price",
+                             json={"type": "call", "spot": 100, "strike": 105, "rate": 0.03,
+                                   "volatility": 0.25, "time": 0.5}, timeout=5).json()
+    assert by_name["price"] == pytest.approx(explicit["price"], abs=1e-12)
+    assert by_name["market_version"] == r.json()["version"]
+    assert requests.delete(f"{api_base}/market/PYTEST", timeout=5).status_code == 200
+    assert requests.get(f"{api_base}/market/PYTEST", timeout=5).status_code == 404